@@ -0,0 +1,32 @@
+REM @english
+REM BIT DATATYPE COUNTING THE BITS OF AN ARRAY
+REM
+REM This example shows how to clear an array of bits, how to set some
+REM of its elements and how to count the elements that are set.
+REM 
+REM @italian
+REM TIPO DATO BIT CONTEGGIO DEI BIT DI UN ARRAY
+REM
+REM Questo esempio mostra come azzerare un array di bit, come impostare 
+REM alcuni suoi elementi e come contare gli elementi impostati.
+REM
+REM @include atari,atarixl,c128,c128z,c64,coco,coco3,coleco,cpc,d32,d64,mo5,msx1,pc128op,plus4,sc3000,sg1000,vg5000,vic20,zx
+
+    CLS
+
+    DIM visited AS BIT(40,25)
+
+    FILL visited
+
+    visited(0,0) = 1
+    visited(39,24) = 1
+
+    FOR y = 0 TO 24 STEP 2
+        visited(y,y) = 1
+    NEXT
+
+    PRINT "VISITED: ";BIT COUNT( visited )
+
+    FILL visited WITH 1
+
+    PRINT "ALL: ";BIT COUNT( visited )
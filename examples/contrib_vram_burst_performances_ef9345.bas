@@ -0,0 +1,43 @@
+REM @english
+REM OTHER CONTRIBUTIONS VRAM BURST PERFORMANCE (EF9345)
+REM
+REM This example measures how many characters per frame can be written
+REM into the video RAM of the EF9345. It repeats ''CLS'' (a burst of 
+REM auto incrementing character writes, one for each row) for a fixed 
+REM time, and then prints the number of characters written for each
+REM frame.
+REM
+REM @italian
+REM VARI ALTRI CONTRIBUTI PERFORMANCE VRAM (EF9345)
+REM
+REM Questo esempio misura quanti caratteri per frame possono essere
+REM scritti nella memoria video dell'EF9345. Ripete ''CLS'' (una 
+REM raffica di scritture di caratteri ad autoincremento, una per ogni
+REM riga) per un tempo fisso, e poi stampa il numero di caratteri 
+REM scritti per ogni frame.
+REM
+REM @include vg5000
+
+CONST timeLimit = 250
+CONST clsBytes = 1000
+
+VAR counter AS WORD = 0
+DIM rate AS FLOAT, elapsed AS FLOAT
+DIM clsRate AS FLOAT
+
+counter = 0
+TIMER = 0
+DO
+    CLS
+    INC counter
+    EXIT IF TIMER > timeLimit
+LOOP
+elapsed = TIMER
+rate = counter
+clsRate = ( rate * clsBytes ) / elapsed
+
+CLS
+LOCATE 0,0
+PRINT "VRAM BURST ON EF9345"
+PRINT
+PRINT "  CLS = ";clsRate;" CHARACTERS/FRAME"
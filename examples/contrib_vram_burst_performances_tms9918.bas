@@ -0,0 +1,66 @@
+REM @english
+REM OTHER CONTRIBUTIONS VRAM BURST PERFORMANCE (TMS9918)
+REM
+REM This example measures how many bytes per frame can be moved into
+REM the video RAM of the TMS9918. It repeats ''CLS'' (a burst fill of
+REM names, patterns and colors) and ''PUT IMAGE'' (a burst copy of
+REM patterns and colors) for a fixed time, and then prints the number
+REM of bytes written for each frame.
+REM
+REM @italian
+REM VARI ALTRI CONTRIBUTI PERFORMANCE VRAM (TMS9918)
+REM
+REM Questo esempio misura quanti byte per frame possono essere scritti
+REM nella memoria video del TMS9918. Ripete ''CLS'' (un riempimento a
+REM raffica di nomi, pattern e colori) e ''PUT IMAGE'' (una copia a
+REM raffica di pattern e colori) per un tempo fisso, e poi stampa il 
+REM numero di byte scritti per ogni frame.
+REM
+REM @include msx1,coleco,sg1000,sc3000
+
+CONST timeLimit = 250
+CONST width = 32
+CONST height = 32
+CONST clsBytes = 13056
+CONST putBytes = 256
+
+BITMAP ENABLE (16)
+COLOR BORDER BLACK
+CLS BLACK
+
+VAR counter AS WORD = 0
+DIM rate AS FLOAT, elapsed AS FLOAT
+DIM clsRate AS FLOAT, putRate AS FLOAT
+
+picture := NEW IMAGE(#width, #height)
+GET IMAGE picture FROM 0, 0
+
+counter = 0
+TIMER = 0
+DO
+    CLS
+    INC counter
+    EXIT IF TIMER > timeLimit
+LOOP
+elapsed = TIMER
+rate = counter
+clsRate = ( rate * clsBytes ) / elapsed
+
+counter = 0
+TIMER = 0
+DO
+    PUT IMAGE picture AT 0, 0
+    INC counter
+    EXIT IF TIMER > timeLimit
+LOOP
+elapsed = TIMER
+rate = counter
+putRate = ( rate * putBytes ) / elapsed
+
+CLS BLACK
+LOCATE 0,0
+PEN WHITE
+PRINT "VRAM BURST ON TMS9918"
+PRINT
+PRINT "  CLS       = ";PEN(YELLOW);clsRate;PEN(WHITE);" BYTES/FRAME"
+PRINT "  PUT IMAGE = ";PEN(YELLOW);putRate;PEN(WHITE);" BYTES/FRAME"
@@ -0,0 +1,66 @@
+REM @english
+REM OTHER CONTRIBUTIONS VRAM BURST PERFORMANCE (VDC)
+REM
+REM This example measures how many bytes per frame can be moved into
+REM the video RAM of the VDC. It repeats ''CLS'' (a block fill of the
+REM whole bitmap) and ''PUT IMAGE'' (an auto increment
+REM burst of the bitmap) for a fixed time, and then prints the number
+REM of bytes written for each frame.
+REM
+REM @italian
+REM VARI ALTRI CONTRIBUTI PERFORMANCE VRAM (VDC)
+REM
+REM Questo esempio misura quanti byte per frame possono essere scritti
+REM nella memoria video del VDC. Ripete ''CLS'' (un riempimento a
+REM blocchi di tutta la bitmap) e ''PUT IMAGE'' (una scrittura a
+REM raffica della bitmap) per un tempo fisso, e poi stampa il 
+REM numero di byte scritti per ogni frame.
+REM
+REM @include c128z
+
+CONST timeLimit = 250
+CONST width = 32
+CONST height = 32
+CONST clsBytes = 32768
+CONST putBytes = 128
+
+BITMAP ENABLE (2)
+COLOR BORDER BLACK
+CLS BLACK
+
+VAR counter AS WORD = 0
+DIM rate AS FLOAT, elapsed AS FLOAT
+DIM clsRate AS FLOAT, putRate AS FLOAT
+
+picture := NEW IMAGE(#width, #height)
+GET IMAGE picture FROM 0, 0
+
+counter = 0
+TIMER = 0
+DO
+    CLS
+    INC counter
+    EXIT IF TIMER > timeLimit
+LOOP
+elapsed = TIMER
+rate = counter
+clsRate = ( rate * clsBytes ) / elapsed
+
+counter = 0
+TIMER = 0
+DO
+    PUT IMAGE picture AT 0, 0
+    INC counter
+    EXIT IF TIMER > timeLimit
+LOOP
+elapsed = TIMER
+rate = counter
+putRate = ( rate * putBytes ) / elapsed
+
+CLS BLACK
+LOCATE 0,0
+PEN WHITE
+PRINT "VRAM BURST ON VDC"
+PRINT
+PRINT "  CLS       = ";PEN(YELLOW);clsRate;PEN(WHITE);" BYTES/FRAME"
+PRINT "  PUT IMAGE = ";PEN(YELLOW);putRate;PEN(WHITE);" BYTES/FRAME"
@@ -0,0 +1,37 @@
+REM @english
+REM EMBEDDED DATA USING TYPED DATA AND READ INTO
+REM
+REM This small example will show how to use the ''OPTION DATA AS'' to
+REM store every ''DATA'' without type tags, and the ''READ INTO'' to fill
+REM a whole array with a single block copy.
+REM 
+REM @italian
+REM INCLUDENDO DEI DATI CON DATA TIPIZZATI E READ INTO
+REM
+REM Questo piccolo esempio mostra come usare ''OPTION DATA AS'' per
+REM memorizzare tutti i ''DATA'' senza il tipo, e ''READ INTO'' per
+REM riempire un intero vettore con una sola copia a blocchi.
+REM
+REM @include atari,atarixl,c128,c128z,c64,coco,coco3,coleco,cpc,d32,d64,mo5,msx1,pc128op,plus4,sc3000,sg1000,vg5000,vic20,zx
+
+OPTION DATA AS BYTE
+
+DATA 1, 2, 3, 4, 5, 6, 7, 8
+DATA 10, 20, 30, 40, 50, 60, 70, 80
+DATA 99
+
+DIM row(8) AS BYTE
+
+CLS
+
+READ INTO row()
+PRINT row(0);" ";row(7)
+
+READ SAFE INTO row()
+PRINT row(0);" ";row(7)
+
+READ last
+PRINT last
+
+READ SAFE INTO row()
+PRINT row(0);" ";row(7)
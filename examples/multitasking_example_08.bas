@@ -0,0 +1,60 @@
+REM @english
+REM MULTI TASKING SCHEDULING OVERHEAD BENCHMARK
+REM
+REM This example measures how many scheduling rounds RUN PARALLEL
+REM can perform in one second with 16 threads: 4 of them are busy
+REM counting, 12 of them are sleeping on WAIT ... TICKS. Sleeping
+REM threads are not visited by the scheduler, so the number of
+REM rounds depends only on the threads that are ready to run.
+REM
+REM @italian
+REM MISURARE IL COSTO DELLO SCHEDULING DEL MULTITASKING
+REM
+REM Questo esempio misura quanti giri di RUN PARALLEL possono
+REM essere eseguiti in un secondo con 16 thread: 4 di essi contano,
+REM mentre gli altri 12 sono sospesi su WAIT ... TICKS. I thread
+REM sospesi non vengono visitati dallo scheduler, per cui il numero
+REM di giri dipende solo dai thread pronti per l'esecuzione.
+REM
+REM @include atari,atarixl,c128,c64,coco,coco3,d32,d64,coleco,sg1000,sc3000,cpc,msx1,zx,vic20,plus4
+
+    CONST threadCount = 16
+    CONST busyCount = 4
+
+    DEFINE TASK COUNT threadCount
+
+    DIM counter AS WORD (threadCount)
+
+    GLOBAL counter
+
+    PARALLEL PROCEDURE busy
+        DO
+            [counter] = [counter] + 1
+            YIELD
+        LOOP
+    END PROC
+
+    PARALLEL PROCEDURE sleeper
+        DO
+            WAIT 200 TICKS
+        LOOP
+    END PROC
+
+    FOR i = 0 TO busyCount - 1
+        SPAWN busy
+    NEXT
+    FOR i = busyCount TO threadCount - 1
+        SPAWN sleeper
+    NEXT
+
+    rounds = (WORD) 0
+
+    t = TIMER
+    WHILE ( TIMER - t ) < TICKS PER SECOND
+        RUN PARALLEL
+        INC rounds
+    WEND
+
+    PRINT "THREADS: "; threadCount
+    PRINT "ROUNDS PER SECOND: "; rounds
+    PRINT "BUSY COUNTER: "; counter(0)
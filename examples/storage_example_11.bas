@@ -0,0 +1,26 @@
+REM @english
+REM STORAGE MANAGEMENT LOADING A COMPRESSED IMAGE
+REM
+REM This example shows how to load a compressed image at runtime. The
+REM image is uncompressed while it is read, directly into the variable.
+REM
+REM @italian
+REM MEMORIE DI MASSA CARICARE UNA IMMAGINE COMPRESSA
+REM
+REM Questo esempio mostra come caricare una immagine compressa a runtime.
+REM L'immagine viene decompressa mentre viene letta, direttamente nella
+REM variabile.
+
+    BITMAP ENABLE
+
+STORAGE "disco" AS "disk1"
+	IMAGE "token_red.png" AS "tokenred" COMPRESSED
+ENDSTORAGE
+
+    CLS
+
+    tokenImage := NEW IMAGE(16, 16)
+
+    DLOAD "tokenred" TO VARPTR(tokenImage)
+
+    PUT IMAGE tokenImage AT 32, 32
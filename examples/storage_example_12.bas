@@ -0,0 +1,34 @@
+REM @english
+REM STORAGE MANAGEMENT LOADING A FILE WITH THE FAST LOADER
+REM
+REM This example shows how to load a file at runtime with the fast
+REM loader of the 1541 drive, and how to check if it has been loaded.
+REM On emulators, the true drive emulation must be enabled.
+REM
+REM @italian
+REM MEMORIE DI MASSA CARICARE UN FILE CON IL CARICATORE VELOCE
+REM
+REM Questo esempio mostra come caricare un file al momento dell'esecuzione
+REM con il caricatore veloce del drive 1541, e come controllare se e' stato
+REM caricato. Sugli emulatori deve essere attivata l'emulazione completa
+REM del drive.
+
+DEFINE DLOAD FAST
+
+CLS
+
+STORAGE "DISCHETTO" AS "DISK1"
+    FILE "test.txt" AS "test.dat"
+ENDSTORAGE
+
+DIM textRuntime AS STRING
+
+textRuntime = "                "
+
+DLOAD "test.dat" TO STRPTR(textRuntime) SIZE 16
+
+IF DLOAD ERROR = 0 THEN
+    PRINT textRuntime
+ELSE
+    PRINT "ERROR ";DLOAD ERROR
+ENDIF
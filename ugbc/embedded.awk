@@ -0,0 +1,96 @@
+# ----------------------------------------------------------------------------
+# Pre-tokenization of embedded assembly modules.
+#
+# For each (non empty) line of the module, it emits three words:
+#
+#   offset           position of the line inside the module (as per xxd -i)
+#   length | kind    length of the line and its kind (0 = code, 1 = comment,
+#                    2 = directive to be parsed by ugbc.embed.y)
+#   next             for @IF / @ELSE / @ELSEIF lines, the index of the next
+#                    branch (or @ENDIF) at the same nesting level
+#
+# so that outembedded0 can copy ready made lines and skip excluded
+# branches without lexing them. Run with LC_ALL=C to count bytes.
+# ----------------------------------------------------------------------------
+
+BEGIN {
+    offset = 0;
+    count = 0;
+    depth = 0;
+}
+
+{
+    line = $0;
+    size = length( line );
+    start = offset;
+    offset += size + 1;
+
+    # Empty lines were never returned by strtok().
+    if ( size == 0 ) {
+        next;
+    }
+
+    kind = 0;
+    branch = 0;
+
+    # A single leading tab is tokenized as OP_TAB by ugbc.embed.lex, so
+    # the line cannot be a directive.
+    if ( !( substr( line, 1, 1 ) == "\t" && substr( line, 2, 1 ) !~ /[ \t]/ ) ) {
+        directive = line;
+        sub( /^[ \t]+/, "", directive );
+        if ( substr( directive, 1, 1 ) == "@" ) {
+            kind = 2;
+            if ( directive ~ /^@[ \t]*IF([^A-Za-z0-9_]|$)/ ) {
+                branch = 1;
+            } else if ( directive ~ /^@[ \t]*ELSE([^A-Za-z0-9_]|$)/ || directive ~ /^@[ \t]*ELSEIF([^A-Za-z0-9_]|$)/ ) {
+                branch = 2;
+            } else if ( directive ~ /^@[ \t]*ENDIF([^A-Za-z0-9_]|$)/ ) {
+                branch = 3;
+            }
+        }
+    }
+
+    # Same rules of assemblyLineIsAComment().
+    if ( kind == 0 ) {
+        comment = line;
+        if ( substr( comment, 1, 1 ) == "\r" ) {
+            kind = 1;
+        } else {
+            sub( /^[ \t]+/, "", comment );
+            if ( substr( comment, 1, 1 ) == ";" ) {
+                kind = 1;
+            }
+        }
+    }
+
+    offsets[count] = start;
+    sizes[count] = size + ( kind * 16777216 );
+    nexts[count] = 0;
+
+    if ( branch == 1 ) {
+        ++depth;
+        last[depth] = count;
+    } else if ( branch == 2 && depth > 0 ) {
+        nexts[last[depth]] = count;
+        last[depth] = count;
+    } else if ( branch == 3 && depth > 0 ) {
+        nexts[last[depth]] = count;
+        --depth;
+    }
+
+    ++count;
+}
+
+END {
+    name = FILENAME;
+    gsub( /[^A-Za-z0-9]/, "_", name );
+    print "unsigned int " name "_lines[] = {";
+    if ( count == 0 ) {
+        print "  0, 0, 0";
+    }
+    for( i=0; i<count; ++i ) {
+        printf( "  %d, %d, %d%s\n", offsets[i], sizes[i], nexts[i], ( i < count-1 ) ? "," : "" );
+    }
+    print "};";
+    print "unsigned int " name "_lines_len = " count ";";
+}
@@ -0,0 +1,429 @@
+/*****************************************************************************
+ * ugBASIC - an isomorphic BASIC language compiler for retrocomputers        *
+ *****************************************************************************
+ * Copyright 2021-2024 Marco Spedaletti (asimov@mclink.it)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *----------------------------------------------------------------------------
+ * Concesso in licenza secondo i termini della Licenza Apache, versione 2.0
+ * (la "Licenza"); è proibito usare questo file se non in conformità alla
+ * Licenza. Una copia della Licenza è disponibile all'indirizzo:
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Se non richiesto dalla legislazione vigente o concordato per iscritto,
+ * il software distribuito nei termini della Licenza è distribuito
+ * "COSÌ COM'È", SENZA GARANZIE O CONDIZIONI DI ALCUN TIPO, esplicite o
+ * implicite. Consultare la Licenza per il testo specifico che regola le
+ * autorizzazioni e le limitazioni previste dalla medesima.
+ ****************************************************************************/
+
+/****************************************************************************
+ * INCLUDE SECTION 
+ ****************************************************************************/
+
+#include <ctype.h>
+#include <getopt.h>
+
+#include "bencher.h"
+
+/****************************************************************************
+ * CODE SECTION
+ ****************************************************************************/
+
+#ifndef BENCH_TARGET
+    #define BENCH_TARGET "unknown"
+#endif
+
+/**
+ * @brief Sum the cycles of a profiled listing.
+ * 
+ * The profiled listing is read like profile_load_cycles() does for the
+ * hot-spot report (see targets/common/_profile.c): each line starts with
+ * the number of cycles spent on it, followed by a colon (or a pipe), and
+ * the total is the sum of all these values. If no line has this form,
+ * the simulator wrote something else and the measure is discarded, 
+ * instead of being taken as zero cycles.
+ * 
+ * @param _profileFileName profiled listing
+ * @return total number of cycles, or -1 if the file is missing or it
+ *         is not in the expected format
+ */
+int bench_profile_cycles( char * _profileFileName ) {
+
+    char raw[MAX_TEMPORARY_STORAGE];
+
+    FILE * handle = fopen( _profileFileName, "rt" );
+    if ( ! handle ) {
+        return -1;
+    }
+
+    double total = 0;
+    int lines = 0;
+
+    while( fgets( raw, MAX_TEMPORARY_STORAGE, handle ) ) {
+        char * text = raw;
+        while( *text == ' ' || *text == '\t' ) {
+            ++text;
+        }
+        if ( isdigit( *text ) ) {
+            double cycles = strtod( text, &text );
+            if ( *text == ':' || *text == '|' ) {
+                total += cycles;
+                ++lines;
+            }
+        }
+    }
+
+    fclose( handle );
+
+    if ( ! lines ) {
+        fprintf( stderr, "Unknown format of profiled listing %s\n", _profileFileName );
+        return -1;
+    }
+
+    return (int) total;
+
+}
+
+/**
+ * @brief Size (in bytes) of a file, or -1 if the file is missing.
+ */
+int bench_file_size( char * _fileName ) {
+
+    FILE * handle = fopen( _fileName, "rb" );
+    if ( ! handle ) {
+        return -1;
+    }
+    fseek( handle, 0, SEEK_END );
+    int size = (int) ftell( handle );
+    fclose( handle );
+
+    return size;
+
+}
+
+/**
+ * @brief Take a value from the operand distribution.
+ * 
+ * The first samples are always the corner cases (0, 1, the maximum and
+ * the middle value for the given width), then a linear congruential
+ * generator with a fixed seed is used, so that every run (and every 
+ * target) sees exactly the same operands.
+ */
+static int bench_sample( int _width, int _index, unsigned int * _seed ) {
+
+    unsigned int mask = ( _width >= 32 ) ? 0xffffffff : ( ( 1U << _width ) - 1 );
+
+    switch( _index ) {
+        case 0:
+            return 0;
+        case 1:
+            return 1;
+        case 2:
+            return (int) mask;
+        case 3:
+            return (int) ( mask >> 1 );
+        default:
+            *_seed = ( *_seed * 1103515245U ) + 12345U;
+            return (int) ( ( ( *_seed >> 8 ) | ( *_seed << 24 ) ) & mask );
+    }
+
+}
+
+/**
+ * @brief Generate, assemble and run the program of a single case.
+ * 
+ * The program contains the setup of the operands and, if `_measure` is 
+ * true, the primitive itself. The difference between the two runs gives
+ * the cost of the primitive, regardless of the startup and setup code.
+ */
+static int bench_measure( BenchCase * _case, int * _values, int _measure, int _cycles, int * _total_cycles, int * _total_bytes ) {
+
+    BenchEnvironment * be = malloc( sizeof( BenchEnvironment ) );
+    memset( be, 0, sizeof( BenchEnvironment ) );
+    memcpy( be->values, _values, sizeof( be->values ) );
+
+    Environment * _environment = &be->environment;
+
+    _environment->sourceFileName = strdup("/tmp/bench.bas");
+    _environment->asmFileName = strdup("/tmp/bench.asm");
+    _environment->debuggerLabelsFileName = strdup("/tmp/bench.lb2");
+
+    bench_prepare( _environment );
+
+    begin_compilation( _environment );
+    _case->setup( be );
+    if ( _measure ) {
+        _case->primitive( be );
+    }
+    bench_halt( _environment );
+    end_compilation( _environment );
+
+    return bench_execute( _cycles, _total_cycles, _total_bytes );
+
+}
+
+/**
+ * @brief Measure a primitive over the whole operand distribution.
+ * 
+ * @return result of the measure, or NULL if the program cannot be 
+ *         assembled or executed
+ */
+static BenchResult * bench_case( BenchCase * _case, int _samples, int _cycles ) {
+
+    BenchResult * result = malloc( sizeof( BenchResult ) );
+    memset( result, 0, sizeof( BenchResult ) );
+    result->name = _case->name;
+    result->width = _case->width;
+    result->min = INT_MAX;
+
+    unsigned int seed = 0x55aa1234;
+    double sum = 0;
+    int i, j;
+
+    for( i=0; i<_samples; ++i ) {
+
+        int values[BENCH_MAX_OPERANDS];
+        for( j=0; j<BENCH_MAX_OPERANDS; ++j ) {
+            values[j] = bench_sample( _case->width, ( i + j ) % ( _samples > 4 ? _samples : 4 ), &seed );
+        }
+
+        int baselineCycles, baselineBytes, measuredCycles, measuredBytes;
+
+        if ( ! bench_measure( _case, values, 0, _cycles, &baselineCycles, &baselineBytes ) ||
+             ! bench_measure( _case, values, 1, _cycles, &measuredCycles, &measuredBytes ) ) {
+            free( result );
+            return NULL;
+        }
+
+        int cycles = measuredCycles - baselineCycles;
+        if ( cycles < result->min ) {
+            result->min = cycles;
+        }
+        if ( cycles > result->max ) {
+            result->max = cycles;
+        }
+        sum += cycles;
+
+        // The size does not depend on the operands: it includes 
+        // any runtime routine deployed by the primitive.
+        result->bytes = measuredBytes - baselineBytes;
+
+        ++result->samples;
+
+    }
+
+    result->avg = sum / result->samples;
+
+    return result;
+
+}
+
+/**
+ * @brief Load a table previously written by this program.
+ */
+static BenchResult * bench_load( char * _fileName ) {
+
+    char raw[MAX_TEMPORARY_STORAGE];
+    char target[MAX_TEMPORARY_STORAGE];
+    char name[MAX_TEMPORARY_STORAGE];
+
+    FILE * handle = fopen( _fileName, "rt" );
+    if ( ! handle ) {
+        fprintf( stderr, "Unable to open baseline %s\n", _fileName );
+        exit( EXIT_FAILURE );
+    }
+
+    BenchResult * first = NULL;
+
+    while( fgets( raw, MAX_TEMPORARY_STORAGE, handle ) ) {
+        BenchResult row;
+        memset( &row, 0, sizeof( BenchResult ) );
+        if ( sscanf( raw, "%s %s %d %d %d %lf %d %d", target, name, &row.width, &row.samples, &row.min, &row.avg, &row.max, &row.bytes ) != 8 ) {
+            // header or malformed line
+            continue;
+        }
+        BenchResult * result = malloc( sizeof( BenchResult ) );
+        memcpy( result, &row, sizeof( BenchResult ) );
+        result->name = strdup( name );
+        result->next = first;
+        first = result;
+    }
+
+    fclose( handle );
+
+    return first;
+
+}
+
+/**
+ * @brief Compare the current results with a baseline.
+ * 
+ * A primitive regresses when the average number of cycles or the size 
+ * grows more than the given tolerance (in percent).
+ * 
+ * @return number of regressions found
+ */
+static int bench_compare( BenchResult * _current, BenchResult * _baseline, double _tolerance ) {
+
+    int regressions = 0;
+
+    while( _current ) {
+
+        BenchResult * base = _baseline;
+        while( base ) {
+            if ( strcmp( base->name, _current->name ) == 0 && base->width == _current->width ) {
+                break;
+            }
+            base = base->next;
+        }
+
+        if ( ! base ) {
+            fprintf( stderr, "NEW        %s/%d: %.1f cycles, %d bytes\n", _current->name, _current->width, _current->avg, _current->bytes );
+        } else {
+            double cyclesLimit = base->avg * ( 1.0 + _tolerance / 100.0 );
+            double bytesLimit = base->bytes * ( 1.0 + _tolerance / 100.0 );
+            if ( _current->avg > cyclesLimit || _current->bytes > bytesLimit ) {
+                fprintf( stderr, "REGRESSION %s/%d: %.1f -> %.1f cycles, %d -> %d bytes\n", _current->name, _current->width, base->avg, _current->avg, base->bytes, _current->bytes );
+                ++regressions;
+            } else if ( _current->avg < base->avg || _current->bytes < base->bytes ) {
+                fprintf( stderr, "IMPROVED   %s/%d: %.1f -> %.1f cycles, %d -> %d bytes\n", _current->name, _current->width, base->avg, _current->avg, base->bytes, _current->bytes );
+            }
+        }
+
+        _current = _current->next;
+
+    }
+
+    return regressions;
+
+}
+
+static void show_usage_and_exit( int _argc, char *_argv[] ) {
+
+    printf("ugBASIC Micro-benchmarks for CPU primitives (target: %s)\n", BENCH_TARGET );
+    printf("-------------------------------------------------------\n\n" );
+    printf("Usage: %s [options]\n\n", _argv[0] );
+    printf("Options and parameters:\n" );
+    printf("\t-o <file>    Output table (default: standard output)\n" );
+    printf("\t-b <file>    Compare with a baseline table; exits with 1\n" );
+    printf("\t             if any primitive regressed\n" );
+    printf("\t-t <perc>    Tolerance (in percent) for the comparison (default: 0)\n" );
+    printf("\t-n <count>   Samples taken from the operand distribution (default: %d)\n", BENCH_DEFAULT_SAMPLES );
+    printf("\t-q <cycles>  Cycles limit for every program (default: %d)\n", BENCH_DEFAULT_CYCLES );
+    printf("\t-f <name>    Measure only primitives whose name contains <name>\n" );
+
+    exit( EXIT_FAILURE );
+
+}
+
+int main( int _argc, char *_argv[] ) {
+
+    char * outputFileName = NULL;
+    char * baselineFileName = NULL;
+    char * filter = NULL;
+    double tolerance = 0;
+    int samples = BENCH_DEFAULT_SAMPLES;
+    int cycles = BENCH_DEFAULT_CYCLES;
+    int opt;
+
+    while ((opt = getopt(_argc, _argv, "o:b:t:n:q:f:h")) != -1) {
+        switch (opt) {
+            case 'o':
+                outputFileName = strdup( optarg );
+                break;
+            case 'b':
+                baselineFileName = strdup( optarg );
+                break;
+            case 't':
+                tolerance = atof( optarg );
+                break;
+            case 'n':
+                samples = atoi( optarg );
+                if ( samples < 1 ) {
+                    samples = 1;
+                }
+                break;
+            case 'q':
+                cycles = atoi( optarg );
+                break;
+            case 'f':
+                filter = strdup( optarg );
+                break;
+            default:
+                show_usage_and_exit( _argc, _argv );
+        }
+    }
+
+    FILE * output = stdout;
+    if ( outputFileName ) {
+        output = fopen( outputFileName, "wt" );
+        if ( ! output ) {
+            fprintf( stderr, "Unable to write %s\n", outputFileName );
+            exit( EXIT_FAILURE );
+        }
+    }
+
+    fprintf( output, "target\tprimitive\twidth\tsamples\tmin\tavg\tmax\tbytes\n" );
+
+    BenchResult * first = NULL;
+    BenchResult * last = NULL;
+    int failures = 0;
+
+    BenchCase * actual = &BENCH_CPU_CASES[0];
+    while( actual->name ) {
+
+        if ( filter && ! strstr( actual->name, filter ) ) {
+            ++actual;
+            continue;
+        }
+
+        BenchResult * result = bench_case( actual, samples, cycles );
+
+        if ( ! result ) {
+            fprintf( stderr, "FAILED     %s/%d\n", actual->name, actual->width );
+            ++failures;
+        } else {
+            fprintf( output, "%s\t%s\t%d\t%d\t%d\t%.1f\t%d\t%d\n", BENCH_TARGET, result->name, result->width, result->samples, result->min, result->avg, result->max, result->bytes );
+            fflush( output );
+            if ( last ) {
+                last->next = result;
+            } else {
+                first = result;
+            }
+            last = result;
+        }
+
+        ++actual;
+
+    }
+
+    if ( outputFileName ) {
+        fclose( output );
+    }
+
+    int regressions = 0;
+
+    if ( baselineFileName ) {
+        regressions = bench_compare( first, bench_load( baselineFileName ), tolerance );
+        fprintf( stderr, "%d regression(s) against %s\n", regressions, baselineFileName );
+    }
+
+    if ( failures ) {
+        return 2;
+    }
+
+    return regressions ? 1 : 0;
+
+}
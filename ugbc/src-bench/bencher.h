@@ -0,0 +1,134 @@
+#ifndef __UGBASICBENCHER__
+#define __UGBASICBENCHER__
+
+/*****************************************************************************
+ * ugBASIC - an isomorphic BASIC language compiler for retrocomputers        *
+ *****************************************************************************
+ * Copyright 2021-2024 Marco Spedaletti (asimov@mclink.it)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *----------------------------------------------------------------------------
+ * Concesso in licenza secondo i termini della Licenza Apache, versione 2.0
+ * (la "Licenza"); è proibito usare questo file se non in conformità alla
+ * Licenza. Una copia della Licenza è disponibile all'indirizzo:
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Se non richiesto dalla legislazione vigente o concordato per iscritto,
+ * il software distribuito nei termini della Licenza è distribuito
+ * "COSÌ COM'È", SENZA GARANZIE O CONDIZIONI DI ALCUN TIPO, esplicite o
+ * implicite. Consultare la Licenza per il testo specifico che regola le
+ * autorizzazioni e le limitazioni previste dalla medesima.
+ ****************************************************************************/
+
+/****************************************************************************
+ * INCLUDE SECTION 
+ ****************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <unistd.h>
+
+#include "../src/ugbc.h"
+
+/****************************************************************************
+ * DECLARATIONS AND DEFINITIONS SECTION 
+ ****************************************************************************/
+
+// Number of samples taken from the operand distribution of every primitive:
+// 0, 1, the maximum value, the middle value and pseudo random values.
+#define BENCH_DEFAULT_SAMPLES       8
+
+// Maximum number of cycles executed by the simulator for a single program.
+#define BENCH_DEFAULT_CYCLES        1000000
+
+// Maximum number of operands of a primitive.
+#define BENCH_MAX_OPERANDS          4
+
+/**
+ * @brief Environment used to generate a single measured program.
+ * 
+ * The setup function of a case defines (and initializes) the operands,
+ * using the values taken from the distribution, and it stores them
+ * into the `operands` array. The primitive function emits only the
+ * code that must be measured, using those operands.
+ */
+typedef struct _BenchEnvironment {
+
+    Environment                 environment;
+
+    /** Operands defined by the setup */
+    Variable                *   operands[BENCH_MAX_OPERANDS];
+
+    /** Values of the operands, taken from the distribution */
+    int                         values[BENCH_MAX_OPERANDS];
+
+} BenchEnvironment;
+
+/**
+ * @brief A single primitive to measure.
+ */
+typedef struct _BenchCase {
+
+    /** Name of the primitive (i.e. "math_mul_8bit_to_16bit") */
+    char *                      name;
+
+    /** Width (in bits) of the operands: it drives the distribution */
+    int                         width;
+
+    /** Define and initialize the operands */
+    void (*setup)( BenchEnvironment * );
+
+    /** Emit the primitive under measure */
+    void (*primitive)( BenchEnvironment * );
+
+} BenchCase;
+
+/**
+ * @brief Result of the measure of a single primitive.
+ */
+typedef struct _BenchResult {
+
+    char *                      name;
+
+    int                         width;
+
+    int                         samples;
+
+    int                         min;
+
+    double                      avg;
+
+    int                         max;
+
+    int                         bytes;
+
+    struct _BenchResult     *   next;
+
+} BenchResult;
+
+extern BenchCase BENCH_CPU_CASES[];
+
+// CPU specific part of the harness (see bencher_6502.c, bencher_z80.c 
+// and bencher_6809.c).
+
+void bench_prepare( Environment * _environment );
+void bench_halt( Environment * _environment );
+int bench_execute( int _cycles, int * _total_cycles, int * _total_bytes );
+
+int bench_profile_cycles( char * _profileFileName );
+int bench_file_size( char * _fileName );
+
+#endif
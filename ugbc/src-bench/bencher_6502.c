@@ -0,0 +1,110 @@
+/*****************************************************************************
+ * ugBASIC - an isomorphic BASIC language compiler for retrocomputers        *
+ *****************************************************************************
+ * Copyright 2021-2024 Marco Spedaletti (asimov@mclink.it)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *----------------------------------------------------------------------------
+ * Concesso in licenza secondo i termini della Licenza Apache, versione 2.0
+ * (la "Licenza"); è proibito usare questo file se non in conformità alla
+ * Licenza. Una copia della Licenza è disponibile all'indirizzo:
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Se non richiesto dalla legislazione vigente o concordato per iscritto,
+ * il software distribuito nei termini della Licenza è distribuito
+ * "COSÌ COM'È", SENZA GARANZIE O CONDIZIONI DI ALCUN TIPO, esplicite o
+ * implicite. Consultare la Licenza per il testo specifico che regola le
+ * autorizzazioni e le limitazioni previste dalla medesima.
+ ****************************************************************************/
+
+/****************************************************************************
+ * INCLUDE SECTION 
+ ****************************************************************************/
+
+#include "bencher.h"
+
+/****************************************************************************
+ * CODE SECTION
+ ****************************************************************************/
+
+#ifdef __UGBC_CPU6502__
+
+#if defined( __c64__ )
+    #define BENCH_ASSEMBLER     "cl65 -l /tmp/bench.lis -Ln /tmp/bench.lbl -g -o /tmp/bench.prg -C /tmp/bench.cfg -u __EXEHDR__ -t c64 /tmp/bench.asm"
+    #define BENCH_SIMULATOR     "run6502 -X 0000 -R 080d -l 07ff /tmp/bench.prg -u /tmp/bench.lis -p /tmp/bench.prof %d"
+    #define BENCH_BINARY        "/tmp/bench.prg"
+#elif defined( __c128__ )
+    #define BENCH_ASSEMBLER     "cl65 -l /tmp/bench.lis -Ln /tmp/bench.lbl -g -o /tmp/bench.prg -C /tmp/bench.cfg -u __EXEHDR__ -t C128 /tmp/bench.asm"
+    #define BENCH_SIMULATOR     "run6502 -X 0000 -R 080d -l 07ff /tmp/bench.prg -u /tmp/bench.lis -p /tmp/bench.prof %d"
+    #define BENCH_BINARY        "/tmp/bench.prg"
+#elif defined( __plus4__ )
+    #define BENCH_ASSEMBLER     "cl65 -l /tmp/bench.lis -Ln /tmp/bench.lbl -g -o /tmp/bench.prg -C /tmp/bench.cfg -u __EXEHDR__ -t plus4 /tmp/bench.asm"
+    #define BENCH_SIMULATOR     "run6502 -X 0000 -R 100d -l 0fff /tmp/bench.prg -u /tmp/bench.lis -p /tmp/bench.prof %d"
+    #define BENCH_BINARY        "/tmp/bench.prg"
+#elif defined( __vic20__ )
+    #define BENCH_ASSEMBLER     "cl65 -l /tmp/bench.lis -Ln /tmp/bench.lbl -g -o /tmp/bench.prg -t vic20 -C /tmp/bench.cfg /tmp/bench.asm"
+    #define BENCH_SIMULATOR     "run6502 -X 0000 -R 2000 -l 11ff /tmp/bench.prg -u /tmp/bench.lis -p /tmp/bench.prof %d"
+    #define BENCH_BINARY        "/tmp/bench.prg"
+#else
+    #define BENCH_ASSEMBLER     "cl65 -l /tmp/bench.lis -Ln /tmp/bench.lbl -g -Os -t atari -C /tmp/bench.cfg /tmp/bench.asm -o /tmp/bench.xex"
+    #define BENCH_SIMULATOR     "run6502 -c atari -X 0000 -R 2000 -l 1ffa /tmp/bench.xex -u /tmp/bench.lis -p /tmp/bench.prof %d"
+    #define BENCH_BINARY        "/tmp/bench.xex"
+#endif
+
+void bench_prepare( Environment * _environment ) {
+
+    _environment->embedded.cpu_fill_blocks = 1;
+    _environment->embedded.cpu_fill = 1;
+    _environment->embedded.cpu_math_div2_8bit = 1;
+    _environment->embedded.cpu_math_mul_8bit_to_16bit = 1;
+    _environment->embedded.cpu_math_div_8bit_to_8bit = 1;
+    _environment->embedded.cpu_math_div2_const_8bit = 1;
+    _environment->embedded.cpu_math_mul2_const_8bit = 1;
+    _environment->embedded.cpu_math_mul_16bit_to_32bit = 1;
+    _environment->embedded.cpu_math_div_16bit_to_16bit = 1;
+    _environment->embedded.cpu_math_div_32bit_to_16bit = 1;
+    _environment->embedded.cpu_random = 1;
+    _environment->embedded.cpu_mem_move = 1;
+
+    _environment->configurationFileName = strdup("/tmp/bench.cfg");
+
+}
+
+void bench_halt( Environment * _environment ) {
+
+    outline0("BRK");
+
+}
+
+int bench_execute( int _cycles, int * _total_cycles, int * _total_bytes ) {
+
+    char commandLine[MAX_TEMPORARY_STORAGE];
+
+    remove( "/tmp/bench.prof" );
+
+    if ( system( BENCH_ASSEMBLER ) ) {
+        return 0;
+    }
+
+    sprintf( commandLine, BENCH_SIMULATOR, _cycles );
+    (void)!system( commandLine );
+
+    *_total_cycles = bench_profile_cycles( "/tmp/bench.prof" );
+    *_total_bytes = bench_file_size( BENCH_BINARY );
+
+    return ( *_total_cycles >= 0 ) && ( *_total_bytes >= 0 );
+
+}
+
+#endif
@@ -0,0 +1,101 @@
+/*****************************************************************************
+ * ugBASIC - an isomorphic BASIC language compiler for retrocomputers        *
+ *****************************************************************************
+ * Copyright 2021-2024 Marco Spedaletti (asimov@mclink.it)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *----------------------------------------------------------------------------
+ * Concesso in licenza secondo i termini della Licenza Apache, versione 2.0
+ * (la "Licenza"); è proibito usare questo file se non in conformità alla
+ * Licenza. Una copia della Licenza è disponibile all'indirizzo:
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Se non richiesto dalla legislazione vigente o concordato per iscritto,
+ * il software distribuito nei termini della Licenza è distribuito
+ * "COSÌ COM'È", SENZA GARANZIE O CONDIZIONI DI ALCUN TIPO, esplicite o
+ * implicite. Consultare la Licenza per il testo specifico che regola le
+ * autorizzazioni e le limitazioni previste dalla medesima.
+ ****************************************************************************/
+
+/****************************************************************************
+ * INCLUDE SECTION 
+ ****************************************************************************/
+
+#include "bencher.h"
+
+/****************************************************************************
+ * CODE SECTION
+ ****************************************************************************/
+
+#ifdef __UGBC_CPU6809__
+
+// The program is assembled and simulated with the same options used by the
+// target_finalize() of each target (see targets/<target>/_build.c). The
+// size includes the header of the executable, that is the same for both 
+// the programs of a measure, so it does not change their difference.
+#if defined( __d32__ ) || defined( __d64__ )
+    #define BENCH_ASSEMBLER     "asm6809 -l /tmp/bench.lis -o /tmp/bench.bin -D -e 10240 /tmp/bench.asm"
+    #define BENCH_SIMULATOR     "run6809 -i /tmp/bench.lis -R 2800 -b -l 27f7 /tmp/bench.bin -p /tmp/bench.prof %d"
+#elif defined( __mo5__ ) || defined( __pc128op__ )
+    #define BENCH_ASSEMBLER     "asm6809 -l /tmp/bench.lis -o /tmp/bench.bin -B -e 10240 /tmp/bench.asm"
+    #define BENCH_SIMULATOR     "run6809 -i /tmp/bench.lis -R 3000 -b -l 3000 /tmp/bench.bin -p /tmp/bench.prof %d"
+#else
+    #define BENCH_ASSEMBLER     "asm6809 -l /tmp/bench.lis -o /tmp/bench.bin -C -e 10752 /tmp/bench.asm"
+    #define BENCH_SIMULATOR     "run6809 -i /tmp/bench.lis -R 2800 -C -l 0 /tmp/bench.bin -p /tmp/bench.prof %d"
+#endif
+#define BENCH_BINARY            "/tmp/bench.bin"
+
+void bench_prepare( Environment * _environment ) {
+
+    _environment->embedded.cpu_fill_blocks = 1;
+    _environment->embedded.cpu_fill = 1;
+    _environment->embedded.cpu_math_div2_8bit = 1;
+    _environment->embedded.cpu_math_mul_8bit_to_16bit = 1;
+    _environment->embedded.cpu_math_div_8bit_to_8bit = 1;
+    _environment->embedded.cpu_math_div2_const_8bit = 1;
+    _environment->embedded.cpu_math_mul_16bit_to_32bit = 1;
+    _environment->embedded.cpu_math_div_16bit_to_16bit = 1;
+    _environment->embedded.cpu_math_div_32bit_to_16bit = 1;
+    _environment->embedded.cpu_random = 1;
+    _environment->embedded.cpu_mem_move = 1;
+
+}
+
+void bench_halt( Environment * _environment ) {
+
+    outline0("SYNC");
+
+}
+
+int bench_execute( int _cycles, int * _total_cycles, int * _total_bytes ) {
+
+    char commandLine[MAX_TEMPORARY_STORAGE];
+
+    remove( "/tmp/bench.prof" );
+
+    if ( system( BENCH_ASSEMBLER ) ) {
+        return 0;
+    }
+
+    sprintf( commandLine, BENCH_SIMULATOR, _cycles );
+    (void)!system( commandLine );
+
+    *_total_cycles = bench_profile_cycles( "/tmp/bench.prof" );
+    *_total_bytes = bench_file_size( BENCH_BINARY );
+
+    return ( *_total_cycles >= 0 ) && ( *_total_bytes >= 0 );
+
+}
+
+#endif
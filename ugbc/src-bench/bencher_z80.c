@@ -0,0 +1,90 @@
+/*****************************************************************************
+ * ugBASIC - an isomorphic BASIC language compiler for retrocomputers        *
+ *****************************************************************************
+ * Copyright 2021-2024 Marco Spedaletti (asimov@mclink.it)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *----------------------------------------------------------------------------
+ * Concesso in licenza secondo i termini della Licenza Apache, versione 2.0
+ * (la "Licenza"); è proibito usare questo file se non in conformità alla
+ * Licenza. Una copia della Licenza è disponibile all'indirizzo:
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Se non richiesto dalla legislazione vigente o concordato per iscritto,
+ * il software distribuito nei termini della Licenza è distribuito
+ * "COSÌ COM'È", SENZA GARANZIE O CONDIZIONI DI ALCUN TIPO, esplicite o
+ * implicite. Consultare la Licenza per il testo specifico che regola le
+ * autorizzazioni e le limitazioni previste dalla medesima.
+ ****************************************************************************/
+
+/****************************************************************************
+ * INCLUDE SECTION 
+ ****************************************************************************/
+
+#include "bencher.h"
+
+/****************************************************************************
+ * CODE SECTION
+ ****************************************************************************/
+
+#ifdef __UGBC_Z80__
+
+// The simulator is called with the same options used by the target_finalize()
+// of each target (see targets/<target>/_build.c), so that the program is
+// loaded and started in the same way as a profiled program.
+#define BENCH_ASSEMBLER         "z88dk-z80asm -l -s -b /tmp/bench.asm"
+#if defined( __coleco__ )
+    #define BENCH_SIMULATOR     "runz80 -c -p /tmp/bench.prof %d -l 8000 /tmp/bench.bin -R 8075 -u /tmp/bench.lis"
+#elif defined( __sc3000__ )
+    #define BENCH_SIMULATOR     "runz80 -c -p /tmp/bench.prof %d -l 0000 /tmp/bench.bin -R 0000 -u /tmp/bench.lis"
+#elif defined( __msx1__ )
+    #define BENCH_SIMULATOR     "runz80 -m -p /tmp/bench.prof %d -l 4000 /tmp/bench.bin -R 4010 -u /tmp/bench.lis"
+#elif defined( __vg5000__ )
+    #define BENCH_SIMULATOR     "runz80 -m -p /tmp/bench.prof %d -l 5000 /tmp/bench.bin -R 5000 -u /tmp/bench.lis"
+#else
+    #define BENCH_SIMULATOR     "runz80 -c -p /tmp/bench.prof %d -l 8000 /tmp/bench.bin -R 8000 -u /tmp/bench.lis"
+#endif
+#define BENCH_BINARY            "/tmp/bench.bin"
+
+void bench_prepare( Environment * _environment ) {
+
+}
+
+void bench_halt( Environment * _environment ) {
+
+    outline0("HALT");
+
+}
+
+int bench_execute( int _cycles, int * _total_cycles, int * _total_bytes ) {
+
+    char commandLine[MAX_TEMPORARY_STORAGE];
+
+    remove( "/tmp/bench.prof" );
+
+    if ( system( BENCH_ASSEMBLER ) ) {
+        return 0;
+    }
+
+    sprintf( commandLine, BENCH_SIMULATOR, _cycles );
+    (void)!system( commandLine );
+
+    *_total_cycles = bench_profile_cycles( "/tmp/bench.prof" );
+    *_total_bytes = bench_file_size( BENCH_BINARY );
+
+    return ( *_total_cycles >= 0 ) && ( *_total_bytes >= 0 );
+
+}
+
+#endif
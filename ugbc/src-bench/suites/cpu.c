@@ -0,0 +1,391 @@
+/*****************************************************************************
+ * ugBASIC - an isomorphic BASIC language compiler for retrocomputers        *
+ *****************************************************************************
+ * Copyright 2021-2024 Marco Spedaletti (asimov@mclink.it)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *----------------------------------------------------------------------------
+ * Concesso in licenza secondo i termini della Licenza Apache, versione 2.0
+ * (la "Licenza"); è proibito usare questo file se non in conformità alla
+ * Licenza. Una copia della Licenza è disponibile all'indirizzo:
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Se non richiesto dalla legislazione vigente o concordato per iscritto,
+ * il software distribuito nei termini della Licenza è distribuito
+ * "COSÌ COM'È", SENZA GARANZIE O CONDIZIONI DI ALCUN TIPO, esplicite o
+ * implicite. Consultare la Licenza per il testo specifico che regola le
+ * autorizzazioni e le limitazioni previste dalla medesima.
+ ****************************************************************************/
+
+/****************************************************************************
+ * INCLUDE SECTION 
+ ****************************************************************************/
+
+#include "../bencher.h"
+
+/****************************************************************************
+ * CODE SECTION
+ ****************************************************************************/
+
+// Size of the memory areas used by mem_move and fill.
+#define BENCH_MEMORY_SIZE       128
+
+//===========================================================================
+
+static void bench_setup_8bit( BenchEnvironment * _be ) {
+
+    Environment * e = &_be->environment;
+
+    _be->operands[0] = variable_define( e, "a", VT_BYTE, _be->values[0] & 0xff );
+    _be->operands[1] = variable_define( e, "b", VT_BYTE, _be->values[1] & 0xff );
+    _be->operands[2] = variable_define( e, "c", VT_WORD, 0 );
+
+}
+
+static void bench_setup_8bit_signed( BenchEnvironment * _be ) {
+
+    Environment * e = &_be->environment;
+
+    _be->operands[0] = variable_define( e, "a", VT_SBYTE, _be->values[0] & 0xff );
+    _be->operands[1] = variable_define( e, "b", VT_SBYTE, _be->values[1] & 0xff );
+    _be->operands[2] = variable_define( e, "c", VT_SWORD, 0 );
+
+}
+
+static void bench_setup_16bit( BenchEnvironment * _be ) {
+
+    Environment * e = &_be->environment;
+
+    _be->operands[0] = variable_define( e, "a", VT_WORD, _be->values[0] & 0xffff );
+    _be->operands[1] = variable_define( e, "b", VT_WORD, _be->values[1] & 0xffff );
+    _be->operands[2] = variable_define( e, "c", VT_DWORD, 0 );
+
+}
+
+static void bench_setup_16bit_signed( BenchEnvironment * _be ) {
+
+    Environment * e = &_be->environment;
+
+    _be->operands[0] = variable_define( e, "a", VT_SWORD, _be->values[0] & 0xffff );
+    _be->operands[1] = variable_define( e, "b", VT_SWORD, _be->values[1] & 0xffff );
+    _be->operands[2] = variable_define( e, "c", VT_SDWORD, 0 );
+
+}
+
+static void bench_setup_32bit( BenchEnvironment * _be ) {
+
+    Environment * e = &_be->environment;
+
+    _be->operands[0] = variable_define( e, "a", VT_DWORD, _be->values[0] );
+    _be->operands[1] = variable_define( e, "b", VT_DWORD, _be->values[1] );
+    _be->operands[2] = variable_define( e, "c", VT_DWORD, 0 );
+
+}
+
+// Divisions: the divisor is never zero, and the 32 bit dividend is
+// divided by a 16 bit divisor.
+
+static void bench_setup_div_8bit( BenchEnvironment * _be ) {
+
+    Environment * e = &_be->environment;
+
+    _be->operands[0] = variable_define( e, "a", VT_BYTE, _be->values[0] & 0xff );
+    _be->operands[1] = variable_define( e, "b", VT_BYTE, ( _be->values[1] & 0xff ) ? ( _be->values[1] & 0xff ) : 1 );
+    _be->operands[2] = variable_define( e, "c", VT_BYTE, 0 );
+    _be->operands[3] = variable_define( e, "d", VT_BYTE, 0 );
+
+}
+
+static void bench_setup_div_16bit( BenchEnvironment * _be ) {
+
+    Environment * e = &_be->environment;
+
+    _be->operands[0] = variable_define( e, "a", VT_WORD, _be->values[0] & 0xffff );
+    _be->operands[1] = variable_define( e, "b", VT_WORD, ( _be->values[1] & 0xffff ) ? ( _be->values[1] & 0xffff ) : 1 );
+    _be->operands[2] = variable_define( e, "c", VT_WORD, 0 );
+    _be->operands[3] = variable_define( e, "d", VT_WORD, 0 );
+
+}
+
+static void bench_setup_div_32bit( BenchEnvironment * _be ) {
+
+    Environment * e = &_be->environment;
+
+    _be->operands[0] = variable_define( e, "a", VT_DWORD, _be->values[0] );
+    _be->operands[1] = variable_define( e, "b", VT_WORD, ( _be->values[1] & 0xffff ) ? ( _be->values[1] & 0xffff ) : 1 );
+    _be->operands[2] = variable_define( e, "c", VT_WORD, 0 );
+    _be->operands[3] = variable_define( e, "d", VT_WORD, 0 );
+
+}
+
+static void bench_setup_memory( BenchEnvironment * _be ) {
+
+    Environment * e = &_be->environment;
+
+    unsigned char buffer[BENCH_MEMORY_SIZE];
+    memset( buffer, _be->values[0] & 0xff, BENCH_MEMORY_SIZE );
+
+    Variable * source = variable_define( e, "source", VT_BUFFER, 0 );
+    variable_store_buffer( e, source->name, buffer, BENCH_MEMORY_SIZE, 0 );
+    Variable * destination = variable_define( e, "destination", VT_BUFFER, 0 );
+    variable_store_buffer( e, destination->name, buffer, BENCH_MEMORY_SIZE, 0 );
+
+    _be->operands[0] = variable_define( e, "a", VT_ADDRESS, 0 );
+    _be->operands[1] = variable_define( e, "b", VT_ADDRESS, 0 );
+    _be->operands[2] = variable_define( e, "c", VT_BYTE, BENCH_MEMORY_SIZE );
+    _be->operands[3] = variable_define( e, "d", VT_BYTE, _be->values[1] & 0xff );
+
+    cpu_addressof_16bit( e, source->realName, _be->operands[0]->realName );
+    cpu_addressof_16bit( e, destination->realName, _be->operands[1]->realName );
+
+}
+
+static void bench_setup_string( BenchEnvironment * _be, VariableType _type ) {
+
+    Environment * e = &_be->environment;
+
+    unsigned char buffer[16];
+    memset( buffer, 0, 16 );
+
+    Variable * string = variable_define( e, "string", VT_BUFFER, 0 );
+    variable_store_buffer( e, string->name, buffer, 16, 0 );
+
+    _be->operands[0] = variable_define( e, "a", _type, _be->values[0] );
+    _be->operands[1] = variable_define( e, "b", VT_ADDRESS, 0 );
+    _be->operands[2] = variable_define( e, "c", VT_BYTE, 0 );
+
+    cpu_addressof_16bit( e, string->realName, _be->operands[1]->realName );
+
+}
+
+static void bench_setup_string_8bit( BenchEnvironment * _be ) {
+    bench_setup_string( _be, VT_BYTE );
+}
+
+static void bench_setup_string_16bit( BenchEnvironment * _be ) {
+    bench_setup_string( _be, VT_WORD );
+}
+
+static void bench_setup_string_32bit( BenchEnvironment * _be ) {
+    bench_setup_string( _be, VT_DWORD );
+}
+
+static void bench_setup_float( BenchEnvironment * _be, FloatTypePrecision _precision ) {
+
+    Environment * e = &_be->environment;
+
+    e->floatType.precision = _precision;
+
+    _be->operands[0] = variable_define( e, "a", VT_FLOAT, 0 );
+    _be->operands[1] = variable_define( e, "b", VT_FLOAT, 0 );
+    _be->operands[2] = variable_define( e, "c", VT_FLOAT, 0 );
+    _be->operands[3] = variable_define( e, "d", VT_SWORD, _be->values[0] & 0xffff );
+
+    // Avoid zero as second operand, so that the division is meaningful.
+    variable_store_float( e, _be->operands[0]->name, ( (double) ( _be->values[0] & 0xffff ) ) / 16.0 );
+    variable_store_float( e, _be->operands[1]->name, ( (double) ( ( _be->values[1] & 0xffff ) | 1 ) ) / 16.0 );
+
+}
+
+static void bench_setup_float_fast( BenchEnvironment * _be ) {
+    bench_setup_float( _be, FT_FAST );
+}
+
+static void bench_setup_float_single( BenchEnvironment * _be ) {
+    bench_setup_float( _be, FT_SINGLE );
+}
+
+static void bench_setup_none( BenchEnvironment * _be ) {
+
+}
+
+//===========================================================================
+
+#define BENCH_OPERAND( n ) _be->operands[n]->realName
+
+static void bench_move_8bit( BenchEnvironment * _be ) {
+    cpu_move_8bit( &_be->environment, BENCH_OPERAND(0), BENCH_OPERAND(1) );
+}
+
+static void bench_move_16bit( BenchEnvironment * _be ) {
+    cpu_move_16bit( &_be->environment, BENCH_OPERAND(0), BENCH_OPERAND(1) );
+}
+
+static void bench_move_32bit( BenchEnvironment * _be ) {
+    cpu_move_32bit( &_be->environment, BENCH_OPERAND(0), BENCH_OPERAND(1) );
+}
+
+static void bench_math_add_8bit( BenchEnvironment * _be ) {
+    cpu_math_add_8bit( &_be->environment, BENCH_OPERAND(0), BENCH_OPERAND(1), BENCH_OPERAND(1) );
+}
+
+static void bench_math_add_16bit( BenchEnvironment * _be ) {
+    cpu_math_add_16bit( &_be->environment, BENCH_OPERAND(0), BENCH_OPERAND(1), BENCH_OPERAND(1) );
+}
+
+static void bench_math_add_32bit( BenchEnvironment * _be ) {
+    cpu_math_add_32bit( &_be->environment, BENCH_OPERAND(0), BENCH_OPERAND(1), BENCH_OPERAND(2) );
+}
+
+static void bench_compare_8bit( BenchEnvironment * _be ) {
+    cpu_compare_8bit( &_be->environment, BENCH_OPERAND(0), BENCH_OPERAND(1), BENCH_OPERAND(2), 1 );
+}
+
+static void bench_compare_16bit( BenchEnvironment * _be ) {
+    cpu_compare_16bit( &_be->environment, BENCH_OPERAND(0), BENCH_OPERAND(1), BENCH_OPERAND(2), 1 );
+}
+
+static void bench_compare_32bit( BenchEnvironment * _be ) {
+    cpu_compare_32bit( &_be->environment, BENCH_OPERAND(0), BENCH_OPERAND(1), BENCH_OPERAND(2), 1 );
+}
+
+static void bench_inc_8bit( BenchEnvironment * _be ) {
+    cpu_inc( &_be->environment, BENCH_OPERAND(0) );
+}
+
+static void bench_inc_16bit( BenchEnvironment * _be ) {
+    cpu_inc_16bit( &_be->environment, BENCH_OPERAND(0) );
+}
+
+static void bench_inc_32bit( BenchEnvironment * _be ) {
+    cpu_inc_32bit( &_be->environment, BENCH_OPERAND(0) );
+}
+
+static void bench_math_mul_8bit_to_16bit( BenchEnvironment * _be ) {
+    cpu_math_mul_8bit_to_16bit( &_be->environment, BENCH_OPERAND(0), BENCH_OPERAND(1), BENCH_OPERAND(2), 0 );
+}
+
+static void bench_math_mul_8bit_to_16bit_signed( BenchEnvironment * _be ) {
+    cpu_math_mul_8bit_to_16bit( &_be->environment, BENCH_OPERAND(0), BENCH_OPERAND(1), BENCH_OPERAND(2), 1 );
+}
+
+static void bench_math_mul_16bit_to_32bit( BenchEnvironment * _be ) {
+    cpu_math_mul_16bit_to_32bit( &_be->environment, BENCH_OPERAND(0), BENCH_OPERAND(1), BENCH_OPERAND(2), 0 );
+}
+
+static void bench_math_mul_16bit_to_32bit_signed( BenchEnvironment * _be ) {
+    cpu_math_mul_16bit_to_32bit( &_be->environment, BENCH_OPERAND(0), BENCH_OPERAND(1), BENCH_OPERAND(2), 1 );
+}
+
+static void bench_math_div_8bit_to_8bit( BenchEnvironment * _be ) {
+    cpu_math_div_8bit_to_8bit( &_be->environment, BENCH_OPERAND(0), BENCH_OPERAND(1), BENCH_OPERAND(2), BENCH_OPERAND(3), 0 );
+}
+
+static void bench_math_div_16bit_to_16bit( BenchEnvironment * _be ) {
+    cpu_math_div_16bit_to_16bit( &_be->environment, BENCH_OPERAND(0), BENCH_OPERAND(1), BENCH_OPERAND(2), BENCH_OPERAND(3), 0 );
+}
+
+static void bench_math_div_32bit_to_16bit( BenchEnvironment * _be ) {
+    cpu_math_div_32bit_to_16bit( &_be->environment, BENCH_OPERAND(0), BENCH_OPERAND(1), BENCH_OPERAND(2), BENCH_OPERAND(3), 0 );
+}
+
+static void bench_math_mul2_const_16bit( BenchEnvironment * _be ) {
+    cpu_math_mul2_const_16bit( &_be->environment, BENCH_OPERAND(0), 3, 0 );
+}
+
+static void bench_math_div2_const_16bit( BenchEnvironment * _be ) {
+    cpu_math_div2_const_16bit( &_be->environment, BENCH_OPERAND(0), 3, 0 );
+}
+
+static void bench_mem_move( BenchEnvironment * _be ) {
+    cpu_mem_move( &_be->environment, BENCH_OPERAND(0), BENCH_OPERAND(1), BENCH_OPERAND(2) );
+}
+
+static void bench_fill( BenchEnvironment * _be ) {
+    cpu_fill( &_be->environment, BENCH_OPERAND(1), BENCH_OPERAND(2), BENCH_OPERAND(3) );
+}
+
+static void bench_number_to_string_8bit( BenchEnvironment * _be ) {
+    cpu_number_to_string( &_be->environment, BENCH_OPERAND(0), BENCH_OPERAND(1), BENCH_OPERAND(2), 8, 0 );
+}
+
+static void bench_number_to_string_16bit( BenchEnvironment * _be ) {
+    cpu_number_to_string( &_be->environment, BENCH_OPERAND(0), BENCH_OPERAND(1), BENCH_OPERAND(2), 16, 0 );
+}
+
+static void bench_number_to_string_32bit( BenchEnvironment * _be ) {
+    cpu_number_to_string( &_be->environment, BENCH_OPERAND(0), BENCH_OPERAND(1), BENCH_OPERAND(2), 32, 0 );
+}
+
+static void bench_float_fast_from_16( BenchEnvironment * _be ) {
+    cpu_float_fast_from_16( &_be->environment, BENCH_OPERAND(3), BENCH_OPERAND(2), 1 );
+}
+
+static void bench_float_fast_add( BenchEnvironment * _be ) {
+    cpu_float_fast_add( &_be->environment, BENCH_OPERAND(0), BENCH_OPERAND(1), BENCH_OPERAND(2) );
+}
+
+static void bench_float_fast_mul( BenchEnvironment * _be ) {
+    cpu_float_fast_mul( &_be->environment, BENCH_OPERAND(0), BENCH_OPERAND(1), BENCH_OPERAND(2) );
+}
+
+static void bench_float_fast_div( BenchEnvironment * _be ) {
+    cpu_float_fast_div( &_be->environment, BENCH_OPERAND(0), BENCH_OPERAND(1), BENCH_OPERAND(2) );
+}
+
+static void bench_float_single_add( BenchEnvironment * _be ) {
+    cpu_float_single_add( &_be->environment, BENCH_OPERAND(0), BENCH_OPERAND(1), BENCH_OPERAND(2) );
+}
+
+static void bench_float_single_mul( BenchEnvironment * _be ) {
+    cpu_float_single_mul( &_be->environment, BENCH_OPERAND(0), BENCH_OPERAND(1), BENCH_OPERAND(2) );
+}
+
+static void bench_float_single_div( BenchEnvironment * _be ) {
+    cpu_float_single_div( &_be->environment, BENCH_OPERAND(0), BENCH_OPERAND(1), BENCH_OPERAND(2) );
+}
+
+static void bench_dsgc( BenchEnvironment * _be ) {
+    cpu_dsgc( &_be->environment );
+}
+
+//===========================================================================
+
+BenchCase BENCH_CPU_CASES[] = {
+    { "move", 8, bench_setup_8bit, bench_move_8bit },
+    { "move", 16, bench_setup_16bit, bench_move_16bit },
+    { "move", 32, bench_setup_32bit, bench_move_32bit },
+    { "math_add", 8, bench_setup_8bit, bench_math_add_8bit },
+    { "math_add", 16, bench_setup_16bit, bench_math_add_16bit },
+    { "math_add", 32, bench_setup_32bit, bench_math_add_32bit },
+    { "compare", 8, bench_setup_8bit, bench_compare_8bit },
+    { "compare", 16, bench_setup_16bit, bench_compare_16bit },
+    { "compare", 32, bench_setup_32bit, bench_compare_32bit },
+    { "inc", 8, bench_setup_8bit, bench_inc_8bit },
+    { "inc", 16, bench_setup_16bit, bench_inc_16bit },
+    { "inc", 32, bench_setup_32bit, bench_inc_32bit },
+    { "math_mul_8bit_to_16bit", 8, bench_setup_8bit, bench_math_mul_8bit_to_16bit },
+    { "math_mul_8bit_to_16bit_signed", 8, bench_setup_8bit_signed, bench_math_mul_8bit_to_16bit_signed },
+    { "math_mul_16bit_to_32bit", 16, bench_setup_16bit, bench_math_mul_16bit_to_32bit },
+    { "math_mul_16bit_to_32bit_signed", 16, bench_setup_16bit_signed, bench_math_mul_16bit_to_32bit_signed },
+    { "math_div_8bit_to_8bit", 8, bench_setup_div_8bit, bench_math_div_8bit_to_8bit },
+    { "math_div_16bit_to_16bit", 16, bench_setup_div_16bit, bench_math_div_16bit_to_16bit },
+    { "math_div_32bit_to_16bit", 32, bench_setup_div_32bit, bench_math_div_32bit_to_16bit },
+    { "math_mul2_const", 16, bench_setup_16bit, bench_math_mul2_const_16bit },
+    { "math_div2_const", 16, bench_setup_16bit, bench_math_div2_const_16bit },
+    { "mem_move", 8, bench_setup_memory, bench_mem_move },
+    { "fill", 8, bench_setup_memory, bench_fill },
+    { "number_to_string", 8, bench_setup_string_8bit, bench_number_to_string_8bit },
+    { "number_to_string", 16, bench_setup_string_16bit, bench_number_to_string_16bit },
+    { "number_to_string", 32, bench_setup_string_32bit, bench_number_to_string_32bit },
+    { "float_fast_from_16", 16, bench_setup_float_fast, bench_float_fast_from_16 },
+    { "float_fast_add", 16, bench_setup_float_fast, bench_float_fast_add },
+    { "float_fast_mul", 16, bench_setup_float_fast, bench_float_fast_mul },
+    { "float_fast_div", 16, bench_setup_float_fast, bench_float_fast_div },
+    { "float_single_add", 16, bench_setup_float_single, bench_float_single_add },
+    { "float_single_mul", 16, bench_setup_float_single, bench_float_single_mul },
+    { "float_single_div", 16, bench_setup_float_single, bench_float_single_div },
+    { "dsgc", 8, bench_setup_none, bench_dsgc },
+    { NULL, 0, NULL, NULL }
+};
@@ -68,8 +68,47 @@ int test_for_step_minus_one_tester( TestEnvironment * _te ) {
 
 }
 
+void test_for_reevaluated_to_payload( TestEnvironment * _te ) {
+
+    Environment * e = &_te->environment;
+
+    // FOR index = a*4+1 TO a*4+10 : a = 0 : INC count : NEXT
+
+    Variable * a = variable_define( e, "a", VT_BYTE, 1 );
+    Variable * count = variable_define( e, "count", VT_BYTE, 0 );
+
+    Variable * from = expression_add( e, expression_mul( e, a->name, parser_adapted_numeric( e, 4 )->name )->name, parser_adapted_numeric( e, 1 )->name );
+    begin_for_to_prepare( e );
+    Variable * to = expression_add( e, expression_mul( e, a->name, parser_adapted_numeric( e, 4 )->name )->name, parser_adapted_numeric( e, 10 )->name );
+    begin_for_step_prepare( e, from->name, to->name, NULL );
+    begin_for_from( e, "index", from->name, to->name, NULL );
+    begin_for_to( e, to->name );
+    begin_for_identifier( e, "index" );
+    variable_reset( e );
+
+    variable_store( e, a->name, 0 );
+    variable_reset( e );
+    variable_increment( e, count->name );
+    variable_reset( e );
+
+    end_for( e );
+
+    _te->trackedVariables[0] = count;
+
+}
+
+int test_for_reevaluated_to_tester( TestEnvironment * _te ) {
+
+    Variable * count = variable_retrieve( &_te->environment, _te->trackedVariables[0]->name );
+
+    // The upper bound drops from 14 to 10 after the first iteration.
+    return count->value == 6;
+
+}
+
 void test_loops( ) {
 
     create_test( "for_step_minus_one", &test_for_step_minus_one_payload, &test_for_step_minus_one_tester );    
+    create_test( "for_reevaluated_to", &test_for_reevaluated_to_payload, &test_for_reevaluated_to_tester );
 
 }
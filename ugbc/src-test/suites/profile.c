@@ -0,0 +1,124 @@
+/*****************************************************************************
+ * ugBASIC - an isomorphic BASIC language compiler for retrocomputers        *
+ *****************************************************************************
+ * Copyright 2021-2024 Marco Spedaletti (asimov@mclink.it)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *----------------------------------------------------------------------------
+ * Concesso in licenza secondo i termini della Licenza Apache, versione 2.0
+ * (la "Licenza"); è proibito usare questo file se non in conformità alla
+ * Licenza. Una copia della Licenza è disponibile all'indirizzo:
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Se non richiesto dalla legislazione vigente o concordato per iscritto,
+ * il software distribuito nei termini della Licenza è distribuito
+ * "COSì COM'è", SENZA GARANZIE O CONDIZIONI DI ALCUN TIPO, esplicite o
+ * implicite. Consultare la Licenza per il testo specifico che regola le
+ * autorizzazioni e le limitazioni previste dalla medesima.
+ ****************************************************************************/
+
+/****************************************************************************
+ * INCLUDE SECTION 
+ ****************************************************************************/
+
+#include "../tester.h"
+
+
+/****************************************************************************
+ * CODE SECTION
+ ****************************************************************************/
+
+void test_profile( ) {
+
+    // Line 1 calls a runtime module (8 cycles) and spends 10 cycles on the 
+    // call itself; line 2 spends 6 cycles. The module is called through
+    // the first of two labels with the same name.
+    FILE * handle = fopen( "profile.asm", "wb" );
+    fputs( "; L:1\n", handle );
+    fputs( "    JSR SUBR\n", handle );
+    fputs( "; L:2\n", handle );
+    fputs( "    LDA #1\n", handle );
+    fputs( "    STA $D020\n", handle );
+    fputs( "; M:mod\n", handle );
+    fputs( "SUBR:\n", handle );
+    fputs( "    LDA #2\n", handle );
+    fputs( "    RTS\n", handle );
+    fputs( "; M:\n", handle );
+    fputs( "; F:other\n", handle );
+    fputs( "SUBR:\n", handle );
+    fputs( "    RTS\n", handle );
+    fclose( handle );
+
+    handle = fopen( "profile.prof", "wb" );
+    fputs( "10:    JSR SUBR\n", handle );
+    fputs( "2:    LDA #1\n", handle );
+    fputs( "4:    STA $D020\n", handle );
+    fputs( "0:SUBR:\n", handle );
+    fputs( "2:    LDA #2\n", handle );
+    fputs( "6:    RTS\n", handle );
+    fputs( "0:SUBR:\n", handle );
+    fputs( "0:    RTS\n", handle );
+    fclose( handle );
+
+    Environment * e = malloc( sizeof( Environment ) );
+    memset( e, 0, sizeof( Environment ) );
+    e->sourceFileName = "profile.bas";
+    e->asmFileName = "profile.asm";
+    e->profileFileName = "profile.prof";
+    e->profileCycles = 24;
+
+    profile_report( e );
+
+    char line[MAX_TEMPORARY_STORAGE];
+    int lines[2] = { -1, -1 }, linesCount = 0, inLines = 0;
+    double inclusives[2] = { 0, 0 };
+    double module = -1;
+
+    handle = fopen( "profile.hotspots", "rt" );
+    if ( ! handle ) {
+        printf( "ERROR: profile: no hot-spot report\n" );
+        exit(0);
+    }
+    while( fgets( line, MAX_TEMPORARY_STORAGE, handle ) ) {
+        char name[MAX_TEMPORARY_STORAGE];
+        int number;
+        double exclusive, inclusive;
+        if ( strncmp( line, "LINE", 4 ) == 0 ) {
+            inLines = 1;
+        } else if ( inLines && linesCount < 2 && sscanf( line, "%d %s %lf %lf", &number, name, &exclusive, &inclusive ) == 4 ) {
+            lines[linesCount] = number;
+            inclusives[linesCount] = inclusive;
+            ++linesCount;
+        } else if ( !inLines && sscanf( line, "%s %lf %lf", name, &exclusive, &inclusive ) == 3 && strcmp( name, "mod" ) == 0 ) {
+            module = exclusive;
+        }
+    }
+    fclose( handle );
+
+    remove( "profile.asm" );
+    remove( "profile.prof" );
+    remove( "profile.hotspots" );
+    remove( "profile.folded" );
+
+    if ( module != 8 ) {
+        printf( "ERROR: profile: module cycles are %f instead of 8\n", module );
+        exit(0);
+    }
+
+    if ( lines[0] != 1 || inclusives[0] != 18 || lines[1] != 2 || inclusives[1] != 6 ) {
+        printf( "ERROR: profile: wrong hot lines (%d:%f, %d:%f)\n", lines[0], inclusives[0], lines[1], inclusives[1] );
+        exit(0);
+    }
+
+}
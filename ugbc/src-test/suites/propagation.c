@@ -0,0 +1,87 @@
+/*****************************************************************************
+ * ugBASIC - an isomorphic BASIC language compiler for retrocomputers        *
+ *****************************************************************************
+ * Copyright 2021-2024 Marco Spedaletti (asimov@mclink.it)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *----------------------------------------------------------------------------
+ * Concesso in licenza secondo i termini della Licenza Apache, versione 2.0
+ * (la "Licenza"); è proibito usare questo file se non in conformità alla
+ * Licenza. Una copia della Licenza è disponibile all'indirizzo:
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Se non richiesto dalla legislazione vigente o concordato per iscritto,
+ * il software distribuito nei termini della Licenza è distribuito
+ * "COSì COM'è", SENZA GARANZIE O CONDIZIONI DI ALCUN TIPO, esplicite o
+ * implicite. Consultare la Licenza per il testo specifico che regola le
+ * autorizzazioni e le limitazioni previste dalla medesima.
+ ****************************************************************************/
+
+/****************************************************************************
+ * INCLUDE SECTION 
+ ****************************************************************************/
+
+#include "../tester.h"
+
+
+/****************************************************************************
+ * CODE SECTION
+ ****************************************************************************/
+
+static int test_propagation_candidate( char * _source, char * _name ) {
+
+    char * filename = "propagation.bas";
+    FILE * handle = fopen( filename, "wb" );
+    fputs( _source, handle );
+    fclose( handle );
+
+    Environment * e = malloc( sizeof( Environment ) );
+    memset( e, 0, sizeof( Environment ) );
+    constant_propagation_scan( e, filename );
+    remove( filename );
+
+    ConstantCandidate * candidate = e->constantCandidates;
+    while( candidate ) {
+        if ( strcmp( candidate->name, _name ) == 0 ) {
+            return 1;
+        }
+        candidate = candidate->next;
+    }
+    return 0;
+
+}
+
+void test_propagation( ) {
+
+    if ( !test_propagation_candidate( "speed = 3\nPRINT speed\n", "speed" ) ) {
+        printf( "ERROR: propagation: speed should be a constant candidate\n" );
+        exit(0);
+    }
+
+    if ( test_propagation_candidate( "x = 5\nPRINT x\n++x\nPRINT x\n", "x" ) ) {
+        printf( "ERROR: propagation: x is incremented by ++x\n" );
+        exit(0);
+    }
+
+    if ( test_propagation_candidate( "x = 5\nPRINT x : -- x\n", "x" ) ) {
+        printf( "ERROR: propagation: x is decremented by --x\n" );
+        exit(0);
+    }
+
+    if ( test_propagation_candidate( "x = 5\nINC x\n", "x" ) ) {
+        printf( "ERROR: propagation: x is incremented by INC x\n" );
+        exit(0);
+    }
+
+}
@@ -0,0 +1,104 @@
+/*****************************************************************************
+ * ugBASIC - an isomorphic BASIC language compiler for retrocomputers        *
+ *****************************************************************************
+ * Copyright 2021-2024 Marco Spedaletti (asimov@mclink.it)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *----------------------------------------------------------------------------
+ * Concesso in licenza secondo i termini della Licenza Apache, versione 2.0
+ * (la "Licenza"); è proibito usare questo file se non in conformità alla
+ * Licenza. Una copia della Licenza è disponibile all'indirizzo:
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Se non richiesto dalla legislazione vigente o concordato per iscritto,
+ * il software distribuito nei termini della Licenza è distribuito
+ * "COSì COM'è", SENZA GARANZIE O CONDIZIONI DI ALCUN TIPO, esplicite o
+ * implicite. Consultare la Licenza per il testo specifico che regola le
+ * autorizzazioni e le limitazioni previste dalla medesima.
+ ****************************************************************************/
+
+/****************************************************************************
+ * INCLUDE SECTION 
+ ****************************************************************************/
+
+#include "../tester.h"
+
+
+/****************************************************************************
+ * CODE SECTION
+ ****************************************************************************/
+
+// Reference search: the scalar affinity against every used tile, where
+// the lowest index wins on ties.
+static int test_tiles_nearest( TileDescriptor * _tile, TileDescriptors * _tiles ) {
+
+    int best = 0xffffff;
+    int bestIndex = -1;
+    int i;
+
+    for(i=0;i<256;++i) {
+        if ( ! _tiles->used[i] ) {
+            continue;
+        }
+        TileDescriptor * descriptor = calculate_tile_descriptor( &_tiles->data[i] );
+        int affinity = calculate_tile_affinity( _tile, descriptor );
+        free( descriptor );
+        if ( affinity < best ) {
+            best = affinity;
+            bestIndex = i;
+        }
+    }
+
+    return bestIndex;
+
+}
+
+void test_tiles( ) {
+
+    char font[200*8];
+    TileData tile;
+    int i, j;
+
+    srand( 42 );
+
+    // Only 200 tiles are used, so that the last lanes of the
+    // search must be skipped.
+    for(i=0;i<sizeof(font);++i) {
+        font[i] = rand() & 0xff;
+    }
+
+    TileDescriptors * tiles = precalculate_tile_descriptors_for_font( font, 200 );
+
+    for(i=0;i<1000;++i) {
+        for(j=0;j<8;++j) {
+            tile.data[j] = ( i < 200 ) ? font[i*8+j] : ( rand() & 0xff );
+        }
+        TileDescriptor * descriptor = calculate_tile_descriptor( &tile );
+        int expected = test_tiles_nearest( descriptor, tiles );
+        int nearest = calculate_nearest_tile( descriptor, tiles );
+        int exact = calculate_exact_tile( descriptor, tiles );
+        free( descriptor );
+        if ( nearest != expected ) {
+            printf( "ERROR: tiles: nearest tile is %d instead of %d\n", nearest, expected );
+            exit(0);
+        }
+        if ( i < 200 && exact != expected ) {
+            printf( "ERROR: tiles: exact tile is %d instead of %d\n", exact, expected );
+            exit(0);
+        }
+    }
+
+    free( tiles );
+
+}
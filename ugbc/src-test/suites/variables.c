@@ -650,6 +650,108 @@ int test_distance_tester( TestEnvironment * _te ) {
     
 }
 
+//===========================================================================
+
+void test_variables_fixed_mul_payload( TestEnvironment * _te ) {
+
+    Environment * e = &_te->environment;
+
+    Variable * a = variable_define( e, "a", VT_FIXED, 0x0180 );
+    Variable * b = variable_define( e, "b", VT_FIXED, 0x0200 );
+    Variable * product = variable_mul( e, a->name, b->name );
+
+    _te->trackedVariables[0] = product;
+
+}
+
+int test_variables_fixed_mul_tester( TestEnvironment * _te ) {
+
+    Variable * product = variable_retrieve( &_te->environment, _te->trackedVariables[0]->name );
+
+    return product->value == 0x0300;
+
+}
+
+void test_variables_cse_payload( TestEnvironment * _te ) {
+
+    Environment * e = &_te->environment;
+
+    Variable * a = variable_define( e, "a", VT_BYTE, 3 );
+    Variable * four = parser_adapted_numeric( e, 4 );
+    Variable * first = expression_mul( e, a->name, four->name );
+    four = parser_adapted_numeric( e, 4 );
+    Variable * second = expression_mul( e, four->name, a->name );
+    Variable * sum = expression_add( e, first->name, second->name );
+
+    _te->trackedVariables[0] = sum;
+    _te->trackedVariables[1] = first;
+    _te->trackedVariables[2] = second;
+
+}
+
+int test_variables_cse_tester( TestEnvironment * _te ) {
+
+    Variable * sum = variable_retrieve( &_te->environment, _te->trackedVariables[0]->name );
+
+    return sum->value == 24 && _te->trackedVariables[1] == _te->trackedVariables[2];
+
+}
+
+void test_variables_concatenation_payload( TestEnvironment * _te ) {
+
+    Environment * e = &_te->environment;
+
+    Variable * a = variable_define( e, "a", VT_DSTRING, 0 );
+    Variable * b = variable_define( e, "b", VT_DSTRING, 0 );
+    Variable * c = variable_define( e, "c", VT_DSTRING, 0 );
+
+    variable_store_string( e, a->name, "AB" );
+    variable_store_string( e, b->name, "CD" );
+    variable_store_string( e, c->name, "EF" );
+
+    Variable * ab = expression_add( e, a->name, b->name );
+    Variable * abc = expression_add( e, ab->name, c->name );
+    variable_move( e, abc->name, a->name );
+
+    _te->trackedVariables[0] = a;
+
+}
+
+int test_variables_concatenation_tester( TestEnvironment * _te ) {
+
+    Variable * a = variable_retrieve( &_te->environment, _te->trackedVariables[0]->name );
+
+    return a->valueString != NULL && strcmp( a->valueString, "ABCDEF" ) == 0;
+
+}
+
+void test_variables_folding_payload( TestEnvironment * _te ) {
+
+    Environment * e = &_te->environment;
+
+    Variable * sum = expression_add( e, parser_adapted_numeric( e, 200 )->name, parser_adapted_numeric( e, 100 )->name );
+    Variable * difference = expression_sub( e, parser_adapted_numeric( e, 5 )->name, parser_adapted_numeric( e, 10 )->name );
+    Variable * product = expression_mul( e, parser_adapted_numeric( e, 200 )->name, parser_adapted_numeric( e, 100 )->name );
+
+    _te->trackedVariables[0] = sum;
+    _te->trackedVariables[1] = difference;
+    _te->trackedVariables[2] = product;
+
+}
+
+int test_variables_folding_tester( TestEnvironment * _te ) {
+
+    Variable * sum = variable_retrieve( &_te->environment, _te->trackedVariables[0]->name );
+    Variable * difference = variable_retrieve( &_te->environment, _te->trackedVariables[1]->name );
+    Variable * product = variable_retrieve( &_te->environment, _te->trackedVariables[2]->name );
+
+    // Folding keeps the type (and the wrap around) of the byte arithmetic.
+    return sum->type == VT_BYTE && sum->value == 44 &&
+        difference->type == VT_BYTE && difference->value == 251 &&
+        product->type == VT_WORD && product->value == 20000;
+
+}
+
 void test_variables( ) {
 
     // create_test( "variables_add01", &test_variables_add01_payload, &test_variables_add01_tester );    
@@ -669,5 +771,9 @@ void test_variables( ) {
     // create_test( "variable_string_right", &test_variable_string_right_payload, &test_variable_string_right_tester );
     // create_test( "distance", &test_distance_payload, &test_distance_tester );
     create_test( "variable_string_mid", &test_variable_string_mid_payload, &test_variable_string_mid_tester );
+    create_test( "variables_fixed_mul", &test_variables_fixed_mul_payload, &test_variables_fixed_mul_tester );
+    create_test( "variables_cse", &test_variables_cse_payload, &test_variables_cse_tester );
+    create_test( "variables_folding", &test_variables_folding_payload, &test_variables_folding_tester );
+    create_test( "variables_concatenation", &test_variables_concatenation_payload, &test_variables_concatenation_tester );
 
 }
@@ -92,4 +92,10 @@ int main( int _argc, char *_argv[] ) {
     
     test_msc1( );
 
+    test_propagation( );
+
+    test_profile( );
+
+    test_tiles( );
+
 }
\ No newline at end of file
@@ -57,6 +57,9 @@ void test_controls( );
 void test_examples( );
 void test_print( );
 void test_msc1( );
+void test_propagation( );
+void test_profile( );
+void test_tiles( );
 
 #if defined( __c64__ )
     #include "tester_c64.h"
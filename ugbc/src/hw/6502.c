@@ -6441,17 +6441,10 @@ void cpu6502_sqroot( Environment * _environment, char * _number, char * _result
 
 }
 
-void emit_segment_if_enough_space( Environment * _environment, int _space ) {
-    MemoryArea * actual = _environment->memoryAreas;
-    int id = 0;
-    while( actual ) {
-        if ( actual->size > _space ) {
-            outhead1(".segment \"MA%3.3x\"", id );
-            actual->size -= _space;
-            break;
-        }
-        actual = actual->next;
-        ++id;
+void emit_segment_if_enough_space( Environment * _environment, char * _name, int _space ) {
+    MemoryArea * area = memory_map_allocate( _environment, _name, _space );
+    if ( area ) {
+        outhead1(".segment \"MA%3.3x\"", area->id );
     }
 }
 
@@ -6460,35 +6453,35 @@ void cpu6502_dstring_vars( Environment * _environment ) {
     int count = _environment->dstring.count == 0 ? DSTRING_DEFAULT_COUNT : _environment->dstring.count;
     int space = _environment->dstring.space == 0 ? DSTRING_DEFAULT_SPACE : _environment->dstring.space;
 
-    emit_segment_if_enough_space( _environment, 1 );
+    emit_segment_if_enough_space( _environment, "MAXSTRINGS", 1 );
     outhead1("MAXSTRINGS:                   .BYTE %d,0", count );
     outhead0(".segment \"CODE\"" );
 
-    emit_segment_if_enough_space( _environment, count );
+    emit_segment_if_enough_space( _environment, "DESCRIPTORS_STATUS", count );
     outhead1("DESCRIPTORS_STATUS:           .RES %d,0", count );
     outhead0(".segment \"CODE\"" );
 
-    emit_segment_if_enough_space( _environment, count );
+    emit_segment_if_enough_space( _environment, "DESCRIPTORS_ADDRESS_LO", count );
     outhead1("DESCRIPTORS_ADDRESS_LO:       .RES %d,0", count );
     outhead0(".segment \"CODE\"" );
 
-    emit_segment_if_enough_space( _environment, count );
+    emit_segment_if_enough_space( _environment, "DESCRIPTORS_ADDRESS_HI", count );
     outhead1("DESCRIPTORS_ADDRESS_HI:       .RES %d,0", count );
     outhead0(".segment \"CODE\"" );
 
-    emit_segment_if_enough_space( _environment, count );
+    emit_segment_if_enough_space( _environment, "DESCRIPTORS_SIZE", count );
     outhead1("DESCRIPTORS_SIZE:             .RES %d,0", count );
     outhead0(".segment \"CODE\"" );
 
-    emit_segment_if_enough_space( _environment, space );
+    emit_segment_if_enough_space( _environment, "WORKING", space );
     outhead1("WORKING:                      .RES %d,0", space );
     outhead0(".segment \"CODE\"" );
 
-    emit_segment_if_enough_space( _environment, space );
+    emit_segment_if_enough_space( _environment, "TEMPORARY", space );
     outhead1("TEMPORARY:                    .RES %d,0", space );
     outhead0(".segment \"CODE\"" );
 
-    emit_segment_if_enough_space( _environment, 2 );
+    emit_segment_if_enough_space( _environment, "FREE_STRING", 4 );
     outhead1("FREE_STRING:                  .WORD %d,0", space );
     outhead0(".segment \"CODE\"" );
 
@@ -6502,15 +6495,21 @@ void cpu6502_protothread_vars( Environment * _environment ) {
     outhead1("PROTOTHREADLC:      .RES        %d,0", count );
     outhead1("PROTOTHREADST:      .RES        %d,0", count );
     outhead0("PROTOTHREADCT:      .BYTE       0" );
-    outhead0("PROTOTHREADLOOP:");
-
-    for( int i=0; i<count; ++i ) {
-        outline1("LDX #%d", i );
-        outline0("STX PROTOTHREADCT" );
-        outline0("JSR PROTOTHREADVOID" );
-    }
-
-    outline0("RTS" );
+    outhead1("PROTOTHREADCOUNT:   .BYTE       %d", count );
+    outhead1("PROTOTHREADAL:      .RES        %d,0", count );
+    outhead1("PROTOTHREADAH:      .RES        %d,0", count );
+    outhead1("PROTOTHREADRL:      .RES        %d,0", count );
+    outhead1("PROTOTHREADRQ:      .RES        %d,0", count );
+    outhead0("PROTOTHREADRC:      .BYTE       0" );
+    outhead0("PROTOTHREADRI:      .BYTE       0" );
+    outhead0("PROTOTHREADWI:      .BYTE       0" );
+    outhead1("PROTOTHREADWL:      .RES        %d,0", count );
+    outhead1("PROTOTHREADWH:      .RES        %d,0", count );
+    outhead1("PROTOTHREADSQ:      .RES        %d,0", count );
+    outhead0("PROTOTHREADSC:      .BYTE       0" );
+    outhead0("PROTOTHREADSW:      .BYTE       0" );
+    outhead0("PROTOTHREADNOW:     .WORD       0" );
+    outhead0("PROTOTHREADPTR:     .WORD       0" );
     
 }
 
@@ -6607,6 +6606,20 @@ void cpu6502_protothread_get_state( Environment * _environment, char * _index, c
 
 }
 
+void cpu6502_protothread_sleep( Environment * _environment, char * _index, char * _ticks ) {
+
+    deploy_with_vars( protothread, src_hw_6502_protothread_asm, cpu_protothread_vars );
+
+    outline1("LDA %s", _ticks );
+    outline0("STA TMPPTR" );
+    outline1("LDA %s", address_displacement(_environment, _ticks, "1") );
+    outline0("STA TMPPTR+1" );
+    outline1("LDY %s", _index );
+
+    outline0("JSR PROTOTHREADSLEEP" );
+
+}
+
 void cpu6502_protothread_current( Environment * _environment, char * _current ) {
 
     deploy_with_vars( protothread, src_hw_6502_protothread_asm, cpu_protothread_vars );
@@ -6616,6 +6629,598 @@ void cpu6502_protothread_current( Environment * _environment, char * _current )
 
 }
 
+/* Pointers saved by the timer manager, in the order they are pushed. */
+static char * cpu6502_timer_context_pointers[] = { "TMPPTR", "TMPPTR2", "PLOTDEST", "PLOTCDEST" };
+
+#define CPU6502_TIMER_CONTEXT_POINTERS ( sizeof( cpu6502_timer_context_pointers ) / sizeof( char * ) )
+
+/* Variable definitions where the zero page of each target is laid out. */
+#if defined(__atari__) || defined(__atarixl__)
+    #define CPU6502_TIMER_CONTEXT_VARS { src_hw_atari_vars_asm, src_hw_gtia_vars_asm, src_hw_antic_vars_asm, src_hw_pokey_vars_asm }
+    #define CPU6502_TIMER_CONTEXT_VARS_LEN { &src_hw_atari_vars_asm_len, &src_hw_gtia_vars_asm_len, &src_hw_antic_vars_asm_len, &src_hw_pokey_vars_asm_len }
+#elif defined(__c64__)
+    #define CPU6502_TIMER_CONTEXT_VARS { src_hw_c64_vars_asm, src_hw_vic2_vars_asm, src_hw_sid_vars_asm }
+    #define CPU6502_TIMER_CONTEXT_VARS_LEN { &src_hw_c64_vars_asm_len, &src_hw_vic2_vars_asm_len, &src_hw_sid_vars_asm_len }
+#elif defined(__c128__)
+    #define CPU6502_TIMER_CONTEXT_VARS { src_hw_c128_vars_asm, src_hw_vic2_vars_asm, src_hw_vdc_vars_asm, src_hw_sid_vars_asm }
+    #define CPU6502_TIMER_CONTEXT_VARS_LEN { &src_hw_c128_vars_asm_len, &src_hw_vic2_vars_asm_len, &src_hw_vdc_vars_asm_len, &src_hw_sid_vars_asm_len }
+#elif defined(__plus4__)
+    #define CPU6502_TIMER_CONTEXT_VARS { src_hw_plus4_vars_asm, src_hw_ted_vars_asm }
+    #define CPU6502_TIMER_CONTEXT_VARS_LEN { &src_hw_plus4_vars_asm_len, &src_hw_ted_vars_asm_len }
+#elif defined(__vic20__)
+    #define CPU6502_TIMER_CONTEXT_VARS { src_hw_vic20_vars_asm, src_hw_vic1_vars_asm }
+    #define CPU6502_TIMER_CONTEXT_VARS_LEN { &src_hw_vic20_vars_asm_len, &src_hw_vic1_vars_asm_len }
+#endif
+
+typedef struct _Cpu6502Symbol {
+
+    char name[MAX_TEMPORARY_STORAGE];
+
+    int address;
+
+} Cpu6502Symbol;
+
+/* Names that share a byte with each of the saved pointers (see below). */
+static char ** cpu6502_timer_context_aliases[CPU6502_TIMER_CONTEXT_POINTERS];
+static int cpu6502_timer_context_aliases_count[CPU6502_TIMER_CONTEXT_POINTERS];
+static int cpu6502_timer_context_aliases_ready = 0;
+
+/* Resolve a term of a symbol definition ($hex, decimal or a known symbol). */
+static int cpu6502_symbol_term( Cpu6502Symbol * _symbols, int _count, char ** _p ) {
+
+    char * p = *_p;
+    int value = -1;
+
+    if ( *p == '$' ) {
+        ++p;
+        if ( isxdigit( *p ) ) {
+            value = (int) strtol( p, &p, 16 );
+        }
+    } else if ( isdigit( *p ) ) {
+        value = (int) strtol( p, &p, 10 );
+    } else if ( isalpha( *p ) || *p == '_' ) {
+        char * start = p;
+        while( isalnum( *p ) || *p == '_' ) {
+            ++p;
+        }
+        int i;
+        for( i=0; i<_count; ++i ) {
+            if ( strlen( _symbols[i].name ) == ( p - start ) && strncasecmp( _symbols[i].name, start, p - start ) == 0 ) {
+                value = _symbols[i].address;
+                break;
+            }
+        }
+    }
+
+    *_p = p;
+
+    return value;
+
+}
+
+/**
+ * @brief Find every symbol that shares a byte with the saved pointers
+ * 
+ * The vars.asm of each target gives more than one name to the same zero
+ * page bytes (i.e. PLOTDEST and MATHPTR7 on the Atari), so comparing the
+ * names is not enough. Definitions in the form "NAME = value" are resolved
+ * to an address, and every name that lands on a saved pointer (or on the
+ * byte before it, since it could be used as a word) is taken as an alias.
+ * 
+ * @param _environment Current calling environment
+ */
+static void cpu6502_timer_context_aliases_prepare( Environment * _environment ) {
+
+    int i, j, k;
+
+    cpu6502_timer_context_aliases_ready = 1;
+
+#ifdef CPU6502_TIMER_CONTEXT_VARS
+
+    unsigned char * texts[] = CPU6502_TIMER_CONTEXT_VARS;
+    unsigned int * lengths[] = CPU6502_TIMER_CONTEXT_VARS_LEN;
+
+    int size = 64, count = 0;
+    Cpu6502Symbol * symbols = malloc( sizeof( Cpu6502Symbol ) * size );
+
+    for( i=0; i<( sizeof( texts ) / sizeof( unsigned char * ) ); ++i ) {
+
+        char * text = malloc( *lengths[i] + 1 );
+        memcpy( text, texts[i], *lengths[i] );
+        text[*lengths[i]] = 0;
+
+        char * line = strtok( text, "\r\n" );
+        while( line ) {
+            char * p = line;
+            while( *p == ' ' || *p == '\t' ) {
+                ++p;
+            }
+            char * start = p;
+            while( isalnum( *p ) || *p == '_' ) {
+                ++p;
+            }
+            int nameLength = p - start;
+            while( *p == ' ' || *p == '\t' ) {
+                ++p;
+            }
+            if ( nameLength > 0 && nameLength < MAX_TEMPORARY_STORAGE && *p == '=' ) {
+                ++p;
+                while( *p == ' ' || *p == '\t' ) {
+                    ++p;
+                }
+                int address = cpu6502_symbol_term( symbols, count, &p );
+                if ( address >= 0 && ( *p == '+' || *p == '-' ) ) {
+                    int sign = ( *p == '+' ) ? 1 : -1;
+                    ++p;
+                    int offset = cpu6502_symbol_term( symbols, count, &p );
+                    address = ( offset >= 0 ) ? address + sign * offset : -1;
+                }
+                if ( address >= 0 ) {
+                    if ( count == size ) {
+                        size *= 2;
+                        symbols = realloc( symbols, sizeof( Cpu6502Symbol ) * size );
+                    }
+                    memcpy( symbols[count].name, start, nameLength );
+                    symbols[count].name[nameLength] = 0;
+                    symbols[count].address = address;
+                    ++count;
+                }
+            }
+            line = strtok( NULL, "\r\n" );
+        }
+
+        free( text );
+
+    }
+
+    for( i=0; i<CPU6502_TIMER_CONTEXT_POINTERS; ++i ) {
+        for( j=0; j<count; ++j ) {
+            if ( strcasecmp( symbols[j].name, cpu6502_timer_context_pointers[i] ) == 0 ) {
+                break;
+            }
+        }
+        if ( j == count ) {
+            continue;
+        }
+        int address = symbols[j].address;
+        for( k=0; k<count; ++k ) {
+            if ( k != j && symbols[k].address >= ( address - 1 ) && symbols[k].address <= ( address + 1 ) ) {
+                cpu6502_timer_context_aliases[i] = realloc( cpu6502_timer_context_aliases[i], sizeof( char * ) * ( cpu6502_timer_context_aliases_count[i] + 1 ) );
+                cpu6502_timer_context_aliases[i][cpu6502_timer_context_aliases_count[i]] = strdup( symbols[k].name );
+                ++cpu6502_timer_context_aliases_count[i];
+            }
+        }
+    }
+
+    free( symbols );
+
+#endif
+
+}
+
+/**
+ * @brief Decode a line of generated code for the timer manager context
+ * 
+ * This function tells how the given instruction moves the program counter
+ * and, in _clobbers, which of the pointers saved by the timer manager
+ * it uses (bit n for the n-th of cpu6502_timer_context_pointers), also
+ * through any other name given to the same bytes. 
+ * Registers A, X and Y are always saved.
+ * 
+ * @param _environment Current calling environment
+ * @param _mnemonic Instruction
+ * @param _operand Operand of the instruction (can be empty)
+ * @param _clobbers Pointers used (updated)
+ * @param _target Where to look for the target label, if any
+ * @return How the instruction moves the program counter
+ */
+CodeLineFlow cpu6502_code_line( Environment * _environment, char * _mnemonic, char * _operand, int * _clobbers, char ** _target ) {
+
+    int i, j;
+
+    if ( ! cpu6502_timer_context_aliases_ready ) {
+        cpu6502_timer_context_aliases_prepare( _environment );
+    }
+
+    for( i=0; i<CPU6502_TIMER_CONTEXT_POINTERS; ++i ) {
+        if ( assemblyLineHasToken( _operand, cpu6502_timer_context_pointers[i] ) ) {
+            *_clobbers |= ( 1 << i );
+            continue;
+        }
+        for( j=0; j<cpu6502_timer_context_aliases_count[i]; ++j ) {
+            if ( assemblyLineHasToken( _operand, cpu6502_timer_context_aliases[i][j] ) ) {
+                *_clobbers |= ( 1 << i );
+                break;
+            }
+        }
+    }
+
+    *_target = _operand;
+
+    if ( strcasecmp( _mnemonic, "RTS" ) == 0 || strcasecmp( _mnemonic, "RTI" ) == 0 ) {
+        return CLF_RETURN;
+    }
+
+    // "*+n" is a jump inside the same routine, that we are reading anyway.
+    if ( *_operand == '*' ) {
+        return CLF_NONE;
+    }
+
+    if ( strcasecmp( _mnemonic, "JSR" ) == 0 ) {
+        return CLF_CALL;
+    }
+
+    if ( strcasecmp( _mnemonic, "JMP" ) == 0 ) {
+        return ( *_operand == '(' ) ? CLF_UNKNOWN : CLF_JUMP;
+    }
+
+    if ( strlen( _mnemonic ) == 3 && toupper( *_mnemonic ) == 'B' && 
+            strcasecmp( _mnemonic, "BIT" ) != 0 && strcasecmp( _mnemonic, "BRK" ) != 0 ) {
+        return CLF_BRANCH;
+    }
+
+    return CLF_NONE;
+
+}
+
+/**
+ * @brief Emit the context save (or restore) of the timer manager
+ * 
+ * @param _environment Current calling environment
+ * @param _clobbers Pointers to save (see cpu6502_code_line())
+ * @param _save 1 to emit the save, 0 to emit the restore
+ */
+void cpu6502_timer_context( Environment * _environment, int _clobbers, int _save ) {
+
+    int i;
+
+    if ( _save ) {
+        for( i=0; i<CPU6502_TIMER_CONTEXT_POINTERS; ++i ) {
+            if ( _clobbers & ( 1 << i ) ) {
+                outline1("LDA %s", cpu6502_timer_context_pointers[i] );
+                outline0("PHA" );
+                outline1("LDA %s+1", cpu6502_timer_context_pointers[i] );
+                outline0("PHA" );
+            }
+        }
+    } else {
+        for( i=CPU6502_TIMER_CONTEXT_POINTERS-1; i>=0; --i ) {
+            if ( _clobbers & ( 1 << i ) ) {
+                outline0("PLA" );
+                outline1("STA %s+1", cpu6502_timer_context_pointers[i] );
+                outline0("PLA" );
+                outline1("STA %s", cpu6502_timer_context_pointers[i] );
+            }
+        }
+    }
+
+}
+
+#define CPU6502_TRACKED_A       0
+#define CPU6502_TRACKED_X       1
+#define CPU6502_TRACKED_Y       2
+
+/* Split a line of generated code into mnemonic and operand (without spaces). */
+static void cpu6502_register_track_split( char * _line, char * _mnemonic, char * _operand ) {
+
+    char * p = _line;
+
+    while( *p == ' ' || *p == '\t' ) {
+        ++p;
+    }
+    while( *p && *p != ' ' && *p != '\t' && *p != ';' ) {
+        *_mnemonic++ = toupper( *p++ );
+    }
+    *_mnemonic = 0;
+    while( *p && *p != ';' && *p != '\r' && *p != '\n' ) {
+        if ( *p != ' ' && *p != '\t' ) {
+            *_operand++ = *p;
+        }
+        ++p;
+    }
+    *_operand = 0;
+
+}
+
+/*
+ * Normalize an operand into _key. Returns 1 if the operand is an immediate,
+ * 2 if it is a variable that can be tracked, 3 if it is a symbol that is
+ * not a variable (a pointer of the runtime, a register of some chip, ...)
+ * and 0 otherwise. Variables at an absolute address are never tracked, 
+ * since they could be a register of some chip.
+ */
+static int cpu6502_register_track_operand( Environment * _environment, char * _operand, char * _key ) {
+
+    char name[MAX_TRACKED_OPERAND];
+    char * p = _operand;
+    int offset = 0;
+
+    if ( strlen( _operand ) >= MAX_TRACKED_OPERAND ) {
+        return 0;
+    }
+
+    if ( *p == '#' ) {
+        ++p;
+        if ( *p == '$' && p[1] && strspn( p+1, "0123456789ABCDEFabcdef" ) == strlen( p+1 ) ) {
+            sprintf( _key, "#%d", (int) ( strtol( p+1, NULL, 16 ) & 0xff ) );
+        } else if ( *p && strspn( p, "0123456789" ) == strlen( p ) ) {
+            sprintf( _key, "#%d", atoi( p ) & 0xff );
+        } else {
+            strcpy( _key, _operand );
+        }
+        return 1;
+    }
+
+    if ( *p != '_' && !isalpha( *p ) ) {
+        return 0;
+    }
+
+    while( *p == '_' || isalnum( *p ) ) {
+        ++p;
+    }
+    memcpy( name, _operand, p - _operand );
+    name[p - _operand] = 0;
+
+    if ( *p == '+' && p[1] && strspn( p+1, "0123456789" ) == strlen( p+1 ) ) {
+        offset = atoi( p+1 );
+    } else if ( *p ) {
+        return 0;
+    }
+
+    Variable * variable = variable_retrieve_by_realname( _environment, name );
+
+    if ( variable && variable->absoluteAddress ) {
+        return 0;
+    }
+
+    if ( offset ) {
+        sprintf( _key, "%s+%d", name, offset );
+    } else {
+        strcpy( _key, name );
+    }
+
+    return variable ? 2 : 3;
+
+}
+
+/* Tell which register is loaded (or stored) by the given mnemonic. */
+static int cpu6502_register_track_register( char * _mnemonic, char * _prefix ) {
+
+    if ( strlen( _mnemonic ) != 3 || strncmp( _mnemonic, _prefix, 2 ) != 0 ) {
+        return -1;
+    }
+
+    switch( _mnemonic[2] ) {
+        case 'A':
+            return CPU6502_TRACKED_A;
+        case 'X':
+            return CPU6502_TRACKED_X;
+        case 'Y':
+            return CPU6502_TRACKED_Y;
+    }
+
+    return -1;
+
+}
+
+/* The memory has been changed by a store (or a read-modify-write). */
+static void cpu6502_register_track_store( Environment * _environment, RegisterTracker * _tracker, char * _operand, char * _key ) {
+
+    switch( cpu6502_register_track_operand( _environment, _operand, _key ) ) {
+        case 2:
+            register_tracker_forget( _tracker, _key );
+            break;
+        case 3:
+            // Not a variable (anymore): it cannot change any of them.
+            register_tracker_forget( _tracker, _key );
+            *_key = 0;
+            break;
+        default:
+            // Indexed, indirect or computed address: it could be anything.
+            register_tracker_forget( _tracker, NULL );
+            *_key = 0;
+            break;
+    }
+
+}
+
+/*
+ * Called before a load of A: if the last two instructions were "LDA #n" 
+ * and "STA m", and X (or Y) already holds #n, the load becomes useless 
+ * and the store is done by "STX m" (or "STY m"). Returns the number of
+ * characters removed from the output.
+ */
+static int cpu6502_register_track_fold( Environment * _environment, RegisterTracker * _tracker ) {
+
+    char line[MAX_TEMPORARY_STORAGE];
+    char mnemonic[MAX_TEMPORARY_STORAGE];
+    char operand[MAX_TEMPORARY_STORAGE];
+    char key[MAX_TRACKED_OPERAND];
+    int size;
+    char * buffer = buffered_get_output( &size );
+    int source = -1;
+
+    if ( _tracker->previousStart < 0 || _tracker->lastStart < 0 ||
+            ( _tracker->previousEnd - _tracker->previousStart ) >= MAX_TEMPORARY_STORAGE ||
+            ( _tracker->lastEnd - _tracker->lastStart ) >= MAX_TEMPORARY_STORAGE ) {
+        return 0;
+    }
+
+    memcpy( line, &buffer[_tracker->previousStart], _tracker->previousEnd - _tracker->previousStart );
+    line[_tracker->previousEnd - _tracker->previousStart] = 0;
+    cpu6502_register_track_split( line, mnemonic, operand );
+    if ( strcmp( mnemonic, "LDA" ) != 0 || cpu6502_register_track_operand( _environment, operand, key ) != 1 ) {
+        return 0;
+    }
+
+    if ( strcmp( _tracker->content[CPU6502_TRACKED_X], key ) == 0 ) {
+        source = CPU6502_TRACKED_X;
+    } else if ( strcmp( _tracker->content[CPU6502_TRACKED_Y], key ) == 0 ) {
+        source = CPU6502_TRACKED_Y;
+    } else {
+        return 0;
+    }
+
+    memcpy( line, &buffer[_tracker->lastStart], _tracker->lastEnd - _tracker->lastStart );
+    line[_tracker->lastEnd - _tracker->lastStart] = 0;
+    cpu6502_register_track_split( line, mnemonic, operand );
+    // STX and STY have no absolute indexed (nor indirect) addressing.
+    if ( strcmp( mnemonic, "STA" ) != 0 || !*operand || strchr( operand, ',' ) || strchr( operand, '(' ) ) {
+        return 0;
+    }
+
+    char * p = &buffer[_tracker->lastStart];
+    while( *p == ' ' || *p == '\t' ) {
+        ++p;
+    }
+    p[2] = ( source == CPU6502_TRACKED_X ) ? 'X' : 'Y';
+
+    int removed = _tracker->previousEnd - _tracker->previousStart;
+    buffered_replace_output( _tracker->previousStart, _tracker->previousEnd, "", 0 );
+    _tracker->generation = bufferOutputGeneration;
+    _tracker->offset -= removed;
+    if ( _environment->producedAssemblyLines > 0 ) {
+        --_environment->producedAssemblyLines;
+    }
+
+    strcpy( _tracker->alias[source], _tracker->alias[CPU6502_TRACKED_A] );
+    _tracker->previousStart = -1;
+    _tracker->previousEnd = -1;
+    _tracker->lastStart -= removed;
+    _tracker->lastEnd -= removed;
+
+    return removed;
+
+}
+
+/**
+ * @brief Track the content of A, X and Y on a line of generated code
+ * 
+ * This function updates what A, X and Y are known to hold after the given
+ * instruction. Anything that cannot be followed (calls, jumps, unknown 
+ * instructions) invalidates everything. A load is redundant if the 
+ * register already holds the same constant (or memory) and the flags 
+ * already reflect it, since a branch could follow.
+ * 
+ * @param _environment Current calling environment
+ * @param _tracker Tracker to update
+ * @param _line Line of generated code (not a label)
+ * @param _start Offset of the line in the output
+ * @param _end Offset of the next line in the output
+ * @return 1 if the line is redundant, 0 otherwise
+ */
+int cpu6502_register_track( Environment * _environment, RegisterTracker * _tracker, char * _line, int _start, int _end ) {
+
+    char mnemonic[MAX_TEMPORARY_STORAGE];
+    char operand[MAX_TEMPORARY_STORAGE];
+    char key[MAX_TRACKED_OPERAND];
+    int reg;
+
+    if ( strchr( _line, '"' ) || strchr( _line, '\'' ) || strchr( _line, ':' ) ) {
+        register_tracker_reset( _tracker );
+        return 0;
+    }
+
+    cpu6502_register_track_split( _line, mnemonic, operand );
+
+    if ( ( reg = cpu6502_register_track_register( mnemonic, "LD" ) ) >= 0 ) {
+        int kind = cpu6502_register_track_operand( _environment, operand, key );
+        if ( ( kind == 1 || kind == 2 ) && _tracker->flags == reg &&
+                ( strcmp( _tracker->content[reg], key ) == 0 || strcmp( _tracker->alias[reg], key ) == 0 ) ) {
+            return 1;
+        }
+        if ( reg == CPU6502_TRACKED_A ) {
+            int removed = cpu6502_register_track_fold( _environment, _tracker );
+            _start -= removed;
+            _end -= removed;
+        }
+        if ( kind == 1 || kind == 2 ) {
+            strcpy( _tracker->content[reg], key );
+        } else {
+            _tracker->content[reg][0] = 0;
+        }
+        _tracker->alias[reg][0] = 0;
+        _tracker->flags = reg;
+    } else if ( ( reg = cpu6502_register_track_register( mnemonic, "ST" ) ) >= 0 ) {
+        cpu6502_register_track_store( _environment, _tracker, operand, key );
+        if ( *key && strcmp( _tracker->content[reg], key ) != 0 ) {
+            strcpy( _tracker->alias[reg], key );
+        }
+    } else if ( strlen( mnemonic ) == 3 && mnemonic[0] == 'T' && 
+            strchr( "AXYS", mnemonic[1] ) && strchr( "AXYS", mnemonic[2] ) ) {
+        int source = mnemonic[1] == 'A' ? CPU6502_TRACKED_A : ( mnemonic[1] == 'X' ? CPU6502_TRACKED_X : CPU6502_TRACKED_Y );
+        int destination = mnemonic[2] == 'A' ? CPU6502_TRACKED_A : ( mnemonic[2] == 'X' ? CPU6502_TRACKED_X : CPU6502_TRACKED_Y );
+        if ( mnemonic[2] == 'S' ) {
+            // TXS: no register nor flag is changed.
+        } else if ( mnemonic[1] == 'S' ) {
+            _tracker->content[destination][0] = 0;
+            _tracker->alias[destination][0] = 0;
+            _tracker->flags = destination;
+        } else {
+            strcpy( _tracker->content[destination], _tracker->content[source] );
+            strcpy( _tracker->alias[destination], _tracker->alias[source] );
+            _tracker->flags = destination;
+        }
+    } else if ( strlen( mnemonic ) == 3 && ( strncmp( mnemonic, "IN", 2 ) == 0 || strncmp( mnemonic, "DE", 2 ) == 0 ) &&
+            ( mnemonic[2] == 'X' || mnemonic[2] == 'Y' ) ) {
+        reg = ( mnemonic[2] == 'X' ) ? CPU6502_TRACKED_X : CPU6502_TRACKED_Y;
+        char * value = _tracker->content[reg];
+        if ( value[0] == '#' && value[1] && strspn( value+1, "0123456789" ) == strlen( value+1 ) ) {
+            sprintf( value, "#%d", ( atoi( value+1 ) + ( mnemonic[0] == 'I' ? 1 : -1 ) ) & 0xff );
+        } else {
+            value[0] = 0;
+        }
+        _tracker->alias[reg][0] = 0;
+        _tracker->flags = reg;
+    } else if ( strcmp( mnemonic, "ADC" ) == 0 || strcmp( mnemonic, "SBC" ) == 0 || strcmp( mnemonic, "AND" ) == 0 ||
+            strcmp( mnemonic, "ORA" ) == 0 || strcmp( mnemonic, "EOR" ) == 0 || strcmp( mnemonic, "PLA" ) == 0 ) {
+        _tracker->content[CPU6502_TRACKED_A][0] = 0;
+        _tracker->alias[CPU6502_TRACKED_A][0] = 0;
+        _tracker->flags = CPU6502_TRACKED_A;
+    } else if ( strcmp( mnemonic, "ASL" ) == 0 || strcmp( mnemonic, "LSR" ) == 0 || strcmp( mnemonic, "ROL" ) == 0 ||
+            strcmp( mnemonic, "ROR" ) == 0 || strcmp( mnemonic, "INC" ) == 0 || strcmp( mnemonic, "DEC" ) == 0 ) {
+        if ( !*operand || strcasecmp( operand, "A" ) == 0 ) {
+            _tracker->content[CPU6502_TRACKED_A][0] = 0;
+            _tracker->alias[CPU6502_TRACKED_A][0] = 0;
+            _tracker->flags = CPU6502_TRACKED_A;
+        } else {
+            cpu6502_register_track_store( _environment, _tracker, operand, key );
+            _tracker->flags = -1;
+        }
+    } else if ( strcmp( mnemonic, "CMP" ) == 0 || strcmp( mnemonic, "CPX" ) == 0 || strcmp( mnemonic, "CPY" ) == 0 ||
+            strcmp( mnemonic, "BIT" ) == 0 || strcmp( mnemonic, "PLP" ) == 0 ) {
+        _tracker->flags = -1;
+    } else if ( strcmp( mnemonic, "CLC" ) == 0 || strcmp( mnemonic, "SEC" ) == 0 || strcmp( mnemonic, "CLI" ) == 0 ||
+            strcmp( mnemonic, "SEI" ) == 0 || strcmp( mnemonic, "CLV" ) == 0 || strcmp( mnemonic, "CLD" ) == 0 ||
+            strcmp( mnemonic, "SED" ) == 0 || strcmp( mnemonic, "NOP" ) == 0 || strcmp( mnemonic, "PHA" ) == 0 ||
+            strcmp( mnemonic, "PHP" ) == 0 ) {
+        // Nothing changes.
+    } else if ( strlen( mnemonic ) == 3 && mnemonic[0] == 'B' && strcmp( mnemonic, "BRK" ) != 0 ) {
+        // A branch keeps everything on the way that goes on, while the
+        // other way ends on a label. But "*+n" lands on a line without
+        // label: the lines up to it (at most one per byte) are not tracked.
+        if ( *operand == '*' ) {
+            register_tracker_reset( _tracker );
+            if ( operand[1] == '+' ) {
+                _tracker->blind = atoi( operand + 2 );
+            }
+            return 0;
+        }
+    } else {
+        // JSR, JMP, RTS, RTI, BRK and anything else.
+        register_tracker_reset( _tracker );
+        return 0;
+    }
+
+    _tracker->previousStart = _tracker->lastStart;
+    _tracker->previousEnd = _tracker->lastEnd;
+    _tracker->lastStart = _start;
+    _tracker->lastEnd = _end;
+
+    return 0;
+
+}
+
 void cpu6502_is_negative( Environment * _environment, char * _value, char * _result ) {
 
     MAKE_LABEL
@@ -253,6 +253,10 @@ void cpu6502_protothread_save( Environment * _environment, char * _index, int _s
 void cpu6502_protothread_restore( Environment * _environment, char * _index, char * _step );
 void cpu6502_protothread_set_state( Environment * _environment, char * _index, int _state );
 void cpu6502_protothread_get_state( Environment * _environment, char * _index, char * _state );
+void cpu6502_protothread_sleep( Environment * _environment, char * _index, char * _ticks );
+CodeLineFlow cpu6502_code_line( Environment * _environment, char * _mnemonic, char * _operand, int * _clobbers, char ** _target );
+void cpu6502_timer_context( Environment * _environment, int _clobbers, int _save );
+int cpu6502_register_track( Environment * _environment, RegisterTracker * _tracker, char * _line, int _start, int _end );
 void cpu6502_protothread_current( Environment * _environment, char * _current );
 
 void cpu6502_msc1_uncompress_direct_direct( Environment * _environment, char * _input, char * _output );
@@ -516,6 +520,10 @@ void cpu6502_f32sub( char * _x, char * _y, char * _result );
 #define cpu_protothread_restore( _environment, _index, _step ) cpu6502_protothread_restore( _environment, _index, _step )
 #define cpu_protothread_set_state( _environment, _index, _state ) cpu6502_protothread_set_state( _environment, _index, _state )
 #define cpu_protothread_get_state( _environment, _index, _state ) cpu6502_protothread_get_state( _environment, _index, _state )
+#define cpu_protothread_sleep( _environment, _index, _ticks ) cpu6502_protothread_sleep( _environment, _index, _ticks )
+#define cpu_code_line( _environment, _mnemonic, _operand, _clobbers, _target ) cpu6502_code_line( _environment, _mnemonic, _operand, _clobbers, _target )
+#define cpu_timer_context( _environment, _clobbers, _save ) cpu6502_timer_context( _environment, _clobbers, _save )
+#define cpu_register_track( _environment, _tracker, _line, _start, _end ) cpu6502_register_track( _environment, _tracker, _line, _start, _end )
 #define cpu_protothread_current( _environment, _current ) cpu6502_protothread_current( _environment, _current )
 
 #define cpu_msc1_uncompress_direct_direct( _environment, _input, _output ) cpu6502_msc1_uncompress_direct_direct( _environment, _input, _output )
@@ -0,0 +1,218 @@
+; /*****************************************************************************
+;  * ugBASIC - an isomorphic BASIC language compiler for retrocomputers        *
+;  *****************************************************************************
+;  * Copyright 2021-2024 Marco Spedaletti (asimov@mclink.it)
+;  *
+;  * Licensed under the Apache License, Version 2.0 (the "License");
+;  * you may not use this file except in compliance with the License.
+;  * You may obtain a copy of the License at
+;  *
+;  * http://www.apache.org/licenses/LICENSE-2.0
+;  *
+;  * Unless required by applicable law or agreed to in writing, software
+;  * distributed under the License is distributed on an "AS IS" BASIS,
+;  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+;  * See the License for the specific language governing permissions and
+;  * limitations under the License.
+;  *----------------------------------------------------------------------------
+;  * Concesso in licenza secondo i termini della Licenza Apache, versione 2.0
+;  * (la "Licenza"); è proibito usare questo file se non in conformità alla
+;  * Licenza. Una copia della Licenza è disponibile all'indirizzo:
+;  *
+;  * http://www.apache.org/licenses/LICENSE-2.0
+;  *
+;  * Se non richiesto dalla legislazione vigente o concordato per iscritto,
+;  * il software distribuito nei termini della Licenza è distribuito
+;  * "COSì COM'è", SENZA GARANZIE O CONDIZIONI DI ALCUN TIPO, esplicite o
+;  * implicite. Consultare la Licenza per il testo specifico che regola le
+;  * autorizzazioni e le limitazioni previste dalla medesima.
+;  ****************************************************************************/
+;* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+;*                                                                             *
+;*                         MSC1 DECOMPRESSOR (STREAMING)                       *
+;*                                                                             *
+;*                             by Marco Spedaletti                             *
+;*                                                                             *
+;* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+; This is a version of the MSC1 decompressor that can be fed one byte
+; at a time, as soon as the byte is read from the storage. The uncompressed
+; bytes are written at the address pointed by TMPPTR2, so there is no need
+; to load the whole compressed block into memory. Since the repetitions of
+; MSC1 refer to the compressed stream (up to 1023 bytes back), the last
+; 1024 bytes of the compressed stream are kept into a ring buffer.
+
+MSC1STREAMSTATE:    .byte 0
+MSC1STREAMDATA:     .byte 0
+MSC1STREAMTOKEN:    .byte 0
+MSC1STREAMCOUNT:    .byte 0
+MSC1STREAMPOS:      .word 0
+MSC1STREAMSOURCE:   .word 0
+MSC1STREAMQUAD:     .res 4, 0
+MSC1STREAMRING:     .res 1024, 0
+
+; Reset the decompressor, before feeding a new stream.
+MSC1STREAMINIT:
+    LDA #0
+    STA MSC1STREAMSTATE
+    STA MSC1STREAMPOS
+    STA MSC1STREAMPOS+1
+    RTS
+
+; Feed the byte in A to the decompressor. On exit, the carry is
+; set if the end of the stream has been reached.
+MSC1STREAMBYTE:
+    STA MSC1STREAMDATA
+
+    ; Keep the byte into the ring buffer, and move forward
+    ; (modulo 1024) the position into the ring buffer.
+    CLC
+    LDA MSC1STREAMPOS
+    ADC #<MSC1STREAMRING
+    STA MSC1STREAMBYTESTORE+1
+    LDA MSC1STREAMPOS+1
+    ADC #>MSC1STREAMRING
+    STA MSC1STREAMBYTESTORE+2
+    LDA MSC1STREAMDATA
+MSC1STREAMBYTESTORE:
+    STA $FFFF
+    INC MSC1STREAMPOS
+    BNE MSC1STREAMBYTEPOS
+    LDA MSC1STREAMPOS+1
+    CLC
+    ADC #1
+    AND #$03
+    STA MSC1STREAMPOS+1
+MSC1STREAMBYTEPOS:
+
+    ; Now the byte is interpreted on the basis of the
+    ; current state of the decompressor:
+    ;   0 = waiting for a token
+    ;   1 = copying literals
+    ;   2 = waiting for the offset of a repetition
+    ;   3 = end of stream
+    LDA MSC1STREAMSTATE
+    BEQ MSC1STREAMTOKENBYTE
+    CMP #1
+    BEQ MSC1STREAMLITERALBYTE
+    CMP #2
+    BEQ MSC1STREAMOFFSETBYTE
+    SEC
+    RTS
+
+    ; A token of zero (0) means "end of block", while a token
+    ; with the upper bit clear introduces (1...127) literals.
+MSC1STREAMTOKENBYTE:
+    LDA MSC1STREAMDATA
+    BNE MSC1STREAMTOKENBYTE2
+    LDA #3
+    STA MSC1STREAMSTATE
+    SEC
+    RTS
+MSC1STREAMTOKENBYTE2:
+    BMI MSC1STREAMTOKENBYTEDUPES
+    STA MSC1STREAMCOUNT
+    LDA #1
+    STA MSC1STREAMSTATE
+    CLC
+    RTS
+MSC1STREAMTOKENBYTEDUPES:
+    STA MSC1STREAMTOKEN
+    LDA #2
+    STA MSC1STREAMSTATE
+    CLC
+    RTS
+
+    ; Literals are copied as they are.
+MSC1STREAMLITERALBYTE:
+    LDA MSC1STREAMDATA
+    LDY #0
+    STA (TMPPTR2),Y
+    INC TMPPTR2
+    BNE MSC1STREAMLITERALBYTE2
+    INC TMPPTR2+1
+MSC1STREAMLITERALBYTE2:
+    DEC MSC1STREAMCOUNT
+    BNE MSC1STREAMLITERALBYTE3
+    LDA #0
+    STA MSC1STREAMSTATE
+MSC1STREAMLITERALBYTE3:
+    CLC
+    RTS
+
+    ; The offset goes back from the current position of the
+    ; ring buffer, up to the 4 bytes to repeat.
+MSC1STREAMOFFSETBYTE:
+    SEC
+    LDA MSC1STREAMPOS
+    SBC MSC1STREAMDATA
+    STA MSC1STREAMSOURCE
+    LDA MSC1STREAMTOKEN
+    AND #$03
+    STA MSC1STREAMSOURCE+1
+    LDA MSC1STREAMPOS+1
+    SBC MSC1STREAMSOURCE+1
+    AND #$03
+    STA MSC1STREAMSOURCE+1
+
+    ; Take out the number of repetitions. If repetitions
+    ; is zero then repetitions will be 32 times.
+    LDA MSC1STREAMTOKEN
+    AND #$7F
+    LSR A
+    LSR A
+    BNE MSC1STREAMOFFSETBYTE2
+    LDA #32
+MSC1STREAMOFFSETBYTE2:
+    STA MSC1STREAMCOUNT
+
+    ; Take the 4 bytes out of the ring buffer (they could
+    ; be across its end).
+    LDX #0
+MSC1STREAMOFFSETBYTEL1:
+    CLC
+    LDA MSC1STREAMSOURCE
+    ADC #<MSC1STREAMRING
+    STA MSC1STREAMOFFSETBYTELOAD+1
+    LDA MSC1STREAMSOURCE+1
+    ADC #>MSC1STREAMRING
+    STA MSC1STREAMOFFSETBYTELOAD+2
+MSC1STREAMOFFSETBYTELOAD:
+    LDA $FFFF
+    STA MSC1STREAMQUAD,X
+    INC MSC1STREAMSOURCE
+    BNE MSC1STREAMOFFSETBYTEL2
+    LDA MSC1STREAMSOURCE+1
+    CLC
+    ADC #1
+    AND #$03
+    STA MSC1STREAMSOURCE+1
+MSC1STREAMOFFSETBYTEL2:
+    INX
+    CPX #4
+    BNE MSC1STREAMOFFSETBYTEL1
+
+    ; Copy the very same 4 bytes for the number of
+    ; repetitions given.
+MSC1STREAMOFFSETBYTEL3:
+    LDY #0
+MSC1STREAMOFFSETBYTEL4:
+    LDA MSC1STREAMQUAD,Y
+    STA (TMPPTR2),Y
+    INY
+    CPY #4
+    BNE MSC1STREAMOFFSETBYTEL4
+    CLC
+    LDA TMPPTR2
+    ADC #4
+    STA TMPPTR2
+    LDA TMPPTR2+1
+    ADC #0
+    STA TMPPTR2+1
+    DEC MSC1STREAMCOUNT
+    BNE MSC1STREAMOFFSETBYTEL3
+
+    LDA #0
+    STA MSC1STREAMSTATE
+    CLC
+    RTS
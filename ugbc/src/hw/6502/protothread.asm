@@ -35,129 +35,234 @@
 ;*                                                                             *
 ;* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
 
-PTP0    = $CA
+
+; Threads are kept in a compact ready list (PROTOTHREADRL) and in a sleep
+; queue (PROTOTHREADSQ) ordered by wake tick. A round only visits the ready
+; list, so empty, ended and sleeping slots cost nothing. An entry address
+; of zero (PROTOTHREADAL/PROTOTHREADAH) marks an empty slot. The scratch
+; word PROTOTHREADPTR is emitted with the other variables, so that no
+; zero page byte of the host system is taken.
 
 PROTOTHREADVOID:
     RTS
 
+; PROTOTHREADLOOP: one scheduling round
+PROTOTHREADLOOP:
+    JSR PROTOTHREADWAKE
+    LDA #0
+    STA PROTOTHREADRI
+    STA PROTOTHREADWI
+PROTOTHREADLOOPL1:
+    LDY PROTOTHREADRI
+    CPY PROTOTHREADRC
+    BCS PROTOTHREADLOOPDONE
+    LDX PROTOTHREADRL,Y
+    STX PROTOTHREADCT
+    INC PROTOTHREADRI
+    LDA PROTOTHREADAL,X
+    STA PROTOTHREADPTR
+    ORA PROTOTHREADAH,X
+    BEQ PROTOTHREADLOOPDROP
+    LDA PROTOTHREADAH,X
+    STA PROTOTHREADPTR+1
+    JSR PROTOTHREADCALL
+    LDX PROTOTHREADCT
+    LDA PROTOTHREADAL,X
+    ORA PROTOTHREADAH,X
+    BEQ PROTOTHREADLOOPDROP
+    LDA PROTOTHREADST,X
+    CMP #3
+    BCS PROTOTHREADLOOPDROP
+    LDY PROTOTHREADWI
+    TXA
+    STA PROTOTHREADRL,Y
+    INC PROTOTHREADWI
+    JMP PROTOTHREADLOOPL1
+PROTOTHREADLOOPDROP:
+    LDA #0
+    STA PROTOTHREADRQ,X
+    JMP PROTOTHREADLOOPL1
+PROTOTHREADLOOPDONE:
+    LDA PROTOTHREADWI
+    STA PROTOTHREADRC
+    RTS
+
+PROTOTHREADCALL:
+    ; Jump through the stack, since JMP (abs) would fail if the word
+    ; crossed a page boundary.
+    SEC
+    LDA PROTOTHREADPTR
+    SBC #1
+    TAX
+    LDA PROTOTHREADPTR+1
+    SBC #0
+    PHA
+    TXA
+    PHA
+    RTS
+
+; PROTOTHREADWAKE: move every due sleeper back on the ready list
+PROTOTHREADWAKE:
+    LDA PROTOTHREADSC
+    BEQ PROTOTHREADWAKEX
+    LDY PROTOTHREADSQ
+    SEC
+    LDA PROTOTHREADNOW
+    SBC PROTOTHREADWL,Y
+    LDA PROTOTHREADNOW+1
+    SBC PROTOTHREADWH,Y
+    BMI PROTOTHREADWAKEX
+    LDX #0
+PROTOTHREADWAKEL1:
+    INX
+    CPX PROTOTHREADSC
+    BEQ PROTOTHREADWAKEL2
+    LDA PROTOTHREADSQ,X
+    STA PROTOTHREADSQ-1,X
+    JMP PROTOTHREADWAKEL1
+PROTOTHREADWAKEL2:
+    DEC PROTOTHREADSC
+    LDA PROTOTHREADST,Y
+    CMP #5
+    BNE PROTOTHREADWAKE
+    LDX #0
+    JSR PROTOTHREADSETSTATE
+    JMP PROTOTHREADWAKE
+PROTOTHREADWAKEX:
+    RTS
+
 ; PROTOTHREADREGAT(Y,TMPPTR)
 PROTOTHREADREGAT:
-    TYA
-    ASL A
-    ASL A
-    ASL A
-    TAY
-    INY
-    INY
-    INY
-    INY
-    INY
-    LDA #<PROTOTHREADLOOP
-    STA PTP0
-    LDA #>PROTOTHREADLOOP
-    STA PTP0+1
     LDA TMPPTR
-    STA (PTP0),Y
-    INY
+    STA PROTOTHREADAL,Y
     LDA TMPPTR+1
-    STA (PTP0),Y
+    STA PROTOTHREADAH,Y
     RTS
 
 ; PROTOTHREADREG(TMPPTR)->Y
 PROTOTHREADREG:
-    LDX #0
-    LDY #6
-    LDA #<PROTOTHREADLOOP
-    STA PTP0
-    LDA #>PROTOTHREADLOOP
-    STA PTP0+1
+    LDY #0
 PROTOTHREADREGL1:
-    LDA (PTP0),Y
-    CMP #<PROTOTHREADVOID
-    BNE PROTOTHREADREGNEXT
+    LDA PROTOTHREADAL,Y
+    ORA PROTOTHREADAH,Y
+    BEQ PROTOTHREADREGL2
     INY
-    LDA (PTP0),Y
-    CMP #>PROTOTHREADVOID
-    BNE PROTOTHREADREGNEXT
-    DEY
+    CPY PROTOTHREADCOUNT
+    BNE PROTOTHREADREGL1
+    LDY #$FF
+    RTS
+PROTOTHREADREGL2:
     LDA TMPPTR
-    STA (PTP0),Y
-    INY
+    STA PROTOTHREADAL,Y
     LDA TMPPTR+1
-    STA (PTP0),Y
-    TXA
-    TAY
+    STA PROTOTHREADAH,Y
     RTS
-PROTOTHREADREGNEXT2:
-    DEY
-PROTOTHREADREGNEXT:
-    INX
-    INY
-    INY
-    INY
-    INY
-    INY
-    INY
-    INY
-    INY
-    JMP PROTOTHREADREGL1
 
 ; PROTOTHREADUNREG(Y)
 PROTOTHREADUNREG:
+    LDA #0
+    STA PROTOTHREADAL,Y
+    STA PROTOTHREADAH,Y
+    LDA PROTOTHREADST,Y
+    CMP #5
+    BNE PROTOTHREADUNREGX
     TYA
-    ASL A
-    ASL A
-    ASL A
-    CLC
-    ADC #6
-    TAY
-    LDA #<PROTOTHREADLOOP
-    STA PTP0
-    LDA #>PROTOTHREADLOOP
-    STA PTP0+1
-    LDA #<PROTOTHREADVOID
-    STA (PTP0),Y
-    INY
-    LDA #>PROTOTHREADVOID
-    STA (PTP0),Y
+    LDX #0
+PROTOTHREADUNREGL1:
+    CPX PROTOTHREADSC
+    BEQ PROTOTHREADUNREGX
+    CMP PROTOTHREADSQ,X
+    BEQ PROTOTHREADUNREGL2
+    INX
+    JMP PROTOTHREADUNREGL1
+PROTOTHREADUNREGL2:
+    INX
+    CPX PROTOTHREADSC
+    BEQ PROTOTHREADUNREGL3
+    LDA PROTOTHREADSQ,X
+    STA PROTOTHREADSQ-1,X
+    JMP PROTOTHREADUNREGL2
+PROTOTHREADUNREGL3:
+    DEC PROTOTHREADSC
+PROTOTHREADUNREGX:
     RTS
 
 ; PROTOTHREADSAVE(Y,X)
 PROTOTHREADSAVE:
-    LDA #<PROTOTHREADLC
-    STA PTP0
-    LDA #>PROTOTHREADLC
-    STA PTP0+1
     TXA
-    STA (PTP0),Y
+    STA PROTOTHREADLC,Y
     RTS
 
 ; PROTOTHREADRESTORE(Y)->X
 PROTOTHREADRESTORE:
-    LDA #<PROTOTHREADLC
-    STA PTP0
-    LDA #>PROTOTHREADLC
-    STA PTP0+1
-    LDA (PTP0),Y
-    TAX
+    LDX PROTOTHREADLC,Y
     RTS
 
 ; PROTOTHREADSETSTATE(Y,X)
 PROTOTHREADSETSTATE:
-    LDA #<PROTOTHREADST
-    STA PTP0
-    LDA #>PROTOTHREADST
-    STA PTP0+1
     TXA
-    STA (PTP0),Y
+    STA PROTOTHREADST,Y
+    CMP #3
+    BCS PROTOTHREADSETSTATEX
+    LDA PROTOTHREADRQ,Y
+    BNE PROTOTHREADSETSTATEX
+    LDA #1
+    STA PROTOTHREADRQ,Y
+    LDX PROTOTHREADRC
+    TYA
+    STA PROTOTHREADRL,X
+    INC PROTOTHREADRC
+PROTOTHREADSETSTATEX:
     RTS
 
 ; PROTOTHREADGETSTATE(Y)->X
 PROTOTHREADGETSTATE:
-    LDA #<PROTOTHREADST
-    STA PTP0
-    LDA #>PROTOTHREADST
-    STA PTP0+1
-    LDA (PTP0),Y
-    TAX
+    LDX PROTOTHREADST,Y
+    RTS
+
+; PROTOTHREADSLEEP(Y,TMPPTR)
+PROTOTHREADSLEEP:
+    LDA #5
+    STA PROTOTHREADST,Y
+    STY PROTOTHREADSW
+    CLC
+    LDA PROTOTHREADNOW
+    ADC TMPPTR
+    STA TMPPTR
+    STA PROTOTHREADWL,Y
+    LDA PROTOTHREADNOW+1
+    ADC TMPPTR+1
+    STA TMPPTR+1
+    STA PROTOTHREADWH,Y
+    LDX #0
+PROTOTHREADSLEEPL1:
+    CPX PROTOTHREADSC
+    BEQ PROTOTHREADSLEEPINS
+    LDY PROTOTHREADSQ,X
+    SEC
+    LDA PROTOTHREADWL,Y
+    SBC TMPPTR
+    STA PROTOTHREADPTR
+    LDA PROTOTHREADWH,Y
+    SBC TMPPTR+1
+    BMI PROTOTHREADSLEEPN
+    ORA PROTOTHREADPTR
+    BNE PROTOTHREADSLEEPINS
+PROTOTHREADSLEEPN:
+    INX
+    JMP PROTOTHREADSLEEPL1
+PROTOTHREADSLEEPINS:
+    STX PROTOTHREADPTR
+    LDY PROTOTHREADSC
+PROTOTHREADSLEEPL2:
+    CPY PROTOTHREADPTR
+    BEQ PROTOTHREADSLEEPL3
+    LDA PROTOTHREADSQ-1,Y
+    STA PROTOTHREADSQ,Y
+    DEY
+    JMP PROTOTHREADSLEEPL2
+PROTOTHREADSLEEPL3:
+    LDA PROTOTHREADSW
+    STA PROTOTHREADSQ,Y
+    INC PROTOTHREADSC
     RTS
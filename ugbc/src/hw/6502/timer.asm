@@ -52,6 +52,11 @@ TIMERMANAGERGO:
 
     ; Save the pointer registers -- some routines inside the called
     ; timers could change them and invalidate main program execution.
+    ; At the end of compilation, the block between TIMERCONTEXTSAVE
+    ; and TIMERCONTEXTSAVEEND (and the twin block for restore) is
+    ; replaced by one that saves only what the EVERY handlers can
+    ; actually change (see every_context_cleanup()).
+TIMERCONTEXTSAVE:
     LDA TMPPTR
     PHA
     LDA TMPPTR+1
@@ -68,6 +73,7 @@ TIMERMANAGERGO:
     PHA
     LDA PLOTCDEST+1
     PHA
+TIMERCONTEXTSAVEEND:
 
     ; Save actual registers (X,Y)
     TXA
@@ -79,137 +85,80 @@ TIMERMANAGERGO:
     LDA #1
     STA TIMERRUNNING
 
-    ; loop through every specific timer status
-    ; looking to the specific bit in the TIMERSTATUS
-    ; control word.
-    LDA TIMERSTATUS
+    ; If EVERY ON / OFF changed the TIMERSTATUS control word, the
+    ; list of active timers must be rebuilt. Since this happens here,
+    ; a change made by a handler takes effect from the next tick.
+    LDA TIMERACTIVEDIRTY
+    BEQ TIMERMANAGERLIST
+    JSR TIMERMANAGERBUILD
+
+TIMERMANAGERLIST:
 
-    ; Up to 8 timers.
+    ; Loop through the active timers only. Each entry of the list
+    ; is the offset (timer * 2) inside the TIMERCOUNTER, TIMERINIT
+    ; and TIMERADDRESS tables.
     LDX #0
 
 TIMERMANAGERL1:
+    CPX TIMERACTIVECOUNT
+    BEQ TIMERMANAGERDONE
 
-    ; Move the first bit into the carry.
-    LSR
-
-    ; If the carry is cleared, move to the next timer. 
-    BCC TIMERMANAGERL2
-
-    PHA
-
-    ; Retrieve the actual time counter, using the current
-    ; index (X-1). The Y will be the offset starting from
-    ; the TIMERCOUNTER base address: 
-    ;
-    ;       TIMERCOUNTER + (X-1) * 2 -> Y = (X-1) * 2
-    ;
-    TXA
-    ASL
-    TAY
-
-    LDA #<TIMERCOUNTER
-    STA TIMERP0
-    LDA #>TIMERCOUNTER
-    STA TIMERP0+1
+    LDY TIMERACTIVE, X
 
     ; Now we are going to check if the timer is not zero.
     ; If not zero, we must decrement the counter.
-    INY
-    LDA (TIMERP0), Y
-    BNE TIMERMANAGERL2AH
-    DEY
-    LDA (TIMERP0), Y
-    BNE TIMERMANAGERL2AL
+    LDA TIMERCOUNTER, Y
+    ORA TIMERCOUNTER+1, Y
+    BNE TIMERMANAGERDEC
 
     ; Ok the counter is zero. So we must reset to the
     ; value we received previously, and call the routine.
-
-    LDA #<TIMERINIT
-    STA TIMERP1
-    LDA #>TIMERINIT
-    STA TIMERP1+1
-    LDA (TIMERP1), Y
-    STA (TIMERP0), Y
-    INY
-    LDA (TIMERP1), Y
-    STA (TIMERP0), Y
-    DEY
-
-TIMERMANAGERJMP2:
-    LDA #<TIMERADDRESS
-    STA TIMERP1
-    LDA #>TIMERADDRESS
-    STA TIMERP1+1
+    LDA TIMERINIT, Y
+    STA TIMERCOUNTER, Y
+    LDA TIMERINIT+1, Y
+    STA TIMERCOUNTER+1, Y
 
     ; Now we are going to check if the address
     ; to call is zero. In this case, we must
     ; avoid to jump to it.
-    INY
-    LDA (TIMERP1), Y
-    BNE TIMERMANAGERJMP2AH
-    DEY
-    LDA (TIMERP1), Y
-    BNE TIMERMANAGERJMP2AL
-
-    JMP TIMERMANAGERL2AL
-
-TIMERMANAGERJMP:
-    JMP $0000
-
-TIMERMANAGERJMP2AH:
-    DEY
-TIMERMANAGERJMP2AL:
-    LDA (TIMERP1), Y
+    LDA TIMERADDRESS, Y
     STA TIMERMANAGERJMP+1
-    INY
-    LDA (TIMERP1), Y
+    ORA TIMERADDRESS+1, Y
+    BEQ TIMERMANAGERDEC
+    LDA TIMERADDRESS+1, Y
     STA TIMERMANAGERJMP+2
-    DEY
 
-    PHA
     TXA
     PHA
-    TYA
-    PHA
 
     JSR TIMERMANAGERJMP
 
-    PLA
-    TAY
     PLA
     TAX
-    PLA
+    LDY TIMERACTIVE, X
 
-    JMP TIMERMANAGERL2AL
-    
-    ; If we reach this line, we are going to decrement the
-    ; counter since it is not zero.
-TIMERMANAGERL2AH:
-    ; Move to the LSB
-    DEY
-TIMERMANAGERL2AL:
     ; 16 bit decrement
-    LDA (TIMERP0), Y
+TIMERMANAGERDEC:
+    LDA TIMERCOUNTER, Y
+    BNE TIMERMANAGERDECL
+    LDA TIMERCOUNTER+1, Y
     SEC
     SBC #1
-    STA (TIMERP0), Y
-    LDA (TIMERP0), Y
-    CMP #$FF
-    BNE TIMERMANAGERL2ALD
-    INY
-    LDA (TIMERP0), Y
+    STA TIMERCOUNTER+1, Y
+TIMERMANAGERDECL:
+    LDA TIMERCOUNTER, Y
     SEC
     SBC #1
-    STA (TIMERP0), Y
-TIMERMANAGERL2ALD:
-
-    PLA
+    STA TIMERCOUNTER, Y
 
     ; If we reach this line, we are going to check the next timer.
-TIMERMANAGERL2:
     INX
-    CPX #8
-    BNE TIMERMANAGERL1
+    JMP TIMERMANAGERL1
+
+TIMERMANAGERJMP:
+    JMP $0000
+
+TIMERMANAGERDONE:
 
     ; Finally, restore the actual state of registers
 
@@ -223,6 +172,7 @@ TIMERMANAGERL2:
     TAX
 
     ; Restore the pointer registers.
+TIMERCONTEXTRESTORE:
     PLA 
     STA PLOTCDEST+1
     PLA 
@@ -239,6 +189,7 @@ TIMERMANAGERL2:
     STA TMPPTR+1
     PLA 
     STA TMPPTR
+TIMERCONTEXTRESTOREEND:
 
     ; Restore register (A)
     PLA
@@ -246,6 +197,29 @@ TIMERMANAGERL2:
 
     RTS
 
+; TIMERMANAGERBUILD: rebuild the list of active timers from TIMERSTATUS
+TIMERMANAGERBUILD:
+    LDA #0
+    STA TIMERACTIVEDIRTY
+    LDX #0
+    LDY #0
+    LDA TIMERSTATUS
+TIMERMANAGERBUILDL1:
+    LSR
+    BCC TIMERMANAGERBUILDL2
+    PHA
+    TYA
+    STA TIMERACTIVE, X
+    INX
+    PLA
+TIMERMANAGERBUILDL2:
+    INY
+    INY
+    CPY #16
+    BNE TIMERMANAGERBUILDL1
+    STX TIMERACTIVECOUNT
+    RTS
+
 ; TIMERSETSTATUS(X,Y)
 TIMERSETSTATUS:
     LDA #1
@@ -261,11 +235,14 @@ TIMERSETSTATUSDONE:
 TIMERSETSTATUS1:
     ORA TIMERSTATUS
     STA TIMERSTATUS
-    RTS
+    JMP TIMERSETSTATUSDIRTY
 TIMERSETSTATUS0:
     EOR #$FF
     AND TIMERSTATUS
     STA TIMERSTATUS
+TIMERSETSTATUSDIRTY:
+    LDA #1
+    STA TIMERACTIVEDIRTY
     RTS
 
 ; TIMERSETCOUNTER(X,MATHPTR2:MATHPTR3)
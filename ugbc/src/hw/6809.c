@@ -33,6 +33,7 @@
  ****************************************************************************/
 
 #include "../ugbc.h"
+#include <ctype.h>
 #include <time.h>
 #include <math.h>
 
@@ -5242,15 +5243,18 @@ void cpu6809_protothread_vars( Environment * _environment ) {
     outhead1("PROTOTHREADLC       rzb        %d", count );
     outhead1("PROTOTHREADST       rzb        %d", count );
     outhead0("PROTOTHREADCT       fcb        0" );
-    outhead0("PROTOTHREADLOOP");
-
-    for( int i=0; i<count; ++i ) {
-        outline1("LDB #%d-1", i+1 ); /* prevents optimizer changing code length */
-        outline0("STB PROTOTHREADCT" );
-        outline0("JSR PROTOTHREADVOID" );
-    }
-
-    outline0("RTS" );
+    outhead1("PROTOTHREADCOUNT    fcb        %d", count );
+    outhead1("PROTOTHREADAD       rzb        %d", count * 2 );
+    outhead1("PROTOTHREADRL       rzb        %d", count );
+    outhead1("PROTOTHREADRQ       rzb        %d", count );
+    outhead0("PROTOTHREADRC       fcb        0" );
+    outhead0("PROTOTHREADRI       fcb        0" );
+    outhead0("PROTOTHREADWI       fcb        0" );
+    outhead1("PROTOTHREADWK       rzb        %d", count * 2 );
+    outhead1("PROTOTHREADSQ       rzb        %d", count );
+    outhead0("PROTOTHREADSC       fcb        0" );
+    outhead0("PROTOTHREADSW       fcb        0" );
+    outhead0("PROTOTHREADNOW      fdb        0" );
     
 }
 
@@ -5341,6 +5345,17 @@ void cpu6809_protothread_get_state( Environment * _environment, char * _index, c
 
 }
 
+void cpu6809_protothread_sleep( Environment * _environment, char * _index, char * _ticks ) {
+
+    deploy_with_vars( protothread, src_hw_6809_protothread_asm, cpu_protothread_vars );
+
+    outline1("LDY %s", _ticks );
+    outline1("LDB %s", _index );
+
+    outline0("JSR PROTOTHREADSLEEP" );
+
+}
+
 void cpu6809_protothread_current( Environment * _environment, char * _current ) {
 
     deploy_with_vars( protothread, src_hw_6809_protothread_asm, cpu_protothread_vars );
@@ -5350,6 +5365,328 @@ void cpu6809_protothread_current( Environment * _environment, char * _current )
 
 }
 
+#define CPU6809_TIMER_CONTEXT_U         0x01
+#define CPU6809_TIMER_CONTEXT_DP        0x02
+
+static char * cpu6809_conditional_branches[] = { 
+    "BCC", "BCS", "BEQ", "BGE", "BGT", "BHI", "BHS", "BLE", "BLO", 
+    "BLS", "BLT", "BMI", "BNE", "BPL", "BRN", "BVC", "BVS", NULL 
+};
+
+/**
+ * @brief Decode a line of generated code for the timer manager context
+ * 
+ * This function tells how the given instruction moves the program counter
+ * and, in _clobbers, which of the optional registers saved by the timer
+ * manager (U and DP) it uses. Registers D, X and Y are always saved.
+ * 
+ * @param _environment Current calling environment
+ * @param _mnemonic Instruction
+ * @param _operand Operand of the instruction (can be empty)
+ * @param _clobbers Registers used (updated)
+ * @param _target Where to look for the target label, if any
+ * @return How the instruction moves the program counter
+ */
+CodeLineFlow cpu6809_code_line( Environment * _environment, char * _mnemonic, char * _operand, int * _clobbers, char ** _target ) {
+
+    int i;
+    char * mnemonic = _mnemonic;
+
+    if ( assemblyLineHasToken( _operand, "U" ) || strcasecmp( _mnemonic, "LDU" ) == 0 || 
+            strcasecmp( _mnemonic, "LEAU" ) == 0 || strcasecmp( _mnemonic, "PULU" ) == 0 || 
+            strcasecmp( _mnemonic, "PSHU" ) == 0 ) {
+        *_clobbers |= CPU6809_TIMER_CONTEXT_U;
+    }
+
+    if ( assemblyLineHasToken( _operand, "DP" ) ) {
+        *_clobbers |= CPU6809_TIMER_CONTEXT_DP;
+    }
+
+    *_target = _operand;
+
+    if ( strcasecmp( _mnemonic, "RTS" ) == 0 || strcasecmp( _mnemonic, "RTI" ) == 0 ) {
+        return CLF_RETURN;
+    }
+
+    if ( ( strcasecmp( _mnemonic, "PULS" ) == 0 || strcasecmp( _mnemonic, "PULU" ) == 0 ) && 
+            assemblyLineHasToken( _operand, "PC" ) ) {
+        return CLF_RETURN;
+    }
+
+    // "*+n" is a jump inside the same routine, that we are reading anyway.
+    if ( *_operand == '*' ) {
+        return CLF_NONE;
+    }
+
+    if ( strcasecmp( _mnemonic, "JSR" ) == 0 || strcasecmp( _mnemonic, "BSR" ) == 0 || 
+            strcasecmp( _mnemonic, "LBSR" ) == 0 ) {
+        return ( *_operand == '[' || strchr( _operand, ',' ) ) ? CLF_UNKNOWN : CLF_CALL;
+    }
+
+    if ( strcasecmp( _mnemonic, "JMP" ) == 0 || strcasecmp( _mnemonic, "BRA" ) == 0 || 
+            strcasecmp( _mnemonic, "LBRA" ) == 0 ) {
+        return ( *_operand == '[' || strchr( _operand, ',' ) ) ? CLF_UNKNOWN : CLF_JUMP;
+    }
+
+    if ( toupper( *mnemonic ) == 'L' ) {
+        ++mnemonic;
+    }
+
+    for( i=0; cpu6809_conditional_branches[i]; ++i ) {
+        if ( strcasecmp( mnemonic, cpu6809_conditional_branches[i] ) == 0 ) {
+            return CLF_BRANCH;
+        }
+    }
+
+    return CLF_NONE;
+
+}
+
+#define CPU6809_TRACKED_A       0
+#define CPU6809_TRACKED_B       1
+#define CPU6809_TRACKED_D       2
+#define CPU6809_TRACKED_X       3
+#define CPU6809_TRACKED_Y       4
+#define CPU6809_TRACKED_U       5
+
+/* Split a line of generated code into mnemonic and operand (without spaces). */
+static void cpu6809_register_track_split( char * _line, char * _mnemonic, char * _operand ) {
+
+    char * p = _line;
+
+    while( *p == ' ' || *p == '\t' ) {
+        ++p;
+    }
+    while( *p && *p != ' ' && *p != '\t' && *p != ';' ) {
+        *_mnemonic++ = toupper( *p++ );
+    }
+    *_mnemonic = 0;
+    while( *p && *p != ';' && *p != '\r' && *p != '\n' ) {
+        if ( *p != ' ' && *p != '\t' ) {
+            *_operand++ = *p;
+        }
+        ++p;
+    }
+    *_operand = 0;
+
+}
+
+/*
+ * Normalize an operand into _key. Returns 1 if the operand is an immediate,
+ * 2 if it is a variable that can be tracked and 0 otherwise (indexed, 
+ * indirect, a symbol that is not a variable, ...). Variables at an absolute
+ * address are never tracked, since they could be a register of some chip.
+ */
+static int cpu6809_register_track_operand( Environment * _environment, char * _operand, char * _key ) {
+
+    char name[MAX_TRACKED_OPERAND];
+    char * p = _operand;
+    int offset = 0;
+
+    if ( strlen( _operand ) >= MAX_TRACKED_OPERAND || !*p ) {
+        return 0;
+    }
+
+    if ( *p == '#' ) {
+        strcpy( _key, _operand );
+        return 1;
+    }
+
+    if ( *p != '_' && !isalpha( *p ) ) {
+        return 0;
+    }
+
+    while( *p == '_' || isalnum( *p ) ) {
+        ++p;
+    }
+    memcpy( name, _operand, p - _operand );
+    name[p - _operand] = 0;
+
+    if ( *p == '+' && p[1] && strspn( p+1, "0123456789" ) == strlen( p+1 ) ) {
+        offset = atoi( p+1 );
+    } else if ( *p ) {
+        return 0;
+    }
+
+    Variable * variable = variable_retrieve_by_realname( _environment, name );
+
+    if ( !variable || variable->absoluteAddress ) {
+        return 0;
+    }
+
+    if ( offset ) {
+        sprintf( _key, "%s+%d", name, offset );
+    } else {
+        strcpy( _key, name );
+    }
+
+    return 2;
+
+}
+
+/* Tell which register is loaded (or stored) by the given mnemonic. */
+static int cpu6809_register_track_register( char * _mnemonic, char * _prefix ) {
+
+    if ( strlen( _mnemonic ) != 3 || strncmp( _mnemonic, _prefix, 2 ) != 0 ) {
+        return -1;
+    }
+
+    switch( _mnemonic[2] ) {
+        case 'A':
+            return CPU6809_TRACKED_A;
+        case 'B':
+            return CPU6809_TRACKED_B;
+        case 'D':
+            return CPU6809_TRACKED_D;
+        case 'X':
+            return CPU6809_TRACKED_X;
+        case 'Y':
+            return CPU6809_TRACKED_Y;
+        case 'U':
+            return CPU6809_TRACKED_U;
+    }
+
+    return -1;
+
+}
+
+/* Forget what a register holds, and what the registers overlapping it hold. */
+static void cpu6809_register_track_clobber( RegisterTracker * _tracker, int _register ) {
+
+    _tracker->content[_register][0] = 0;
+    _tracker->alias[_register][0] = 0;
+
+    // D is made by A (high byte) and B (low byte).
+    if ( _register == CPU6809_TRACKED_A || _register == CPU6809_TRACKED_B ) {
+        _tracker->content[CPU6809_TRACKED_D][0] = 0;
+        _tracker->alias[CPU6809_TRACKED_D][0] = 0;
+    } else if ( _register == CPU6809_TRACKED_D ) {
+        _tracker->content[CPU6809_TRACKED_A][0] = 0;
+        _tracker->alias[CPU6809_TRACKED_A][0] = 0;
+        _tracker->content[CPU6809_TRACKED_B][0] = 0;
+        _tracker->alias[CPU6809_TRACKED_B][0] = 0;
+    }
+
+}
+
+/**
+ * @brief Track the content of A, B, D, X, Y and U on a line of generated code
+ * 
+ * This function updates what the registers are known to hold after the 
+ * given instruction. Anything that cannot be followed (calls, jumps, 
+ * unknown instructions, auto increments) invalidates everything, and any
+ * store forgets every memory operand. On the 6809 both loads and stores 
+ * set N and Z from the register (and clear V), while C is left untouched:
+ * a load is redundant if the register already holds the same constant (or
+ * memory) and the flags already reflect it, since a branch could follow.
+ * 
+ * @param _environment Current calling environment
+ * @param _tracker Tracker to update
+ * @param _line Line of generated code (not a label)
+ * @param _start Offset of the line in the output
+ * @param _end Offset of the next line in the output
+ * @return 1 if the line is redundant, 0 otherwise
+ */
+int cpu6809_register_track( Environment * _environment, RegisterTracker * _tracker, char * _line, int _start, int _end ) {
+
+    char mnemonic[MAX_TEMPORARY_STORAGE];
+    char operand[MAX_TEMPORARY_STORAGE];
+    char key[MAX_TRACKED_OPERAND];
+    int reg;
+
+    if ( strchr( _line, '"' ) || strchr( _line, '\'' ) || strchr( _line, ':' ) ) {
+        register_tracker_reset( _tracker );
+        return 0;
+    }
+
+    cpu6809_register_track_split( _line, mnemonic, operand );
+
+    // Indexed addressing with auto increment (or decrement) changes the 
+    // index register.
+    char * comma = strchr( operand, ',' );
+    if ( comma && ( strchr( comma, '+' ) || strchr( comma, '-' ) ) ) {
+        register_tracker_reset( _tracker );
+        return 0;
+    }
+
+    if ( ( reg = cpu6809_register_track_register( mnemonic, "LD" ) ) >= 0 ) {
+        int kind = cpu6809_register_track_operand( _environment, operand, key );
+        if ( kind && _tracker->flags == reg &&
+                ( strcmp( _tracker->content[reg], key ) == 0 || strcmp( _tracker->alias[reg], key ) == 0 ) ) {
+            return 1;
+        }
+        cpu6809_register_track_clobber( _tracker, reg );
+        if ( kind ) {
+            strcpy( _tracker->content[reg], key );
+        }
+        _tracker->flags = reg;
+    } else if ( ( reg = cpu6809_register_track_register( mnemonic, "ST" ) ) >= 0 ) {
+        // 16 bit stores and indexed stores change more than one memory
+        // operand, so every one of them is forgotten.
+        register_tracker_forget( _tracker, NULL );
+        if ( cpu6809_register_track_operand( _environment, operand, key ) == 2 && strcmp( _tracker->content[reg], key ) != 0 ) {
+            strcpy( _tracker->alias[reg], key );
+        }
+        _tracker->flags = reg;
+    } else if ( strncmp( mnemonic, "CMP", 3 ) == 0 || strncmp( mnemonic, "TST", 3 ) == 0 ||
+            strcmp( mnemonic, "BITA" ) == 0 || strcmp( mnemonic, "BITB" ) == 0 ) {
+        _tracker->flags = -1;
+    } else if ( ( mnemonic[0] == 'B' || ( mnemonic[0] == 'L' && mnemonic[1] == 'B' ) ) &&
+            strcmp( mnemonic, "BRA" ) != 0 && strcmp( mnemonic, "LBRA" ) != 0 && strcmp( mnemonic, "BSR" ) != 0 &&
+            strcmp( mnemonic, "LBSR" ) != 0 && strcmp( mnemonic, "BRN" ) != 0 && strncmp( mnemonic, "BIT", 3 ) != 0 &&
+            strlen( mnemonic ) == ( mnemonic[0] == 'L' ? 4 : 3 ) ) {
+        // A branch keeps everything on the way that goes on, while the
+        // other way ends on a label. But "*+n" lands on a line without
+        // label: the lines up to it (at most one per byte) are not tracked.
+        if ( *operand == '*' ) {
+            register_tracker_reset( _tracker );
+            if ( operand[1] == '+' ) {
+                _tracker->blind = atoi( operand + 2 );
+            }
+            return 0;
+        }
+    } else {
+        // JSR, JMP, BRA, RTS, arithmetic, directives and anything else.
+        register_tracker_reset( _tracker );
+        return 0;
+    }
+
+    _tracker->previousStart = _tracker->lastStart;
+    _tracker->previousEnd = _tracker->lastEnd;
+    _tracker->lastStart = _start;
+    _tracker->lastEnd = _end;
+
+    return 0;
+
+}
+
+/**
+ * @brief Emit the context save (or restore) of the timer manager
+ * 
+ * @param _environment Current calling environment
+ * @param _clobbers Registers to save (see cpu6809_code_line())
+ * @param _save 1 to emit the save, 0 to emit the restore
+ */
+void cpu6809_timer_context( Environment * _environment, int _clobbers, int _save ) {
+
+    if ( _save ) {
+        if ( _clobbers & CPU6809_TIMER_CONTEXT_U ) {
+            outline0("PSHS U" );
+        }
+        if ( _clobbers & CPU6809_TIMER_CONTEXT_DP ) {
+            outline0("PSHS DP" );
+        }
+    } else {
+        if ( _clobbers & CPU6809_TIMER_CONTEXT_DP ) {
+            outline0("PULS DP" );
+        }
+        if ( _clobbers & CPU6809_TIMER_CONTEXT_U ) {
+            outline0("PULS U" );
+        }
+    }
+
+}
+
 void cpu6809_is_negative( Environment * _environment, char * _value, char * _result ) {
 
     inline( cpu_is_negative )
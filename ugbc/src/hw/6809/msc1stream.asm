@@ -0,0 +1,185 @@
+; /*****************************************************************************
+;  * ugBASIC - an isomorphic BASIC language compiler for retrocomputers        *
+;  *****************************************************************************
+;  * Copyright 2021-2024 Marco Spedaletti (asimov@mclink.it)
+;  *
+;  * Licensed under the Apache License, Version 2.0 (the "License");
+;  * you may not use this file except in compliance with the License.
+;  * You may obtain a copy of the License at
+;  *
+;  * http://www.apache.org/licenses/LICENSE-2.0
+;  *
+;  * Unless required by applicable law or agreed to in writing, software
+;  * distributed under the License is distributed on an "AS IS" BASIS,
+;  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+;  * See the License for the specific language governing permissions and
+;  * limitations under the License.
+;  *----------------------------------------------------------------------------
+;  * Concesso in licenza secondo i termini della Licenza Apache, versione 2.0
+;  * (la "Licenza"); è proibito usare questo file se non in conformità alla
+;  * Licenza. Una copia della Licenza è disponibile all'indirizzo:
+;  *
+;  * http://www.apache.org/licenses/LICENSE-2.0
+;  *
+;  * Se non richiesto dalla legislazione vigente o concordato per iscritto,
+;  * il software distribuito nei termini della Licenza è distribuito
+;  * "COSì COM'è", SENZA GARANZIE O CONDIZIONI DI ALCUN TIPO, esplicite o
+;  * implicite. Consultare la Licenza per il testo specifico che regola le
+;  * autorizzazioni e le limitazioni previste dalla medesima.
+;  ****************************************************************************/
+;* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+;*                                                                             *
+;*                         MSC1 DECOMPRESSOR (STREAMING)                       *
+;*                                                                             *
+;*                             by Marco Spedaletti                             *
+;*                                                                             *
+;* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+; This is a version of the MSC1 decompressor that can be fed one byte
+; at a time, as soon as the byte is read from the storage. The uncompressed
+; bytes are written at the address pointed by Y, so there is no need
+; to load the whole compressed block into memory. Since the repetitions of
+; MSC1 refer to the compressed stream (up to 1023 bytes back), the last
+; 1024 bytes of the compressed stream are kept into a ring buffer.
+
+MSC1STREAMSTATE     fcb 0
+MSC1STREAMDATA      fcb 0
+MSC1STREAMTOKEN     fcb 0
+MSC1STREAMCOUNT     fcb 0
+MSC1STREAMPOS       fdb 0
+MSC1STREAMSOURCE    fdb 0
+MSC1STREAMQUAD      rzb 4
+MSC1STREAMRING      rzb 1024
+
+; Reset the decompressor, before feeding a new stream.
+MSC1STREAMINIT
+    CLR MSC1STREAMSTATE
+    CLR MSC1STREAMPOS
+    CLR MSC1STREAMPOS+1
+    RTS
+
+; Feed the byte in A to the decompressor, that will write at Y (and 
+; move it forward). On exit, the carry is set if the end of the stream 
+; has been reached. B and X are preserved.
+MSC1STREAMBYTE
+    PSHS B,X
+    STA MSC1STREAMDATA
+
+    ; Keep the byte into the ring buffer, and move forward
+    ; (modulo 1024) the position into the ring buffer.
+    LDX #MSC1STREAMRING
+    LDD MSC1STREAMPOS
+    LEAX D,X
+    LDA MSC1STREAMDATA
+    STA ,X
+    LDD MSC1STREAMPOS
+    ADDD #1
+    ANDA #$03
+    STD MSC1STREAMPOS
+
+    ; Now the byte is interpreted on the basis of the
+    ; current state of the decompressor:
+    ;   0 = waiting for a token
+    ;   1 = copying literals
+    ;   2 = waiting for the offset of a repetition
+    ;   3 = end of stream
+    LDA MSC1STREAMSTATE
+    BEQ MSC1STREAMTOKENBYTE
+    CMPA #1
+    BEQ MSC1STREAMLITERALBYTE
+    CMPA #2
+    BEQ MSC1STREAMOFFSETBYTE
+    ORCC #$01
+    PULS B,X,PC
+
+    ; A token of zero (0) means "end of block", while a token
+    ; with the upper bit clear introduces (1...127) literals.
+MSC1STREAMTOKENBYTE
+    LDA MSC1STREAMDATA
+    BNE MSC1STREAMTOKENBYTE2
+    LDA #3
+    STA MSC1STREAMSTATE
+    ORCC #$01
+    PULS B,X,PC
+MSC1STREAMTOKENBYTE2
+    BMI MSC1STREAMTOKENBYTEDUPES
+    STA MSC1STREAMCOUNT
+    LDA #1
+    STA MSC1STREAMSTATE
+    ANDCC #$FE
+    PULS B,X,PC
+MSC1STREAMTOKENBYTEDUPES
+    STA MSC1STREAMTOKEN
+    LDA #2
+    STA MSC1STREAMSTATE
+    ANDCC #$FE
+    PULS B,X,PC
+
+    ; Literals are copied as they are.
+MSC1STREAMLITERALBYTE
+    LDA MSC1STREAMDATA
+    STA ,Y+
+    DEC MSC1STREAMCOUNT
+    BNE MSC1STREAMLITERALBYTE2
+    CLR MSC1STREAMSTATE
+MSC1STREAMLITERALBYTE2
+    ANDCC #$FE
+    PULS B,X,PC
+
+    ; The offset goes back from the current position of the
+    ; ring buffer, up to the 4 bytes to repeat.
+MSC1STREAMOFFSETBYTE
+    LDA MSC1STREAMTOKEN
+    ANDA #$03
+    LDB MSC1STREAMDATA
+    STD MSC1STREAMSOURCE
+    LDD MSC1STREAMPOS
+    SUBD MSC1STREAMSOURCE
+    ANDA #$03
+    STD MSC1STREAMSOURCE
+
+    ; Take the 4 bytes out of the ring buffer (they could
+    ; be across its end).
+    CLRB
+MSC1STREAMOFFSETBYTEL1
+    PSHS B
+    LDX #MSC1STREAMRING
+    LDD MSC1STREAMSOURCE
+    LEAX D,X
+    LDA ,X
+    LDB ,S
+    LDX #MSC1STREAMQUAD
+    STA B,X
+    LDD MSC1STREAMSOURCE
+    ADDD #1
+    ANDA #$03
+    STD MSC1STREAMSOURCE
+    PULS B
+    INCB
+    CMPB #4
+    BNE MSC1STREAMOFFSETBYTEL1
+
+    ; Take out the number of repetitions. If repetitions
+    ; is zero then repetitions will be 32 times.
+    LDA MSC1STREAMTOKEN
+    ANDA #$7F
+    LSRA
+    LSRA
+    BNE MSC1STREAMOFFSETBYTE2
+    LDA #32
+MSC1STREAMOFFSETBYTE2
+    STA MSC1STREAMCOUNT
+
+    ; Copy the very same 4 bytes for the number of
+    ; repetitions given.
+MSC1STREAMOFFSETBYTEL3
+    LDD MSC1STREAMQUAD
+    STD ,Y++
+    LDD MSC1STREAMQUAD+2
+    STD ,Y++
+    DEC MSC1STREAMCOUNT
+    BNE MSC1STREAMOFFSETBYTEL3
+
+    CLR MSC1STREAMSTATE
+    ANDCC #$FE
+    PULS B,X,PC
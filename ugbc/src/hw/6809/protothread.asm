@@ -35,89 +35,249 @@
 ;*                                                                             *
 ;* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
 
+; Threads are kept in a compact ready list (PROTOTHREADRL) and in a sleep
+; queue (PROTOTHREADSQ) ordered by wake tick. A round only visits the ready
+; list, so empty, ended and sleeping slots cost nothing. An entry address
+; of zero (PROTOTHREADAD) marks an empty slot.
+
 PROTOTHREADVOID
     RTS
 
+; PROTOTHREADLOOP: one scheduling round
+PROTOTHREADLOOP
+    JSR PROTOTHREADWAKE
+    CLR PROTOTHREADRI
+    CLR PROTOTHREADWI
+PROTOTHREADLOOPL1
+    LDB PROTOTHREADRI
+    CMPB PROTOTHREADRC
+    BHS PROTOTHREADLOOPDONE
+    LDX #PROTOTHREADRL
+    ABX
+    LDB ,X
+    STB PROTOTHREADCT
+    INC PROTOTHREADRI
+    LDX #PROTOTHREADAD
+    ABX
+    ABX
+    LDX ,X
+    BEQ PROTOTHREADLOOPDROP
+    JSR ,X
+    LDB PROTOTHREADCT
+    LDX #PROTOTHREADAD
+    ABX
+    ABX
+    LDX ,X
+    BEQ PROTOTHREADLOOPDROP
+    LDX #PROTOTHREADST
+    ABX
+    LDA ,X
+    CMPA #3
+    BHS PROTOTHREADLOOPDROP
+    PSHS B
+    LDB PROTOTHREADWI
+    INC PROTOTHREADWI
+    LDX #PROTOTHREADRL
+    ABX
+    PULS B
+    STB ,X
+    BRA PROTOTHREADLOOPL1
+PROTOTHREADLOOPDROP
+    LDX #PROTOTHREADRQ
+    ABX
+    CLR ,X
+    BRA PROTOTHREADLOOPL1
+PROTOTHREADLOOPDONE
+    LDA PROTOTHREADWI
+    STA PROTOTHREADRC
+    RTS
+
+; PROTOTHREADWAKE: move every due sleeper back on the ready list
+PROTOTHREADWAKE
+    LDA PROTOTHREADSC
+    BEQ PROTOTHREADWAKEX
+    LDB PROTOTHREADSQ
+    STB PROTOTHREADSW
+    LDX #PROTOTHREADWK
+    ABX
+    ABX
+    LDD PROTOTHREADNOW
+    SUBD ,X
+    BMI PROTOTHREADWAKEX
+    LDX #PROTOTHREADSQ
+    LDA #1
+PROTOTHREADWAKEL1
+    CMPA PROTOTHREADSC
+    BEQ PROTOTHREADWAKEL2
+    LDB 1,X
+    STB ,X+
+    INCA
+    BRA PROTOTHREADWAKEL1
+PROTOTHREADWAKEL2
+    DEC PROTOTHREADSC
+    LDB PROTOTHREADSW
+    LDX #PROTOTHREADST
+    ABX
+    LDA ,X
+    CMPA #5
+    BNE PROTOTHREADWAKE
+    CLRA
+    JSR PROTOTHREADSETSTATE
+    BRA PROTOTHREADWAKE
+PROTOTHREADWAKEX
+    RTS
+
 ; PROTOTHREADREGAT(B,Y)
 PROTOTHREADREGAT
-    LDX #PROTOTHREADLOOP
-    LDA #0
-    ROLB
-    ASLA
-    TFR D,X
-    ROLB
-    ASLA
-    LEAX D,X
-    STY ,X    
+    LDX #PROTOTHREADAD
+    ABX
+    ABX
+    STY ,X
     RTS
 
 ; PROTOTHREADREG(Y)->B
 PROTOTHREADREG
-    LDB #0
-    LDU #PROTOTHREADLOOP
-    LEAU 6,U
+    CLRB
+    LDX #PROTOTHREADAD
 PROTOTHREADREGL1
-    PSHS B
-    LDD ,U
-    CMPD #PROTOTHREADVOID
-    BNE PROTOTHREADREGNEXT
-    STY ,U
-    PULS B
-    RTS
-PROTOTHREADREGNEXT
-    PULS B
+    LDU ,X
+    BEQ PROTOTHREADREGL2
+    LEAX 2,X
     INCB
-    LEAU 8,U
-    JMP PROTOTHREADREGL1
+    CMPB PROTOTHREADCOUNT
+    BNE PROTOTHREADREGL1
+    LDB #$FF
+    RTS
+PROTOTHREADREGL2
+    STY ,X
+    RTS
 
 ; PROTOTHREADUNREG(B)
 PROTOTHREADUNREG
-    LDX #PROTOTHREADLOOP
-    LEAX 6, X
-    LDA #0
-    ROLB
-    ASLA
-    ROLB
-    ASLA
-    ROLB
-    ASLA
-    LEAX D,X
-    LDY #PROTOTHREADVOID
-    STY ,X    
+    LDX #PROTOTHREADAD
+    ABX
+    ABX
+    CLR ,X
+    CLR 1,X
+    LDX #PROTOTHREADST
+    ABX
+    LDA ,X
+    CMPA #5
+    BNE PROTOTHREADUNREGX
+    LDX #PROTOTHREADSQ
+    CLRA
+PROTOTHREADUNREGL1
+    CMPA PROTOTHREADSC
+    BEQ PROTOTHREADUNREGX
+    INCA
+    CMPB ,X+
+    BNE PROTOTHREADUNREGL1
+PROTOTHREADUNREGL2
+    CMPA PROTOTHREADSC
+    BEQ PROTOTHREADUNREGL3
+    LDB ,X
+    STB -1,X
+    LEAX 1,X
+    INCA
+    BRA PROTOTHREADUNREGL2
+PROTOTHREADUNREGL3
+    DEC PROTOTHREADSC
+PROTOTHREADUNREGX
     RTS
 
 ; PROTOTHREADSAVE(B,A)
 PROTOTHREADSAVE
-    LDY #PROTOTHREADLC
-    PSHS A
-    LDA #0
-    LEAY D, Y
-    PULS A
-    STA ,Y
+    LDX #PROTOTHREADLC
+    ABX
+    STA ,X
     RTS
 
 ; PROTOTHREADRESTORE(B)->A
 PROTOTHREADRESTORE
-    LDY #PROTOTHREADLC
-    LDA #0
-    LEAY D, Y
-    LDA ,Y
+    LDX #PROTOTHREADLC
+    ABX
+    LDA ,X
     RTS
 
 ; PROTOTHREADSETSTATE(B,A)
 PROTOTHREADSETSTATE
-    LDY #PROTOTHREADST
-    PSHS A
-    LDA #0
-    LEAY D, Y
-    PULS A
-    STA ,Y
+    LDX #PROTOTHREADST
+    ABX
+    STA ,X
+    CMPA #3
+    BHS PROTOTHREADSETSTATEX
+    LDX #PROTOTHREADRQ
+    ABX
+    TST ,X
+    BNE PROTOTHREADSETSTATEX
+    INC ,X
+    PSHS B
+    LDB PROTOTHREADRC
+    INC PROTOTHREADRC
+    LDX #PROTOTHREADRL
+    ABX
+    PULS B
+    STB ,X
+PROTOTHREADSETSTATEX
     RTS
 
 ; PROTOTHREADGETSTATE(B)->A
 PROTOTHREADGETSTATE
-    LDY #PROTOTHREADST
-    LDA #0
-    LEAY D, Y
-    LDA ,Y
+    LDX #PROTOTHREADST
+    ABX
+    LDA ,X
+    RTS
+
+; PROTOTHREADSLEEP(B,Y)
+PROTOTHREADSLEEP
+    STB PROTOTHREADSW
+    LDX #PROTOTHREADST
+    ABX
+    LDA #5
+    STA ,X
+    TFR Y,D
+    ADDD PROTOTHREADNOW
+    TFR D,Y
+    LDB PROTOTHREADSW
+    LDX #PROTOTHREADWK
+    ABX
+    ABX
+    STY ,X
+    LDU #PROTOTHREADSQ
+    CLRA
+PROTOTHREADSLEEPL1
+    CMPA PROTOTHREADSC
+    BEQ PROTOTHREADSLEEPINS
+    LDB ,U
+    LDX #PROTOTHREADWK
+    ABX
+    ABX
+    PSHS A
+    PSHS Y
+    LDD ,X
+    SUBD ,S++
+    PULS A
+    BMI PROTOTHREADSLEEPN
+    BNE PROTOTHREADSLEEPINS
+PROTOTHREADSLEEPN
+    LEAU 1,U
+    INCA
+    BRA PROTOTHREADSLEEPL1
+PROTOTHREADSLEEPINS
+    NEGA
+    ADDA PROTOTHREADSC
+    LDB PROTOTHREADSC
+    LDX #PROTOTHREADSQ
+    ABX
+PROTOTHREADSLEEPL2
+    TSTA
+    BEQ PROTOTHREADSLEEPL3
+    LDB ,-X
+    STB 1,X
+    DECA
+    BRA PROTOTHREADSLEEPL2
+PROTOTHREADSLEEPL3
+    LDB PROTOTHREADSW
+    STB ,U
+    INC PROTOTHREADSC
     RTS
@@ -42,136 +42,119 @@ TIMERMANAGER
     PSHS D
     LDA TIMERRUNNING
     BEQ TIMERMANAGERGO
-    PULS D
-    RTS
-
-TIMERMANAGERGO
 
+    ; Save the registers -- some routines inside the called timers
+    ; could change them and invalidate main program execution.
+    ; At the end of compilation, the block between TIMERCONTEXTSAVE
+    ; and TIMERCONTEXTSAVEEND (and the twin block for restore) is
+    ; replaced by one that saves only what the EVERY handlers can
+    ; actually change (see every_context_cleanup()).
     PSHS X
     PSHS Y
+TIMERCONTEXTSAVE
     PSHS U
     PSHS DP
+TIMERCONTEXTSAVEEND
 
     ; Next, we update the RUNNING flag.
     LDA #1
     STA TIMERRUNNING
 
-    ; loop through every specific timer status
-    ; looking to the specific bit in the TIMERSTATUS
-    ; control word.
-    LDA TIMERSTATUS
-
-    ; Up to 8 timers.
-    LDB #0
-
-TIMERMANAGERL1
+    ; If EVERY ON / OFF changed the TIMERSTATUS control word, the
+    ; list of active timers must be rebuilt. Since this happens here,
+    ; a change made by a handler takes effect from the next tick.
+    LDA TIMERACTIVEDIRTY
+    BEQ TIMERMANAGERLIST
+    JSR TIMERMANAGERBUILD
 
-    ; Move the first bit into the carry.
-    LSRA
+TIMERMANAGERLIST
 
-    ; If the carry is cleared, move to the next timer. 
-    BCC TIMERMANAGERL2
+    ; Loop through the active timers only. Each entry of the list
+    ; is the offset (timer * 2) inside the TIMERCOUNTER, TIMERINIT
+    ; and TIMERADDRESS tables. The index is kept on the stack.
+    LDA #0
+    PSHS A
 
-    PSHS D
-    PSHS X
-    PSHS Y
-    PSHS U
+TIMERMANAGERL1
+    LDA , S
+    CMPA TIMERACTIVECOUNT
+    BEQ TIMERMANAGERDONE
 
-    ; Retrieve the actual time counter, using the current
-    ; index (X-1). The Y will be the offset starting from
-    ; the TIMERCOUNTER base address: 
-    ;
-    ;       TIMERCOUNTER + (X-1) * 2 -> Y = (X-1) * 2
-    ;
-    LSLB
+    LDX #TIMERACTIVE
+    LDB A, X
     CLRA
+    LDX #TIMERCOUNTER
+    LEAX D, X
 
     ; Now we are going to check if the timer is not zero.
     ; If not zero, we must decrement the counter.
-    LDX #TIMERCOUNTER
-    LEAX D, X
-    LDY #TIMERINIT
-    LEAY D, Y
-    LDU #TIMERADDRESS
-    LEAU D, U
-
-    LDD ,X
-    CMPD #0
-    BNE TIMERMANAGERL2A
-    
+    LDY , X
+    BNE TIMERMANAGERDEC
+
     ; Ok the counter is zero. So we must reset to the
     ; value we received previously, and call the routine.
-
-    LDD , Y
-    STD , X
-
-TIMERMANAGERJMP2
+    LDY #TIMERINIT
+    LDY D, Y
+    STY , X
 
     ; Now we are going to check if the address
     ; to call is zero. In this case, we must
     ; avoid to jump to it.
+    LDY #TIMERADDRESS
+    LDY D, Y
+    BEQ TIMERMANAGERDEC
 
-    LDD , U
-    CMPD #0
-    BNE TIMERMANAGERJMP2A
-
-    JMP TIMERMANAGERL2A
-
-TIMERMANAGERADD     fdb $0
-TIMERMANAGERJMP
-    JMP [TIMERMANAGERADD]
-
-TIMERMANAGERJMP2A
-    LDD , U
-    STD TIMERMANAGERADD
-
-    PSHS D
     PSHS X
-    PSHS Y
-    PSHS U
-    PSHS DP
-
-    JSR TIMERMANAGERJMP
-
-    PULS DP
-    PULS U
-    PULS Y
+    JSR , Y
     PULS X
-    PULS D
 
-    ; If we reach this line, we are going to decrement the
-    ; counter since it is not zero.
-TIMERMANAGERL2A
+    ; 16 bit decrement
+TIMERMANAGERDEC
     LDD , X
     SUBD #1
     STD , X
 
-TIMERMANAGERL2ALD
-
-    PULS U
-    PULS Y
-    PULS X
-    PULS D
-
     ; If we reach this line, we are going to check the next timer.
-TIMERMANAGERL2
-    INCB
-    CMPB #8
-    BNE TIMERMANAGERL1
+    INC , S
+    JMP TIMERMANAGERL1
+
+TIMERMANAGERDONE
+    LEAS 1, S
 
     ; Finally, restore the actual state of registers
 
     LDA #0
     STA TIMERRUNNING
-    
+
+TIMERCONTEXTRESTORE
     PULS DP
     PULS U
+TIMERCONTEXTRESTOREEND
     PULS Y
     PULS X
     PULS D
 
     RTS
 
+; TIMERMANAGERBUILD: rebuild the list of active timers from TIMERSTATUS
+TIMERMANAGERBUILD
+    CLR TIMERACTIVEDIRTY
+    LDX #TIMERACTIVE
+    LDA TIMERSTATUS
+    LDB #0
+TIMERMANAGERBUILDL1
+    LSRA
+    BCC TIMERMANAGERBUILDL2
+    STB , X+
+TIMERMANAGERBUILDL2
+    ADDB #2
+    CMPB #16
+    BNE TIMERMANAGERBUILDL1
+    TFR X, D
+    SUBD #TIMERACTIVE
+    STB TIMERACTIVECOUNT
+    RTS
+
 ; TIMERSETSTATUS(B,MATHPTR0)
 TIMERSETSTATUS
     LDA #1
@@ -188,11 +171,14 @@ TIMERSETSTATUSDONE
 TIMERSETSTATUS1
     ORA TIMERSTATUS
     STA TIMERSTATUS
-    RTS
+    BRA TIMERSETSTATUSDIRTY
 TIMERSETSTATUS0
     EORA #$FF
     ANDA TIMERSTATUS
     STA TIMERSTATUS
+TIMERSETSTATUSDIRTY
+    LDA #1
+    STA TIMERACTIVEDIRTY
     RTS
 
 ; TIMERSETCOUNTER(B,MATHPTR2:MATHPTR3)
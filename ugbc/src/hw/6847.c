@@ -1254,9 +1254,9 @@ static Variable * c6847_image_converter_bitmap_mode_standard( Environment * _env
             } else if ( ( rgb.alpha == 255 ) && rgbi_equals_rgba( &white, &rgb ) ) {
                 colorIndex = 1;
             } else {
-                int minDistance = 9999;
+                int minDistance = 0x7fffffff;
                 for( int i=0; i<2; ++i ) {
-                    int distance = rgbi_distance(&commonPalette[i], &rgb );
+                    int distance = rgbi_distance_squared(&commonPalette[i], &rgb );
                     if ( distance < minDistance ) {
                         minDistance = distance;
                         colorIndex = i;
@@ -1388,9 +1388,9 @@ static Variable * c6847_image_converter_multicolor_mode_standard( Environment *
             if ( rgb.alpha < 255 ) {
                 colorIndex = 0;
             } else {
-                int minDistance = 9999;
+                int minDistance = 0x7fffffff;
                 for( int i=0; i<lastUsedSlotInCommonPalette; ++i ) {
-                    int distance = rgbi_distance(&commonPalette[i], &rgb );
+                    int distance = rgbi_distance_squared(&commonPalette[i], &rgb );
                     if ( distance < minDistance ) {
                         minDistance = distance;
                         colorIndex = commonPalette[i].index;
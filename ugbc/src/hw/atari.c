@@ -355,6 +355,47 @@ void atari_dload( Environment * _environment, char * _filename, char * _offset,
 
 }
 
+void atari_dstream( Environment * _environment, char * _filename, char * _address ) {
+
+    deploy( dcommon, src_hw_atari_dcommon_asm );
+    deploy( msc1stream, src_hw_6502_msc1stream_asm );
+    deploy( dstream, src_hw_atari_dstream_asm );
+
+    MAKE_LABEL
+    
+    Variable * filename = variable_retrieve( _environment, _filename );
+    Variable * tnaddress = variable_temporary( _environment, VT_ADDRESS, "(address of target_name)");
+    Variable * tnsize = variable_temporary( _environment, VT_BYTE, "(size of target_name)");
+
+    Variable * address = variable_retrieve( _environment, _address );
+
+    switch( filename->type ) {
+        case VT_STRING:
+            cpu_move_8bit( _environment, filename->realName, tnsize->realName );
+            cpu_addressof_16bit( _environment, filename->realName, tnaddress->realName );
+            cpu_inc_16bit( _environment, tnaddress->realName );
+            break;
+        case VT_DSTRING:
+            cpu_dsdescriptor( _environment, filename->realName, tnaddress->realName, tnsize->realName );
+            break;
+    }
+
+    outline1("LDA %s", tnaddress->realName);
+    outline0("STA TMPPTR");
+    outline1("LDA %s", address_displacement(_environment, tnaddress->realName, "1"));
+    outline0("STA TMPPTR+1");
+    outline1("LDA %s", tnsize->realName);
+    outline0("STA MATHPTR0");
+
+    outline1("LDA %s", address->realName);
+    outline0("STA TMPPTR2");
+    outline1("LDA %s", address_displacement(_environment, address->realName, "1"));
+    outline0("STA TMPPTR2+1");
+
+    outline0("JSR ATARIDSTREAM");
+
+}
+
 void atari_dsave( Environment * _environment, char * _filename, char * _offset, char * _address, char * _size ) {
 
     deploy( dcommon, src_hw_atari_dcommon_asm );
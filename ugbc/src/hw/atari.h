@@ -160,6 +160,7 @@ void atari_timer_set_counter( Environment * _environment, char * _timer, char *
 void atari_timer_set_init( Environment * _environment, char * _timer, char * _init );
 void atari_timer_set_address( Environment * _environment, char * _timer, char * _address );
 void atari_dload( Environment * _environment, char * _filename, char * _offset, char * _address, char * _size );
+void atari_dstream( Environment * _environment, char * _filename, char * _address );
 void atari_dsave( Environment * _environment, char * _filename, char * _offset, char * _address, char * _size );
 
 #endif
\ No newline at end of file
@@ -0,0 +1,118 @@
+; /*****************************************************************************
+;  * ugBASIC - an isomorphic BASIC language compiler for retrocomputers        *
+;  *****************************************************************************
+;  * Copyright 2021-2024 Marco Spedaletti (asimov@mclink.it)
+;  *
+;  * Licensed under the Apache License, Version 2.0 (the "License
+;  * you may not use this file eXcept in compliance with the License.
+;  * You may obtain a copy of the License at
+;  *
+;  * http://www.apache.org/licenses/LICENSE-2.0
+;  *
+;  * Unless required by applicable law or agreed to in writing, software
+;  * distributed under the License is distributed on an "AS IS" BASIS,
+;  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either eXpress or implied.
+;  * See the License for the specific language governing permissions and
+;  * limitations under the License.
+;  *----------------------------------------------------------------------------
+;  * Concesso in licenza secondo i termini della Licenza Apache, versione 2.0
+;  * (la "Licenza è proibito usare questo file se non in conformità alla
+;  * Licenza. Una copia della Licenza è disponibile all'indirizzo:
+;  *
+;  * http://www.apache.org/licenses/LICENSE-2.0
+;  *
+;  * Se non richiesto dalla legislazione vigente o concordato per iscritto,
+;  * il software distribuito nei termini della Licenza è distribuito
+;  * "COSì COM'è", SENZA GARANZIE O CONDIZIONI DI ALCUN TIPO, esplicite o
+;  * implicite. Consultare la Licenza per il testo specifico che regola le
+;  * autorizzazioni e le limitazioni previste dalla medesima.
+;  ****************************************************************************/
+;* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+;*                                                                             *
+;*                  DLOAD ROUTINE (WITH DECOMPRESSION) ON ATARI                *
+;*                                                                             *
+;*                             by Marco Spedaletti                             *
+;*                                                                             *
+;* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+ATARIDSTREAMBUFFER:     .RES 128,0
+ATARIDSTREAMCOUNT:      .BYTE 0
+ATARIDSTREAMINDEX:      .BYTE 0
+ATARIDSTREAMSTATUS:     .BYTE 0
+
+; TMPPTR : filename; MATHPTR0: filename size
+; TMPPTR2: address
+;
+; The file is read by blocks of 128 bytes, and every byte is given to the
+; MSC1 streaming decompressor, that will write the uncompressed data 
+; directly at the given address.
+ATARIDSTREAM:
+    JSR ATARIPREPAREFILENAME
+
+    LDX #$10
+    LDA #IOCB_OPEN
+    STA	ICCOM, X
+    LDA #$04
+    STA	ICAUX1, X
+    LDA #<ATARIFILENAME
+    STA ICBADRL, X
+    LDA #>ATARIFILENAME
+    STA ICBADRH, X
+    JSR CIOV
+
+    CPY #127
+    BCC ATARIDSTREAMERRX
+    JMP ATARIDSTREAMERR
+ATARIDSTREAMERRX:
+
+    JSR MSC1STREAMINIT
+
+ATARIDSTREAML1:
+
+    LDX #$10
+    LDA #IOCB_GETCHR
+    STA	ICCOM, X
+    LDA #<ATARIDSTREAMBUFFER
+    STA ICBADRL, X
+    LDA #>ATARIDSTREAMBUFFER
+    STA ICBADRH, X
+    LDA #128
+    STA ICBLENL, X
+    LDA #0
+    STA ICBLENH, X
+    JSR CIOV
+    STY ATARIDSTREAMSTATUS
+
+    ; The number of bytes effectively read is
+    ; given back into the buffer length.
+    LDX #$10
+    LDA ICBLENL, X
+    STA ATARIDSTREAMCOUNT
+    BEQ ATARIDSTREAMEOF
+
+    LDA #0
+    STA ATARIDSTREAMINDEX
+ATARIDSTREAML2:
+    LDX ATARIDSTREAMINDEX
+    LDA ATARIDSTREAMBUFFER, X
+    JSR MSC1STREAMBYTE
+    BCS ATARIDSTREAMEOF
+    INC ATARIDSTREAMINDEX
+    LDA ATARIDSTREAMINDEX
+    CMP ATARIDSTREAMCOUNT
+    BNE ATARIDSTREAML2
+
+    LDA ATARIDSTREAMSTATUS
+    CMP #1
+    BEQ ATARIDSTREAML1
+
+ATARIDSTREAMEOF:
+    LDX #$10
+    LDA #IOCB_CLOSE
+    STA	ICCOM, X
+    JSR CIOV
+    RTS
+
+ATARIDSTREAMERR:
+    STY DLOADERROR
+    RTS
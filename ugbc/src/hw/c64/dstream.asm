@@ -0,0 +1,142 @@
+; /*****************************************************************************
+;  * ugBASIC - an isomorphic BASIC language compiler for retrocomputers        *
+;  *****************************************************************************
+;  * Copyright 2021-2024 Marco Spedaletti (asimov@mclink.it)
+;  *
+;  * Licensed under the Apache License, Version 2.0 (the "License
+;  * you may not use this file eXcept in compliance with the License.
+;  * You may obtain a copy of the License at
+;  *
+;  * http://www.apache.org/licenses/LICENSE-2.0
+;  *
+;  * Unless required by applicable law or agreed to in writing, software
+;  * distributed under the License is distributed on an "AS IS" BASIS,
+;  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either eXpress or implied.
+;  * See the License for the specific language governing permissions and
+;  * limitations under the License.
+;  *----------------------------------------------------------------------------
+;  * Concesso in licenza secondo i termini della Licenza Apache, versione 2.0
+;  * (la "Licenza è proibito usare questo file se non in conformità alla
+;  * Licenza. Una copia della Licenza è disponibile all'indirizzo:
+;  *
+;  * http://www.apache.org/licenses/LICENSE-2.0
+;  *
+;  * Se non richiesto dalla legislazione vigente o concordato per iscritto,
+;  * il software distribuito nei termini della Licenza è distribuito
+;  * "COSì COM'è", SENZA GARANZIE O CONDIZIONI DI ALCUN TIPO, esplicite o
+;  * implicite. Consultare la Licenza per il testo specifico che regola le
+;  * autorizzazioni e le limitazioni previste dalla medesima.
+;  ****************************************************************************/
+;* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+;*                                                                             *
+;*                  DLOAD ROUTINE (WITH DECOMPRESSION) ON C=64                 *
+;*                                                                             *
+;*                             by Marco Spedaletti                             *
+;*                                                                             *
+;* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+; TMPPTR : filename; MATHPTR0: filename size
+; TMPPTR2: address
+;
+; The file is read a byte at a time (by using the KERNAL) and every byte
+; is given to the MSC1 streaming decompressor, that will write the
+; uncompressed data directly at the given address.
+C64DSTREAM:
+
+    ; SETNAM. Set file name parameters.
+    ; Input: A = File name length; X/Y = Pointer to file name.
+
+    LDA #$BD
+    STA SYSCALL0+1
+    LDA #$FF
+    STA SYSCALL0+2
+    LDA MATHPTR0
+    LDX TMPPTR
+    LDY TMPPTR+1
+    JSR SYSCALL
+
+    ; SETLFS. Set file parameters.
+    ; Input: A = Logical number; X = Device number; Y = Secondary address.
+
+    LDA #$BA
+    STA SYSCALL0+1
+    LDA #$02
+    LDX $BA       ; last used device number
+    BNE C64DSTREAMSKIP
+    LDX #$08      ; default to device 8
+C64DSTREAMSKIP:
+    LDY #$02      ; a data channel, to read the file as is
+    JSR SYSCALL
+
+    ; OPEN. Open file. (Must call SETLFS and SETNAM beforehands.)
+    ; Output: Carry: 0 = No errors, 1 = Error; A = KERNAL error code.
+
+    LDA #$C0
+    STA SYSCALL0+1
+    JSR SYSCALL
+    BCC C64DSTREAMOPENED
+    JMP C64DSTREAMERROR
+C64DSTREAMOPENED:
+
+    ; CHKIN. Define file as default input.
+    ; Input: X = Logical number.
+
+    LDA #$C6
+    STA SYSCALL0+1
+    LDX #$02
+    JSR SYSCALL
+    BCS C64DSTREAMERRORCLOSE
+
+    JSR MSC1STREAMINIT
+
+    ; CHRIN. Read byte from default input.
+    ; Output: A = Byte read.
+    ; The first two bytes are the load address, and they are skipped.
+
+    LDA #$CF
+    STA SYSCALL0+1
+    JSR SYSCALL
+    JSR SYSCALL
+
+C64DSTREAML1:
+    LDA #$CF
+    STA SYSCALL0+1
+    JSR SYSCALL
+    JSR MSC1STREAMBYTE
+    BCS C64DSTREAMDONE
+
+    ; READST. Fetch status of current input/output device.
+    ; Output: A = Device status ($40 = end of file).
+
+    LDA #$B7
+    STA SYSCALL0+1
+    JSR SYSCALL
+    CMP #0
+    BEQ C64DSTREAML1
+    AND #$BF
+    BEQ C64DSTREAMDONE
+    STA DLOADERROR
+
+C64DSTREAMDONE:
+
+    ; CLRCHN. Close default input/output files.
+
+    LDA #$CC
+    STA SYSCALL0+1
+    JSR SYSCALL
+
+C64DSTREAMERRORCLOSE:
+
+    ; CLOSE. Close file.
+    ; Input: A = Logical number.
+
+    LDA #$C3
+    STA SYSCALL0+1
+    LDA #$02
+    JSR SYSCALL
+    RTS
+
+C64DSTREAMERROR:
+    ; Accumulator contains KERNAL error code
+    STA DLOADERROR
+    RTS
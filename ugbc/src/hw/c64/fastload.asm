@@ -0,0 +1,533 @@
+; /*****************************************************************************
+;  * ugBASIC - an isomorphic BASIC language compiler for retrocomputers        *
+;  *****************************************************************************
+;  * Copyright 2021-2024 Marco Spedaletti (asimov@mclink.it)
+;  *
+;  * Licensed under the Apache License, Version 2.0 (the "License
+;  * you may not use this file eXcept in compliance with the License.
+;  * You may obtain a copy of the License at
+;  *
+;  * http://www.apache.org/licenses/LICENSE-2.0
+;  *
+;  * Unless required by applicable law or agreed to in writing, software
+;  * distributed under the License is distributed on an "AS IS" BASIS,
+;  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either eXpress or implied.
+;  * See the License for the specific language governing permissions and
+;  * limitations under the License.
+;  *----------------------------------------------------------------------------
+;  * Concesso in licenza secondo i termini della Licenza Apache, versione 2.0
+;  * (la "Licenza è proibito usare questo file se non in conformità alla
+;  * Licenza. Una copia della Licenza è disponibile all'indirizzo:
+;  *
+;  * http://www.apache.org/licenses/LICENSE-2.0
+;  *
+;  * Se non richiesto dalla legislazione vigente o concordato per iscritto,
+;  * il software distribuito nei termini della Licenza è distribuito
+;  * "COSì COM'è", SENZA GARANZIE O CONDIZIONI DI ALCUN TIPO, esplicite o
+;  * implicite. Consultare la Licenza per il testo specifico che regola le
+;  * autorizzazioni e le limitazioni previste dalla medesima.
+;  ****************************************************************************/
+;* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+;*                                                                             *
+;*                       DLOAD ROUTINE ON C=64 (FAST LOADER)                   *
+;*                                                                             *
+;*                             by Marco Spedaletti                             *
+;*                                                                             *
+;* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+; The drive code below is copied into the 1541 memory (at $0500) with a set
+; of "M-W" commands, together with the name of the file, and it is started
+; with "M-E". It looks for the file in the directory and sends every sector
+; to the computer, two bits at a time on the CLK and DATA lines:
+;
+;   - the computer pulls DATA when it is ready to receive a byte;
+;   - the drive pulls CLK when it has a byte to send;
+;   - the computer releases DATA: this is the synchronization point;
+;   - the drive puts the four pairs of bits (lowest first) on the lines,
+;     one every 16 cycles, and the computer samples them in the middle
+;     of each window; then the drive releases the lines.
+;
+; For each sector the drive sends a byte with the number of bytes that
+; follow (1...254), 0 at the end of the file or $FF on error. An error is
+; followed by the code of the failed read job (2...11), or by 0 if the
+; file has not been found. The screen
+; is blanked and the sprites are disabled while loading, since the timing
+; of the computer must not be disturbed by the VIC-II.
+
+; TMPPTR : filename; MATHPTR0: filename size
+; MATHPTR1: 1 if address is NULL; 0 if address is not NULL
+; TMPPTR2: address
+C64FASTLOAD:
+
+    LDA $BA                 ; last used device number
+    BNE C64FASTLOADSKIP
+    LDA #$08                ; default to device 8
+C64FASTLOADSKIP:
+    STA C64FLDEVICE
+
+    ; Copy the drive code, 32 bytes for each "M-W" command.
+
+    LDA #<C64FLDSTART
+    STA C64FLTARGET
+    LDA #>C64FLDSTART
+    STA C64FLTARGET+1
+    LDA #<C64FLDRIVE
+    STA C64FASTLOADSOURCE+1
+    LDA #>C64FLDRIVE
+    STA C64FASTLOADSOURCE+2
+C64FASTLOADUPLOAD:
+    JSR C64FLLISTEN
+    JSR C64FLMW
+    LDA C64FLTARGET
+    JSR C64FLCIOUT
+    LDA C64FLTARGET+1
+    JSR C64FLCIOUT
+    LDA #$20
+    STA C64FLCOUNT
+    JSR C64FLCIOUT
+C64FASTLOADSOURCE:
+    LDA C64FLDRIVE
+    JSR C64FLCIOUT
+    INC C64FASTLOADSOURCE+1
+    BNE C64FASTLOADUPLOADL1
+    INC C64FASTLOADSOURCE+2
+C64FASTLOADUPLOADL1:
+    INC C64FLTARGET
+    BNE C64FASTLOADUPLOADL2
+    INC C64FLTARGET+1
+C64FASTLOADUPLOADL2:
+    DEC C64FLCOUNT
+    BNE C64FASTLOADSOURCE
+    JSR C64FLUNLSN
+    LDA C64FLTARGET
+    CMP #<C64FLDEND
+    LDA C64FLTARGET+1
+    SBC #>C64FLDEND
+    BCC C64FASTLOADUPLOAD
+
+    ; Copy the name of the file, padded with shifted spaces.
+
+    JSR C64FLLISTEN
+    JSR C64FLMW
+    LDA #<C64FLDFILENAME
+    JSR C64FLCIOUT
+    LDA #>C64FLDFILENAME
+    JSR C64FLCIOUT
+    LDA #$10
+    JSR C64FLCIOUT
+    LDA #$00
+    STA C64FLCOUNT
+C64FASTLOADNAME:
+    LDA #$A0
+    LDY C64FLCOUNT
+    CPY MATHPTR0
+    BCS C64FASTLOADNAMEPAD
+    LDA (TMPPTR), Y
+C64FASTLOADNAMEPAD:
+    JSR C64FLCIOUT
+    INC C64FLCOUNT
+    LDA C64FLCOUNT
+    CMP #$10
+    BNE C64FASTLOADNAME
+    JSR C64FLUNLSN
+
+    ; Start the drive code.
+
+    JSR C64FLLISTEN
+    LDA #'M'
+    JSR C64FLCIOUT
+    LDA #'-'
+    JSR C64FLCIOUT
+    LDA #'E'
+    JSR C64FLCIOUT
+    LDA #<C64FLDSTART
+    JSR C64FLCIOUT
+    LDA #>C64FLDSTART
+    JSR C64FLCIOUT
+    JSR C64FLUNLSN
+
+    ; From now on, the timing must be exact: no interrupts, no
+    ; badlines and no sprites. The screen is blanked and we wait
+    ; for the lower border, so that the next frame has no badlines.
+
+    SEI
+    LDA $D011
+    AND #$10
+    STA C64FLD011
+    LDA $D011
+    AND #$6F
+    STA $D011
+    LDA $D015
+    STA C64FLD015
+    LDA #$00
+    STA $D015
+C64FASTLOADWAIT:
+    BIT $D011
+    BPL C64FASTLOADWAIT
+
+    ; Values of $DD00 with all the lines released, and with DATA pulled.
+
+    LDA $DD00
+    AND #$07
+    STA C64FLBASE
+    ORA #$20
+    STA C64FLREADY
+
+    LDA #$02
+    STA C64FLSKIP
+
+C64FASTLOADSECTOR:
+    JSR C64FLGET
+    BEQ C64FASTLOADDONE
+    CMP #$FF
+    BEQ C64FASTLOADERROR
+    TAX
+C64FASTLOADBYTE:
+    JSR C64FLGET
+    LDY C64FLSKIP
+    BEQ C64FASTLOADSTORE
+
+    ; The first two bytes are the load address of the file.
+
+    DEC C64FLSKIP
+    CPY #$02
+    BNE C64FASTLOADHIGH
+    STA C64FLADDRESS
+    JMP C64FASTLOADNEXT
+C64FASTLOADHIGH:
+    STA C64FLADDRESS+1
+    LDA MATHPTR1
+    BEQ C64FASTLOADNEXT
+    LDA C64FLADDRESS
+    STA TMPPTR2
+    LDA C64FLADDRESS+1
+    STA TMPPTR2+1
+    JMP C64FASTLOADNEXT
+
+C64FASTLOADSTORE:
+    STA (TMPPTR2), Y
+    INC TMPPTR2
+    BNE C64FASTLOADNEXT
+    INC TMPPTR2+1
+C64FASTLOADNEXT:
+    DEX
+    BNE C64FASTLOADBYTE
+    JMP C64FASTLOADSECTOR
+
+C64FASTLOADERROR:
+    JSR C64FLGET            ; code of the failed job (0 = not found)
+    BEQ C64FASTLOADNOTFOUND
+    CLC
+    ADC #18                 ; DOS error (i.e. 20 READ ERROR, 23 CHECKSUM)
+    STA DLOADERROR
+    JMP C64FASTLOADDONE
+C64FASTLOADNOTFOUND:
+    LDA #$04                ; FILE NOT FOUND
+    STA DLOADERROR
+C64FASTLOADDONE:
+    LDA C64FLBASE
+    STA $DD00
+    LDA C64FLD015
+    STA $D015
+    LDA $D011
+    AND #$7F
+    ORA C64FLD011
+    STA $D011
+    CLI
+    RTS
+
+; Receive a byte from the drive. Preserves X and Y.
+C64FLGET:
+    LDA C64FLREADY
+    STA $DD00               ; pull DATA: ready to receive
+    LDA C64FLBASE
+C64FLGETWAIT:
+    BIT $DD00
+    BVS C64FLGETWAIT        ; wait until the drive pulls CLK
+    STA $DD00               ; release DATA (t=0)
+    NOP
+    NOP
+    NOP
+    NOP
+    NOP
+    NOP
+    NOP
+    LDA $DD00               ; t=18: bits 1 and 0
+    STA C64FLBITS
+    NOP
+    NOP
+    NOP
+    NOP
+    LDA $DD00               ; t=34: bits 3 and 2
+    STA C64FLBITS+1
+    NOP
+    NOP
+    NOP
+    NOP
+    LDA $DD00               ; t=50: bits 5 and 4
+    STA C64FLBITS+2
+    NOP
+    NOP
+    NOP
+    NOP
+    LDA $DD00               ; t=66: bits 7 and 6
+    AND #$C0
+    STA C64FLBITS+3
+    LDA C64FLBITS+2
+    AND #$C0
+    LSR
+    LSR
+    ORA C64FLBITS+3
+    STA C64FLBITS+3
+    LDA C64FLBITS+1
+    AND #$C0
+    LSR
+    LSR
+    LSR
+    LSR
+    ORA C64FLBITS+3
+    STA C64FLBITS+3
+    LDA C64FLBITS
+    ASL
+    ROL
+    ROL
+    AND #$03
+    ORA C64FLBITS+3
+    RTS
+
+; Send "M-W" on the command channel.
+C64FLMW:
+    LDA #'M'
+    JSR C64FLCIOUT
+    LDA #'-'
+    JSR C64FLCIOUT
+    LDA #'W'
+    JMP C64FLCIOUT
+
+; LISTEN and SECOND on the command channel (15).
+C64FLLISTEN:
+    LDA #$B1
+    STA SYSCALL0+1
+    LDA #$FF
+    STA SYSCALL0+2
+    LDA C64FLDEVICE
+    JSR SYSCALL
+    LDA #$93
+    STA SYSCALL0+1
+    LDA #$6F
+    JMP SYSCALL
+
+; CIOUT. Send the byte in A.
+C64FLCIOUT:
+    PHA
+    LDA #$A8
+    STA SYSCALL0+1
+    LDA #$FF
+    STA SYSCALL0+2
+    PLA
+    JMP SYSCALL
+
+; UNLSN. The drive executes the command.
+C64FLUNLSN:
+    LDA #$AE
+    STA SYSCALL0+1
+    LDA #$FF
+    STA SYSCALL0+2
+    JMP SYSCALL
+
+C64FLDEVICE:    .byte $00
+C64FLTARGET:    .byte $00, $00
+C64FLCOUNT:     .byte $00
+C64FLSKIP:      .byte $00
+C64FLADDRESS:   .byte $00, $00
+C64FLBASE:      .byte $00
+C64FLREADY:     .byte $00
+C64FLD011:      .byte $00
+C64FLD015:      .byte $00
+C64FLBITS:      .byte $00, $00, $00, $00
+
+; ----------------------------------------------------------------------------
+; Drive code (1541), it runs at $0500.
+; ----------------------------------------------------------------------------
+
+C64FLDRIVE:
+    .org $0500
+C64FLDSTART:
+    JMP C64FLDMAIN
+
+; Send the byte in A. Preserves Y. It stays in the first page, so that
+; the branches take always the same time.
+C64FLDSEND:
+    STA C64FLDBYTE
+    AND #$03
+    TAX
+    LDA C64FLDENCODE, X
+    STA C64FLDPAIRS
+    LDA C64FLDBYTE
+    LSR
+    LSR
+    STA C64FLDBYTE
+    AND #$03
+    TAX
+    LDA C64FLDENCODE, X
+    STA C64FLDPAIRS+1
+    LDA C64FLDBYTE
+    LSR
+    LSR
+    STA C64FLDBYTE
+    AND #$03
+    TAX
+    LDA C64FLDENCODE, X
+    STA C64FLDPAIRS+2
+    LDA C64FLDBYTE
+    LSR
+    LSR
+    TAX
+    LDA C64FLDENCODE, X
+    STA C64FLDPAIRS+3
+    LDX C64FLDPAIRS
+    SEI
+    LDA #$01
+C64FLDSENDREADY:
+    BIT $1800
+    BEQ C64FLDSENDREADY     ; wait until the computer pulls DATA
+    LDA #$08
+    STA $1800               ; pull CLK: a byte is ready
+    LDA #$01
+C64FLDSENDSYNC:
+    BIT $1800
+    BNE C64FLDSENDSYNC      ; wait until the computer releases DATA (t=0)
+    STX $1800               ; t=6
+    NOP
+    NOP
+    NOP
+    NOP
+    LDA C64FLDPAIRS+1
+    STA $1800               ; t=22
+    NOP
+    NOP
+    NOP
+    NOP
+    LDA C64FLDPAIRS+2
+    STA $1800               ; t=38
+    NOP
+    NOP
+    NOP
+    NOP
+    LDA C64FLDPAIRS+3
+    STA $1800               ; t=54
+    NOP
+    NOP
+    NOP
+    NOP
+    NOP
+    LDA #$00
+    STA $1800               ; t=70: release CLK and DATA
+    CLI
+    RTS
+
+C64FLDMAIN:
+    LDA #$00
+    STA $1800               ; release CLK and DATA
+
+    ; The directory starts at 18/1.
+
+    LDA #18
+    STA $06
+    LDA #1
+    STA $07
+C64FLDDIR:
+    JSR C64FLDREAD
+    BCS C64FLDERROR
+    LDX #$00
+C64FLDENTRY:
+    STX C64FLDPOSITION
+    LDA $0302, X            ; file type (0 = free entry)
+    BEQ C64FLDNEXT
+    LDY #$00
+C64FLDNAME:
+    LDA C64FLDFILENAME, Y
+    CMP #$2A                ; "*" matches the rest of the name
+    BEQ C64FLDFOUND
+    CMP $0305, X
+    BNE C64FLDNEXT
+    INX
+    INY
+    CPY #$10
+    BNE C64FLDNAME
+C64FLDFOUND:
+    LDX C64FLDPOSITION
+    LDA $0303, X
+    STA $06
+    LDA $0304, X
+    STA $07
+    JMP C64FLDFILE
+C64FLDNEXT:
+    LDA C64FLDPOSITION
+    CLC
+    ADC #$20
+    TAX
+    BNE C64FLDENTRY
+    LDA $0301
+    STA $07
+    LDA $0300
+    STA $06
+    BNE C64FLDDIR
+    LDA #$00                ; end of the directory: file not found
+C64FLDERROR:
+    PHA
+    LDA #$FF
+    JSR C64FLDSEND
+    PLA
+    JMP C64FLDSEND
+
+C64FLDFILE:
+    JSR C64FLDREAD
+    BCS C64FLDERROR
+    LDX #$FE                ; a full sector has 254 bytes
+    LDA $0300
+    BNE C64FLDFULL
+    LDX $0301               ; the last one has them up to the given index
+    DEX
+    BEQ C64FLDEOF
+C64FLDFULL:
+    STX C64FLDCOUNT
+    TXA
+    JSR C64FLDSEND
+    LDY #$02
+C64FLDDATA:
+    LDA $0300, Y
+    JSR C64FLDSEND
+    INY
+    DEC C64FLDCOUNT
+    BNE C64FLDDATA
+    LDA $0301
+    STA $07
+    LDA $0300
+    STA $06
+    BNE C64FLDFILE
+C64FLDEOF:
+    LDA #$00
+    JMP C64FLDSEND
+
+; Read the sector at $06/$07 into $0300 (carry set on error).
+C64FLDREAD:
+    LDA #$80                ; job: read a sector
+    STA $00
+    CLI
+C64FLDREADWAIT:
+    LDA $00
+    BMI C64FLDREADWAIT
+    CMP #$02                ; 1 = OK
+    RTS
+
+; Value of $1800 for each pair of bits: CLK carries bit 0, DATA bit 1
+; (a line is pulled when the bit is 0).
+C64FLDENCODE:   .byte $0A, $02, $08, $00
+C64FLDPOSITION: .byte $00
+C64FLDCOUNT:    .byte $00
+C64FLDBYTE:     .byte $00
+C64FLDPAIRS:    .byte $00, $00, $00, $00
+C64FLDFILENAME: .res 16, $A0
+C64FLDEND:
+    .reloc
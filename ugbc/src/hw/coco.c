@@ -384,6 +384,42 @@ void coco_dload( Environment * _environment, char * _filename, char * _offset, c
 
 }
 
+void coco_dstream( Environment * _environment, char * _filename, char * _address ) {
+
+    deploy( dcommon, src_hw_coco_dcommon_asm);
+    deploy( dload, src_hw_coco_dload_asm);
+    deploy( msc1stream, src_hw_6809_msc1stream_asm );
+    deploy( dstream, src_hw_coco_dstream_asm );
+
+    MAKE_LABEL
+    
+    Variable * filename = variable_retrieve( _environment, _filename );
+    Variable * tnaddress = variable_temporary( _environment, VT_ADDRESS, "(address of target_name)");
+    Variable * tnsize = variable_temporary( _environment, VT_BYTE, "(size of target_name)");
+
+    Variable * address = variable_retrieve( _environment, _address );
+
+    switch( filename->type ) {
+        case VT_STRING:
+            cpu_move_8bit( _environment, filename->realName, tnsize->realName );
+            cpu_addressof_16bit( _environment, filename->realName, tnaddress->realName );
+            cpu_inc_16bit( _environment, tnaddress->realName );
+            break;
+        case VT_DSTRING:
+            cpu_dsdescriptor( _environment, filename->realName, tnaddress->realName, tnsize->realName );
+            break;
+    }
+
+    outline1("LDB %s", tnsize->realName);
+    outline0("CLRA");
+    outline0("TFR D, U");
+    outline1("LDX %s", tnaddress->realName);
+    outline1("LDY %s", address->realName);
+
+    outline0("JSR COCODSTREAM");
+
+}
+
 void coco_dsave( Environment * _environment, char * _filename, char * _offset, char * _address, char * _size ) {
 
     deploy( dcommon, src_hw_coco_dcommon_asm);
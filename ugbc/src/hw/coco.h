@@ -175,6 +175,7 @@ void coco_timer_set_counter( Environment * _environment, char * _timer, char * _
 void coco_timer_set_init( Environment * _environment, char * _timer, char * _init );
 void coco_timer_set_address( Environment * _environment, char * _timer, char * _address );
 void coco_dload( Environment * _environment, char * _filename, char * _offset, char * _address, char * _size );
+void coco_dstream( Environment * _environment, char * _filename, char * _address );
 void coco_dsave( Environment * _environment, char * _filename, char * _offset, char * _address, char * _size );
 
 #endif
\ No newline at end of file
@@ -57,8 +57,9 @@ COCODLOADFILEREAD
     PULS D,X,Y,U,PC
 
 ; X : filename, U : size of filename
-; Y : destination area
-COCODLOAD
+; Y : destination area (preserved)
+; Carry set on error (with error code in B)
+COCODLOADOPEN
     PSHS Y
     LDY #$094C
     LDA #32
@@ -111,7 +112,12 @@ COCODLOADENDE
     STA $006F
     LDB #1
     LDA #'I'
-    JSR COCODCOMMONFILEOPEN
+    JMP COCODCOMMONFILEOPEN
+
+; X : filename, U : size of filename
+; Y : destination area
+COCODLOAD
+    JSR COCODLOADOPEN
     BCS COCODLOADERR
 
 COCODLOADREADL1
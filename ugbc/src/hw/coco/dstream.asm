@@ -0,0 +1,69 @@
+; /*****************************************************************************
+;  * ugBASIC - an isomorphic BASIC language compiler for retrocomputers        *
+;  *****************************************************************************
+;  * Copyright 2021-2024 Marco Spedaletti (asimov@mclink.it)
+;  *
+;  * Licensed under the Apache License, Version 2.0 (the "License
+;  * you may not use this file eXcept in compliance with the License.
+;  * You may obtain a copy of the License at
+;  *
+;  * http://www.apache.org/licenses/LICENSE-2.0
+;  *
+;  * Unless required by applicable law or agreed to in writing, software
+;  * distributed under the License is distributed on an "AS IS" BASIS,
+;  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either eXpress or implied.
+;  * See the License for the specific language governing permissions and
+;  * limitations under the License.
+;  *----------------------------------------------------------------------------
+;  * Concesso in licenza secondo i termini della Licenza Apache, versione 2.0
+;  * (la "Licenza è proibito usare questo file se non in conformità alla
+;  * Licenza. Una copia della Licenza è disponibile all'indirizzo:
+;  *
+;  * http://www.apache.org/licenses/LICENSE-2.0
+;  *
+;  * Se non richiesto dalla legislazione vigente o concordato per iscritto,
+;  * il software distribuito nei termini della Licenza è distribuito
+;  * "COSì COM'è", SENZA GARANZIE O CONDIZIONI DI ALCUN TIPO, esplicite o
+;  * implicite. Consultare la Licenza per il testo specifico che regola le
+;  * autorizzazioni e le limitazioni previste dalla medesima.
+;  ****************************************************************************/
+;* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+;*                                                                             *
+;*                  DLOAD ROUTINE (WITH DECOMPRESSION) ON COCO                 *
+;*                                                                             *
+;*                             by Marco Spedaletti                             *
+;*                                                                             *
+;* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+; X : filename, U : size of filename
+; Y : destination area
+;
+; The file is read a byte at a time, and every byte is given to the
+; MSC1 streaming decompressor, that will write the uncompressed data 
+; directly at the given address.
+COCODSTREAM
+    JSR COCODLOADOPEN
+    BCS COCODSTREAMERR
+
+    JSR MSC1STREAMINIT
+
+COCODSTREAMREADL1
+    LDA #1
+    STA $006F
+    LDB #1
+    JSR COCODLOADFILEREAD
+    LDB $0070
+    BNE COCODSTREAMREADDONE
+    JSR MSC1STREAMBYTE
+    BCS COCODSTREAMREADDONE
+    JMP COCODSTREAMREADL1
+
+COCODSTREAMREADDONE
+    LDA #1
+    STA $006F
+    LDB #1
+    JSR COCODCOMMONFILECLOSE
+
+COCODSTREAMERR
+    STB DLOADERROR
+    RTS
@@ -106,6 +106,9 @@ DATAPTR fdb  0
 
 TIMERRUNNING   fcb   $0
 TIMERSTATUS    fcb   $0
+TIMERACTIVE    fcb   $0, $0, $0, $0, $0, $0, $0, $0
+TIMERACTIVECOUNT   fcb   $0
+TIMERACTIVEDIRTY   fcb   $0
 TIMERCOUNTER   fdb   $0, $0, $0, $0, $0, $0, $0, $0
 TIMERINIT      fdb   $0, $0, $0, $0, $0, $0, $0, $0
 TIMERADDRESS   fdb   $0, $0, $0, $0, $0, $0, $0, $0
@@ -490,7 +490,7 @@ static int rgbConverterFunction( int _red, int _green, int _blue ) {
     rgb.blue = _blue;
 
     for (j = 0; j < sizeof(SYSTEM_PALETTE)/sizeof(RGBi); ++j) {
-        int distance = rgbi_distance(&SYSTEM_PALETTE[j], &rgb);
+        int distance = rgbi_distance_squared(&SYSTEM_PALETTE[j], &rgb);
         if (distance < minDistance) {
             minDistance = distance;
             colorIndex = SYSTEM_PALETTE[j].hardwareIndex;
@@ -1270,9 +1270,9 @@ static Variable * cpc_image_converter_bitmap_mode_hires( Environment * _environm
             if ( rgb.alpha < 255 ) {
                 colorIndex = 0;
             } else {
-                int minDistance = 9999;
+                int minDistance = 0x7fffffff;
                 for( int i=(_transparent_color)?1:0; i<lastUsedSlotInCommonPalette; ++i ) {
-                    int distance = rgbi_distance(&commonPalette[i], &rgb );
+                    int distance = rgbi_distance_squared(&commonPalette[i], &rgb );
                     if ( distance < minDistance ) {
                         minDistance = distance;
                         colorIndex = i;
@@ -1438,9 +1438,9 @@ static Variable * cpc_image_converter_multicolor_mode_midres( Environment * _env
             if ( rgb.alpha < 255 ) {
                 colorIndex = 0;
             } else {
-                int minDistance = 9999;
+                int minDistance = 0x7fffffff;
                 for( int i=(_transparent_color)?1:0; i<lastUsedSlotInCommonPalette; ++i ) {
-                    int distance = rgbi_distance(&commonPalette[i], &rgb );
+                    int distance = rgbi_distance_squared(&commonPalette[i], &rgb );
                     if ( distance < minDistance ) {
                         minDistance = distance;
                         colorIndex = i;
@@ -1640,9 +1640,9 @@ static Variable * cpc_image_converter_multicolor_mode_lores( Environment * _envi
             if ( rgb.alpha < 255 ) {
                 colorIndex = 0;
             } else {
-                int minDistance = 9999;
+                int minDistance = 0x7fffffff;
                 for( int i=(_transparent_color)?1:0; i<lastUsedSlotInCommonPalette; ++i ) {
-                    int distance = rgbi_distance(&commonPalette[i], &rgb );
+                    int distance = rgbi_distance_squared(&commonPalette[i], &rgb );
                     if ( distance < minDistance ) {
                         minDistance = distance;
                         colorIndex = i;
@@ -62,10 +62,10 @@ static RGBi SYSTEM_PALETTE[] = {
 
 RGBi * ef9345_image_nearest_system_color( RGBi * _color ) {
 
-    int minDistance = 0xffff;
+    int minDistance = 0x7fffffff;
     int colorIndex = 0;
     for (int j = 0; j < COLOR_COUNT; ++j) {
-        int distance = rgbi_distance(&SYSTEM_PALETTE[j], _color);
+        int distance = rgbi_distance_squared(&SYSTEM_PALETTE[j], _color);
         if (distance < minDistance) {
             minDistance = distance;
             colorIndex = j;
@@ -454,7 +454,7 @@ static int rgbConverterFunction( int _red, int _green, int _blue ) {
     rgb.blue = _blue;
 
     for (j = 0; j < sizeof(SYSTEM_PALETTE)/sizeof(RGBi); ++j) {
-        int distance = rgbi_distance(&SYSTEM_PALETTE[j], &rgb);
+        int distance = rgbi_distance_squared(&SYSTEM_PALETTE[j], &rgb);
         if (distance < minDistance) {
             minDistance = distance;
             colorIndex = j;
@@ -944,10 +944,10 @@ Variable * ef9345_sprite_converter( Environment * _environment, char * _source,
     // int i, j, k;
 
     // for( i=0; i<colorUsed; ++i ) {
-    //     int minDistance = 0xffff;
+    //     int minDistance = 0x7fffffff;
     //     int colorIndex = 0;
     //     for (j = 0; j < sizeof(SYSTEM_PALETTE)/sizeof(RGBi); ++j) {
-    //         int distance = rgbi_distance(&SYSTEM_PALETTE[j], &palette[i]);
+    //         int distance = rgbi_distance_squared(&SYSTEM_PALETTE[j], &palette[i]);
     //         if (distance < minDistance) {
     //             for( k=0; k<i; ++k ) {
     //                 if ( palette[k].index == SYSTEM_PALETTE[j].index ) {
@@ -1009,7 +1009,7 @@ Variable * ef9345_sprite_converter( Environment * _environment, char * _source,
     //         // and the bit to set.
     //         offset = (image_y * ( _width>>3 ) ) + (image_x >> 3);
 
-    //         int minDistance = 0xffff;
+    //         int minDistance = 0x7fffffff;
     //         int colorIndex = 0;
 
     //         if ( rgbi_equals_rgba( _color, &rgb ) ) {
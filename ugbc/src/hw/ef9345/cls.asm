@@ -56,35 +56,20 @@ CLS:
 
     LD B, $19
 CLSL1:
-    LD C, $28
+    PUSH BC
 
-    LD D, REGISTER7
-    LD E, 0
-    CALL EF9345LIB
-
-    LD D, REGISTER6
     LD A, B
     DEC A
     CP 0
     JR Z, CLSL10Y
     ADD $07
 CLSL10Y:
-    LD E, A
-    CALL EF9345LIB
-
-CLSL2:
-
-    LD D, REGISTER1
+    LD D, A
+    LD E, 0
     LD A, (EMPTYTILE)
-    LD E, A
-    CALL EF9345LIB
+    LD B, $28
+    CALL EF9345BURSTFILL
 
-    LD D, REGISTERE
-    LD E, 1
-    CALL EF9345LIB
-
-    DEC     C
-    JP      NZ, CLSL2
-    DJNZ    CLSL1
+    POP BC
+    DJNZ CLSL1
     RET
-
@@ -106,6 +106,61 @@ EF9345LIBR:
     POP BC
     RET
 
+; PREPARE A BURST OF CHARACTERS: SET THE POINTER AND THE KRF COMMAND
+; WITH AUTO INCREMENT (R0 = $01) WITHOUT EXECUTING IT. FROM NOW ON, EACH
+; WRITE OF R1 WITH THE EXECUTION FLAG (REGISTER1E) WRITES ONE CHARACTER
+; AND MOVES THE POINTER TO THE NEXT ONE.
+;    D = row (R6)
+;    E = column (R7)
+EF9345BURSTPOS:
+    PUSH DE
+    LD E, D
+    LD D, REGISTER6
+    CALL EF9345LIB
+    POP DE
+    LD D, REGISTER7
+    CALL EF9345LIB
+    LD D, REGISTER0
+    LD E, $01
+    CALL EF9345LIB
+    RET
+
+; WRITE A BURST OF CHARACTERS
+;    D = row (R6)
+;    E = column (R7)
+;    HL = characters (it is advanced by the count)
+;    B = count
+EF9345BURSTWRITE:
+    CALL EF9345BURSTPOS
+EF9345BURSTWRITEL1:
+    CALL EF9345WAIT
+    LD A, REGISTER1E
+    OUT ($8F), A
+    LD A, (HL)
+    OUT ($CF), A
+    INC HL
+    DJNZ EF9345BURSTWRITEL1
+    RET
+
+; FILL A BURST OF CHARACTERS
+;    D = row (R6)
+;    E = column (R7)
+;    A = character
+;    B = count
+EF9345BURSTFILL:
+    PUSH AF
+    CALL EF9345BURSTPOS
+    POP AF
+    LD E, A
+EF9345BURSTFILLL1:
+    CALL EF9345WAIT
+    LD A, REGISTER1E
+    OUT ($8F), A
+    LD A, E
+    OUT ($CF), A
+    DJNZ EF9345BURSTFILLL1
+    RET
+
 ; Startup for EF9345
 EF9345STARTUP:
 
@@ -1071,10 +1071,10 @@ static Variable * ef936x_image_converter_bitmap_mode_standard( Environment * _en
             if ( rgb.alpha < 255 ) {
                 colorIndex = 0;
             } else {
-                unsigned int minDistance = 0xffff;
+                unsigned int minDistance = 0xffffffff;
                 for( i=firstIndex; i<lastUsedSlotInCommonPalette; ++i ) {
                     if ( commonPalette[i].alpha < 255 ) continue;
-                    unsigned int distance = rgbi_distance(&commonPalette[i], &rgb);
+                    unsigned int distance = rgbi_distance_squared(&commonPalette[i], &rgb);
                     if ( minDistance > distance ) {
                         minDistance = distance;
                         colorIndex = i;
@@ -1243,10 +1243,10 @@ static Variable * ef936x_image_converter_multicolor_mode_standard( Environment *
                 if ( rgb.alpha < 255 ) {
                     colorIndexes[xx] = 0;
                 } else {
-                    int minDistance = 9999;
+                    int minDistance = 0x7fffffff;
                     for( int i=firstIndex; i<lastUsedSlotInCommonPalette; ++i ) {
                     if ( commonPalette[i].alpha < 255 ) continue;
-                        int distance = rgbi_distance(&commonPalette[i], &rgb );
+                        int distance = rgbi_distance_squared(&commonPalette[i], &rgb );
                         if ( distance < minDistance ) {
                             minDistance = distance;
                             colorIndexes[xx] = i;
@@ -1454,7 +1454,7 @@ static Variable * ef936x_image_converter_multicolor_mode4( Environment * _enviro
                 rgb.blue = 0;
             }
 
-            unsigned int minDistance = 0xffff;
+            unsigned int minDistance = 0xffffffff;
             int colorIndex = 0;
             int firstIndex = 0;
             if ( _transparent_color & 0x0f0000 ) {
@@ -1468,7 +1468,7 @@ static Variable * ef936x_image_converter_multicolor_mode4( Environment * _enviro
             } else {
                 for( i=firstIndex; i<lastUsedSlotInCommonPalette; ++i ) {
                     if ( commonPalette[i].alpha < 255 ) continue;
-                    unsigned int distance = rgbi_distance(&commonPalette[i], &rgb);
+                    unsigned int distance = rgbi_distance_squared(&commonPalette[i], &rgb);
                     if ( minDistance > distance ) {
                         minDistance = distance;
                         colorIndex = i;
@@ -1637,7 +1637,7 @@ static Variable * ef936x_image_converter_multicolor_mode16( Environment * _envir
                 rgb.blue = 0;
             }
 
-            int minDistance = 0xffff;
+            int minDistance = 0x7fffffff;
             int colorIndex = 0;
             int firstIndex = 0;
             if ( _transparent_color & 0x0f0000 ) {
@@ -1651,7 +1651,7 @@ static Variable * ef936x_image_converter_multicolor_mode16( Environment * _envir
             } else {
                 for( i=firstIndex; i<lastUsedSlotInCommonPalette; ++i ) {
                     if ( commonPalette[i].alpha < 255 ) continue;
-                    int distance = rgbi_distance(&commonPalette[i], &rgb);
+                    int distance = rgbi_distance_squared(&commonPalette[i], &rgb);
                     if ( minDistance > distance ) {
                         minDistance = distance;
                         colorIndex = i;
@@ -1991,9 +1991,9 @@ static Variable * gime_image_converter_bitmap_mode_hires( Environment * _environ
             if ( rgb.alpha < 255 ) {
                 colorIndex = 0;
             } else {
-                int minDistance = 9999;
+                int minDistance = 0x7fffffff;
                 for( int i=(_transparent_color)?1:0; i<lastUsedSlotInCommonPalette; ++i ) {
-                    int distance = rgbi_distance(&commonPalette[i], &rgb );
+                    int distance = rgbi_distance_squared(&commonPalette[i], &rgb );
                     if ( distance < minDistance ) {
                         minDistance = distance;
                         colorIndex = i;
@@ -2159,9 +2159,9 @@ static Variable * gime_image_converter_multicolor_mode_midres( Environment * _en
             if ( rgb.alpha < 255 ) {
                 colorIndex = 0;
             } else {
-                int minDistance = 9999;
+                int minDistance = 0x7fffffff;
                 for( int i=(_transparent_color)?1:0; i<lastUsedSlotInCommonPalette; ++i ) {
-                    int distance = rgbi_distance(&commonPalette[i], &rgb );
+                    int distance = rgbi_distance_squared(&commonPalette[i], &rgb );
                     if ( distance < minDistance ) {
                         minDistance = distance;
                         colorIndex = i;
@@ -2360,9 +2360,9 @@ static Variable * gime_image_converter_multicolor_mode_lores( Environment * _env
             if ( rgb.alpha < 255 ) {
                 colorIndex = 0;
             } else {
-                int minDistance = 9999;
+                int minDistance = 0x7fffffff;
                 for( int i=(_transparent_color)?1:0; i<lastUsedSlotInCommonPalette; ++i ) {
-                    int distance = rgbi_distance(&commonPalette[i], &rgb );
+                    int distance = rgbi_distance_squared(&commonPalette[i], &rgb );
                     if ( distance < minDistance ) {
                         minDistance = distance;
                         colorIndex = i;
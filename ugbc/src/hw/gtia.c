@@ -699,6 +699,64 @@ static int rgbConverterFunction( int _red, int _green, int _blue ) {
     
 }
 
+/**
+ * @brief Rewrite a display list for the virtual playfield
+ * 
+ * Every mode line of the given display list is given its own LMS (with
+ * fine scroll enabled in both directions), pointing to the corresponding
+ * row of the playfield. Blank lines and jumps are kept as they are.
+ * 
+ * @param _environment Current calling environment
+ * @param _list Original display list
+ * @param _size Size of the original display list
+ * @param _result Display list with one LMS for each mode line
+ * @param _lms_offset Offset of the first LMS address (output)
+ * @param _jvb_offset Offset of the JVB address (output)
+ * @param _rows Number of mode lines (output)
+ * @param _row_bytes Bytes fetched for each mode line (output)
+ * @return Size of the new display list
+ */
+static int gtia_playfield_display_list( Environment * _environment, unsigned char * _list, int _size, unsigned char * _result, int * _lms_offset, int * _jvb_offset, int * _rows, int * _row_bytes ) {
+
+    unsigned char * current = _result;
+    int i = 0;
+
+    *_lms_offset = 0;
+    *_rows = 0;
+    *_row_bytes = 40;
+
+    while( i < _size ) {
+        unsigned char instruction = _list[i];
+        int mode = instruction & 0x0f;
+        if ( mode == 0 ) {
+            *current++ = instruction;
+            ++i;
+        } else if ( mode == 1 ) {
+            *current++ = _list[i];
+            *current++ = _list[i+1];
+            *current++ = _list[i+2];
+            *_jvb_offset = current - _result - 2;
+            i += 3;
+        } else {
+            int address = _environment->frameBufferStart + *_rows * _environment->playfieldWidth;
+            // Modes 6 and 7 have 20 bytes per line, that become 24 with
+            // horizontal scrolling; the others have 40 bytes (48).
+            *_row_bytes = ( mode == 6 || mode == 7 ) ? 24 : 48;
+            *current++ = ( instruction & 0xa0 ) | 0x40 | 0x10 | mode;
+            if ( ! *_lms_offset ) {
+                *_lms_offset = current - _result;
+            }
+            *current++ = ( address & 0xff );
+            *current++ = ( address >> 8 ) & 0xff;
+            ++*_rows;
+            i += ( instruction & 0x40 ) ? 3 : 1;
+        }
+    }
+
+    return current - _result;
+
+}
+
 int gtia_screen_mode_enable( Environment * _environment, ScreenMode * _screen_mode ) {
 
     int i;
@@ -1475,6 +1533,41 @@ int gtia_screen_mode_enable( Environment * _environment, ScreenMode * _screen_mo
             CRITICAL_SCREEN_UNSUPPORTED( _screen_mode->id );
     }
 
+    if ( _environment->playfieldWidth && ! _screen_mode->bitmap ) {
+
+        int playfieldSize = _environment->playfieldWidth * _environment->playfieldHeight;
+        if ( _environment->frameBufferStart > ( 0xc000 - playfieldSize ) ) {
+            _environment->frameBufferStart = ( ( 0xc000 - playfieldSize ) >> 8 ) << 8;
+        }
+
+        int rows, rowBytes;
+        unsigned char * playfieldList = malloc( DLI_COUNT );
+        int playfieldListSize = gtia_playfield_display_list( _environment, dliListStart, dliListCurrent - dliListStart, playfieldList, &screenMemoryOffset, &dliListStartOffset, &rows, &rowBytes );
+        free( dliListStart );
+        dliListStart = playfieldList;
+        dliListCurrent = playfieldList + playfieldListSize;
+
+        if ( _environment->playfieldHeight < rows ) {
+            CRITICAL_INVALID_PLAYFIELD_HEIGHT( _environment->playfieldHeight );
+        }
+
+        int shift = 0;
+        while( ( 1 << shift ) < _environment->playfieldWidth ) {
+            ++shift;
+        }
+
+        cpu_store_16bit( _environment, "PLAYFIELDWIDTH", _environment->playfieldWidth );
+        cpu_store_8bit( _environment, "PLAYFIELDSHIFT", shift );
+        cpu_store_16bit( _environment, "PLAYFIELDLMS", screenMemoryOffset );
+        cpu_store_8bit( _environment, "PLAYFIELDROWS", rows );
+        cpu_store_8bit( _environment, "PLAYFIELDXSTEP", rowBytes == 24 ? 1 : 2 );
+        cpu_store_8bit( _environment, "PLAYFIELDXMAX", _environment->playfieldWidth - rowBytes );
+        cpu_store_8bit( _environment, "PLAYFIELDYMAX", _environment->playfieldHeight - rows );
+        cpu_store_8bit( _environment, "PLAYFIELDX", 0 );
+        cpu_store_8bit( _environment, "PLAYFIELDY", 0 );
+
+    }
+
     cpu_store_16bit( _environment, "CURRENTWIDTH", _environment->screenWidth );
     cpu_store_16bit( _environment, "CURRENTHEIGHT", _environment->screenHeight );
     cpu_move_16bit( _environment, "CURRENTWIDTH", "RESOLUTIONX" );
@@ -1879,8 +1972,40 @@ void gtia_clear( Environment * _environment, char * _pattern ) {
 
 }
 
+/**
+ * @brief Move the virtual playfield by one step
+ * 
+ * The window on the playfield is moved by rewriting the LMS addresses of
+ * the display list, during the vertical blank: nothing is copied.
+ * 
+ * @param _environment Current calling environment
+ * @param _dx Horizontal direction (-1, 0, 1)
+ * @param _dy Vertical direction (-1, 0, 1)
+ */
+static void gtia_playfield_step( Environment * _environment, int _dx, int _dy ) {
+
+    deploy( gtiavars, src_hw_gtia_vars_asm);
+    deploy_deferred( gtiavarsGraphic, src_hw_gtia_vars_graphics_asm );
+    deploy( scroll, src_hw_gtia_scroll_asm);
+    deploy( textHScroll, src_hw_gtia_hscroll_text_asm );
+    deploy( vScrollText, src_hw_gtia_vscroll_text_asm );
+    deploy( playfield, src_hw_gtia_playfield_asm);
+
+    outline1("LDA #$%2.2x", (unsigned char)(_dx&0xff) );
+    outline0("STA XSCROLL" );
+    outline1("LDA #$%2.2x", (unsigned char)(_dy&0xff) );
+    outline0("STA YSCROLL" );
+    outline0("JSR PLAYFIELDSTEP");
+
+}
+
 void gtia_scroll_text( Environment * _environment, int _direction ) {
 
+    if ( _environment->playfieldWidth ) {
+        gtia_playfield_step( _environment, 0, _direction > 0 ? 1 : -1 );
+        return;
+    }
+
     deploy( vScrollText, src_hw_gtia_vscroll_text_asm );
 
     outline1("LDA #$%2.2x", ( _direction & 0xff ) );
@@ -2035,6 +2160,11 @@ void gtia_hscroll_line( Environment * _environment, int _direction ) {
 
 void gtia_hscroll_screen( Environment * _environment, int _direction ) {
 
+    if ( _environment->playfieldWidth ) {
+        gtia_playfield_step( _environment, _direction > 0 ? 1 : -1, 0 );
+        return;
+    }
+
     deploy( textHScroll, src_hw_gtia_hscroll_text_asm );
 
     outline1("LDA #$%2.2x", ( _direction & 0xff ) );
@@ -2539,9 +2669,9 @@ static Variable * gtia_image_converter_bitmap_mode_standard( Environment * _envi
             if ( rgb.alpha < 255 ) {
                 colorIndex = 0;
             } else {
-                int minDistance = 9999;
+                int minDistance = 0x7fffffff;
                 for( int i=(_transparent_color); i<lastUsedSlotInCommonPalette; ++i ) {
-                    int distance = rgbi_distance(&commonPalette[i], &rgb );
+                    int distance = rgbi_distance_squared(&commonPalette[i], &rgb );
                     if ( distance < minDistance ) {
                         minDistance = distance;
                         colorIndex = i;
@@ -2719,9 +2849,9 @@ static Variable * gtia_image_converter_multicolor_mode_standard( Environment * _
             if ( rgb.alpha < 255 ) {
                 colorIndex = 0;
             } else {
-                int minDistance = 9999;
+                int minDistance = 0x7fffffff;
                 for( int i=(_transparent_color); i<lastUsedSlotInCommonPalette; ++i ) {
-                    int distance = rgbi_distance(&commonPalette[i], &rgb );
+                    int distance = rgbi_distance_squared(&commonPalette[i], &rgb );
                     if ( distance < minDistance ) {
                         minDistance = distance;
                         colorIndex = i;
@@ -3454,7 +3584,62 @@ void gtia_scroll( Environment * _environment, int _dx, int _dy ) {
     outline0("STA MATHPTR0" );
     outline1("LDA #$%2.2x", (unsigned char)(_dy&0xff) );
     outline0("STA MATHPTR1" );
-    outline0("JSR SCROLL");
+    if ( _environment->playfieldWidth ) {
+        deploy( playfield, src_hw_gtia_playfield_asm);
+        outline0("JSR SCROLLPF");
+    } else {
+        outline0("JSR SCROLL");
+    }
+
+}
+
+/**
+ * @brief Emit code for <b>SCREEN PLAYFIELD width, height</b>
+ * 
+ * The text modes are redefined so that every mode line has its own LMS,
+ * pointing to a row of a map of the given size (in bytes). The map is
+ * placed at the end of the memory, and it starts at TEXTADDRESS.
+ * 
+ * @param _environment Current calling environment
+ * @param _width Width of the playfield (64, 128 or 256)
+ * @param _height Height of the playfield
+ */
+void gtia_screen_playfield( Environment * _environment, int _width, int _height ) {
+
+    if ( _width != 64 && _width != 128 && _width != 256 ) {
+        CRITICAL_INVALID_PLAYFIELD_WIDTH( _width );
+    }
+
+    if ( _height <= 0 || _height > 255 || ( _width * _height ) > 16384 ) {
+        CRITICAL_INVALID_PLAYFIELD_HEIGHT( _height );
+    }
+
+    _environment->playfieldWidth = _width;
+    _environment->playfieldHeight = _height;
+
+    variable_import( _environment, "PLAYFIELDWIDTH", VT_WORD, 0 );
+    variable_global( _environment, "PLAYFIELDWIDTH" );
+    variable_import( _environment, "PLAYFIELDSHIFT", VT_BYTE, 0 );
+    variable_global( _environment, "PLAYFIELDSHIFT" );
+    variable_import( _environment, "PLAYFIELDLMS", VT_ADDRESS, 0 );
+    variable_global( _environment, "PLAYFIELDLMS" );
+    variable_import( _environment, "PLAYFIELDROWS", VT_BYTE, 0 );
+    variable_global( _environment, "PLAYFIELDROWS" );
+    variable_import( _environment, "PLAYFIELDXSTEP", VT_BYTE, 0 );
+    variable_global( _environment, "PLAYFIELDXSTEP" );
+    variable_import( _environment, "PLAYFIELDXMAX", VT_BYTE, 0 );
+    variable_global( _environment, "PLAYFIELDXMAX" );
+    variable_import( _environment, "PLAYFIELDYMAX", VT_BYTE, 0 );
+    variable_global( _environment, "PLAYFIELDYMAX" );
+    variable_import( _environment, "PLAYFIELDX", VT_BYTE, 0 );
+    variable_global( _environment, "PLAYFIELDX" );
+    variable_import( _environment, "PLAYFIELDY", VT_BYTE, 0 );
+    variable_global( _environment, "PLAYFIELDY" );
+
+    ScreenMode * mode = find_screen_mode_by_id( _environment, _environment->currentMode );
+    if ( mode && ! mode->bitmap ) {
+        gtia_screen_mode_enable( _environment, mode );
+    }
 
 }
 
@@ -308,6 +308,7 @@ void gtia_hscroll_screen( Environment * _environment, int _direction );
 void gtia_text( Environment * _environment, char * _text, char * _text_size );
 void gtia_cline( Environment * _environment, char * _characters );
 void gtia_scroll( Environment * _environment, int _dx, int _dy );
+void gtia_screen_playfield( Environment * _environment, int _width, int _height );
 
 int gtia_image_size( Environment * _environment, int _width, int _height, int _mode );
 Variable * gtia_image_converter( Environment * _environment, char * _data, int _width, int _height, int _depth, int _offset_x, int _offset_y, int _frame_width, int _frame_height, int _mode, int _transparent_color, int _flags );
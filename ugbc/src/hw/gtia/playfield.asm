@@ -0,0 +1,201 @@
+; /*****************************************************************************
+;  * ugBASIC - an isomorphic BASIC language compiler for retrocomputers        *
+;  *****************************************************************************
+;  * Copyright 2021-2024 Marco Spedaletti (asimov@mclink.it)
+;  *
+;  * Licensed under the Apache License, Version 2.0 (the "License");
+;  * you may not use this file except in compliance with the License.
+;  * You may obtain a copy of the License at
+;  *
+;  * http://www.apache.org/licenses/LICENSE-2.0
+;  *
+;  * Unless required by applicable law or agreed to in writing, software
+;  * distributed under the License is distributed on an "AS IS" BASIS,
+;  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+;  * See the License for the specific language governing permissions and
+;  * limitations under the License.
+;  *----------------------------------------------------------------------------
+;  * Concesso in licenza secondo i termini della Licenza Apache, versione 2.0
+;  * (la "Licenza"); è proibito usare questo file se non in conformità alla
+;  * Licenza. Una copia della Licenza è disponibile all'indirizzo:
+;  *
+;  * http://www.apache.org/licenses/LICENSE-2.0
+;  *
+;  * Se non richiesto dalla legislazione vigente o concordato per iscritto,
+;  * il software distribuito nei termini della Licenza è distribuito
+;  * "COSì COM'è", SENZA GARANZIE O CONDIZIONI DI ALCUN TIPO, esplicite o
+;  * implicite. Consultare la Licenza per il testo specifico che regola le
+;  * autorizzazioni e le limitazioni previste dalla medesima.
+;  ****************************************************************************/
+;* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+;*                                                                             *
+;*                        VIRTUAL PLAYFIELD ON ANTIC                           *
+;*                                                                             *
+;*                             by Marco Spedaletti                             *
+;*                                                                             *
+;* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+; With a virtual playfield every mode line of the display list has its own
+; LMS, pointing to a row of a map larger than the screen. The visible
+; window starts at (PLAYFIELDX, PLAYFIELDY): moving it by one character
+; in any direction only rewrites the LMS addresses, and nothing is copied.
+
+; PLAYFIELDUPDATE: rewrite the LMS addresses and the fine scroll registers
+; during the vertical blank.
+PLAYFIELDUPDATE:
+
+    ; MATHPTR2/3 = TEXTADDRESS + ( PLAYFIELDY << PLAYFIELDSHIFT ) + PLAYFIELDX
+    LDA PLAYFIELDY
+    STA MATHPTR2
+    LDA #0
+    STA MATHPTR3
+    LDX PLAYFIELDSHIFT
+PLAYFIELDUPDATES:
+    ASL MATHPTR2
+    ROL MATHPTR3
+    DEX
+    BNE PLAYFIELDUPDATES
+    CLC
+    LDA MATHPTR2
+    ADC PLAYFIELDX
+    STA MATHPTR2
+    LDA MATHPTR3
+    ADC #0
+    STA MATHPTR3
+    CLC
+    LDA MATHPTR2
+    ADC TEXTADDRESS
+    STA MATHPTR2
+    LDA MATHPTR3
+    ADC TEXTADDRESS+1
+    STA MATHPTR3
+
+    CLC
+    LDA #<DLI
+    ADC PLAYFIELDLMS
+    STA TMPPTR
+    LDA #>DLI
+    ADC PLAYFIELDLMS+1
+    STA TMPPTR+1
+
+    ; Wait for the vertical blank (VCOUNT is half the scanline).
+PLAYFIELDUPDATEW:
+    LDA $D40B
+    CMP #124
+    BCC PLAYFIELDUPDATEW
+
+    LDX PLAYFIELDROWS
+    LDY #0
+PLAYFIELDUPDATEL1:
+    LDA MATHPTR2
+    STA (TMPPTR),Y
+    INY
+    LDA MATHPTR3
+    STA (TMPPTR),Y
+    INY
+    INY
+    CLC
+    LDA MATHPTR2
+    ADC PLAYFIELDWIDTH
+    STA MATHPTR2
+    LDA MATHPTR3
+    ADC PLAYFIELDWIDTH+1
+    STA MATHPTR3
+    DEX
+    BNE PLAYFIELDUPDATEL1
+
+    JSR SCREENSCROLLEMBED
+
+    RTS
+
+; PLAYFIELDSTEP(XSCROLL,YSCROLL): move the window by one step (eight color
+; clocks, that are PLAYFIELDXSTEP columns, horizontally, and one row
+; vertically). On the border of the map the movement is refused, and the
+; fine scroll is kept on the last position.
+PLAYFIELDSTEP:
+    LDA XSCROLL
+    BEQ PLAYFIELDSTEPY
+    CMP #$80
+    BCS PLAYFIELDSTEPXLEFT
+PLAYFIELDSTEPXRIGHT:
+    LDA PLAYFIELDX
+    SEC
+    SBC PLAYFIELDXSTEP
+    BCC PLAYFIELDSTEPXRIGHT0
+    STA PLAYFIELDX
+    JMP PLAYFIELDSTEPY
+PLAYFIELDSTEPXRIGHT0:
+    LDA #7
+    STA XSCROLLPOS
+    LDA #0
+    STA XSCROLL
+    JMP PLAYFIELDSTEPY
+PLAYFIELDSTEPXLEFT:
+    LDA PLAYFIELDX
+    CLC
+    ADC PLAYFIELDXSTEP
+    CMP PLAYFIELDXMAX
+    BEQ PLAYFIELDSTEPXLEFT1
+    BCS PLAYFIELDSTEPXLEFT0
+PLAYFIELDSTEPXLEFT1:
+    STA PLAYFIELDX
+    JMP PLAYFIELDSTEPY
+PLAYFIELDSTEPXLEFT0:
+    LDA #0
+    STA XSCROLLPOS
+    STA XSCROLL
+
+PLAYFIELDSTEPY:
+    LDA YSCROLL
+    BEQ PLAYFIELDSTEPN
+    CMP #$80
+    BCS PLAYFIELDSTEPYUP
+PLAYFIELDSTEPYDOWN:
+    LDA PLAYFIELDY
+    BEQ PLAYFIELDSTEPYDOWN0
+    DEC PLAYFIELDY
+    JMP PLAYFIELDSTEPN
+PLAYFIELDSTEPYDOWN0:
+    LDA #7
+    STA YSCROLLPOS
+    LDA #0
+    STA YSCROLL
+    JMP PLAYFIELDSTEPN
+PLAYFIELDSTEPYUP:
+    LDA PLAYFIELDY
+    CMP PLAYFIELDYMAX
+    BCS PLAYFIELDSTEPYUP0
+    INC PLAYFIELDY
+    JMP PLAYFIELDSTEPN
+PLAYFIELDSTEPYUP0:
+    LDA #0
+    STA YSCROLLPOS
+    STA YSCROLL
+
+PLAYFIELDSTEPN:
+    JMP PLAYFIELDUPDATE
+
+; SCROLLPF(MATHPTR0,MATHPTR1)
+SCROLLPF:
+    JSR SCROLLCALC
+    JSR PLAYFIELDSTEP
+
+    LDA XSCROLL
+    BEQ SCROLLPF2
+    CMP #$80
+    BCS SCROLLPFLEFT
+    JSR ONSCROLLRIGHT
+    JMP SCROLLPF2
+SCROLLPFLEFT:
+    JSR ONSCROLLLEFT
+SCROLLPF2:
+    LDA YSCROLL
+    BEQ SCROLLPF3
+    CMP #$80
+    BCS SCROLLPFUP
+    JSR ONSCROLLDOWN
+    JMP SCROLLPF3
+SCROLLPFUP:
+    JSR ONSCROLLUP
+SCROLLPF3:
+    RTS
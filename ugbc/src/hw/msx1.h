@@ -172,6 +172,7 @@ void msx1_timer_set_counter( Environment * _environment, char * _timer, char * _
 void msx1_timer_set_init( Environment * _environment, char * _timer, char * _init );
 void msx1_timer_set_address( Environment * _environment, char * _timer, char * _address );
 void msx1_dload( Environment * _environment, char * _filename, char * _offset, char * _address, char * _size );
+void msx1_dstream( Environment * _environment, char * _filename, char * _address );
 void msx1_dsave( Environment * _environment, char * _filename, char * _offset, char * _address, char * _size );
 
 #endif
\ No newline at end of file
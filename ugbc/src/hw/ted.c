@@ -65,10 +65,10 @@ int lastUsedSlotInCommonPalette = 0;
 
 RGBi * ted_image_nearest_system_color( RGBi * _color ) {
 
-    int minDistance = 0xffff;
+    int minDistance = 0x7fffffff;
     int colorIndex = 0;
     for (int j = 0; j < COLOR_COUNT; ++j) {
-        int distance = rgbi_distance(&SYSTEM_PALETTE[j], _color);
+        int distance = rgbi_distance_squared(&SYSTEM_PALETTE[j], _color);
         if (distance < minDistance) {
             minDistance = distance;
             colorIndex = j;
@@ -718,7 +718,7 @@ static int rgbConverterFunction( int _red, int _green, int _blue ) {
     rgb.blue = _blue;
 
     for (j = 0; j < sizeof(SYSTEM_PALETTE)/sizeof(RGBi); ++j) {
-        int distance = rgbi_distance(&SYSTEM_PALETTE[j], &rgb);
+        int distance = rgbi_distance_squared(&SYSTEM_PALETTE[j], &rgb);
         if (distance < minDistance) {
             minDistance = distance;
             colorIndex = j;
@@ -1180,8 +1180,40 @@ void ted_cls( Environment * _environment ) {
 
 }
 
+/**
+ * @brief Move the text screen by one character, on the hidden buffer
+ * 
+ * With ''DEFINE SCROLL DOUBLE BUFFER'' the shifted screen is prepared on
+ * the matrix that is not visible, and then the two matrices (characters
+ * and attributes) are exchanged during the lower border.
+ * 
+ * @param _environment Current calling environment
+ * @param _dx Horizontal direction (-1, 0, 1)
+ * @param _dy Vertical direction (-1, 0, 1)
+ */
+static void ted_scroll_double_step( Environment * _environment, int _dx, int _dy ) {
+
+    deploy( tedvars, src_hw_ted_vars_asm);
+    deploy( scroll, src_hw_ted_scroll_asm);
+    deploy( textHScroll, src_hw_ted_hscroll_text_asm );
+    deploy( vScrollText, src_hw_ted_vscroll_text_asm );
+    deploy( scrollDouble, src_hw_ted_scroll_double_asm);
+
+    outline1("LDA #$%2.2x", (unsigned char)(_dx&0xff) );
+    outline0("STA XSCROLL" );
+    outline1("LDA #$%2.2x", (unsigned char)(_dy&0xff) );
+    outline0("STA YSCROLL" );
+    outline0("JSR DBSCROLLSTEP");
+
+}
+
 void ted_scroll_text( Environment * _environment, int _direction ) {
 
+    if ( _environment->scrollDoubleBuffer ) {
+        ted_scroll_double_step( _environment, 0, _direction > 0 ? 1 : -1 );
+        return;
+    }
+
     deploy( vScrollText, src_hw_ted_vscroll_text_asm );
 
     outline1("LDA #$%2.2x", ( _direction & 0xff ) );
@@ -1202,7 +1234,12 @@ void ted_scroll( Environment * _environment, int _dx, int _dy ) {
     outline0("STA MATHPTR0" );
     outline1("LDA #$%2.2x", (unsigned char)(_dy&0xff) );
     outline0("STA MATHPTR1" );
-    outline0("JSR SCROLL");
+    if ( _environment->scrollDoubleBuffer ) {
+        deploy( scrollDouble, src_hw_ted_scroll_double_asm);
+        outline0("JSR SCROLLDB");
+    } else {
+        outline0("JSR SCROLL");
+    }
 
 }
 
@@ -1331,6 +1368,11 @@ void ted_hscroll_line( Environment * _environment, int _direction ) {
 
 void ted_hscroll_screen( Environment * _environment, int _direction ) {
 
+    if ( _environment->scrollDoubleBuffer ) {
+        ted_scroll_double_step( _environment, _direction > 0 ? 1 : -1, 0 );
+        return;
+    }
+
     deploy( textHScroll, src_hw_ted_hscroll_text_asm );
 
     outline1("LDA #$%2.2x", ( _direction & 0xff ) );
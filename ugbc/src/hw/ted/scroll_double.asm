@@ -0,0 +1,335 @@
+; /*****************************************************************************
+;  * ugBASIC - an isomorphic BASIC language compiler for retrocomputers        *
+;  *****************************************************************************
+;  * Copyright 2021-2024 Marco Spedaletti (asimov@mclink.it)
+;  *
+;  * Licensed under the Apache License, Version 2.0 (the "License");
+;  * you may not use this file except in compliance with the License.
+;  * You may obtain a copy of the License at
+;  *
+;  * http://www.apache.org/licenses/LICENSE-2.0
+;  *
+;  * Unless required by applicable law or agreed to in writing, software
+;  * distributed under the License is distributed on an "AS IS" BASIS,
+;  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+;  * See the License for the specific language governing permissions and
+;  * limitations under the License.
+;  *----------------------------------------------------------------------------
+;  * Concesso in licenza secondo i termini della Licenza Apache, versione 2.0
+;  * (la "Licenza"); è proibito usare questo file se non in conformità alla
+;  * Licenza. Una copia della Licenza è disponibile all'indirizzo:
+;  *
+;  * http://www.apache.org/licenses/LICENSE-2.0
+;  *
+;  * Se non richiesto dalla legislazione vigente o concordato per iscritto,
+;  * il software distribuito nei termini della Licenza è distribuito
+;  * "COSì COM'è", SENZA GARANZIE O CONDIZIONI DI ALCUN TIPO, esplicite o
+;  * implicite. Consultare la Licenza per il testo specifico che regola le
+;  * autorizzazioni e le limitazioni previste dalla medesima.
+;  ****************************************************************************/
+;* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+;*                                                                             *
+;*                        DOUBLE BUFFERED SCROLL ON TED                        *
+;*                                                                             *
+;*                             by Marco Spedaletti                             *
+;*                                                                             *
+;* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+; The text screen is kept on two matrices ($E800 and $D800). While the
+; visible one is moved by the fine scroll registers, the hidden one is
+; filled with the content already shifted by one character, a few rows
+; for each fine step. When the fine scroll wraps, the remaining rows are
+; prepared and the matrices are exchanged during the lower border. On
+; TED the attributes are part of the matrix, so they are exchanged
+; together with the characters.
+
+DBSCROLLROWLO:
+    .byte <0, <40, <80, <120, <160, <200, <240, <280, <320, <360
+    .byte <400, <440, <480, <520, <560, <600, <640, <680, <720, <760
+    .byte <800, <840, <880, <920, <960
+DBSCROLLROWHI:
+    .byte >0, >40, >80, >120, >160, >200, >240, >280, >320, >360
+    .byte >400, >440, >480, >520, >560, >600, >640, >680, >720, >760
+    .byte >800, >840, >880, >920, >960
+
+DBSCROLLDX:     .byte 0
+DBSCROLLDY:     .byte 0
+DBSCROLLROW:    .byte 0
+DBSCROLLLIMIT:  .byte 0
+DBSCROLLFIRST:  .byte 0
+DBSCROLLLAST:   .byte 0
+
+; SCROLLDB(MATHPTR0,MATHPTR1)
+SCROLLDB:
+    JSR SCROLLCALC
+
+    ; The direction of the next coarse step is the one requested:
+    ; if it changes, the rows prepared so far are useless.
+    LDX #0
+    LDA MATHPTR0
+    BEQ SCROLLDBDX
+    LDX #1
+    CMP #$80
+    BCC SCROLLDBDX
+    LDX #$FF
+SCROLLDBDX:
+    LDY #0
+    LDA MATHPTR1
+    BEQ SCROLLDBDY
+    LDY #1
+    CMP #$80
+    BCC SCROLLDBDY
+    LDY #$FF
+SCROLLDBDY:
+    LDA XSCROLL
+    ORA YSCROLL
+    BNE SCROLLDBCOARSE
+
+    JSR DBSCROLLDIRECTION
+    JSR SCREENSCROLLEMBED
+    LDA #13
+    JSR DBSCROLLPREPARE
+    RTS
+
+SCROLLDBCOARSE:
+    JSR DBSCROLLSTEP
+
+    LDA XSCROLL
+    BEQ SCROLLDBCOARSE2
+    CMP #$80
+    BCS SCROLLDBCOARSELEFT
+    JSR ONSCROLLRIGHT
+    JMP SCROLLDBCOARSE2
+SCROLLDBCOARSELEFT:
+    JSR ONSCROLLLEFT
+SCROLLDBCOARSE2:
+    LDA YSCROLL
+    BEQ SCROLLDBCOARSE3
+    CMP #$80
+    BCS SCROLLDBCOARSEUP
+    JSR ONSCROLLDOWN
+    JMP SCROLLDBCOARSE3
+SCROLLDBCOARSEUP:
+    JSR ONSCROLLUP
+SCROLLDBCOARSE3:
+    RTS
+
+; DBSCROLLSTEP(XSCROLL,YSCROLL): move the screen by one character,
+; completing the hidden matrix and exchanging it with the visible one.
+DBSCROLLSTEP:
+    LDX XSCROLL
+    LDY YSCROLL
+    JSR DBSCROLLDIRECTION
+    LDA #25
+    JSR DBSCROLLPREPARE
+    JSR DBSCROLLSWAP
+    LDA #0
+    STA DBSCROLLROW
+    RTS
+
+; DBSCROLLDIRECTION(X=dx,Y=dy)
+DBSCROLLDIRECTION:
+    CPX DBSCROLLDX
+    BNE DBSCROLLDIRECTIONC
+    CPY DBSCROLLDY
+    BNE DBSCROLLDIRECTIONC
+    RTS
+DBSCROLLDIRECTIONC:
+    STX DBSCROLLDX
+    STY DBSCROLLDY
+    LDA #0
+    STA DBSCROLLROW
+    RTS
+
+; DBSCROLLPREPARE(A=rows): prepare up to A rows of the hidden matrix.
+DBSCROLLPREPARE:
+    STA DBSCROLLLIMIT
+DBSCROLLPREPAREL1:
+    LDA DBSCROLLROW
+    CMP #25
+    BEQ DBSCROLLPREPARED
+    LDA DBSCROLLLIMIT
+    BEQ DBSCROLLPREPARED
+    DEC DBSCROLLLIMIT
+    JSR DBSCROLLPREPAREROW
+    INC DBSCROLLROW
+    JMP DBSCROLLPREPAREL1
+DBSCROLLPREPARED:
+    RTS
+
+; DBSCROLLPREPAREROW(DBSCROLLROW)
+DBSCROLLPREPAREROW:
+
+    ; Destination: the same row, on the hidden matrix (characters
+    ; and attributes).
+    LDX DBSCROLLROW
+    LDA TEXTADDRESS
+    CLC
+    ADC DBSCROLLROWLO, X
+    STA COPYOFTEXTADDRESS2
+    LDA TEXTADDRESS+1
+    EOR #$30
+    ADC DBSCROLLROWHI, X
+    STA COPYOFTEXTADDRESS2+1
+    LDA TEXTADDRESS
+    CLC
+    ADC DBSCROLLROWLO, X
+    STA COPYOFCOLORMAPADDRESS2
+    LDA TEXTADDRESS+1
+    EOR #$30
+    AND #$F8
+    ADC DBSCROLLROWHI, X
+    STA COPYOFCOLORMAPADDRESS2+1
+
+    ; Source: the row that will fall on this one. If it is outside
+    ; the screen, the row is exposed: it will be emptied, keeping the
+    ; colors already there.
+    LDA DBSCROLLROW
+    SEC
+    SBC DBSCROLLDY
+    CMP #25
+    BCC DBSCROLLPREPAREROWS
+    JMP DBSCROLLPREPAREROWE
+
+DBSCROLLPREPAREROWS:
+    TAX
+    LDA TEXTADDRESS
+    CLC
+    ADC DBSCROLLROWLO, X
+    STA COPYOFTEXTADDRESS
+    LDA TEXTADDRESS+1
+    ADC DBSCROLLROWHI, X
+    STA COPYOFTEXTADDRESS+1
+    LDA TEXTADDRESS
+    CLC
+    ADC DBSCROLLROWLO, X
+    STA COPYOFCOLORMAPADDRESS
+    LDA TEXTADDRESS+1
+    AND #$F8
+    ADC DBSCROLLROWHI, X
+    STA COPYOFCOLORMAPADDRESS+1
+
+    ; The horizontal movement is obtained by moving back (right) or
+    ; forth (left) the source by one position, so that the same index
+    ; can be used for both. The column left behind is exposed.
+    LDA #0
+    STA DBSCROLLFIRST
+    LDA #39
+    STA DBSCROLLLAST
+    LDA DBSCROLLDX
+    BEQ DBSCROLLPREPAREROWC
+    CMP #$80
+    BCS DBSCROLLPREPAREROWL
+
+    INC DBSCROLLFIRST
+    SEC
+    LDA COPYOFTEXTADDRESS
+    SBC #1
+    STA COPYOFTEXTADDRESS
+    LDA COPYOFTEXTADDRESS+1
+    SBC #0
+    STA COPYOFTEXTADDRESS+1
+    SEC
+    LDA COPYOFCOLORMAPADDRESS
+    SBC #1
+    STA COPYOFCOLORMAPADDRESS
+    LDA COPYOFCOLORMAPADDRESS+1
+    SBC #0
+    STA COPYOFCOLORMAPADDRESS+1
+    JMP DBSCROLLPREPAREROWC
+
+DBSCROLLPREPAREROWL:
+    DEC DBSCROLLLAST
+    CLC
+    LDA COPYOFTEXTADDRESS
+    ADC #1
+    STA COPYOFTEXTADDRESS
+    LDA COPYOFTEXTADDRESS+1
+    ADC #0
+    STA COPYOFTEXTADDRESS+1
+    CLC
+    LDA COPYOFCOLORMAPADDRESS
+    ADC #1
+    STA COPYOFCOLORMAPADDRESS
+    LDA COPYOFCOLORMAPADDRESS+1
+    ADC #0
+    STA COPYOFCOLORMAPADDRESS+1
+
+DBSCROLLPREPAREROWC:
+    LDY DBSCROLLLAST
+DBSCROLLPREPAREROWCL1:
+    LDA (COPYOFTEXTADDRESS), Y
+    STA (COPYOFTEXTADDRESS2), Y
+    LDA (COPYOFCOLORMAPADDRESS), Y
+    STA (COPYOFCOLORMAPADDRESS2), Y
+    CPY DBSCROLLFIRST
+    BEQ DBSCROLLPREPAREROWCX
+    DEY
+    JMP DBSCROLLPREPAREROWCL1
+
+    ; The exposed column is emptied, and it takes the color
+    ; of its neighbour.
+DBSCROLLPREPAREROWCX:
+    LDA DBSCROLLDX
+    BEQ DBSCROLLPREPAREROWCD
+    CMP #$80
+    BCS DBSCROLLPREPAREROWCXL
+    LDY #1
+    LDA (COPYOFCOLORMAPADDRESS2), Y
+    DEY
+    JMP DBSCROLLPREPAREROWCX2
+DBSCROLLPREPAREROWCXL:
+    LDY #38
+    LDA (COPYOFCOLORMAPADDRESS2), Y
+    INY
+DBSCROLLPREPAREROWCX2:
+    STA (COPYOFCOLORMAPADDRESS2), Y
+    LDA EMPTYTILE
+    STA (COPYOFTEXTADDRESS2), Y
+DBSCROLLPREPAREROWCD:
+    RTS
+
+DBSCROLLPREPAREROWE:
+    LDX DBSCROLLROW
+    LDA TEXTADDRESS
+    CLC
+    ADC DBSCROLLROWLO, X
+    STA COPYOFCOLORMAPADDRESS
+    LDA TEXTADDRESS+1
+    AND #$F8
+    ADC DBSCROLLROWHI, X
+    STA COPYOFCOLORMAPADDRESS+1
+    LDY #39
+DBSCROLLPREPAREROWEL1:
+    LDA EMPTYTILE
+    STA (COPYOFTEXTADDRESS2), Y
+    LDA (COPYOFCOLORMAPADDRESS), Y
+    STA (COPYOFCOLORMAPADDRESS2), Y
+    DEY
+    BPL DBSCROLLPREPAREROWEL1
+    RTS
+
+; DBSCROLLSWAP: exchange the matrices.
+DBSCROLLSWAP:
+
+    ; Wait for the lower border, so that the new matrix and the new
+    ; fine scroll will be used together, from the next frame.
+DBSCROLLSWAPW:
+    LDA $FF1D
+    CMP #$CC
+    BNE DBSCROLLSWAPW
+
+    LDA TEXTADDRESS+1
+    EOR #$30
+    STA TEXTADDRESS+1
+    AND #$F8
+    STA COLORMAPADDRESS+1
+    STA MATHPTR2
+    LDA $FF14
+    AND #$07
+    ORA MATHPTR2
+    STA $FF14
+
+    JSR SCREENSCROLLEMBED
+
+    RTS
@@ -65,10 +65,10 @@ int lastUsedSlotInCommonPalette = 0;
 
 RGBi * tms9918_image_nearest_system_color( RGBi * _color ) {
 
-    unsigned int minDistance = 0xffff;
+    unsigned int minDistance = 0xffffffff;
     int colorIndex = 0;
     for (int j = 0; j < COLOR_COUNT; ++j) {
-        int distance = rgbi_distance(&SYSTEM_PALETTE[j], _color);
+        int distance = rgbi_distance_squared(&SYSTEM_PALETTE[j], _color);
         if ( _color->alpha < 255 ) {
             if ( rgbi_equals_rgb( &SYSTEM_PALETTE[j], _color ) ) {
                 minDistance = 0;
@@ -284,6 +284,35 @@ static void tms9918_image_converter_tiles( Environment * _environment, char * _s
 
 }
 
+/**
+ * @brief <i>TMS9918</i>: deploy sprite routines
+ * 
+ * Sprite routines are served by the multiplexer (<i>hw/tms9918/multiplexer.asm</i>)
+ * if it has been requested by <b>DEFINE SPRITE MULTIPLEX</b>. Both modules
+ * share the same entry points and calling conventions.
+ * 
+ * @param _environment Current calling environment
+ */
+static void tms9918_sprite_deploy( Environment * _environment ) {
+
+    if ( _environment->spriteConfig.multiplex ) {
+        if ( ! _environment->deployed.spriteMultiplexer ) {
+            variable_import( _environment, "MPXSAT", VT_BUFFER, 128 );
+            variable_global( _environment, "MPXSAT" );
+            variable_import( _environment, "MPXCOUNT", VT_BYTE, _environment->spriteConfig.count );
+            variable_global( _environment, "MPXCOUNT" );
+            variable_import( _environment, "MPXROTATION", VT_BYTE, 0 );
+            variable_global( _environment, "MPXROTATION" );
+            variable_import( _environment, "MPXREADY", VT_BYTE, 0 );
+            variable_global( _environment, "MPXREADY" );
+        }
+        deploy( spriteMultiplexer, src_hw_tms9918_multiplexer_asm );
+    } else {
+        deploy( sprite, src_hw_tms9918_sprites_asm );
+    }
+
+}
+
 /**
  * @brief <i>TMS9918</i>: emit code to check for collision
  * 
@@ -300,7 +329,7 @@ Variable * tms9918_collision( Environment * _environment, char * _sprite ) {
     Variable * sprite = variable_retrieve_or_define( _environment, _sprite, VT_BYTE, 0 );
     Variable * result = variable_temporary( _environment, VT_SBYTE, "(collision)" );
 
-    deploy( sprite, src_hw_tms9918_sprites_asm );
+    tms9918_sprite_deploy( _environment );
     
     if ( ! _environment->hasGameLoop ) {
         outline0("CALL SPRITECOL");
@@ -618,7 +647,7 @@ static int rgbConverterFunction( int _red, int _green, int _blue ) {
     rgb.blue = _blue;
 
     for (j = 0; j < sizeof(SYSTEM_PALETTE)/sizeof(RGBi); ++j) {
-        int distance = rgbi_distance(&SYSTEM_PALETTE[j], &rgb);
+        int distance = rgbi_distance_squared(&SYSTEM_PALETTE[j], &rgb);
         if (distance < minDistance) {
             minDistance = distance;
             colorIndex = j;
@@ -1101,7 +1130,7 @@ void tms9918_sprite_data_from( Environment * _environment, char * _sprite, char
     Variable * sprite = variable_retrieve_or_define( _environment, _sprite, VT_BYTE, 0 );
     Variable * image = variable_retrieve_or_define( _environment, _image, VT_IMAGE, 0 );
 
-    deploy( sprite, src_hw_tms9918_sprites_asm );
+    tms9918_sprite_deploy( _environment );
     
     outline1("LD A, (%s)", sprite->realName );
     outline0("LD B, A");
@@ -1118,7 +1147,7 @@ void tms9918_sprite_enable( Environment * _environment, char * _sprite ) {
 
     Variable * sprite = variable_retrieve_or_define( _environment, _sprite, VT_BYTE, 0 );
 
-    deploy( sprite, src_hw_tms9918_sprites_asm );
+    tms9918_sprite_deploy( _environment );
     
     outline1("LD A, (%s)", sprite->realName );
     outline0("LD B, A");
@@ -1134,7 +1163,7 @@ void tms9918_sprite_disable( Environment * _environment, char * _sprite ) {
 
     Variable * sprite = variable_retrieve_or_define( _environment, _sprite, VT_BYTE, 0 );
 
-    deploy( sprite, src_hw_tms9918_sprites_asm );
+    tms9918_sprite_deploy( _environment );
     
     outline1("LD A, (%s)", sprite->realName );
     outline0("LD B, A");
@@ -1152,7 +1181,7 @@ void tms9918_sprite_at( Environment * _environment, char * _sprite, char * _x, c
     Variable * x = variable_retrieve_or_define( _environment, _x, VT_POSITION, 0 );
     Variable * y = variable_retrieve_or_define( _environment, _y, VT_POSITION, 0 );
 
-    deploy( sprite, src_hw_tms9918_sprites_asm );
+    tms9918_sprite_deploy( _environment );
     
     outline1("LD A, (%s)", sprite->realName );
     outline0("LD B, A");
@@ -1172,7 +1201,7 @@ void tms9918_sprite_expand_vertical( Environment * _environment, char * _sprite
 
     _sprite = NULL;
 
-    deploy( sprite, src_hw_tms9918_sprites_asm );
+    tms9918_sprite_deploy( _environment );
     
     if ( ! _environment->hasGameLoop ) {
         outline0("CALL SPRITEEXPAND");
@@ -1186,7 +1215,7 @@ void tms9918_sprite_expand_horizontal( Environment * _environment, char * _sprit
 
     _sprite = NULL;
 
-    deploy( sprite, src_hw_tms9918_sprites_asm );
+    tms9918_sprite_deploy( _environment );
     
     if ( ! _environment->hasGameLoop ) {
         outline0("CALL SPRITEEXPAND");
@@ -1200,7 +1229,7 @@ void tms9918_sprite_compress_vertical( Environment * _environment, char * _sprit
 
     _sprite = NULL;
 
-    deploy( sprite, src_hw_tms9918_sprites_asm );
+    tms9918_sprite_deploy( _environment );
     
     if ( ! _environment->hasGameLoop ) {
         outline0("CALL SPRITECOMPRESS");
@@ -1214,7 +1243,7 @@ void tms9918_sprite_compress_horizontal( Environment * _environment, char * _spr
 
     _sprite = NULL;
 
-    deploy( sprite, src_hw_tms9918_sprites_asm );
+    tms9918_sprite_deploy( _environment );
     
     if ( ! _environment->hasGameLoop ) {
         outline0("CALL SPRITECOMPRESS");
@@ -1237,7 +1266,7 @@ void tms9918_sprite_color( Environment * _environment, char * _sprite, char * _c
     Variable * sprite = variable_retrieve_or_define( _environment, _sprite, VT_BYTE, 0 );
     Variable * color = variable_retrieve_or_define( _environment, _color, VT_COLOR, COLOR_WHITE );
 
-    deploy( sprite, src_hw_tms9918_sprites_asm );
+    tms9918_sprite_deploy( _environment );
     
     outline1("LD A, (%s)", sprite->realName );
     outline0("LD B, A");
@@ -1561,6 +1590,8 @@ void tms9918_initialization( Environment * _environment ) {
     variable_global( _environment, "VBLFLAG" ); 
     variable_import( _environment, "VDPINUSE", VT_BYTE, 0 );
     variable_global( _environment, "VDPINUSE" );
+    variable_import( _environment, "VDPBURSTBUFFER", VT_BUFFER, 40 );
+    variable_global( _environment, "VDPBURSTBUFFER" );
 
     variable_import( _environment, "SLICEX", VT_POSITION, 0 );
     variable_global( _environment, "SLICEX" );
@@ -1580,6 +1611,14 @@ void tms9918_initialization( Environment * _environment ) {
 
 void tms9918_finalization( Environment * _environment ) {
 
+    // Called by WAITVBL at the end of each frame.
+    outhead0("TMS9918FRAMEHOOK:");
+    if ( _environment->deployed.spriteMultiplexer ) {
+        outline0("JP MPXUPDATE");
+    } else {
+        outline0("RET");
+    }
+
 }
 
 void tms9918_hscroll_line( Environment * _environment, int _direction ) {
@@ -1806,10 +1845,10 @@ Variable * tms9918_sprite_converter( Environment * _environment, char * _source,
     // int i, j, k;
 
     // for( i=0; i<colorUsed; ++i ) {
-    //     int minDistance = 0xffff;
+    //     int minDistance = 0x7fffffff;
     //     int colorIndex = 0;
     //     for (j = 0; j < sizeof(SYSTEM_PALETTE)/sizeof(RGBi); ++j) {
-    //         int distance = rgbi_distance(&SYSTEM_PALETTE[j], &palette[i]);
+    //         int distance = rgbi_distance_squared(&SYSTEM_PALETTE[j], &palette[i]);
     //         if (distance < minDistance) {
     //             for( k=0; k<i; ++k ) {
     //                 if ( palette[k].index == SYSTEM_PALETTE[j].index ) {
@@ -1881,11 +1920,11 @@ Variable * tms9918_sprite_converter( Environment * _environment, char * _source,
             } else {
 
                 if ( ! _color ) {
-                    int minDistance = 0xffff;
+                    int minDistance = 0x7fffffff;
                     RGBi * color = NULL;
                     int i = 0;
                     for( int k=0; k<colorUsed; ++k ) {
-                        int distance = rgbi_distance( &palette[k], &rgb );
+                        int distance = rgbi_distance_squared( &palette[k], &rgb );
                         if ( distance < minDistance ) {
                             minDistance = distance;
                             color = &palette[k];
@@ -1899,11 +1938,11 @@ Variable * tms9918_sprite_converter( Environment * _environment, char * _source,
                     //     }
                     // }
                 } else {
-                    int minDistance = 0xffff;
+                    int minDistance = 0x7fffffff;
                     RGBi * color = NULL;
                     for( int k=0; k<colorUsed; ++k ) {
                         if ( palette[k].alpha < 255 ) continue;
-                        int distance = rgbi_distance( &palette[k], &rgb );
+                        int distance = rgbi_distance_squared( &palette[k], &rgb );
                         if ( distance < minDistance ) {
                             minDistance = distance;
                             color = &palette[k];
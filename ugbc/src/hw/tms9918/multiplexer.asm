@@ -0,0 +1,262 @@
+; /*****************************************************************************
+;  * ugBASIC - an isomorphic BASIC language compiler for retrocomputers        *
+;  *****************************************************************************
+;  * Copyright 2021-2024 Marco Spedaletti (asimov@mclink.it)
+;  *
+;  * Licensed under the Apache License, Version 2.0 (the "License");
+;  * you may not use this file except in compliance with the License.
+;  * You may obtain a copy of the License at
+;  *
+;  * http://www.apache.org/licenses/LICENSE-2.0
+;  *
+;  * Unless required by applicable law or agreed to in writing, software
+;  * distributed under the License is distributed on an "AS IS" BASIS,
+;  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+;  * See the License for the specific language governing permissions and
+;  * limitations under the License.
+;  *----------------------------------------------------------------------------
+;  * Concesso in licenza secondo i termini della Licenza Apache, versione 2.0
+;  * (la "Licenza"); è proibito usare questo file se non in conformità alla
+;  * Licenza. Una copia della Licenza è disponibile all'indirizzo:
+;  *
+;  * http://www.apache.org/licenses/LICENSE-2.0
+;  *
+;  * Se non richiesto dalla legislazione vigente o concordato per iscritto,
+;  * il software distribuito nei termini della Licenza è distribuito
+;  * "COSì COM'è", SENZA GARANZIE O CONDIZIONI DI ALCUN TIPO, esplicite o
+;  * implicite. Consultare la Licenza per il testo specifico che regola le
+;  * autorizzazioni e le limitazioni previste dalla medesima.
+;  ****************************************************************************/
+;* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+;*                                                                             *
+;*                     SPRITE MULTIPLEXER ROUTINE FOR TMS9918                  *
+;*                                                                             *
+;*                             by Marco Spedaletti                             *
+;*                                                                             *
+;* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+; The multiplexer keeps a copy of the sprite attribute table in RAM 
+; (MPXSAT), and the entry points (with the same names and calling 
+; conventions of the ones in sprites.asm) update this copy. The copy is 
+; sent to VRAM starting from a different sprite at each frame 
+; (MPXROTATION), so that the 4-sprites-per-line limit hides a different 
+; sprite each time: sprites flicker instead of disappearing. 
+; The *NMI2 entry points (used inside a game loop) only update the copy, 
+; since it will be sent at the end of the frame by MPXUPDATE.
+
+; Compute HL = address of the entry in MPXSAT for sprite B
+MPXENTRY:
+    LD A, (MPXREADY)
+    CP 0
+    CALL Z, MPXINIT
+    LD HL, MPXSAT
+    LD D, 0
+    LD E, B
+    SLA E
+    SLA E
+    ADD HL, DE
+    RET
+
+; Unused sprites are placed under the last visible line, so that
+; they never reach the limit of sprites per line.
+MPXINIT:
+    PUSH BC
+    LD HL, MPXSAT
+    LD B, 32
+MPXINITL1:
+    LD (HL), $C0
+    INC HL
+    LD (HL), 0
+    INC HL
+    LD (HL), 0
+    INC HL
+    LD (HL), 0
+    INC HL
+    DJNZ MPXINITL1
+    LD A, 0
+    LD (MPXROTATION), A
+    LD A, 1
+    LD (MPXREADY), A
+    POP BC
+    RET
+
+; SET SPRITE DATA(B,HL)
+SPRITEDATAFROM:
+    CALL SPRITEDATAFROMNMI2
+    JP MPXFLUSH
+
+SPRITEDATAFROMNMI2:
+    PUSH HL
+    CALL MPXENTRY
+    INC HL
+    INC HL
+    LD A, B
+    SLA A
+    SLA A
+    LD (HL), A
+
+    LD H, 0
+    LD L, B
+    ADD HL, HL
+    ADD HL, HL
+    ADD HL, HL
+    ADD HL, HL
+    ADD HL, HL
+    LD DE, (SPRITEADDRESS)
+    ADD HL, DE
+    EX DE, HL
+    POP HL
+
+    PUSH BC
+    LD BC, 32
+    CALL VDPWRITE
+    POP BC
+
+    LD A, (HL)
+    AND $0F
+    LD C, A
+    JP SPRITECOLORNMI2
+
+; SET SPRITE DISABLE(B)
+SPRITEDISABLE:
+    LD HL, $FFFF
+    JP SPRITEAT
+
+SPRITEDISABLENMI2:
+    LD HL, $FFFF
+    JP SPRITEATNMI2
+
+; SET SPRITE ENABLE(B)
+SPRITEENABLE:
+SPRITEENABLENMI2:
+    RET
+
+; SPRITE AT(B,H,L)
+SPRITEAT:
+    CALL SPRITEATNMI2
+    JP MPXFLUSH
+
+SPRITEATNMI2:
+    PUSH HL
+    CALL MPXENTRY
+    POP DE
+    LD (HL), E
+    INC HL
+    LD (HL), D
+    RET
+
+; SPRITE EXPAND()
+SPRITEEXPAND:
+SPRITEEXPANDNMI2:
+    RET
+
+; SPRITE COMPRESS()
+SPRITECOMPRESS:
+SPRITECOMPRESSNMI2:
+    RET
+
+; SPRITE COLOR(B,C)
+SPRITECOLOR:
+    CALL SPRITECOLORNMI2
+    JP MPXFLUSH
+
+SPRITECOLORNMI2:
+    CALL MPXENTRY
+    INC HL
+    INC HL
+    INC HL
+    LD A, C
+    AND $0F
+    LD (HL), A
+    RET
+
+SPRITECOL:
+SPRITECOLNMI2:
+    CALL VDPREGIN
+    AND $20
+    CP 0
+    JR NZ, SPRITECOLNMI2YES
+    RET
+
+SPRITECOLNMI2YES:
+    LD A, $FF
+    RET
+
+; Move to the next sprite priority, and send the table to VRAM.
+MPXUPDATE:
+    LD A, (MPXREADY)
+    CP 0
+    RET Z
+    LD A, (MPXCOUNT)
+    LD B, A
+    LD A, (MPXROTATION)
+    INC A
+    CP B
+    JR C, MPXUPDATE1
+    LD A, 0
+MPXUPDATE1:
+    LD (MPXROTATION), A
+
+; Send the table to VRAM: entries from MPXROTATION to MPXCOUNT-1 
+; first, then entries from 0 to MPXROTATION-1.
+MPXFLUSH:
+    LD A, (MPXREADY)
+    CP 0
+    RET Z
+    PUSH BC
+
+    LD A, (MPXROTATION)
+    LD L, A
+    LD H, 0
+    ADD HL, HL
+    ADD HL, HL
+    LD DE, MPXSAT
+    ADD HL, DE
+    LD A, (MPXROTATION)
+    LD B, A
+    LD A, (MPXCOUNT)
+    SUB B
+    LD C, A
+    LD B, 0
+    SLA C
+    RL B
+    SLA C
+    RL B
+    LD DE, (SPRITEAADDRESS)
+    PUSH BC
+    CALL VDPWRITE
+    POP BC
+
+    LD HL, (SPRITEAADDRESS)
+    ADD HL, BC
+    EX DE, HL
+
+    LD A, (MPXROTATION)
+    CP 0
+    JR Z, MPXFLUSH2
+    LD C, A
+    LD B, 0
+    SLA C
+    RL B
+    SLA C
+    RL B
+    LD HL, MPXSAT
+    PUSH DE
+    PUSH BC
+    CALL VDPWRITE
+    POP BC
+    POP DE
+    EX DE, HL
+    ADD HL, BC
+    EX DE, HL
+
+MPXFLUSH2:
+    LD A, (MPXCOUNT)
+    CP 32
+    JR NC, MPXFLUSHDONE
+    LD A, $D0
+    CALL VDPOUTCHAR
+
+MPXFLUSHDONE:
+    POP BC
+    RET
@@ -147,9 +147,12 @@ PUTIMAGE0CP:
     PUSH BC
     LD B, 0
     SLA C
+    RL B
     SLA C
+    RL B
     SLA C
-    CALL VDPWRITEOPT
+    RL B
+    CALL VDPBURSTWRITE
     POP BC
     ; LD A, (HL)
     ; CALL VDPOUTCHAR
@@ -259,66 +262,20 @@ PUTIMAGE0CPAAX:
 PUTIMAGE0CPCA:
     PUSH BC
 PUTIMAGE0CPC:
-    LD A, (HL)
-    CALL VDPOUTCHAR
-    INC DE
-    INC HL
-    LD A, (HL)
-    CALL VDPOUTCHAR
-    INC DE
-    INC HL
-    LD A, (HL)
-    CALL VDPOUTCHAR
-    INC DE
-    INC HL
-    LD A, (HL)
-    CALL VDPOUTCHAR
-    INC DE
-    INC HL
-    LD A, (HL)
-    CALL VDPOUTCHAR
-    INC DE
-    INC HL
-    LD A, (HL)
-    CALL VDPOUTCHAR
-    INC DE
-    INC HL
-    LD A, (HL)
-    CALL VDPOUTCHAR
-    INC DE
-    INC HL
-    LD A, (HL)
-    CALL VDPOUTCHAR
-    INC DE
-    INC HL
-    DEC C
-    JR NZ, PUTIMAGE0CPC
+    LD B, 0
+    SLA C
+    RL B
+    SLA C
+    RL B
+    SLA C
+    RL B
+    CALL VDPBURSTWRITE
     POP BC
     PUSH HL
-    PUSH BC
-    LD HL, DE 
-    LD D, 0
-    LD A, (CURRENTTILESWIDTH)
-    LD E, A
-    ADD HL, DE
-    ADD HL, DE
-    ADD HL, DE
-    ADD HL, DE
-    ADD HL, DE
-    ADD HL, DE
-    ADD HL, DE
+    LD HL, DE
+    LD DE, (CURRENTTILESWIDTHX8)
     ADD HL, DE
-    LD B, 0
-    SBC HL, BC
-    SBC HL, BC
-    SBC HL, BC
-    SBC HL, BC
-    SBC HL, BC
-    SBC HL, BC
-    SBC HL, BC
-    SBC HL, BC
     LD DE, HL
-    POP BC
     POP HL
 PUTIMAGE0CP2C:
     DEC B
@@ -394,19 +394,308 @@ VDPREAD:
         CALL VDPUNLOCK
         RET
 
+; Fill VRAM with a value (it keeps the DJNZ convention of the original 
+; loop: C bytes, then B-1 pages of 256 bytes; C = 0 means 256).
+;   - A : value
+;   - DE : VRAM address
+;   - BC : count
 VDPFILL:
         CALL VDPLOCK
         PUSH    AF
         CALL    VDPWRITEADDR
         POP     AF
-VDPFILLLOOP:
-        CALL    VDPRAMOUT
+        PUSH    BC
+        PUSH    DE
+        PUSH    HL
+        LD      H, B
+        LD      L, C
+        INC     C
         DEC     C
-        JP      NZ, VDPFILLLOOP
-        DJNZ    VDPFILLLOOP
+        JR      Z, VDPFILLLOOP
+        DEC     H
+VDPFILLLOOP:
+        CALL    VDPBURSTFILLI
+        POP     HL
+        POP     DE
+        POP     BC
         CALL VDPUNLOCK
         RET
 
+; Burst transfers to and from VRAM. Bytes are moved 8 at a time by unrolled
+; OUTI / INI / OUT (C) sequences, without any call or address setup between
+; them. Each access is followed by enough NOPs to keep at least 29 T-states
+; between two accesses, that is the slowest rate the TMS9918 can sustain 
+; during the active display.
+
+; Write a block to VRAM
+;   - HL : source (it is advanced by the count)
+;   - DE : VRAM address
+;   - BC : count
+VDPBURSTWRITE:
+        CALL VDPLOCK
+        CALL    VDPWRITEADDR
+        PUSH    BC
+        PUSH    DE
+        LD      D, B
+        LD      E, C
+        LD      BC, (VDPDATAPORTWRITE)
+VDPBURSTWRITEL8:
+        LD      A, D
+        OR      A
+        JR      NZ, VDPBURSTWRITE8
+        LD      A, E
+        CP      8
+        JR      C, VDPBURSTWRITETAIL
+VDPBURSTWRITE8:
+        OUTI
+        NOP
+        NOP
+        NOP
+        NOP
+        OUTI
+        NOP
+        NOP
+        NOP
+        NOP
+        OUTI
+        NOP
+        NOP
+        NOP
+        NOP
+        OUTI
+        NOP
+        NOP
+        NOP
+        NOP
+        OUTI
+        NOP
+        NOP
+        NOP
+        NOP
+        OUTI
+        NOP
+        NOP
+        NOP
+        NOP
+        OUTI
+        NOP
+        NOP
+        NOP
+        NOP
+        OUTI
+        NOP
+        NOP
+        NOP
+        NOP
+        LD      A, E
+        SUB     8
+        LD      E, A
+        JR      NC, VDPBURSTWRITEL8
+        DEC     D
+        JR      VDPBURSTWRITEL8
+VDPBURSTWRITETAIL:
+        OR      A
+        JR      Z, VDPBURSTWRITEDONE
+VDPBURSTWRITETAILL:
+        OUTI
+        NOP
+        NOP
+        NOP
+        NOP
+        DEC     E
+        JR      NZ, VDPBURSTWRITETAILL
+VDPBURSTWRITEDONE:
+        POP     DE
+        POP     BC
+        CALL VDPUNLOCK
+        RET
+
+; Read a block from VRAM
+;   - HL : destination (it is advanced by the count)
+;   - DE : VRAM address
+;   - BC : count
+VDPBURSTREAD:
+        CALL VDPLOCK
+        CALL    VDPREADADDR
+        PUSH    BC
+        PUSH    DE
+        LD      D, B
+        LD      E, C
+        LD      BC, (VDPDATAPORTREAD)
+VDPBURSTREADL8:
+        LD      A, D
+        OR      A
+        JR      NZ, VDPBURSTREAD8
+        LD      A, E
+        CP      8
+        JR      C, VDPBURSTREADTAIL
+VDPBURSTREAD8:
+        INI
+        NOP
+        NOP
+        NOP
+        NOP
+        INI
+        NOP
+        NOP
+        NOP
+        NOP
+        INI
+        NOP
+        NOP
+        NOP
+        NOP
+        INI
+        NOP
+        NOP
+        NOP
+        NOP
+        INI
+        NOP
+        NOP
+        NOP
+        NOP
+        INI
+        NOP
+        NOP
+        NOP
+        NOP
+        INI
+        NOP
+        NOP
+        NOP
+        NOP
+        INI
+        NOP
+        NOP
+        NOP
+        NOP
+        LD      A, E
+        SUB     8
+        LD      E, A
+        JR      NC, VDPBURSTREADL8
+        DEC     D
+        JR      VDPBURSTREADL8
+VDPBURSTREADTAIL:
+        OR      A
+        JR      Z, VDPBURSTREADDONE
+VDPBURSTREADTAILL:
+        INI
+        NOP
+        NOP
+        NOP
+        NOP
+        DEC     E
+        JR      NZ, VDPBURSTREADTAILL
+VDPBURSTREADDONE:
+        POP     DE
+        POP     BC
+        CALL VDPUNLOCK
+        RET
+
+; Fill VRAM with a value
+;   - A : value
+;   - DE : VRAM address
+;   - BC : count
+VDPBURSTFILL:
+        CALL VDPLOCK
+        PUSH    AF
+        CALL    VDPWRITEADDR
+        POP     AF
+        PUSH    BC
+        PUSH    DE
+        PUSH    HL
+        LD      H, B
+        LD      L, C
+        CALL    VDPBURSTFILLI
+        POP     HL
+        POP     DE
+        POP     BC
+        CALL VDPUNLOCK
+        RET
+
+; Fill loop, with the VDP already locked and addressed
+;   - A : value
+;   - HL : count
+VDPBURSTFILLI:
+        LD      D, A
+        LD      BC, (VDPDATAPORTWRITE)
+VDPBURSTFILLL8:
+        LD      A, H
+        OR      A
+        JR      NZ, VDPBURSTFILL8
+        LD      A, L
+        CP      8
+        JR      C, VDPBURSTFILLTAIL
+VDPBURSTFILL8:
+        OUT     (C), D
+        NOP
+        NOP
+        NOP
+        NOP
+        NOP
+        OUT     (C), D
+        NOP
+        NOP
+        NOP
+        NOP
+        NOP
+        OUT     (C), D
+        NOP
+        NOP
+        NOP
+        NOP
+        NOP
+        OUT     (C), D
+        NOP
+        NOP
+        NOP
+        NOP
+        NOP
+        OUT     (C), D
+        NOP
+        NOP
+        NOP
+        NOP
+        NOP
+        OUT     (C), D
+        NOP
+        NOP
+        NOP
+        NOP
+        NOP
+        OUT     (C), D
+        NOP
+        NOP
+        NOP
+        NOP
+        NOP
+        OUT     (C), D
+        NOP
+        NOP
+        NOP
+        NOP
+        NOP
+        LD      A, L
+        SUB     8
+        LD      L, A
+        JR      NC, VDPBURSTFILLL8
+        DEC     H
+        JR      VDPBURSTFILLL8
+VDPBURSTFILLTAIL:
+        OR      A
+        RET     Z
+VDPBURSTFILLTAILL:
+        OUT     (C), D
+        NOP
+        NOP
+        NOP
+        NOP
+        NOP
+        DEC     L
+        JR      NZ, VDPBURSTFILLTAILL
+        RET
+
 VDPFILL8:
         CALL VDPLOCK
         PUSH    AF
@@ -570,4 +859,4 @@ WAITVBL2:
         LD A, (VBLFLAG)
         CP 0
         JR Z, WAITVBL2
-        RET
+        JP TMS9918FRAMEHOOK
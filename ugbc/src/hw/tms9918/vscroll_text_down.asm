@@ -70,74 +70,47 @@ VSCROLLTDOWNNMI2:
     JP VSCROLLTDOWNDONE
 
 VSCROLLTDOWN0:
-    LD BC, 40 * 24
     LD A, 40
-    LD E, A
-    LD D, 0
-    LD HL, (TEXTADDRESS)
-    PUSH HL
     JP VSCROLLTDOWNCOMMON
 
 VSCROLLTDOWN1:
-    LD BC, 32 * 24
+VSCROLLTDOWN2:
+VSCROLLTDOWN3:
     LD A, 32
-    LD E, A
-    LD D, 0
+    JP VSCROLLTDOWNCOMMON
+
+VSCROLLTDOWNCOMMON:
+    ; Rows are moved one at a time, from the bottom, with a burst read 
+    ; into VDPBURSTBUFFER followed by a burst write one row below.
+    LD C, A
+    LD B, 0
     LD HL, (TEXTADDRESS)
     PUSH HL
-    LD HL, (TEXTADDRESS)
+    LD A, 22
+VSCROLLTDOWNLAST:
     ADD HL, BC
-    SBC HL, DE
+    DEC A
+    JR NZ, VSCROLLTDOWNLAST
+    LD A, 23
+
+VSCROLLTDOWNLOOP:
+    PUSH AF
     PUSH HL
-    LD HL, (TEXTADDRESS)
-    ADC HL, BC
     LD DE, HL
+    LD HL, VDPBURSTBUFFER
+    CALL VDPBURSTREAD
     POP HL
-    JP VSCROLLTDOWNCOMMON
-
-VSCROLLTDOWN2:
-VSCROLLTDOWN3:
-    LD BC, 32 * 24
-    LD A, 32
-    LD E, A
-    LD D, 0
-    LD HL, (TEXTADDRESS)
     PUSH HL
-    LD HL, (TEXTADDRESS)
     ADD HL, BC
-    SBC HL, DE
-    PUSH HL
-    LD HL, (TEXTADDRESS)
-    ADC HL, BC
     LD DE, HL
+    LD HL, VDPBURSTBUFFER
+    CALL VDPBURSTWRITE
     POP HL
-    JP VSCROLLTDOWNCOMMON
-
-VSCROLLTDOWNCOMMON:
-VSCROLLTDOWNLOOP:
-
-    PUSH DE
-    PUSH BC
-    LD DE, HL
-    LD BC, 1
-    CALL VDPINCHAR
-    POP BC
-    POP DE
-
-    PUSH DE
-    PUSH BC
-    LD BC, 1
-    CALL VDPOUTCHAR
-    POP BC
-    POP DE
-
-    DEC     DE
-    DEC     HL
-
-    DEC     C
-    JP      NZ, VSCROLLTDOWNLOOP
-    DEC     B
-    JP      NZ, VSCROLLTDOWNLOOP
+    AND A
+    SBC HL, BC
+    POP AF
+    DEC A
+    JR NZ, VSCROLLTDOWNLOOP
 
     LD A, (CURRENTMODE)
     CP 0
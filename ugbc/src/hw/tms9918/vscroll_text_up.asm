@@ -98,33 +98,31 @@ VSCROLLTUP3:
     JP VSCROLLTUPCOMMON
 
 VSCROLLTUPCOMMON:
+    ; Rows are moved one at a time, with a burst read into VDPBURSTBUFFER
+    ; followed by a burst write one row above.
+    LD C, E
+    LD B, 0
     LD HL, (TEXTADDRESS)
-    PUSH HL
-    ADD HL, DE
-    POP DE
-    INC B
-    
-VSCROLLTUPLOOP:
+    LD DE, HL
+    ADD HL, BC
+    LD A, 23
 
+VSCROLLTUPLOOP:
+    PUSH AF
+    PUSH HL
     PUSH DE
-    PUSH BC
     LD DE, HL
-    LD BC, 1
-    CALL VDPINCHAR
-    POP BC
+    LD HL, VDPBURSTBUFFER
+    CALL VDPBURSTREAD
     POP DE
-
-    PUSH BC
-    LD BC, 1
-    CALL VDPOUTCHAR
-    POP BC
-
-    INC     DE
-    INC     HL
-
-    DEC     C
-    JP      NZ, VSCROLLTUPLOOP
-    DJNZ    VSCROLLTUPLOOP
+    LD HL, VDPBURSTBUFFER
+    CALL VDPBURSTWRITE
+    POP HL
+    LD DE, HL
+    ADD HL, BC
+    POP AF
+    DEC A
+    JR NZ, VSCROLLTUPLOOP
 
     LD A, (CURRENTMODE)
     CP 0
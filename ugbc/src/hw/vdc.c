@@ -65,10 +65,10 @@ static int lastUsedSlotInCommonPalette = 0;
 
 RGBi * vdc_image_nearest_system_color( RGBi * _color ) {
 
-    unsigned int minDistance = 0xffff;
+    unsigned int minDistance = 0xffffffff;
     int colorIndex = 0;
     for (int j = 0; j < COLOR_COUNT; ++j) {
-        int distance = rgbi_distance(&SYSTEM_PALETTE[j], _color);
+        int distance = rgbi_distance_squared(&SYSTEM_PALETTE[j], _color);
         if (distance < minDistance) {
             minDistance = distance;
             colorIndex = j;
@@ -715,7 +715,7 @@ static int rgbConverterFunction( int _red, int _green, int _blue ) {
     rgb.blue = _blue;
 
     for (j = 0; j < sizeof(SYSTEM_PALETTE)/sizeof(RGBi); ++j) {
-        int distance = rgbi_distance(&SYSTEM_PALETTE[j], &rgb);
+        int distance = rgbi_distance_squared(&SYSTEM_PALETTE[j], &rgb);
         if (distance < minDistance) {
             minDistance = distance;
             colorIndex = j;
@@ -65,10 +65,10 @@ int lastUsedSlotInCommonPalette = 0;
 
 RGBi * vdcz_image_nearest_system_color( RGBi * _color ) {
 
-    unsigned int minDistance = 0xffff;
+    unsigned int minDistance = 0xffffffff;
     int colorIndex = 0;
     for (int j = 0; j < COLOR_COUNT; ++j) {
-        int distance = rgbi_distance(&SYSTEM_PALETTE[j], _color);
+        int distance = rgbi_distance_squared(&SYSTEM_PALETTE[j], _color);
         if (distance < minDistance) {
             minDistance = distance;
             colorIndex = j;
@@ -169,9 +169,9 @@ static Variable * vcdz_image_converter_bitmap_mode_standard( Environment * _envi
                 rgb.blue = 0;
             }
 
-            int minDistance = 9999;
+            int minDistance = 0x7fffffff;
             for( int i=0; i<2; ++i ) {
-                int distance = rgbi_distance(&commonPalette[i], &rgb );
+                int distance = rgbi_distance_squared(&commonPalette[i], &rgb );
                 if ( distance < minDistance ) {
                     minDistance = distance;
                     colorIndex = commonPalette[i].index;
@@ -374,9 +374,9 @@ static void vdcz_image_converter_tiles( Environment * _environment, char * _sour
                 rgb.blue = 0;
             }
 
-            int minDistance = 9999;
+            int minDistance = 0x7fffffff;
             for( int i=0; i<2; ++i ) {
-                int distance = rgbi_distance(&commonPalette[i], &rgb );
+                int distance = rgbi_distance_squared(&commonPalette[i], &rgb );
                 if ( distance < minDistance ) {
                     minDistance = distance;
                     colorIndex = rgb.index;
@@ -729,7 +729,7 @@ static int rgbConverterFunction( int _red, int _green, int _blue ) {
     rgb.blue = _blue;
 
     for (j = 0; j < sizeof(SYSTEM_PALETTE)/sizeof(RGBi); ++j) {
-        int distance = rgbi_distance(&SYSTEM_PALETTE[j], &rgb);
+        int distance = rgbi_distance_squared(&SYSTEM_PALETTE[j], &rgb);
         if (distance < minDistance) {
             minDistance = distance;
             colorIndex = j;
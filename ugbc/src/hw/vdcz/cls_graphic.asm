@@ -36,34 +36,15 @@
 ;* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
 
 CLSG:
-    ; Set the start location
-    ; Set address to clear
-    LD HL, (TEXTADDRESS)
-    PUSH HL
-    POP IY
-    CALL VDCZSETADDR
-
     ; Clear the copy bit && Reverse Bit
     LD IXH, 24
     LD IXL, 0
     CALL VDCZWRITE
 
-    ; Set data byte
-    LD IXH, 31
+    ; Clear the bitmap
+    LD DE, (TEXTADDRESS)
+    LD BC, 32768
     LD A, $0
-    LD IXL, A
-    CALL VDCZWRITE
-
-    LD B, 128
-
-CLSGL1:
-    ; Word count register
-    ; Set data byte
-    LD IXH, 30
-    LD IXL, 0
-    CALL VDCZWRITE
-
-    DEC B
-    JR NZ, CLSGL1
+    CALL VDCZBURSTFILL
 
     RET
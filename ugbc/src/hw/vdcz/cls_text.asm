@@ -36,64 +36,21 @@
 ;* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
 
 CLST:
-    ; Set the start location
-    ; Set address to clear
-    LD HL, (TEXTADDRESS)
-    PUSH HL
-    POP IY
-    CALL VDCZSETADDR
-
     ; Clear the copy bit && Reverse Bit
     LD IXH, 24
     LD IXL, 0
     CALL VDCZWRITE
 
-    ; Set data byte
-    LD IXH, 31
+    ; Clear the text
+    LD DE, (TEXTADDRESS)
+    LD BC, 2048
     LD A, (EMPTYTILE)
-    LD IXL, A
-    CALL VDCZWRITE
-
-    LD B, 8
-
-CLSTL1:
-    ; Word count register
-    ; Set data byte
-    LD IXH, 30
-    LD IXL, 0
-    CALL VDCZWRITE
-
-    DEC B
-    JR NZ, CLSTL1
-
-    ; Set the start location
-    ; Set address to clear
-    LD HL, (COLORMAPADDRESS)
-    PUSH HL
-    POP IY
-    CALL VDCZSETADDR
+    CALL VDCZBURSTFILL
 
-    ; Clear the copy bit && Reverse Bit
-    LD IXH, 24
-    LD IXL, 0
-    CALL VDCZWRITE
-
-    ; Set data byte
-    LD IXH, 31
+    ; Clear the attributes
+    LD DE, (COLORMAPADDRESS)
+    LD BC, 2048
     LD A, (_PEN)
-    LD IXL, A
-    CALL VDCZWRITE
-
-    LD B, 8
-
-CLSTL2:
-    ; Word count register
-    ; Set data byte
-    LD IXH, 30
-    LD IXL, 0
-    CALL VDCZWRITE
-
-    DEC B
-    JR NZ, CLSTL2
+    CALL VDCZBURSTFILL
 
     RET
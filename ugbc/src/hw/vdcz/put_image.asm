@@ -104,16 +104,9 @@ PUTIMAGE1L2:
 
     PUSH BC
 PUTIMAGE1L1:
-    ; Calculate new pixels
-    LD A, (HL)
-    ; Draw them
-    CALL VDCZPUTCHAR
-
-    INC DE
-    INC HL
-
-    DEC C
-    JP NZ, PUTIMAGE1L1
+    ; Draw the whole row at once
+    LD B, 0
+    CALL VDCZBURSTWRITE
 
 PUTIMAGE1DONEROW:
     POP BC
@@ -186,6 +186,104 @@ VDCZGETCHAR:
     POP IY
     RET
 
+; Burst writing to this RAM: the data register is selected once, and the
+; update address is incremented by the VDCZ itself after each byte.
+;   - HL : source (it is advanced by the count)
+;   - DE : address
+;   - BC : count
+VDCZBURSTWRITE:
+    LD A, B
+    OR C
+    RET Z
+    PUSH IY
+    PUSH DE
+    PUSH BC
+    PUSH DE
+    POP IY
+    CALL VDCZSETADDR
+    LD D, B
+    LD E, C
+    LD BC, VDCZADDRREG
+    LD A, 31
+    OUT (C), A
+VDCZBURSTWRITEL1:
+    LD BC, VDCZADDRREG
+VDCZBURSTWRITEL2:
+    IN A, (C)
+    AND $80
+    JR Z, VDCZBURSTWRITEL2
+    LD BC, VDCZDATAREG
+    LD A, (HL)
+    OUT (C), A
+    INC HL
+    DEC DE
+    LD A, D
+    OR E
+    JR NZ, VDCZBURSTWRITEL1
+    POP BC
+    POP DE
+    POP IY
+    RET
+
+; Burst filling this RAM, by using the block fill mode of the VDCZ: the
+; first byte is written as usual, and the word count register (30) then 
+; repeats it up to 256 times for each write.
+;   - A : value
+;   - DE : address
+;   - BC : count
+VDCZBURSTFILL:
+    PUSH IY
+    PUSH DE
+    PUSH BC
+    PUSH AF
+    LD A, B
+    OR C
+    JR Z, VDCZBURSTFILLDONE
+    PUSH DE
+    POP IY
+    CALL VDCZSETADDR
+
+    ; Clear the copy bit, to select the block fill
+    LD IXH, 24
+    CALL VDCZREAD
+    AND $7F
+    LD IXL, A
+    CALL VDCZWRITE
+
+    ; Set data byte
+    POP AF
+    PUSH AF
+    LD IXH, 31
+    LD IXL, A
+    CALL VDCZWRITE
+
+    DEC BC
+VDCZBURSTFILLL1:
+    LD A, B
+    OR A
+    JR NZ, VDCZBURSTFILLFULL
+    LD A, C
+    OR A
+    JR Z, VDCZBURSTFILLDONE
+    LD IXH, 30
+    LD IXL, A
+    CALL VDCZWRITE
+    JR VDCZBURSTFILLDONE
+VDCZBURSTFILLFULL:
+    ; Word count of 0 means 256 bytes
+    LD IXH, 30
+    LD IXL, 0
+    CALL VDCZWRITE
+    DEC B
+    JR VDCZBURSTFILLL1
+
+VDCZBURSTFILLDONE:
+    POP AF
+    POP BC
+    POP DE
+    POP IY
+    RET
+
 VDCZSTARTUP:
     RET
 
@@ -62,10 +62,10 @@ static RGBi SYSTEM_PALETTE[] = {
 
 RGBi * vic1_image_nearest_system_color( RGBi * _color ) {
 
-    unsigned int minDistance = 0xffff;
+    unsigned int minDistance = 0xffffffff;
     int colorIndex = 0;
     for (int j = 0; j < COLOR_COUNT; ++j) {
-        int distance = rgbi_distance(&SYSTEM_PALETTE[j], _color);
+        int distance = rgbi_distance_squared(&SYSTEM_PALETTE[j], _color);
         if (distance < minDistance) {
             minDistance = distance;
             colorIndex = j;
@@ -334,7 +334,7 @@ static int rgbConverterFunction( int _red, int _green, int _blue ) {
     rgb.blue = _blue;
 
     for (j = 0; j < sizeof(SYSTEM_PALETTE)/sizeof(RGBi); ++j) {
-        int distance = rgbi_distance(&SYSTEM_PALETTE[j], &rgb);
+        int distance = rgbi_distance_squared(&SYSTEM_PALETTE[j], &rgb);
         if (distance < minDistance) {
             minDistance = distance;
             colorIndex = j;
@@ -905,10 +905,10 @@ static Variable * vic1_image_converter_bitmap_mode_standard( Environment * _envi
     int i, j, k;
 
     for( i=0; i<colorUsed; ++i ) {
-        int minDistance = 0xffff;
+        int minDistance = 0x7fffffff;
         int colorIndex = 0;
         for (j = 0; j < sizeof(SYSTEM_PALETTE)/sizeof(RGBi); ++j) {
-            int distance = rgbi_distance(&SYSTEM_PALETTE[j], &palette[i]);
+            int distance = rgbi_distance_squared(&SYSTEM_PALETTE[j], &palette[i]);
             // printf("%d <-> %d [%d] = %d [min = %d]\n", i, j, SYSTEM_PALETTE[j].index, distance, minDistance );
             if (distance < minDistance) {
                 // printf(" candidated...\n" );
@@ -1034,10 +1034,10 @@ static Variable * vic1_image_converter_multicolor_mode_standard( Environment * _
     int i, j, k;
 
     for( i=0; i<colorUsed; ++i ) {
-        int minDistance = 0xffff;
+        int minDistance = 0x7fffffff;
         int colorIndex = 0;
         for (j = 0; j < sizeof(SYSTEM_PALETTE)/sizeof(RGBi); ++j) {
-            int distance = rgbi_distance(&SYSTEM_PALETTE[j], &palette[i]);
+            int distance = rgbi_distance_squared(&SYSTEM_PALETTE[j], &palette[i]);
             // printf("%d <-> %d [%d] = %d [min = %d]\n", i, j, SYSTEM_PALETTE[j].index, distance, minDistance );
             if (distance < minDistance) {
                 // printf(" candidated...\n" );
@@ -1106,7 +1106,7 @@ static Variable * vic1_image_converter_multicolor_mode_standard( Environment * _
             offset = (tile_y * 8 *( _frame_width >> 2 ) ) + (tile_x * 8) + (image_y & 0x07);
             offsetc = (tile_y * ( _frame_width >> 2 ) ) + (tile_x);
 
-            int minDistance = 0xffff;
+            int minDistance = 0x7fffffff;
             int colorIndex = 0;
 
             for( i=0; i<colorUsed; ++i ) {
@@ -1383,10 +1383,10 @@ static Variable * vic1_image_converter_tilemap_mode_standard( Environment * _env
     int i, j, k;
 
     for( i=0; i<colorUsed; ++i ) {
-        int minDistance = 0xffff;
+        int minDistance = 0x7fffffff;
         int colorIndex = 0;
         for (j = 0; j < sizeof(SYSTEM_PALETTE)/sizeof(RGBi); ++j) {
-            int distance = rgbi_distance(&SYSTEM_PALETTE[j], &palette[i]);
+            int distance = rgbi_distance_squared(&SYSTEM_PALETTE[j], &palette[i]);
             // printf("%d <-> %d [%d] = %d [min = %d]\n", i, j, SYSTEM_PALETTE[j].index, distance, minDistance );
             if (distance < minDistance) {
                 // printf(" candidated...\n" );
@@ -1479,7 +1479,7 @@ static Variable * vic1_image_converter_tilemap_mode_standard( Environment * _env
             if ( tile == -1 ) {
                 if ( _environment->descriptors->count < 256 ) {
                     tile = (_environment->descriptors->count++);
-                    _environment->descriptors->descriptor[tile] = t; 
+                    tile_descriptors_set( _environment->descriptors, tile, t ); 
                     memcpy( &_environment->descriptors->data[tile], &tileData, sizeof( TileData ) ); 
                 } else {
                     tile = calculate_nearest_tile( t, _environment->descriptors );
@@ -65,10 +65,10 @@ int lastUsedSlotInCommonPalette = 0;
 
 RGBi * vic2_image_nearest_system_color( RGBi * _color ) {
 
-    unsigned int minDistance = 0xffff;
+    unsigned int minDistance = 0xffffffff;
     int colorIndex = 0;
     for (int j = 0; j < COLOR_COUNT; ++j) {
-        int distance = rgbi_distance(&SYSTEM_PALETTE[j], _color);
+        int distance = rgbi_distance_squared(&SYSTEM_PALETTE[j], _color);
         if (distance < minDistance) {
             minDistance = distance;
             colorIndex = j;
@@ -502,6 +502,29 @@ static void vic2_image_converter_tiles_multicolor( Environment * _environment, c
 
 }
 
+/**
+ * @brief <i>VIC-II</i>: deploy sprite routines
+ * 
+ * Sprite routines are served by the multiplexer (<i>hw/vic2/multiplexer.asm</i>)
+ * if it has been requested by <b>DEFINE SPRITE MULTIPLEX</b>. Both modules
+ * share the same entry points and calling conventions.
+ * 
+ * @param _environment Current calling environment
+ */
+static void vic2_sprite_deploy( Environment * _environment ) {
+
+    if ( _environment->spriteConfig.multiplex ) {
+#if defined(__c128__)
+        CRITICAL_SPRITE_MULTIPLEX_UNSUPPORTED();
+#endif
+        _environment->bitmaskNeeded = 1;
+        deploy( spriteMultiplexer, src_hw_vic2_multiplexer_asm );
+    } else {
+        deploy( sprite, src_hw_vic2_sprites_asm );
+    }
+
+}
+
 /**
  * @brief <i>VIC-II</i>: emit code to check for collision
  * 
@@ -517,7 +540,7 @@ Variable * vic2_collision( Environment * _environment, char * _sprite ) {
 
     _environment->bitmaskNeeded = 1;
 
-    deploy( sprite, src_hw_vic2_sprites_asm );
+    vic2_sprite_deploy( _environment );
 
     Variable * sprite = variable_retrieve_or_define( _environment, _sprite, VT_SPRITE, 0 );
     Variable * result = variable_temporary( _environment, VT_SBYTE, "(collision result)");
@@ -697,6 +720,12 @@ void vic2_sprite_common_color( Environment * _environment, char * _index, char *
  */
 void vic2_raster_at( Environment * _environment, char * _label, char * _positionlo, char * _positionhi ) {
 
+    // The multiplexer owns the raster interrupt chain.
+    if ( _environment->spriteConfig.multiplex ) {
+        CRITICAL_SPRITE_MULTIPLEX_RASTER();
+    }
+    _environment->spriteConfig.rasterAt = 1;
+
     MAKE_LABEL
 
     outline0("LDA #%01111111"); // switch off CIA-1
@@ -762,6 +791,12 @@ void vic2_next_raster( Environment * _environment ) {
  */
 void vic2_next_raster_at( Environment * _environment, char * _label, char * _positionlo, char * _positionhi ) {
 
+    // The multiplexer owns the raster interrupt chain.
+    if ( _environment->spriteConfig.multiplex ) {
+        CRITICAL_SPRITE_MULTIPLEX_RASTER();
+    }
+    _environment->spriteConfig.rasterAt = 1;
+
     MAKE_LABEL
 
     outline1("LDA %s", _positionlo);
@@ -856,7 +891,7 @@ static int rgbConverterFunction( int _red, int _green, int _blue ) {
     rgb.blue = _blue;
 
     for (j = 0; j < sizeof(SYSTEM_PALETTE)/sizeof(RGBi); ++j) {
-        int distance = rgbi_distance(&SYSTEM_PALETTE[j], &rgb);
+        int distance = rgbi_distance_squared(&SYSTEM_PALETTE[j], &rgb);
         if (distance < minDistance) {
             minDistance = distance;
             colorIndex = j;
@@ -1323,7 +1358,7 @@ void vic2_sprite_data_from( Environment * _environment, char * _sprite, char * _
     Variable * sprite = variable_retrieve_or_define( _environment, _sprite, VT_BYTE, 0 );
     Variable * image = variable_retrieve_or_define( _environment, _image, VT_IMAGE, 0 );
 
-    deploy( sprite, src_hw_vic2_sprites_asm );
+    vic2_sprite_deploy( _environment );
 
     outline1("LDA #<%s", image->realName );
     outline0("STA MATHPTR1"  );
@@ -1338,7 +1373,7 @@ void vic2_sprite_enable( Environment * _environment, char * _sprite ) {
 
     Variable * sprite = variable_retrieve_or_define( _environment, _sprite, VT_BYTE, 0 );
 
-    deploy( sprite, src_hw_vic2_sprites_asm );
+    vic2_sprite_deploy( _environment );
 
     _environment->bitmaskNeeded = 1;
 
@@ -1351,7 +1386,7 @@ void vic2_sprite_disable( Environment * _environment, char * _sprite ) {
 
     Variable * sprite = variable_retrieve_or_define( _environment, _sprite, VT_BYTE, 0 );
 
-    deploy( sprite, src_hw_vic2_sprites_asm );
+    vic2_sprite_deploy( _environment );
     
     _environment->bitmaskNeeded = 1;
 
@@ -1366,7 +1401,7 @@ void vic2_sprite_at( Environment * _environment, char * _sprite, char * _x, char
     Variable * x = variable_retrieve_or_define( _environment, _x, VT_POSITION, 0 );
     Variable * y = variable_retrieve_or_define( _environment, _y, VT_POSITION, 0 );
 
-    deploy( sprite, src_hw_vic2_sprites_asm );
+    vic2_sprite_deploy( _environment );
     
     _environment->bitmaskNeeded = 1;
 
@@ -1384,7 +1419,7 @@ void vic2_sprite_expand_vertical( Environment * _environment, char * _sprite ) {
 
     Variable * sprite = variable_retrieve_or_define( _environment, _sprite, VT_BYTE, 0 );
 
-    deploy( sprite, src_hw_vic2_sprites_asm );
+    vic2_sprite_deploy( _environment );
     outline1("LDY %s", sprite->realName );
     outline0("JSR SPRITEEXPANDY" );
 
@@ -1394,7 +1429,7 @@ void vic2_sprite_expand_horizontal( Environment * _environment, char * _sprite )
 
     Variable * sprite = variable_retrieve_or_define( _environment, _sprite, VT_BYTE, 0 );
 
-    deploy( sprite, src_hw_vic2_sprites_asm );
+    vic2_sprite_deploy( _environment );
     
     outline1("LDY %s", sprite->realName );
     outline0("JSR SPRITEEXPANDX" );
@@ -1405,7 +1440,7 @@ void vic2_sprite_compress_vertical( Environment * _environment, char * _sprite )
 
     Variable * sprite = variable_retrieve_or_define( _environment, _sprite, VT_BYTE, 0 );
 
-    deploy( sprite, src_hw_vic2_sprites_asm );
+    vic2_sprite_deploy( _environment );
     
     outline1("LDY %s", sprite->realName );
     outline0("JSR SPRITECOMPRESSY" );
@@ -1416,7 +1451,7 @@ void vic2_sprite_compress_horizontal( Environment * _environment, char * _sprite
 
     Variable * sprite = variable_retrieve_or_define( _environment, _sprite, VT_BYTE, 0 );
 
-    deploy( sprite, src_hw_vic2_sprites_asm );
+    vic2_sprite_deploy( _environment );
     
     outline1("LDY %s", sprite->realName );
     outline0("JSR SPRITECOMPRESSX" );
@@ -1429,7 +1464,7 @@ void vic2_sprite_multicolor( Environment * _environment, char * _sprite ) {
 
     Variable * sprite = variable_retrieve_or_define( _environment, _sprite, VT_BYTE, 0 );
 
-    deploy( sprite, src_hw_vic2_sprites_asm );
+    vic2_sprite_deploy( _environment );
     
     outline1("LDY %s", sprite->realName );
     outline0("JSR SPRITEMULTICOLOR" );
@@ -1442,7 +1477,7 @@ void vic2_sprite_monocolor( Environment * _environment, char * _sprite ) {
 
     Variable * sprite = variable_retrieve_or_define( _environment, _sprite, VT_BYTE, 0 );
 
-    deploy( sprite, src_hw_vic2_sprites_asm );
+    vic2_sprite_deploy( _environment );
     
     outline1("LDY %s", sprite->realName );
     outline0("JSR SPRITEMONOCOLOR" );
@@ -1456,7 +1491,7 @@ void vic2_sprite_color( Environment * _environment, char * _sprite, char * _colo
     Variable * sprite = variable_retrieve_or_define( _environment, _sprite, VT_BYTE, 0 );
     Variable * color = variable_retrieve_or_define( _environment, _color, VT_COLOR, COLOR_WHITE );
 
-    deploy( sprite, src_hw_vic2_sprites_asm );
+    vic2_sprite_deploy( _environment );
     
     outline1("LDA %s", color->realName );
     outline1("LDY %s", sprite->realName );
@@ -1576,8 +1611,41 @@ void vic2_cls( Environment * _environment ) {
 
 }
 
+/**
+ * @brief Move the text screen by one character, on the hidden buffer
+ * 
+ * With ''DEFINE SCROLL DOUBLE BUFFER'' the shifted screen is prepared on
+ * the matrix that is not visible, and then the two matrices are exchanged
+ * during the lower border, so that the movement never tears.
+ * 
+ * @param _environment Current calling environment
+ * @param _dx Horizontal direction (-1, 0, 1)
+ * @param _dy Vertical direction (-1, 0, 1)
+ */
+static void vic2_scroll_double_step( Environment * _environment, int _dx, int _dy ) {
+
+    deploy( vic2vars, src_hw_vic2_vars_asm);
+    deploy( scroll, src_hw_vic2_scroll_asm);
+    deploy( textHScroll, src_hw_vic2_hscroll_text_asm );
+    deploy( vScrollTextDown, src_hw_vic2_vscroll_text_down_asm );
+    deploy( vScrollTextUp, src_hw_vic2_vscroll_text_up_asm );
+    deploy( scrollDouble, src_hw_vic2_scroll_double_asm);
+
+    outline1("LDA #$%2.2x", (unsigned char)(_dx&0xff) );
+    outline0("STA XSCROLL" );
+    outline1("LDA #$%2.2x", (unsigned char)(_dy&0xff) );
+    outline0("STA YSCROLL" );
+    outline0("JSR DBSCROLLSTEP");
+
+}
+
 void vic2_scroll_text( Environment * _environment, int _direction ) {
 
+    if ( _environment->scrollDoubleBuffer ) {
+        vic2_scroll_double_step( _environment, 0, _direction > 0 ? 1 : -1 );
+        return;
+    }
+
     if ( _direction > 0 ) {
         deploy( vScrollTextDown, src_hw_vic2_vscroll_text_down_asm );
         outline0("JSR VSCROLLTDOWN");
@@ -1717,6 +1785,11 @@ void vic2_finalization( Environment * _environment ) {
 
     outhead0("VIC2FINALIZATION:");
 
+    if ( _environment->deployed.spriteMultiplexer ) {
+        outline1("LDA #$%2.2x", _environment->spriteConfig.count );
+        outline0("JSR MPXINIT" );
+    }
+
     if ( multicolorSpritePalette[0] ) {
         outline1("LDA #$%2.2x", multicolorSpritePalette[0]->index );
         outline0("STA $D025" );
@@ -1757,6 +1830,11 @@ void vic2_hscroll_line( Environment * _environment, int _direction ) {
 
 void vic2_hscroll_screen( Environment * _environment, int _direction ) {
 
+    if ( _environment->scrollDoubleBuffer ) {
+        vic2_scroll_double_step( _environment, _direction > 0 ? 1 : -1, 0 );
+        return;
+    }
+
     deploy( textHScroll, src_hw_vic2_hscroll_text_asm );
 
     outline1("LDA #$%2.2x", ( _direction & 0xff ) );
@@ -2164,9 +2242,9 @@ static Variable * vic2_image_converter_tilemap_mode_standard( Environment * _env
                         colorIndex = commonPalette[0].index;
                     } else {
 
-                        int minDistance = 9999;
+                        int minDistance = 0x7fffffff;
                         for( int i=0; i<colorUsed; ++i ) {
-                            int distance = rgbi_distance(&commonPalette[i], &rgb );
+                            int distance = rgbi_distance_squared(&commonPalette[i], &rgb );
                             if ( distance < minDistance ) {
                                 minDistance = distance;
                                 colorIndex = commonPalette[i].index;
@@ -2221,7 +2299,7 @@ static Variable * vic2_image_converter_tilemap_mode_standard( Environment * _env
             if ( tile == -1 ) {
                 if ( _environment->descriptors->count < 256 ) {
                     tile = (_environment->descriptors->count++);
-                    _environment->descriptors->descriptor[tile] = t; 
+                    tile_descriptors_set( _environment->descriptors, tile, t ); 
                     memcpy( &_environment->descriptors->data[tile], &tileData, sizeof( TileData ) ); 
                     // printf("*** tile = %d\n", tile );
                 } else {
@@ -2349,9 +2427,9 @@ static Variable * vic2_image_converter_tilemap_mode_multicolor( Environment * _e
                         colorIndex = commonPalette[0].index;
                     } else {
 
-                        int minDistance = 9999;
+                        int minDistance = 0x7fffffff;
                         for( int i=0; i<colorUsed; ++i ) {
-                            int distance = rgbi_distance(&commonPalette[i], &rgb );
+                            int distance = rgbi_distance_squared(&commonPalette[i], &rgb );
                             if ( distance < minDistance ) {
                                 minDistance = distance;
                                 colorIndex = commonPalette[i].index;
@@ -2413,7 +2491,7 @@ static Variable * vic2_image_converter_tilemap_mode_multicolor( Environment * _e
             if ( tile == -1 ) {
                 if ( _environment->descriptors->count < 256 ) {
                     tile = (_environment->descriptors->count++);
-                    _environment->descriptors->descriptor[tile] = t; 
+                    tile_descriptors_set( _environment->descriptors, tile, t ); 
                     memcpy( &_environment->descriptors->data[tile], &tileData, sizeof( TileData ) ); 
                     // printf("*** tile = %d\n", tile );
                 } else {
@@ -2541,10 +2619,10 @@ Variable * vic2_sprite_converter( Environment * _environment, char * _source, in
     int i, j, k;
 
     // for( i=0; i<colorUsed; ++i ) {
-    //     int minDistance = 0xffff;
+    //     int minDistance = 0x7fffffff;
     //     int colorIndex = 0;
     //     for (j = 0; j < sizeof(SYSTEM_PALETTE)/sizeof(RGBi); ++j) {
-    //         int distance = rgbi_distance(&SYSTEM_PALETTE[j], &palette[i]);
+    //         int distance = rgbi_distance_squared(&SYSTEM_PALETTE[j], &palette[i]);
     //         // printf("%d <-> %d [%d] = %d [min = %d]\n", i, j, SYSTEM_PALETTE[j].index, distance, minDistance );
     //         if (distance < minDistance) {
     //             // printf(" candidated...\n" );
@@ -2686,11 +2764,11 @@ Variable * vic2_sprite_converter( Environment * _environment, char * _source, in
             } else {
 
                 if ( ! _color ) {
-                    int minDistance = 0xffff;
+                    int minDistance = 0x7fffffff;
                     RGBi * color = NULL;
                     i = 0;
                     for( int k=0; k<colorUsed; ++k ) {
-                        int distance = rgbi_distance( &palette[k], &rgb );
+                        int distance = rgbi_distance_squared( &palette[k], &rgb );
                         if ( distance < minDistance ) {
                             minDistance = distance;
                             color = &palette[k];
@@ -2704,10 +2782,10 @@ Variable * vic2_sprite_converter( Environment * _environment, char * _source, in
                     //     }
                     // }
                 } else {
-                    int minDistance = 0xffff;
+                    int minDistance = 0x7fffffff;
                     RGBi * color = NULL;
                     for( int k=0; k<colorUsed; ++k ) {
-                        int distance = rgbi_distance( &palette[k], &rgb );
+                        int distance = rgbi_distance_squared( &palette[k], &rgb );
                         if ( distance < minDistance ) {
                             minDistance = distance;
                             color = &palette[k];
@@ -3291,7 +3369,12 @@ void vic2_scroll( Environment * _environment, int _dx, int _dy ) {
     outline0("STA MATHPTR0" );
     outline1("LDA #$%2.2x", (unsigned char)(_dy&0xff) );
     outline0("STA MATHPTR1" );
-    outline0("JSR SCROLL");
+    if ( _environment->scrollDoubleBuffer ) {
+        deploy( scrollDouble, src_hw_vic2_scroll_double_asm);
+        outline0("JSR SCROLLDB");
+    } else {
+        outline0("JSR SCROLL");
+    }
 
 }
 
@@ -0,0 +1,486 @@
+; /*****************************************************************************
+;  * ugBASIC - an isomorphic BASIC language compiler for retrocomputers        *
+;  *****************************************************************************
+;  * Copyright 2021-2024 Marco Spedaletti (asimov@mclink.it)
+;  *
+;  * Licensed under the Apache License, Version 2.0 (the "License");
+;  * you may not use this file except in compliance with the License.
+;  * You may obtain a copy of the License at
+;  *
+;  * http://www.apache.org/licenses/LICENSE-2.0
+;  *
+;  * Unless required by applicable law or agreed to in writing, software
+;  * distributed under the License is distributed on an "AS IS" BASIS,
+;  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+;  * See the License for the specific language governing permissions and
+;  * limitations under the License.
+;  *----------------------------------------------------------------------------
+;  * Concesso in licenza secondo i termini della Licenza Apache, versione 2.0
+;  * (la "Licenza"); è proibito usare questo file se non in conformità alla
+;  * Licenza. Una copia della Licenza è disponibile all'indirizzo:
+;  *
+;  * http://www.apache.org/licenses/LICENSE-2.0
+;  *
+;  * Se non richiesto dalla legislazione vigente o concordato per iscritto,
+;  * il software distribuito nei termini della Licenza è distribuito
+;  * "COSì COM'è", SENZA GARANZIE O CONDIZIONI DI ALCUN TIPO, esplicite o
+;  * implicite. Consultare la Licenza per il testo specifico che regola le
+;  * autorizzazioni e le limitazioni previste dalla medesima.
+;  ****************************************************************************/
+;* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+;*                                                                             *
+;*                      SPRITE MULTIPLEXER ROUTINE FOR VIC-II                  *
+;*                                                                             *
+;*                             by Marco Spedaletti                             *
+;*                                                                             *
+;* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+; The multiplexer keeps a table of (up to) 32 virtual sprites. The entry
+; points have the same names and the same calling conventions of the ones
+; in sprites.asm, but they only update the virtual table. At each frame,
+; the "frame" raster interrupt (at line MPXFRAMELINE, through IRQSVC) sorts
+; the virtual sprites by their vertical position, and programs the first
+; eight. A chain of "slot" raster interrupts (directly on $FFFE, so that
+; timers and music are served only once per frame) reuses each hardware
+; sprite for the next virtual sprite, as soon as the previous one has been
+; completely drawn.
+
+MPXFRAMELINE = $FA
+
+MPXCOUNT:       .byte 24
+MPXX:           .res 32, 0
+MPXXH:          .res 32, 0
+MPXY:           .res 32, 0
+; Sort key: vertical position if enabled, $FF otherwise.
+MPXKEY:         .res 32, $FF
+MPXCOL:         .res 32, 1
+MPXPTR:         .res 32, 0
+; Flags: bit 0 = enabled, bit 1 = expanded x, bit 2 = expanded y, 
+;        bit 3 = multicolor
+MPXFLAGS:       .res 32, 0
+MPXPHYS:        .res 32, 0
+MPXORDER:       .res 32, 0
+MPXACTIVE:      .byte 0
+MPXNEXT:        .byte 0
+MPXLINE:        .byte 0
+MPXSLOT:        .byte 0
+MPXI:           .byte 0
+MPXCUR:         .byte 0
+MPXCURKEY:      .byte 0
+MPXV:           .byte 0
+MPXCOLLIDED:    .byte 0
+
+; MPXINIT(A = number of virtual sprites)
+MPXINIT:
+    SEI
+    STA MPXCOUNT
+    LDX #0
+MPXINITL1:
+    TXA
+    STA MPXORDER, X
+    INX
+    CPX #32
+    BNE MPXINITL1
+
+    LDA #%01111111 ; switch off CIA-1
+    STA $DC0D
+    AND $D011
+    STA $D011
+    LDA $DC0D ; acknowledge CIA-1
+    LDA $DD0D ; acknowledge CIA-2
+    LDA #<MPXIRQ
+    STA $0314
+    LDA #>MPXIRQ
+    STA $0315
+    LDA #MPXFRAMELINE
+    STA $D012
+    LDA #%00000001 ; enable raster interrupt signals from VIC
+    STA $D01A
+    CLI
+    RTS
+
+; SET SPRITE DATA(Y,MATHPTR1:2)
+SPRITEDATAFROM:
+    STY MPXV
+
+    ; Virtual sprites 0...15 use the blocks at $8000, virtual sprites
+    ; 16...31 use the blocks at $8C00 (pointers $30...$3F).
+    TYA
+    CMP #16
+    BCC SPRITEDATAFROMP
+    ADC #$1F
+SPRITEDATAFROMP:
+    STA MPXPTR, Y
+
+    PHA
+    LSR
+    LSR
+    CLC
+    ADC #$80
+    STA TMPPTR2+1
+    PLA
+    AND #$03
+    LSR
+    ROR
+    ROR
+    STA TMPPTR2
+
+    LDA MATHPTR1
+    STA TMPPTR
+    LDA MATHPTR2
+    STA TMPPTR+1
+
+    LDY #0
+SPRITEDATAL1:
+    LDA (TMPPTR), Y
+    STA (TMPPTR2), Y
+    INY
+    CPY #63
+    BNE SPRITEDATAL1
+    LDA (TMPPTR), Y
+    LDY MPXV
+    STA MPXCOL, Y
+    RTS
+
+; SET SPRITE DISABLE(Y)
+SPRITEDISABLE:
+    LDA MPXFLAGS, Y
+    AND #$FE
+    STA MPXFLAGS, Y
+    LDA #$FF
+    STA MPXKEY, Y
+    RTS
+
+; SET SPRITE ENABLE(Y)
+SPRITEENABLE:
+    LDA MPXFLAGS, Y
+    ORA #$01
+    STA MPXFLAGS, Y
+    LDA MPXY, Y
+    STA MPXKEY, Y
+    RTS
+
+; SPRITE AT(Y,MATHPTR0:1,X)
+SPRITEAT:
+    LDA MATHPTR0
+    STA MPXX, Y
+    LDA MATHPTR1
+    STA MPXXH, Y
+    TXA
+    STA MPXY, Y
+    LDA MPXFLAGS, Y
+    AND #$01
+    BEQ SPRITEATDONE
+    TXA
+    STA MPXKEY, Y
+SPRITEATDONE:
+    RTS
+
+; SPRITE EXPAND(Y)
+SPRITEEXPANDX:
+    LDA MPXFLAGS, Y
+    ORA #$02
+    STA MPXFLAGS, Y
+    RTS
+
+; SPRITE EXPAND(Y)
+SPRITEEXPANDY:
+    LDA MPXFLAGS, Y
+    ORA #$04
+    STA MPXFLAGS, Y
+    RTS
+
+; SPRITE COMPRESS(Y)
+SPRITECOMPRESSX:
+    LDA MPXFLAGS, Y
+    AND #$FD
+    STA MPXFLAGS, Y
+    RTS
+
+; SPRITE COMPRESS(Y)
+SPRITECOMPRESSY:
+    LDA MPXFLAGS, Y
+    AND #$FB
+    STA MPXFLAGS, Y
+    RTS
+
+; SPRITE COLOR(Y,A)
+SPRITECOLOR:
+    STA MPXCOL, Y
+    RTS
+
+; SPRITE MULTICOLOR(Y)
+SPRITEMULTICOLOR:
+    LDA MPXFLAGS, Y
+    ORA #$08
+    STA MPXFLAGS, Y
+    RTS
+
+; SPRITE MONOCOLOR(Y)
+SPRITEMONOCOLOR:
+    LDA MPXFLAGS, Y
+    AND #$F7
+    STA MPXFLAGS, Y
+    RTS
+
+; SPRITE COLLISION(MATHPTR3)
+; The collision register is latched, and the bit checked is the one
+; of the hardware sprite that has been used for the virtual sprite
+; the last time it has been drawn.
+SPRITECOL:
+    LDA $D01E
+    ORA MPXCOLLIDED
+    STA MPXCOLLIDED
+    BNE SPRITECOL2
+    RTS
+SPRITECOL2:
+    LDY MATHPTR3
+    LDX MPXPHYS, Y
+    LDA BITMASK, X
+    AND MPXCOLLIDED
+    BEQ SPRITECOLNO
+    LDA MPXCOLLIDED
+    CMP BITMASK, X
+    BEQ SPRITECOLNO
+    LDA #0
+    STA MPXCOLLIDED
+    LDA #$FF
+    RTS
+SPRITECOLNO:
+    LDA #0
+    RTS
+
+; Incremental insertion sort of MPXORDER by MPXKEY. Since the order is
+; kept from one frame to the next, and objects move of few lines at 
+; each frame, the table is almost sorted and this takes linear time.
+MPXSORT:
+    LDX #1
+MPXSORTL1:
+    CPX MPXCOUNT
+    BCS MPXSORTDONE
+    STX MPXI
+    LDY MPXORDER, X
+    STY MPXCUR
+    LDA MPXKEY, Y
+    STA MPXCURKEY
+MPXSORTL2:
+    LDY MPXORDER-1, X
+    LDA MPXKEY, Y
+    CMP MPXCURKEY
+    BCC MPXSORTL3
+    BEQ MPXSORTL3
+    TYA
+    STA MPXORDER, X
+    DEX
+    BNE MPXSORTL2
+MPXSORTL3:
+    LDA MPXCUR
+    STA MPXORDER, X
+    LDX MPXI
+    INX
+    JMP MPXSORTL1
+MPXSORTDONE:
+    RTS
+
+; Program the virtual sprite at position MPXNEXT of the sorted order
+; into the hardware sprite (MPXNEXT mod 8).
+MPXPROGRAM:
+    LDX MPXNEXT
+    LDY MPXORDER, X
+    TXA
+    AND #$07
+    STA MPXSLOT
+    TAX
+    STA MPXPHYS, Y
+
+    LDA MPXPTR, Y
+    STA $87F8, X
+    STA $8BF8, X
+    LDA MPXCOL, Y
+    STA $D027, X
+
+    TXA
+    ASL
+    TAX
+    LDA MPXX, Y
+    STA $D000, X
+    LDA MPXY, Y
+    STA $D001, X
+    LDX MPXSLOT
+
+    LDA MPXXH, Y
+    BEQ MPXPROGRAMX0
+    LDA $D010
+    ORA BITMASK, X
+    JMP MPXPROGRAMX1
+MPXPROGRAMX0:
+    LDA $D010
+    AND BITMASKN, X
+MPXPROGRAMX1:
+    STA $D010
+
+    LDA MPXFLAGS, Y
+    AND #$02
+    BEQ MPXPROGRAMEX0
+    LDA $D01D
+    ORA BITMASK, X
+    JMP MPXPROGRAMEX1
+MPXPROGRAMEX0:
+    LDA $D01D
+    AND BITMASKN, X
+MPXPROGRAMEX1:
+    STA $D01D
+
+    LDA MPXFLAGS, Y
+    AND #$04
+    BEQ MPXPROGRAMEY0
+    LDA $D017
+    ORA BITMASK, X
+    JMP MPXPROGRAMEY1
+MPXPROGRAMEY0:
+    LDA $D017
+    AND BITMASKN, X
+MPXPROGRAMEY1:
+    STA $D017
+
+    LDA MPXFLAGS, Y
+    AND #$08
+    BEQ MPXPROGRAMMC0
+    LDA $D01C
+    ORA BITMASK, X
+    JMP MPXPROGRAMMC1
+MPXPROGRAMMC0:
+    LDA $D01C
+    AND BITMASKN, X
+MPXPROGRAMMC1:
+    STA $D01C
+
+    LDA $D015
+    ORA BITMASK, X
+    STA $D015
+    RTS
+
+; Schedule the next slot interrupt just after the last line of the
+; virtual sprite that is actually using the hardware sprite that will
+; be reused. Carry is set if there is no more room on this frame.
+MPXSCHEDULE:
+    LDA MPXNEXT
+    SEC
+    SBC #8
+    TAX
+    LDY MPXORDER, X
+    LDA MPXFLAGS, Y
+    AND #$04
+    BEQ MPXSCHEDULE1
+    LDA #43
+    JMP MPXSCHEDULE2
+MPXSCHEDULE1:
+    LDA #22
+MPXSCHEDULE2:
+    CLC
+    ADC MPXKEY, Y
+    BCS MPXSCHEDULESTOP
+    CMP #(MPXFRAMELINE-2)
+    BCS MPXSCHEDULESTOP
+    STA MPXLINE
+    STA $D012
+    LDA #<MPXSLOTIRQ
+    STA $FFFE
+    LDA #>MPXSLOTIRQ
+    STA $FFFF
+    CLC
+    RTS
+MPXSCHEDULESTOP:
+    LDA #MPXFRAMELINE
+    STA $D012
+    LDA #<IRQSVC
+    STA $FFFE
+    LDA #>IRQSVC
+    STA $FFFF
+    SEC
+    RTS
+
+; Frame interrupt (called by IRQSVC, through $0314).
+MPXIRQ:
+    PHA
+    TXA
+    PHA
+    TYA
+    PHA
+
+    JSR MPXSORT
+
+    ; Disabled sprites have been sorted at the end of the order.
+    LDX #0
+MPXIRQL1:
+    CPX MPXCOUNT
+    BEQ MPXIRQL2
+    LDY MPXORDER, X
+    LDA MPXKEY, Y
+    CMP #$FF
+    BEQ MPXIRQL2
+    INX
+    JMP MPXIRQL1
+MPXIRQL2:
+    STX MPXACTIVE
+
+    LDA $D01E
+    ORA MPXCOLLIDED
+    STA MPXCOLLIDED
+
+    LDA #0
+    STA $D015
+    STA MPXNEXT
+MPXIRQL3:
+    LDA MPXNEXT
+    CMP MPXACTIVE
+    BEQ MPXIRQDONE
+    CMP #8
+    BEQ MPXIRQCHAIN
+    JSR MPXPROGRAM
+    INC MPXNEXT
+    JMP MPXIRQL3
+MPXIRQCHAIN:
+    JSR MPXSCHEDULE
+MPXIRQDONE:
+    ASL $D019
+    PLA
+    TAY
+    PLA
+    TAX
+    PLA
+    RTI
+
+; Slot interrupt (called directly through $FFFE).
+MPXSLOTIRQ:
+    PHA
+    TXA
+    PHA
+    TYA
+    PHA
+MPXSLOTIRQL1:
+    JSR MPXPROGRAM
+    INC MPXNEXT
+    LDA MPXNEXT
+    CMP MPXACTIVE
+    BEQ MPXSLOTIRQEND
+    JSR MPXSCHEDULE
+    BCS MPXSLOTIRQDONE
+    ; If the raster is already (almost) on the next line, 
+    ; program the next sprite without waiting.
+    LDA $D012
+    CLC
+    ADC #2
+    CMP MPXLINE
+    BCS MPXSLOTIRQL1
+    JMP MPXSLOTIRQDONE
+MPXSLOTIRQEND:
+    JSR MPXSCHEDULESTOP
+MPXSLOTIRQDONE:
+    ASL $D019
+    PLA
+    TAY
+    PLA
+    TAX
+    PLA
+    RTI
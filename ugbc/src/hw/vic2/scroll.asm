@@ -52,6 +52,11 @@ ONSCROLLRIGHT:
 
 ; SCROLL(MATHPTR0,MATHPTR1)
 SCROLL:
+    JSR SCROLLCALC
+    JMP SCROLLN
+
+; SCROLLCALC(MATHPTR0,MATHPTR1) -> XSCROLLPOS,YSCROLLPOS,XSCROLL,YSCROLL
+SCROLLCALC:
     LDA #0
     STA XSCROLL
     STA YSCROLL
@@ -92,7 +97,7 @@ SCROLLX:
     LDA MATHPTR0
     CMP #0
     BNE SCROLLXX
-    JMP SCROLLN
+    JMP SCROLLCALCN
 SCROLLXX:
     CMP #$80
     BCS SCROLLXLEFT
@@ -101,25 +106,28 @@ SCROLLXRIGHT:
     CMP #7
     BEQ SCROLLXRIGHT0
     INC XSCROLLPOS
-    JMP SCROLLN
+    JMP SCROLLCALCN
 SCROLLXRIGHT0:
     LDA #0
     STA XSCROLLPOS
     LDA #$1
     STA XSCROLL
-    JMP SCROLLN
+    JMP SCROLLCALCN
 SCROLLXLEFT:
     LDA XSCROLLPOS
     CMP #0
     BEQ SCROLLXLEFT0
     DEC XSCROLLPOS
-    JMP SCROLLN
+    JMP SCROLLCALCN
 SCROLLXLEFT0:
     LDA #7
     STA XSCROLLPOS
     LDA #$FF
     STA XSCROLL
-    JMP SCROLLN
+    JMP SCROLLCALCN
+
+SCROLLCALCN:
+    RTS
 
 SCREENSCROLLVOID:
     RTS
@@ -0,0 +1,642 @@
+; /*****************************************************************************
+;  * ugBASIC - an isomorphic BASIC language compiler for retrocomputers        *
+;  *****************************************************************************
+;  * Copyright 2021-2024 Marco Spedaletti (asimov@mclink.it)
+;  *
+;  * Licensed under the Apache License, Version 2.0 (the "License");
+;  * you may not use this file except in compliance with the License.
+;  * You may obtain a copy of the License at
+;  *
+;  * http://www.apache.org/licenses/LICENSE-2.0
+;  *
+;  * Unless required by applicable law or agreed to in writing, software
+;  * distributed under the License is distributed on an "AS IS" BASIS,
+;  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+;  * See the License for the specific language governing permissions and
+;  * limitations under the License.
+;  *----------------------------------------------------------------------------
+;  * Concesso in licenza secondo i termini della Licenza Apache, versione 2.0
+;  * (la "Licenza"); è proibito usare questo file se non in conformità alla
+;  * Licenza. Una copia della Licenza è disponibile all'indirizzo:
+;  *
+;  * http://www.apache.org/licenses/LICENSE-2.0
+;  *
+;  * Se non richiesto dalla legislazione vigente o concordato per iscritto,
+;  * il software distribuito nei termini della Licenza è distribuito
+;  * "COSì COM'è", SENZA GARANZIE O CONDIZIONI DI ALCUN TIPO, esplicite o
+;  * implicite. Consultare la Licenza per il testo specifico che regola le
+;  * autorizzazioni e le limitazioni previste dalla medesima.
+;  ****************************************************************************/
+;* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+;*                                                                             *
+;*                      DOUBLE BUFFERED SCROLL ON VIC-II                       *
+;*                                                                             *
+;*                             by Marco Spedaletti                             *
+;*                                                                             *
+;* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+; The text screen is kept on two matrices ($8400 and $8800). While the
+; visible one is moved by the fine scroll registers, the hidden one is
+; filled with the content already shifted by one character, a few rows
+; for each fine step. When the fine scroll wraps, the remaining rows are
+; prepared and the matrices are exchanged during the lower border. The
+; color RAM cannot be exchanged, so the shifted colors are prepared
+; on a separate buffer and copied row by row, ahead of the beam.
+
+DBSCROLLROWLO:
+    .byte <0, <40, <80, <120, <160, <200, <240, <280, <320, <360
+    .byte <400, <440, <480, <520, <560, <600, <640, <680, <720, <760
+    .byte <800, <840, <880, <920, <960
+DBSCROLLROWHI:
+    .byte >0, >40, >80, >120, >160, >200, >240, >280, >320, >360
+    .byte >400, >440, >480, >520, >560, >600, >640, >680, >720, >760
+    .byte >800, >840, >880, >920, >960
+
+DBSCROLLDX:     .byte 0
+DBSCROLLDY:     .byte 0
+DBSCROLLROW:    .byte 0
+DBSCROLLLIMIT:  .byte 0
+DBSCROLLFIRST:  .byte 0
+DBSCROLLLAST:   .byte 0
+DBSCROLLCOLOR:  .res 1000, 0
+
+; SCROLLDB(MATHPTR0,MATHPTR1)
+SCROLLDB:
+    JSR SCROLLCALC
+
+    ; The direction of the next coarse step is the one requested:
+    ; if it changes, the rows prepared so far are useless.
+    LDX #0
+    LDA MATHPTR0
+    BEQ SCROLLDBDX
+    LDX #1
+    CMP #$80
+    BCC SCROLLDBDX
+    LDX #$FF
+SCROLLDBDX:
+    LDY #0
+    LDA MATHPTR1
+    BEQ SCROLLDBDY
+    LDY #1
+    CMP #$80
+    BCC SCROLLDBDY
+    LDY #$FF
+SCROLLDBDY:
+    LDA XSCROLL
+    ORA YSCROLL
+    BNE SCROLLDBCOARSE
+
+    JSR DBSCROLLDIRECTION
+    JSR SCREENSCROLLEMBED
+    LDA #13
+    JSR DBSCROLLPREPARE
+    RTS
+
+SCROLLDBCOARSE:
+    JSR DBSCROLLSTEP
+
+    LDA XSCROLL
+    BEQ SCROLLDBCOARSE2
+    CMP #$80
+    BCS SCROLLDBCOARSELEFT
+    JSR ONSCROLLRIGHT
+    JMP SCROLLDBCOARSE2
+SCROLLDBCOARSELEFT:
+    JSR ONSCROLLLEFT
+SCROLLDBCOARSE2:
+    LDA YSCROLL
+    BEQ SCROLLDBCOARSE3
+    CMP #$80
+    BCS SCROLLDBCOARSEUP
+    JSR ONSCROLLDOWN
+    JMP SCROLLDBCOARSE3
+SCROLLDBCOARSEUP:
+    JSR ONSCROLLUP
+SCROLLDBCOARSE3:
+    RTS
+
+; DBSCROLLSTEP(XSCROLL,YSCROLL): move the screen by one character,
+; completing the hidden matrix and exchanging it with the visible one.
+DBSCROLLSTEP:
+    LDX XSCROLL
+    LDY YSCROLL
+    JSR DBSCROLLDIRECTION
+    LDA #25
+    JSR DBSCROLLPREPARE
+    JSR DBSCROLLSWAP
+    LDA #0
+    STA DBSCROLLROW
+    RTS
+
+; DBSCROLLDIRECTION(X=dx,Y=dy)
+DBSCROLLDIRECTION:
+    CPX DBSCROLLDX
+    BNE DBSCROLLDIRECTIONC
+    CPY DBSCROLLDY
+    BNE DBSCROLLDIRECTIONC
+    RTS
+DBSCROLLDIRECTIONC:
+    STX DBSCROLLDX
+    STY DBSCROLLDY
+    LDA #0
+    STA DBSCROLLROW
+    RTS
+
+; DBSCROLLPREPARE(A=rows): prepare up to A rows of the hidden matrix.
+DBSCROLLPREPARE:
+    STA DBSCROLLLIMIT
+DBSCROLLPREPAREL1:
+    LDA DBSCROLLROW
+    CMP #25
+    BEQ DBSCROLLPREPARED
+    LDA DBSCROLLLIMIT
+    BEQ DBSCROLLPREPARED
+    DEC DBSCROLLLIMIT
+    JSR DBSCROLLPREPAREROW
+    INC DBSCROLLROW
+    JMP DBSCROLLPREPAREL1
+DBSCROLLPREPARED:
+    RTS
+
+; DBSCROLLPREPAREROW(DBSCROLLROW)
+DBSCROLLPREPAREROW:
+
+    ; Destination: the same row, on the hidden matrix and on the
+    ; color buffer.
+    LDX DBSCROLLROW
+    LDA TEXTADDRESS
+    CLC
+    ADC DBSCROLLROWLO, X
+    STA COPYOFTEXTADDRESS2
+    LDA TEXTADDRESS+1
+    EOR #$0C
+    ADC DBSCROLLROWHI, X
+    STA COPYOFTEXTADDRESS2+1
+    LDA #<DBSCROLLCOLOR
+    CLC
+    ADC DBSCROLLROWLO, X
+    STA COPYOFCOLORMAPADDRESS2
+    LDA #>DBSCROLLCOLOR
+    ADC DBSCROLLROWHI, X
+    STA COPYOFCOLORMAPADDRESS2+1
+
+    ; Source: the row that will fall on this one. If it is outside
+    ; the screen, the row is exposed: it will be emptied, keeping the
+    ; colors already there.
+    LDA DBSCROLLROW
+    SEC
+    SBC DBSCROLLDY
+    CMP #25
+    BCC DBSCROLLPREPAREROWS
+    JMP DBSCROLLPREPAREROWE
+
+DBSCROLLPREPAREROWS:
+    TAX
+    LDA TEXTADDRESS
+    CLC
+    ADC DBSCROLLROWLO, X
+    STA COPYOFTEXTADDRESS
+    LDA TEXTADDRESS+1
+    ADC DBSCROLLROWHI, X
+    STA COPYOFTEXTADDRESS+1
+    LDA #$00
+    CLC
+    ADC DBSCROLLROWLO, X
+    STA COPYOFCOLORMAPADDRESS
+    LDA #$D8
+    ADC DBSCROLLROWHI, X
+    STA COPYOFCOLORMAPADDRESS+1
+
+    ; The horizontal movement is obtained by moving back (right) or
+    ; forth (left) the source by one position, so that the same index
+    ; can be used for both. The column left behind is exposed.
+    LDA #0
+    STA DBSCROLLFIRST
+    LDA #39
+    STA DBSCROLLLAST
+    LDA DBSCROLLDX
+    BEQ DBSCROLLPREPAREROWC
+    CMP #$80
+    BCS DBSCROLLPREPAREROWL
+
+    INC DBSCROLLFIRST
+    SEC
+    LDA COPYOFTEXTADDRESS
+    SBC #1
+    STA COPYOFTEXTADDRESS
+    LDA COPYOFTEXTADDRESS+1
+    SBC #0
+    STA COPYOFTEXTADDRESS+1
+    SEC
+    LDA COPYOFCOLORMAPADDRESS
+    SBC #1
+    STA COPYOFCOLORMAPADDRESS
+    LDA COPYOFCOLORMAPADDRESS+1
+    SBC #0
+    STA COPYOFCOLORMAPADDRESS+1
+    JMP DBSCROLLPREPAREROWC
+
+DBSCROLLPREPAREROWL:
+    DEC DBSCROLLLAST
+    CLC
+    LDA COPYOFTEXTADDRESS
+    ADC #1
+    STA COPYOFTEXTADDRESS
+    LDA COPYOFTEXTADDRESS+1
+    ADC #0
+    STA COPYOFTEXTADDRESS+1
+    CLC
+    LDA COPYOFCOLORMAPADDRESS
+    ADC #1
+    STA COPYOFCOLORMAPADDRESS
+    LDA COPYOFCOLORMAPADDRESS+1
+    ADC #0
+    STA COPYOFCOLORMAPADDRESS+1
+
+DBSCROLLPREPAREROWC:
+    LDY DBSCROLLLAST
+DBSCROLLPREPAREROWCL1:
+    LDA (COPYOFTEXTADDRESS), Y
+    STA (COPYOFTEXTADDRESS2), Y
+    LDA (COPYOFCOLORMAPADDRESS), Y
+    STA (COPYOFCOLORMAPADDRESS2), Y
+    CPY DBSCROLLFIRST
+    BEQ DBSCROLLPREPAREROWCX
+    DEY
+    JMP DBSCROLLPREPAREROWCL1
+
+    ; The exposed column is emptied, and it takes the color
+    ; of its neighbour.
+DBSCROLLPREPAREROWCX:
+    LDA DBSCROLLDX
+    BEQ DBSCROLLPREPAREROWCD
+    CMP #$80
+    BCS DBSCROLLPREPAREROWCXL
+    LDY #1
+    LDA (COPYOFCOLORMAPADDRESS2), Y
+    DEY
+    JMP DBSCROLLPREPAREROWCX2
+DBSCROLLPREPAREROWCXL:
+    LDY #38
+    LDA (COPYOFCOLORMAPADDRESS2), Y
+    INY
+DBSCROLLPREPAREROWCX2:
+    STA (COPYOFCOLORMAPADDRESS2), Y
+    LDA EMPTYTILE
+    STA (COPYOFTEXTADDRESS2), Y
+DBSCROLLPREPAREROWCD:
+    RTS
+
+DBSCROLLPREPAREROWE:
+    LDX DBSCROLLROW
+    LDA #$00
+    CLC
+    ADC DBSCROLLROWLO, X
+    STA COPYOFCOLORMAPADDRESS
+    LDA #$D8
+    ADC DBSCROLLROWHI, X
+    STA COPYOFCOLORMAPADDRESS+1
+    LDY #39
+DBSCROLLPREPAREROWEL1:
+    LDA EMPTYTILE
+    STA (COPYOFTEXTADDRESS2), Y
+    LDA (COPYOFCOLORMAPADDRESS), Y
+    STA (COPYOFCOLORMAPADDRESS2), Y
+    DEY
+    BPL DBSCROLLPREPAREROWEL1
+    RTS
+
+; DBSCROLLSWAP: exchange the matrices and copy the colors.
+DBSCROLLSWAP:
+
+    ; Wait for the lower border, so that the new matrix and the new
+    ; fine scroll will be used together, from the next frame.
+DBSCROLLSWAPW:
+    LDA $D012
+    CMP #$FB
+    BNE DBSCROLLSWAPW
+
+    LDA TEXTADDRESS+1
+    EOR #$0C
+    STA TEXTADDRESS+1
+    AND #$0F
+    ASL
+    ASL
+    STA MATHPTR2
+    LDA $D018
+    AND #$0F
+    ORA MATHPTR2
+    STA $D018
+
+    JSR SCREENSCROLLEMBED
+
+    ; The colors are copied one row at a time, from the top, starting
+    ; while the beam is in the lower border. Each row takes about 420
+    ; cycles, while the beam needs at least 460 cycles to reach the next
+    ; row, even counting the 40 cycles stolen by the badline: so the copy
+    ; is faster than the beam, and it stays ahead of it also on NTSC
+    ; machines, where only 63 lines pass before the first row. A loop
+    ; of a single color for each step (16 cycles each) would be reached
+    ; by the beam before the end of the screen.
+    LDX #9
+DBSCROLLSWAPR0:
+    LDA DBSCROLLCOLOR+0, X
+    STA $D800+0, X
+    LDA DBSCROLLCOLOR+10, X
+    STA $D800+10, X
+    LDA DBSCROLLCOLOR+20, X
+    STA $D800+20, X
+    LDA DBSCROLLCOLOR+30, X
+    STA $D800+30, X
+    DEX
+    BPL DBSCROLLSWAPR0
+    LDX #9
+DBSCROLLSWAPR1:
+    LDA DBSCROLLCOLOR+40, X
+    STA $D800+40, X
+    LDA DBSCROLLCOLOR+50, X
+    STA $D800+50, X
+    LDA DBSCROLLCOLOR+60, X
+    STA $D800+60, X
+    LDA DBSCROLLCOLOR+70, X
+    STA $D800+70, X
+    DEX
+    BPL DBSCROLLSWAPR1
+    LDX #9
+DBSCROLLSWAPR2:
+    LDA DBSCROLLCOLOR+80, X
+    STA $D800+80, X
+    LDA DBSCROLLCOLOR+90, X
+    STA $D800+90, X
+    LDA DBSCROLLCOLOR+100, X
+    STA $D800+100, X
+    LDA DBSCROLLCOLOR+110, X
+    STA $D800+110, X
+    DEX
+    BPL DBSCROLLSWAPR2
+    LDX #9
+DBSCROLLSWAPR3:
+    LDA DBSCROLLCOLOR+120, X
+    STA $D800+120, X
+    LDA DBSCROLLCOLOR+130, X
+    STA $D800+130, X
+    LDA DBSCROLLCOLOR+140, X
+    STA $D800+140, X
+    LDA DBSCROLLCOLOR+150, X
+    STA $D800+150, X
+    DEX
+    BPL DBSCROLLSWAPR3
+    LDX #9
+DBSCROLLSWAPR4:
+    LDA DBSCROLLCOLOR+160, X
+    STA $D800+160, X
+    LDA DBSCROLLCOLOR+170, X
+    STA $D800+170, X
+    LDA DBSCROLLCOLOR+180, X
+    STA $D800+180, X
+    LDA DBSCROLLCOLOR+190, X
+    STA $D800+190, X
+    DEX
+    BPL DBSCROLLSWAPR4
+    LDX #9
+DBSCROLLSWAPR5:
+    LDA DBSCROLLCOLOR+200, X
+    STA $D800+200, X
+    LDA DBSCROLLCOLOR+210, X
+    STA $D800+210, X
+    LDA DBSCROLLCOLOR+220, X
+    STA $D800+220, X
+    LDA DBSCROLLCOLOR+230, X
+    STA $D800+230, X
+    DEX
+    BPL DBSCROLLSWAPR5
+    LDX #9
+DBSCROLLSWAPR6:
+    LDA DBSCROLLCOLOR+240, X
+    STA $D800+240, X
+    LDA DBSCROLLCOLOR+250, X
+    STA $D800+250, X
+    LDA DBSCROLLCOLOR+260, X
+    STA $D800+260, X
+    LDA DBSCROLLCOLOR+270, X
+    STA $D800+270, X
+    DEX
+    BPL DBSCROLLSWAPR6
+    LDX #9
+DBSCROLLSWAPR7:
+    LDA DBSCROLLCOLOR+280, X
+    STA $D800+280, X
+    LDA DBSCROLLCOLOR+290, X
+    STA $D800+290, X
+    LDA DBSCROLLCOLOR+300, X
+    STA $D800+300, X
+    LDA DBSCROLLCOLOR+310, X
+    STA $D800+310, X
+    DEX
+    BPL DBSCROLLSWAPR7
+    LDX #9
+DBSCROLLSWAPR8:
+    LDA DBSCROLLCOLOR+320, X
+    STA $D800+320, X
+    LDA DBSCROLLCOLOR+330, X
+    STA $D800+330, X
+    LDA DBSCROLLCOLOR+340, X
+    STA $D800+340, X
+    LDA DBSCROLLCOLOR+350, X
+    STA $D800+350, X
+    DEX
+    BPL DBSCROLLSWAPR8
+    LDX #9
+DBSCROLLSWAPR9:
+    LDA DBSCROLLCOLOR+360, X
+    STA $D800+360, X
+    LDA DBSCROLLCOLOR+370, X
+    STA $D800+370, X
+    LDA DBSCROLLCOLOR+380, X
+    STA $D800+380, X
+    LDA DBSCROLLCOLOR+390, X
+    STA $D800+390, X
+    DEX
+    BPL DBSCROLLSWAPR9
+    LDX #9
+DBSCROLLSWAPR10:
+    LDA DBSCROLLCOLOR+400, X
+    STA $D800+400, X
+    LDA DBSCROLLCOLOR+410, X
+    STA $D800+410, X
+    LDA DBSCROLLCOLOR+420, X
+    STA $D800+420, X
+    LDA DBSCROLLCOLOR+430, X
+    STA $D800+430, X
+    DEX
+    BPL DBSCROLLSWAPR10
+    LDX #9
+DBSCROLLSWAPR11:
+    LDA DBSCROLLCOLOR+440, X
+    STA $D800+440, X
+    LDA DBSCROLLCOLOR+450, X
+    STA $D800+450, X
+    LDA DBSCROLLCOLOR+460, X
+    STA $D800+460, X
+    LDA DBSCROLLCOLOR+470, X
+    STA $D800+470, X
+    DEX
+    BPL DBSCROLLSWAPR11
+    LDX #9
+DBSCROLLSWAPR12:
+    LDA DBSCROLLCOLOR+480, X
+    STA $D800+480, X
+    LDA DBSCROLLCOLOR+490, X
+    STA $D800+490, X
+    LDA DBSCROLLCOLOR+500, X
+    STA $D800+500, X
+    LDA DBSCROLLCOLOR+510, X
+    STA $D800+510, X
+    DEX
+    BPL DBSCROLLSWAPR12
+    LDX #9
+DBSCROLLSWAPR13:
+    LDA DBSCROLLCOLOR+520, X
+    STA $D800+520, X
+    LDA DBSCROLLCOLOR+530, X
+    STA $D800+530, X
+    LDA DBSCROLLCOLOR+540, X
+    STA $D800+540, X
+    LDA DBSCROLLCOLOR+550, X
+    STA $D800+550, X
+    DEX
+    BPL DBSCROLLSWAPR13
+    LDX #9
+DBSCROLLSWAPR14:
+    LDA DBSCROLLCOLOR+560, X
+    STA $D800+560, X
+    LDA DBSCROLLCOLOR+570, X
+    STA $D800+570, X
+    LDA DBSCROLLCOLOR+580, X
+    STA $D800+580, X
+    LDA DBSCROLLCOLOR+590, X
+    STA $D800+590, X
+    DEX
+    BPL DBSCROLLSWAPR14
+    LDX #9
+DBSCROLLSWAPR15:
+    LDA DBSCROLLCOLOR+600, X
+    STA $D800+600, X
+    LDA DBSCROLLCOLOR+610, X
+    STA $D800+610, X
+    LDA DBSCROLLCOLOR+620, X
+    STA $D800+620, X
+    LDA DBSCROLLCOLOR+630, X
+    STA $D800+630, X
+    DEX
+    BPL DBSCROLLSWAPR15
+    LDX #9
+DBSCROLLSWAPR16:
+    LDA DBSCROLLCOLOR+640, X
+    STA $D800+640, X
+    LDA DBSCROLLCOLOR+650, X
+    STA $D800+650, X
+    LDA DBSCROLLCOLOR+660, X
+    STA $D800+660, X
+    LDA DBSCROLLCOLOR+670, X
+    STA $D800+670, X
+    DEX
+    BPL DBSCROLLSWAPR16
+    LDX #9
+DBSCROLLSWAPR17:
+    LDA DBSCROLLCOLOR+680, X
+    STA $D800+680, X
+    LDA DBSCROLLCOLOR+690, X
+    STA $D800+690, X
+    LDA DBSCROLLCOLOR+700, X
+    STA $D800+700, X
+    LDA DBSCROLLCOLOR+710, X
+    STA $D800+710, X
+    DEX
+    BPL DBSCROLLSWAPR17
+    LDX #9
+DBSCROLLSWAPR18:
+    LDA DBSCROLLCOLOR+720, X
+    STA $D800+720, X
+    LDA DBSCROLLCOLOR+730, X
+    STA $D800+730, X
+    LDA DBSCROLLCOLOR+740, X
+    STA $D800+740, X
+    LDA DBSCROLLCOLOR+750, X
+    STA $D800+750, X
+    DEX
+    BPL DBSCROLLSWAPR18
+    LDX #9
+DBSCROLLSWAPR19:
+    LDA DBSCROLLCOLOR+760, X
+    STA $D800+760, X
+    LDA DBSCROLLCOLOR+770, X
+    STA $D800+770, X
+    LDA DBSCROLLCOLOR+780, X
+    STA $D800+780, X
+    LDA DBSCROLLCOLOR+790, X
+    STA $D800+790, X
+    DEX
+    BPL DBSCROLLSWAPR19
+    LDX #9
+DBSCROLLSWAPR20:
+    LDA DBSCROLLCOLOR+800, X
+    STA $D800+800, X
+    LDA DBSCROLLCOLOR+810, X
+    STA $D800+810, X
+    LDA DBSCROLLCOLOR+820, X
+    STA $D800+820, X
+    LDA DBSCROLLCOLOR+830, X
+    STA $D800+830, X
+    DEX
+    BPL DBSCROLLSWAPR20
+    LDX #9
+DBSCROLLSWAPR21:
+    LDA DBSCROLLCOLOR+840, X
+    STA $D800+840, X
+    LDA DBSCROLLCOLOR+850, X
+    STA $D800+850, X
+    LDA DBSCROLLCOLOR+860, X
+    STA $D800+860, X
+    LDA DBSCROLLCOLOR+870, X
+    STA $D800+870, X
+    DEX
+    BPL DBSCROLLSWAPR21
+    LDX #9
+DBSCROLLSWAPR22:
+    LDA DBSCROLLCOLOR+880, X
+    STA $D800+880, X
+    LDA DBSCROLLCOLOR+890, X
+    STA $D800+890, X
+    LDA DBSCROLLCOLOR+900, X
+    STA $D800+900, X
+    LDA DBSCROLLCOLOR+910, X
+    STA $D800+910, X
+    DEX
+    BPL DBSCROLLSWAPR22
+    LDX #9
+DBSCROLLSWAPR23:
+    LDA DBSCROLLCOLOR+920, X
+    STA $D800+920, X
+    LDA DBSCROLLCOLOR+930, X
+    STA $D800+930, X
+    LDA DBSCROLLCOLOR+940, X
+    STA $D800+940, X
+    LDA DBSCROLLCOLOR+950, X
+    STA $D800+950, X
+    DEX
+    BPL DBSCROLLSWAPR23
+    LDX #9
+DBSCROLLSWAPR24:
+    LDA DBSCROLLCOLOR+960, X
+    STA $D800+960, X
+    LDA DBSCROLLCOLOR+970, X
+    STA $D800+970, X
+    LDA DBSCROLLCOLOR+980, X
+    STA $D800+980, X
+    LDA DBSCROLLCOLOR+990, X
+    STA $D800+990, X
+    DEX
+    BPL DBSCROLLSWAPR24
+
+    RTS
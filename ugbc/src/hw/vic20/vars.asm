@@ -123,6 +123,9 @@ TIMERP1 = $2B
 
 TIMERRUNNING:   .BYTE   $0
 TIMERSTATUS:    .BYTE   $0
+TIMERACTIVE:    .BYTE   $0, $0, $0, $0, $0, $0, $0, $0
+TIMERACTIVECOUNT:   .BYTE   $0
+TIMERACTIVEDIRTY:   .BYTE   $0
 TIMERCOUNTER:   .WORD   $0, $0, $0, $0, $0, $0, $0, $0
 TIMERINIT:      .WORD   $0, $0, $0, $0, $0, $0, $0, $0
 TIMERADDRESS:   .WORD   $0, $0, $0, $0, $0, $0, $0, $0
@@ -65,10 +65,10 @@ int lastUsedSlotInCommonPalette = 0;
 
 RGBi * vic2z_image_nearest_system_color( RGBi * _color ) {
 
-    unsigned int minDistance = 0xffff;
+    unsigned int minDistance = 0xffffffff;
     int colorIndex = 0;
     for (int j = 0; j < COLOR_COUNT; ++j) {
-        int distance = rgbi_distance(&SYSTEM_PALETTE[j], _color);
+        int distance = rgbi_distance_squared(&SYSTEM_PALETTE[j], _color);
         if (distance < minDistance) {
             minDistance = distance;
             colorIndex = j;
@@ -847,7 +847,7 @@ static int rgbConverterFunction( int _red, int _green, int _blue ) {
     rgb.blue = _blue;
 
     for (j = 0; j < sizeof(SYSTEM_PALETTE)/sizeof(RGBi); ++j) {
-        int distance = rgbi_distance(&SYSTEM_PALETTE[j], &rgb);
+        int distance = rgbi_distance_squared(&SYSTEM_PALETTE[j], &rgb);
         if (distance < minDistance) {
             minDistance = distance;
             colorIndex = j;
@@ -2022,10 +2022,10 @@ static Variable * vic2z_image_converter_tilemap_mode_standard( Environment * _en
     int i, j, k;
 
     for( i=0; i<colorUsed; ++i ) {
-        int minDistance = 0xffff;
+        int minDistance = 0x7fffffff;
         int colorIndex = 0;
         for (j = 0; j < sizeof(SYSTEM_PALETTE)/sizeof(RGBi); ++j) {
-            int distance = rgbi_distance(&SYSTEM_PALETTE[j], &palette[i]);
+            int distance = rgbi_distance_squared(&SYSTEM_PALETTE[j], &palette[i]);
             // printf("%d <-> %d [%d] = %d [min = %d]\n", i, j, SYSTEM_PALETTE[j].index, distance, minDistance );
             if (distance < minDistance) {
                 // printf(" candidated...\n" );
@@ -2120,9 +2120,9 @@ static Variable * vic2z_image_converter_tilemap_mode_standard( Environment * _en
                         colorIndex = palette[0].index;
                     } else {
 
-                        int minDistance = 9999;
+                        int minDistance = 0x7fffffff;
                         for( int i=0; i<colorUsed; ++i ) {
-                            int distance = rgbi_distance(&palette[i], &rgb );
+                            int distance = rgbi_distance_squared(&palette[i], &rgb );
                             if ( distance < minDistance ) {
                                 minDistance = distance;
                                 colorIndex = palette[i].index;
@@ -2186,7 +2186,7 @@ static Variable * vic2z_image_converter_tilemap_mode_standard( Environment * _en
             if ( tile == -1 ) {
                 if ( _environment->descriptors->count < 128 ) {
                     tile = 0x5e + (_environment->descriptors->count++);
-                    _environment->descriptors->descriptor[tile] = t; 
+                    tile_descriptors_set( _environment->descriptors, tile, t ); 
                     memcpy( &_environment->descriptors->data[tile], &tileData, sizeof( TileData ) ); 
                 } else {
                     tile = calculate_nearest_tile( t, _environment->descriptors );
@@ -2310,10 +2310,10 @@ Variable * vic2z_sprite_converter( Environment * _environment, char * _source, i
     int i, j, k;
 
     for( i=0; i<colorUsed; ++i ) {
-        int minDistance = 0xffff;
+        int minDistance = 0x7fffffff;
         int colorIndex = 0;
         for (j = 0; j < sizeof(SYSTEM_PALETTE)/sizeof(RGBi); ++j) {
-            int distance = rgbi_distance(&SYSTEM_PALETTE[j], &palette[i]);
+            int distance = rgbi_distance_squared(&SYSTEM_PALETTE[j], &palette[i]);
             // printf("%d <-> %d [%d] = %d [min = %d]\n", i, j, SYSTEM_PALETTE[j].index, distance, minDistance );
             if (distance < minDistance) {
                 // printf(" candidated...\n" );
@@ -33,6 +33,7 @@
  ****************************************************************************/
 
 #include "../ugbc.h"
+#include <ctype.h>
 
 #include <math.h>
 
@@ -6295,8 +6296,17 @@ void z80_protothread_vars( Environment * _environment ) {
     // outhead1("PROTOTHREADST:      DEFS        %d", count );
     variable_import( _environment, "PROTOTHREADCT", VT_BYTE, 0 );
     // outhead0("PROTOTHREADCT:      DEFB        0" );
-    variable_import( _environment, "PROTOTHREADLOOP", VT_BUFFER, 1 + count * 8 );
     variable_import( _environment, "PROTOTHREADCOUNT", VT_BYTE, count );
+    variable_import( _environment, "PROTOTHREADAD", VT_BUFFER, count * 2 );
+    variable_import( _environment, "PROTOTHREADRL", VT_BUFFER, count );
+    variable_import( _environment, "PROTOTHREADRQ", VT_BUFFER, count );
+    variable_import( _environment, "PROTOTHREADRC", VT_BYTE, 0 );
+    variable_import( _environment, "PROTOTHREADRI", VT_BYTE, 0 );
+    variable_import( _environment, "PROTOTHREADWI", VT_BYTE, 0 );
+    variable_import( _environment, "PROTOTHREADWK", VT_BUFFER, count * 2 );
+    variable_import( _environment, "PROTOTHREADSQ", VT_BUFFER, count );
+    variable_import( _environment, "PROTOTHREADSC", VT_BYTE, 0 );
+    variable_import( _environment, "PROTOTHREADNOW", VT_WORD, 0 );
 
 }
 
@@ -6395,6 +6405,18 @@ void z80_protothread_get_state( Environment * _environment, char * _index, char
 
 }
 
+void z80_protothread_sleep( Environment * _environment, char * _index, char * _ticks ) {
+
+    deploy_with_vars( protothread, src_hw_z80_protothread_asm, cpu_protothread_vars );
+
+    outline1("LD HL, (%s)", _ticks );
+    outline1("LD A, (%s)", _index );
+    outline0("LD B, A" );
+
+    outline0("CALL PROTOTHREADSLEEP" );
+
+}
+
 void z80_protothread_current( Environment * _environment, char * _current ) {
 
     deploy_with_vars( protothread, src_hw_z80_protothread_asm, cpu_protothread_vars );
@@ -6404,6 +6426,366 @@ void z80_protothread_current( Environment * _environment, char * _current ) {
 
 }
 
+#define Z80_TIMER_CONTEXT_IX            0x01
+#define Z80_TIMER_CONTEXT_IY            0x02
+#define Z80_TIMER_CONTEXT_SHADOW        0x04
+
+/**
+ * @brief Decode a line of generated code for the timer manager context
+ * 
+ * This function tells how the given instruction moves the program counter
+ * and, in _clobbers, which of the optional registers saved by the timer
+ * manager (IX, IY and the shadow set) it uses. Registers AF, BC, DE and 
+ * HL are always saved.
+ * 
+ * @param _environment Current calling environment
+ * @param _mnemonic Instruction
+ * @param _operand Operand of the instruction (can be empty)
+ * @param _clobbers Registers used (updated)
+ * @param _target Where to look for the target label, if any
+ * @return How the instruction moves the program counter
+ */
+CodeLineFlow z80_code_line( Environment * _environment, char * _mnemonic, char * _operand, int * _clobbers, char ** _target ) {
+
+    char * comma = strrchr( _operand, ',' );
+
+    if ( assemblyLineHasToken( _operand, "IX" ) || assemblyLineHasToken( _operand, "IXL" ) || 
+            assemblyLineHasToken( _operand, "IXH" ) ) {
+        *_clobbers |= Z80_TIMER_CONTEXT_IX;
+    }
+
+    if ( assemblyLineHasToken( _operand, "IY" ) || assemblyLineHasToken( _operand, "IYL" ) || 
+            assemblyLineHasToken( _operand, "IYH" ) ) {
+        *_clobbers |= Z80_TIMER_CONTEXT_IY;
+    }
+
+    if ( strcasecmp( _mnemonic, "EXX" ) == 0 || strstr( _operand, "AF'" ) || strstr( _operand, "af'" ) ) {
+        *_clobbers |= Z80_TIMER_CONTEXT_SHADOW;
+    }
+
+    // CALL cc, label / JP cc, label / JR cc, label
+    *_target = comma ? comma + 1 : _operand;
+    while( **_target == ' ' || **_target == '\t' ) {
+        ++*_target;
+    }
+
+    if ( strcasecmp( _mnemonic, "RET" ) == 0 || strcasecmp( _mnemonic, "RETI" ) == 0 || 
+            strcasecmp( _mnemonic, "RETN" ) == 0 ) {
+        return *_operand ? CLF_NONE : CLF_RETURN;
+    }
+
+    if ( strcasecmp( _mnemonic, "RST" ) == 0 ) {
+        return CLF_UNKNOWN;
+    }
+
+    // "$+n" is a jump inside the same routine, that we are reading anyway.
+    if ( **_target == '$' && ( (*_target)[1] == '+' || (*_target)[1] == '-' || !(*_target)[1] ) ) {
+        return CLF_NONE;
+    }
+
+    if ( strcasecmp( _mnemonic, "CALL" ) == 0 ) {
+        return CLF_CALL;
+    }
+
+    if ( strcasecmp( _mnemonic, "JP" ) == 0 || strcasecmp( _mnemonic, "JR" ) == 0 ) {
+        if ( *_operand == '(' ) {
+            return CLF_UNKNOWN;
+        }
+        return comma ? CLF_BRANCH : CLF_JUMP;
+    }
+
+    if ( strcasecmp( _mnemonic, "DJNZ" ) == 0 ) {
+        return CLF_BRANCH;
+    }
+
+    return CLF_NONE;
+
+}
+
+#define Z80_TRACKED_A           0
+#define Z80_TRACKED_HL          1
+
+/* Split a line of generated code into mnemonic and operands (without spaces). */
+static void z80_register_track_split( char * _line, char * _mnemonic, char * _destination, char * _source ) {
+
+    char * p = _line;
+
+    while( *p == ' ' || *p == '\t' ) {
+        ++p;
+    }
+    while( *p && *p != ' ' && *p != '\t' && *p != ';' ) {
+        *_mnemonic++ = toupper( *p++ );
+    }
+    *_mnemonic = 0;
+    while( *p && *p != ';' && *p != ',' && *p != '\r' && *p != '\n' ) {
+        if ( *p != ' ' && *p != '\t' ) {
+            *_destination++ = *p;
+        }
+        ++p;
+    }
+    *_destination = 0;
+    if ( *p == ',' ) {
+        ++p;
+    }
+    while( *p && *p != ';' && *p != '\r' && *p != '\n' ) {
+        if ( *p != ' ' && *p != '\t' ) {
+            *_source++ = *p;
+        }
+        ++p;
+    }
+    *_source = 0;
+
+}
+
+/*
+ * Normalize an operand into _key. Returns 1 if the operand is an immediate,
+ * 2 if it is a variable in memory that can be tracked (i.e. "(_x)") and 0
+ * otherwise (a register, an indirect access, a symbol that is not a 
+ * variable, ...). Variables at an absolute address are never tracked, 
+ * since they could be a register of some chip.
+ */
+static int z80_register_track_operand( Environment * _environment, char * _operand, char * _key ) {
+
+    char name[MAX_TRACKED_OPERAND];
+    char * p = _operand;
+    int offset = 0;
+
+    if ( strlen( _operand ) >= ( MAX_TRACKED_OPERAND - 1 ) || !*p ) {
+        return 0;
+    }
+
+    if ( *p != '(' ) {
+        static char * registers[] = { "A", "B", "C", "D", "E", "H", "L", "I", "R", "AF", "BC", "DE", "HL", "SP", "IX", "IY", "IXH", "IXL", "IYH", "IYL", NULL };
+        int i;
+        for( i=0; registers[i]; ++i ) {
+            if ( strcasecmp( _operand, registers[i] ) == 0 ) {
+                return 0;
+            }
+        }
+        sprintf( _key, "#%s", _operand );
+        return 1;
+    }
+
+    ++p;
+    if ( *p != '_' && !isalpha( *p ) ) {
+        return 0;
+    }
+
+    char * q = p;
+    while( *q == '_' || isalnum( *q ) ) {
+        ++q;
+    }
+    memcpy( name, p, q - p );
+    name[q - p] = 0;
+
+    if ( *q == '+' && strspn( q+1, "0123456789" ) > 0 ) {
+        offset = atoi( q+1 );
+        q += strspn( q+1, "0123456789" ) + 1;
+    }
+    if ( *q != ')' || q[1] ) {
+        return 0;
+    }
+
+    Variable * variable = variable_retrieve_by_realname( _environment, name );
+
+    if ( !variable || variable->absoluteAddress ) {
+        return 0;
+    }
+
+    if ( offset ) {
+        sprintf( _key, "%s+%d", name, offset );
+    } else {
+        strcpy( _key, name );
+    }
+
+    return 2;
+
+}
+
+/* Forget the tracked register(s) that overlap the given register operand. */
+static void z80_register_track_clobber( RegisterTracker * _tracker, char * _register ) {
+
+    if ( strcmp( _register, "A" ) == 0 || strcmp( _register, "AF" ) == 0 ) {
+        _tracker->content[Z80_TRACKED_A][0] = 0;
+        _tracker->alias[Z80_TRACKED_A][0] = 0;
+    } else if ( strcmp( _register, "H" ) == 0 || strcmp( _register, "L" ) == 0 || strcmp( _register, "HL" ) == 0 ) {
+        _tracker->content[Z80_TRACKED_HL][0] = 0;
+        _tracker->alias[Z80_TRACKED_HL][0] = 0;
+    }
+
+}
+
+/**
+ * @brief Track the content of A and HL on a line of generated code
+ * 
+ * This function updates what A and HL are known to hold after the given
+ * instruction. Anything that cannot be followed (calls, jumps, unknown 
+ * instructions) invalidates everything, and any store to memory forgets 
+ * every memory operand. Since <code>LD</code> does not change the flags 
+ * on the Z80, a load is redundant as soon as the register already holds 
+ * the same constant (or memory).
+ * 
+ * @param _environment Current calling environment
+ * @param _tracker Tracker to update
+ * @param _line Line of generated code (not a label)
+ * @param _start Offset of the line in the output
+ * @param _end Offset of the next line in the output
+ * @return 1 if the line is redundant, 0 otherwise
+ */
+int z80_register_track( Environment * _environment, RegisterTracker * _tracker, char * _line, int _start, int _end ) {
+
+    char mnemonic[MAX_TEMPORARY_STORAGE];
+    char destination[MAX_TEMPORARY_STORAGE];
+    char source[MAX_TEMPORARY_STORAGE];
+    char key[MAX_TRACKED_OPERAND];
+    int reg = -1;
+
+    if ( strchr( _line, '"' ) || strchr( _line, '\'' ) || strchr( _line, ':' ) ) {
+        register_tracker_reset( _tracker );
+        return 0;
+    }
+
+    z80_register_track_split( _line, mnemonic, destination, source );
+
+    // Registers are compared in upper case, memory operands as they are.
+    char target[MAX_TEMPORARY_STORAGE];
+    char * t = target;
+    char * d = destination;
+    while( *d ) {
+        *t++ = toupper( *d++ );
+    }
+    *t = 0;
+
+    if ( strcmp( target, "A" ) == 0 ) {
+        reg = Z80_TRACKED_A;
+    } else if ( strcmp( target, "HL" ) == 0 ) {
+        reg = Z80_TRACKED_HL;
+    }
+
+    if ( strcmp( mnemonic, "LD" ) == 0 ) {
+        if ( destination[0] == '(' ) {
+            // Store: 16 bit stores and indirect stores change more than one
+            // memory operand, so every one of them is forgotten.
+            register_tracker_forget( _tracker, NULL );
+            if ( strcmp( source, "A" ) == 0 || strcmp( source, "HL" ) == 0 ) {
+                reg = ( strcmp( source, "A" ) == 0 ) ? Z80_TRACKED_A : Z80_TRACKED_HL;
+                if ( z80_register_track_operand( _environment, destination, key ) == 2 && strcmp( _tracker->content[reg], key ) != 0 ) {
+                    strcpy( _tracker->alias[reg], key );
+                }
+            }
+        } else if ( reg >= 0 ) {
+            int kind = z80_register_track_operand( _environment, source, key );
+            if ( kind && ( strcmp( _tracker->content[reg], key ) == 0 || strcmp( _tracker->alias[reg], key ) == 0 ) ) {
+                return 1;
+            }
+            if ( kind ) {
+                strcpy( _tracker->content[reg], key );
+            } else {
+                _tracker->content[reg][0] = 0;
+            }
+            _tracker->alias[reg][0] = 0;
+        } else {
+            z80_register_track_clobber( _tracker, target );
+        }
+    } else if ( strcmp( mnemonic, "ADD" ) == 0 || strcmp( mnemonic, "ADC" ) == 0 || strcmp( mnemonic, "SUB" ) == 0 ||
+            strcmp( mnemonic, "SBC" ) == 0 || strcmp( mnemonic, "AND" ) == 0 || strcmp( mnemonic, "OR" ) == 0 ||
+            strcmp( mnemonic, "XOR" ) == 0 ) {
+        // The short forms ("SUB n", "AND n", ...) have A as destination.
+        if ( !*source ) {
+            z80_register_track_clobber( _tracker, "A" );
+        } else {
+            z80_register_track_clobber( _tracker, target );
+        }
+    } else if ( strcmp( mnemonic, "INC" ) == 0 || strcmp( mnemonic, "DEC" ) == 0 ) {
+        if ( destination[0] == '(' ) {
+            register_tracker_forget( _tracker, NULL );
+        } else {
+            z80_register_track_clobber( _tracker, target );
+        }
+    } else if ( strcmp( mnemonic, "POP" ) == 0 ) {
+        z80_register_track_clobber( _tracker, target );
+    } else if ( strcmp( mnemonic, "EX" ) == 0 || strcmp( mnemonic, "EXX" ) == 0 ) {
+        // "EX AF, AF'" has a quote, so it never gets here.
+        z80_register_track_clobber( _tracker, "HL" );
+    } else if ( strcmp( mnemonic, "NEG" ) == 0 || strcmp( mnemonic, "CPL" ) == 0 || strcmp( mnemonic, "DAA" ) == 0 ||
+            strcmp( mnemonic, "RLA" ) == 0 || strcmp( mnemonic, "RRA" ) == 0 || strcmp( mnemonic, "RLCA" ) == 0 ||
+            strcmp( mnemonic, "RRCA" ) == 0 ) {
+        z80_register_track_clobber( _tracker, "A" );
+    } else if ( strcmp( mnemonic, "CP" ) == 0 || strcmp( mnemonic, "PUSH" ) == 0 || strcmp( mnemonic, "SCF" ) == 0 ||
+            strcmp( mnemonic, "CCF" ) == 0 || strcmp( mnemonic, "NOP" ) == 0 || strcmp( mnemonic, "DI" ) == 0 ||
+            strcmp( mnemonic, "EI" ) == 0 ) {
+        // Nothing changes.
+    } else if ( ( strcmp( mnemonic, "JR" ) == 0 || strcmp( mnemonic, "JP" ) == 0 ) && *source ) {
+        // A conditional jump keeps everything on the way that goes on, while 
+        // the other way ends on a label. But "$+n" lands on a line without
+        // label: the lines up to it (at most one per byte) are not tracked.
+        if ( *source == '$' ) {
+            register_tracker_reset( _tracker );
+            if ( source[1] == '+' ) {
+                _tracker->blind = atoi( source + 2 );
+            }
+            return 0;
+        }
+    } else {
+        // CALL, JP, JR, DJNZ, RET, RST, block instructions and anything else.
+        // Note that "$-n" loops land on lines already tracked: the ones
+        // generated today only loop over shifts and counters, never loads.
+        register_tracker_reset( _tracker );
+        return 0;
+    }
+
+    _tracker->previousStart = _tracker->lastStart;
+    _tracker->previousEnd = _tracker->lastEnd;
+    _tracker->lastStart = _start;
+    _tracker->lastEnd = _end;
+
+    return 0;
+
+}
+
+/**
+ * @brief Emit the context save (or restore) of the timer manager
+ * 
+ * @param _environment Current calling environment
+ * @param _clobbers Registers to save (see z80_code_line())
+ * @param _save 1 to emit the save, 0 to emit the restore
+ */
+void z80_timer_context( Environment * _environment, int _clobbers, int _save ) {
+
+    if ( _save ) {
+        if ( _clobbers & Z80_TIMER_CONTEXT_IX ) {
+            outline0("PUSH IX" );
+        }
+        if ( _clobbers & Z80_TIMER_CONTEXT_IY ) {
+            outline0("PUSH IY" );
+        }
+        if ( _clobbers & Z80_TIMER_CONTEXT_SHADOW ) {
+            outline0("EX AF, AF'" );
+            outline0("PUSH AF" );
+            outline0("EXX" );
+            outline0("PUSH BC" );
+            outline0("PUSH DE" );
+            outline0("PUSH HL" );
+        }
+    } else {
+        if ( _clobbers & Z80_TIMER_CONTEXT_SHADOW ) {
+            outline0("POP HL" );
+            outline0("POP DE" );
+            outline0("POP BC" );
+            outline0("EXX" );
+            outline0("POP AF" );
+            outline0("EX AF, AF'" );
+        }
+        if ( _clobbers & Z80_TIMER_CONTEXT_IY ) {
+            outline0("POP IY" );
+        }
+        if ( _clobbers & Z80_TIMER_CONTEXT_IX ) {
+            outline0("POP IX" );
+        }
+    }
+
+}
+
 void z80_is_negative( Environment * _environment, char * _value, char * _result ) {
 
     MAKE_LABEL
@@ -254,6 +254,10 @@ void z80_protothread_save( Environment * _environment, char * _index, int _step
 void z80_protothread_restore( Environment * _environment, char * _index, char * _step );
 void z80_protothread_set_state( Environment * _environment, char * _index, int _state );
 void z80_protothread_get_state( Environment * _environment, char * _index, char * _state );
+void z80_protothread_sleep( Environment * _environment, char * _index, char * _ticks );
+CodeLineFlow z80_code_line( Environment * _environment, char * _mnemonic, char * _operand, int * _clobbers, char ** _target );
+void z80_timer_context( Environment * _environment, int _clobbers, int _save );
+int z80_register_track( Environment * _environment, RegisterTracker * _tracker, char * _line, int _start, int _end );
 void z80_protothread_current( Environment * _environment, char * _current );
 void z80_set_callback( Environment * _environment, char * _callback, char * _label );
 
@@ -516,6 +520,10 @@ void z80_float_single_tan( Environment * _environment, char * _value, char * _re
 #define cpu_protothread_restore( _environment, _index, _step ) z80_protothread_restore( _environment, _index, _step )
 #define cpu_protothread_set_state( _environment, _index, _state ) z80_protothread_set_state( _environment, _index, _state )
 #define cpu_protothread_get_state( _environment, _index, _state ) z80_protothread_get_state( _environment, _index, _state )
+#define cpu_protothread_sleep( _environment, _index, _ticks ) z80_protothread_sleep( _environment, _index, _ticks )
+#define cpu_code_line( _environment, _mnemonic, _operand, _clobbers, _target ) z80_code_line( _environment, _mnemonic, _operand, _clobbers, _target )
+#define cpu_timer_context( _environment, _clobbers, _save ) z80_timer_context( _environment, _clobbers, _save )
+#define cpu_register_track( _environment, _tracker, _line, _start, _end ) z80_register_track( _environment, _tracker, _line, _start, _end )
 #define cpu_protothread_current( _environment, _current ) z80_protothread_current( _environment, _current )
 
 #define cpu_msc1_uncompress_direct_direct( _environment, _input, _output ) z80_msc1_uncompress_direct_direct( _environment, _input, _output )
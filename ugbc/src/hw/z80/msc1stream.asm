@@ -0,0 +1,198 @@
+; /*****************************************************************************
+;  * ugBASIC - an isomorphic BASIC language compiler for retrocomputers        *
+;  *****************************************************************************
+;  * Copyright 2021-2024 Marco Spedaletti (asimov@mclink.it)
+;  *
+;  * Licensed under the Apache License, Version 2.0 (the "License");
+;  * you may not use this file except in compliance with the License.
+;  * You may obtain a copy of the License at
+;  *
+;  * http://www.apache.org/licenses/LICENSE-2.0
+;  *
+;  * Unless required by applicable law or agreed to in writing, software
+;  * distributed under the License is distributed on an "AS IS" BASIS,
+;  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+;  * See the License for the specific language governing permissions and
+;  * limitations under the License.
+;  *----------------------------------------------------------------------------
+;  * Concesso in licenza secondo i termini della Licenza Apache, versione 2.0
+;  * (la "Licenza"); è proibito usare questo file se non in conformità alla
+;  * Licenza. Una copia della Licenza è disponibile all'indirizzo:
+;  *
+;  * http://www.apache.org/licenses/LICENSE-2.0
+;  *
+;  * Se non richiesto dalla legislazione vigente o concordato per iscritto,
+;  * il software distribuito nei termini della Licenza è distribuito
+;  * "COSì COM'è", SENZA GARANZIE O CONDIZIONI DI ALCUN TIPO, esplicite o
+;  * implicite. Consultare la Licenza per il testo specifico che regola le
+;  * autorizzazioni e le limitazioni previste dalla medesima.
+;  ****************************************************************************/
+;* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+;*                                                                             *
+;*                         MSC1 DECOMPRESSOR (STREAMING)                       *
+;*                                                                             *
+;*                             by Marco Spedaletti                             *
+;*                                                                             *
+;* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+; This is a version of the MSC1 decompressor that can be fed one byte
+; at a time, as soon as the byte is read from the storage. The uncompressed
+; bytes are written at the address pointed by DE, so there is no need
+; to load the whole compressed block into memory. Since the repetitions of
+; MSC1 refer to the compressed stream (up to 1023 bytes back), the last
+; 1024 bytes of the compressed stream are kept into a ring buffer.
+
+MSC1STREAMSTATE:    DEFB 0
+MSC1STREAMDATA:     DEFB 0
+MSC1STREAMTOKEN:    DEFB 0
+MSC1STREAMCOUNT:    DEFB 0
+MSC1STREAMPOS:      DEFW 0
+MSC1STREAMQUAD:     DEFS 4
+MSC1STREAMRING:     DEFS 1024
+
+; Reset the decompressor, before feeding a new stream.
+MSC1STREAMINIT:
+    XOR A
+    LD (MSC1STREAMSTATE), A
+    LD (MSC1STREAMPOS), A
+    LD (MSC1STREAMPOS+1), A
+    RET
+
+; Feed the byte in A to the decompressor, that will write at DE (and 
+; move it forward). On exit, the carry is set if the end of the stream 
+; has been reached. HL and BC are preserved.
+MSC1STREAMBYTE:
+    PUSH HL
+    PUSH BC
+    LD (MSC1STREAMDATA), A
+
+    ; Keep the byte into the ring buffer, and move forward
+    ; (modulo 1024) the position into the ring buffer.
+    LD HL, (MSC1STREAMPOS)
+    LD BC, MSC1STREAMRING
+    ADD HL, BC
+    LD (HL), A
+    LD HL, (MSC1STREAMPOS)
+    INC HL
+    LD A, H
+    AND $03
+    LD H, A
+    LD (MSC1STREAMPOS), HL
+
+    ; Now the byte is interpreted on the basis of the
+    ; current state of the decompressor:
+    ;   0 = waiting for a token
+    ;   1 = copying literals
+    ;   2 = waiting for the offset of a repetition
+    ;   3 = end of stream
+    LD A, (MSC1STREAMSTATE)
+    CP 0
+    JR Z, MSC1STREAMTOKENBYTE
+    CP 1
+    JR Z, MSC1STREAMLITERALBYTE
+    CP 2
+    JP Z, MSC1STREAMOFFSETBYTE
+    SCF
+    JP MSC1STREAMBYTEDONE
+
+    ; A token of zero (0) means "end of block", while a token
+    ; with the upper bit clear introduces (1...127) literals.
+MSC1STREAMTOKENBYTE:
+    LD A, (MSC1STREAMDATA)
+    CP 0
+    JR NZ, MSC1STREAMTOKENBYTE2
+    LD A, 3
+    LD (MSC1STREAMSTATE), A
+    SCF
+    JP MSC1STREAMBYTEDONE
+MSC1STREAMTOKENBYTE2:
+    BIT 7, A
+    JR NZ, MSC1STREAMTOKENBYTEDUPES
+    LD (MSC1STREAMCOUNT), A
+    LD A, 1
+    LD (MSC1STREAMSTATE), A
+    JP MSC1STREAMBYTEOK
+MSC1STREAMTOKENBYTEDUPES:
+    LD (MSC1STREAMTOKEN), A
+    LD A, 2
+    LD (MSC1STREAMSTATE), A
+    JP MSC1STREAMBYTEOK
+
+    ; Literals are copied as they are.
+MSC1STREAMLITERALBYTE:
+    LD A, (MSC1STREAMDATA)
+    LD (DE), A
+    INC DE
+    LD A, (MSC1STREAMCOUNT)
+    DEC A
+    LD (MSC1STREAMCOUNT), A
+    JR NZ, MSC1STREAMBYTEOK
+    LD (MSC1STREAMSTATE), A
+    JR MSC1STREAMBYTEOK
+
+    ; The offset goes back from the current position of the
+    ; ring buffer, up to the 4 bytes to repeat.
+MSC1STREAMOFFSETBYTE:
+    LD A, (MSC1STREAMTOKEN)
+    AND $03
+    LD B, A
+    LD A, (MSC1STREAMDATA)
+    LD C, A
+    LD HL, (MSC1STREAMPOS)
+    OR A
+    SBC HL, BC
+    LD A, H
+    AND $03
+    LD H, A
+
+    ; Take the 4 bytes out of the ring buffer (they could
+    ; be across its end).
+    PUSH DE
+    LD DE, MSC1STREAMQUAD
+    LD B, 4
+MSC1STREAMOFFSETBYTEL1:
+    PUSH HL
+    PUSH BC
+    LD BC, MSC1STREAMRING
+    ADD HL, BC
+    LD A, (HL)
+    LD (DE), A
+    INC DE
+    POP BC
+    POP HL
+    INC HL
+    LD A, H
+    AND $03
+    LD H, A
+    DJNZ MSC1STREAMOFFSETBYTEL1
+    POP DE
+
+    ; Take out the number of repetitions. If repetitions
+    ; is zero then repetitions will be 32 times.
+    LD A, (MSC1STREAMTOKEN)
+    AND $7F
+    SRL A
+    SRL A
+    JR NZ, MSC1STREAMOFFSETBYTE2
+    LD A, 32
+MSC1STREAMOFFSETBYTE2:
+    LD (MSC1STREAMCOUNT), A
+
+    ; Copy the very same 4 bytes for the number of
+    ; repetitions given.
+MSC1STREAMOFFSETBYTEL3:
+    LD HL, MSC1STREAMQUAD
+    LD BC, 4
+    LDIR
+    LD A, (MSC1STREAMCOUNT)
+    DEC A
+    LD (MSC1STREAMCOUNT), A
+    JR NZ, MSC1STREAMOFFSETBYTEL3
+    LD (MSC1STREAMSTATE), A
+
+MSC1STREAMBYTEOK:
+    OR A
+MSC1STREAMBYTEDONE:
+    POP BC
+    POP HL
+    RET
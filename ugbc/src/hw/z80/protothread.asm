@@ -35,183 +35,337 @@
 ;*                                                                             *
 ;* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
 
+; Threads are kept in a compact ready list (PROTOTHREADRL) and in a sleep
+; queue (PROTOTHREADSQ) ordered by wake tick. A round only visits the ready
+; list, so empty, ended and sleeping slots cost nothing. An entry address
+; of zero (PROTOTHREADAD) marks an empty slot.
+
 PROTOTHREADVOID:
     RET
 
 PROTOTHREADINIT:
-    LD C, 0
-    LD HL, PROTOTHREADLOOP
-    LD A, (PROTOTHREADCOUNT)
+    XOR A
+    LD (PROTOTHREADRC), A
+    LD (PROTOTHREADSC), A
+    RET
+
+; PROTOTHREADLOOP: one scheduling round
+PROTOTHREADLOOP:
+    CALL PROTOTHREADWAKE
+    XOR A
+    LD (PROTOTHREADRI), A
+    LD (PROTOTHREADWI), A
+PROTOTHREADLOOPL1:
+    LD A, (PROTOTHREADRC)
     LD B, A
-PROTOTHREADINITL1:
-    LD A, $3E
-    LD (HL), A
-    INC HL
-    LD A, C
-    LD (HL), A
-    INC HL
-    LD A, $32
-    LD (HL), A
-    INC HL
-    LD DE, PROTOTHREADCT
-    LD A, E
-    LD (HL), A
-    INC HL
-    LD A, D
-    LD (HL), A
-    INC HL
-    LD A, $CD
+    LD A, (PROTOTHREADRI)
+    CP B
+    JP NC, PROTOTHREADLOOPDONE
+    LD E, A
+    INC A
+    LD (PROTOTHREADRI), A
+    LD D, 0
+    LD HL, PROTOTHREADRL
+    ADD HL, DE
+    LD A, (HL)
+    LD (PROTOTHREADCT), A
+    CALL PROTOTHREADENTRY
+    JR Z, PROTOTHREADLOOPDROP
+    CALL PROTOTHREADCALL
+    LD A, (PROTOTHREADCT)
+    CALL PROTOTHREADENTRY
+    JR Z, PROTOTHREADLOOPDROP
+    LD A, (PROTOTHREADCT)
+    LD E, A
+    LD D, 0
+    LD HL, PROTOTHREADST
+    ADD HL, DE
+    LD A, (HL)
+    CP 3
+    JR NC, PROTOTHREADLOOPDROP
+    LD A, (PROTOTHREADWI)
+    LD E, A
+    INC A
+    LD (PROTOTHREADWI), A
+    LD HL, PROTOTHREADRL
+    ADD HL, DE
+    LD A, (PROTOTHREADCT)
     LD (HL), A
+    JP PROTOTHREADLOOPL1
+PROTOTHREADLOOPDROP:
+    LD A, (PROTOTHREADCT)
+    LD E, A
+    LD D, 0
+    LD HL, PROTOTHREADRQ
+    ADD HL, DE
+    LD (HL), 0
+    JP PROTOTHREADLOOPL1
+PROTOTHREADLOOPDONE:
+    LD A, (PROTOTHREADWI)
+    LD (PROTOTHREADRC), A
+    RET
+
+PROTOTHREADCALL:
+    JP (HL)
+
+; PROTOTHREADENTRY(A)->HL, Z if the slot is empty
+PROTOTHREADENTRY:
+    LD HL, PROTOTHREADAD
+    LD E, A
+    LD D, 0
+    ADD HL, DE
+    ADD HL, DE
+    LD E, (HL)
     INC HL
-    LD DE, PROTOTHREADVOID
-    LD A, E
-    LD (HL), A
+    LD D, (HL)
+    EX DE, HL
+    LD A, H
+    OR L
+    RET
+
+; PROTOTHREADWAKE: move every due sleeper back on the ready list
+PROTOTHREADWAKE:
+    LD A, (PROTOTHREADSC)
+    OR A
+    RET Z
+    LD A, (PROTOTHREADSQ)
+    LD B, A
+    LD E, A
+    LD D, 0
+    LD HL, PROTOTHREADWK
+    ADD HL, DE
+    ADD HL, DE
+    LD E, (HL)
     INC HL
-    LD A, D
-    LD (HL), A
+    LD D, (HL)
+    LD HL, (PROTOTHREADNOW)
+    AND A
+    SBC HL, DE
+    RET M
+    LD HL, PROTOTHREADSQ
+    LD A, (PROTOTHREADSC)
+    DEC A
+    LD (PROTOTHREADSC), A
+    JR Z, PROTOTHREADWAKEL2
+    LD C, A
+PROTOTHREADWAKEL1:
     INC HL
-PROTOTHREADINITL2:
-    INC C
-    LD A, C
-    CP B
-    JR NZ, PROTOTHREADINITL1
-    LD A, $C9
+    LD A, (HL)
+    DEC HL
     LD (HL), A
     INC HL
-    RET
+    DEC C
+    JR NZ, PROTOTHREADWAKEL1
+PROTOTHREADWAKEL2:
+    LD HL, PROTOTHREADST
+    LD E, B
+    LD D, 0
+    ADD HL, DE
+    LD A, (HL)
+    CP 5
+    JR NZ, PROTOTHREADWAKE
+    XOR A
+    CALL PROTOTHREADSETSTATE
+    JR PROTOTHREADWAKE
 
 ; PROTOTHREADREGAT(B,HL)
 PROTOTHREADREGAT:
     PUSH HL
-    LD HL, PROTOTHREADLOOP
-    LD A, B
-    SRL A
-    SRL A
-    SRL A
-    ADD 7
+    LD HL, PROTOTHREADAD
+    LD E, B
     LD D, 0
-    LD E, A
-    AND A
+    ADD HL, DE
     ADD HL, DE
     POP DE
-    LD A, E
-    LD (HL), A
+    LD (HL), E
     INC HL
-    LD A, D
-    LD (HL), A
+    LD (HL), D
     RET
 
 ; PROTOTHREADREG(HL)->B
 PROTOTHREADREG:
+    PUSH HL
+    LD HL, PROTOTHREADAD
     LD A, (PROTOTHREADCOUNT)
-    LD B, A
-    LD A, 0
     LD C, A
-    PUSH HL
-    LD HL, PROTOTHREADLOOP
-    LD D, 0
-    LD E, 6
-    ADD HL, DE
+    LD B, 0
 PROTOTHREADREGL1:
-    LD DE, PROTOTHREADVOID
     LD A, (HL)
-    CP E
-    JR NZ, PROTOTHREADREGL2A
     INC HL
-    LD A, (HL)
-    CP D
-    JR NZ, PROTOTHREADREGL2
-    POP DE
-    DEC HL
-    LD (HL), E
+    OR (HL)
+    JR Z, PROTOTHREADREGL2
     INC HL
-    LD (HL), D
-    LD B, C
-    RET
-PROTOTHREADREGL2A:
-    LD D, 0
-    LD E, 1
-    ADD HL, DE
-PROTOTHREADREGL2:
-    LD D, 0
-    LD E, 7
-    ADD HL, DE
-    INC C
-    LD A, C
-    CP B
+    INC B
+    LD A, B
+    CP C
     JR NZ, PROTOTHREADREGL1
     LD B, $ff
     POP DE
     RET
+PROTOTHREADREGL2:
+    POP DE
+    LD (HL), D
+    DEC HL
+    LD (HL), E
+    RET
 
 ; PROTOTHREADUNREG(B)
 PROTOTHREADUNREG:
-    LD HL, PROTOTHREADLOOP
-    LD A, B
-    SLA A
-    SLA A
-    SLA A
-    ADD 6
+    LD HL, PROTOTHREADAD
+    LD E, B
     LD D, 0
-    LD E, A
-    AND A
     ADD HL, DE
-    LD DE, PROTOTHREADVOID
-    LD A, E
+    ADD HL, DE
+    XOR A
     LD (HL), A
     INC HL
-    LD A, D
     LD (HL), A
+    LD HL, PROTOTHREADST
+    ADD HL, DE
+    LD A, (HL)
+    CP 5
+    RET NZ
+    LD HL, PROTOTHREADSQ
+    LD A, (PROTOTHREADSC)
+    LD C, A
+PROTOTHREADUNREGL1:
+    LD A, C
+    OR A
+    RET Z
+    DEC C
+    LD A, (HL)
+    INC HL
+    CP B
+    JR NZ, PROTOTHREADUNREGL1
+PROTOTHREADUNREGL2:
+    LD A, C
+    OR A
+    JR Z, PROTOTHREADUNREGL3
+    LD A, (HL)
+    DEC HL
+    LD (HL), A
+    INC HL
+    INC HL
+    DEC C
+    JR PROTOTHREADUNREGL2
+PROTOTHREADUNREGL3:
+    LD HL, PROTOTHREADSC
+    DEC (HL)
     RET
 
 ; PROTOTHREADSAVE(B,A)
 PROTOTHREADSAVE:
-    PUSH AF
     LD HL, PROTOTHREADLC
-    LD A, B
+    LD E, B
     LD D, 0
-    LD E, A
-    AND A
     ADD HL, DE
-    POP AF
     LD (HL), A
     RET
 
 ; PROTOTHREADRESTORE(B)->A
 PROTOTHREADRESTORE:
-    PUSH AF
     LD HL, PROTOTHREADLC
-    LD A, B
+    LD E, B
     LD D, 0
-    LD E, A
-    AND A
     ADD HL, DE
-    POP AF
     LD A, (HL)
     RET
 
 ; PROTOTHREADSETSTATE(B,A)
 PROTOTHREADSETSTATE:
-    PUSH AF
     LD HL, PROTOTHREADST
-    LD A, B
+    LD E, B
     LD D, 0
-    LD E, A
-    AND A
     ADD HL, DE
-    POP AF
     LD (HL), A
+    CP 3
+    RET NC
+    LD HL, PROTOTHREADRQ
+    ADD HL, DE
+    LD A, (HL)
+    OR A
+    RET NZ
+    LD (HL), 1
+    LD A, (PROTOTHREADRC)
+    LD E, A
+    INC A
+    LD (PROTOTHREADRC), A
+    LD HL, PROTOTHREADRL
+    ADD HL, DE
+    LD (HL), B
     RET
 
 ; PROTOTHREADGETSTATE(B)->A
 PROTOTHREADGETSTATE:
-    PUSH AF
     LD HL, PROTOTHREADST
-    LD A, B
+    LD E, B
     LD D, 0
-    LD E, A
+    ADD HL, DE
+    LD A, (HL)
+    RET
+
+; PROTOTHREADSLEEP(B,HL)
+PROTOTHREADSLEEP:
+    LD DE, (PROTOTHREADNOW)
+    ADD HL, DE
+    PUSH HL
+    LD HL, PROTOTHREADST
+    LD E, B
+    LD D, 0
+    ADD HL, DE
+    LD (HL), 5
+    LD HL, PROTOTHREADWK
+    ADD HL, DE
+    ADD HL, DE
+    POP DE
+    LD (HL), E
+    INC HL
+    LD (HL), D
+    LD C, 0
+PROTOTHREADSLEEPL1:
+    LD A, (PROTOTHREADSC)
+    CP C
+    JR Z, PROTOTHREADSLEEPINS
+    PUSH DE
+    LD HL, PROTOTHREADSQ
+    LD E, C
+    LD D, 0
+    ADD HL, DE
+    LD E, (HL)
+    LD HL, PROTOTHREADWK
+    ADD HL, DE
+    ADD HL, DE
+    LD A, (HL)
+    INC HL
+    LD H, (HL)
+    LD L, A
+    POP DE
     AND A
+    SBC HL, DE
+    JP M, PROTOTHREADSLEEPN
+    JR NZ, PROTOTHREADSLEEPINS
+PROTOTHREADSLEEPN:
+    INC C
+    JR PROTOTHREADSLEEPL1
+PROTOTHREADSLEEPINS:
+    LD A, (PROTOTHREADSC)
+    LD E, A
+    LD D, 0
+    LD HL, PROTOTHREADSQ
     ADD HL, DE
-    POP AF
+PROTOTHREADSLEEPL2:
+    LD A, E
+    CP C
+    JR Z, PROTOTHREADSLEEPL3
+    DEC HL
     LD A, (HL)
+    INC HL
+    LD (HL), A
+    DEC HL
+    DEC E
+    JR PROTOTHREADSLEEPL2
+PROTOTHREADSLEEPL3:
+    LD (HL), B
+    LD HL, PROTOTHREADSC
+    INC (HL)
     RET
@@ -48,9 +48,16 @@ TIMERMANAGER:
 
 TIMERMANAGERGO:
 
+    ; Save the registers -- some routines inside the called timers
+    ; could change them and invalidate main program execution.
+    ; At the end of compilation, the block between TIMERCONTEXTSAVE
+    ; and TIMERCONTEXTSAVEEND (and the twin block for restore) is
+    ; replaced by one that saves only what the EVERY handlers can
+    ; actually change (see every_context_cleanup()).
 	PUSH	BC
 	PUSH	DE
 	PUSH	HL
+TIMERCONTEXTSAVE:
 	PUSH	IX
 	PUSH	IY
 	EX	AF,AF'
@@ -59,168 +66,101 @@ TIMERMANAGERGO:
 	PUSH	BC
 	PUSH	DE
 	PUSH	HL
+TIMERCONTEXTSAVEEND:
 
     LD A, 1
     LD (TIMERRUNNING), A
 
-    ; loop through every specific timer status
-    ; looking to the specific bit in the TIMERSTATUS
-    ; control word.
-    LD A, (TIMERSTATUS)
+    ; If EVERY ON / OFF changed the TIMERSTATUS control word, the
+    ; list of active timers must be rebuilt. Since this happens here,
+    ; a change made by a handler takes effect from the next tick.
+    LD A, (TIMERACTIVEDIRTY)
+    CP 0
+    CALL NZ, TIMERMANAGERBUILD
 
-    ; Up to 8 timers.
-    LD B, 0
-    PUSH AF
+    ; Loop through the active timers only. Each entry of the list
+    ; is the offset (timer * 2) inside the TIMERCOUNTER, TIMERINIT
+    ; and TIMERADDRESS tables.
+    LD C, 0
 
 TIMERMANAGERL1:
-    POP AF
-
-    ; Move the first bit into the carry.
-    SRA A
-
-    ; If the carry is cleared, move to the next timer. 
-    JR NC, TIMERMANAGERL2
-
-    PUSH AF
-    PUSH DE
-    PUSH HL
-    PUSH BC
-
-    ; Retrieve the actual time counter, using the current
-    ; index (X-1). The Y will be the offset starting from
-    ; the TIMERCOUNTER base address: 
-    ;
-    ;       TIMERCOUNTER + (X-1) * 2 -> Y = (X-1) * 2
-    ;
-    LD A, B
-    SLA A
-    LD E, A
-    LD A, 0
-    LD D, A 
+    LD A, (TIMERACTIVECOUNT)
+    CP C
+    JR Z, TIMERMANAGERDONE
 
-    LD HL, TIMERCOUNTER 
+    LD HL, TIMERACTIVE
+    LD E, C
+    LD D, 0
     ADD HL, DE
+    LD E, (HL)
 
     ; Now we are going to check if the timer is not zero.
     ; If not zero, we must decrement the counter.
-    INC HL
-    LD A, (HL)
-    CP 0
-    JR NZ, TIMERMANAGERL2AH
-    DEC HL
+    LD HL, TIMERCOUNTER
+    ADD HL, DE
     LD A, (HL)
-    CP 0
-    JR NZ, TIMERMANAGERL2AL
+    INC HL
+    OR (HL)
+    JR NZ, TIMERMANAGERDEC
 
     ; Ok the counter is zero. So we must reset to the
     ; value we received previously, and call the routine.
-
     LD HL, TIMERINIT
     ADD HL, DE
     LD A, (HL)
-    LD IXL, A
     INC HL
-    LD A, (HL)
-    LD IXH, A
-
-    LD HL, TIMERCOUNTER 
+    LD B, (HL)
+    LD HL, TIMERCOUNTER
     ADD HL, DE
-    LD A, IXL
     LD (HL), A
     INC HL
-    LD A, IXH
-    LD (HL), A
-
-TIMERMANAGERJMP2:
-    LD HL, TIMERADDRESS
-    ADD HL, DE
+    LD (HL), B
 
     ; Now we are going to check if the address
     ; to call is zero. In this case, we must
     ; avoid to jump to it.
-    INC HL
-    LD A, (HL)
-    CP 0
-    JR NZ, TIMERMANAGERJMP2AH
-    DEC HL
-    LD A, (HL)
-    CP 0
-    JR NZ, TIMERMANAGERJMP2AL
-
-    JP TIMERMANAGERL2AL
-
-TIMERMANAGERJMP:
-    JP (HL)
-
-TIMERMANAGERJMP2AH:
-TIMERMANAGERJMP2AL:
     LD HL, TIMERADDRESS
     ADD HL, DE
     LD A, (HL)
-    LD IXL, A
     INC HL
-    LD A, (HL)
-    LD IXH, A
-
-    PUSH AF
-    PUSH HL
-    PUSH DE
-    
-    LD A, IXL
+    LD H, (HL)
     LD L, A
-    LD A, IXH
-    LD H, A
+    OR H
+    JR Z, TIMERMANAGERDEC
 
+    PUSH BC
+    PUSH DE
     CALL TIMERMANAGERJMP
-
     POP DE
-    POP HL
-    POP AF
+    POP BC
 
-    ; If we reach this line, we are going to decrement the
-    ; counter since it is not zero.
-TIMERMANAGERL2AH:
-    ; Move to the LSB
-TIMERMANAGERL2AL:
     ; 16 bit decrement
-    LD HL, TIMERCOUNTER 
+TIMERMANAGERDEC:
+    LD HL, TIMERCOUNTER
     ADD HL, DE
-    PUSH DE
-    LD A, (HL)
-    LD E, A
+    LD E, (HL)
     INC HL
-    LD A, (HL)
-    LD D, A
-    DEC HL
+    LD D, (HL)
     DEC DE
-    LD A, E
-    LD (HL), A
-    INC HL
-    LD A, D
-    LD (HL), A
-    POP DE
-TIMERMANAGERL2ALD:
-
-    POP BC
-    POP HL
-    POP DE
-    POP AF
+    LD (HL), D
+    DEC HL
+    LD (HL), E
 
     ; If we reach this line, we are going to check the next timer.
-TIMERMANAGERL2:
+    INC C
+    JP TIMERMANAGERL1
+
+TIMERMANAGERJMP:
+    JP (HL)
+
+TIMERMANAGERDONE:
 
-    INC B
-    PUSH AF
-    LD A, B
-    CP 8
-    JR NZ, TIMERMANAGERL1
-    POP AF
-    
     ; Finally, restore the actual state of registers
 
     LD A, 0
     LD (TIMERRUNNING), A
-    
+
+TIMERCONTEXTRESTORE:
 	POP	HL
 	POP	DE
 	POP	BC
@@ -229,6 +169,7 @@ TIMERMANAGERL2:
 	EX	AF,AF'
 	POP	IY
 	POP	IX
+TIMERCONTEXTRESTOREEND:
 	POP	HL
 	POP	DE
 	POP	BC
@@ -236,6 +177,31 @@ TIMERMANAGERL2:
 
     RET
 
+; TIMERMANAGERBUILD: rebuild the list of active timers from TIMERSTATUS
+TIMERMANAGERBUILD:
+    XOR A
+    LD (TIMERACTIVEDIRTY), A
+    LD HL, TIMERACTIVE
+    LD A, (TIMERSTATUS)
+    LD D, A
+    LD B, 0
+    LD C, 0
+TIMERMANAGERBUILDL1:
+    SRL D
+    JR NC, TIMERMANAGERBUILDL2
+    LD (HL), B
+    INC HL
+    INC C
+TIMERMANAGERBUILDL2:
+    INC B
+    INC B
+    LD A, B
+    CP 16
+    JR NZ, TIMERMANAGERBUILDL1
+    LD A, C
+    LD (TIMERACTIVECOUNT), A
+    RET
+
 ; TIMERSETSTATUS(B,C)
 TIMERSETSTATUS:
     LD A, B
@@ -257,7 +223,7 @@ TIMERSETSTATUS1:
     POP AF
     OR B
     LD (TIMERSTATUS), A
-    RET
+    JR TIMERSETSTATUSDIRTY
 TIMERSETSTATUS0:
     LD A, (TIMERSTATUS)
     LD B, A
@@ -265,6 +231,9 @@ TIMERSETSTATUS0:
     XOR $FF
     AND B
     LD (TIMERSTATUS), A
+TIMERSETSTATUSDIRTY:
+    LD A, 1
+    LD (TIMERACTIVEDIRTY), A
     RET
 
 ; TIMERSETCOUNTER(B,IX)
@@ -267,7 +267,7 @@ static int rgbConverterFunction( int _red, int _green, int _blue ) {
     rgb.blue = _blue;
 
     for (j = 0; j < sizeof(SYSTEM_PALETTE)/sizeof(RGBi); ++j) {
-        int distance = rgbi_distance(&SYSTEM_PALETTE[j], &rgb);
+        int distance = rgbi_distance_squared(&SYSTEM_PALETTE[j], &rgb);
         if (distance < minDistance) {
             minDistance = distance;
             colorIndex = j;
@@ -538,9 +538,9 @@ static Variable * zx_image_converter_bitmap_mode_standard( Environment * _enviro
 
                         colorIndex = 0;
 
-                        int minDistance = 9999;
+                        int minDistance = 0x7fffffff;
                         for( int i=0; i<paletteColorCount; ++i ) {
-                            int distance = rgbi_distance(&commonPalette[i], &rgb );
+                            int distance = rgbi_distance_squared(&commonPalette[i], &rgb );
                             if ( distance < minDistance ) {
                                 minDistance = distance;
                                 colorIndex = commonPalette[i].index;
@@ -608,9 +608,9 @@ static Variable * zx_image_converter_bitmap_mode_standard( Environment * _enviro
 
                 colorIndex = 0;
 
-                int minDistance = 9999;
+                int minDistance = 0x7fffffff;
                 for( int i=0; i<paletteColorCount; ++i ) {
-                    int distance = rgbi_distance(&commonPalette[i], &rgb );
+                    int distance = rgbi_distance_squared(&commonPalette[i], &rgb );
                     if ( distance < minDistance ) {
                         minDistance = distance;
                         colorIndex = commonPalette[i].index;
@@ -377,10 +377,18 @@ static void d64_find_free_sector( D64Handle * _handle, D64Track * _track, D64Sec
         // A fast check if free sectors are available.
         if ( entry->freeSectors > 0 ) {
             // A detailed check to find out the correct sector
-            // must be executed.
-            int sector = 0;
-            for( int j=0; j<D64SectorsPerTrack[_handle->lastUsedTrack-1]; ++j ) {
-                // printf( " > sector = %d\n", j );
+            // must be executed. On the same track of the previous
+            // sector, we start from the sector that will be under
+            // the head when the previous one has been used (the
+            // interleave), and we go on with the next ones.
+            int sectors = D64SectorsPerTrack[_handle->lastUsedTrack-1];
+            int start = 0;
+            if ( _handle->previousTrack == _handle->lastUsedTrack ) {
+                start = ( _handle->previousSector + _handle->interleave ) % sectors;
+            }
+            for( int j=0; j<sectors; ++j ) {
+                int sector = ( start + j ) % sectors;
+                // printf( " > sector = %d\n", sector );
                 // Let's calculate the offset and the bitmap for the given sector.
                 int offset = sector >> 3;
                 int bitmap = 1 << ( sector & 0x07 ); 
@@ -390,10 +398,10 @@ static void d64_find_free_sector( D64Handle * _handle, D64Track * _track, D64Sec
                     // printf( "found %2.2x %2.2x\n", offset, bitmap );
                     *_track = _handle->lastUsedTrack;
                     *_sector = sector;
+                    _handle->previousTrack = *_track;
+                    _handle->previousSector = *_sector;
                     return;
                 }
-                sector += 10;
-                sector = sector % D64SectorsPerTrack[_handle->lastUsedTrack-1];
             }
         }
         
@@ -712,6 +720,21 @@ void d64_set_disk_id( D64Handle * _handle, D64DiskId _disk_id ) {
 
 }
 
+/**
+ * @brief Set the distance between two consecutive sectors of the files
+ * that will be written on the disk image. It should be chosen so that
+ * the next sector is under the head just when the loader is ready to
+ * read it.
+ * 
+ * @param _handle Handle of the disk image
+ * @param _interleave Interleave (in sectors)
+ */
+void d64_set_interleave( D64Handle * _handle, D64Sector _interleave ) {
+
+    _handle->interleave = _interleave;
+
+}
+
 /**
  * @brief Set the DOS Type for the given disk image
  * 
@@ -742,6 +765,7 @@ D64Handle * d64_create( D64Format _format ) {
 
     // Update and format the disk image
     handle->format = _format;
+    handle->interleave = D64_DEFAULT_INTERLEAVE;
     d64_format( handle );
 
     return handle;
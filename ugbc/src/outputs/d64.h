@@ -615,6 +615,13 @@ typedef struct _D64Handle {
     // 
     D64Track            lastUsedTrack;
 
+    // Distance (in sectors) between two consecutive sectors of a file
+    D64Sector           interleave;
+
+    // Last sector allocated for a file (0/0 if none)
+    D64Track            previousTrack;
+    D64Sector           previousSector;
+
 } D64Handle;
 
 #define         D64_BAM_TRACK               18
@@ -622,6 +629,13 @@ typedef struct _D64Handle {
 #define         D64_DIRECTORY_TRACK         18
 #define         D64_DIRECTORY_SECTOR         1
 
+// Interleave used by the standard KERNAL loader.
+#define         D64_DEFAULT_INTERLEAVE      10
+
+// Interleave used by the fast loader: a sector takes about five sector
+// times to be sent to the computer, plus the latency of the job queue.
+#define         D64_FASTLOAD_INTERLEAVE      8
+
 /****************************************************************************
  * FUNCTION DECLARATION
  ****************************************************************************/
@@ -631,6 +645,7 @@ void                d64_set_dos_version( D64Handle * _handle, D64DosVersion _ver
 void                d64_set_disk_name( D64Handle * _handle, unsigned char * _disk_name );
 void                d64_set_disk_id( D64Handle * _handle, D64DiskId _disk_id );
 void                d64_set_dos_type( D64Handle * _handle, unsigned char * _dos_type );
+void                d64_set_interleave( D64Handle * _handle, D64Sector _interleave );
 void                d64_write_file( D64Handle * _handle, unsigned char * _filename, D64FileType _type, unsigned char * _buffer, int _size );
 void                d64_output( D64Handle * _handle, unsigned char * _filename );
 void                d64_free( D64Handle * _handle );
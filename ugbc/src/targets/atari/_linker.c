@@ -62,6 +62,11 @@ void linker_setup( Environment * _environment ) {
     cfgline1("MAIN:     start = %%S,    size = $%4.4x, file = %%O;", size);
     cfgline0("TRAILER:	start = $0000, size = $0006, file = %O;");
 
+    // The video memory (and the virtual playfield, if SCREEN PLAYFIELD has
+    // been used) goes from the frame buffer up to $C000: it is reserved, so
+    // that the linker will complain if the program grows over it.
+    cfgline2("SCREEN:   file = \"\", start = $%4.4x, size = $%4.4x;", _environment->frameBufferStart, 0xc000 - _environment->frameBufferStart );
+
     MemoryArea * actual = _environment->memoryAreas;
     actual = _environment->memoryAreas;
     while( actual ) {
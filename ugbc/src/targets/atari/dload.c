@@ -93,6 +93,21 @@ void dload( Environment * _environment, char * _filename, char * _offset, char *
         CRITICAL_DLOAD_MISSING_ADDRESS( _filename );
     }
 
-    atari_dload( _environment, _filename, _offset, _address, _size );
+    // A compressed file on the storage is uncompressed while it is
+    // read, directly at the destination address.
+    FileStorage * fileStorage = file_storage_find( _environment, _filename );
+
+    if ( fileStorage && fileStorage->uncompressedSize ) {
+        if ( _offset ) {
+            WARNING_DLOAD_IGNORED_OFFSET( _filename );
+        }
+        if ( _size ) {
+            WARNING_DLOAD_IGNORED_SIZE( _filename );
+        }
+        file_storage_uncompressed( _environment, fileStorage );
+        atari_dstream( _environment, _filename, _address );
+    } else {
+        atari_dload( _environment, _filename, _offset, _address, _size );
+    }
 
 }
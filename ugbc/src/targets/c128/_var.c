@@ -67,6 +67,7 @@ static void variable_cleanup_entry( Environment * _environment, Variable * _firs
                     break;
                 case VT_WORD:
                 case VT_SWORD:
+                case VT_FIXED:
                 case VT_POSITION:
                 case VT_ADDRESS:
                     if ( variable->memoryArea && !variable->bankAssigned ) {
@@ -77,6 +78,7 @@ static void variable_cleanup_entry( Environment * _environment, Variable * _firs
                     break;
                 case VT_DWORD:
                 case VT_SDWORD:
+                case VT_DFIXED:
                     if ( variable->memoryArea && !variable->bankAssigned ) {
                         // outline2("%s = $%4.4x", variable->realName, variable->absoluteAddress);
                     } else {
@@ -225,12 +227,14 @@ static void variable_cleanup_memory_mapped( Environment * _environment, Variable
             break;
         case VT_WORD:
         case VT_SWORD:
+        case VT_FIXED:
         case VT_POSITION:
         case VT_ADDRESS:
             outline1(" .word $%2.2x", ( _variable->value & 0xffff ) );
             break;
         case VT_DWORD:
         case VT_SDWORD:
+        case VT_DFIXED:
             outline1(" .dword $%4.4x", ( _variable->value & 0xffff ) );
             break;
         case VT_FLOAT: {
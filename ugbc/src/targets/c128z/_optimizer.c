@@ -668,6 +668,8 @@ static int optim_pass( Environment * _environment, POBuffer buf[LOOK_AHEAD], Pee
         break;
     }
 
+    telemetry_begin_pass( _environment, peephole_pass, kind );
+
     fileAsm = fopen( _environment->asmFileName, "rt" );
     if(fileAsm == NULL) {
         perror(_environment->asmFileName);
@@ -771,6 +773,8 @@ static int optim_pass( Environment * _environment, POBuffer buf[LOOK_AHEAD], Pee
     remove(_environment->asmFileName);
     (void)rename( fileNameOptimized, _environment->asmFileName );
     
+    telemetry_end_pass( _environment );
+
     return change;
 }
 
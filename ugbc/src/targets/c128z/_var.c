@@ -62,6 +62,7 @@ static void variable_cleanup_entry( Environment * _environment, Variable * _firs
                     break;
                 case VT_WORD:
                 case VT_SWORD:
+                case VT_FIXED:
                 case VT_POSITION:
                 case VT_ADDRESS:
                     if ( variable->memoryArea ) {
@@ -79,6 +80,7 @@ static void variable_cleanup_entry( Environment * _environment, Variable * _firs
                     break;
                 case VT_DWORD:
                 case VT_SDWORD:
+                case VT_DFIXED:
                     if ( variable->memoryArea ) {
                         outline2("%s: EQU $%4.4x", variable->realName, variable->absoluteAddress);
                     } else {
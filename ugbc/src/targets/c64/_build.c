@@ -115,6 +115,9 @@ void generate_d64( Environment * _environment ) {
 
     if ( !storage ) {
         D64Handle * handle = d64_create( CBMDOS );
+        if ( _environment->dloadFast ) {
+            d64_set_interleave( handle, D64_FASTLOAD_INTERLEAVE );
+        }
         d64_write_file( handle, "MAIN", PRG, prgContent, prgSize );
         d64_output( handle, d64FileName );
         d64_free( handle );
@@ -122,6 +125,9 @@ void generate_d64( Environment * _environment ) {
         int i=0;
         while( storage ) {
             D64Handle * handle = d64_create( CBMDOS );
+            if ( _environment->dloadFast ) {
+                d64_set_interleave( handle, D64_FASTLOAD_INTERLEAVE );
+            }
             if ( i == 0 ) {
                 d64_write_file( handle, "MAIN", PRG, prgContent, prgSize );
             }
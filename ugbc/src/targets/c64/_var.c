@@ -67,6 +67,7 @@ static void variable_cleanup_entry( Environment * _environment, Variable * _firs
                     break;
                 case VT_WORD:
                 case VT_SWORD:
+                case VT_FIXED:
                 case VT_POSITION:
                 case VT_ADDRESS:
                     if ( variable->memoryArea && !variable->bankAssigned ) {
@@ -77,6 +78,7 @@ static void variable_cleanup_entry( Environment * _environment, Variable * _firs
                     break;
                 case VT_DWORD:
                 case VT_SDWORD:
+                case VT_DFIXED:
                     if ( variable->memoryArea && !variable->bankAssigned ) {
                         // outline2("%s = $%4.4x", variable->realName, variable->absoluteAddress);
                     } else {
@@ -225,12 +227,14 @@ static void variable_cleanup_memory_mapped( Environment * _environment, Variable
             break;
         case VT_WORD:
         case VT_SWORD:
+        case VT_FIXED:
         case VT_POSITION:
         case VT_ADDRESS:
             outline1(" .word $%2.2x", ( _variable->value & 0xffff ) );
             break;
         case VT_DWORD:
         case VT_SDWORD:
+        case VT_DFIXED:
             outline1(" .dword $%4.4x", ( _variable->value & 0xffff ) );
             break;
         case VT_FLOAT: {
@@ -318,6 +322,21 @@ static void variable_cleanup_memory_mapped( Environment * _environment, Variable
 
 }
 
+// Emit a variable placed in a memory area, preceded by the padding left
+// by the packer (alignment), and return the address that follows it.
+static int variable_cleanup_memory_area( Environment * _environment, Variable * _variable, int _cursor ) {
+
+    if ( _variable->absoluteAddress > _cursor ) {
+        outhead1(".res %d,0", _variable->absoluteAddress - _cursor );
+    }
+
+    variable_cleanup_memory_mapped( _environment, _variable );
+    _variable->staticalInit = ( _variable->memoryArea->type == MAT_RAM ? 0 : 1 );
+
+    return _variable->absoluteAddress + _variable->memoryAreaRequested;
+
+}
+
 static void variable_cleanup_entry_bit( Environment * _environment, Variable * _first ) {
 
     Variable * variable = _first;
@@ -520,14 +539,14 @@ void variable_cleanup( Environment * _environment ) {
             //     cfgline2("MA%3.3x:  load = MAIN, type = overwrite,  optional = yes, start = $%4.4x;", memoryArea->id, memoryArea->start);
             // }
             outhead1(".segment \"MA%3.3x\"", memoryArea->id );
+            int cursor = memoryArea->start;
             for( i=memoryArea->start; i<memoryArea->end; ++i ) {
                 Variable * variable = _environment->variables;
                 while( variable ) {
                     if ( 
                             ( !variable->assigned && variable->memoryArea == memoryArea && variable->absoluteAddress == i )
                      ) {
-                        variable_cleanup_memory_mapped( _environment, variable );
-                        variable->staticalInit = ( memoryArea->type == MAT_RAM ? 0 : 1 );
+                        cursor = variable_cleanup_memory_area( _environment, variable, cursor );
                         break;
                     }
                     variable = variable->next;
@@ -538,8 +557,7 @@ void variable_cleanup( Environment * _environment ) {
                         if ( 
                             ( !variable->assigned && variable->memoryArea == memoryArea && variable->absoluteAddress == i ) 
                             ){
-                            variable_cleanup_memory_mapped( _environment, variable );
-                            variable->staticalInit = ( memoryArea->type == MAT_RAM ? 0 : 1 );
+                            cursor = variable_cleanup_memory_area( _environment, variable, cursor );
                             break;
                         }
                         variable = variable->next;
@@ -550,8 +568,7 @@ void variable_cleanup( Environment * _environment ) {
                     if ( 
                         ( !variable->assigned && variable->memoryArea == memoryArea && variable->absoluteAddress == i ) 
                         ) {
-                        variable_cleanup_memory_mapped( _environment, variable );
-                        variable->staticalInit = ( memoryArea->type == MAT_RAM ? 0 : 1 );
+                        cursor = variable_cleanup_memory_area( _environment, variable, cursor );
                         break;
                     }
                     variable = variable->next;
@@ -79,6 +79,18 @@ void dload( Environment * _environment, char * _filename, char * _offset, char *
         WARNING_DLOAD_IGNORED_SIZE( _filename );
     }
 
-    c64_dload( _environment, _filename, _offset, _address, _size );
+    // A compressed file on the storage is uncompressed while it is
+    // read, directly at the destination address.
+    FileStorage * fileStorage = file_storage_find( _environment, _filename );
+
+    if ( fileStorage && fileStorage->uncompressedSize ) {
+        if ( ! _address ) {
+            CRITICAL_DLOAD_MISSING_ADDRESS( _filename );
+        }
+        file_storage_uncompressed( _environment, fileStorage );
+        c64_dstream( _environment, _filename, _address );
+    } else {
+        c64_dload( _environment, _filename, _offset, _address, _size );
+    }
 
 }
\ No newline at end of file
@@ -134,6 +134,8 @@ static int peephole_pass = 0;
 static int num_dp        = 0; /* number of variables relocated to direct-page */
 static int num_inlined   = 0; /* number of variables inlined */
 static int num_unread    = 0; /* number of variables not read */
+static int num_cycles    = 0; /* number of T-states saved */
+static int vars_complete = 0; /* all the lines have been scanned for variables */
 
 #ifdef __GNUC__
 static void optim(POBuffer buf, const char *rule, const char *repl, ...)
@@ -538,10 +540,29 @@ static void vars_scan(POBuffer buf[LOOK_AHEAD]) {
         v->nb_wr++;
     }
 
+    /* only "LD A, (x)" can be inlined, and only if x is always accessed as a byte */
+    if( po_buf_match( buf[0], " LD *, (*)",  tmp, arg ) && vars_ok(arg) ) {
+        struct var *v = vars_get(arg);
+        if( strcmp(tmp->str, "A") || strchr(arg->str, '+') ) {
+            v->flags |= NO_INLINE;
+        } else if( v->offset == 0 ) {
+            v->offset = -1;
+        }
+    } else if( po_buf_match( buf[0], " LD (*), *",  arg, tmp ) && vars_ok(arg) ) {
+        if( strcmp(tmp->str, "A") || strchr(arg->str, '+') ) vars_get(arg)->flags |= NO_INLINE;
+    } else if( po_buf_match( buf[0], " LD *, *",  tmp, arg ) && vars_ok(arg) ) {
+        vars_get(arg)->flags |= NO_INLINE;
+    }
+
+    if( po_buf_match( buf[0], " *: EQU *", tmp, arg) && vars_ok(tmp)) {
+        vars_get(tmp)->flags |= NO_INLINE;
+    }
+
     if( po_buf_match( buf[0], " *: defs *", tmp, arg) && vars_ok(tmp)) {
         struct var *v = vars_get(tmp);
         v->size = atoi(arg->str);
         v->init = strdup("1-1");
+        if( strchr(arg->str, ',') ) v->flags |= NO_INLINE;
     }
 
     if( po_buf_match(buf[0], " *: defb *", tmp, arg) && vars_ok(tmp) && strchr(buf[0]->str,',')==NULL) {
@@ -606,6 +627,57 @@ static void vars_remove(Environment * _environment, POBuffer buf[LOOK_AHEAD]) {
      }
 }            
 
+/* decides which variables will be inlined (there is no direct-page on Z80) */
+static void vars_prepare_relocation(Environment * _environment) {
+    int i;
+
+    num_dp = 0;
+    num_inlined = 0;
+
+    for(i=0; i<vars.size; ++i) {
+        struct var *v = &vars.tab[i];
+        if(v->offset != -1) continue;
+        /* the immediate is the variable itself: code must be in RAM */
+        if(!DO_INLINE || !vars_complete || (v->flags & NO_INLINE) || v->size != 1 || v->init == NULL
+        || _environment->outputFileType == OUTPUT_FILE_TYPE_ROM) {
+            v->offset = 0;
+        }
+    }
+}
+
+/* inlines the variables */
+static void vars_relocate(Environment * _environment, POBuffer buf[LOOK_AHEAD]) {
+    static int relative = 0; /* lines still inside a "$+n" */
+    POBuffer var = TMP_BUF;
+    int i, near = relative > 0;
+
+    if(relative > 0) --relative;
+    if(strstr(buf[0]->str, "$+")) relative = 8;
+    for(i=0; i<LOOK_AHEAD; ++i) if(strstr(buf[i]->str, "$-") || strstr(buf[i]->str, "$+")) near = 1;
+
+    /* the first "LD A, (x)" becomes "LD A, n", x being the operand itself */
+    if(po_buf_match( buf[0], " LD A, (*)", var) && vars_ok(var) && !near) {
+        struct var *v = vars_get(var);
+        if(v->offset == -1) {
+            v->offset = -2;
+            v->flags |= NO_REMOVE;
+            optim(buf[0], "inlined1", "\tLD A, %s\n%s: EQU $-1", v->init, var->str);
+            num_cycles += 13-7;
+        }
+    }
+
+    /* removes the storage of inlined variables */
+    if(po_buf_match( buf[0], " *: DEFS ", var)
+    || po_buf_match( buf[0], " *: DEFB ", var) ) if(vars_ok(var)) {
+        struct var *v = vars_get(var);
+        if(v->offset == -2) {
+            optim(buf[0], "inlined3", NULL);
+            ++num_inlined;
+            ++_environment->removedAssemblyLines;
+        }
+    }
+}
+
 /* collapse all heading spaces into a single tabulation */
 static void out(FILE *f, POBuffer _buf) {
     char *s = _buf->str;
@@ -642,6 +714,841 @@ static void fixes_indexed_syntax(POBuffer buf) {
 
 }
 
+/* data-flow optimizations, over the content of the registers */
+
+/* registers as a bitmask, to follow their liveness */
+#define RB_A        0x0001
+#define RB_F        0x0002  /* P/V, H and N flags (S, Z and C are not changed by LDI) */
+#define RB_B        0x0004
+#define RB_C        0x0008
+#define RB_D        0x0010
+#define RB_E        0x0020
+#define RB_H        0x0040
+#define RB_L        0x0080
+#define RB_OTHER    0x0100  /* IX, IY, SP, I and R */
+
+/* how an instruction moves the program counter */
+#define FLOW_NEXT       0   /* goes on with the next line */
+#define FLOW_BRANCH     1   /* could jump elsewhere, or go on */
+#define FLOW_END        2   /* never goes on (jump, return) */
+#define FLOW_CALL       3   /* calls a routine */
+#define FLOW_UNKNOWN    4   /* not understood */
+
+/* memory written by an instruction */
+#define MEM_NONE        0
+#define MEM_OPERAND     1   /* the memory of the first operand */
+#define MEM_ANY         2   /* anything (indirect or block access) */
+
+/* registers whose content is tracked */
+#define REG_A           0
+#define REG_HL          1
+#define REG_DE          2
+#define REG_BC          3
+#define REGS            4
+
+#define REG_TEXT        64
+
+/* content of a register (or memory where it has been stored) */
+struct reg_value {
+    int kind;       /* 0 = unknown, 1 = immediate, 2 = memory */
+    char text[REG_TEXT];
+    int offset;
+};
+
+static struct {
+    struct reg_value content[REGS];
+    struct reg_value alias[REGS];
+} regs;
+
+static const int regs_masks[REGS]     = { RB_A, RB_H|RB_L, RB_D|RB_E, RB_B|RB_C };
+static const char *regs_names[REGS]   = { "A", "HL", "DE", "BC" };
+static const char *regs_high[REGS]    = { NULL, "H", "D", "B" };
+static const char *regs_low[REGS]     = { NULL, "L", "E", "C" };
+
+/* symbols, sorted for a binary search */
+struct symbols {
+    char **tab;
+    int size;
+    int capacity;
+};
+
+static void symbols_add(struct symbols *_symbols, char *_name, int _len) {
+    if(_symbols->size == _symbols->capacity) {
+        _symbols->capacity += 256;
+        _symbols->tab = realloc(_symbols->tab, sizeof(char *)*_symbols->capacity);
+    }
+    _symbols->tab[_symbols->size] = malloc(_len+1);
+    memcpy(_symbols->tab[_symbols->size], _name, _len);
+    _symbols->tab[_symbols->size][_len] = '\0';
+    ++_symbols->size;
+}
+
+static int symbols_cmp(const void *_a, const void *_b) {
+    return strcmp(*(char **)_a, *(char **)_b);
+}
+
+static void symbols_sort(struct symbols *_symbols) {
+    qsort(_symbols->tab, _symbols->size, sizeof(char *), symbols_cmp);
+}
+
+static int symbols_has(struct symbols *_symbols, char *_name) {
+    return _symbols->size > 0 &&
+        bsearch(&_name, _symbols->tab, _symbols->size, sizeof(char *), symbols_cmp) != NULL;
+}
+
+static void symbols_free(struct symbols *_symbols) {
+    int i;
+    for(i=0; i<_symbols->size; ++i) free(_symbols->tab[i]);
+    free(_symbols->tab);
+    memset(_symbols, 0, sizeof(*_symbols));
+}
+
+static inline int _isSymbol(char c) {
+    return isalnum(c) || c=='_' || c=='.' || c=='@';
+}
+
+/* labels used by some instruction (or data), and variables at a fixed address */
+static struct symbols regs_referenced;
+static struct symbols regs_equated;
+
+/* clears what is known */
+static void regs_reset(void) {
+    memset(&regs, 0, sizeof(regs));
+}
+
+/* splits a line into label, mnemonic and operands (without spaces); returns 1 if the label ends with a colon */
+static int regs_split(char *_line, char *_label, char *_mnemonic, char *_op1, char *_op2) {
+    char *s = _line;
+    char *d, *base;
+    int depth = 0;
+    int colon = 0;
+
+    *_label = *_mnemonic = *_op1 = *_op2 = '\0';
+
+    /* a label starts at the first column, or ends with a colon */
+    d = _label;
+    while(*s==' ' || *s=='\t') ++s;
+    while(_isSymbol(*s) && d-_label < REG_TEXT-1) *d++ = *s++;
+    *d = '\0';
+    if(*s==':') {
+        colon = 1;
+        ++s;
+    } else if(_line[0]==' ' || _line[0]=='\t') {
+        s -= strlen(_label);
+        *_label = '\0';
+    }
+
+    while(*s==' ' || *s=='\t') ++s;
+    d = _mnemonic;
+    while(_isSymbol(*s) && d-_mnemonic < REG_TEXT-1) *d++ = _toUpper(*s++);
+    *d = '\0';
+
+    d = base = _op1;
+    while(*s && *s!=';' && *s!='\n' && *s!='\r') {
+        if(*s=='(') ++depth;
+        if(*s==')') --depth;
+        if(*s==',' && depth==0 && base==_op1) {
+            *d = '\0';
+            d = base = _op2;
+        } else if(*s!=' ' && *s!='\t' && d-base < MAX_TEMPORARY_STORAGE-1) {
+            *d++ = *s;
+        }
+        ++s;
+    }
+    *d = '\0';
+
+    return colon;
+}
+
+/* returns the register(s) named by the operand */
+static int regs_register(char *_op) {
+    static const struct { char *name; int mask; } names[] = {
+        {"A", RB_A}, {"B", RB_B}, {"C", RB_C}, {"D", RB_D}, {"E", RB_E}, {"H", RB_H}, {"L", RB_L},
+        {"AF", RB_A|RB_F}, {"AF'", RB_A|RB_F}, {"BC", RB_B|RB_C}, {"DE", RB_D|RB_E}, {"HL", RB_H|RB_L},
+        {"IX", RB_OTHER}, {"IY", RB_OTHER}, {"SP", RB_OTHER}, {"I", RB_OTHER}, {"R", RB_OTHER},
+        {"IXH", RB_OTHER}, {"IXL", RB_OTHER}, {"IYH", RB_OTHER}, {"IYL", RB_OTHER}
+    };
+    int i;
+    for(i=0; i<sizeof(names)/sizeof(names[0]); ++i) {
+        if(strcasecmp(_op, names[i].name)==0) return names[i].mask;
+    }
+    return 0;
+}
+
+/* returns the register(s) used to address the memory of the operand */
+static int regs_address(char *_op) {
+    if(*_op!='(') return 0;
+    if(strcasecmp(_op, "(HL)")==0) return RB_H|RB_L;
+    if(strcasecmp(_op, "(DE)")==0) return RB_D|RB_E;
+    if(strcasecmp(_op, "(BC)")==0) return RB_B|RB_C;
+    if(strcasecmp(_op, "(C)")==0)  return RB_B|RB_C;
+    if(strncasecmp(_op, "(IX", 3)==0 || strncasecmp(_op, "(IY", 3)==0 || strcasecmp(_op, "(SP)")==0) return RB_OTHER;
+    return 0;
+}
+
+/* returns the flags read by a condition */
+static int regs_condition(char *_op) {
+    return (strcasecmp(_op, "PE")==0 || strcasecmp(_op, "PO")==0) ? RB_F : 0;
+}
+
+/* tells what an instruction reads, writes and how it moves the program counter */
+static int regs_effects(char *_mn, char *_op1, char *_op2, int *_reads, int *_writes, int *_memory) {
+    *_reads = *_writes = 0;
+    *_memory = MEM_NONE;
+
+    if(strcmp(_mn, "LD")==0) {
+        if(!*_op2) return FLOW_UNKNOWN;
+        *_reads = regs_register(_op2) | regs_address(_op2) | regs_address(_op1);
+        if(*_op1=='(') {
+            *_memory = regs_address(_op1) ? MEM_ANY : MEM_OPERAND;
+        } else {
+            *_writes = regs_register(_op1);
+            if(!*_writes) return FLOW_UNKNOWN;
+            if(strcasecmp(_op2, "I")==0 || strcasecmp(_op2, "R")==0) *_writes |= RB_F;
+        }
+        return FLOW_NEXT;
+    }
+    if(strcmp(_mn, "PUSH")==0) {
+        *_reads = regs_register(_op1);
+        return FLOW_NEXT;
+    }
+    if(strcmp(_mn, "POP")==0) {
+        *_writes = regs_register(_op1);
+        return FLOW_NEXT;
+    }
+    if(strcmp(_mn, "EX")==0) {
+        *_reads = *_writes = (*_op1=='(' ? 0 : regs_register(_op1)) | regs_register(_op2);
+        return *_reads ? FLOW_NEXT : FLOW_UNKNOWN;
+    }
+    if(strcmp(_mn, "EXX")==0) {
+        *_reads = *_writes = RB_B|RB_C|RB_D|RB_E|RB_H|RB_L;
+        return FLOW_NEXT;
+    }
+    if(strcmp(_mn, "ADD")==0 || strcmp(_mn, "ADC")==0 || strcmp(_mn, "SUB")==0 || strcmp(_mn, "SBC")==0 ||
+       strcmp(_mn, "AND")==0 || strcmp(_mn, "OR")==0  || strcmp(_mn, "XOR")==0 || strcmp(_mn, "CP")==0) {
+        int wide = *_op2 && (regs_register(_op1) & ~RB_A);
+        if(wide) {
+            /* ADD HL, rr leaves P/V as it is */
+            *_reads = regs_register(_op1) | regs_register(_op2);
+            *_writes = regs_register(_op1) | (strcmp(_mn, "ADD")==0 ? 0 : RB_F);
+        } else {
+            char *src = *_op2 ? _op2 : _op1;
+            *_reads = RB_A | regs_register(src) | regs_address(src);
+            *_writes = RB_F | (strcmp(_mn, "CP")==0 ? 0 : RB_A);
+        }
+        return FLOW_NEXT;
+    }
+    if(strcmp(_mn, "INC")==0 || strcmp(_mn, "DEC")==0) {
+        if(*_op1=='(') {
+            *_reads = regs_address(_op1);
+            *_writes = RB_F;
+            *_memory = MEM_ANY;
+        } else {
+            int r = regs_register(_op1);
+            *_reads = *_writes = r;
+            if(r==RB_A || r==RB_B || r==RB_C || r==RB_D || r==RB_E || r==RB_H || r==RB_L) *_writes |= RB_F;
+        }
+        return FLOW_NEXT;
+    }
+    if(strcmp(_mn, "RLCA")==0 || strcmp(_mn, "RRCA")==0 || strcmp(_mn, "RLA")==0 || strcmp(_mn, "RRA")==0 ||
+       strcmp(_mn, "CPL")==0) {
+        *_reads = *_writes = RB_A;
+        return FLOW_NEXT;
+    }
+    if(strcmp(_mn, "NEG")==0 || strcmp(_mn, "DAA")==0) {
+        *_reads = RB_A | (strcmp(_mn, "DAA")==0 ? RB_F : 0);
+        *_writes = RB_A | RB_F;
+        return FLOW_NEXT;
+    }
+    if(strcmp(_mn, "RLC")==0 || strcmp(_mn, "RRC")==0 || strcmp(_mn, "RL")==0  || strcmp(_mn, "RR")==0 ||
+       strcmp(_mn, "SLA")==0 || strcmp(_mn, "SRA")==0 || strcmp(_mn, "SRL")==0 || strcmp(_mn, "SLL")==0 ||
+       strcmp(_mn, "SL1")==0) {
+        if(*_op2) return FLOW_UNKNOWN;
+        if(*_op1=='(') {
+            *_reads = regs_address(_op1);
+            *_writes = RB_F;
+            *_memory = MEM_ANY;
+        } else {
+            *_reads = regs_register(_op1);
+            *_writes = regs_register(_op1) | RB_F;
+        }
+        return FLOW_NEXT;
+    }
+    if(strcmp(_mn, "BIT")==0) {
+        *_reads = regs_register(_op2) | regs_address(_op2);
+        *_writes = RB_F;
+        return FLOW_NEXT;
+    }
+    if(strcmp(_mn, "SET")==0 || strcmp(_mn, "RES")==0) {
+        if(*_op2=='(') {
+            *_reads = regs_address(_op2);
+            *_memory = MEM_ANY;
+        } else {
+            *_reads = *_writes = regs_register(_op2);
+        }
+        return FLOW_NEXT;
+    }
+    if(strcmp(_mn, "RLD")==0 || strcmp(_mn, "RRD")==0) {
+        *_reads = RB_A|RB_H|RB_L;
+        *_writes = RB_A|RB_F;
+        *_memory = MEM_ANY;
+        return FLOW_NEXT;
+    }
+    if(strcmp(_mn, "LDI")==0 || strcmp(_mn, "LDD")==0 || strcmp(_mn, "LDIR")==0 || strcmp(_mn, "LDDR")==0) {
+        *_reads = *_writes = RB_B|RB_C|RB_D|RB_E|RB_H|RB_L;
+        *_writes |= RB_F;
+        *_memory = MEM_ANY;
+        return FLOW_NEXT;
+    }
+    if(strcmp(_mn, "CPI")==0 || strcmp(_mn, "CPD")==0 || strcmp(_mn, "CPIR")==0 || strcmp(_mn, "CPDR")==0) {
+        *_reads = RB_A|RB_B|RB_C|RB_H|RB_L;
+        *_writes = RB_B|RB_C|RB_H|RB_L|RB_F;
+        return FLOW_NEXT;
+    }
+    if(strcmp(_mn, "INI")==0 || strcmp(_mn, "IND")==0 || strcmp(_mn, "INIR")==0 || strcmp(_mn, "INDR")==0 ||
+       strcmp(_mn, "OUTI")==0 || strcmp(_mn, "OUTD")==0 || strcmp(_mn, "OTIR")==0 || strcmp(_mn, "OTDR")==0) {
+        *_reads = *_writes = RB_B|RB_C|RB_H|RB_L;
+        *_writes |= RB_F;
+        if(*_mn=='I') *_memory = MEM_ANY;
+        return FLOW_NEXT;
+    }
+    if(strcmp(_mn, "IN")==0) {
+        if(strcasecmp(_op2, "(C)")==0) {
+            *_reads = RB_B|RB_C;
+            *_writes = regs_register(_op1) | RB_F;
+        } else {
+            *_reads = RB_A;
+            *_writes = RB_A;
+        }
+        return FLOW_NEXT;
+    }
+    if(strcmp(_mn, "OUT")==0) {
+        *_reads = regs_register(_op2) | (strcasecmp(_op1, "(C)")==0 ? RB_B|RB_C : RB_A);
+        return FLOW_NEXT;
+    }
+    if(strcmp(_mn, "NOP")==0 || strcmp(_mn, "DI")==0 || strcmp(_mn, "EI")==0 || strcmp(_mn, "IM")==0 ||
+       strcmp(_mn, "SCF")==0 || strcmp(_mn, "CCF")==0) {
+        return FLOW_NEXT;
+    }
+    if(strcmp(_mn, "JP")==0 || strcmp(_mn, "JR")==0) {
+        if(*_op2) {
+            *_reads = regs_condition(_op1);
+            return FLOW_BRANCH;
+        }
+        *_reads = regs_address(_op1) | (strcasecmp(_op1, "HL")==0 ? RB_H|RB_L : 0);
+        return FLOW_END;
+    }
+    if(strcmp(_mn, "DJNZ")==0) {
+        *_reads = *_writes = RB_B;
+        return FLOW_BRANCH;
+    }
+    if(strcmp(_mn, "RET")==0) {
+        if(*_op1) {
+            *_reads = regs_condition(_op1);
+            return FLOW_BRANCH;
+        }
+        return FLOW_END;
+    }
+    if(strcmp(_mn, "RETI")==0 || strcmp(_mn, "RETN")==0 || strcmp(_mn, "HALT")==0) {
+        return FLOW_END;
+    }
+    if(strcmp(_mn, "CALL")==0 || strcmp(_mn, "RST")==0) {
+        return FLOW_CALL;
+    }
+
+    return FLOW_UNKNOWN;
+}
+
+/* parses "name" or "name+n" (n decimal); returns the length of the name */
+static int regs_symbol(char *_op, int *_offset) {
+    char *s = _op;
+    *_offset = 0;
+    if(!isalpha(*s) && *s!='_') return 0;
+    while(_isSymbol(*s)) ++s;
+    if(*s=='+' && isdigit(s[1])) {
+        char *e;
+        *_offset = strtol(s+1, &e, 10);
+        if(*e) return 0;
+    } else if(*s) {
+        return 0;
+    }
+    return s - _op;
+}
+
+/* can the content of this variable be assumed to change only by the code? */
+static int regs_trackable(char *_name) {
+    POBuffer name = TMP_BUF;
+    po_buf_cpy(name, _name);
+    return *_name=='_' && vars_ok(name) && !symbols_has(&regs_equated, _name);
+}
+
+/* decodes the value of an operand */
+static void regs_value(char *_op, int _width, struct reg_value *_value) {
+    memset(_value, 0, sizeof(*_value));
+
+    if(*_op=='(') {
+        char inside[MAX_TEMPORARY_STORAGE];
+        int len, offset;
+        strcpy(inside, _op+1);
+        if(!*inside || inside[strlen(inside)-1]!=')') return;
+        inside[strlen(inside)-1] = '\0';
+        len = regs_symbol(inside, &offset);
+        if(len==0 || len>=REG_TEXT) return;
+        inside[len] = '\0';
+        if(!regs_trackable(inside)) return;
+        _value->kind = 2;
+        strcpy(_value->text, inside);
+        _value->offset = offset;
+        return;
+    }
+
+    if(!*_op || regs_register(_op) || strlen(_op)>=REG_TEXT || strchr(_op, '\'') || strchr(_op, '"')) return;
+
+    _value->kind = 1;
+    if(*_op=='$' && _op[1] && strspn(_op+1, "0123456789abcdefABCDEF")==strlen(_op+1)) {
+        sprintf(_value->text, "%ld", strtol(_op+1, NULL, 16) & (_width==1 ? 0xff : 0xffff));
+    } else if(strspn(_op, "0123456789")==strlen(_op)) {
+        sprintf(_value->text, "%ld", strtol(_op, NULL, 10) & (_width==1 ? 0xff : 0xffff));
+    } else {
+        strcpy(_value->text, _op);
+    }
+}
+
+static int regs_same(struct reg_value *_a, struct reg_value *_b) {
+    return _a->kind!=0 && _a->kind==_b->kind && _a->offset==_b->offset && strcmp(_a->text, _b->text)==0;
+}
+
+static int regs_width(int _reg) {
+    return _reg==REG_A ? 1 : 2;
+}
+
+/* forgets the registers related to the memory written */
+static void regs_forget(struct reg_value *_memory, char *_name, int _width) {
+    int i, j;
+    for(i=0; i<REGS; ++i) {
+        struct reg_value *values[2] = { &regs.content[i], &regs.alias[i] };
+        for(j=0; j<2; ++j) {
+            struct reg_value *v = values[j];
+            if(v->kind!=2) continue;
+            if(_memory!=NULL) {
+                if(strcmp(v->text, _memory->text)==0 &&
+                   v->offset < _memory->offset+_width && _memory->offset < v->offset+regs_width(i)) {
+                    v->kind = 0;
+                }
+            } else if(_name==NULL || strcmp(v->text, _name)==0) {
+                v->kind = 0;
+            }
+        }
+    }
+}
+
+/* the memory of the operand has been written */
+static void regs_store(char *_op, int _width) {
+    struct reg_value memory;
+    char inside[MAX_TEMPORARY_STORAGE];
+    int len, offset;
+
+    if(regs_address(_op)) {
+        regs_forget(NULL, NULL, 0);
+        return;
+    }
+
+    regs_value(_op, _width, &memory);
+    if(memory.kind==2) {
+        regs_forget(&memory, NULL, _width);
+        return;
+    }
+
+    strcpy(inside, _op+1);
+    if(*inside) inside[strlen(inside)-1] = '\0';
+    len = regs_symbol(inside, &offset);
+    if(len>0) {
+        /* not tracked: forget it at any offset */
+        inside[len] = '\0';
+        regs_forget(NULL, inside, 0);
+    } else {
+        regs_forget(NULL, NULL, 0);
+    }
+}
+
+static int regs_index(char *_op) {
+    int i;
+    for(i=0; i<REGS; ++i) {
+        if(strcasecmp(_op, regs_names[i])==0) return i;
+    }
+    return -1;
+}
+
+/* T-states of a load (or store) of a register with an immediate (or memory) */
+static int regs_cycles(int _reg, int _memory) {
+    if(_reg==REG_A)  return _memory ? 13 : 7;
+    if(_reg==REG_HL) return _memory ? 16 : 10;
+    return _memory ? 20 : 10;
+}
+
+/* the lines of the source, with the information for the data-flow pass */
+struct regs_line {
+    POBuffer buf;
+    int code;     /* 1 if it is an instruction (or label) */
+    int pinned;   /* 1 if it cannot be changed nor tracked */
+};
+
+/* marks _count instructions near a relative jump ("JR NC, $+4") */
+static void regs_pin(struct regs_line *_lines, int _size, int _line, int _count) {
+    int i, step, n;
+    for(step=-1; step<=1; step+=2) {
+        for(i=_line, n=0; i>=0 && i<_size && n<=_count; i+=step) {
+            _lines[i].pinned = 1;
+            if(_lines[i].code) ++n;
+        }
+    }
+}
+
+/* collects referenced labels, variables at fixed address, relative jumps
+   and code that is changed by itself */
+static void regs_prepare(struct regs_line *_lines, int _size) {
+    char label[REG_TEXT], mn[REG_TEXT], op1[MAX_TEMPORARY_STORAGE], op2[MAX_TEMPORARY_STORAGE];
+    struct symbols stored;
+    int i;
+
+    memset(&stored, 0, sizeof(stored));
+
+    for(i=0; i<_size; ++i) {
+        _lines[i].code = !isAComment(_lines[i].buf);
+        _lines[i].pinned = 0;
+    }
+
+    for(i=0; i<_size; ++i) {
+        char *s = _lines[i].buf->str;
+        if(!_lines[i].code) continue;
+
+        regs_split(s, label, mn, op1, op2);
+
+        /* any symbol used after the label is a reference */
+        if(*label) {
+            s = strstr(s, label) + strlen(label);
+        }
+        while(*s && *s!=';') {
+            if(*s=='"' || *s=='\'') {
+                char q = *s++;
+                while(*s && *s!=q) ++s;
+                if(*s) ++s;
+            } else if(_isSymbol(*s) && !isdigit(*s)) {
+                char *start = s;
+                while(_isSymbol(*s)) ++s;
+                symbols_add(&regs_referenced, start, s-start);
+            } else {
+                ++s;
+            }
+        }
+
+        if(*label && strcmp(mn, "EQU")==0) {
+            symbols_add(&regs_equated, label, strlen(label));
+            /* "label: EQU $-n" points inside the previous instruction */
+            if(*op1=='$' && op1[1]=='-') {
+                int j = i-1;
+                while(j>0 && !_lines[j].code) --j;
+                if(j>=0) _lines[j].pinned = 1;
+            }
+        }
+
+        /* "$+n" and "$-n" point to instructions without label */
+        if((*op1=='$' && (op1[1]=='+' || op1[1]=='-')) || (*op2=='$' && (op2[1]=='+' || op2[1]=='-'))) {
+            char *rel = (*op2=='$') ? op2 : op1;
+            regs_pin(_lines, _size, i, atoi(rel+2));
+        }
+
+        if(strcmp(mn, "LD")==0 && *op1=='(') {
+            int offset;
+            int len = regs_symbol(op1+1, &offset);
+            if(len>0) symbols_add(&stored, op1+1, len);
+        }
+    }
+
+    symbols_sort(&regs_referenced);
+    symbols_sort(&regs_equated);
+    symbols_sort(&stored);
+
+    /* code whose operands are changed by "LD (label+n), A" */
+    for(i=0; i<_size; ++i) {
+        if(!_lines[i].code) continue;
+        regs_split(_lines[i].buf->str, label, mn, op1, op2);
+        if(*label && symbols_has(&stored, label) && strcmp(mn, "EQU") && strncmp(mn, "DEF", 3) && strcmp(mn, "DB") && strcmp(mn, "DW") && strcmp(mn, "DS")) {
+            int j, n;
+            for(j=i, n=0; j<_size && n<3; ++j) {
+                _lines[j].pinned = 1;
+                if(_lines[j].code) ++n;
+            }
+        }
+    }
+
+    symbols_free(&stored);
+}
+
+/* are registers in _mask dead after the line _line? (conservative) */
+static int regs_dead(struct regs_line *_lines, int _size, int _line, int _mask) {
+    char label[REG_TEXT], mn[REG_TEXT], op1[MAX_TEMPORARY_STORAGE], op2[MAX_TEMPORARY_STORAGE];
+    int reads, writes, memory, flow;
+    int i, n;
+
+    for(i=_line, n=0; i<_size && n<64; ++i) {
+        if(!_lines[i].code) continue;
+        if(_lines[i].pinned) return 0;
+        ++n;
+        regs_split(_lines[i].buf->str, label, mn, op1, op2);
+        if(*label && symbols_has(&regs_referenced, label)) return 0;
+        if(!*mn) continue;
+        flow = regs_effects(mn, op1, op2, &reads, &writes, &memory);
+        if(flow==FLOW_UNKNOWN || (reads & _mask)) return 0;
+        _mask &= ~writes;
+        if(!_mask) return 1;
+        if(flow!=FLOW_NEXT) return 0;
+    }
+
+    return 0;
+}
+
+/* is the line "LD A, (name+n)" or "LD (name+n), A" (_store) ? returns the length of name */
+static int regs_copy(struct regs_line *_line, int _store, char *_name, int *_offset) {
+    char label[REG_TEXT], mn[REG_TEXT], op1[MAX_TEMPORARY_STORAGE], op2[MAX_TEMPORARY_STORAGE];
+    char *mem;
+    int len;
+
+    if(_line->pinned) return 0;
+    regs_split(_line->buf->str, label, mn, op1, op2);
+    if(*label || strcmp(mn, "LD")) return 0;
+    if(strcasecmp(_store ? op2 : op1, "A")) return 0;
+    mem = _store ? op1 : op2;
+    if(*mem!='(' || mem[strlen(mem)-1]!=')') return 0;
+    mem[strlen(mem)-1] = '\0';
+    len = regs_symbol(mem+1, _offset);
+    if(len==0 || len>=REG_TEXT) return 0;
+    memcpy(_name, mem+1, len);
+    _name[len] = '\0';
+    return len;
+}
+
+/*
+ * Turns a sequence of at least 4 "LD A, (x+n) / LD (y+n), A" into LDI:
+ *     LD HL, x
+ *     LD DE, y
+ *     LDI
+ *     ...
+ * if A, HL, DE, BC and the P/V flag are not used after it.
+ * Returns the number of lines of the sequence, 0 if not changed.
+ */
+static int regs_ldi(Environment * _environment, struct regs_line *_lines, int _size, int _line) {
+    char src[REG_TEXT], dst[REG_TEXT], name[REG_TEXT];
+    int srcOffset, dstOffset = 0, offset;
+    int first[32], second[32];
+    int count = 0;
+    int i = _line, j;
+
+    if(!regs_copy(&_lines[i], 0, src, &srcOffset)) return 0;
+
+    while(count < sizeof(first)/sizeof(first[0])) {
+        while(i<_size && !_lines[i].code) ++i;
+        if(i>=_size || !regs_copy(&_lines[i], 0, name, &offset) ||
+           strcmp(name, src) || offset!=srcOffset+count) break;
+        j = i+1;
+        while(j<_size && !_lines[j].code) ++j;
+        if(j>=_size || !regs_copy(&_lines[j], 1, name, &offset)) break;
+        if(count==0) {
+            strcpy(dst, name);
+            dstOffset = offset;
+        } else if(strcmp(name, dst) || offset!=dstOffset+count) {
+            break;
+        }
+        first[count] = i;
+        second[count] = j;
+        ++count;
+        i = j+1;
+    }
+
+    if(count < 4) return 0;
+
+    if(!regs_dead(_lines, _size, second[count-1]+1, RB_A|RB_F|RB_B|RB_C|RB_D|RB_E|RB_H|RB_L)) return 0;
+
+    for(j=0; j<count; ++j) {
+        if(j==0) {
+            optim(_lines[first[j]].buf, RULE "(LD A,(x);LD (y),A)*n->(LD HL,x;LD DE,y;LDI*n)",
+                "\tLD HL, %s+%d\n\tLD DE, %s+%d\n\tLDI", src, srcOffset, dst, dstOffset);
+        } else {
+            optim(_lines[first[j]].buf, NULL, "\tLDI");
+        }
+        optim(_lines[second[j]].buf, NULL, NULL);
+        ++_environment->removedAssemblyLines;
+    }
+    num_cycles += 26*count - (20 + 16*count);
+
+    return second[count-1] - _line + 1;
+}
+
+/* follows the content of the registers, and removes what is useless */
+static void regs_line(Environment * _environment, struct regs_line *_lines, int _size, int _line) {
+    char label[REG_TEXT], mn[REG_TEXT], op1[MAX_TEMPORARY_STORAGE], op2[MAX_TEMPORARY_STORAGE];
+    POBuffer buf = _lines[_line].buf;
+    struct reg_value value;
+    int reads, writes, memory, flow;
+    int r, p, colon;
+
+    colon = regs_split(buf->str, label, mn, op1, op2);
+
+    /* code reachable from elsewhere (or a directive) */
+    if(*label && (!colon || symbols_has(&regs_referenced, label))) {
+        regs_reset();
+    }
+    if(!*mn) return;
+
+    flow = regs_effects(mn, op1, op2, &reads, &writes, &memory);
+
+    if(flow==FLOW_UNKNOWN || _lines[_line].pinned) {
+        regs_reset();
+        return;
+    }
+
+    /* LD r, value */
+    if(strcmp(mn, "LD")==0 && (r = regs_index(op1)) >= 0) {
+        regs_value(op2, regs_width(r), &value);
+        if(value.kind && (regs_same(&regs.content[r], &value) || regs_same(&regs.alias[r], &value))) {
+            optim(buf, RULE "[r=x](LD r,x)->()", NULL);
+            ++_environment->removedAssemblyLines;
+            num_cycles += regs_cycles(r, value.kind==2);
+            return;
+        }
+        if(value.kind==2) {
+            for(p=REG_HL; p<REGS; ++p) {
+                if(p==r) continue;
+                struct reg_value *known = regs.content[p].kind==2 ? &regs.content[p] : &regs.alias[p];
+                if(known->kind!=2 || strcmp(known->text, value.text)) continue;
+                if(r==REG_A && (value.offset==known->offset || value.offset==known->offset+1)) {
+                    optim(buf, RULE "[rr=(x)](LD A,(x))->(LD A,r)", "\tLD A, %s",
+                        value.offset==known->offset ? regs_low[p] : regs_high[p]);
+                    num_cycles += 13-4;
+                    break;
+                }
+                if(r!=REG_A && value.offset==known->offset) {
+                    optim(buf, RULE "[rr=(x)](LD rr,(x))->(LD r,r;LD r,r)", "\tLD %s, %s\n\tLD %s, %s",
+                        regs_high[r], regs_high[p], regs_low[r], regs_low[p]);
+                    num_cycles += regs_cycles(r, 1) - 8;
+                    break;
+                }
+            }
+        }
+        regs.content[r] = value;
+        regs.alias[r].kind = 0;
+        return;
+    }
+
+    /* LD (x), r */
+    if(strcmp(mn, "LD")==0 && *op1=='(' && (r = regs_index(op2)) >= 0) {
+        regs_value(op1, regs_width(r), &value);
+        if(value.kind==2 && (regs_same(&regs.content[r], &value) || regs_same(&regs.alias[r], &value))) {
+            optim(buf, RULE "[r=(x)](LD (x),r)->()", NULL);
+            ++_environment->removedAssemblyLines;
+            num_cycles += regs_cycles(r, 1);
+            return;
+        }
+        regs_store(op1, regs_width(r));
+        if(value.kind==2 && !regs_same(&regs.content[r], &value)) {
+            regs.alias[r] = value;
+        }
+        return;
+    }
+
+    /* EX DE, HL swaps what is known */
+    if(strcmp(mn, "EX")==0 && regs_index(op1)==REG_DE && regs_index(op2)==REG_HL) {
+        struct reg_value t;
+        t = regs.content[REG_DE]; regs.content[REG_DE] = regs.content[REG_HL]; regs.content[REG_HL] = t;
+        t = regs.alias[REG_DE];   regs.alias[REG_DE]   = regs.alias[REG_HL];   regs.alias[REG_HL]   = t;
+        return;
+    }
+
+    if(memory==MEM_OPERAND) {
+        regs_store(op1, regs_register(op2) & (RB_B|RB_D|RB_H|RB_OTHER) && strlen(op2)>1 ? 2 : 1);
+    } else if(memory==MEM_ANY) {
+        regs_forget(NULL, NULL, 0);
+    }
+
+    for(r=0; r<REGS; ++r) {
+        if(writes & regs_masks[r]) {
+            regs.content[r].kind = 0;
+            regs.alias[r].kind = 0;
+        }
+    }
+
+    if(flow==FLOW_END || flow==FLOW_CALL) {
+        regs_reset();
+    }
+}
+
+/* data-flow pass, over the whole source */
+static int optim_dataflow( Environment * _environment ) {
+    struct regs_line *lines = NULL;
+    int size = 0, capacity = 0;
+    FILE * fileAsm;
+    FILE * fileOptimized;
+    char fileNameOptimized[MAX_TEMPORARY_STORAGE];
+    int i;
+
+    fileAsm = fopen( _environment->asmFileName, "rt" );
+    if(fileAsm == NULL) {
+        perror(_environment->asmFileName);
+        exit(-1);
+    }
+
+    while( !feof(fileAsm) ) {
+        if(size == capacity) {
+            capacity += 1024;
+            lines = realloc(lines, sizeof(*lines)*capacity);
+        }
+        lines[size].buf = po_buf_new(0);
+        po_buf_fgets(lines[size].buf, fileAsm);
+        ++size;
+    }
+    (void)fclose(fileAsm);
+
+    ++peephole_pass;
+    change = 0;
+
+    regs_prepare(lines, size);
+    regs_reset();
+
+    for(i=0; i<size; ++i) {
+        int skip;
+        if(!lines[i].code) continue;
+        if((skip = regs_ldi(_environment, lines, size, i)) > 0) {
+            regs_reset();
+            i += skip-1;
+            continue;
+        }
+        regs_line(_environment, lines, size, i);
+    }
+
+    sprintf( fileNameOptimized, "%s.asm", get_temporary_filename( _environment ) );
+    fileOptimized = fopen( fileNameOptimized, "wt" );
+    if(fileOptimized == NULL) {
+        perror(fileNameOptimized);
+        exit(-1);
+    }
+    for(i=0; i<size; ++i) {
+        out(fileOptimized, lines[i].buf);
+        po_buf_del(lines[i].buf);
+    }
+    fprintf(fileOptimized, "; peephole: pass %d, %d change%s, %d T-states saved.\n", peephole_pass,
+        change, change>1 ?"s":"", num_cycles);
+    (void)fclose(fileOptimized);
+    free(lines);
+
+    symbols_free(&regs_referenced);
+    symbols_free(&regs_equated);
+
+    remove(_environment->asmFileName);
+    (void)rename( fileNameOptimized, _environment->asmFileName );
+
+    return change;
+}
+
 /* various kind of optimization */
 static int optim_pass( Environment * _environment, POBuffer buf[LOOK_AHEAD], PeepHoleOptimizationKind kind) {
     char fileNameOptimized[MAX_TEMPORARY_STORAGE];
@@ -671,7 +1578,7 @@ static int optim_pass( Environment * _environment, POBuffer buf[LOOK_AHEAD], Pee
         
         case RELOCATION1:
         ++peephole_pass;
-        // vars_prepare_relocation();
+        vars_prepare_relocation(_environment);
         break;
         
         case RELOCATION2:
@@ -683,6 +1590,8 @@ static int optim_pass( Environment * _environment, POBuffer buf[LOOK_AHEAD], Pee
         break;
     }
 
+    telemetry_begin_pass( _environment, peephole_pass, kind );
+
     fileAsm = fopen( _environment->asmFileName, "rt" );
     if(fileAsm == NULL) {
         perror(_environment->asmFileName);
@@ -747,7 +1656,7 @@ static int optim_pass( Environment * _environment, POBuffer buf[LOOK_AHEAD], Pee
             
             case RELOCATION1:
             case RELOCATION2:
-            // vars_relocate(buf);
+            vars_relocate(_environment, buf);
             break;
         }
 
@@ -757,6 +1666,9 @@ static int optim_pass( Environment * _environment, POBuffer buf[LOOK_AHEAD], Pee
     adiline3( "POL:0:%d:%d:%d", 
         peephole_pass, _environment->currentSourceLineAnalyzed, _environment->removedAssemblyLines );
 
+    /* every line has been looked for variables */
+    if(kind == PEEPHOLE && change == 0) vars_complete = 1;
+
     /* log info at the end of the file */
     switch(kind) {
         case PEEPHOLE:
@@ -770,9 +1682,9 @@ static int optim_pass( Environment * _environment, POBuffer buf[LOOK_AHEAD], Pee
         break;
         
         case RELOCATION2:
-        fprintf(fileOptimized, "; peephole: pass %d, %d var%s moved to dp, %d var%s inlined.\n", peephole_pass, 
+        fprintf(fileOptimized, "; peephole: pass %d, %d var%s moved to dp, %d var%s inlined, %d T-states saved.\n", peephole_pass, 
             num_dp, num_dp>1 ?"s":"", 
-            num_inlined, num_inlined>1 ? "s":"");
+            num_inlined, num_inlined>1 ? "s":"", num_cycles);
         break;
         
         default:
@@ -786,6 +1698,8 @@ static int optim_pass( Environment * _environment, POBuffer buf[LOOK_AHEAD], Pee
     remove(_environment->asmFileName);
     (void)rename( fileNameOptimized, _environment->asmFileName );
     
+    telemetry_end_pass( _environment );
+
     return change;
 }
 
@@ -1017,6 +1931,7 @@ void target_peephole_optimizer( Environment * _environment ) {
             while(optim_pass(_environment, buf, PEEPHOLE)&&optimization_limit_count) {
                 --optimization_limit_count;
             };
+            optim_dataflow(_environment);
             optim_pass(_environment, buf, DEADVARS);
         } while(change&&optimization_limit_count);
         optim_pass(_environment, buf, RELOCATION1);
@@ -1489,6 +1489,42 @@ del programma.
 @target all
 </usermanual> */
 
+/* <usermanual>
+@keyword OPTION DATA
+
+@english
+When ''OPTION DATA AS'' appears in a source file, every value of every
+''DATA'' line is stored with the given (integer) type. Since all the values 
+have the same type, ugBASIC does not store the type of each one: the data
+take less memory, and ''READ'' does not have to check it, so it is faster.
+The option also enables ''READ INTO'', that fills a whole array at once.
+
+A value that does not fit the type (a string, a floating point number or 
+a ''DATA AS'' with a different size) gives an error at compile time. The 
+option must be given before any ''DATA'' or ''READ'' statement.
+
+@italian
+Quando ''OPTION DATA AS'' appare in un file sorgente, tutti i valori di 
+tutte le righe ''DATA'' sono memorizzati con il tipo (intero) indicato.
+Poiché tutti i valori hanno lo stesso tipo, ugBASIC non memorizza il tipo 
+di ciascuno: i dati occupano meno memoria, e ''READ'' non deve verificarlo,
+per cui è più veloce. L'opzione abilita anche ''READ INTO'', che riempie 
+un intero vettore in una sola volta.
+
+Un valore che non rientra nel tipo (una stringa, un numero in virgola 
+mobile o un ''DATA AS'' con una dimensione diversa) dà un errore in fase di 
+compilazione. L'opzione deve essere indicata prima di qualsiasi istruzione 
+''DATA'' o ''READ''.
+
+@syntax OPTION DATA AS type
+
+@example OPTION DATA AS BYTE
+
+@usedInExample data_example_14.bas
+
+@target all
+</usermanual> */
+
 /* <usermanual>
 @keyword ORIGIN
 
@@ -1831,6 +1867,233 @@ di stringe dinamiche concorrenti consentite.
 
 @target all
 </usermanual> */
+/* <usermanual>
+@keyword DEFINE SPRITE MULTIPLEX
+
+@english
+
+With the ''DEFINE SPRITE MULTIPLEX'' instruction it is possible to enable the
+sprite multiplexer. The compiler will keep a table of virtual sprites (24 by
+default, up to 32) that can be used like hardware sprites.
+
+On VIC-II, the virtual sprites are sorted by their vertical position at each
+frame, and the eight hardware sprites are reprogrammed down the screen by a
+chain of raster interrupts. No more than eight sprites can share the same
+lines. The multiplexer owns the raster interrupt, so ''RASTER AT'' cannot be
+used at the same time, and neither composite sprites (''CSPRITE'').
+
+On TMS9918, the sprite attributes are kept in memory and copied to the video
+chip with a different priority at each frame, so sprites that exceed the limit
+of four per line will flicker instead of disappearing. The rotation happens at
+each ''END GAMELOOP''.
+
+@italian
+
+Con l'istruzione ''DEFINE SPRITE MULTIPLEX'' è possibile abilitare il
+multiplexer degli sprite. Il compilatore manterrà una tabella di sprite
+virtuali (24 di default, fino a 32) utilizzabili come sprite hardware.
+
+Su VIC-II, gli sprite virtuali sono ordinati per posizione verticale ad ogni
+fotogramma, e gli otto sprite hardware sono riprogrammati lungo lo schermo
+da una catena di interruzioni raster. Non più di otto sprite possono
+condividere le stesse linee. Il multiplexer utilizza l'interruzione raster,
+per cui ''RASTER AT'' non può essere usato insieme, e nemmeno gli sprite
+composti (''CSPRITE'').
+
+Su TMS9918, gli attributi degli sprite sono mantenuti in memoria e copiati
+sul chip video con una priorità diversa ad ogni fotogramma, in modo che gli
+sprite che superano il limite di quattro per linea lampeggino invece di
+sparire. La rotazione avviene ad ogni ''END GAMELOOP''.
+
+@syntax DEFINE SPRITE MULTIPLEX ON
+@syntax DEFINE SPRITE MULTIPLEX OFF
+@syntax DEFINE SPRITE MULTIPLEX count
+
+@example DEFINE SPRITE MULTIPLEX 32
+
+@target c64
+@target coleco
+@target msx1
+@target sc3000
+@target sg1000
+</usermanual> */
+/* <usermanual>
+@keyword DEFINE MATH
+
+@english
+
+With the ''DEFINE MATH'' instruction it is possible to choose between the
+precise math routines and the table driven (or approximated) ones.
+
+By default, ''SIN'', ''COS'' and ''TAN'' of a fixed point angle are read
+from a quarter-wave table of 65 words, and returned with the same type
+of the angle, while integer and ''FLOAT'' angles keep using the floating
+point routines. The angle is reduced to 256
+steps per turn (1.4 degrees), so the error is below 0.025; the cost is
+one 16 bit multiplication, one table access and a few shifts, against
+the series evaluation of the floating point library, that needs several
+floating point multiplications.
+
+With ''DEFINE MATH FAST'' the table is also used for integer angles
+(returning a ''FIXED'', so the result must be scaled with care: 8.8
+values overflow above 127) and for ''FLOAT'' angles (after one floating
+point multiplication and a conversion), ''SQR''
+uses a table of 256 bytes to seed a single Newton step (the result is
+still exact, but it costs one division instead of the bit by bit
+method) and ''DISTANCE'' is approximated with shifts and sums, with an
+error between -2.8% and +6.8%. With ''DEFINE MATH PRECISE'' the floating
+point routines are used for every angle that is not a fixed point.
+
+The advantage is greatest on 6502 targets, where every multiplication
+is made in software; on 6809 targets the hardware 8 bit multiplication
+makes the floating point series cheaper, but the table is still faster;
+on Z80 targets the division used by ''SQR'' is relatively expensive,
+so the Newton method pays off mainly on large values.
+
+@italian
+
+Con l'istruzione ''DEFINE MATH'' è possibile scegliere tra le routine
+matematiche precise e quelle basate su tabelle (o approssimate).
+
+In modo predefinito, ''SIN'', ''COS'' e ''TAN'' di un angolo in virgola
+fissa vengono letti da una tabella di un quarto d'onda di 65 parole, e
+restituiti con lo stesso tipo dell'angolo, mentre gli angoli interi e
+''FLOAT'' continuano a usare le routine in virgola mobile. L'angolo viene ridotto a 256 passi per giro (1.4 gradi),
+per cui l'errore è inferiore a 0.025; il costo è una moltiplicazione a
+16 bit, un accesso alla tabella e qualche scorrimento, contro il calcolo
+della serie della libreria in virgola mobile, che richiede diverse
+moltiplicazioni in virgola mobile.
+
+Con ''DEFINE MATH FAST'' la tabella viene usata anche per gli angoli
+interi (restituendo un ''FIXED'', per cui il risultato va scalato con
+attenzione: i valori 8.8 vanno oltre il limite sopra 127) e per gli
+angoli ''FLOAT'' (dopo una moltiplicazione in virgola mobile e una
+conversione),
+''SQR'' usa una tabella di 256 byte come punto di partenza di un solo
+passo di Newton (il risultato resta esatto, ma costa una divisione invece
+del metodo bit per bit) e ''DISTANCE'' viene approssimata con scorrimenti
+e somme, con un errore tra -2.8% e +6.8%. Con ''DEFINE MATH PRECISE''
+vengono usate le routine in virgola mobile per ogni angolo che non sia
+in virgola fissa.
+
+Il vantaggio è massimo sui target 6502, dove ogni moltiplicazione è
+fatta via software; sui target 6809 la moltiplicazione hardware a 8 bit
+rende la serie in virgola mobile meno costosa, ma la tabella resta più
+veloce; sui target Z80 la divisione usata da ''SQR'' è relativamente
+costosa, per cui il metodo di Newton conviene soprattutto su valori grandi.
+
+@syntax DEFINE MATH FAST
+@syntax DEFINE MATH PRECISE
+
+@example DEFINE MATH FAST
+
+@target all
+</usermanual> */
+/* <usermanual>
+@keyword DEFINE SCROLL DOUBLE BUFFER
+
+@english
+
+With the ''DEFINE SCROLL DOUBLE BUFFER'' instruction the text screen is
+moved by ''SCROLL'', ''HSCROLL SCREEN'' and ''VSCROLL SCREEN'' using two
+screen buffers. While the visible screen is moved pixel by pixel by the
+fine scroll registers, the hidden one is filled with the content already
+shifted by one character, about half of the screen for each pixel. When
+the eighth pixel is reached, the rest of the hidden screen is prepared
+and the two screens are exchanged during the lower border, so the coarse
+step never tears and costs about half of the full copy.
+
+On the VIC-II the screens are at $8400 and $8800; since the color RAM
+cannot be exchanged, the shifted colors are prepared in a separate buffer
+of 1000 bytes and copied while the raster is in the border, ahead of the
+beam. On TED the screens are at $E800 and $D800, and the attributes are
+exchanged together with the characters.
+
+Since the rows are prepared in advance, any change to the screen should
+be done right after the coarse step (for example, in the ''ON SCROLL''
+handlers); the instruction is meant for the standard text mode, and it
+should not be mixed with ''DOUBLE BUFFER ON''.
+
+@italian
+
+Con l'istruzione ''DEFINE SCROLL DOUBLE BUFFER'' lo schermo testuale viene
+spostato da ''SCROLL'', ''HSCROLL SCREEN'' e ''VSCROLL SCREEN'' usando due
+schermi. Mentre lo schermo visibile viene spostato pixel per pixel dai
+registri di scorrimento fine, quello nascosto viene riempito con il
+contenuto già spostato di un carattere, circa metà schermo per ogni pixel.
+Quando si raggiunge l'ottavo pixel, il resto dello schermo nascosto viene
+preparato e i due schermi vengono scambiati durante il bordo inferiore,
+per cui il passo a carattere non produce mai strappi e costa circa metà
+della copia completa.
+
+Sul VIC-II gli schermi sono a $8400 e $8800; dato che la RAM dei colori
+non può essere scambiata, i colori spostati vengono preparati in un buffer
+separato di 1000 byte e copiati mentre il raster è nel bordo, davanti al
+pennello elettronico. Sul TED gli schermi sono a $E800 e $D800, e gli
+attributi vengono scambiati insieme ai caratteri.
+
+Dato che le righe sono preparate in anticipo, qualsiasi modifica allo
+schermo dovrebbe essere fatta subito dopo il passo a carattere (ad esempio,
+nei gestori ''ON SCROLL''); l'istruzione è pensata per la modalità testuale
+standard, e non dovrebbe essere usata insieme a ''DOUBLE BUFFER ON''.
+
+@syntax DEFINE SCROLL DOUBLE BUFFER [ON|OFF]
+
+@example DEFINE SCROLL DOUBLE BUFFER
+
+@target c64, c128, plus4
+</usermanual> */
+/* <usermanual>
+@keyword DEFINE DLOAD FAST
+
+@english
+
+With the ''DEFINE DLOAD FAST'' instruction the files are loaded by
+''DLOAD'' with a fast loader instead of the KERNAL. A small routine is
+copied into the memory of the 1541 drive, it looks for the file and it
+sends the sectors to the computer two bits at a time, on the CLK and
+DATA lines of the serial bus, many times faster than the standard
+protocol. Moreover, the files written on the ''D64'' disk images (for
+example by ''STORAGE'') use an interleave of 8 sectors, suited to the
+time needed to send a sector to the computer.
+
+While loading, the screen is blanked, the sprites are disabled and the
+interrupts are stopped, since the timing of the transfer is exact. The
+fast loader works with a 1541 (or compatible) drive: on emulators, the
+true drive emulation must be enabled.
+
+If the file is not found, ''DLOAD ERROR'' is 4 (as with the KERNAL);
+if a sector cannot be read, it is the number of the DOS error (from
+20 to 29, i.e. 23 for a checksum error).
+
+@italian
+
+Con l'istruzione ''DEFINE DLOAD FAST'' i file vengono caricati da
+''DLOAD'' con un caricatore veloce invece che con il KERNAL. Una piccola
+routine viene copiata nella memoria del drive 1541, cerca il file e invia
+i settori al computer due bit alla volta, sulle linee CLK e DATA del bus
+seriale, molte volte più velocemente del protocollo standard. Inoltre, i
+file scritti sulle immagini disco ''D64'' (ad esempio da ''STORAGE'')
+usano un interleave di 8 settori, adatto al tempo necessario per inviare
+un settore al computer.
+
+Durante il caricamento lo schermo viene spento, gli sprite disabilitati e
+gli interrupt fermati, dato che i tempi del trasferimento sono esatti. Il
+caricatore veloce funziona con un drive 1541 (o compatibile): sugli
+emulatori, deve essere attivata l'emulazione completa del drive.
+
+Se il file non viene trovato, ''DLOAD ERROR'' vale 4 (come con il KERNAL);
+se un settore non può essere letto, vale il numero dell'errore DOS (da
+20 a 29, ad esempio 23 per un errore di checksum).
+
+@syntax DEFINE DLOAD FAST [ON|OFF]
+
+@example DEFINE DLOAD FAST
+
+@usedInExample storage_example_12.bas
+
+@target c64
+</usermanual> */
 
 /* <usermanual>
 @keyword AFTER...CALL
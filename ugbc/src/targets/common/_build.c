@@ -58,6 +58,8 @@ void end_build( Environment * _environment ) {
 
     target_finalize( _environment );
 
+    profile_report( _environment );
+
     target_cleanup( _environment );
     
 }
\ No newline at end of file
@@ -102,53 +102,24 @@ void end_compilation( Environment * _environment ) {
         }
     }
     
+    deploy_marker( "runtime" );
+
     int j=0;
     for( j=0; j<MAX_TEMPORARY_STORAGE; ++j ) {
         if ( _environment->deferredEmbedded[j] ) {
-            int size = _environment->deferredEmbeddedSize[j];
-            char * parsed = malloc( (8*size) + 1 );
-            memset( parsed, 0, (8*size) + 1 );
-            char * line = strtok( _environment->deferredEmbedded[j], "\x0a" );
-            while( line ) {
-                _environment->embedResult.line = line;
-                _environment->embedResult.conditional = 0;
-                 _environment->embedResult.lineCount = 0;
-                embed_scan_string( line );
-                embedparse(_environment);
-                if ( ! _environment->embedResult.conditional ) {
-                    int i;
-                    for( i=0; i<_environment->embedResult.current; ++i ) {
-                        if ( _environment->embedResult.excluded[i] )
-                            break;
-                    }
-                    if ( i>= _environment->embedResult.current ) {
-                        if ( _environment->embedResult.lineCount ) {
-                            int j=0;
-                            for( j=0; j<_environment->embedResult.lineCount; ++j ) {
-                                strcat( parsed, _environment->embedResult.lines[j] );
-                                strcat( parsed, "\x0a" );
-                                ((Environment *)_environment)->producedAssemblyLines += assemblyLineIsAComment( _environment->embedResult.lines[j] ) ? 0 : 1;
-                            }
-                        } else {
-                            strcat( parsed, line );
-                            strcat( parsed, "\x0a" );
-                            ((Environment *)_environment)->producedAssemblyLines += assemblyLineIsAComment( line ) ? 0 : 1;
-                        }                        
-                    }
-                }
-                line = strtok( NULL, "\x0a" );
-            }
-            free( _environment->deferredEmbedded[j] );
-            buffered_fwrite( parsed, strlen( parsed )-1, 1, ((Environment *)_environment)->asmFile );
-            free( parsed );
-            buffered_fputs( "\n", ((Environment *)_environment)->asmFile );
+            embedded_deploy( _environment, _environment->deferredEmbedded[j], _environment->deferredEmbeddedLines[j], _environment->deferredEmbeddedLinesCount[j] );
         }
     }
 
+    deploy_marker( "" );
+
     bank_cleanup( _environment );
     every_cleanup( _environment );
+    memory_map_pack( _environment );
     variable_cleanup( _environment );
     dstring_cleanup( _environment );
+    memory_map_report( _environment );
+    image_cache_cleanup( _environment );
     
     target_finalization( _environment );
 
@@ -162,6 +133,8 @@ void end_compilation( Environment * _environment ) {
         fclose(_environment->debuggerLabelsFile);
     }
     
+    every_context_cleanup( _environment );
+
     buffered_output( _environment->asmFile );
     
     fclose(_environment->asmFile);
@@ -0,0 +1,132 @@
+/*****************************************************************************
+ * ugBASIC - an isomorphic BASIC language compiler for retrocomputers        *
+ *****************************************************************************
+ * Copyright 2021-2024 Marco Spedaletti (asimov@mclink.it)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *----------------------------------------------------------------------------
+ * Concesso in licenza secondo i termini della Licenza Apache, versione 2.0
+ * (la "Licenza"); è proibito usare questo file se non in conformità alla
+ * Licenza. Una copia della Licenza è disponibile all'indirizzo:
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Se non richiesto dalla legislazione vigente o concordato per iscritto,
+ * il software distribuito nei termini della Licenza è distribuito
+ * "COSÌ COM'È", SENZA GARANZIE O CONDIZIONI DI ALCUN TIPO, esplicite o
+ * implicite. Consultare la Licenza per il testo specifico che regola le
+ * autorizzazioni e le limitazioni previste dalla medesima.
+ ****************************************************************************/
+
+/****************************************************************************
+ * INCLUDE SECTION 
+ ****************************************************************************/
+
+#include "../../ugbc.h"
+
+/****************************************************************************
+ * CODE SECTION 
+ ****************************************************************************/
+
+/**
+ * @brief Deploy an embedded assembly module into the assembly file
+ * 
+ * This function emits the content of an (embedded) assembly module, by
+ * using the table of lines that has been prepared at build time by the
+ * `embedded.awk` script. Code and comment lines are copied as they are,
+ * without lexing them again. Only the directive lines (those starting
+ * with `@`) are given to the embedded parser, and the branches that are
+ * excluded by an `@IF` / `@ELSE` directive are skipped as a whole.
+ * 
+ * @param _environment Current calling environment
+ * @param _module Content of the module (as per `xxd -i`)
+ * @param _lines Table of lines of the module (as per `embedded.awk`)
+ * @param _count Number of lines of the module
+ */
+void embedded_deploy( Environment * _environment, unsigned char * _module, unsigned int * _lines, unsigned int _count ) {
+
+    char directive[MAX_TEMPORARY_STORAGE];
+
+    unsigned int i = 0;
+
+    while( i < _count ) {
+
+        unsigned int offset = _lines[3*i];
+        unsigned int size = _lines[3*i+1] & 0xffffff;
+        unsigned int kind = _lines[3*i+1] >> 24;
+        unsigned int next = _lines[3*i+2];
+
+        char * line = (char *) &_module[offset];
+
+        int j;
+        int included = 1;
+
+        if ( kind == EMBEDDED_LINE_DIRECTIVE ) {
+
+            if ( size >= MAX_TEMPORARY_STORAGE ) {
+                size = MAX_TEMPORARY_STORAGE - 1;
+            }
+            memcpy( directive, line, size );
+            directive[size] = 0;
+            line = directive;
+
+            _environment->embedResult.line = line;
+            _environment->embedResult.conditional = 0;
+            _environment->embedResult.lineCount = 0;
+            embed_scan_string( line );
+            embedparse(_environment);
+
+            if ( _environment->embedResult.conditional ) {
+                // If the branch just opened is excluded, we can jump
+                // directly to the next one (or to the @ENDIF).
+                if ( next && _environment->embedResult.current > 0 && 
+                        _environment->embedResult.excluded[_environment->embedResult.current-1] ) {
+                    i = next;
+                } else {
+                    ++i;
+                }
+                continue;
+            }
+
+        }
+
+        for( j=0; j<_environment->embedResult.current; ++j ) {
+            if ( _environment->embedResult.excluded[j] ) {
+                included = 0;
+                break;
+            }
+        }
+
+        if ( included ) {
+            if ( kind == EMBEDDED_LINE_DIRECTIVE && _environment->embedResult.lineCount ) {
+                for( j=0; j<_environment->embedResult.lineCount; ++j ) {
+                    buffered_fputs( _environment->embedResult.lines[j], _environment->asmFile );
+                    buffered_fputs( "\n", _environment->asmFile );
+                    _environment->producedAssemblyLines += assemblyLineIsAComment( _environment->embedResult.lines[j] ) ? 0 : 1;
+                }
+            } else {
+                buffered_fwrite( line, size, 1, _environment->asmFile );
+                buffered_fputs( "\n", _environment->asmFile );
+                if ( kind == EMBEDDED_LINE_CODE ) {
+                    ++_environment->producedAssemblyLines;
+                } else if ( kind == EMBEDDED_LINE_DIRECTIVE ) {
+                    _environment->producedAssemblyLines += assemblyLineIsAComment( line ) ? 0 : 1;
+                }
+            }
+        }
+
+        ++i;
+
+    }
+
+}
@@ -0,0 +1,614 @@
+/*****************************************************************************
+ * ugBASIC - an isomorphic BASIC language compiler for retrocomputers        *
+ *****************************************************************************
+ * Copyright 2021-2024 Marco Spedaletti (asimov@mclink.it)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *----------------------------------------------------------------------------
+ * Concesso in licenza secondo i termini della Licenza Apache, versione 2.0
+ * (la "Licenza"); è proibito usare questo file se non in conformità alla
+ * Licenza. Una copia della Licenza è disponibile all'indirizzo:
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Se non richiesto dalla legislazione vigente o concordato per iscritto,
+ * il software distribuito nei termini della Licenza è distribuito
+ * "COSÌ COM'È", SENZA GARANZIE O CONDIZIONI DI ALCUN TIPO, esplicite o
+ * implicite. Consultare la Licenza per il testo specifico che regola le
+ * autorizzazioni e le limitazioni previste dalla medesima.
+ ****************************************************************************/
+
+/****************************************************************************
+ * INCLUDE SECTION
+ ****************************************************************************/
+
+#include "../../ugbc.h"
+#include <math.h>
+
+/****************************************************************************
+ * CODE SECTION
+ ****************************************************************************/
+
+/*
+ * The parser emits the code of an expression while it reduces it, so there
+ * is no separate tree to optimize. This module gives the arithmetic rules of
+ * the grammar a per statement table of "value numbers": every binary
+ * operation is identified by its operator and by the value numbers of its
+ * operands (the name of a variable, or the type and the value of a constant).
+ * If the same operation has already been emitted inside the same statement,
+ * the variable that holds its result is reused (common subexpression
+ * elimination). Before emitting, constant operands are folded and the
+ * trivial cases (x+0, x*1, x*2^n, ...) are simplified.
+ *
+ * The table is dropped at the end of each statement, when a procedure is
+ * called and, for the entries that use it, when a variable is assigned.
+ *
+ * Strings are not numbered (their sum is not commutative): a chain of "+"
+ * between strings is collected into a single pending concatenation, that
+ * is emitted when the result is used (see variable_concatenation_flush()).
+ */
+
+/**
+ * @brief Check if a variable can take part in value numbering
+ *
+ * @param _variable Variable to check
+ * @return int 1 if the variable is a numeric one
+ */
+static int expression_numeric( Variable * _variable ) {
+
+    return ( VT_BITWIDTH( _variable->type ) > 1 ) || ( _variable->type == VT_FLOAT );
+
+}
+
+/**
+ * @brief Check if a variable is a (static or dynamic) string
+ *
+ * @param _variable Variable to check
+ * @return int 1 if the variable is a string
+ */
+static int expression_string( Variable * _variable ) {
+
+    return ( _variable->type == VT_STRING ) || ( _variable->type == VT_DSTRING );
+
+}
+
+/**
+ * @brief Check if a variable is an integer constant that can be folded
+ *
+ * @param _variable Variable to check
+ * @return int 1 if the variable is an integer constant
+ */
+static int expression_integer_constant( Variable * _variable ) {
+
+    return _variable->initializedByConstant && ( VT_BITWIDTH( _variable->type ) > 1 ) && ! VT_FIXED_TYPE( _variable->type );
+
+}
+
+/**
+ * @brief Check if a variable is a (non fixed point) integer of 8 or 16 bits
+ *
+ * @param _variable Variable to check
+ * @return int 1 if the variable can be strength reduced
+ */
+static int expression_small_integer( Variable * _variable ) {
+
+    return ( VT_BITWIDTH( _variable->type ) == 8 || VT_BITWIDTH( _variable->type ) == 16 ) && ! VT_FIXED_TYPE( _variable->type );
+
+}
+
+/**
+ * @brief Calculate the common type of two operands, as the arithmetic routines do
+ *
+ * @param _left Type of the left operand
+ * @param _right Type of the right operand
+ * @return VariableType The common type
+ */
+static VariableType expression_common_type( VariableType _left, VariableType _right ) {
+
+    if ( VT_SIGNED( _left ) || VT_SIGNED( _right ) ) {
+        return VT_SIGN( VT_MAX_BITWIDTH_TYPE( _left, _right ) );
+    } else {
+        return VT_MAX_BITWIDTH_TYPE( _left, _right );
+    }
+
+}
+
+/**
+ * @brief Calculate the type of a product, that doubles the width of the operands
+ *
+ * @param _type Common type of the operands (8 or 16 bits)
+ * @return VariableType The type of the product
+ */
+static VariableType expression_product_type( VariableType _type ) {
+
+    if ( VT_BITWIDTH( _type ) == 8 ) {
+        return VT_SIGNED( _type ) ? VT_SWORD : VT_WORD;
+    } else {
+        return VT_SIGNED( _type ) ? VT_SDWORD : VT_DWORD;
+    }
+
+}
+
+/**
+ * @brief Return the exponent of a power of two, or -1 if it is not
+ *
+ * @param _value Value to check
+ * @return int Exponent (0...30) or -1
+ */
+static int expression_log2( int _value ) {
+
+    int steps = 0;
+
+    if ( _value <= 0 || ( _value & ( _value - 1 ) ) ) {
+        return -1;
+    }
+
+    while( _value > 1 ) {
+        _value >>= 1;
+        ++steps;
+    }
+
+    return steps;
+
+}
+
+/**
+ * @brief Define a folded constant
+ *
+ * The constant takes the type that the emitted operation would give, and
+ * the value wraps around as it would at run time (so 200+100 between two
+ * bytes is a byte worth 44, and 5-10 is a byte worth 251).
+ *
+ * @param _environment Current calling environment
+ * @param _type Type of the result of the operation
+ * @param _value Exact value of the operation
+ * @return Variable* The constant
+ */
+static Variable * expression_constant( Environment * _environment, VariableType _type, int _value ) {
+
+    if ( VT_BITWIDTH( _type ) < 32 ) {
+        int mask = ( 1 << VT_BITWIDTH( _type ) ) - 1;
+        _value &= mask;
+        if ( VT_SIGNED( _type ) && ( _value & ~( mask >> 1 ) ) ) {
+            _value |= ~mask;
+        }
+    }
+
+    Variable * number = variable_temporary( _environment, _type, "(folded constant)" );
+    variable_store( _environment, number->name, _value );
+    number->initializedByConstant = 1;
+
+    return number;
+
+}
+
+/**
+ * @brief Write the value number of an operand
+ *
+ * @param _variable Operand
+ * @param _key Buffer for the value number
+ */
+static void expression_key( Variable * _variable, char * _key ) {
+
+    if ( expression_integer_constant( _variable ) ) {
+        sprintf( _key, "#%d:%d", _variable->type, _variable->value );
+    } else {
+        sprintf( _key, "%s", _variable->name );
+    }
+
+}
+
+/**
+ * @brief Look for an operation already emitted in the current statement
+ *
+ * @param _environment Current calling environment
+ * @param _operator Operator
+ * @param _left Left operand
+ * @param _right Right operand
+ * @param _commutative 1 if operands can be exchanged
+ * @return Variable* The variable with the result, or NULL if not found
+ */
+static Variable * expression_lookup( Environment * _environment, char _operator, Variable * _left, Variable * _right, int _commutative ) {
+
+    char left[MAX_TEMPORARY_STORAGE];
+    char right[MAX_TEMPORARY_STORAGE];
+
+    if ( ! expression_numeric( _left ) || ! expression_numeric( _right ) ) {
+        return NULL;
+    }
+
+    expression_key( _left, left );
+    expression_key( _right, right );
+
+    ValueNumber * actual = _environment->valueNumbers;
+    while( actual ) {
+        if ( actual->op == _operator ) {
+            if ( ! strcmp( actual->left, left ) && ! strcmp( actual->right, right ) ) {
+                return variable_retrieve( _environment, actual->result );
+            }
+            if ( _commutative && ! strcmp( actual->left, right ) && ! strcmp( actual->right, left ) ) {
+                return variable_retrieve( _environment, actual->result );
+            }
+        }
+        actual = actual->next;
+    }
+
+    return NULL;
+
+}
+
+/**
+ * @brief Remember the result of an operation for the current statement
+ *
+ * @param _environment Current calling environment
+ * @param _operator Operator
+ * @param _left Left operand
+ * @param _right Right operand
+ * @param _result Variable with the result
+ * @return Variable* The result
+ */
+static Variable * expression_remember( Environment * _environment, char _operator, Variable * _left, Variable * _right, Variable * _result ) {
+
+    char left[MAX_TEMPORARY_STORAGE];
+    char right[MAX_TEMPORARY_STORAGE];
+
+    if ( ! expression_numeric( _left ) || ! expression_numeric( _right ) || ! _result->temporary ) {
+        return _result;
+    }
+
+    expression_key( _left, left );
+    expression_key( _right, right );
+
+    ValueNumber * valueNumber = malloc( sizeof( ValueNumber ) );
+    memset( valueNumber, 0, sizeof( ValueNumber ) );
+    valueNumber->op = _operator;
+    valueNumber->left = strdup( left );
+    valueNumber->right = strdup( right );
+    valueNumber->result = strdup( _result->name );
+    valueNumber->next = _environment->valueNumbers;
+    _environment->valueNumbers = valueNumber;
+
+    return _result;
+
+}
+
+/**
+ * @brief Forget all the operations emitted in the current statement
+ *
+ * @param _environment Current calling environment
+ */
+void expression_reset( Environment * _environment ) {
+
+    ValueNumber * actual = _environment->valueNumbers;
+    while( actual ) {
+        ValueNumber * next = actual->next;
+        free( actual->left );
+        free( actual->right );
+        free( actual->result );
+        free( actual );
+        actual = next;
+    }
+    _environment->valueNumbers = NULL;
+
+}
+
+/**
+ * @brief Forget the operations that read a variable that has been assigned
+ *
+ * @param _environment Current calling environment
+ * @param _name Name of the assigned variable
+ */
+void expression_invalidate( Environment * _environment, char * _name ) {
+
+    ValueNumber ** previous = &_environment->valueNumbers;
+    ValueNumber * actual = _environment->valueNumbers;
+    while( actual ) {
+        ValueNumber * next = actual->next;
+        if ( ! strcmp( actual->left, _name ) || ! strcmp( actual->right, _name ) || ! strcmp( actual->result, _name ) ) {
+            *previous = next;
+            free( actual->left );
+            free( actual->right );
+            free( actual->result );
+            free( actual );
+        } else {
+            previous = &actual->next;
+        }
+        actual = next;
+    }
+
+}
+
+/**
+ * @brief Add a string to a pending concatenation
+ *
+ * If the concatenation is full, it is emitted and becomes the first
+ * string of a new one.
+ *
+ * @param _environment Current calling environment
+ * @param _result Pending concatenation (can be replaced)
+ * @param _piece String to add
+ */
+static void expression_concatenation_push( Environment * _environment, Variable ** _result, Variable * _piece ) {
+
+    if ( (*_result)->concatenationCount == MAX_CONCATENATION ) {
+        Variable * partial = *_result;
+        variable_concatenation_flush( _environment, partial );
+        *_result = variable_temporary( _environment, VT_DSTRING, "(result of sum)" );
+        (*_result)->concatenation[(*_result)->concatenationCount++] = partial;
+    }
+
+    (*_result)->concatenation[(*_result)->concatenationCount++] = _piece;
+
+}
+
+/**
+ * @brief Collect the strings of a sum into a single concatenation
+ *
+ * An operand that is itself a pending concatenation (the left one, in
+ * A$ + B$ + C$, or the right one if parenthesized) gives its strings
+ * instead of its result, and it is never emitted: only the expression
+ * that is being reduced refers to it.
+ *
+ * @param _environment Current calling environment
+ * @param _left Left string
+ * @param _right Right string
+ * @return Variable* The (pending) concatenation
+ */
+static Variable * expression_concatenate( Environment * _environment, Variable * _left, Variable * _right ) {
+
+    Variable * result = variable_temporary( _environment, VT_DSTRING, "(result of sum)" );
+
+    Variable * operands[2] = { _left, _right };
+    int i, j;
+
+    for( i=0; i<2; ++i ) {
+        if ( operands[i]->concatenationCount ) {
+            for( j=0; j<operands[i]->concatenationCount; ++j ) {
+                expression_concatenation_push( _environment, &result, operands[i]->concatenation[j] );
+            }
+            operands[i]->concatenationCount = 0;
+        } else {
+            expression_concatenation_push( _environment, &result, operands[i] );
+        }
+    }
+
+    return result;
+
+}
+
+/**
+ * @brief Emit the concatenations still pending in the current context
+ *
+ * It must be called before emitting code that could change the strings
+ * that a pending concatenation refers to (i.e. a procedure call).
+ *
+ * @param _environment Current calling environment
+ */
+void expression_flush( Environment * _environment ) {
+
+    Variable * actual = _environment->tempVariables[_environment->currentProcedure];
+    while( actual ) {
+        if ( actual->concatenationCount ) {
+            variable_concatenation_flush( _environment, actual );
+        }
+        actual = actual->next;
+    }
+
+}
+
+/**
+ * @brief Emit (or reuse) the sum of two expressions
+ *
+ * @param _environment Current calling environment
+ * @param _left Left operand's name
+ * @param _right Right operand's name
+ * @return Variable* The sum
+ */
+Variable * expression_add( Environment * _environment, char * _left, char * _right ) {
+
+    ++_environment->concatenationHold;
+    Variable * left = variable_retrieve( _environment, _left );
+    Variable * right = variable_retrieve( _environment, _right );
+    --_environment->concatenationHold;
+
+    if ( expression_string( left ) && expression_string( right ) ) {
+        return expression_concatenate( _environment, left, right );
+    }
+
+    left = variable_retrieve( _environment, _left );
+    right = variable_retrieve( _environment, _right );
+
+    Variable * result = expression_lookup( _environment, '+', left, right, 1 );
+    if ( result ) {
+        return result;
+    }
+
+    if ( expression_integer_constant( left ) && expression_integer_constant( right ) ) {
+        return expression_constant( _environment, expression_common_type( left->type, right->type ), left->value + right->value );
+    }
+
+    if ( expression_integer_constant( left ) && left->value == 0 && expression_small_integer( right ) ) {
+        return variable_cast( _environment, right->name, expression_common_type( left->type, right->type ) );
+    }
+
+    if ( expression_integer_constant( right ) ) {
+        if ( right->value == 0 && expression_small_integer( left ) ) {
+            return variable_cast( _environment, left->name, expression_common_type( left->type, right->type ) );
+        }
+        result = variable_add_const( _environment, left->name, right->value );
+    } else {
+        result = variable_add( _environment, left->name, right->name );
+    }
+
+    return expression_remember( _environment, '+', left, right, result );
+
+}
+
+/**
+ * @brief Emit (or reuse) the difference of two expressions
+ *
+ * @param _environment Current calling environment
+ * @param _left Left operand's name
+ * @param _right Right operand's name
+ * @return Variable* The difference
+ */
+Variable * expression_sub( Environment * _environment, char * _left, char * _right ) {
+
+    Variable * left = variable_retrieve( _environment, _left );
+    Variable * right = variable_retrieve( _environment, _right );
+
+    Variable * result = expression_lookup( _environment, '-', left, right, 0 );
+    if ( result ) {
+        return result;
+    }
+
+    if ( expression_integer_constant( left ) && expression_integer_constant( right ) ) {
+        return expression_constant( _environment, expression_common_type( left->type, right->type ), left->value - right->value );
+    }
+
+    if ( expression_integer_constant( right ) ) {
+        if ( right->value == 0 && expression_small_integer( left ) ) {
+            return variable_cast( _environment, left->name, expression_common_type( left->type, right->type ) );
+        }
+        result = variable_sub_const( _environment, left->name, right->value );
+    } else {
+        result = variable_sub( _environment, left->name, right->name );
+    }
+
+    return expression_remember( _environment, '-', left, right, result );
+
+}
+
+/**
+ * @brief Emit (or reuse) the product of two expressions
+ *
+ * A product by a power of two is emitted as a shift, on the same
+ * (double width) type that the multiplication would give.
+ *
+ * @param _environment Current calling environment
+ * @param _left Left operand's name
+ * @param _right Right operand's name
+ * @return Variable* The product
+ */
+Variable * expression_mul( Environment * _environment, char * _left, char * _right ) {
+
+    Variable * left = variable_retrieve( _environment, _left );
+    Variable * right = variable_retrieve( _environment, _right );
+
+    Variable * result = expression_lookup( _environment, '*', left, right, 1 );
+    if ( result ) {
+        return result;
+    }
+
+    if ( expression_integer_constant( left ) && expression_integer_constant( right ) ) {
+        VariableType productType = expression_common_type( left->type, right->type );
+        if ( VT_BITWIDTH( productType ) < 32 ) {
+            productType = expression_product_type( productType );
+        }
+        return expression_constant( _environment, productType, left->value * right->value );
+    }
+
+    // Take the constant (if any) on the right.
+    Variable * factor = right;
+    Variable * other = left;
+    if ( expression_integer_constant( left ) ) {
+        factor = left;
+        other = right;
+    }
+
+    if ( expression_integer_constant( factor ) && expression_small_integer( other ) && expression_small_integer( factor ) ) {
+        VariableType productType = expression_product_type( expression_common_type( other->type, factor->type ) );
+        if ( factor->value == 0 ) {
+            return expression_constant( _environment, productType, 0 );
+        }
+        int steps = expression_log2( factor->value );
+        if ( steps >= 0 ) {
+            Variable * widened = variable_cast( _environment, other->name, productType );
+            result = variable_mul2_const( _environment, widened->name, steps );
+            return expression_remember( _environment, '*', left, right, result );
+        }
+    }
+
+    result = variable_mul( _environment, left->name, right->name );
+
+    return expression_remember( _environment, '*', left, right, result );
+
+}
+
+/**
+ * @brief Emit (or reuse) the quotient of two expressions
+ *
+ * @param _environment Current calling environment
+ * @param _left Dividend's name
+ * @param _right Divisor's name
+ * @return Variable* The quotient
+ */
+Variable * expression_div( Environment * _environment, char * _left, char * _right ) {
+
+    Variable * left = variable_retrieve( _environment, _left );
+    Variable * right = variable_retrieve( _environment, _right );
+
+    Variable * result = expression_lookup( _environment, '/', left, right, 0 );
+    if ( result ) {
+        return result;
+    }
+
+    if ( expression_integer_constant( left ) && expression_integer_constant( right ) && left->value >= 0 && right->value > 0 ) {
+        return expression_constant( _environment, expression_common_type( left->type, right->type ), left->value / right->value );
+    }
+
+    // Only unsigned dividends can be shifted, since the signed division
+    // rounds toward zero. The quotient keeps the type of the dividend.
+    if ( expression_integer_constant( right ) && expression_small_integer( left ) && ! VT_SIGNED( left->type ) && ! VT_SIGNED( right->type ) ) {
+        int steps = expression_log2( right->value );
+        if ( steps == 0 ) {
+            return left;
+        } else if ( steps > 0 ) {
+            result = variable_div2_const( _environment, left->name, steps );
+            return expression_remember( _environment, '/', left, right, result );
+        }
+    }
+
+    result = variable_div( _environment, left->name, right->name, NULL );
+
+    return expression_remember( _environment, '/', left, right, result );
+
+}
+
+/**
+ * @brief Emit (or reuse) the remainder of the division of two expressions
+ *
+ * @param _environment Current calling environment
+ * @param _left Dividend's name
+ * @param _right Divisor's name
+ * @return Variable* The remainder
+ */
+Variable * expression_mod( Environment * _environment, char * _left, char * _right ) {
+
+    Variable * left = variable_retrieve( _environment, _left );
+    Variable * right = variable_retrieve( _environment, _right );
+
+    Variable * result = expression_lookup( _environment, '%', left, right, 0 );
+    if ( result ) {
+        return result;
+    }
+
+    if ( expression_integer_constant( left ) && expression_integer_constant( right ) && left->value >= 0 && right->value > 0 ) {
+        return expression_constant( _environment, expression_common_type( left->type, right->type ), left->value % right->value );
+    }
+
+    result = variable_mod( _environment, left->name, right->name );
+
+    return expression_remember( _environment, '%', left, right, result );
+
+}
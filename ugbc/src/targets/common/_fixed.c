@@ -0,0 +1,776 @@
+/*****************************************************************************
+ * ugBASIC - an isomorphic BASIC language compiler for retrocomputers        *
+ *****************************************************************************
+ * Copyright 2021-2024 Marco Spedaletti (asimov@mclink.it)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *----------------------------------------------------------------------------
+ * Concesso in licenza secondo i termini della Licenza Apache, versione 2.0
+ * (la "Licenza"); è proibito usare questo file se non in conformità alla
+ * Licenza. Una copia della Licenza è disponibile all'indirizzo:
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Se non richiesto dalla legislazione vigente o concordato per iscritto,
+ * il software distribuito nei termini della Licenza è distribuito
+ * "COSÌ COM'È", SENZA GARANZIE O CONDIZIONI DI ALCUN TIPO, esplicite o
+ * implicite. Consultare la Licenza per il testo specifico che regola le
+ * autorizzazioni e le limitazioni previste dalla medesima.
+ ****************************************************************************/
+
+/****************************************************************************
+ * INCLUDE SECTION
+ ****************************************************************************/
+
+#include "../../ugbc.h"
+#include <math.h>
+
+/****************************************************************************
+ * CODE SECTION
+ ****************************************************************************/
+
+extern char DATATYPE_AS_STRING[][16];
+
+/* <usermanual>
+@keyword FIXED
+
+@english
+The ''FIXED'' and ''DFIXED'' datatypes store signed fixed point numbers.
+A ''FIXED'' takes 16 bits, 8 for the integer part and 8 for the fraction
+(range -128...127.996, step 1/256), while a ''DFIXED'' takes 32 bits,
+16 for the integer part and 16 for the fraction (range -32768...32767.99998,
+step 1/65536). Sums, differences and comparisons cost exactly as much as the
+integer ones, and multiplications and divisions use the integer routines
+plus a shift, so they are a much faster alternative to ''FLOAT'' whenever
+the range is known in advance. ''SIN'', ''COS'' and ''TAN'' of a fixed point
+angle are read from a quarter-wave table (see ''DEFINE MATH'').
+
+Constants can be given with a cast: ''(FIXED)1.5'' is converted at compile
+time, while assigning a ''FLOAT'' expression converts it at runtime.
+
+@italian
+I tipi di dato ''FIXED'' e ''DFIXED'' memorizzano numeri con segno in
+virgola fissa. Un ''FIXED'' occupa 16 bit, 8 per la parte intera e 8 per
+la parte frazionaria (intervallo -128...127.996, passo 1/256), mentre un
+''DFIXED'' occupa 32 bit, 16 per la parte intera e 16 per quella frazionaria
+(intervallo -32768...32767.99998, passo 1/65536). Somme, differenze e confronti
+costano esattamente come quelli interi, mentre moltiplicazioni e divisioni
+usano le routine intere più uno scorrimento: sono quindi un'alternativa
+molto più veloce a ''FLOAT'' quando l'intervallo è noto in anticipo. ''SIN'',
+''COS'' e ''TAN'' di un angolo in virgola fissa vengono letti da una tabella
+di un quarto d'onda (vedi ''DEFINE MATH'').
+
+Le costanti possono essere indicate con un cast: ''(FIXED)1.5'' è convertito
+durante la compilazione, mentre assegnare un'espressione ''FLOAT'' comporta
+una conversione a tempo di esecuzione.
+
+@syntax DIM var AS FIXED
+@syntax DIM var AS DFIXED
+@syntax (FIXED)constant
+@syntax (DFIXED)(expression)
+
+@example DIM speed AS FIXED
+@example speed = (FIXED)1.25
+@example x = x + speed * SIN(angle)
+
+@target all
+</usermanual> */
+
+/**
+ * @brief Return the address of a 16 bit word of a 32 bit variable
+ *
+ * @param _environment Current calling environment
+ * @param _variable 32 bit variable
+ * @param _high 1 for the most significant word, 0 for the least one
+ * @return char* Address of the word
+ */
+static char * fixed_word( Environment * _environment, Variable * _variable, int _high ) {
+
+#ifdef CPU_BIG_ENDIAN
+    return address_displacement( _environment, _variable->realName, _high ? "0" : "2" );
+#else
+    return address_displacement( _environment, _variable->realName, _high ? "2" : "0" );
+#endif
+
+}
+
+/**
+ * @brief Return the address of a byte of a 32 bit variable
+ *
+ * @param _environment Current calling environment
+ * @param _variable 32 bit variable
+ * @param _byte Byte number, where 0 is the least significant one
+ * @return char* Address of the byte
+ */
+static char * fixed_byte( Environment * _environment, Variable * _variable, int _byte ) {
+
+    char displacement[MAX_TEMPORARY_STORAGE];
+
+#ifdef CPU_BIG_ENDIAN
+    sprintf( displacement, "%d", 3 - _byte );
+#else
+    sprintf( displacement, "%d", _byte );
+#endif
+
+    return address_displacement( _environment, _variable->realName, displacement );
+
+}
+
+/**
+ * @brief Copy the raw content of a fixed point variable into a signed integer one
+ *
+ * The integer is taken with the same bitwidth of the fixed point type,
+ * so that the usual signed routines (that are driven by the datatype)
+ * can be used on it without any conversion.
+ *
+ * @param _environment Current calling environment
+ * @param _source Fixed point variable
+ * @return Variable* Integer variable with the same bits
+ */
+static Variable * fixed_raw( Environment * _environment, Variable * _source ) {
+
+    Variable * raw;
+
+    if ( _source->type == VT_DFIXED ) {
+        raw = variable_temporary( _environment, VT_SDWORD, "(fixed)" );
+        cpu_move_32bit( _environment, _source->realName, raw->realName );
+    } else {
+        raw = variable_temporary( _environment, VT_SWORD, "(fixed)" );
+        cpu_move_16bit( _environment, _source->realName, raw->realName );
+    }
+
+    return raw;
+
+}
+
+/**
+ * @brief Convert between fixed point and any other numeric datatype
+ *
+ * This function is called by ''variable_move'' every time one of the
+ * two variables is a fixed point and the other has a different datatype.
+ * Integers are scaled by shifting them, so no multiplication is needed.
+ * The conversions from and to ''FLOAT'' are made by passing through
+ * a 16 bit value, since this is the widest integer that the floating
+ * point libraries are able to convert: so a ''DFIXED'' exchanged with a
+ * ''FLOAT'' is limited to the range of a ''FIXED''.
+ *
+ * @param _environment Current calling environment
+ * @param _source Source variable
+ * @param _target Target variable
+ */
+void variable_move_fixed( Environment * _environment, Variable * _source, Variable * _target ) {
+
+    if ( VT_FIXED_TYPE( _target->type ) ) {
+
+        int shift = VT_FIXED_SHIFT( _target->type );
+
+        if ( VT_FIXED_TYPE( _source->type ) ) {
+
+            // 8.8 <-> 16.16: sign extension (or truncation) and 8 bit shift.
+
+            Variable * raw = fixed_raw( _environment, _source );
+            Variable * wide = variable_temporary( _environment, VT_SDWORD, "(fixed)" );
+            variable_move( _environment, raw->name, wide->name );
+            if ( _target->type == VT_DFIXED ) {
+                cpu_math_mul2_const_32bit( _environment, wide->realName, 8, 1 );
+                cpu_move_32bit( _environment, wide->realName, _target->realName );
+            } else {
+                cpu_math_div2_const_32bit( _environment, wide->realName, 8, 1 );
+                cpu_move_16bit( _environment, fixed_word( _environment, wide, 0 ), _target->realName );
+            }
+
+        } else if ( _source->type == VT_FLOAT ) {
+
+            Variable * scale = variable_temporary( _environment, VT_FLOAT, "(fixed scale)" );
+            Variable * scaled = variable_temporary( _environment, VT_FLOAT, "(fixed)" );
+            Variable * fixed = variable_temporary( _environment, VT_FIXED, "(fixed)" );
+            variable_store_float( _environment, scale->name, 256.0 );
+            switch( _source->precision ) {
+                case FT_FAST:
+                    cpu_float_fast_mul( _environment, _source->realName, scale->realName, scaled->realName );
+                    cpu_float_fast_to_16( _environment, scaled->realName, fixed->realName, 1 );
+                    break;
+                case FT_SINGLE:
+                    cpu_float_single_mul( _environment, _source->realName, scale->realName, scaled->realName );
+                    cpu_float_single_to_16( _environment, scaled->realName, fixed->realName, 1 );
+                    break;
+            }
+            variable_move( _environment, fixed->name, _target->name );
+
+        } else if ( VT_BITWIDTH( _source->type ) > 1 ) {
+
+            if ( _source->initializedByConstant ) {
+                variable_store( _environment, _target->name, ( (unsigned int) _source->value ) << shift );
+            } else {
+                Variable * raw = variable_temporary( _environment, _target->type == VT_DFIXED ? VT_SDWORD : VT_SWORD, "(fixed)" );
+                variable_move( _environment, _source->name, raw->name );
+                if ( _target->type == VT_DFIXED ) {
+                    cpu_math_mul2_const_32bit( _environment, raw->realName, shift, 1 );
+                    cpu_move_32bit( _environment, raw->realName, _target->realName );
+                } else {
+                    cpu_math_mul2_const_16bit( _environment, raw->realName, shift, 1 );
+                    cpu_move_16bit( _environment, raw->realName, _target->realName );
+                }
+            }
+
+        } else {
+            CRITICAL_CANNOT_CAST( DATATYPE_AS_STRING[_source->type], DATATYPE_AS_STRING[_target->type] );
+        }
+
+    } else {
+
+        int shift = VT_FIXED_SHIFT( _source->type );
+
+        if ( _target->type == VT_FLOAT ) {
+
+            Variable * fixed = _source;
+            if ( _source->type == VT_DFIXED ) {
+                fixed = variable_temporary( _environment, VT_FIXED, "(fixed)" );
+                variable_move( _environment, _source->name, fixed->name );
+            }
+            Variable * scale = variable_temporary( _environment, VT_FLOAT, "(fixed scale)" );
+            Variable * unscaled = variable_temporary( _environment, VT_FLOAT, "(fixed)" );
+            variable_store_float( _environment, scale->name, 1.0 / 256.0 );
+            switch( _target->precision ) {
+                case FT_FAST:
+                    cpu_float_fast_from_16( _environment, fixed->realName, unscaled->realName, 1 );
+                    cpu_float_fast_mul( _environment, unscaled->realName, scale->realName, _target->realName );
+                    break;
+                case FT_SINGLE:
+                    cpu_float_single_from_16( _environment, fixed->realName, unscaled->realName, 1 );
+                    cpu_float_single_mul( _environment, unscaled->realName, scale->realName, _target->realName );
+                    break;
+            }
+
+        } else if ( VT_BITWIDTH( _target->type ) > 1 ) {
+
+            // The arithmetic shift rounds toward minus infinity, like INT().
+
+            Variable * raw = fixed_raw( _environment, _source );
+            if ( _source->type == VT_DFIXED ) {
+                cpu_math_div2_const_32bit( _environment, raw->realName, shift, 1 );
+            } else {
+                cpu_math_div2_const_16bit( _environment, raw->realName, shift, 1 );
+            }
+            variable_move( _environment, raw->name, _target->name );
+
+        } else {
+            CRITICAL_CANNOT_CAST( DATATYPE_AS_STRING[_source->type], DATATYPE_AS_STRING[_target->type] );
+        }
+
+    }
+
+}
+
+/**
+ * @brief Multiply two signed 32 bit values and shift the product
+ *
+ * The CPU libraries offer only a 16 x 16 bit multiplication, so the
+ * magnitudes are split in words and the (up to) four partial products
+ * are summed back with the right weight. The sign is applied at the end.
+ *
+ * @param _environment Current calling environment
+ * @param _source First factor (32 bit)
+ * @param _target Second factor (32 bit)
+ * @param _shift 16 to drop the extra fraction of a 16.16 product, 0 otherwise
+ * @param _result Where to store the lower 32 bits of the shifted product
+ */
+static void fixed_mul_32bit( Environment * _environment, Variable * _source, Variable * _target, int _shift, Variable * _result ) {
+
+    MAKE_LABEL
+
+    char positiveLabel[MAX_TEMPORARY_STORAGE]; sprintf( positiveLabel, "%spos", label );
+    char endLabel[MAX_TEMPORARY_STORAGE]; sprintf( endLabel, "%send", label );
+
+    Variable * mixed = variable_temporary( _environment, VT_SDWORD, "(sign)" );
+    Variable * negative = variable_temporary( _environment, VT_BYTE, "(sign)" );
+    cpu_xor_32bit( _environment, _source->realName, _target->realName, mixed->realName );
+    cpu_bit_check( _environment, mixed->realName, 31, negative->realName, 32 );
+
+    Variable * a = absolute( _environment, _source->name );
+    Variable * b = absolute( _environment, _target->name );
+
+    Variable * low = variable_temporary( _environment, VT_DWORD, "(partial product)" );
+    Variable * middle1 = variable_temporary( _environment, VT_DWORD, "(partial product)" );
+    Variable * middle2 = variable_temporary( _environment, VT_DWORD, "(partial product)" );
+    Variable * magnitude = variable_temporary( _environment, VT_DWORD, "(product)" );
+
+    cpu_math_mul_16bit_to_32bit( _environment, fixed_word( _environment, a, 0 ), fixed_word( _environment, b, 0 ), low->realName, 0 );
+    cpu_math_mul_16bit_to_32bit( _environment, fixed_word( _environment, a, 1 ), fixed_word( _environment, b, 0 ), middle1->realName, 0 );
+    cpu_math_mul_16bit_to_32bit( _environment, fixed_word( _environment, a, 0 ), fixed_word( _environment, b, 1 ), middle2->realName, 0 );
+
+    if ( _shift ) {
+        Variable * high = variable_temporary( _environment, VT_DWORD, "(partial product)" );
+        Variable * carry = variable_temporary( _environment, VT_DWORD, "(partial product)" );
+        cpu_math_mul_16bit_to_32bit( _environment, fixed_word( _environment, a, 1 ), fixed_word( _environment, b, 1 ), high->realName, 0 );
+        cpu_store_32bit( _environment, magnitude->realName, 0 );
+        cpu_move_16bit( _environment, fixed_word( _environment, high, 0 ), fixed_word( _environment, magnitude, 1 ) );
+        cpu_math_add_32bit( _environment, magnitude->realName, middle1->realName, magnitude->realName );
+        cpu_math_add_32bit( _environment, magnitude->realName, middle2->realName, magnitude->realName );
+        cpu_store_32bit( _environment, carry->realName, 0 );
+        cpu_move_16bit( _environment, fixed_word( _environment, low, 1 ), fixed_word( _environment, carry, 0 ) );
+        cpu_math_add_32bit( _environment, magnitude->realName, carry->realName, magnitude->realName );
+    } else {
+        cpu_math_add_32bit( _environment, middle1->realName, middle2->realName, middle1->realName );
+        cpu_move_32bit( _environment, low->realName, magnitude->realName );
+        cpu_math_add_16bit( _environment, fixed_word( _environment, magnitude, 1 ), fixed_word( _environment, middle1, 0 ), fixed_word( _environment, magnitude, 1 ) );
+    }
+
+    cpu_bveq( _environment, negative->realName, positiveLabel );
+    cpu_complement2_32bit( _environment, magnitude->realName, _result->realName );
+    cpu_jump( _environment, endLabel );
+    cpu_label( _environment, positiveLabel );
+    cpu_move_32bit( _environment, magnitude->realName, _result->realName );
+    cpu_label( _environment, endLabel );
+
+}
+
+/**
+ * @brief Divide an unsigned 32 bit value by an unsigned 16 bit one
+ *
+ * The CPU libraries offer a 32 / 16 bit division with a 16 bit quotient,
+ * so the division is made in two steps (long division by words): the
+ * remainder of the first step is always less than the divisor, and this
+ * guarantees that the quotient of the second step fits in 16 bits.
+ *
+ * @param _environment Current calling environment
+ * @param _source Dividend (32 bit)
+ * @param _target Divisor (16 bit)
+ * @param _quotient Quotient (32 bit)
+ * @param _remainder Remainder (16 bit)
+ */
+static void fixed_div_32bit_16bit( Environment * _environment, Variable * _source, Variable * _target, Variable * _quotient, Variable * _remainder ) {
+
+    Variable * part = variable_temporary( _environment, VT_DWORD, "(partial dividend)" );
+    Variable * quotient = variable_temporary( _environment, VT_WORD, "(partial quotient)" );
+    Variable * remainder = variable_temporary( _environment, VT_WORD, "(partial remainder)" );
+
+    cpu_store_32bit( _environment, part->realName, 0 );
+    cpu_move_16bit( _environment, fixed_word( _environment, _source, 1 ), fixed_word( _environment, part, 0 ) );
+    cpu_math_div_32bit_to_16bit( _environment, part->realName, _target->realName, quotient->realName, remainder->realName, 0 );
+    cpu_move_16bit( _environment, quotient->realName, fixed_word( _environment, _quotient, 1 ) );
+
+    cpu_move_16bit( _environment, remainder->realName, fixed_word( _environment, part, 1 ) );
+    cpu_move_16bit( _environment, fixed_word( _environment, _source, 0 ), fixed_word( _environment, part, 0 ) );
+    cpu_math_div_32bit_to_16bit( _environment, part->realName, _target->realName, quotient->realName, _remainder->realName, 0 );
+    cpu_move_16bit( _environment, quotient->realName, fixed_word( _environment, _quotient, 0 ) );
+
+}
+
+/**
+ * @brief Multiply two numbers when (at least) one of them is a fixed point
+ *
+ * The result has the widest fixed point type of the two operands. A fixed
+ * point multiplied by an integer is already correctly scaled, while the
+ * product of two fixed point numbers is shifted back by the fractional bits.
+ *
+ * @param _environment Current calling environment
+ * @param _source First factor
+ * @param _target Second factor
+ * @return Variable* The product
+ */
+Variable * variable_mul_fixed( Environment * _environment, Variable * _source, Variable * _target ) {
+
+    VariableType type = VT_MAX_BITWIDTH_TYPE( _source->type, _target->type );
+
+    Variable * fixed = VT_FIXED_TYPE( _source->type ) ? _source : _target;
+    Variable * other = ( fixed == _source ) ? _target : _source;
+
+    Variable * result = variable_temporary( _environment, type, "(result of multiplication)" );
+
+    fixed = variable_cast( _environment, fixed->name, type );
+
+    if ( type == VT_FIXED ) {
+
+        Variable * product = variable_temporary( _environment, VT_SDWORD, "(product)" );
+
+        if ( VT_FIXED_TYPE( other->type ) ) {
+            cpu_math_mul_16bit_to_32bit( _environment, fixed->realName, other->realName, product->realName, 1 );
+            cpu_math_div2_const_32bit( _environment, product->realName, 8, 1 );
+        } else {
+            other = variable_cast( _environment, other->name, VT_SWORD );
+            cpu_math_mul_16bit_to_32bit( _environment, fixed->realName, other->realName, product->realName, 1 );
+        }
+
+        cpu_move_16bit( _environment, fixed_word( _environment, product, 0 ), result->realName );
+
+    } else {
+
+        if ( VT_FIXED_TYPE( other->type ) ) {
+            other = variable_cast( _environment, other->name, VT_DFIXED );
+            fixed_mul_32bit( _environment, fixed_raw( _environment, fixed ), fixed_raw( _environment, other ), 16, result );
+        } else {
+            other = variable_cast( _environment, other->name, VT_SDWORD );
+            fixed_mul_32bit( _environment, fixed_raw( _environment, fixed ), other, 0, result );
+        }
+
+    }
+
+    return result;
+
+}
+
+/**
+ * @brief Divide two numbers when (at least) one of them is a fixed point
+ *
+ * The result has the widest fixed point type of the two operands. A fixed
+ * point divided by an integer is already correctly scaled, while the
+ * dividend is shifted left by the fractional bits before dividing by
+ * another fixed point. For ''DFIXED'' divisors, the CPU libraries allow
+ * only a 16 bit divisor: so the lower 8 fractional bits are dropped and
+ * the divisor must be in the range of a ''FIXED''.
+ *
+ * @param _environment Current calling environment
+ * @param _source Dividend
+ * @param _target Divisor
+ * @return Variable* The quotient
+ */
+Variable * variable_div_fixed( Environment * _environment, Variable * _source, Variable * _target ) {
+
+    VariableType type = VT_MAX_BITWIDTH_TYPE( _source->type, _target->type );
+
+    Variable * result = variable_temporary( _environment, type, "(result of division)" );
+
+    Variable * dividend = fixed_raw( _environment, variable_cast( _environment, _source->name, type ) );
+
+    if ( type == VT_FIXED ) {
+
+        Variable * remainder = variable_temporary( _environment, VT_SWORD, "(remainder of division)" );
+
+        if ( VT_FIXED_TYPE( _target->type ) ) {
+            Variable * scaled = variable_temporary( _environment, VT_SDWORD, "(dividend)" );
+            Variable * divisor = fixed_raw( _environment, variable_cast( _environment, _target->name, VT_FIXED ) );
+            variable_move( _environment, dividend->name, scaled->name );
+            cpu_math_mul2_const_32bit( _environment, scaled->realName, 8, 1 );
+            cpu_math_div_32bit_to_16bit( _environment, scaled->realName, divisor->realName, result->realName, remainder->realName, 1 );
+        } else {
+            Variable * divisor = variable_cast( _environment, _target->name, VT_SWORD );
+            cpu_math_div_16bit_to_16bit( _environment, dividend->realName, divisor->realName, result->realName, remainder->realName, 1 );
+        }
+
+    } else {
+
+        MAKE_LABEL
+
+        char positiveLabel[MAX_TEMPORARY_STORAGE]; sprintf( positiveLabel, "%spos", label );
+        char endLabel[MAX_TEMPORARY_STORAGE]; sprintf( endLabel, "%send", label );
+
+        Variable * divisor = variable_temporary( _environment, VT_SWORD, "(divisor)" );
+
+        if ( VT_FIXED_TYPE( _target->type ) ) {
+            // The middle word of a 16.16 is the 8.8 value, on both endianness.
+            Variable * wide = variable_cast( _environment, _target->name, VT_DFIXED );
+            cpu_move_16bit( _environment, address_displacement( _environment, wide->realName, "1" ), divisor->realName );
+        } else {
+            variable_move( _environment, variable_cast( _environment, _target->name, VT_SWORD )->name, divisor->name );
+        }
+
+        Variable * dividendSign = variable_temporary( _environment, VT_BYTE, "(sign)" );
+        Variable * divisorSign = variable_temporary( _environment, VT_BYTE, "(sign)" );
+        Variable * negative = variable_temporary( _environment, VT_BYTE, "(sign)" );
+        cpu_bit_check( _environment, dividend->realName, 31, dividendSign->realName, 32 );
+        cpu_bit_check( _environment, divisor->realName, 15, divisorSign->realName, 16 );
+        cpu_xor_8bit( _environment, dividendSign->realName, divisorSign->realName, negative->realName );
+
+        Variable * a = absolute( _environment, dividend->name );
+        Variable * b = absolute( _environment, divisor->name );
+
+        Variable * quotient = variable_temporary( _environment, VT_DWORD, "(quotient)" );
+        Variable * remainder = variable_temporary( _environment, VT_WORD, "(remainder)" );
+
+        fixed_div_32bit_16bit( _environment, a, b, quotient, remainder );
+
+        if ( VT_FIXED_TYPE( _target->type ) ) {
+            // Restore the 8 bits lost by the 8.8 divisor, by going on
+            // with the long division on the remainder.
+            Variable * part = variable_temporary( _environment, VT_DWORD, "(partial dividend)" );
+            Variable * fraction = variable_temporary( _environment, VT_DWORD, "(fraction)" );
+            Variable * unused = variable_temporary( _environment, VT_WORD, "(remainder)" );
+            cpu_store_32bit( _environment, part->realName, 0 );
+            cpu_move_16bit( _environment, remainder->realName, fixed_word( _environment, part, 0 ) );
+            cpu_math_mul2_const_32bit( _environment, part->realName, 8, 0 );
+            cpu_store_32bit( _environment, fraction->realName, 0 );
+            cpu_math_div_32bit_to_16bit( _environment, part->realName, b->realName, fixed_word( _environment, fraction, 0 ), unused->realName, 0 );
+            cpu_math_mul2_const_32bit( _environment, quotient->realName, 8, 0 );
+            cpu_math_add_32bit( _environment, quotient->realName, fraction->realName, quotient->realName );
+        }
+
+        cpu_bveq( _environment, negative->realName, positiveLabel );
+        cpu_complement2_32bit( _environment, quotient->realName, result->realName );
+        cpu_jump( _environment, endLabel );
+        cpu_label( _environment, positiveLabel );
+        cpu_move_32bit( _environment, quotient->realName, result->realName );
+        cpu_label( _environment, endLabel );
+
+    }
+
+    return result;
+
+}
+
+/**
+ * @brief Check if SIN / COS / TAN of an angle must use the table
+ *
+ * Fixed point angles always use the table. Integer and ''FLOAT'' angles
+ * use it only with ''DEFINE MATH FAST'', since the result is a ''FIXED''
+ * and would change the precision (and the range) of existing programs.
+ *
+ * @param _environment Current calling environment
+ * @param _angle Angle
+ * @return int 1 if the table must be used, 0 otherwise
+ */
+int fixed_sin_applies( Environment * _environment, Variable * _angle ) {
+
+    if ( VT_FIXED_TYPE( _angle->type ) ) {
+        return 1;
+    }
+
+    if ( _environment->mathMode == MATH_MODE_FAST ) {
+        return ( _angle->type == VT_FLOAT ) || ( VT_BITWIDTH( _angle->type ) > 1 );
+    }
+
+    return 0;
+
+}
+
+/**
+ * @brief Calculate the sine (or cosine) of a binary angle
+ *
+ * A binary angle divides the whole turn in 256 steps, so that it can be
+ * wrapped for free. The value is read from a quarter-wave table of 65
+ * words (Q2.14), stored once in the program: the other three quarters
+ * are obtained by mirroring the index and by changing the sign.
+ * The cosine is the same table, shifted by a quarter of a turn.
+ *
+ * @param _environment Current calling environment
+ * @param _binary Binary angle (BYTE)
+ * @param _type Type of the result (FIXED or DFIXED)
+ * @param _cosine 1 to calculate the cosine, 0 for the sine
+ * @return Variable* The sine (or cosine) of the angle
+ */
+static Variable * fixed_sin_binary( Environment * _environment, Variable * _binary, VariableType _type, int _cosine ) {
+
+    if ( ! _environment->fixedSinTable ) {
+
+        // Q2.14 values, that can be scaled to both 8.8 and 16.16 by shifting.
+
+        unsigned char table[130];
+        int i;
+        for( i=0; i<65; ++i ) {
+            int value = (int) round( sin( M_PI * i / 128 ) * 16384 );
+#ifdef CPU_BIG_ENDIAN
+            table[2*i] = ( value >> 8 ) & 0xff;
+            table[2*i+1] = value & 0xff;
+#else
+            table[2*i] = value & 0xff;
+            table[2*i+1] = ( value >> 8 ) & 0xff;
+#endif
+        }
+
+        _environment->fixedSinTable = variable_temporary( _environment, VT_BUFFER, "(table of sines)" );
+        variable_store_buffer( _environment, _environment->fixedSinTable->name, table, 130, 0 );
+
+    }
+
+    MAKE_LABEL
+
+    char risingLabel[MAX_TEMPORARY_STORAGE]; sprintf( risingLabel, "%sris", label );
+    char positiveLabel[MAX_TEMPORARY_STORAGE]; sprintf( positiveLabel, "%spos", label );
+    char endLabel[MAX_TEMPORARY_STORAGE]; sprintf( endLabel, "%send", label );
+
+    Variable * angle = variable_temporary( _environment, VT_BYTE, "(binary angle)" );
+    Variable * index = variable_temporary( _environment, VT_BYTE, "(index)" );
+    Variable * flag = variable_temporary( _environment, VT_BYTE, "(quadrant)" );
+    Variable * quarter = variable_temporary( _environment, VT_BYTE, "(quarter)" );
+    Variable * value = variable_temporary( _environment, VT_SWORD, "(sin)" );
+    Variable * result = variable_temporary( _environment, _type, "(sin)" );
+
+    if ( _cosine ) {
+        cpu_math_add_8bit_const( _environment, _binary->realName, 64, angle->realName );
+    } else {
+        cpu_move_8bit( _environment, _binary->realName, angle->realName );
+    }
+
+    // Second and fourth quarters go backward on the table.
+
+    cpu_move_8bit( _environment, angle->realName, index->realName );
+    cpu_math_and_const_8bit( _environment, index->realName, 0x3f );
+    cpu_bit_check( _environment, angle->realName, 6, flag->realName, 8 );
+    cpu_bveq( _environment, flag->realName, risingLabel );
+    cpu_store_8bit( _environment, quarter->realName, 64 );
+    cpu_math_sub_8bit( _environment, quarter->realName, index->realName, index->realName );
+    cpu_label( _environment, risingLabel );
+
+    cpu_move_16bit_indirect2_8bit( _environment, _environment->fixedSinTable->realName, index->realName, value->realName );
+
+    // Third and fourth quarters are negative.
+
+    cpu_bit_check( _environment, angle->realName, 7, flag->realName, 8 );
+
+    if ( _type == VT_FIXED ) {
+        cpu_math_add_16bit_const( _environment, value->realName, 32, value->realName );
+        cpu_math_div2_const_16bit( _environment, value->realName, 6, 0 );
+        cpu_bveq( _environment, flag->realName, positiveLabel );
+        cpu_complement2_16bit( _environment, value->realName, result->realName );
+        cpu_jump( _environment, endLabel );
+        cpu_label( _environment, positiveLabel );
+        cpu_move_16bit( _environment, value->realName, result->realName );
+    } else {
+        Variable * wide = variable_temporary( _environment, VT_SDWORD, "(sin)" );
+        variable_move( _environment, value->name, wide->name );
+        cpu_math_mul2_const_32bit( _environment, wide->realName, 2, 1 );
+        cpu_bveq( _environment, flag->realName, positiveLabel );
+        cpu_complement2_32bit( _environment, wide->realName, result->realName );
+        cpu_jump( _environment, endLabel );
+        cpu_label( _environment, positiveLabel );
+        cpu_move_32bit( _environment, wide->realName, result->realName );
+    }
+
+    cpu_label( _environment, endLabel );
+
+    return result;
+
+}
+
+/**
+ * @brief Calculate the sine (or cosine) of an angle, using the table
+ *
+ * The angle is converted into a binary angle (256 steps for a whole turn)
+ * with a single 16 bit multiplication by a constant, taking the right
+ * byte of the product: this also wraps the angle for free. ''FLOAT''
+ * angles are scaled and converted to an integer, instead.
+ * The result has the same type of the angle if it is a fixed point,
+ * otherwise it is a ''FIXED''.
+ *
+ * @param _environment Current calling environment
+ * @param _angle Angle (in degrees or radians, following DEFINE DEGREE / RADIAN)
+ * @param _cosine 1 to calculate the cosine, 0 for the sine
+ * @return Variable* The sine (or cosine) of the angle
+ */
+Variable * fixed_sin( Environment * _environment, Variable * _angle, int _cosine ) {
+
+    int degrees = ( _environment->floatType.angle == FT_DEGREE );
+
+    Variable * binary = variable_temporary( _environment, VT_BYTE, "(binary angle)" );
+
+    if ( _angle->type == VT_FLOAT ) {
+
+        Variable * scale = variable_temporary( _environment, VT_FLOAT, "(angle to binary)" );
+        Variable * scaled = variable_temporary( _environment, VT_FLOAT, "(angle to binary)" );
+        Variable * turns = variable_temporary( _environment, VT_SWORD, "(angle to binary)" );
+        variable_store_float( _environment, scale->name, degrees ? ( 256.0 / 360.0 ) : ( 128.0 / M_PI ) );
+        switch( _angle->precision ) {
+            case FT_FAST:
+                cpu_float_fast_mul( _environment, _angle->realName, scale->realName, scaled->realName );
+                cpu_float_fast_to_16( _environment, scaled->realName, turns->realName, 1 );
+                break;
+            case FT_SINGLE:
+                cpu_float_single_mul( _environment, _angle->realName, scale->realName, scaled->realName );
+                cpu_float_single_to_16( _environment, scaled->realName, turns->realName, 1 );
+                break;
+        }
+#ifdef CPU_BIG_ENDIAN
+        cpu_move_8bit( _environment, address_displacement( _environment, turns->realName, "1" ), binary->realName );
+#else
+        cpu_move_8bit( _environment, turns->realName, binary->realName );
+#endif
+
+    } else {
+
+        // 65536 / 360 = 182 and 65536 / ( 2 * PI ) = 10430: the product
+        // holds the binary angle in the byte above the fractional bits.
+
+        Variable * factor = variable_temporary( _environment, VT_SWORD, "(angle to binary)" );
+        Variable * product = variable_temporary( _environment, VT_SDWORD, "(angle to binary)" );
+        variable_store( _environment, factor->name, degrees ? 182 : 10430 );
+
+        if ( _angle->type == VT_FIXED ) {
+            cpu_math_mul_16bit_to_32bit( _environment, _angle->realName, factor->realName, product->realName, 1 );
+            cpu_move_8bit( _environment, fixed_byte( _environment, product, 2 ), binary->realName );
+        } else if ( _angle->type == VT_DFIXED ) {
+            if ( degrees ) {
+                // Integer part only: the binary angle is coarser than a degree.
+                cpu_math_mul_16bit_to_32bit( _environment, fixed_word( _environment, _angle, 1 ), factor->realName, product->realName, 1 );
+                cpu_move_8bit( _environment, fixed_byte( _environment, product, 1 ), binary->realName );
+            } else {
+                // The middle word of a 16.16 is the 8.8 value, on both endianness.
+                cpu_math_mul_16bit_to_32bit( _environment, address_displacement( _environment, _angle->realName, "1" ), factor->realName, product->realName, 1 );
+                cpu_move_8bit( _environment, fixed_byte( _environment, product, 2 ), binary->realName );
+            }
+        } else {
+            Variable * integer = variable_cast( _environment, _angle->name, VT_SWORD );
+            cpu_math_mul_16bit_to_32bit( _environment, integer->realName, factor->realName, product->realName, 1 );
+            cpu_move_8bit( _environment, fixed_byte( _environment, product, 1 ), binary->realName );
+        }
+
+    }
+
+    return fixed_sin_binary( _environment, binary, VT_FIXED_TYPE( _angle->type ) ? _angle->type : VT_FIXED, _cosine );
+
+}
+
+/**
+ * @brief Calculate the tangent of an angle, using the table
+ *
+ * The tangent is the ratio between the sine and the cosine taken from
+ * the table. At 90 and 270 degrees the cosine is zero, and the result
+ * saturates to the largest (or the smallest) value of the type.
+ *
+ * @param _environment Current calling environment
+ * @param _angle Angle (in degrees or radians, following DEFINE DEGREE / RADIAN)
+ * @return Variable* The tangent of the angle
+ */
+Variable * fixed_tan( Environment * _environment, Variable * _angle ) {
+
+    MAKE_LABEL
+
+    char zeroLabel[MAX_TEMPORARY_STORAGE]; sprintf( zeroLabel, "%szero", label );
+    char negativeLabel[MAX_TEMPORARY_STORAGE]; sprintf( negativeLabel, "%sneg", label );
+    char endLabel[MAX_TEMPORARY_STORAGE]; sprintf( endLabel, "%send", label );
+
+    Variable * sine = fixed_sin( _environment, _angle, 0 );
+    Variable * cosine = fixed_sin( _environment, _angle, 1 );
+    Variable * result = variable_temporary( _environment, sine->type, "(tan)" );
+
+    // The cosine is zero only where the sine is exactly +1 or -1.
+
+    if ( sine->type == VT_FIXED ) {
+        cpu_compare_and_branch_16bit_const( _environment, cosine->realName, 0, zeroLabel, 1 );
+    } else {
+        cpu_compare_and_branch_32bit_const( _environment, cosine->realName, 0, zeroLabel, 1 );
+    }
+
+    Variable * quotient = variable_div_fixed( _environment, sine, cosine );
+    variable_move( _environment, quotient->name, result->name );
+    cpu_jump( _environment, endLabel );
+
+    cpu_label( _environment, zeroLabel );
+    if ( sine->type == VT_FIXED ) {
+        cpu_compare_and_branch_16bit_const( _environment, sine->realName, 0x0100, negativeLabel, 0 );
+        cpu_store_16bit( _environment, result->realName, 0x7fff );
+        cpu_jump( _environment, endLabel );
+        cpu_label( _environment, negativeLabel );
+        cpu_store_16bit( _environment, result->realName, 0x8001 );
+    } else {
+        cpu_compare_and_branch_32bit_const( _environment, sine->realName, 0x00010000, negativeLabel, 0 );
+        cpu_store_32bit( _environment, result->realName, 0x7fffffff );
+        cpu_jump( _environment, endLabel );
+        cpu_label( _environment, negativeLabel );
+        cpu_store_32bit( _environment, result->realName, 0x80000001 );
+    }
+
+    cpu_label( _environment, endLabel );
+
+    return result;
+
+}
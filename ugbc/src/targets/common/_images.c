@@ -0,0 +1,436 @@
+/*****************************************************************************
+ * ugBASIC - an isomorphic BASIC language compiler for retrocomputers        *
+ *****************************************************************************
+ * Copyright 2021-2024 Marco Spedaletti (asimov@mclink.it)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *----------------------------------------------------------------------------
+ * Concesso in licenza secondo i termini della Licenza Apache, versione 2.0
+ * (la "Licenza"); è proibito usare questo file se non in conformità alla
+ * Licenza. Una copia della Licenza è disponibile all'indirizzo:
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Se non richiesto dalla legislazione vigente o concordato per iscritto,
+ * il software distribuito nei termini della Licenza è distribuito
+ * "COSÌ COM'È", SENZA GARANZIE O CONDIZIONI DI ALCUN TIPO, esplicite o
+ * implicite. Consultare la Licenza per il testo specifico che regola le
+ * autorizzazioni e le limitazioni previste dalla medesima.
+ ****************************************************************************/
+
+/****************************************************************************
+ * INCLUDE SECTION 
+ ****************************************************************************/
+
+
+#include "../../ugbc.h"
+#include "../../libs/stb_image.h"
+
+#include <pthread.h>
+#include <ctype.h>
+#ifndef _WIN32
+    #include <unistd.h>
+#endif
+
+/****************************************************************************
+ * CODE SECTION 
+ ****************************************************************************/
+
+/*
+ * Decoded images cache. Every image file read by LOAD IMAGE, LOAD IMAGES,
+ * LOAD SEQUENCE, LOAD TILE(S) and LOAD TILESET is decoded only once, and 
+ * every caller receives its own copy of the pixels (since they are
+ * flipped, cut and freed in place). Files can be queued in advance
+ * (see image_cache_prefetch_source()): in that case, they are decoded 
+ * by a pool of workers while the parser goes on, and the parser will wait
+ * for the decoding only if it reaches the LOAD before it ends.
+ *
+ * Only the decoding (stbi_load) is done by the pool. The conversion to
+ * the target format stays in the parser thread: it reads and changes the
+ * shared state of the compiler (palettes, tile descriptors, variables),
+ * so its result depends on the order of the LOADs in the source. The
+ * compression stays there too, since its outcome has to be known as soon
+ * as the image is loaded (it changes the code emitted to draw it).
+ */
+
+#define IMAGE_CACHE_MAX_WORKERS     8
+
+typedef enum _ImageCacheState {
+
+    ICS_QUEUED = 0,
+    ICS_DECODING = 1,
+    ICS_READY = 2
+
+} ImageCacheState;
+
+typedef struct _ImageCacheEntry {
+
+    char * filename;
+    ImageCacheState state;
+    unsigned char * data;
+    int width;
+    int height;
+    int depth;
+
+    struct _ImageCacheEntry * next;
+
+} ImageCacheEntry;
+
+static ImageCacheEntry * imageCacheFirst = NULL;
+static ImageCacheEntry * imageCacheLast = NULL;
+static int imageCacheQueued = 0;
+static int imageCacheShutdown = 0;
+
+static pthread_mutex_t imageCacheMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t imageCacheQueuedCondition = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t imageCacheReadyCondition = PTHREAD_COND_INITIALIZER;
+
+static pthread_t imageCacheWorkers[IMAGE_CACHE_MAX_WORKERS];
+static int imageCacheWorkersCount = 0;
+
+/* must be called with the mutex locked */
+static ImageCacheEntry * image_cache_find( char * _filename ) {
+
+    ImageCacheEntry * entry = imageCacheFirst;
+
+    while( entry ) {
+        if ( strcmp( entry->filename, _filename ) == 0 ) {
+            break;
+        }
+        entry = entry->next;
+    }
+
+    return entry;
+
+}
+
+/* must be called with the mutex locked */
+static ImageCacheEntry * image_cache_add( char * _filename, ImageCacheState _state ) {
+
+    ImageCacheEntry * entry = malloc( sizeof( ImageCacheEntry ) );
+    memset( entry, 0, sizeof( ImageCacheEntry ) );
+    entry->filename = strdup( _filename );
+    entry->state = _state;
+
+    if ( imageCacheLast ) {
+        imageCacheLast->next = entry;
+    } else {
+        imageCacheFirst = entry;
+    }
+    imageCacheLast = entry;
+
+    return entry;
+
+}
+
+/* must be called with the mutex unlocked, on an entry in ICS_DECODING state */
+static void image_cache_decode( ImageCacheEntry * _entry ) {
+
+    int width = 0, height = 0, depth = 0;
+
+    unsigned char * data = stbi_load( _entry->filename, &width, &height, &depth, 0 );
+
+    pthread_mutex_lock( &imageCacheMutex );
+    _entry->data = data;
+    _entry->width = width;
+    _entry->height = height;
+    _entry->depth = depth;
+    _entry->state = ICS_READY;
+    pthread_cond_broadcast( &imageCacheReadyCondition );
+    pthread_mutex_unlock( &imageCacheMutex );
+
+}
+
+static void * image_cache_worker( void * _unused ) {
+
+    pthread_mutex_lock( &imageCacheMutex );
+
+    while( 1 ) {
+
+        while( !imageCacheQueued && !imageCacheShutdown ) {
+            pthread_cond_wait( &imageCacheQueuedCondition, &imageCacheMutex );
+        }
+
+        if ( imageCacheShutdown ) {
+            break;
+        }
+
+        ImageCacheEntry * entry = imageCacheFirst;
+        while( entry->state != ICS_QUEUED ) {
+            entry = entry->next;
+        }
+        entry->state = ICS_DECODING;
+        --imageCacheQueued;
+
+        pthread_mutex_unlock( &imageCacheMutex );
+        image_cache_decode( entry );
+        pthread_mutex_lock( &imageCacheMutex );
+
+    }
+
+    pthread_mutex_unlock( &imageCacheMutex );
+
+    return NULL;
+
+}
+
+/* must be called with the mutex locked */
+static void image_cache_start_workers( ) {
+
+    int count = 0;
+
+#ifdef _WIN32
+    char * processors = getenv( "NUMBER_OF_PROCESSORS" );
+    if ( processors ) {
+        count = atoi( processors );
+    }
+#else
+    count = sysconf( _SC_NPROCESSORS_ONLN );
+#endif
+
+    if ( count < 1 ) {
+        count = 1;
+    }
+    if ( count > IMAGE_CACHE_MAX_WORKERS ) {
+        count = IMAGE_CACHE_MAX_WORKERS;
+    }
+
+    while( imageCacheWorkersCount < count ) {
+        if ( pthread_create( &imageCacheWorkers[imageCacheWorkersCount], NULL, image_cache_worker, NULL ) != 0 ) {
+            break;
+        }
+        ++imageCacheWorkersCount;
+    }
+
+}
+
+/**
+ * @brief Queue an image file to be decoded in background
+ * 
+ * The file is resolved as resource_load_asserts() would do. Missing or
+ * invalid files are silently ignored: the error will be given (if the
+ * LOAD is really compiled) when the file is loaded.
+ * 
+ * @param _environment Current calling environment
+ * @param _filename Filename of the image
+ */
+void image_cache_prefetch( Environment * _environment, char * _filename ) {
+
+    if ( strchr( _filename, ':' ) || strchr( _filename, '\\' ) ) {
+        return;
+    }
+
+    char * lookedFilename = resource_lookup( _environment, _filename );
+
+    if ( !lookedFilename ) {
+        return;
+    }
+
+    pthread_mutex_lock( &imageCacheMutex );
+
+    if ( !image_cache_find( lookedFilename ) ) {
+        image_cache_add( lookedFilename, ICS_QUEUED );
+        ++imageCacheQueued;
+        if ( !imageCacheWorkersCount ) {
+            image_cache_start_workers( );
+        }
+        pthread_cond_signal( &imageCacheQueuedCondition );
+    }
+
+    pthread_mutex_unlock( &imageCacheMutex );
+
+    free( lookedFilename );
+
+}
+
+/**
+ * @brief Queue all the images loaded with a constant filename by the source
+ * 
+ * This function looks for <code>LOAD IMAGE("...")</code>, 
+ * <code>LOAD IMAGES("...")</code> and <code>LOAD SEQUENCE("...")</code> 
+ * (and the <code>IMAGE LOAD</code> forms) into the main source file,
+ * and queues the given files to be decoded while the source is compiled.
+ * 
+ * @param _environment Current calling environment
+ * @param _source_filename Filename of the source
+ */
+void image_cache_prefetch_source( Environment * _environment, char * _source_filename ) {
+
+    static char * keywords[][2] = {
+        { "LOAD", "IMAGE" }, { "LOAD", "IMAGES" }, { "LOAD", "SEQUENCE" },
+        { "IMAGE", "LOAD" }, { "IMAGES", "LOAD" }, { "SEQUENCE", "LOAD" }
+    };
+
+    FILE * fh = fopen( _source_filename, "rb" );
+    if ( !fh ) {
+        return;
+    }
+    fseek( fh, 0, SEEK_END );
+    int size = ftell( fh );
+    fseek( fh, 0, SEEK_SET );
+    char * source = malloc( size + 1 );
+    (void)!fread( source, 1, size, fh );
+    source[size] = 0;
+    fclose( fh );
+
+    char * p = source;
+
+    while( *p ) {
+
+        int k;
+        char * q = NULL;
+
+        if ( p > source && ( isalnum( p[-1] ) || p[-1] == '_' ) ) {
+            ++p;
+            continue;
+        }
+
+        for( k=0; k<( sizeof( keywords ) / sizeof( keywords[0] ) ); ++k ) {
+            int first = strlen( keywords[k][0] );
+            int second = strlen( keywords[k][1] );
+            if ( strncasecmp( p, keywords[k][0], first ) != 0 || ( p[first] != ' ' && p[first] != '\t' ) ) {
+                continue;
+            }
+            q = p + first;
+            while( *q == ' ' || *q == '\t' ) {
+                ++q;
+            }
+            if ( strncasecmp( q, keywords[k][1], second ) == 0 && !isalnum( q[second] ) ) {
+                q += second;
+                break;
+            }
+            q = NULL;
+        }
+
+        if ( q ) {
+            while( *q == ' ' || *q == '\t' ) {
+                ++q;
+            }
+            if ( *q == '(' ) {
+                ++q;
+                while( *q == ' ' || *q == '\t' ) {
+                    ++q;
+                }
+                if ( *q == '"' ) {
+                    char * end = strchr( q + 1, '"' );
+                    if ( end && ( end - q - 1 ) < MAX_TEMPORARY_STORAGE && memchr( q + 1, '\n', end - q - 1 ) == NULL ) {
+                        char filename[MAX_TEMPORARY_STORAGE];
+                        memcpy( filename, q + 1, end - q - 1 );
+                        filename[end - q - 1] = 0;
+                        image_cache_prefetch( _environment, filename );
+                        p = end;
+                    }
+                }
+            }
+        }
+
+        ++p;
+
+    }
+
+    free( source );
+
+}
+
+/**
+ * @brief Decode an image file, using the cache
+ * 
+ * This function is a replacement for <code>stbi_load( ..., 0 )</code>.
+ * If the file has been already decoded (or it is being decoded by a
+ * worker), the decoded pixels are reused.
+ * 
+ * @param _environment Current calling environment
+ * @param _filename Filename of the image (as given by resource_load_asserts())
+ * @param _width Width of the image (output)
+ * @param _height Height of the image (output)
+ * @param _depth Bytes per pixel of the image (output)
+ * @return A copy of the pixels, to be freed by the caller (NULL if the 
+ *         file cannot be decoded)
+ */
+unsigned char * image_cache_load( Environment * _environment, char * _filename, int * _width, int * _height, int * _depth ) {
+
+    telemetry_begin_resource( _environment, "image decoding", _filename );
+
+    pthread_mutex_lock( &imageCacheMutex );
+
+    ImageCacheEntry * entry = image_cache_find( _filename );
+
+    if ( !entry || entry->state == ICS_QUEUED ) {
+        if ( entry ) {
+            --imageCacheQueued;
+            entry->state = ICS_DECODING;
+        } else {
+            entry = image_cache_add( _filename, ICS_DECODING );
+        }
+        pthread_mutex_unlock( &imageCacheMutex );
+        image_cache_decode( entry );
+        pthread_mutex_lock( &imageCacheMutex );
+    }
+
+    while( entry->state != ICS_READY ) {
+        pthread_cond_wait( &imageCacheReadyCondition, &imageCacheMutex );
+    }
+
+    unsigned char * result = NULL;
+
+    if ( entry->data ) {
+        int size = entry->width * entry->height * entry->depth;
+        result = malloc( size );
+        memcpy( result, entry->data, size );
+        *_width = entry->width;
+        *_height = entry->height;
+        *_depth = entry->depth;
+    }
+
+    pthread_mutex_unlock( &imageCacheMutex );
+
+    telemetry_end( _environment );
+
+    return result;
+
+}
+
+/**
+ * @brief Stop the workers and free the cache
+ * 
+ * @param _environment Current calling environment
+ */
+void image_cache_cleanup( Environment * _environment ) {
+
+    int i;
+
+    pthread_mutex_lock( &imageCacheMutex );
+    imageCacheShutdown = 1;
+    pthread_cond_broadcast( &imageCacheQueuedCondition );
+    pthread_mutex_unlock( &imageCacheMutex );
+
+    for( i=0; i<imageCacheWorkersCount; ++i ) {
+        pthread_join( imageCacheWorkers[i], NULL );
+    }
+    imageCacheWorkersCount = 0;
+
+    ImageCacheEntry * entry = imageCacheFirst;
+    while( entry ) {
+        ImageCacheEntry * next = entry->next;
+        if ( entry->data ) {
+            stbi_image_free( entry->data );
+        }
+        free( entry->filename );
+        free( entry );
+        entry = next;
+    }
+    imageCacheFirst = NULL;
+    imageCacheLast = NULL;
+    imageCacheQueued = 0;
+
+}
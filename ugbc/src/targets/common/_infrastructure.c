@@ -34,6 +34,11 @@
 
 #include "../../ugbc.h"
 #include <math.h>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 #include <ctype.h>
 #include <errno.h>
 #include <stdio.h>
@@ -90,7 +95,10 @@ char DATATYPE_AS_STRING[][16] = {
     "MUSIC",
     "BLIT",
     "FLOAT",
-    "BIT"
+    "TILEMAP",
+    "BIT",
+    "FIXED",
+    "DFIXED"
 };
 
 char OUTPUT_FILE_TYPE_AS_STRING[][16] = {
@@ -107,10 +115,22 @@ char OUTPUT_FILE_TYPE_AS_STRING[][16] = {
     "atr"
 };
 
+/**
+ * @brief Ask to place a variable into one of the memory areas
+ * 
+ * The variable is only marked with the space it needs: the memory area
+ * and the address are chosen at the end of compilation by memory_map_pack(),
+ * when every variable (and its final size) is known.
+ * 
+ * @param _first first memory area (NULL if the target has none)
+ * @param _variable variable to place
+ */
 void memory_area_assign( MemoryArea * _first, Variable * _variable ) {
 
     int neededSpace = 0;
 
+    if ( ! _first ) return;
+
     if ( _variable->type == VT_ARRAY ) {
         neededSpace = _variable->size;
     } else if ( _variable->type == VT_DSTRING ) {
@@ -119,25 +139,7 @@ void memory_area_assign( MemoryArea * _first, Variable * _variable ) {
         neededSpace = VT_BITWIDTH( _variable->type ) ? ( VT_BITWIDTH( _variable->type ) >> 3 ) : _variable->size;   
     }
 
-    if ( neededSpace == 0 ) return;
-
-    MemoryArea * actual = _first;
-    while( actual ) {
-        int enoughSpace = actual->size > neededSpace;
-        if ( actual->type == MAT_RAM ) {
-            if ( _variable->type == VT_STRING || _variable->type == VT_BUFFER || _variable->type == VT_IMAGE || _variable->type == VT_IMAGES || _variable->type == VT_SEQUENCE || _variable->type == VT_MUSIC ) {
-                enoughSpace = 0;
-            }
-        }
-        if ( enoughSpace ) {
-            actual->size -= neededSpace;
-            _variable->memoryArea = actual;
-            _variable->absoluteAddress = actual->current;
-            actual->current += neededSpace;
-            break;
-        }
-        actual = actual->next;
-    }
+    _variable->memoryAreaRequested = neededSpace;
 
 }
 
@@ -422,6 +424,12 @@ Variable * variable_retrieve_internal( Environment * _environment, char * _name,
         CRITICAL_VARIABLE( _name );
     }
 
+    // A string concatenation is emitted only when its result is used.
+
+    if ( var && var->concatenationCount && ! _environment->concatenationHold ) {
+        variable_concatenation_flush( _environment, var );
+    }
+
     return var;
 
 }
@@ -866,6 +874,7 @@ void variable_reset( Environment * _environment ) {
     } else {
         variable_reset_pool( _environment, _environment->tempVariables[0] );
     }    
+    expression_reset( _environment );
     outline0("; VSP" );
 }
 
@@ -1144,7 +1153,8 @@ Variable * variable_cast( Environment * _environment, char * _source, VariableTy
 
     variable_move( _environment, source->name, target->name );
 
-    if ( source->initializedByConstant && VT_BITWIDTH( source->type ) > 1 && VT_BITWIDTH( target->type ) > 1 ) {
+    // Fixed point values are scaled, so the constant cannot be propagated as is.
+    if ( source->initializedByConstant && VT_BITWIDTH( source->type ) > 1 && VT_BITWIDTH( target->type ) > 1 && ! VT_FIXED_TYPE( source->type ) && ! VT_FIXED_TYPE( target->type ) ) {
         
         target->initializedByConstant = source->initializedByConstant;
 
@@ -1216,6 +1226,8 @@ Variable * variable_store( Environment * _environment, char * _destination, unsi
     
     Variable * destination = variable_retrieve( _environment, _destination );
 
+    expression_invalidate( _environment, destination->name );
+
     destination->value = _value;
 
     switch( VT_BITWIDTH( destination->type ) ) {
@@ -1466,6 +1478,11 @@ Variable * variable_store_float( Environment * _environment, char * _destination
 
             break;
         }
+        case VT_FIXED:
+        case VT_DFIXED:
+            // Fixed point constants are scaled at compile time.
+            variable_store( _environment, destination->name, (int) round( _value * ( 1 << VT_FIXED_SHIFT( destination->type ) ) ) );
+            break;
         default:
             CRITICAL_STORE_UNSUPPORTED(DATATYPE_AS_STRING[destination->type]);
     }
@@ -2956,6 +2973,13 @@ Variable * variable_move( Environment * _environment, char * _source, char * _de
 
     Variable * target = variable_retrieve( _environment, _destination );
 
+    expression_invalidate( _environment, target->name );
+
+    if ( ( VT_FIXED_TYPE( source->type ) || VT_FIXED_TYPE( target->type ) ) && source->type != target->type ) {
+        variable_move_fixed( _environment, source, target );
+        return target;
+    }
+
     switch( VT_BITWIDTH( source->type ) ) {
 
         //////////////////////////////////////////////////////////////////////////////
@@ -3270,6 +3294,17 @@ Variable * variable_move( Environment * _environment, char * _source, char * _de
                         case VT_DSTRING:
                             switch( target->type ) {
                                 case VT_DSTRING: {
+                                    if ( source->concatenationOwned ) {
+                                        // The target takes the freshly concatenated string
+                                        // (so A$ = A$ + B$ copies A$ only once); the slot 0
+                                        // left in the temporary is never used, and freeing
+                                        // it again is harmless.
+                                        cpu_dsfree( _environment, target->realName );
+                                        cpu_move_8bit( _environment, source->realName, target->realName );
+                                        cpu_store_8bit( _environment, source->realName, 0 );
+                                        source->concatenationOwned = 0;
+                                        break;
+                                    }
                                     Variable * sourceAddress = variable_temporary( _environment, VT_ADDRESS, "(address of DSTRING)");
                                     Variable * sourceSize = variable_temporary( _environment, VT_BYTE, "(size of DSTRING)");
                                     Variable * targetAddress = variable_temporary( _environment, VT_ADDRESS, "(address of DSTRING)");
@@ -3519,15 +3554,19 @@ Variable * variable_add_const( Environment * _environment, char * _source, int
 
     Variable * source = variable_retrieve( _environment, _source );
 
+    if ( VT_FIXED_TYPE( source->type ) ) {
+        _destination *= ( 1 << VT_FIXED_SHIFT( source->type ) );
+    }
+
     Variable * result;
 
     switch( VT_BITWIDTH( source->type ) ) {
         case 32:
-            result = variable_temporary( _environment, VT_SIGNED( source->type ) ? VT_SDWORD : VT_DWORD, "(result of sum)" );
+            result = variable_temporary( _environment, VT_FIXED_TYPE( source->type ) ? source->type : ( VT_SIGNED( source->type ) ? VT_SDWORD : VT_DWORD ), "(result of sum)" );
             cpu_math_add_32bit_const( _environment, source->realName, _destination, result->realName );
             break;
         case 16:
-            result = variable_temporary( _environment, VT_SIGNED( source->type ) ? VT_SWORD : VT_SWORD, "(result of sum)" );
+            result = variable_temporary( _environment, VT_FIXED_TYPE( source->type ) ? source->type : ( VT_SIGNED( source->type ) ? VT_SWORD : VT_SWORD ), "(result of sum)" );
             cpu_math_add_16bit_const( _environment, source->realName, _destination, result->realName );
             break;
         case 8:
@@ -3563,6 +3602,8 @@ Variable * variable_move_naked( Environment * _environment, char * _source, char
     Variable * source = variable_retrieve( _environment, _source );
     Variable * target = variable_retrieve( _environment, _destination );
 
+    expression_invalidate( _environment, target->name );
+
     if ( source->type != target->type ) {
         CRITICAL_DATATYPE_MISMATCH( DATATYPE_AS_STRING[source->type], DATATYPE_AS_STRING[target->type] );
     }
@@ -3775,11 +3816,11 @@ Variable * variable_add( Environment * _environment, char * _source, char * _des
 
     switch( VT_BITWIDTH( source->type ) ) {
         case 32:
-            result = variable_temporary( _environment, VT_SIGNED( source->type ) ? VT_SDWORD : VT_DWORD, "(result of sum)" );
+            result = variable_temporary( _environment, VT_FIXED_TYPE( source->type ) ? source->type : ( VT_SIGNED( source->type ) ? VT_SDWORD : VT_DWORD ), "(result of sum)" );
             cpu_math_add_32bit( _environment, source->realName, target->realName, result->realName );
             break;
         case 16:
-            result = variable_temporary( _environment, VT_SIGNED( source->type ) ? VT_SWORD : VT_WORD, "(result of sum)" );
+            result = variable_temporary( _environment, VT_FIXED_TYPE( source->type ) ? source->type : ( VT_SIGNED( source->type ) ? VT_SWORD : VT_WORD ), "(result of sum)" );
             cpu_math_add_16bit( _environment, source->realName, target->realName, result->realName );
             break;
         case 8:
@@ -3854,6 +3895,65 @@ Variable * variable_add( Environment * _environment, char * _source, char * _des
     return result;
 }
 
+/**
+ * @brief Emit the code of a pending string concatenation
+ * 
+ * All the strings collected by expression_add() are concatenated into
+ * the result with a single allocation, copying each string once: the
+ * total size is calculated first, then the result is allocated and the
+ * strings are copied one after the other. The descriptors are read again
+ * after the allocation, since it could move the strings (garbage
+ * collection).
+ * 
+ * @param _environment Current calling environment
+ * @param _result Temporary DSTRING with the pending concatenation
+ */
+void variable_concatenation_flush( Environment * _environment, Variable * _result ) {
+
+    Variable * pieces[MAX_CONCATENATION];
+    int i, count = _result->concatenationCount;
+
+    // Clear first: the retrievals below must not emit it again.
+
+    _result->concatenationCount = 0;
+
+    for( i=0; i<count; ++i ) {
+        pieces[i] = variable_retrieve( _environment, _result->concatenation[i]->name );
+        if ( pieces[i]->type == VT_STRING ) {
+            pieces[i] = variable_cast( _environment, pieces[i]->name, VT_DSTRING );
+        }
+    }
+
+    Variable * address = variable_temporary( _environment, VT_ADDRESS, "(address of DSTRING)");
+    Variable * size = variable_temporary( _environment, VT_BYTE, "(size of DSTRING)");
+    Variable * pieceAddress = variable_temporary( _environment, VT_ADDRESS, "(address of piece)");
+    Variable * pieceSize = variable_temporary( _environment, VT_BYTE, "(size of piece)");
+
+    for( i=0; i<count; ++i ) {
+        cpu_dsdescriptor( _environment, pieces[i]->realName, pieceAddress->realName, pieceSize->realName );
+        if ( i == 0 ) {
+            cpu_move_8bit( _environment, pieceSize->realName, size->realName );
+        } else {
+            cpu_math_add_8bit( _environment, size->realName, pieceSize->realName, size->realName );
+        }
+    }
+
+    cpu_dsfree( _environment, _result->realName );
+    cpu_dsalloc( _environment, size->realName, _result->realName );
+    cpu_dsdescriptor( _environment, _result->realName, address->realName, size->realName );
+
+    for( i=0; i<count; ++i ) {
+        cpu_dsdescriptor( _environment, pieces[i]->realName, pieceAddress->realName, pieceSize->realName );
+        cpu_mem_move( _environment, pieceAddress->realName, address->realName, pieceSize->realName );
+        if ( i < ( count - 1 ) ) {
+            cpu_math_add_16bit_with_8bit( _environment, address->realName, pieceSize->realName, address->realName );
+        }
+    }
+
+    _result->concatenationOwned = 1;
+
+}
+
 void variable_add_inplace( Environment * _environment, char * _source, int _destination ) {
 
     Variable * source = variable_retrieve( _environment, _source );
@@ -3861,6 +3961,10 @@ void variable_add_inplace( Environment * _environment, char * _source, int _dest
         source = variable_cast( _environment, _source, VT_DSTRING );
     }
 
+    if ( VT_FIXED_TYPE( source->type ) ) {
+        _destination *= ( 1 << VT_FIXED_SHIFT( source->type ) );
+    }
+
     switch( VT_BITWIDTH( source->type ) ) {
         case 32:
             cpu_math_add_32bit_const( _environment, source->realName, _destination, source->realName );
@@ -4125,6 +4229,10 @@ Variable * variable_sub( Environment * _environment, char * _source, char * _des
 Variable * variable_sub_const( Environment * _environment, char * _source, int _destination ) {
     Variable * source = variable_retrieve( _environment, _source );
 
+    if ( VT_FIXED_TYPE( source->type ) ) {
+        _destination *= ( 1 << VT_FIXED_SHIFT( source->type ) );
+    }
+
     Variable * result = variable_temporary( _environment, source->type, "(result of subtracting)" );
 
     switch( VT_BITWIDTH( source->type ) ) {
@@ -4310,6 +4418,10 @@ Variable * variable_mul( Environment * _environment, char * _source, char * _des
     Variable * source = variable_retrieve( _environment, _source );
     Variable * target = variable_retrieve( _environment, _destination );
 
+    if ( ( VT_FIXED_TYPE( source->type ) || VT_FIXED_TYPE( target->type ) ) && source->type != VT_FLOAT && target->type != VT_FLOAT ) {
+        return variable_mul_fixed( _environment, source, target );
+    }
+
     if ( VT_SIGNED( source->type ) != VT_SIGNED( target->type ) ) {
         source = variable_cast( _environment, _source, VT_SIGN( VT_MAX_BITWIDTH_TYPE( source->type, target->type ) ) );
         target = variable_cast( _environment, _destination, VT_SIGN( VT_MAX_BITWIDTH_TYPE( source->type, target->type ) ) );
@@ -4408,6 +4520,13 @@ Variable * variable_div( Environment * _environment, char * _source, char * _des
     Variable * source = variable_retrieve( _environment, _source );
     Variable * target = variable_retrieve( _environment, _destination );
 
+    if ( ( VT_FIXED_TYPE( source->type ) || VT_FIXED_TYPE( target->type ) ) && source->type != VT_FLOAT && target->type != VT_FLOAT ) {
+        if ( _remainder ) {
+            CRITICAL_DIV_UNSUPPORTED( _remainder, DATATYPE_AS_STRING[VT_MAX_BITWIDTH_TYPE( source->type, target->type )] );
+        }
+        return variable_div_fixed( _environment, source, target );
+    }
+
     if ( VT_SIGNED( source->type ) != VT_SIGNED( target->type ) ) {
         if ( VT_SIGNED( source->type ) ) {
             target = variable_cast( _environment, _destination, source->type );
@@ -4566,6 +4685,10 @@ Tale operazione è assai più efficiente che utilizzare la sintassi standard ''v
 </usermanual> */
 Variable * variable_increment( Environment * _environment, char * _source ) {
     Variable * source = variable_retrieve( _environment, _source );
+    if ( VT_FIXED_TYPE( source->type ) ) {
+        variable_add_inplace( _environment, source->name, 1 );
+        return source;
+    }
     switch( VT_BITWIDTH( source->type ) ) {
         case 32:
         case 1:
@@ -4714,6 +4837,10 @@ Variable * variable_increment_mt( Environment * _environment, char * _source ) {
  */
 Variable * variable_decrement( Environment * _environment, char * _source ) {
     Variable * source = variable_retrieve( _environment, _source );
+    if ( VT_FIXED_TYPE( source->type ) ) {
+        variable_add_inplace( _environment, source->name, -1 );
+        return source;
+    }
     switch( VT_BITWIDTH( source->type ) ) {
         case 32:
         case 1:
@@ -4851,6 +4978,11 @@ Variable * variable_compare( Environment * _environment, char * _source, char *
     Variable * source = variable_retrieve( _environment, _source );
     Variable * target = variable_retrieve( _environment, _destination );
 
+    if ( ( VT_FIXED_TYPE( source->type ) || VT_FIXED_TYPE( target->type ) ) && source->type != target->type ) {
+        source = variable_cast( _environment, _source, VT_MAX_BITWIDTH_TYPE( source->type, target->type ) );
+        target = variable_cast( _environment, _destination, VT_MAX_BITWIDTH_TYPE( source->type, target->type ) );
+    }
+
     if ( VT_SIGNED( source->type ) != VT_SIGNED( target->type ) ) {
         source = variable_cast( _environment, _source, VT_SIGN( source->type ) );
         target = variable_cast( _environment, _destination, VT_SIGN( target->type ) );
@@ -5182,6 +5314,10 @@ Variable * variable_compare( Environment * _environment, char * _source, char *
 Variable * variable_compare_const( Environment * _environment, char * _source, int _destination ) {
     Variable * source = variable_retrieve( _environment, _source );
 
+    if ( VT_FIXED_TYPE( source->type ) ) {
+        _destination *= ( 1 << VT_FIXED_SHIFT( source->type ) );
+    }
+
     MAKE_LABEL
 
     Variable * result = variable_temporary( _environment, VT_SBYTE, "(result of compare)" );
@@ -5222,6 +5358,10 @@ Variable * variable_compare_const( Environment * _environment, char * _source, i
 Variable * variable_compare_not_const( Environment * _environment, char * _source, int _destination ) {
     Variable * source = variable_retrieve( _environment, _source );
 
+    if ( VT_FIXED_TYPE( source->type ) ) {
+        _destination *= ( 1 << VT_FIXED_SHIFT( source->type ) );
+    }
+
     MAKE_LABEL
 
     Variable * result = variable_temporary( _environment, VT_SBYTE, "(result of compare)" );
@@ -7614,10 +7754,109 @@ static Variable * calculate_offset_in_array( Environment * _environment, char *
 
 }
 
+// @bit2: ok
+static int calculate_constant_offset_in_array( Environment * _environment, Variable * _array ) {
+
+    int i, j, offset = 0;
+    int count = _environment->arrayIndexes[_environment->arrayNestedIndex];
+
+    if ( _array->arrayDimensions != count ) {
+        CRITICAL_ARRAY_SIZE_MISMATCH( _array->name, _array->arrayDimensions, count );
+    }
+
+    for( i = 0; i<count; ++i ) {
+        if ( _environment->arrayIndexesEach[_environment->arrayNestedIndex][i] != NULL ) {
+            return -1;
+        }
+    }
+
+    for( i = 0; i<count; ++i ) {
+        int baseValue = 1;
+        for( j=0; j<(count-i-1); ++j ) {
+            baseValue *= _array->arrayDimensionsEach[j];
+        }
+        offset += _environment->arrayIndexesDirectEach[_environment->arrayNestedIndex][count-i-1] * baseValue;
+    }
+
+    return offset;
+
+}
+
+/* Bit arrays with two dimensions avoid the multiplication of the row
+   index: if the row is a power of two bits wide, the row index is shifted, 
+   otherwise the offset of each row is taken from a table. */
+// @bit2: ok
+static Variable * calculate_offset_in_bit_array( Environment * _environment, Variable * _array ) {
+
+    int nested = _environment->arrayNestedIndex;
+
+    if ( _array->arrayDimensions != 2 || _environment->arrayIndexes[nested] != 2 || _environment->arrayIndexesEach[nested][1] == NULL ) {
+        return calculate_offset_in_array( _environment, _array->name );
+    }
+
+    int width = _array->arrayDimensionsEach[0];
+    int height = _array->arrayDimensionsEach[1];
+    Variable * offset = NULL;
+
+    if ( ( width & ( width - 1 ) ) == 0 ) {
+        int shift = 0;
+        while( ( 1 << shift ) < width ) {
+            ++shift;
+        }
+        offset = variable_temporary( _environment, VT_WORD, "(offset in array)");
+        variable_move( _environment, _environment->arrayIndexesEach[nested][1], offset->name );
+        offset = variable_mul2_const( _environment, offset->name, shift );
+    } else if ( height <= 128 ) {
+        char rowsName[MAX_TEMPORARY_STORAGE]; sprintf( rowsName, "%srows", _array->realName );
+        Variable * rows;
+        if ( variable_exists( _environment, rowsName ) ) {
+            rows = variable_retrieve( _environment, rowsName );
+        } else {
+            unsigned char * buffer = malloc( height * 2 );
+            int i;
+            for( i=0; i<height; ++i ) {
+                #ifdef CPU_BIG_ENDIAN
+                    buffer[i*2] = ( ( i * width ) >> 8 ) & 0xff;
+                    buffer[i*2+1] = ( i * width ) & 0xff;
+                #else
+                    buffer[i*2+1] = ( ( i * width ) >> 8 ) & 0xff;
+                    buffer[i*2] = ( i * width ) & 0xff;
+                #endif
+            }
+            rows = variable_define( _environment, rowsName, VT_BUFFER, 0 );
+            rows->readonly = 1;
+            variable_store_buffer( _environment, rows->name, buffer, height * 2, 0 );
+            free( buffer );
+        }
+        Variable * row = variable_cast( _environment, _environment->arrayIndexesEach[nested][1], VT_BYTE );
+        offset = variable_temporary( _environment, VT_WORD, "(offset in array)");
+        cpu_move_16bit_indirect2_8bit( _environment, rows->realName, row->realName, offset->realName );
+    } else {
+        return calculate_offset_in_array( _environment, _array->name );
+    }
+
+    if ( _environment->arrayIndexesEach[nested][0] == NULL ) {
+        variable_add_inplace( _environment, offset->name, _environment->arrayIndexesDirectEach[nested][0] );
+    } else {
+        variable_add_inplace_vars( _environment, offset->name, _environment->arrayIndexesEach[nested][0] );
+    }
+
+    return offset;
+
+}
+
 // @bit2: ok
 void variable_store_array_const_bit( Environment * _environment, Variable * _array, int _value  ) {
 
-    Variable * offset = calculate_offset_in_array( _environment, _array->name );
+    int constantOffset = calculate_constant_offset_in_array( _environment, _array );
+
+    if ( constantOffset >= 0 ) {
+        char displacement[MAX_TEMPORARY_STORAGE]; sprintf( displacement, "%d", constantOffset >> 3 );
+        cpu_bit_inplace_8bit( _environment, address_displacement( _environment, _array->realName, displacement ), constantOffset & 0x07, &_value );
+        return;
+    }
+
+    Variable * offset = calculate_offset_in_bit_array( _environment, _array );
     Variable * position = variable_temporary( _environment, VT_BYTE, "(position)");
     variable_move( _environment, offset->name, position->name );
 
@@ -7714,7 +7953,28 @@ void variable_store_array_const( Environment * _environment, char * _array, int
 // @bit2: ok
 void variable_move_array_bit( Environment * _environment, Variable * _array, Variable * _value  ) {
 
-    Variable * offset = calculate_offset_in_array( _environment, _array->name );
+    MAKE_LABEL
+
+    char zeroLabel[MAX_TEMPORARY_STORAGE]; sprintf( zeroLabel,  "%szero", label );
+    int value = 0;
+
+    int constantOffset = calculate_constant_offset_in_array( _environment, _array );
+
+    if ( constantOffset >= 0 ) {
+        char displacement[MAX_TEMPORARY_STORAGE]; sprintf( displacement, "%d", constantOffset >> 3 );
+        char * address = address_displacement( _environment, _array->realName, displacement );
+        variable_compare_and_branch_const( _environment, _value->name, 0, zeroLabel, 1 );
+        value = 1;
+        cpu_bit_inplace_8bit( _environment, address, constantOffset & 0x07, &value );
+        cpu_jump( _environment, label );
+        cpu_label( _environment, zeroLabel );
+        value = 0;
+        cpu_bit_inplace_8bit( _environment, address, constantOffset & 0x07, &value );
+        cpu_label( _environment, label );
+        return;
+    }
+
+    Variable * offset = calculate_offset_in_bit_array( _environment, _array );
     Variable * position = variable_temporary( _environment, VT_BYTE, "(position)");
     variable_move( _environment, offset->name, position->name );
 
@@ -7724,11 +7984,6 @@ void variable_move_array_bit( Environment * _environment, Variable * _array, Var
 
     cpu_math_add_16bit_with_16bit( _environment, offset->realName, _array->realName, offset->realName );
 
-    MAKE_LABEL
-
-    char zeroLabel[MAX_TEMPORARY_STORAGE]; sprintf( zeroLabel,  "%szero", label );
-    int value = 0;
-
     variable_compare_and_branch_const( _environment, _value->name, 0, zeroLabel, 1 );
 
     value = 1;
@@ -7878,7 +8133,16 @@ Variable * variable_move_from_array_bit( Environment * _environment, Variable *
     Variable * tmp = variable_temporary( _environment, VT_BYTE, "(element from array)" );
     Variable * result = variable_temporary( _environment, VT_BIT, "(element from array)" );
 
-    Variable * offset = calculate_offset_in_array( _environment, _array->name );
+    int constantOffset = calculate_constant_offset_in_array( _environment, _array );
+
+    if ( constantOffset >= 0 ) {
+        char displacement[MAX_TEMPORARY_STORAGE]; sprintf( displacement, "%d", constantOffset >> 3 );
+        cpu_bit_check( _environment, address_displacement( _environment, _array->realName, displacement ), constantOffset & 0x07, NULL, 8 );
+        cpu_bit_inplace_8bit( _environment, result->realName, result->bitPosition, NULL );
+        return result;
+    }
+
+    Variable * offset = calculate_offset_in_bit_array( _environment, _array );
     Variable * position = variable_temporary( _environment, VT_BYTE, "(position)");
     variable_move( _environment, offset->name, position->name );
 
@@ -8528,6 +8792,9 @@ void label_define_numeric( Environment * _environment, int _label ) {
         _environment->labels = label;
     }
 
+    // A label can be reached by a jump from anywhere.
+    expression_reset( _environment );
+
 }
 
 void label_define_named( Environment * _environment, char * _label ) {
@@ -8549,6 +8816,9 @@ void label_define_named( Environment * _environment, char * _label ) {
         _environment->labels = label;
     }
 
+    // A label can be reached by a jump from anywhere.
+    expression_reset( _environment );
+
 }
 
 void const_define_numeric( Environment * _environment, char * _name, int _value ) {
@@ -8645,6 +8915,12 @@ void variable_array_fill( Environment * _environment, char * _name, int _value )
         CRITICAL_NOT_ARRAY( array->name );
     }
 
+    // Every element of an array of bits is a single bit: so a value
+    // different from zero must set all the bits of each byte.
+    if ( array->arrayType == VT_BIT && _value ) {
+        _value = 0xff;
+    }
+
     if ( array->size > 0 ) {
         cpu_fill_direct_size_value( _environment, array->realName, array->size, _value );
     } else {
@@ -8653,6 +8929,108 @@ void variable_array_fill( Environment * _environment, char * _name, int _value )
 
 }
 
+/**
+ * @brief Emit code for <b>= BIT COUNT( ... )</b>
+ * 
+ * The bits are counted a byte at a time, using a table with the number
+ * of bits set for each of the 256 possible values of a byte. The last 
+ * byte is masked, so that unused bits are never counted.
+ * 
+ * @param _environment Current calling environment
+ * @param _name Name of the array of bits
+ * @return Variable* Number of elements set to 1
+ */
+/* <usermanual>
+@keyword BIT COUNT
+
+@english
+This function returns how many elements of an array of ''BIT'' are
+set (that is, equal to 1). The array is examined a byte at a time, 
+so it is fast even on large sets of flags, like collision maps or
+the cells already visited on a map. To clear (or set) all the elements
+of the array at once, you can use the ''FILL'' command.
+
+@italian
+Questa funzione restituisce quanti elementi di un vettore di ''BIT'' 
+sono impostati (cioè, uguali a 1). Il vettore viene esaminato un byte 
+alla volta, per cui è veloce anche su grandi insiemi di indicatori, 
+come le mappe di collisione o le celle già visitate su una mappa. 
+Per azzerare (o impostare) tutti gli elementi del vettore in una volta,
+è possibile usare il comando ''FILL''.
+
+@syntax = BIT COUNT( array )
+
+@example DIM visited AS BIT (40,25)
+@example FILL visited
+@example visited(10,5) = 1
+@example PRINT BIT COUNT( visited )
+
+@usedInExample bit_example_05.bas
+
+@target all
+ </usermanual> */
+Variable * variable_array_bit_count( Environment * _environment, char * _name ) {
+
+    MAKE_LABEL
+
+    Variable * array = variable_retrieve( _environment, _name );
+
+    if ( array->type != VT_ARRAY ) {
+        CRITICAL_NOT_ARRAY( _name );
+    }
+
+    if ( array->arrayType != VT_BIT ) {
+        CRITICAL_NOT_BIT_ARRAY( _name );
+    }
+
+    int i, bits = 1;
+    for( i=0; i<array->arrayDimensions; ++i ) {
+        bits *= array->arrayDimensionsEach[i];
+    }
+
+    Variable * table;
+    if ( variable_exists( _environment, "BITCOUNT" ) ) {
+        table = variable_retrieve( _environment, "BITCOUNT" );
+    } else {
+        unsigned char buffer[256];
+        for( i=0; i<256; ++i ) {
+            buffer[i] = ( i & 1 ) + ( ( i >> 1 ) & 1 ) + ( ( i >> 2 ) & 1 ) + ( ( i >> 3 ) & 1 ) +
+                ( ( i >> 4 ) & 1 ) + ( ( i >> 5 ) & 1 ) + ( ( i >> 6 ) & 1 ) + ( ( i >> 7 ) & 1 );
+        }
+        table = variable_define( _environment, "BITCOUNT", VT_BUFFER, 0 );
+        table->readonly = 1;
+        variable_store_buffer( _environment, table->name, buffer, 256, 0 );
+    }
+
+    Variable * result = variable_temporary( _environment, VT_WORD, "(result of BIT COUNT)" );
+    Variable * index = variable_temporary( _environment, VT_WORD, "(index of BIT COUNT)" );
+    Variable * element = variable_temporary( _environment, VT_BYTE, "(element of BIT COUNT)" );
+    Variable * count = variable_temporary( _environment, VT_BYTE, "(count of BIT COUNT)" );
+
+    variable_store( _environment, result->name, 0 );
+
+    if ( bits >> 3 ) {
+        variable_store( _environment, index->name, 0 );
+        cpu_label( _environment, label );
+        cpu_move_8bit_indirect2_16bit( _environment, array->realName, index->realName, element->realName );
+        cpu_move_8bit_indirect2_8bit( _environment, table->realName, element->realName, count->realName );
+        cpu_math_add_16bit_with_8bit( _environment, result->realName, count->realName, result->realName );
+        cpu_inc_16bit( _environment, index->realName );
+        cpu_compare_and_branch_16bit_const( _environment, index->realName, bits >> 3, label, 0 );
+    }
+
+    if ( bits & 0x07 ) {
+        char displacement[MAX_TEMPORARY_STORAGE]; sprintf( displacement, "%d", bits >> 3 );
+        cpu_move_8bit( _environment, address_displacement( _environment, array->realName, displacement ), element->realName );
+        variable_and_const( _environment, element->name, ( 1 << ( bits & 0x07 ) ) - 1 );
+        cpu_move_8bit_indirect2_8bit( _environment, table->realName, element->realName, count->realName );
+        cpu_math_add_16bit_with_8bit( _environment, result->realName, count->realName, result->realName );
+    }
+
+    return result;
+
+}
+
 void image_converter_asserts( Environment * _environment, int _width, int _height, int _offset_x, int _offset_y, int * _frame_width, int * _frame_height ) {
 
     if ( _width % 8 ) {
@@ -8741,15 +9119,14 @@ void image_converter_asserts_free_height( Environment * _environment, int _width
 
 }
 
-char * resource_load_asserts( Environment * _environment, char * _filename ) {
+/* returns the target dependent version of the file, if present, or the file itself (NULL if missing) */
+char * resource_lookup( Environment * _environment, char * _filename ) {
 
     char * lookedFilename = malloc(MAX_TEMPORARY_STORAGE);
     char lookedExtension[MAX_TEMPORARY_STORAGE];
     memset( lookedFilename, 0, MAX_TEMPORARY_STORAGE);
     memset( lookedExtension, 0, MAX_TEMPORARY_STORAGE);
 
-    check_if_filename_is_valid( _environment,  _filename );
-
     strcpy( lookedFilename, _filename );
     char * c = strrchr( lookedFilename, '/' );
     if ( c ) {
@@ -8815,12 +9192,25 @@ char * resource_load_asserts( Environment * _environment, char * _filename ) {
         file = fopen( lookedFilename, "rb" );
 
         if ( !file ) {
-            CRITICAL_RESOURCE_LOAD_MISSING_FILE( lookedFilename );
+            free( lookedFilename );
+            return NULL;
         }
     }
 
-    if ( file ) {
-        fclose( file );
+    fclose( file );
+
+    return lookedFilename;
+
+}
+
+char * resource_load_asserts( Environment * _environment, char * _filename ) {
+
+    check_if_filename_is_valid( _environment,  _filename );
+
+    char * lookedFilename = resource_lookup( _environment, _filename );
+
+    if ( !lookedFilename ) {
+        CRITICAL_RESOURCE_LOAD_MISSING_FILE( _filename );
     }
 
     return lookedFilename;
@@ -8951,11 +9341,17 @@ TileDescriptors * precalculate_tile_descriptors_for_font( char * _fontData, int
     
     int i=0,j=0;
 
+    for(i=0;i<256;++i) {
+        tileDescriptors->whiteArea[i] = TILE_DESCRIPTOR_UNUSED;
+    }
+
     for(i=0;i<_fontSize;++i) {
         for(j=0;j<8;++j) {
             tileDescriptors->data[i].data[j] = *(_fontData + i*8 + j);
         }
-        tileDescriptors->descriptor[i] = calculate_tile_descriptor( &tileDescriptors->data[i] );
+        TileDescriptor * tileDescriptor = calculate_tile_descriptor( &tileDescriptors->data[i] );
+        tile_descriptors_set( tileDescriptors, i, tileDescriptor );
+        free( tileDescriptor );
     }
 
     tileDescriptors->count = 0;
@@ -8979,47 +9375,142 @@ int calculate_tile_affinity( TileDescriptor * _first, TileDescriptor * _second )
 
 }
 
-int calculate_nearest_tile( TileDescriptor * _tile, TileDescriptors * _tiles ) {
+/**
+ * @brief Store a tile descriptor into the table of descriptors
+ * 
+ * The descriptor is copied into the structure of arrays of the table, so
+ * the caller keeps the ownership of _descriptor.
+ * 
+ * @param _tiles table of descriptors
+ * @param _index index of the tile (0...255)
+ * @param _descriptor descriptor to store
+ */
+void tile_descriptors_set( TileDescriptors * _tiles, int _index, TileDescriptor * _descriptor ) {
 
-    int minAffinity = 0xffffff;
-    int nearestTileIndex = -1;
     int i;
 
-    for(i=0;i<256;++i) {
-        if ( _tiles->descriptor[i] ) {
-            int affinity = calculate_tile_affinity( _tile, _tiles->descriptor[i] );
-            if ( minAffinity > affinity ) {
-                minAffinity = affinity;
-                nearestTileIndex = i;
+    _tiles->used[_index] = 1;
+    _tiles->whiteArea[_index] = _descriptor->whiteArea;
+    for(i=0;i<8;++i) {
+        _tiles->edges[i][_index] = _descriptor->horizontalEdges[i];
+        _tiles->edges[8+i][_index] = _descriptor->verticalEdges[i];
+    }
+
+}
+
+// Number of tiles compared at once by tile_descriptors_search().
+#if defined(__AVX2__)
+    #define TILE_DESCRIPTORS_LANES      16
+#elif defined(__SSE2__)
+    #define TILE_DESCRIPTORS_LANES      8
+#else
+    #define TILE_DESCRIPTORS_LANES      1
+#endif
+
+/**
+ * @brief Find the used tile with the lowest affinity below a limit
+ * 
+ * Tiles are compared TILE_DESCRIPTORS_LANES at a time, using the SSE2 or
+ * AVX2 instructions when the compiler has them enabled. Since the distance
+ * of white areas alone is a lower bound of the affinity, a group of tiles
+ * whose white areas are all too far from the searched one is skipped
+ * without looking at the edges. On ties, the lowest index wins.
+ * 
+ * @param _tile descriptor to search for
+ * @param _tiles table of descriptors
+ * @param _limit only affinities strictly lower than this are accepted
+ * @return index of the tile found, or -1 if none
+ */
+static int tile_descriptors_search( TileDescriptor * _tile, TileDescriptors * _tiles, int _limit ) {
+
+    short features[17];
+    short affinities[TILE_DESCRIPTORS_LANES];
+    int best = _limit;
+    int bestIndex = -1;
+    int i, j, f;
+
+    features[0] = _tile->whiteArea;
+    for(i=0;i<8;++i) {
+        features[1+i] = _tile->horizontalEdges[i];
+        features[9+i] = _tile->verticalEdges[i];
+    }
+
+    for(i=0;i<256;i+=TILE_DESCRIPTORS_LANES) {
+
+#if defined(__AVX2__)
+
+        __m256i value = _mm256_set1_epi16( features[0] );
+        __m256i sum = _mm256_abs_epi16( _mm256_sub_epi16( _mm256_loadu_si256( (__m256i *) &_tiles->whiteArea[i] ), value ) );
+        __m128i lowest = _mm_min_epi16( _mm256_castsi256_si128( sum ), _mm256_extracti128_si256( sum, 1 ) );
+        lowest = _mm_minpos_epu16( lowest );
+        if ( _mm_extract_epi16( lowest, 0 ) >= best ) {
+            continue;
+        }
+        for(f=0;f<16;++f) {
+            value = _mm256_set1_epi16( features[1+f] );
+            sum = _mm256_add_epi16( sum, _mm256_abs_epi16( _mm256_sub_epi16( _mm256_loadu_si256( (__m256i *) &_tiles->edges[f][i] ), value ) ) );
+        }
+        _mm256_storeu_si256( (__m256i *) affinities, sum );
+
+#elif defined(__SSE2__)
+
+        __m128i value = _mm_set1_epi16( features[0] );
+        __m128i white = _mm_loadu_si128( (__m128i *) &_tiles->whiteArea[i] );
+        __m128i sum = _mm_max_epi16( _mm_sub_epi16( white, value ), _mm_sub_epi16( value, white ) );
+        __m128i lowest = _mm_min_epi16( sum, _mm_shuffle_epi32( sum, _MM_SHUFFLE( 1, 0, 3, 2 ) ) );
+        lowest = _mm_min_epi16( lowest, _mm_shuffle_epi32( lowest, _MM_SHUFFLE( 2, 3, 0, 1 ) ) );
+        lowest = _mm_min_epi16( lowest, _mm_shufflelo_epi16( lowest, _MM_SHUFFLE( 2, 3, 0, 1 ) ) );
+        if ( _mm_extract_epi16( lowest, 0 ) >= best ) {
+            continue;
+        }
+        for(f=0;f<16;++f) {
+            __m128i edges = _mm_loadu_si128( (__m128i *) &_tiles->edges[f][i] );
+            value = _mm_set1_epi16( features[1+f] );
+            sum = _mm_add_epi16( sum, _mm_max_epi16( _mm_sub_epi16( edges, value ), _mm_sub_epi16( value, edges ) ) );
+        }
+        _mm_storeu_si128( (__m128i *) affinities, sum );
+
+#else
+
+        affinities[0] = abs( _tiles->whiteArea[i] - features[0] );
+        if ( affinities[0] >= best ) {
+            continue;
+        }
+        for(f=0;f<16;++f) {
+            affinities[0] += abs( _tiles->edges[f][i] - features[1+f] );
+        }
+
+#endif
+
+        for(j=0;j<TILE_DESCRIPTORS_LANES;++j) {
+            if ( _tiles->used[i+j] && affinities[j] < best ) {
+                best = affinities[j];
+                bestIndex = i+j;
+                if ( ! best ) {
+                    return bestIndex;
+                }
             }
         }
+
     }
 
-    return nearestTileIndex;
+    return bestIndex;
 
 }
 
-int calculate_exact_tile( TileDescriptor * _tile, TileDescriptors * _tiles ) {
+int calculate_nearest_tile( TileDescriptor * _tile, TileDescriptors * _tiles ) {
 
-    int i=0;
+    return tile_descriptors_search( _tile, _tiles, 0xffffff );
 
-    if ( ! _tiles ) {
-        return -1;
-    }
+}
 
-    if ( ! _tiles->descriptor ) {
-        return -1;
-    }
+int calculate_exact_tile( TileDescriptor * _tile, TileDescriptors * _tiles ) {
 
-    for(i=0;i<256;++i) {
-        if ( _tiles->descriptor[i] ) {
-            if ( calculate_tile_affinity( _tile, _tiles->descriptor[i] ) == 0 ) {
-                return i;
-            };
-        }
+    if ( ! _tiles ) {
+        return -1;
     }
 
-    return -1;
+    return tile_descriptors_search( _tile, _tiles, 1 );
 
 }
 
@@ -9031,7 +9522,9 @@ int tile_allocate( TileDescriptors * _tiles, char * _data ) {
 
     memcpy( _tiles->data[_tiles->firstFree].data, _data, 8 );
 
-    _tiles->descriptor[_tiles->firstFree] = calculate_tile_descriptor( &_tiles->data[_tiles->firstFree] );
+    TileDescriptor * tileDescriptor = calculate_tile_descriptor( &_tiles->data[_tiles->firstFree] );
+    tile_descriptors_set( _tiles, _tiles->firstFree, tileDescriptor );
+    free( tileDescriptor );
 
     ++_tiles->count;
 
@@ -9421,25 +9914,25 @@ void rgbi_move( RGBi * _source, RGBi * _destination ) {
 }
 
 /**
- * @brief Calculate the distance between two colors
+ * @brief Calculate the squared distance between two colors
  *
- * This function calculates the color distance between two colors(_a and _b).
- * By "distance" we mean the geometric distance between two points in a 
- * three-dimensional space, where each dimension corresponds to one of the 
- * components (red, green and blue). The returned value is normalized to 
- * the nearest 8-bit value. 
+ * This function calculates the squared color distance between two colors,
+ * by weighting each component (red, green and blue) as the human eye does.
+ * The square root is not taken: since it is monotonic, the result is
+ * enough to look for the nearest color (that is, for every pixel of an
+ * image).
  * 
  * @param _e1 First color 
  * @param _e2 Second color
- * @return int distance
+ * @return int squared distance
  */
-int rgbi_distance( RGBi * _e1, RGBi * _e2 ) {
+int rgbi_distance_squared( RGBi * _e1, RGBi * _e2 ) {
 
-    long rmean = ( (long)_e1->red + (long)_e2->red ) / 2;
-    long r = (long)_e1->red - (long)_e2->red;
-    long g = (long)_e1->green - (long)_e2->green;
-    long b = (long)_e1->blue - (long)_e2->blue;
-    return (int)( sqrt((((512+rmean)*r*r)>>8) + 4*g*g + (((767-rmean)*b*b)>>8)) );
+    int rmean = ( _e1->red + _e2->red ) >> 1;
+    int r = _e1->red - _e2->red;
+    int g = _e1->green - _e2->green;
+    int b = _e1->blue - _e2->blue;
+    return (((512+rmean)*r*r)>>8) + 4*g*g + (((767-rmean)*b*b)>>8);
 
 }
 
@@ -9651,8 +10144,12 @@ int system_call( Environment * _environment, char * _commandline ) {
 
         // Now we can exec the batch file.
 
+        telemetry_begin_command( _environment, _commandline );
+
         int result = system( batchFileName2 );
 
+        telemetry_end( _environment );
+
         // Remove the temporary batch file.
 
         TRACE1( "  removing \"%s\"", batchFileName );
@@ -9675,8 +10172,12 @@ int system_call( Environment * _environment, char * _commandline ) {
 
         TRACE1( "  executing %s", _commandline );
 
+        telemetry_begin_command( _environment, _commandline );
+
         int result = system( _commandline );
 
+        telemetry_end( _environment );
+
         // Give back the result.
 
         TRACE1( "  result = %d", result );
@@ -9883,7 +10384,7 @@ RGBi * palette_match( RGBi * _source, int _source_size, RGBi * _system, int _sys
 
     for ( i=0; i<_source_size; ++i ) {
 
-        unsigned int minDistance = 0xffff;
+        unsigned int minDistance = 0xffffffff;
 
         for( j=0; j<_system_size; ++j ) {
             if ( _source[i].alpha < 255 ) {
@@ -9895,7 +10396,7 @@ RGBi * palette_match( RGBi * _source, int _source_size, RGBi * _system, int _sys
                 if ( _system[j].alpha < 255 ) {
                     continue;
                 }
-                unsigned int distance = rgbi_distance( &_source[i], &_system[j] );
+                unsigned int distance = rgbi_distance_squared( &_source[i], &_system[j] );
                 if ( distance < minDistance ) {
                     rgbi_move( &_system[j], &matchedPalette[i] );
                     minDistance = distance;
@@ -9917,11 +10418,11 @@ RGBi * palette_match_hardware_index( RGBi * _source, int _source_size, RGBi * _s
 
     for ( i=0; i<_source_size; ++i ) {
 
-        unsigned int minDistance = 0xffff;
+        unsigned int minDistance = 0xffffffff;
 
         for( j=0; j<_system_size; ++j ) {
 
-            unsigned int distance = rgbi_distance( &_source[i], &_system[j] );
+            unsigned int distance = rgbi_distance_squared( &_source[i], &_system[j] );
 
             if ( distance < minDistance ) {
                 rgbi_move( &_source[i], &matchedPalette[i] );
@@ -10193,6 +10694,26 @@ int assemblyLineIsAComment( char * _buffer ) {
     return 0;
 }
 
+/* returns true if the (part of) assembly line contains the given identifier */
+int assemblyLineHasToken( char * _buffer, char * _token ) {
+    int size = strlen( _token );
+    char * p = _buffer;
+    while( *p ) {
+        if ( isalnum( *p ) || *p == '_' || *p == '.' || *p == '@' ) {
+            char * start = p;
+            while( isalnum( *p ) || *p == '_' || *p == '.' || *p == '@' ) {
+                ++p;
+            }
+            if ( ( p - start ) == size && strncasecmp( start, _token, size ) == 0 ) {
+                return 1;
+            }
+        } else {
+            ++p;
+        }
+    }
+    return 0;
+}
+
 char * strtoupper( char * _string ) {
 
     char * target = strdup( _string );
@@ -10533,6 +11054,7 @@ Variable * variable_direct_assign( Environment * _environment, char * _var, char
     }
     memcpy( var->originalPalette, expr->originalPalette, MAX_PALETTE * sizeof( RGBi ) );
     var->memoryArea = expr->memoryArea;
+    var->memoryAreaRequested = expr->memoryAreaRequested;
     var->arrayDimensions = expr->arrayDimensions;
     memcpy( var->arrayDimensionsEach, expr->arrayDimensionsEach, MAX_ARRAY_DIMENSIONS * sizeof( int ) );
     var->arrayType = expr->arrayType;
@@ -10778,6 +11300,10 @@ int currentBufferOutput = 0;
 char * bufferOutput[16];
 int bufferOutputSize[16];
 
+// Changed every time the output is moved or rewritten, so that the
+// register tracker knows that its offsets are no longer valid.
+int bufferOutputGeneration = 1;
+
 static void buffered_realloc( const char * _ptr, int _size ) {
     if ( bufferOutput[currentBufferOutput] ) {
         bufferOutput[currentBufferOutput] = realloc( bufferOutput[currentBufferOutput], bufferOutputSize[currentBufferOutput] + _size );
@@ -10810,12 +11336,14 @@ size_t buffered_fwrite( void * _data, size_t _size, size_t _count, FILE * _strea
 
 void buffered_push_output( ) {
     ++currentBufferOutput;
+    ++bufferOutputGeneration;
 }
 
 void buffered_pop_output( ) {
     bufferOutput[currentBufferOutput] = NULL;
     bufferOutputSize[currentBufferOutput] = 0;
     --currentBufferOutput;
+    ++bufferOutputGeneration;
 }
 
 void buffered_prepend_output( ) {
@@ -10828,10 +11356,183 @@ void buffered_prepend_output( ) {
     buffered_pop_output( );
 }
 
+char * buffered_get_output( int * _size ) {
+    *_size = bufferOutputSize[currentBufferOutput];
+    return bufferOutput[currentBufferOutput];
+}
+
+void buffered_replace_output( int _start, int _end, char * _text, int _size ) {
+    int size = bufferOutputSize[currentBufferOutput] - ( _end - _start ) + _size;
+    char * p = malloc( size );
+    memcpy( p, bufferOutput[currentBufferOutput], _start );
+    memcpy( p + _start, _text, _size );
+    memcpy( p + _start + _size, bufferOutput[currentBufferOutput] + _end, bufferOutputSize[currentBufferOutput] - _end );
+    free( bufferOutput[currentBufferOutput] );
+    bufferOutput[currentBufferOutput] = p;
+    bufferOutputSize[currentBufferOutput] = size;
+    ++bufferOutputGeneration;
+}
+
 void buffered_output( FILE * _stream ) {
     fwrite( bufferOutput[currentBufferOutput], 1, bufferOutputSize[currentBufferOutput], _stream );
 }
 
+/**
+ * @brief Forget everything the registers are known to hold
+ * 
+ * @param _tracker Tracker to reset
+ */
+void register_tracker_reset( RegisterTracker * _tracker ) {
+
+    int i;
+
+    for( i=0; i<MAX_TRACKED_REGISTERS; ++i ) {
+        _tracker->content[i][0] = 0;
+        _tracker->alias[i][0] = 0;
+    }
+    _tracker->flags = -1;
+    _tracker->lastStart = -1;
+    _tracker->lastEnd = -1;
+    _tracker->previousStart = -1;
+    _tracker->previousEnd = -1;
+
+}
+
+/**
+ * @brief Forget every register related to the given memory operand
+ * 
+ * Called when the memory is changed. If _memory is NULL, every register 
+ * related to any memory operand is forgotten (i.e. after an indirect 
+ * store), while the constants are kept.
+ * 
+ * @param _tracker Tracker to update
+ * @param _memory Memory operand changed (or NULL)
+ */
+void register_tracker_forget( RegisterTracker * _tracker, char * _memory ) {
+
+    int i;
+
+    for( i=0; i<MAX_TRACKED_REGISTERS; ++i ) {
+        if ( _tracker->content[i][0] != '#' && ( !_memory || strcmp( _tracker->content[i], _memory ) == 0 ) ) {
+            _tracker->content[i][0] = 0;
+        }
+        if ( !_memory || strcmp( _tracker->alias[i], _memory ) == 0 ) {
+            _tracker->alias[i][0] = 0;
+        }
+    }
+
+}
+
+/**
+ * @brief Track the content of the registers on the generated lines
+ * 
+ * This function is called every time a line has been emitted. It passes
+ * every complete line, not yet seen, to the per-CPU 
+ * <code>cpu_register_track()</code>, so that the registers are tracked 
+ * also across code written directly on the output (like embedded modules).
+ * Any label invalidates what is known, since the code could be reached
+ * from elsewhere. If the CPU says that the last line loads a register with 
+ * what it already holds, the line is removed from the output.
+ * 
+ * @param _environment Current calling environment
+ */
+void register_tracker_update( Environment * _environment ) {
+
+    RegisterTracker * tracker = &_environment->registerTracker;
+
+    if ( _environment->peepholeOptimizationLimit <= 0 ) {
+        return;
+    }
+
+    if ( tracker->buffer != currentBufferOutput || tracker->generation != bufferOutputGeneration || 
+            tracker->offset > bufferOutputSize[currentBufferOutput] ) {
+        register_tracker_reset( tracker );
+        tracker->buffer = currentBufferOutput;
+        tracker->generation = bufferOutputGeneration;
+        tracker->blind = 0;
+        // Start from the last complete line, since nothing is known before it.
+        tracker->offset = bufferOutputSize[currentBufferOutput] - 1;
+        while( tracker->offset > 0 && bufferOutput[currentBufferOutput][tracker->offset-1] != '\n' ) {
+            --tracker->offset;
+        }
+        if ( tracker->offset < 0 ) {
+            tracker->offset = 0;
+        }
+    }
+
+    while( tracker->offset < bufferOutputSize[currentBufferOutput] ) {
+
+        char * buffer = bufferOutput[currentBufferOutput];
+        int size = bufferOutputSize[currentBufferOutput];
+        int start = tracker->offset;
+        int end = start;
+        char line[MAX_TEMPORARY_STORAGE];
+
+        while( end < size && buffer[end] != '\n' ) {
+            ++end;
+        }
+
+        if ( end == size ) {
+            break;
+        }
+
+        tracker->offset = end + 1;
+
+        if ( ( end - start ) >= MAX_TEMPORARY_STORAGE ) {
+            register_tracker_reset( tracker );
+            continue;
+        }
+
+        memcpy( line, &buffer[start], end - start );
+        line[end-start] = 0;
+        if ( end > start && line[end-start-1] == '\r' ) {
+            line[end-start-1] = 0;
+        }
+
+        if ( assemblyLineIsAComment( line ) ) {
+            continue;
+        }
+
+        // Labels (and directives) start from the first column, or end with a colon.
+        if ( line[0] != ' ' && line[0] != '\t' ) {
+            register_tracker_reset( tracker );
+            continue;
+        } else {
+            char * p = line;
+            while( *p == ' ' || *p == '\t' ) {
+                ++p;
+            }
+            while( *p && *p != ' ' && *p != '\t' && *p != ';' ) {
+                ++p;
+            }
+            if ( *(p-1) == ':' ) {
+                register_tracker_reset( tracker );
+                continue;
+            }
+        }
+
+        if ( tracker->blind > 0 ) {
+            --tracker->blind;
+            register_tracker_reset( tracker );
+            continue;
+        }
+
+        if ( cpu_register_track( _environment, tracker, line, start, end + 1 ) ) {
+            // Only the last line can be removed: anything before it could
+            // have been already referred to.
+            if ( tracker->offset == bufferOutputSize[currentBufferOutput] ) {
+                bufferOutputSize[currentBufferOutput] = start;
+                tracker->offset = start;
+                if ( _environment->producedAssemblyLines > 0 ) {
+                    --_environment->producedAssemblyLines;
+                }
+            }
+        }
+
+    }
+
+}
+
 void get_image_overwrite_size( Environment * _environment, char * _image, char * _x1, char * _y1, char * _x2, char * _y2 ) {
 
     Variable * image = variable_retrieve( _environment, _image );
@@ -10978,6 +11679,10 @@ void prepare_variable_storage( Environment * _environment, char * _name, Variabl
         memset( v->valueBuffer, 0, v->size );
     }
 
+    // The variable stays compressed (if the file is): only a DLOAD
+    // that uncompresses while reading will change it, by calling
+    // file_storage_uncompressed().
+    fileStorage->variable = v;
     v->onStorage = 1;
 
 }
@@ -0,0 +1,490 @@
+/*****************************************************************************
+ * ugBASIC - an isomorphic BASIC language compiler for retrocomputers        *
+ *****************************************************************************
+ * Copyright 2021-2024 Marco Spedaletti (asimov@mclink.it)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *----------------------------------------------------------------------------
+ * Concesso in licenza secondo i termini della Licenza Apache, versione 2.0
+ * (la "Licenza"); è proibito usare questo file se non in conformità alla
+ * Licenza. Una copia della Licenza è disponibile all'indirizzo:
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Se non richiesto dalla legislazione vigente o concordato per iscritto,
+ * il software distribuito nei termini della Licenza è distribuito
+ * "COSÌ COM'È", SENZA GARANZIE O CONDIZIONI DI ALCUN TIPO, esplicite o
+ * implicite. Consultare la Licenza per il testo specifico che regola le
+ * autorizzazioni e le limitazioni previste dalla medesima.
+ ****************************************************************************/
+
+/****************************************************************************
+ * INCLUDE SECTION 
+ ****************************************************************************/
+
+#include "../../ugbc.h"
+
+/****************************************************************************
+ * CODE SECTION 
+ ****************************************************************************/
+
+// Initial number of free holes tracked for each memory area.
+#define MEMORY_MAP_HOLES            16
+
+typedef struct _MemoryMapHole {
+
+    int start;
+    int end;
+
+} MemoryMapHole;
+
+typedef struct _MemoryMapCandidate {
+
+    Variable * variable;
+    int size;
+    int alignment;
+    int noPageCrossing;
+
+} MemoryMapCandidate;
+
+typedef struct _MemoryMapAreaState {
+
+    MemoryArea * area;
+    MemoryMapHole * holes;
+    int count;
+    int capacity;
+
+} MemoryMapAreaState;
+
+static int memory_map_candidate_compare( const void * _first, const void * _second ) {
+
+    MemoryMapCandidate * first = (MemoryMapCandidate *) _first;
+    MemoryMapCandidate * second = (MemoryMapCandidate *) _second;
+
+    if ( first->alignment != second->alignment ) {
+        return second->alignment - first->alignment;
+    }
+    if ( first->noPageCrossing != second->noPageCrossing ) {
+        return second->noPageCrossing - first->noPageCrossing;
+    }
+    if ( first->size != second->size ) {
+        return second->size - first->size;
+    }
+    return strcmp( first->variable->realName, second->variable->realName );
+
+}
+
+static int memory_map_item_compare( const void * _first, const void * _second ) {
+
+    MemoryMapItem * first = *(MemoryMapItem **) _first;
+    MemoryMapItem * second = *(MemoryMapItem **) _second;
+
+    return first->address - second->address;
+
+}
+
+static void memory_map_item_add( Environment * _environment, char * _name, MemoryArea * _area, int _address, int _size ) {
+
+    MemoryMapItem * item = malloc( sizeof( MemoryMapItem ) );
+    memset( item, 0, sizeof( MemoryMapItem ) );
+    item->name = strdup( _name );
+    item->area = _area;
+    item->address = _address;
+    item->size = _size;
+
+    MemoryMapItem * last = _environment->memoryMapItems;
+    if ( last ) {
+        while( last->next ) {
+            last = last->next;
+        }
+        last->next = item;
+    } else {
+        _environment->memoryMapItems = item;
+    }
+
+}
+
+static int memory_map_area_accepts( MemoryArea * _area, Variable * _variable ) {
+
+    // A RAM area is not loaded with the program, so it cannot keep 
+    // anything that has an initial content.
+    if ( _area->type == MAT_RAM ) {
+        switch( _variable->type ) {
+            case VT_STRING:
+            case VT_BUFFER:
+            case VT_IMAGE:
+            case VT_IMAGES:
+            case VT_SEQUENCE:
+            case VT_MUSIC:
+                return 0;
+            default:
+                break;
+        }
+    }
+
+    return 1;
+
+}
+
+// Calculate where a candidate would be placed inside a hole, or -1 if
+// it does not fit.
+static int memory_map_fit( MemoryMapHole * _hole, MemoryMapCandidate * _candidate ) {
+
+    int address = _hole->start;
+
+    if ( _candidate->alignment > 1 ) {
+        address = ( address + _candidate->alignment - 1 ) & ~( _candidate->alignment - 1 );
+    }
+    if ( _candidate->noPageCrossing && ( ( address & 0xff ) + _candidate->size ) > 0x100 ) {
+        address = ( address + 0xff ) & ~0xff;
+    }
+    if ( ( address + _candidate->size ) > _hole->end ) {
+        return -1;
+    }
+
+    return address;
+
+}
+
+static void memory_map_candidate_add( MemoryMapCandidate * _candidates, int * _count, int _max, Variable * _variable ) {
+
+    while( _variable ) {
+        // A variable assigned to another one is never emitted, so it
+        // must not take any space.
+        if ( _variable->memoryAreaRequested && _variable->assigned ) {
+            _variable->memoryArea = NULL;
+        } else if ( _variable->memoryAreaRequested && *_count < _max ) {
+            MemoryMapCandidate * candidate = &_candidates[(*_count)++];
+            candidate->variable = _variable;
+            candidate->size = _variable->memoryAreaRequested;
+            candidate->alignment = 1;
+            candidate->noPageCrossing = 0;
+#ifdef __UGBC_CPU6502__
+            // Indexed accesses pay one more cycle when crossing a page:
+            // tables that fit a page are kept inside a single page, and 
+            // bigger tables made of whole pages are page aligned.
+            if ( _variable->type == VT_ARRAY || _variable->type == VT_BUFFER ) {
+                if ( candidate->size <= 0x100 ) {
+                    candidate->noPageCrossing = 1;
+                } else if ( ( candidate->size & 0xff ) == 0 ) {
+                    candidate->alignment = 0x100;
+                }
+            }
+#endif
+        }
+        _variable = _variable->next;
+    }
+
+}
+
+/**
+ * @brief Place variables into the memory areas of the target
+ * 
+ * Every variable that asked for a memory area (see memory_area_assign())
+ * is placed here, at the end of compilation. This is a bin packing problem
+ * over the free holes of all the memory areas: it is solved with a "best
+ * fit decreasing" strategy, that is, the most constrained and biggest 
+ * variables are placed first, each in the hole that leaves the smallest 
+ * amount of space unused. Alignment and page crossing constraints are
+ * honored. Variables that do not fit anywhere stay in main memory.
+ * 
+ * The packer is limited to the variables placed into memory areas and to
+ * the runtime buffers (see memory_map_allocate()): code, images and string
+ * pools are still laid out by the linker configuration of each target,
+ * and no segment or .org is emitted here. Only the targets that describe
+ * their free memory with MEMORY_AREA_DEFINE (today, c64) and whose 
+ * emitters honor the address chosen here take advantage of it: vic20, mo5,
+ * d32, sg1000 and the others keep their areas disabled in their _init.c,
+ * so there is nothing to pack.
+ * 
+ * @param _environment Current calling environment
+ */
+void memory_map_pack( Environment * _environment ) {
+
+    if ( _environment->memoryMapPacked ) {
+        return;
+    }
+    _environment->memoryMapPacked = 1;
+
+    int areaCount = 0;
+    MemoryArea * area = _environment->memoryAreas;
+    while( area ) {
+        ++areaCount;
+        area = area->next;
+    }
+
+    if ( ! areaCount ) {
+        return;
+    }
+
+    MemoryMapAreaState * states = malloc( areaCount * sizeof( MemoryMapAreaState ) );
+    memset( states, 0, areaCount * sizeof( MemoryMapAreaState ) );
+
+    int i = 0, j = 0, k = 0;
+
+    area = _environment->memoryAreas;
+    for( i=0; i<areaCount; ++i ) {
+        states[i].area = area;
+        states[i].capacity = MEMORY_MAP_HOLES;
+        states[i].holes = malloc( states[i].capacity * sizeof( MemoryMapHole ) );
+        states[i].holes[0].start = area->start;
+        states[i].holes[0].end = area->end;
+        states[i].count = 1;
+        area = area->next;
+    }
+
+    int maxCandidates = 0;
+    Variable * variable = _environment->variables;
+    while( variable ) { ++maxCandidates; variable = variable->next; }
+    for( i=0; i<(_environment->currentProcedure+1); ++i ) {
+        variable = _environment->tempVariables[i];
+        while( variable ) { ++maxCandidates; variable = variable->next; }
+    }
+    variable = _environment->tempResidentVariables;
+    while( variable ) { ++maxCandidates; variable = variable->next; }
+
+    MemoryMapCandidate * candidates = malloc( ( maxCandidates + 1 ) * sizeof( MemoryMapCandidate ) );
+    int candidateCount = 0;
+
+    memory_map_candidate_add( candidates, &candidateCount, maxCandidates, _environment->variables );
+    for( i=0; i<(_environment->currentProcedure+1); ++i ) {
+        memory_map_candidate_add( candidates, &candidateCount, maxCandidates, _environment->tempVariables[i] );
+    }
+    memory_map_candidate_add( candidates, &candidateCount, maxCandidates, _environment->tempResidentVariables );
+
+    qsort( candidates, candidateCount, sizeof( MemoryMapCandidate ), memory_map_candidate_compare );
+
+    for( i=0; i<candidateCount; ++i ) {
+
+        MemoryMapCandidate * candidate = &candidates[i];
+        int bestArea = -1, bestHole = -1, bestAddress = -1, bestWaste = 0, bestPadding = 0;
+
+        candidate->variable->memoryArea = NULL;
+
+        for( j=0; j<areaCount; ++j ) {
+            if ( ! memory_map_area_accepts( states[j].area, candidate->variable ) ) {
+                continue;
+            }
+            for( k=0; k<states[j].count; ++k ) {
+                int address = memory_map_fit( &states[j].holes[k], candidate );
+                if ( address < 0 ) {
+                    continue;
+                }
+                // The space wasted is the padding before the variable (due 
+                // to alignment or page crossing) plus what is left after it.
+                // On equal waste, the placement with less padding is better,
+                // since the space left after the variable stays contiguous.
+                int padding = address - states[j].holes[k].start;
+                int waste = padding + ( states[j].holes[k].end - ( address + candidate->size ) );
+                if ( bestArea < 0 || waste < bestWaste || ( waste == bestWaste && padding < bestPadding ) ) {
+                    bestArea = j;
+                    bestHole = k;
+                    bestAddress = address;
+                    bestWaste = waste;
+                    bestPadding = padding;
+                }
+            }
+        }
+
+        if ( bestArea < 0 ) {
+            memory_map_item_add( _environment, candidate->variable->realName, NULL, 0, candidate->size );
+            continue;
+        }
+
+        // Split the hole around the variable: the part before it (due to
+        // alignment) stays in place, the part after it is appended.
+        MemoryMapAreaState * state = &states[bestArea];
+        MemoryMapHole hole = state->holes[bestHole];
+        state->holes[bestHole].end = bestAddress;
+        if ( state->holes[bestHole].start == state->holes[bestHole].end ) {
+            state->holes[bestHole] = state->holes[--state->count];
+        }
+        if ( ( bestAddress + candidate->size ) < hole.end ) {
+            if ( state->count == state->capacity ) {
+                state->capacity *= 2;
+                state->holes = realloc( state->holes, state->capacity * sizeof( MemoryMapHole ) );
+            }
+            state->holes[state->count].start = bestAddress + candidate->size;
+            state->holes[state->count].end = hole.end;
+            ++state->count;
+        }
+
+        candidate->variable->memoryArea = state->area;
+        candidate->variable->absoluteAddress = bestAddress;
+        memory_map_item_add( _environment, candidate->variable->realName, state->area, bestAddress, candidate->size );
+
+    }
+
+    // Runtime buffers allocated later (see memory_map_allocate()) are
+    // appended after the last variable of each area.
+    for( i=0; i<areaCount; ++i ) {
+        area = states[i].area;
+        area->current = area->start;
+        MemoryMapItem * item = _environment->memoryMapItems;
+        while( item ) {
+            if ( item->area == area && ( item->address + item->size ) > area->current ) {
+                area->current = item->address + item->size;
+            }
+            item = item->next;
+        }
+        area->size = area->end - area->current;
+    }
+
+    for( i=0; i<areaCount; ++i ) {
+        free( states[i].holes );
+    }
+    free( candidates );
+    free( states );
+
+}
+
+/**
+ * @brief Allocate a runtime buffer into the memory areas
+ * 
+ * The buffer is appended to the memory area that has the smallest free
+ * space still big enough to contain it (best fit).
+ * 
+ * @param _environment Current calling environment
+ * @param _name Label of the buffer (for the memory map report)
+ * @param _size Size of the buffer, in bytes
+ * @return Memory area chosen, or NULL if it has to stay in main memory
+ */
+MemoryArea * memory_map_allocate( Environment * _environment, char * _name, int _size ) {
+
+    memory_map_pack( _environment );
+
+    MemoryArea * best = NULL;
+    MemoryArea * actual = _environment->memoryAreas;
+    while( actual ) {
+        if ( actual->size >= _size && ( ! best || actual->size < best->size ) ) {
+            best = actual;
+        }
+        actual = actual->next;
+    }
+
+    if ( best ) {
+        memory_map_item_add( _environment, _name, best, best->current, _size );
+        best->current += _size;
+        best->size -= _size;
+    }
+
+    return best;
+
+}
+
+/**
+ * @brief Write the memory map report
+ * 
+ * For each memory area the report gives the space used, the free space,
+ * the number of free holes and the biggest of them. Fragmentation is the
+ * share of free space that is not part of the biggest hole: 0% means that
+ * all the free space can be used by a single element. Then, all the 
+ * elements placed are listed by address.
+ * 
+ * @param _environment Current calling environment
+ */
+void memory_map_report( Environment * _environment ) {
+
+    if ( ! _environment->memoryMapFileName ) {
+        return;
+    }
+
+    FILE * handle = fopen( _environment->memoryMapFileName, "wt" );
+    if ( ! handle ) {
+        return;
+    }
+
+    int itemCount = 0;
+    MemoryMapItem * item = _environment->memoryMapItems;
+    while( item ) { ++itemCount; item = item->next; }
+
+    MemoryMapItem ** items = malloc( ( itemCount + 1 ) * sizeof( MemoryMapItem * ) );
+    itemCount = 0;
+    item = _environment->memoryMapItems;
+    while( item ) { items[itemCount++] = item; item = item->next; }
+    qsort( items, itemCount, sizeof( MemoryMapItem * ), memory_map_item_compare );
+
+    fprintf( handle, "MEMORY MAP\n\n" );
+    fprintf( handle, "AREA   TYPE    START  END     SIZE   USED   FREE  HOLES LARGEST FRAGMENTATION\n" );
+
+    int totalSize = 0, totalUsed = 0;
+    MemoryArea * area = _environment->memoryAreas;
+    while( area ) {
+
+        int used = 0, holes = 0, largest = 0, cursor = area->start, i;
+
+        for( i=0; i<itemCount; ++i ) {
+            if ( items[i]->area != area ) {
+                continue;
+            }
+            if ( items[i]->address > cursor ) {
+                ++holes;
+                if ( ( items[i]->address - cursor ) > largest ) {
+                    largest = items[i]->address - cursor;
+                }
+            }
+            used += items[i]->size;
+            cursor = items[i]->address + items[i]->size;
+        }
+        if ( area->end > cursor ) {
+            ++holes;
+            if ( ( area->end - cursor ) > largest ) {
+                largest = area->end - cursor;
+            }
+        }
+
+        int size = area->end - area->start;
+        int free = size - used;
+
+        fprintf( handle, "MA%3.3x  %-6s  $%4.4x  $%4.4x  %5d  %5d  %5d  %5d  %5d  %11d%%\n", 
+            area->id, 
+            area->type == MAT_DIRECT ? "direct" : ( area->type == MAT_GATED ? "gated" : "ram" ),
+            area->start, area->end, size, used, free, holes, largest,
+            free ? ( 100 - ( 100 * largest ) / free ) : 0 );
+
+        totalSize += size;
+        totalUsed += used;
+
+        area = area->next;
+
+    }
+
+    if ( ! _environment->memoryAreas ) {
+        fprintf( handle, "(this target has no memory areas: everything is in main memory)\n" );
+    } else {
+        fprintf( handle, "\nTOTAL %d bytes, %d used, %d free\n", totalSize, totalUsed, totalSize - totalUsed );
+    }
+
+    fprintf( handle, "\nELEMENTS\n\n" );
+    for( int i=0; i<itemCount; ++i ) {
+        if ( items[i]->area ) {
+            fprintf( handle, "$%4.4x-$%4.4x %5d MA%3.3x %s\n", 
+                items[i]->address, items[i]->address + items[i]->size - 1, items[i]->size, items[i]->area->id, items[i]->name );
+        }
+    }
+
+    int notPlaced = 0;
+    for( int i=0; i<itemCount; ++i ) {
+        if ( ! items[i]->area ) {
+            if ( ! notPlaced++ ) {
+                fprintf( handle, "\nNOT PLACED (kept in main memory)\n\n" );
+            }
+            fprintf( handle, "            %5d       %s\n", items[i]->size, items[i]->name );
+        }
+    }
+
+    fclose( handle );
+
+    free( items );
+
+}
@@ -378,6 +378,8 @@ Variable * music_load_to_variable( Environment * _environment, char * _filename,
 
     int size = 0;
     
+    telemetry_begin_resource( _environment, "midi decoding", _filename );
+
     MidiFile * mf = midiFileOpen(_filename);
 
     // If the file to read is a MIDI...
@@ -629,6 +631,8 @@ Variable * music_load_to_variable( Environment * _environment, char * _filename,
 
     }
 
+    telemetry_end( _environment );
+
     variable_store_buffer( _environment, result->name, imfBuffer, size, 0 );
 
     if ( _bank_expansion && _environment->expansionBanks ) {
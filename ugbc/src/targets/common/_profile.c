@@ -0,0 +1,664 @@
+/*****************************************************************************
+ * ugBASIC - an isomorphic BASIC language compiler for retrocomputers        *
+ *****************************************************************************
+ * Copyright 2021-2024 Marco Spedaletti (asimov@mclink.it)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *----------------------------------------------------------------------------
+ * Concesso in licenza secondo i termini della Licenza Apache, versione 2.0
+ * (la "Licenza"); è proibito usare questo file se non in conformità alla
+ * Licenza. Una copia della Licenza è disponibile all'indirizzo:
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Se non richiesto dalla legislazione vigente o concordato per iscritto,
+ * il software distribuito nei termini della Licenza è distribuito
+ * "COSÌ COM'È", SENZA GARANZIE O CONDIZIONI DI ALCUN TIPO, esplicite o
+ * implicite. Consultare la Licenza per il testo specifico che regola le
+ * autorizzazioni e le limitazioni previste dalla medesima.
+ ****************************************************************************/
+
+/****************************************************************************
+ * INCLUDE SECTION 
+ ****************************************************************************/
+
+#include "../../ugbc.h"
+
+#include <ctype.h>
+
+/****************************************************************************
+ * CODE SECTION 
+ ****************************************************************************/
+
+/*
+ * The profiler report joins three sources of information:
+ *
+ *  - the assembly file, where the compiler left the "; L:<line>" markers
+ *    for each BASIC statement, the "; F:<procedure>" markers for each
+ *    PROCEDURE and the "; M:<module>" markers around each runtime module
+ *    deployed by the deploy() macro;
+ *  - the profiled listing (-P), where each line of the assembly listing
+ *    is prefixed by the number of cycles spent on it (-q);
+ *  - the call instructions (JSR, BSR, LBSR, CALL) found in the code, used
+ *    to give back the cycles spent inside runtime modules and procedures
+ *    to the statements that called them.
+ *
+ * Cycles of a callee are distributed among its call sites in proportion
+ * to the cycles spent on the call instruction itself (that is, to the
+ * number of times it has been executed).
+ */
+
+#define PROFILE_MAIN            "main"
+
+typedef struct _ProfileEntry {
+
+    // Normalized code of the assembly line (without comments).
+    char * code;
+
+    // BASIC source line, as per last "; L:" marker.
+    int line;
+
+    // Unit (procedure or runtime module) the line belongs to.
+    int unit;
+
+    // Label defined by this line, if any.
+    char * label;
+
+    // Target of the call instruction, if any.
+    char * callee;
+    int calleeUnit;
+
+    // Cycles spent on this line (from the profiled listing).
+    double cycles;
+
+} ProfileEntry;
+
+typedef struct _ProfileUnit {
+
+    char * name;
+
+    // 1 if this is a runtime module, 0 if it is a procedure (or main).
+    int module;
+
+    double exclusive;
+    double inclusive;
+    double callWeight;
+
+    // 0 = to be calculated, 1 = calculating, 2 = calculated
+    int status;
+
+} ProfileUnit;
+
+typedef struct _Profile {
+
+    ProfileEntry * entries;
+    int entriesCount;
+    int entriesSize;
+
+    ProfileUnit * units;
+    int unitsCount;
+    int unitsSize;
+
+    int maxLine;
+
+} Profile;
+
+static void profile_normalize( char * _line ) {
+
+    char * p = _line;
+    char * q = _line;
+    int space = 1;
+
+    while( *p ) {
+        if ( *p == ' ' || *p == '\t' || *p == '\r' || *p == '\n' ) {
+            if ( !space ) {
+                *q++ = ' ';
+                space = 1;
+            }
+        } else {
+            *q++ = *p;
+            space = 0;
+        }
+        ++p;
+    }
+    if ( q > _line && *(q-1) == ' ' ) {
+        --q;
+    }
+    *q = 0;
+
+}
+
+static int profile_unit( Profile * _profile, char * _name, int _module ) {
+
+    int i;
+
+    for( i=0; i<_profile->unitsCount; ++i ) {
+        if ( _profile->units[i].module == _module && strcmp( _profile->units[i].name, _name ) == 0 ) {
+            return i;
+        }
+    }
+
+    if ( _profile->unitsCount == _profile->unitsSize ) {
+        _profile->unitsSize = _profile->unitsSize ? 2 * _profile->unitsSize : 64;
+        _profile->units = realloc( _profile->units, _profile->unitsSize * sizeof( ProfileUnit ) );
+    }
+
+    ProfileUnit * unit = &_profile->units[_profile->unitsCount];
+    memset( unit, 0, sizeof( ProfileUnit ) );
+    unit->name = strdup( _name );
+    unit->module = _module;
+
+    return _profile->unitsCount++;
+
+}
+
+static ProfileEntry * profile_entry( Profile * _profile ) {
+
+    if ( _profile->entriesCount == _profile->entriesSize ) {
+        _profile->entriesSize = _profile->entriesSize ? 2 * _profile->entriesSize : 1024;
+        _profile->entries = realloc( _profile->entries, _profile->entriesSize * sizeof( ProfileEntry ) );
+    }
+
+    ProfileEntry * entry = &_profile->entries[_profile->entriesCount++];
+    memset( entry, 0, sizeof( ProfileEntry ) );
+    entry->calleeUnit = -1;
+
+    return entry;
+
+}
+
+/*
+ * Extract the label defined and the routine called by a line of code, if
+ * any. Labels start at the first column, while instructions are indented.
+ */
+static void profile_decode( ProfileEntry * _entry, char * _raw ) {
+
+    char buffer[MAX_TEMPORARY_STORAGE];
+    char * token;
+
+    strncpy( buffer, _entry->code, MAX_TEMPORARY_STORAGE - 1 );
+    buffer[MAX_TEMPORARY_STORAGE - 1] = 0;
+
+    token = strtok( buffer, " " );
+    if ( !token ) {
+        return;
+    }
+
+    if ( *_raw != ' ' && *_raw != '\t' ) {
+        char * colon = strchr( token, ':' );
+        if ( colon ) {
+            *colon = 0;
+        }
+        if ( *token && *token != '.' && *token != '@' ) {
+            _entry->label = strdup( token );
+        }
+        token = strtok( NULL, " " );
+        if ( !token ) {
+            return;
+        }
+    }
+
+    if ( strcasecmp( token, "JSR" ) == 0 || strcasecmp( token, "BSR" ) == 0 || 
+            strcasecmp( token, "LBSR" ) == 0 || strcasecmp( token, "CALL" ) == 0 ) {
+        char * target = strtok( NULL, "" );
+        if ( target ) {
+            // CALL cc, label
+            char * comma = strrchr( target, ',' );
+            if ( comma ) {
+                target = comma + 1;
+            }
+            while( *target == ' ' ) {
+                ++target;
+            }
+            _entry->callee = strdup( target );
+        }
+    }
+
+}
+
+static void profile_load_assembly( Profile * _profile, FILE * _file ) {
+
+    char raw[MAX_TEMPORARY_STORAGE];
+    char code[MAX_TEMPORARY_STORAGE];
+
+    int line = 0;
+    int procedure = profile_unit( _profile, PROFILE_MAIN, 0 );
+    int module = -1;
+
+    while( fgets( raw, MAX_TEMPORARY_STORAGE, _file ) ) {
+
+        // Split code from (maybe merged) comments, and look for markers.
+        char * comment = strchr( raw, ';' );
+
+        strcpy( code, raw );
+        if ( comment ) {
+            code[comment - raw] = 0;
+        }
+        profile_normalize( code );
+
+        if ( *code ) {
+            ProfileEntry * entry = profile_entry( _profile );
+            entry->code = strdup( code );
+            entry->line = line;
+            entry->unit = ( module >= 0 ) ? module : procedure;
+            profile_decode( entry, raw );
+        }
+
+        while( comment ) {
+            char marker[MAX_TEMPORARY_STORAGE];
+            char * next = strchr( comment + 1, ';' );
+            int size = next ? ( next - comment - 1 ) : strlen( comment + 1 );
+            memcpy( marker, comment + 1, size );
+            marker[size] = 0;
+            profile_normalize( marker );
+            if ( strncmp( marker, "L:", 2 ) == 0 ) {
+                line = atoi( marker + 2 );
+                if ( line > _profile->maxLine ) {
+                    _profile->maxLine = line;
+                }
+            } else if ( strncmp( marker, "F:", 2 ) == 0 ) {
+                procedure = profile_unit( _profile, marker[2] ? marker + 2 : PROFILE_MAIN, 0 );
+            } else if ( strncmp( marker, "M:", 2 ) == 0 ) {
+                module = marker[2] ? profile_unit( _profile, marker + 2, 1 ) : -1;
+            }
+            comment = next;
+        }
+
+    }
+
+}
+
+/*
+ * Each line of the profiled listing is the original line of the listing,
+ * prefixed by the number of cycles spent on it. Lines are matched against
+ * the assembly in order, like target_finalize() does for the listing.
+ */
+static void profile_load_cycles( Profile * _profile, FILE * _file ) {
+
+    char raw[MAX_TEMPORARY_STORAGE];
+
+    int current = 0;
+
+    while( fgets( raw, MAX_TEMPORARY_STORAGE, _file ) && current < _profile->entriesCount ) {
+
+        char * text = raw;
+        double cycles = 0;
+        int i;
+
+        while( *text == ' ' || *text == '\t' ) {
+            ++text;
+        }
+        if ( isdigit( *text ) ) {
+            cycles = strtod( text, &text );
+            if ( *text == ':' || *text == '|' ) {
+                ++text;
+            }
+        }
+
+        profile_normalize( text );
+        if ( ! *text ) {
+            continue;
+        }
+
+        // Some lines (i.e. directives expanded by the assembler) could
+        // be missing from the listing: look a little bit ahead.
+        for( i=current; i<_profile->entriesCount && i<current+16; ++i ) {
+            if ( strstr( text, _profile->entries[i].code ) ) {
+                _profile->entries[i].cycles += cycles;
+                current = i + 1;
+                break;
+            }
+        }
+
+    }
+
+}
+
+// Labels sorted by name and, for the same name, by position.
+static int profile_label_compare( const void * _first, const void * _second ) {
+
+    ProfileEntry * first = *(ProfileEntry **) _first;
+    ProfileEntry * second = *(ProfileEntry **) _second;
+
+    int result = strcmp( first->label, second->label );
+    if ( result ) {
+        return result;
+    }
+    return ( first < second ) ? -1 : ( first > second );
+
+}
+
+/*
+ * Find the unit of each routine called. The labels are sorted once, so 
+ * that every call site is resolved with a binary search: when a label is
+ * defined more than once, the first definition wins.
+ */
+static void profile_resolve_calls( Profile * _profile ) {
+
+    int i, count = 0;
+
+    ProfileEntry ** labels = malloc( ( _profile->entriesCount + 1 ) * sizeof( ProfileEntry * ) );
+    for( i=0; i<_profile->entriesCount; ++i ) {
+        if ( _profile->entries[i].label ) {
+            labels[count++] = &_profile->entries[i];
+        }
+    }
+    qsort( labels, count, sizeof( ProfileEntry * ), profile_label_compare );
+
+    for( i=0; i<_profile->entriesCount; ++i ) {
+        ProfileEntry * entry = &_profile->entries[i];
+        if ( ! entry->callee ) {
+            continue;
+        }
+        int low = 0, high = count;
+        while( low < high ) {
+            int middle = ( low + high ) / 2;
+            if ( strcmp( labels[middle]->label, entry->callee ) < 0 ) {
+                low = middle + 1;
+            } else {
+                high = middle;
+            }
+        }
+        if ( low < count && strcmp( labels[low]->label, entry->callee ) == 0 ) {
+            if ( labels[low]->unit != entry->unit ) {
+                entry->calleeUnit = labels[low]->unit;
+                _profile->units[entry->calleeUnit].callWeight += entry->cycles;
+            }
+        }
+    }
+
+    free( labels );
+
+}
+
+static double profile_share( Profile * _profile, ProfileEntry * _entry );
+
+static double profile_inclusive( Profile * _profile, int _unit ) {
+
+    ProfileUnit * unit = &_profile->units[_unit];
+    int i;
+
+    // Recursive calls are accounted only for their exclusive cycles.
+    if ( unit->status == 1 ) {
+        return unit->exclusive;
+    } else if ( unit->status == 2 ) {
+        return unit->inclusive;
+    }
+
+    unit->status = 1;
+    unit->inclusive = unit->exclusive;
+    for( i=0; i<_profile->entriesCount; ++i ) {
+        if ( _profile->entries[i].unit == _unit ) {
+            unit->inclusive += profile_share( _profile, &_profile->entries[i] );
+        }
+    }
+    unit->status = 2;
+
+    return unit->inclusive;
+
+}
+
+// Cycles of the called unit given back to this call instruction.
+static double profile_share( Profile * _profile, ProfileEntry * _entry ) {
+
+    if ( _entry->calleeUnit < 0 || _entry->cycles == 0 ) {
+        return 0;
+    }
+
+    ProfileUnit * callee = &_profile->units[_entry->calleeUnit];
+
+    return profile_inclusive( _profile, _entry->calleeUnit ) * _entry->cycles / callee->callWeight;
+
+}
+
+#define PROFILE_MAX_DEPTH       16
+
+static void profile_folded( Profile * _profile, FILE * _file, int _unit, char * _stack, double _scale, int _depth ) {
+
+    ProfileUnit * unit = &_profile->units[_unit];
+    char stack[MAX_TEMPORARY_STORAGE];
+    int i;
+
+    unit->status = 1;
+
+    for( i=0; i<_profile->entriesCount; ++i ) {
+
+        ProfileEntry * entry = &_profile->entries[i];
+
+        if ( entry->unit != _unit || entry->cycles == 0 ) {
+            continue;
+        }
+
+        if ( unit->module ) {
+            strcpy( stack, _stack );
+        } else {
+            snprintf( stack, MAX_TEMPORARY_STORAGE, "%s;line %d", _stack, entry->line );
+        }
+
+        fprintf( _file, "%s %.0f\n", stack, entry->cycles * _scale );
+
+        if ( entry->calleeUnit >= 0 ) {
+            ProfileUnit * callee = &_profile->units[entry->calleeUnit];
+            double scale = _scale * entry->cycles / callee->callWeight;
+            if ( strlen( stack ) + strlen( callee->name ) + 2 >= MAX_TEMPORARY_STORAGE ) {
+                continue;
+            }
+            strcat( stack, ";" );
+            strcat( stack, callee->name );
+            if ( callee->status == 1 || _depth >= PROFILE_MAX_DEPTH ) {
+                fprintf( _file, "%s %.0f\n", stack, callee->inclusive * scale );
+            } else {
+                profile_folded( _profile, _file, entry->calleeUnit, stack, scale, _depth + 1 );
+            }
+        }
+
+    }
+
+    unit->status = 2;
+
+}
+
+typedef struct _ProfileLine {
+
+    int line;
+    double inclusive;
+
+} ProfileLine;
+
+// Most expensive lines first, then by line number.
+static int profile_line_compare( const void * _first, const void * _second ) {
+
+    ProfileLine * first = (ProfileLine *) _first;
+    ProfileLine * second = (ProfileLine *) _second;
+
+    if ( first->inclusive != second->inclusive ) {
+        return ( first->inclusive < second->inclusive ) ? 1 : -1;
+    }
+    return first->line - second->line;
+
+}
+
+static void profile_output_name( Environment * _environment, char * _fileName, char * _extension ) {
+
+    strcpy( _fileName, _environment->profileFileName );
+    char * p = strrchr( _fileName, '.' );
+    if ( p && !strchr( p, '/' ) && !strchr( p, '\\' ) ) {
+        *p = 0;
+    }
+    strcat( _fileName, _extension );
+
+}
+
+/**
+ * @brief Produce the hot-spot report of a profiling run
+ * 
+ * This function joins the profiled listing produced by the emulator (if 
+ * `-P` and `-q` have been given) with the markers left by the compiler 
+ * into the assembly, and it writes two files next to the profile:
+ * 
+ *  - `<profile>.hotspots`, a text report with cycles spent for each 
+ *    PROCEDURE, each BASIC line and each runtime module (exclusive and
+ *    inclusive of the called modules and procedures);
+ *  - `<profile>.folded`, the same information as collapsed stacks
+ *    (`procedure;line;module cycles`), ready for flamegraph tools.
+ * 
+ * @param _environment Current calling environment
+ */
+void profile_report( Environment * _environment ) {
+
+    Profile profile;
+    char fileName[MAX_TEMPORARY_STORAGE];
+    int i, j;
+
+    if ( ! _environment->profileFileName || ! _environment->profileCycles ) {
+        return;
+    }
+
+    FILE * fileAsm = fopen( _environment->asmFileName, "rt" );
+    if ( ! fileAsm ) {
+        return;
+    }
+
+    FILE * fileProfile = fopen( _environment->profileFileName, "rt" );
+    if ( ! fileProfile ) {
+        fclose( fileAsm );
+        printf("The profiling report cannot be produced (missing %s).\n\n", _environment->profileFileName );
+        return;
+    }
+
+    memset( &profile, 0, sizeof( Profile ) );
+
+    profile_load_assembly( &profile, fileAsm );
+    profile_load_cycles( &profile, fileProfile );
+
+    fclose( fileAsm );
+    fclose( fileProfile );
+
+    profile_resolve_calls( &profile );
+
+    double total = 0;
+    double * lineExclusive = malloc( ( profile.maxLine + 1 ) * sizeof( double ) );
+    double * lineInclusive = malloc( ( profile.maxLine + 1 ) * sizeof( double ) );
+    int * lineUnit = malloc( ( profile.maxLine + 1 ) * sizeof( int ) );
+    memset( lineExclusive, 0, ( profile.maxLine + 1 ) * sizeof( double ) );
+    memset( lineInclusive, 0, ( profile.maxLine + 1 ) * sizeof( double ) );
+    for( i=0; i<=profile.maxLine; ++i ) {
+        lineUnit[i] = -1;
+    }
+
+    for( i=0; i<profile.entriesCount; ++i ) {
+        ProfileEntry * entry = &profile.entries[i];
+        profile.units[entry->unit].exclusive += entry->cycles;
+        total += entry->cycles;
+        if ( ! profile.units[entry->unit].module ) {
+            lineExclusive[entry->line] += entry->cycles;
+            if ( lineUnit[entry->line] < 0 || entry->cycles ) {
+                lineUnit[entry->line] = entry->unit;
+            }
+        }
+    }
+
+    for( i=0; i<profile.unitsCount; ++i ) {
+        profile_inclusive( &profile, i );
+    }
+
+    for( i=0; i<profile.entriesCount; ++i ) {
+        ProfileEntry * entry = &profile.entries[i];
+        if ( ! profile.units[entry->unit].module ) {
+            lineInclusive[entry->line] += profile_share( &profile, entry );
+        }
+    }
+
+    // Collapsed stacks, starting from units that nobody calls (the main
+    // program, interrupt handlers and so on).
+    profile_output_name( _environment, fileName, ".folded" );
+    FILE * fileFolded = fopen( fileName, "wt" );
+    if ( fileFolded ) {
+        for( i=0; i<profile.unitsCount; ++i ) {
+            if ( profile.units[i].callWeight == 0 && profile.units[i].exclusive + profile.units[i].inclusive > 0 ) {
+                profile_folded( &profile, fileFolded, i, profile.units[i].name, 1.0, 0 );
+            }
+        }
+        fclose( fileFolded );
+    }
+
+    for( i=0; i<=profile.maxLine; ++i ) {
+        lineInclusive[i] += lineExclusive[i];
+    }
+
+    // Text report
+    profile_output_name( _environment, fileName, ".hotspots" );
+    FILE * fileReport = fopen( fileName, "wt" );
+    if ( fileReport ) {
+
+        if ( total == 0 ) {
+            total = 1;
+        }
+
+        fprintf( fileReport, "PROFILE OF %s (%d cycles)\n\n", _environment->sourceFileName, _environment->profileCycles );
+
+        fprintf( fileReport, "%-24s %12s %12s %7s\n", "PROCEDURE", "EXCLUSIVE", "INCLUSIVE", "%" );
+        for( i=0; i<profile.unitsCount; ++i ) {
+            ProfileUnit * unit = &profile.units[i];
+            if ( ! unit->module ) {
+                fprintf( fileReport, "%-24s %12.0f %12.0f %6.2f%%\n", unit->name, unit->exclusive, unit->inclusive, 100.0 * unit->inclusive / total );
+            }
+        }
+
+        fprintf( fileReport, "\n%-24s %12s %12s %7s\n", "MODULE", "EXCLUSIVE", "INCLUSIVE", "%" );
+        for( i=0; i<profile.unitsCount; ++i ) {
+            ProfileUnit * unit = &profile.units[i];
+            if ( unit->module && unit->exclusive ) {
+                fprintf( fileReport, "%-24s %12.0f %12.0f %6.2f%%\n", unit->name, unit->exclusive, unit->inclusive, 100.0 * unit->exclusive / total );
+            }
+        }
+
+        // BASIC lines, from the most expensive one.
+        fprintf( fileReport, "\n%-8s %-24s %12s %12s %7s\n", "LINE", "PROCEDURE", "EXCLUSIVE", "INCLUSIVE", "%" );
+        ProfileLine * lines = malloc( ( profile.maxLine + 1 ) * sizeof( ProfileLine ) );
+        int linesCount = 0;
+        for( j=0; j<=profile.maxLine; ++j ) {
+            if ( lineInclusive[j] > 0 ) {
+                lines[linesCount].line = j;
+                lines[linesCount].inclusive = lineInclusive[j];
+                ++linesCount;
+            }
+        }
+        qsort( lines, linesCount, sizeof( ProfileLine ), profile_line_compare );
+        for( j=0; j<linesCount; ++j ) {
+            int best = lines[j].line;
+            fprintf( fileReport, "%-8d %-24s %12.0f %12.0f %6.2f%%\n", best, 
+                lineUnit[best] >= 0 ? profile.units[lineUnit[best]].name : PROFILE_MAIN,
+                lineExclusive[best], lineInclusive[best], 100.0 * lineInclusive[best] / total );
+        }
+        free( lines );
+
+        fclose( fileReport );
+
+    }
+
+    for( i=0; i<profile.entriesCount; ++i ) {
+        free( profile.entries[i].code );
+        free( profile.entries[i].label );
+        free( profile.entries[i].callee );
+    }
+    for( i=0; i<profile.unitsCount; ++i ) {
+        free( profile.units[i].name );
+    }
+    free( profile.entries );
+    free( profile.units );
+    free( lineExclusive );
+    free( lineInclusive );
+    free( lineUnit );
+
+}
@@ -0,0 +1,466 @@
+/*****************************************************************************
+ * ugBASIC - an isomorphic BASIC language compiler for retrocomputers        *
+ *****************************************************************************
+ * Copyright 2021-2024 Marco Spedaletti (asimov@mclink.it)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *----------------------------------------------------------------------------
+ * Concesso in licenza secondo i termini della Licenza Apache, versione 2.0
+ * (la "Licenza"); è proibito usare questo file se non in conformità alla
+ * Licenza. Una copia della Licenza è disponibile all'indirizzo:
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Se non richiesto dalla legislazione vigente o concordato per iscritto,
+ * il software distribuito nei termini della Licenza è distribuito
+ * "COSÌ COM'È", SENZA GARANZIE O CONDIZIONI DI ALCUN TIPO, esplicite o
+ * implicite. Consultare la Licenza per il testo specifico che regola le
+ * autorizzazioni e le limitazioni previste dalla medesima.
+ ****************************************************************************/
+
+/****************************************************************************
+ * INCLUDE SECTION 
+ ****************************************************************************/
+
+#include "../../ugbc.h"
+#include <ctype.h>
+
+/****************************************************************************
+ * CODE SECTION 
+ ****************************************************************************/
+
+/*
+ * Constant propagation of variables assigned once. Many programs assign
+ * a configuration value once (SPEED = 3) and never change it: those
+ * variables would waste memory, and every read would be a load from memory
+ * (so the "*_const" paths of code generation could not be used).
+ *
+ * The main source is scanned before the parsing, looking for variables 
+ * that:
+ *  - are assigned once, with a statement like "name = expression";
+ *  - are assigned before any control flow statement (IF, FOR, GOTO, 
+ *    PROCEDURE, ...) and before any other use, so that the assignment 
+ *    is the only reaching definition of every following use;
+ *  - are only read after the assignment (every statement that could write 
+ *    them, like INPUT, READ, SWAP, INC, DIM or VARPTR, excludes them);
+ *  - are never used inside a procedure (so SHARED and GLOBAL variables,
+ *    or local variables with the same name, are excluded);
+ *  - are never named inside an ASM line or block.
+ * 
+ * The scan is lexical, and conservative: anything it does not understand
+ * excludes the variable. If the main source includes other files, the
+ * scan is not done at all. When the parser meets the assignment of a 
+ * candidate, and the expression is a constant, the variable is defined 
+ * as a numeric constant instead (see constant_propagation_applies()).
+ */
+
+typedef struct _PropagationEntry {
+
+    char * name;
+
+    /** Number of assignments (at the beginning of a statement) */
+    int assignments;
+
+    /** Number of reads */
+    int reads;
+
+    /** The first assignment is the only reaching definition */
+    int eligible;
+
+    /** The variable cannot be promoted */
+    int excluded;
+
+} PropagationEntry;
+
+typedef struct _PropagationScan {
+
+    PropagationEntry * entries;
+    int count;
+    int capacity;
+
+    /** Reads of the current statement (index of the entries) */
+    int * pending;
+    int pendingCount;
+    int pendingCapacity;
+
+    /** Text of all the ASM lines and blocks */
+    char * asmText;
+    int asmSize;
+
+} PropagationScan;
+
+/* Statements that could write any variable they name. */
+static char * propagationWriters[] = {
+    "ADD", "ARRAY", "AS", "CONST", "DEC", "DECLARE", "DIM", "FIELD", "GET", 
+    "GLOBAL", "INC", "INPUT", "INTO", "LOCAL", "PARAM", "PROCEDURE", "READ", 
+    "SHARED", "SWAP", "TYPE", "VAR", "VARPTR", 
+    NULL
+};
+
+/* Statements that start (or break) the control flow. */
+static char * propagationControls[] = {
+    "BEGIN", "CALL", "CASE", "DO", "ELSE", "ELSEIF", "END", "ENDIF", "ENDSELECT",
+    "EVERY", "EXEC", "EXIT", "FOR", "GOSUB", "GOTO", "HALT", "IF", "LOOP", "NEXT", 
+    "ON", "PARALLEL", "POP", "PROC", "PROCEDURE", "REPEAT", "RESUME", "RETURN", 
+    "RUN", "SELECT", "SPAWN", "STOP", "UNTIL", "WEND", "WHILE", "YIELD",
+    NULL
+};
+
+static int propagation_keyword_in( char * _word, char ** _list ) {
+
+    for( ; *_list; ++_list ) {
+        if ( strcmp( _word, *_list ) == 0 ) {
+            return 1;
+        }
+    }
+    return 0;
+
+}
+
+static int propagation_entry( PropagationScan * _scan, char * _name, int _length ) {
+
+    int i;
+
+    for( i=0; i<_scan->count; ++i ) {
+        if ( strncmp( _scan->entries[i].name, _name, _length ) == 0 && _scan->entries[i].name[_length] == 0 ) {
+            return i;
+        }
+    }
+
+    if ( _scan->count == _scan->capacity ) {
+        _scan->capacity = _scan->capacity ? _scan->capacity * 2 : 64;
+        _scan->entries = realloc( _scan->entries, _scan->capacity * sizeof( PropagationEntry ) );
+    }
+
+    PropagationEntry * entry = &_scan->entries[_scan->count];
+    memset( entry, 0, sizeof( PropagationEntry ) );
+    entry->name = malloc( _length + 1 );
+    memcpy( entry->name, _name, _length );
+    entry->name[_length] = 0;
+
+    return _scan->count++;
+
+}
+
+static void propagation_asm( PropagationScan * _scan, char * _text, int _length ) {
+
+    _scan->asmText = realloc( _scan->asmText, _scan->asmSize + _length + 2 );
+    memcpy( _scan->asmText + _scan->asmSize, _text, _length );
+    _scan->asmSize += _length;
+    _scan->asmText[_scan->asmSize++] = '\n';
+    _scan->asmText[_scan->asmSize] = 0;
+
+}
+
+static int propagation_asm_names( PropagationScan * _scan, char * _name ) {
+
+    int length = strlen( _name );
+    char * p = _scan->asmText;
+
+    if ( !p ) {
+        return 0;
+    }
+
+    for( ; *p; ++p ) {
+        if ( strncasecmp( p, _name, length ) == 0 ) {
+            return 1;
+        }
+    }
+
+    return 0;
+
+}
+
+/* end of a statement: reads are confirmed, unless the statement could write */
+static void propagation_statement_end( PropagationScan * _scan, int * _writer ) {
+
+    int i;
+
+    for( i=0; i<_scan->pendingCount; ++i ) {
+        if ( *_writer ) {
+            _scan->entries[_scan->pending[i]].excluded = 1;
+        } else {
+            ++_scan->entries[_scan->pending[i]].reads;
+        }
+    }
+
+    _scan->pendingCount = 0;
+    *_writer = 0;
+
+}
+
+/**
+ * @brief Find the variables that can be promoted to constants
+ * 
+ * This function scans the main source, and it fills the list of 
+ * variables that are assigned once and then only read (see the
+ * comment at the beginning of this file).
+ * 
+ * @param _environment Current calling environment
+ * @param _source_filename Filename of the source
+ */
+void constant_propagation_scan( Environment * _environment, char * _source_filename ) {
+
+    if ( _environment->constantPropagationDisabled ) {
+        return;
+    }
+
+    FILE * fh = fopen( _source_filename, "rb" );
+    if ( !fh ) {
+        return;
+    }
+    fseek( fh, 0, SEEK_END );
+    int size = ftell( fh );
+    fseek( fh, 0, SEEK_SET );
+    char * source = malloc( size + 1 );
+    (void)!fread( source, 1, size, fh );
+    source[size] = 0;
+    fclose( fh );
+
+    PropagationScan scan;
+    memset( &scan, 0, sizeof( PropagationScan ) );
+
+    char previous[MAX_TEMPORARY_STORAGE];
+    int lineStart = 1, statementStart = 1, writer = 0, prologue = 1, procedure = 0, included = 0;
+    int i;
+    char * p = source;
+
+    if ( (unsigned char)p[0] == 0xef && (unsigned char)p[1] == 0xbb && (unsigned char)p[2] == 0xbf ) {
+        p += 3;
+    }
+
+    previous[0] = 0;
+
+    while( *p && !included ) {
+
+        if ( *p == '\r' || *p == ' ' || *p == '\t' ) {
+            ++p;
+        } else if ( (unsigned char)*p >= 0x80 ) {
+            ++p;
+            statementStart = lineStart = 0;
+            previous[0] = 0;
+        } else if ( *p == '_' && ( p[1] == '\n' || ( p[1] == '\r' && p[2] == '\n' ) ) ) {
+            // line continuation: it does not end the statement
+            p += ( p[1] == '\n' ) ? 2 : 3;
+        } else if ( *p == '\n' || *p == ':' ) {
+            propagation_statement_end( &scan, &writer );
+            lineStart = ( *p == '\n' );
+            statementStart = 1;
+            previous[0] = 0;
+            ++p;
+        } else if ( *p == '\'' ) {
+            while( *p && *p != '\n' ) {
+                ++p;
+            }
+        } else if ( *p == '"' || ( *p == '#' && p[1] == '"' ) ) {
+            p += ( *p == '#' ) ? 2 : 1;
+            while( *p && *p != '"' ) {
+                if ( *p == '\\' && p[1] ) {
+                    ++p;
+                }
+                ++p;
+            }
+            if ( *p ) {
+                ++p;
+            }
+            statementStart = lineStart = 0;
+            previous[0] = 0;
+        } else if ( isdigit( *p ) || *p == '$' || *p == '%' || ( *p == '&' && ( p[1] == 'H' || p[1] == 'h' ) ) || ( *p == '#' && p[1] == '[' ) ) {
+            // numbers (line numbers do not change the beginning of a statement)
+            int number = isdigit( *p );
+            p += ( *p == '&' || *p == '#' ) ? 2 : 1;
+            while( isalnum( *p ) || *p == '.' || *p == '_' ) {
+                ++p;
+            }
+            if ( *p == ']' ) {
+                ++p;
+            }
+            statementStart = statementStart && lineStart && number;
+            lineStart = 0;
+            previous[0] = 0;
+        } else if ( isupper( *p ) ) {
+            char * q = p;
+            while( isupper( *q ) || isdigit( *q ) ) {
+                ++q;
+            }
+            int length = q - p;
+            if ( length >= MAX_TEMPORARY_STORAGE ) {
+                length = MAX_TEMPORARY_STORAGE - 1;
+            }
+            char word[MAX_TEMPORARY_STORAGE];
+            memcpy( word, p, length );
+            word[length] = 0;
+            p = q;
+            while( *q == ' ' || *q == '\t' ) {
+                ++q;
+            }
+            if ( strncmp( word, "REM", 3 ) == 0 ) {
+                while( *p && *p != '\n' ) {
+                    ++p;
+                }
+                continue;
+            } else if ( strcmp( word, "ASM" ) == 0 ) {
+                char * end = strchr( p, '\n' );
+                if ( !end ) {
+                    end = p + strlen( p );
+                }
+                propagation_asm( &scan, p, end - p );
+                p = end;
+                continue;
+            } else if ( strcmp( word, "BEGIN" ) == 0 && strncmp( q, "ASM", 3 ) == 0 ) {
+                char * end = strstr( q, "END ASM" );
+                if ( !end ) {
+                    end = q + strlen( q );
+                }
+                propagation_asm( &scan, q + 3, end - q - 3 );
+                p = *end ? end + 7 : end;
+                continue;
+            } else if ( strcmp( word, "INCLUDE" ) == 0 || strcmp( word, "IMPORT" ) == 0 ) {
+                included = 1;
+                continue;
+            } else if ( strcmp( word, "END" ) == 0 && strncmp( q, "PROC", 4 ) == 0 ) {
+                procedure = 0;
+            } else if ( strcmp( word, "PROCEDURE" ) == 0 ) {
+                procedure = 1;
+            }
+            if ( propagation_keyword_in( word, propagationControls ) ) {
+                prologue = 0;
+            }
+            if ( propagation_keyword_in( word, propagationWriters ) ) {
+                writer = 1;
+            }
+            if ( strcmp( word, "THEN" ) == 0 || strcmp( word, "ELSE" ) == 0 ) {
+                statementStart = 1;
+            } else if ( strcmp( word, "LET" ) != 0 ) {
+                statementStart = 0;
+            }
+            lineStart = 0;
+            strcpy( previous, word );
+        } else if ( islower( *p ) || *p == '_' ) {
+            char * q = p;
+            while( isalnum( *q ) || *q == '_' ) {
+                ++q;
+            }
+            int index = propagation_entry( &scan, p, q - p );
+            PropagationEntry * entry = &scan.entries[index];
+            char * r = q;
+            while( *r == ' ' || *r == '\t' ) {
+                ++r;
+            }
+            if ( procedure || strchr( "$@%&!", *q ) || *r == '(' || *r == '[' ) {
+                // used in a procedure, with a type suffix or as an array
+                entry->excluded = 1;
+            } else if ( statementStart && *r == '=' && r[1] != '=' ) {
+                if ( !entry->assignments && !entry->reads && prologue ) {
+                    entry->eligible = 1;
+                }
+                ++entry->assignments;
+            } else if ( statementStart && *r == ':' ) {
+                // label or direct assignment
+                entry->excluded = 1;
+            } else if ( strcmp( previous, "FOR" ) == 0 || strcmp( previous, "NEXT" ) == 0 ) {
+                entry->excluded = 1;
+            } else {
+                if ( scan.pendingCount == scan.pendingCapacity ) {
+                    scan.pendingCapacity = scan.pendingCapacity ? scan.pendingCapacity * 2 : 16;
+                    scan.pending = realloc( scan.pending, scan.pendingCapacity * sizeof( int ) );
+                }
+                scan.pending[scan.pendingCount++] = index;
+            }
+            p = q;
+            statementStart = lineStart = 0;
+            previous[0] = 0;
+        } else if ( ( *p == '+' && p[1] == '+' ) || ( *p == '-' && p[1] == '-' ) ) {
+            // "++x" and "--x" increment / decrement like INC and DEC
+            char * q = p + 2;
+            while( *q == ' ' || *q == '\t' ) {
+                ++q;
+            }
+            if ( islower( *q ) || *q == '_' ) {
+                writer = 1;
+            }
+            p += 2;
+            statementStart = lineStart = 0;
+            previous[0] = 0;
+        } else {
+            ++p;
+            statementStart = lineStart = 0;
+            previous[0] = 0;
+        }
+
+    }
+
+    propagation_statement_end( &scan, &writer );
+
+    for( i=0; i<scan.count; ++i ) {
+        PropagationEntry * entry = &scan.entries[i];
+        if ( !included && entry->eligible && entry->assignments == 1 && !entry->excluded && !propagation_asm_names( &scan, entry->name ) ) {
+            ConstantCandidate * candidate = malloc( sizeof( ConstantCandidate ) );
+            memset( candidate, 0, sizeof( ConstantCandidate ) );
+            candidate->name = strdup( entry->name );
+            candidate->next = _environment->constantCandidates;
+            _environment->constantCandidates = candidate;
+        }
+        free( entry->name );
+    }
+
+    free( scan.entries );
+    free( scan.pending );
+    free( scan.asmText );
+    free( source );
+
+}
+
+/**
+ * @brief Check if an assignment defines a constant, instead of a variable
+ * 
+ * The assignment defines a constant if the variable has been found by
+ * constant_propagation_scan(), the variable has not been defined yet,
+ * and the expression is an integer constant. The type of the expression
+ * must be the one that the constant will have when read, so that every
+ * use of the constant will behave as the use of the variable.
+ * 
+ * @param _environment Current calling environment
+ * @param _name Name of the variable assigned
+ * @param _expr Expression assigned
+ * @return 1 if the variable must be defined as a constant, 0 otherwise
+ */
+int constant_propagation_applies( Environment * _environment, char * _name, Variable * _expr ) {
+
+    if ( _environment->constantPropagationDisabled || _environment->optionExplicit || _environment->procedureName || _environment->emptyProcedure ) {
+        return 0;
+    }
+
+    if ( _environment->conditionals || _environment->loops ) {
+        return 0;
+    }
+
+    if ( !_expr->initializedByConstant || _expr->type != variable_type_from_numeric_value( _environment, _expr->value ) ) {
+        return 0;
+    }
+
+    if ( variable_exists( _environment, _name ) || constant_find( _environment->constants, _name ) ) {
+        return 0;
+    }
+
+    ConstantCandidate * candidate = _environment->constantCandidates;
+    while( candidate ) {
+        if ( strcmp( candidate->name, _name ) == 0 ) {
+            return 1;
+        }
+        candidate = candidate->next;
+    }
+
+    return 0;
+
+}
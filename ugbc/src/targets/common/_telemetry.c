@@ -0,0 +1,456 @@
+/*****************************************************************************
+ * ugBASIC - an isomorphic BASIC language compiler for retrocomputers        *
+ *****************************************************************************
+ * Copyright 2021-2024 Marco Spedaletti (asimov@mclink.it)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *----------------------------------------------------------------------------
+ * Concesso in licenza secondo i termini della Licenza Apache, versione 2.0
+ * (la "Licenza"); è proibito usare questo file se non in conformità alla
+ * Licenza. Una copia della Licenza è disponibile all'indirizzo:
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Se non richiesto dalla legislazione vigente o concordato per iscritto,
+ * il software distribuito nei termini della Licenza è distribuito
+ * "COSÌ COM'È", SENZA GARANZIE O CONDIZIONI DI ALCUN TIPO, esplicite o
+ * implicite. Consultare la Licenza per il testo specifico che regola le
+ * autorizzazioni e le limitazioni previste dalla medesima.
+ ****************************************************************************/
+/****************************************************************************
+ * INCLUDE SECTION 
+ ****************************************************************************/
+
+#include "../../ugbc.h"
+
+#include <time.h>
+#include <sys/time.h>
+#ifndef _WIN32
+    #include <sys/resource.h>
+#endif
+
+/****************************************************************************
+ * CODE SECTION 
+ ****************************************************************************/
+
+/*
+ * The compile time report (--time-report) measures where the compiler
+ * spends its own time: each phase is surrounded by a telemetry_begin() /
+ * telemetry_end() pair, and phases started while another one is running
+ * become its children. For each phase the report gives the wall clock
+ * time, the CPU time of the compiler (including the workers that decode
+ * images in background), and the CPU time of the external commands 
+ * (assembler, linker, ...) that ended during the phase. Peephole passes 
+ * also give the number of lines emitted and removed.
+ *
+ * When the report is not requested, every function returns immediately.
+ */
+
+static double telemetry_wall( ) {
+
+    struct timeval tv;
+    gettimeofday( &tv, NULL );
+    return (double) tv.tv_sec + (double) tv.tv_usec / 1000000.0;
+
+}
+
+static double telemetry_cpu( ) {
+
+    return (double) clock( ) / CLOCKS_PER_SEC;
+
+}
+
+static double telemetry_children_cpu( ) {
+
+#ifdef _WIN32
+    return 0;
+#else
+    struct rusage usage;
+    getrusage( RUSAGE_CHILDREN, &usage );
+    return (double) usage.ru_utime.tv_sec + (double) usage.ru_utime.tv_usec / 1000000.0 +
+           (double) usage.ru_stime.tv_sec + (double) usage.ru_stime.tv_usec / 1000000.0;
+#endif
+
+}
+
+// Peak resident set size (in KB), or -1 if not available.
+static long telemetry_peak_rss( ) {
+
+#ifdef _WIN32
+    return -1;
+#else
+    struct rusage usage;
+    getrusage( RUSAGE_SELF, &usage );
+    #ifdef __APPLE__
+        return usage.ru_maxrss / 1024;
+    #else
+        return usage.ru_maxrss;
+    #endif
+#endif
+
+}
+
+static int telemetry_count_lines( char * _fileName ) {
+
+    FILE * handle = fopen( _fileName, "rt" );
+    if ( ! handle ) {
+        return 0;
+    }
+
+    int lines = 0;
+    int c;
+    while( ( c = fgetc( handle ) ) != EOF ) {
+        if ( c == '\n' ) {
+            ++lines;
+        }
+    }
+
+    fclose( handle );
+
+    return lines;
+
+}
+
+static TelemetryPhase * telemetry_phase_new( char * _name, TelemetryPhase * _parent ) {
+
+    TelemetryPhase * phase = malloc( sizeof( TelemetryPhase ) );
+    memset( phase, 0, sizeof( TelemetryPhase ) );
+    phase->name = strdup( _name );
+    phase->linesEmitted = -1;
+    phase->linesRemoved = -1;
+    phase->parent = _parent;
+
+    if ( _parent ) {
+        if ( _parent->lastChild ) {
+            _parent->lastChild->next = phase;
+        } else {
+            _parent->firstChild = phase;
+        }
+        _parent->lastChild = phase;
+    }
+
+    return phase;
+
+}
+
+static void telemetry_phase_start( TelemetryPhase * _phase ) {
+
+    ++_phase->count;
+    _phase->wallStart = telemetry_wall( );
+    _phase->cpuStart = telemetry_cpu( );
+    _phase->childrenCpuStart = telemetry_children_cpu( );
+
+}
+
+static void telemetry_phase_stop( TelemetryPhase * _phase ) {
+
+    _phase->wall += telemetry_wall( ) - _phase->wallStart;
+    _phase->cpu += telemetry_cpu( ) - _phase->cpuStart;
+    _phase->childrenCpu += telemetry_children_cpu( ) - _phase->childrenCpuStart;
+
+}
+
+/**
+ * @brief Enable the compile time report
+ * 
+ * @param _environment Current calling environment
+ * @param _fileName Filename of the JSON report (NULL for standard error)
+ */
+void telemetry_create( Environment * _environment, char * _fileName ) {
+
+    _environment->telemetry = malloc( sizeof( Telemetry ) );
+    memset( _environment->telemetry, 0, sizeof( Telemetry ) );
+
+    _environment->telemetry->fileName = _fileName ? strdup( _fileName ) : NULL;
+    _environment->telemetry->root = telemetry_phase_new( "ugbc", NULL );
+    _environment->telemetry->current = _environment->telemetry->root;
+
+    telemetry_phase_start( _environment->telemetry->root );
+
+}
+
+/**
+ * @brief Start measuring a phase
+ * 
+ * The phase becomes a child of the one currently running. If that phase
+ * already has a child with the same name, the time is accumulated on it.
+ * 
+ * @param _environment Current calling environment
+ * @param _name Name of the phase
+ */
+void telemetry_begin( Environment * _environment, char * _name ) {
+
+    Telemetry * telemetry = _environment->telemetry;
+
+    if ( ! telemetry ) {
+        return;
+    }
+
+    TelemetryPhase * phase = telemetry->current->firstChild;
+    while( phase ) {
+        if ( strcmp( phase->name, _name ) == 0 ) {
+            break;
+        }
+        phase = phase->next;
+    }
+
+    if ( ! phase ) {
+        phase = telemetry_phase_new( _name, telemetry->current );
+    }
+
+    telemetry_phase_start( phase );
+
+    telemetry->current = phase;
+
+}
+
+/**
+ * @brief Start measuring an external command
+ * 
+ * The phase is named after the executable (without path), so that 
+ * every call to the same tool is accumulated on the same node.
+ * 
+ * @param _environment Current calling environment
+ * @param _commandline Command line that is going to be executed
+ */
+void telemetry_begin_command( Environment * _environment, char * _commandline ) {
+
+    if ( ! _environment->telemetry ) {
+        return;
+    }
+
+    char name[MAX_TEMPORARY_STORAGE];
+    char * p = _commandline;
+    char * q = name;
+    char terminator = ' ';
+
+    while( *p == ' ' ) {
+        ++p;
+    }
+    if ( *p == '"' ) {
+        terminator = '"';
+        ++p;
+    }
+    strcpy( q, "exec " );
+    q += strlen( q );
+    while( *p && *p != terminator && ( q - name ) < ( MAX_TEMPORARY_STORAGE - 1 ) ) {
+        if ( *p == '/' || *p == '\\' ) {
+            q = name + strlen( "exec " );
+        } else {
+            *q++ = *p;
+        }
+        ++p;
+    }
+    *q = 0;
+
+    telemetry_begin( _environment, name );
+
+}
+
+/**
+ * @brief Start measuring the load of a resource
+ * 
+ * The phase is named after the kind of work and the file, so that each
+ * resource has its own node.
+ * 
+ * @param _environment Current calling environment
+ * @param _kind Kind of work (i.e. "image decoding")
+ * @param _filename Filename of the resource
+ */
+void telemetry_begin_resource( Environment * _environment, char * _kind, char * _filename ) {
+
+    if ( ! _environment->telemetry ) {
+        return;
+    }
+
+    char * name = malloc( strlen( _kind ) + strlen( _filename ) + 2 );
+    sprintf( name, "%s %s", _kind, _filename );
+
+    telemetry_begin( _environment, name );
+
+    free( name );
+
+}
+
+/**
+ * @brief Start measuring a peephole optimizer pass
+ * 
+ * @param _environment Current calling environment
+ * @param _pass Number of the pass
+ * @param _kind Kind of the pass
+ */
+void telemetry_begin_pass( Environment * _environment, int _pass, PeepHoleOptimizationKind _kind ) {
+
+    if ( ! _environment->telemetry ) {
+        return;
+    }
+
+    char name[MAX_TEMPORARY_STORAGE];
+    char * kind = "peephole";
+
+    switch( _kind ) {
+        case DEADVARS:
+            kind = "deadvars";
+            break;
+        case RELOCATION1:
+            kind = "relocation1";
+            break;
+        case RELOCATION2:
+            kind = "relocation2";
+            break;
+        default:
+            break;
+    }
+
+    sprintf( name, "pass %d %s", _pass, kind );
+
+    _environment->telemetry->passLinesBefore = telemetry_count_lines( _environment->asmFileName );
+
+    telemetry_begin( _environment, name );
+
+}
+
+/**
+ * @brief Stop measuring the phase currently running
+ * 
+ * @param _environment Current calling environment
+ */
+void telemetry_end( Environment * _environment ) {
+
+    Telemetry * telemetry = _environment->telemetry;
+
+    if ( ! telemetry || telemetry->current == telemetry->root ) {
+        return;
+    }
+
+    telemetry_phase_stop( telemetry->current );
+
+    telemetry->current = telemetry->current->parent;
+
+}
+
+/**
+ * @brief Stop measuring a peephole optimizer pass
+ * 
+ * The lines emitted are the ones of the assembly file written by the 
+ * pass; the lines removed are the difference with the file it read.
+ * 
+ * @param _environment Current calling environment
+ */
+void telemetry_end_pass( Environment * _environment ) {
+
+    Telemetry * telemetry = _environment->telemetry;
+
+    if ( ! telemetry || telemetry->current == telemetry->root ) {
+        return;
+    }
+
+    int linesAfter = telemetry_count_lines( _environment->asmFileName );
+
+    TelemetryPhase * phase = telemetry->current;
+    if ( phase->linesEmitted < 0 ) {
+        phase->linesEmitted = 0;
+        phase->linesRemoved = 0;
+    }
+    phase->linesEmitted += linesAfter;
+    phase->linesRemoved += telemetry->passLinesBefore - linesAfter;
+
+    telemetry_end( _environment );
+
+}
+
+static void telemetry_write_string( FILE * _handle, char * _string ) {
+
+    fputc( '"', _handle );
+    while( *_string ) {
+        if ( *_string == '"' || *_string == '\\' ) {
+            fputc( '\\', _handle );
+            fputc( *_string, _handle );
+        } else if ( (unsigned char) *_string < 32 ) {
+            fprintf( _handle, "\\u%4.4x", (unsigned char) *_string );
+        } else {
+            fputc( *_string, _handle );
+        }
+        ++_string;
+    }
+    fputc( '"', _handle );
+
+}
+
+static void telemetry_write_phase( FILE * _handle, TelemetryPhase * _phase, int _indent ) {
+
+    fprintf( _handle, "%*s{ \"name\": ", _indent, "" );
+    telemetry_write_string( _handle, _phase->name );
+    fprintf( _handle, ", \"count\": %d, \"wall_ms\": %.3f, \"cpu_ms\": %.3f, \"children_cpu_ms\": %.3f",
+        _phase->count, _phase->wall * 1000.0, _phase->cpu * 1000.0, _phase->childrenCpu * 1000.0 );
+    if ( _phase->linesEmitted >= 0 ) {
+        fprintf( _handle, ", \"lines_emitted\": %d, \"lines_removed\": %d", _phase->linesEmitted, _phase->linesRemoved );
+    }
+    if ( _phase->firstChild ) {
+        fprintf( _handle, ",\n%*s  \"phases\": [\n", _indent, "" );
+        TelemetryPhase * child = _phase->firstChild;
+        while( child ) {
+            telemetry_write_phase( _handle, child, _indent + 4 );
+            fprintf( _handle, child->next ? ",\n" : "\n" );
+            child = child->next;
+        }
+        fprintf( _handle, "%*s  ]\n%*s}", _indent, "", _indent, "" );
+    } else {
+        fprintf( _handle, " }" );
+    }
+
+}
+
+/**
+ * @brief Write the compile time report
+ * 
+ * Phases still running (i.e. if the compilation stopped) are closed,
+ * then the whole tree is written as JSON, together with the peak
+ * resident set size of the compiler.
+ * 
+ * @param _environment Current calling environment
+ */
+void telemetry_report( Environment * _environment ) {
+
+    Telemetry * telemetry = _environment->telemetry;
+
+    if ( ! telemetry ) {
+        return;
+    }
+
+    while( telemetry->current != telemetry->root ) {
+        telemetry_end( _environment );
+    }
+
+    telemetry_phase_stop( telemetry->root );
+
+    FILE * handle = stderr;
+    if ( telemetry->fileName ) {
+        handle = fopen( telemetry->fileName, "wt" );
+        if ( ! handle ) {
+            fprintf( stderr, "Unable to write the time report on %s\n", telemetry->fileName );
+            return;
+        }
+    }
+
+    fprintf( handle, "{\n  \"source\": " );
+    telemetry_write_string( handle, _environment->sourceFileName ? _environment->sourceFileName : "" );
+    fprintf( handle, ",\n  \"peak_rss_kb\": %ld,\n  \"phases\": [\n", telemetry_peak_rss( ) );
+    telemetry_write_phase( handle, telemetry->root, 4 );
+    fprintf( handle, "\n  ]\n}\n" );
+
+    if ( telemetry->fileName ) {
+        fclose( handle );
+    }
+
+}
@@ -111,6 +111,10 @@ void begin_for_to_prepare( Environment * _environment ) {
     cpu_jump( _environment, beginForPrepareAfter );
     cpu_label( _environment, beginForPrepare );
 
+    // The prepare subroutine is called at every iteration: nothing computed
+    // before it (the FROM expression) can be reused inside it.
+    expression_reset( _environment );
+
 }
 
 void begin_for_step_prepare( Environment * _environment, char * _from, char * _to, char * _step ) {
@@ -160,6 +164,9 @@ void begin_for_from( Environment * _environment, char * _index, char * _from, ch
     cpu_return( _environment );
     cpu_label( _environment, beginForPrepareAfter );
 
+    // This point is reached by jumping over the prepare subroutine.
+    expression_reset( _environment );
+
     // Retrieve index and extremes. 
     Variable * index = NULL;
     Variable * from = variable_retrieve( _environment, _from );
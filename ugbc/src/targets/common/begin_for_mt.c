@@ -55,6 +55,10 @@ void begin_for_to_prepare_mt( Environment * _environment ) {
     cpu_jump( _environment, beginForPrepareAfter );
     cpu_label( _environment, beginForPrepare );
 
+    // The prepare subroutine is called at every iteration: nothing computed
+    // before it (the FROM expression) can be reused inside it.
+    expression_reset( _environment );
+
 }
 
 void begin_for_step_prepare_mt( Environment * _environment, char * _from, char * _to, char * _step ) {
@@ -104,6 +108,9 @@ void begin_for_from_mt( Environment * _environment, char * _index, char * _from,
     cpu_return( _environment );
     cpu_label( _environment, beginForPrepareAfter );
 
+    // This point is reached by jumping over the prepare subroutine.
+    expression_reset( _environment );
+
     // Retrieve index and extremes. 
     Variable * index = NULL;
     Variable * from = variable_retrieve( _environment, _from );
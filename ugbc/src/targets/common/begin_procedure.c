@@ -149,6 +149,10 @@ void begin_procedure( Environment * _environment, char * _name ) {
 
     cpu_jump( _environment, procedureAfterLabel  );
 
+    if ( _environment->profileFileName ) {
+        outline1("; F:%s", _environment->procedureName );
+    }
+
     cpu_label( _environment, procedureLabel );
 
     if ( procedure->protothread ) {
@@ -109,6 +109,10 @@ void call_procedure( Environment * _environment, char * _name ) {
         return;
     }
 
+    // The procedure can change any variable.
+    expression_flush( _environment );
+    expression_reset( _environment );
+
     Procedure * procedure = _environment->procedures;
 
     while( procedure ) {
@@ -38,6 +38,8 @@
  * CODE SECTION 
  ****************************************************************************/
 
+extern char DATATYPE_AS_STRING[][16];
+
 /**
  * @brief Emit code for <strong>DATA</strong> instruction (numeric values)
  * 
@@ -136,6 +138,10 @@ void data_numeric( Environment * _environment, int _value ) {
         type = variable_type_from_numeric_value( _environment, _value );
     }
 
+    if ( _environment->optionDataType && VT_BITWIDTH( type ) != VT_BITWIDTH( _environment->optionDataType ) ) {
+        CRITICAL_DATA_NOT_HOMOGENEOUS( DATATYPE_AS_STRING[type], DATATYPE_AS_STRING[_environment->optionDataType] );
+    }
+
     int bytes = VT_BITWIDTH( type ) >> 3;
 
     DataSegment * data;
@@ -191,6 +197,10 @@ void data_floating( Environment * _environment, double _value ) {
 
     VariableType type = VT_FLOAT;
 
+    if ( _environment->optionDataType ) {
+        CRITICAL_DATA_NOT_HOMOGENEOUS( DATATYPE_AS_STRING[type], DATATYPE_AS_STRING[_environment->optionDataType] );
+    }
+
     int bytes = VT_FLOAT_BITWIDTH( _environment->floatType.precision ) >> 3;
 
     DataSegment * data;
@@ -245,6 +255,10 @@ void data_string( Environment * _environment, char * _value ) {
 
     VariableType type = VT_STRING;
 
+    if ( _environment->optionDataType ) {
+        CRITICAL_DATA_NOT_HOMOGENEOUS( DATATYPE_AS_STRING[type], DATATYPE_AS_STRING[_environment->optionDataType] );
+    }
+
     int bytes = strlen( _value );
 
     DataSegment * data;
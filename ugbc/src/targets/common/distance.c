@@ -40,6 +40,54 @@
 
 extern char DATATYPE_AS_STRING[][16];
 
+/**
+ * @brief Return the approximated distance between two (screen) positions
+ * 
+ * The distance is approximated as max + 3/8 min of the absolute differences
+ * (the "alpha max plus beta min" method), so only shifts and sums are needed.
+ * The error is between -2.8% (on the diagonals) and +6.8%.
+ * 
+ * @param _environment Current calling environment
+ * @param _x1 Abscissa of the first point
+ * @param _y1 Ordinate of the first point
+ * @param _x1 Abscissa of the second point
+ * @param _y1 Ordinate of the second point
+ * @return Variable* The distance
+ */
+static Variable * distance_approximated( Environment * _environment, Variable * _x1, Variable * _y1, Variable * _x2, Variable * _y2 ) {
+
+    MAKE_LABEL
+
+    char sortedLabel[MAX_TEMPORARY_STORAGE]; sprintf( sortedLabel, "%ssorted", label );
+
+    Variable * dx = absolute( _environment, variable_sub( _environment, _x1->name, _x2->name )->name );
+    Variable * dy = absolute( _environment, variable_sub( _environment, _y1->name, _y2->name )->name );
+
+    Variable * major = variable_temporary( _environment, VT_POSITION, "(major)" );
+    Variable * minor = variable_temporary( _environment, VT_POSITION, "(minor)" );
+    Variable * eighth = variable_temporary( _environment, VT_POSITION, "(minor / 8)" );
+    Variable * greater = variable_temporary( _environment, VT_BYTE, "(check)" );
+
+    cpu_move_16bit( _environment, dx->realName, major->realName );
+    cpu_move_16bit( _environment, dy->realName, minor->realName );
+    cpu_greater_than_16bit( _environment, dy->realName, dx->realName, greater->realName, 0, 0 );
+    cpu_bveq( _environment, greater->realName, sortedLabel );
+    cpu_move_16bit( _environment, dy->realName, major->realName );
+    cpu_move_16bit( _environment, dx->realName, minor->realName );
+    cpu_label( _environment, sortedLabel );
+
+    // major + minor / 4 + minor / 8
+
+    cpu_math_div2_const_16bit( _environment, minor->realName, 2, 0 );
+    cpu_move_16bit( _environment, minor->realName, eighth->realName );
+    cpu_math_div2_const_16bit( _environment, eighth->realName, 1, 0 );
+    cpu_math_add_16bit( _environment, major->realName, minor->realName, major->realName );
+    cpu_math_add_16bit( _environment, major->realName, eighth->realName, major->realName );
+
+    return major;
+
+}
+
 /**
  * @brief Return the distance between two (screen) positions
  *  
@@ -60,6 +108,9 @@ The distance is calculated with the application of the Pythagorean theorem,
 the result of which is however returned with the nnly integer part. If any 
 component is omitted, the last screen position is used, instead.
 
+With ''DEFINE MATH FAST'' the distance is approximated, without any
+multiplication nor square root, with an error between -2.8% and +6.8%.
+
 @italian
 La funzione ''DISTANCE'' calcola la distanza geometrica tra due punti. 
 La distanza viene calcolata con l'applicazione del teorema di Pitagora, il cui 
@@ -67,6 +118,9 @@ risultato viene comunque restituito con la sola parte intera. Se viene omessa
 una qualsiasi delle componenti, viene usata quella corrispondente all'ultima
 position dello schermo.
 
+Con ''DEFINE MATH FAST'' la distanza viene approssimata, senza moltiplicazioni
+né radice quadrata, con un errore tra -2.8% e +6.8%.
+
 @syntax = DISTANCE( [x1], [y1] TO [x2], [y2] )
 
 @example result = DISTANCE( x1, y1 TO x2, y2 )
@@ -82,6 +136,11 @@ Variable * distance( Environment * _environment, char * _x1, char * _y1, char *
     Variable * y1 = variable_retrieve_or_define( _environment, _y1, VT_POSITION, 0 );
     Variable * x2 = variable_retrieve_or_define( _environment, _x2, VT_POSITION, 0 );
     Variable * y2 = variable_retrieve_or_define( _environment, _y2, VT_POSITION, 0 );
+
+    if ( _environment->mathMode == MATH_MODE_FAST ) {
+        return distance_approximated( _environment, x1, y1, x2, y2 );
+    }
+
     Variable * two = variable_resident( _environment, VT_POSITION, "(two)");
     
     variable_store( _environment, two->name, 2 );
@@ -65,6 +65,9 @@ void else_if_then_label( Environment * _environment ) {
     cpu_jump( _environment, endifLabel );
 
     cpu_label( _environment, elseLabel );
+
+    // The ELSE branch is not reached through the THEN branch.
+    expression_reset( _environment );
     
 }
 
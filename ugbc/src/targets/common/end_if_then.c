@@ -65,6 +65,9 @@ void end_if_then( Environment * _environment ) {
     cpu_label( _environment, endifLabel );
     cpu_label( _environment, elseLabel );
 
+    // Join point of all the branches.
+    expression_reset( _environment );
+
     _environment->conditionals->expression->locked = 0;
 
     _environment->conditionals = _environment->conditionals->next;
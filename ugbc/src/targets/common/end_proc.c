@@ -125,6 +125,9 @@ void end_procedure( Environment * _environment, char * _value ) {
 
     }
 
+    if ( _environment->profileFileName ) {
+        outline0("; F:");
+    }
 
     cpu_label( _environment, procedureAfterLabel );
 
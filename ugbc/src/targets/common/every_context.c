@@ -0,0 +1,378 @@
+/*****************************************************************************
+ * ugBASIC - an isomorphic BASIC language compiler for retrocomputers        *
+ *****************************************************************************
+ * Copyright 2021-2024 Marco Spedaletti (asimov@mclink.it)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *----------------------------------------------------------------------------
+ * Concesso in licenza secondo i termini della Licenza Apache, versione 2.0
+ * (la "Licenza"); è proibito usare questo file se non in conformità alla
+ * Licenza. Una copia della Licenza è disponibile all'indirizzo:
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Se non richiesto dalla legislazione vigente o concordato per iscritto,
+ * il software distribuito nei termini della Licenza è distribuito
+ * "COSÌ COM'È", SENZA GARANZIE O CONDIZIONI DI ALCUN TIPO, esplicite o
+ * implicite. Consultare la Licenza per il testo specifico che regola le
+ * autorizzazioni e le limitazioni previste dalla medesima.
+ ****************************************************************************/
+
+/****************************************************************************
+ * INCLUDE SECTION 
+ ****************************************************************************/
+
+#include "../../ugbc.h"
+
+#include <ctype.h>
+#include <stdlib.h>
+
+/****************************************************************************
+ * CODE SECTION 
+ ****************************************************************************/
+
+/* A line of the generated code, split into its parts. */
+typedef struct _EveryContextLine {
+
+    char * label;
+    char * mnemonic;
+    char * operand;
+
+} EveryContextLine;
+
+typedef struct _EveryContextLabel {
+
+    char * name;
+    int line;
+
+} EveryContextLabel;
+
+static int every_context_is_identifier( char _c ) {
+    return isalnum( _c ) || _c == '_' || _c == '.' || _c == '@';
+}
+
+static int every_context_label_compare( const void * _first, const void * _second ) {
+    return strcmp( ((EveryContextLabel *)_first)->name, ((EveryContextLabel *)_second)->name );
+}
+
+static int every_context_find( EveryContextLabel * _labels, int _count, char * _name ) {
+
+    EveryContextLabel key;
+    EveryContextLabel * found;
+
+    key.name = _name;
+    found = bsearch( &key, _labels, _count, sizeof( EveryContextLabel ), every_context_label_compare );
+
+    return found ? found->line : -1;
+
+}
+
+/*
+ * Split a line in label (at first column, with or without colon), mnemonic
+ * and operand, dropping comments. Constants (NAME = value, NAME EQU value)
+ * are not labels.
+ */
+static void every_context_decode( EveryContextLine * _line, char * _raw ) {
+
+    char * p = _raw;
+    char * comment;
+    int quoted = 0;
+
+    for( comment = _raw; *comment; ++comment ) {
+        if ( *comment == '"' ) {
+            quoted = !quoted;
+        } else if ( *comment == ';' && !quoted ) {
+            *comment = 0;
+            break;
+        }
+    }
+
+    if ( *p == '*' ) {
+        return;
+    }
+
+    if ( isalpha( *p ) || *p == '_' || *p == '@' ) {
+        char * label = p;
+        while( every_context_is_identifier( *p ) ) {
+            ++p;
+        }
+        if ( *p == '=' ) {
+            return;
+        }
+        if ( *p ) {
+            *p++ = 0;
+        }
+        _line->label = label;
+    }
+
+    while( *p == ' ' || *p == '\t' ) {
+        ++p;
+    }
+
+    if ( *p ) {
+        _line->mnemonic = p;
+        while( *p && *p != ' ' && *p != '\t' ) {
+            ++p;
+        }
+        if ( *p ) {
+            *p++ = 0;
+        }
+        while( *p == ' ' || *p == '\t' ) {
+            ++p;
+        }
+        _line->operand = p;
+        p += strlen( p );
+        while( p > _line->operand && ( p[-1] == ' ' || p[-1] == '\t' ) ) {
+            *--p = 0;
+        }
+        if ( strcmp( _line->mnemonic, "=" ) == 0 || strcasecmp( _line->mnemonic, "EQU" ) == 0 || 
+                strcasecmp( _line->mnemonic, ".SET" ) == 0 ) {
+            _line->label = NULL;
+            _line->mnemonic = NULL;
+        }
+    } else {
+        _line->operand = p;
+    }
+
+}
+
+/*
+ * Replace the code between the line with the label _begin and the line with
+ * the label _end. Returns 0 if the two labels are not found.
+ */
+static int every_context_splice( char * _begin, char * _end, char * _text, int _size ) {
+
+    int size;
+    char * buffer = buffered_get_output( &size );
+    int start = -1;
+    int i = 0;
+
+    while( i < size ) {
+
+        int j = i;
+        char * label = NULL;
+
+        while( j < size && buffer[j] != '\n' ) {
+            ++j;
+        }
+
+        if ( start < 0 ) {
+            label = _begin;
+        } else {
+            label = _end;
+        }
+
+        int length = strlen( label );
+        if ( ( j - i ) >= length && memcmp( &buffer[i], label, length ) == 0 && 
+                ( i + length == j || !every_context_is_identifier( buffer[i + length] ) ) ) {
+            if ( start < 0 ) {
+                start = j + 1;
+            } else {
+                buffered_replace_output( start, i, _text, _size );
+                return 1;
+            }
+        }
+
+        i = j + 1;
+
+    }
+
+    return 0;
+
+}
+
+/**
+ * @brief Take note of a label called by the timer manager
+ * 
+ * @param _environment Current calling environment
+ * @param _label Label called by EVERY ... GOSUB / CALL
+ */
+void every_handler( Environment * _environment, char * _label ) {
+
+    int i;
+
+    if ( _environment->everyHandlersCount < 0 ) {
+        return;
+    }
+
+    for( i=0; i<_environment->everyHandlersCount; ++i ) {
+        if ( strcmp( _environment->everyHandlers[i], _label ) == 0 ) {
+            return;
+        }
+    }
+
+    if ( _environment->everyHandlersCount == MAX_EVERY_HANDLERS ) {
+        _environment->everyHandlersCount = -1;
+        return;
+    }
+
+    _environment->everyHandlers[_environment->everyHandlersCount++] = strdup( _label );
+
+}
+
+/**
+ * @brief Tailor the context saved by the timer manager to the EVERY handlers
+ * 
+ * The timer manager saves, by default, every register and pointer that
+ * a generic routine could change. Since the manager runs at every tick, 
+ * this is a cost paid also when no timer has to be called. This function 
+ * follows the code reachable from the labels given to EVERY ... GOSUB / 
+ * CALL, on the generated code, and collects what it really changes.
+ * Then it replaces the default save and restore (the code between 
+ * TIMERCONTEXTSAVE / TIMERCONTEXTSAVEEND and TIMERCONTEXTRESTORE / 
+ * TIMERCONTEXTRESTOREEND) with one that saves only that. Any jump or call 
+ * that cannot be followed keeps the full save.
+ * 
+ * @param _environment Current calling environment
+ */
+void every_context_cleanup( Environment * _environment ) {
+
+    if ( ! _environment->deployed.timer || _environment->everyHandlersCount < 0 ) {
+        return;
+    }
+
+    int size;
+    char * output = buffered_get_output( &size );
+    char * text = malloc( size + 1 );
+    memcpy( text, output, size );
+    text[size] = 0;
+
+    int linesCount = 1;
+    int i;
+    for( i=0; i<size; ++i ) {
+        if ( text[i] == '\n' ) {
+            ++linesCount;
+        }
+    }
+
+    EveryContextLine * lines = malloc( linesCount * sizeof( EveryContextLine ) );
+    memset( lines, 0, linesCount * sizeof( EveryContextLine ) );
+    EveryContextLabel * labels = malloc( linesCount * sizeof( EveryContextLabel ) );
+    int labelsCount = 0;
+
+    char * p = text;
+    for( i=0; i<linesCount; ++i ) {
+        char * next = strchr( p, '\n' );
+        if ( next ) {
+            *next = 0;
+        }
+        if ( next > p && next[-1] == '\r' ) {
+            next[-1] = 0;
+        }
+        every_context_decode( &lines[i], p );
+        if ( lines[i].label ) {
+            labels[labelsCount].name = lines[i].label;
+            labels[labelsCount].line = i;
+            ++labelsCount;
+        }
+        p = next ? next + 1 : p + strlen( p );
+    }
+
+    qsort( labels, labelsCount, sizeof( EveryContextLabel ), every_context_label_compare );
+
+    // Walk the code from each handler, following calls and jumps.
+    char * visited = malloc( linesCount );
+    memset( visited, 0, linesCount );
+    int * pending = malloc( ( linesCount + MAX_EVERY_HANDLERS ) * sizeof( int ) );
+    int pendingCount = 0;
+    int clobbers = 0;
+    int unknown = 0;
+
+    for( i=0; i<_environment->everyHandlersCount; ++i ) {
+        int line = every_context_find( labels, labelsCount, _environment->everyHandlers[i] );
+        if ( line < 0 ) {
+            unknown = 1;
+            break;
+        }
+        pending[pendingCount++] = line;
+    }
+
+    while( pendingCount && !unknown ) {
+
+        int line = pending[--pendingCount];
+
+        while( line < linesCount && !visited[line] && !unknown ) {
+
+            visited[line] = 1;
+
+            if ( lines[line].mnemonic ) {
+
+                char * target = NULL;
+                CodeLineFlow flow = cpu_code_line( _environment, lines[line].mnemonic, lines[line].operand, &clobbers, &target );
+
+                if ( flow == CLF_CALL || flow == CLF_BRANCH || flow == CLF_JUMP ) {
+                    char name[MAX_TEMPORARY_STORAGE];
+                    int length = 0;
+                    while( *target && !( isalpha( *target ) || *target == '_' || *target == '@' ) ) {
+                        if ( isdigit( *target ) || *target == '$' ) {
+                            break;
+                        }
+                        ++target;
+                    }
+                    while( every_context_is_identifier( target[length] ) && length < ( MAX_TEMPORARY_STORAGE - 1 ) ) {
+                        name[length] = target[length];
+                        ++length;
+                    }
+                    name[length] = 0;
+                    int destination = length ? every_context_find( labels, labelsCount, name ) : -1;
+                    if ( destination < 0 ) {
+                        unknown = 1;
+                    } else if ( !visited[destination] ) {
+                        pending[pendingCount++] = destination;
+                    }
+                } else if ( flow == CLF_UNKNOWN ) {
+                    unknown = 1;
+                }
+
+                if ( flow == CLF_JUMP || flow == CLF_RETURN ) {
+                    break;
+                }
+
+            }
+
+            ++line;
+
+        }
+
+    }
+
+    if ( !unknown ) {
+
+        int saveSize, restoreSize;
+        char * save, * restore;
+
+        buffered_push_output( );
+        cpu_timer_context( _environment, clobbers, 1 );
+        save = buffered_get_output( &saveSize );
+        buffered_pop_output( );
+
+        buffered_push_output( );
+        cpu_timer_context( _environment, clobbers, 0 );
+        restore = buffered_get_output( &restoreSize );
+        buffered_pop_output( );
+
+        every_context_splice( "TIMERCONTEXTSAVE", "TIMERCONTEXTSAVEEND", save, saveSize );
+        every_context_splice( "TIMERCONTEXTRESTORE", "TIMERCONTEXTRESTOREEND", restore, restoreSize );
+
+        free( save );
+        free( restore );
+
+    }
+
+    free( pending );
+    free( visited );
+    free( labels );
+    free( lines );
+    free( text );
+
+}
@@ -33,6 +33,7 @@
  ****************************************************************************/
 
 #include "../../ugbc.h"
+#include "../../libs/msc1.h"
 
 /****************************************************************************
  * CODE SECTION 
@@ -42,7 +43,9 @@
  * @brief Emit code for <strong>FILE ... AS ...</strong>
  * 
  * @param _environment Current calling environment
- * @param _name Name of the storage
+ * @param _source_name Name of the file to store
+ * @param _target_name Name of the file on the storage (if NULL, the source one)
+ * @param _flags Flags (FLAG_COMPRESSED to store the file compressed)
  */
 /* <usermanual>
 @keyword FILE
@@ -53,6 +56,11 @@ allows you to define the content of the mass storage element. The basic syntax r
 indicating the name of the ''source'' file that will be inserted into the medium. 
 If you don't want to use the same name, you can indicate an alias (''AS target'').
 
+By adding the ''COMPRESSED'' keyword, the file will be stored compressed 
+(if this saves space). On ''c64'', ''msx1'', ''coco'' and ''atari'' targets, 
+a ''DLOAD'' of this file (by using its name as a constant string) will uncompress 
+it while it is read, directly at the destination address.
+
 @italian
 Il comando ''FILE'', inserite all'interno di un blocco ''BEGIN STORAGE'' - 
 ''ENDSTORAGE'', permette di definire il contenuto dell'elemento di memorizzazione
@@ -60,17 +68,23 @@ di massa. La sintassi di base prevede di indicare il nome del file sorgente che
 sarà inserito nel supporto. Se non si vuole utilizzare lo stesso nome, è possibile 
 indicare un alias (''AS target'').
 
-@syntax FILE source [AS target]
+Aggiungendo la parola chiave ''COMPRESSED'', il file sarà memorizzato in forma
+compressa (se questo fa risparmiare spazio). Sui target ''c64'', ''msx1'', ''coco'' 
+e ''atari'', un ''DLOAD'' di questo file (usando il suo nome come stringa costante) 
+lo decomprimerà mentre viene letto, direttamente all'indirizzo di destinazione.
+
+@syntax FILE source [AS target] [COMPRESSED]
 
 @example FILE "examples/data.dat"
 @example FILE "sprites.png" AS "sprites.dat"
+@example FILE "level1.map" COMPRESSED
 
 @usedInExample storage_example_01.bas
 
 @target all
 @verified
 </usermanual> */
-void file_storage( Environment * _environment, char * _source_name, char * _target_name ) {
+void file_storage( Environment * _environment, char * _source_name, char * _target_name, int _flags ) {
 
     if ( !_environment->currentStorage ) {
         CRITICAL_STORAGE_NOT_OPENED();
@@ -93,11 +107,115 @@ void file_storage( Environment * _environment, char * _source_name, char * _targ
     fseek( file, 0, SEEK_END );
     int size = ftell( file );
     fseek( file, 0, SEEK_SET );
-    fclose( file );
     fileStorage->size = size;
 
+    if ( ( _flags & FLAG_COMPRESSED ) && size > 0 ) {
+
+        MemoryBlock * content = malloc( size );
+        (void)!fread( content, size, 1, file );
+
+        // Try to compress the content of the file, using the MSC1
+        // algorithm. As for images, the compressed content is kept 
+        // only if it is smaller than the original one.
+        MSC1Compressor * compressor = msc1_create( 32 );
+        int compressedSize = 0;
+        telemetry_begin( _environment, "msc1 compression" );
+        MemoryBlock * output = msc1_compress( compressor, content, size, &compressedSize );
+        telemetry_end( _environment );
+
+        int temporary;
+        MemoryBlock * outputCheck = msc1_uncompress( compressor, output, compressedSize, &temporary );
+        if ( memcmp( outputCheck, content, size ) != 0 ) {
+            CRITICAL("Compression failed");
+        }
+        msc1_free( compressor );
+        free( outputCheck );
+
+        if ( compressedSize < size ) {
+            fileStorage->content = (char *) output;
+            fileStorage->size = compressedSize;
+            fileStorage->uncompressedSize = size;
+            free( content );
+        } else {
+            fileStorage->content = (char *) content;
+            free( output );
+        }
+
+    }
+
+    fclose( file );
+
     fileStorage->next = _environment->currentStorage->files;
     _environment->currentStorage->files = fileStorage;
     _environment->currentFileStorage = fileStorage;
 
 }
+
+/**
+ * @brief Find the file that a <strong>DLOAD</strong> will read
+ * 
+ * This function looks for a file into the storages, by using the
+ * name given to <strong>DLOAD</strong>. This is possible only if
+ * the name is a constant string, known at compile time.
+ * 
+ * @param _environment Current calling environment
+ * @param _filename Name of the variable with the name of the file
+ * @return FileStorage* The file, or NULL if not found (or not constant)
+ */
+FileStorage * file_storage_find( Environment * _environment, char * _filename ) {
+
+    Variable * filename = variable_retrieve( _environment, _filename );
+
+    if ( filename->type != VT_STRING || ! filename->valueString ) {
+        return NULL;
+    }
+
+    Storage * storage = _environment->storage;
+
+    while( storage ) {
+
+        FileStorage * fileStorage = storage->files;
+
+        while( fileStorage ) {
+            if ( strcmp( fileStorage->targetName, filename->valueString->value ) == 0 ) {
+                return fileStorage;
+            }
+            fileStorage = fileStorage->next;
+        }
+
+        storage = storage->next;
+
+    }
+
+    return NULL;
+
+}
+
+/**
+ * @brief Record that a <strong>DLOAD</strong> uncompresses the file
+ * 
+ * This function must be called when a <strong>DLOAD</strong> emits the
+ * code that uncompresses the file while it is read. The variable linked
+ * to the file (if any) will receive the uncompressed content: so it must 
+ * be large as the uncompressed content, and it is not compressed anymore.
+ * 
+ * @param _environment Current calling environment
+ * @param _file_storage File that will be uncompressed while loaded
+ */
+void file_storage_uncompressed( Environment * _environment, FileStorage * _file_storage ) {
+
+    Variable * v = _file_storage->variable;
+
+    if ( ! v || ! _file_storage->uncompressedSize ) {
+        return;
+    }
+
+    if ( v->size < _file_storage->uncompressedSize ) {
+        v->valueBuffer = malloc( _file_storage->uncompressedSize );
+        v->size = _file_storage->uncompressedSize;
+        memset( v->valueBuffer, 0, v->size );
+    }
+
+    v->uncompressedSize = 0;
+
+}
@@ -57,6 +57,9 @@ as sound and light waves, the position and velocity of harmonic oscillators,
 sunlight intensity and day length, and average temperature variations throughout 
 the year.
 
+If the angle is an integer or a fixed point number, the value is read from
+a table and it is returned as a fixed point number (see ''DEFINE MATH'').
+
 @italian
 
 Questa funzione calcolerà il valore del coseno di un angolo. Il coseno di un angolo 
@@ -71,6 +74,9 @@ Le funzioni sinusoidali sono comunemente utilizzate per modellare fenomeni perio
 onde sonore e luminose, la posizione e la velocità degli oscillatori armonici, l'intensità 
 della luce solare e la durata del giorno e le variazioni di temperatura media durante tutto l'anno.
 
+Se l'angolo è un numero intero o in virgola fissa, il valore viene letto da
+una tabella e restituito come numero in virgola fissa (vedi ''DEFINE MATH'').
+
 @syntax = COS(angle)
 
 @example x = COS(PI/2)
@@ -81,7 +87,12 @@ della luce solare e la durata del giorno e le variazioni di temperatura media du
 </usermanual> */
 Variable * fp_cos( Environment * _environment, char * _angle ) {
 
+    if ( variable_exists( _environment, _angle ) && fixed_sin_applies( _environment, variable_retrieve( _environment, _angle ) ) ) {
+        return fixed_sin( _environment, variable_retrieve( _environment, _angle ), 1 );
+    }
+
     Variable * angle = variable_retrieve_or_define( _environment, _angle, VT_FLOAT, 0 );
+
     Variable * result = variable_temporary( _environment, VT_FLOAT, "(cos)");
 
     switch( result->precision ) {
@@ -47,11 +47,17 @@ This function will calculate the tangent value of an angle. It is the ratio
 of the opposite side and the adjacent side of the angle in consideration in 
 a right-angled triangle.
 
+If the angle is an integer or a fixed point number, the value is read from
+a table and it is returned as a fixed point number (see ''DEFINE MATH'').
+
 @italian
 Questa funzione calcolerà il valore della tangente di un angolo. È il rapporto 
 tra il lato opposto e il lato adiacente dell'angolo considerato in un triangolo 
 rettangolo.
 
+Se l'angolo è un numero intero o in virgola fissa, il valore viene letto da
+una tabella e restituito come numero in virgola fissa (vedi ''DEFINE MATH'').
+
 @syntax = TAN([angle])
 
 @example x = TAN(0)
@@ -62,6 +68,10 @@ rettangolo.
 </usermanual> */
 Variable * fp_tan( Environment * _environment, char * _angle ) {
 
+    if ( variable_exists( _environment, _angle ) && fixed_sin_applies( _environment, variable_retrieve( _environment, _angle ) ) ) {
+        return fixed_tan( _environment, variable_retrieve( _environment, _angle ) );
+    }
+
     Variable * angle = variable_retrieve_or_define( _environment, _angle, VT_FLOAT, 0 );
     Variable * result = variable_temporary( _environment, VT_FLOAT, "(tan)");
 
@@ -182,7 +182,7 @@ Variable * image_load( Environment * _environment, char * _filename, char * _ali
     fclose( lookedFileHandle );
 
     // Now we can decode the image using the external library.
-    unsigned char* source = stbi_load(lookedFilename, &width, &height, &depth, 0);
+    unsigned char* source = image_cache_load( _environment, lookedFilename, &width, &height, &depth );
 
     // If we are unable to decode the iamge, we stop the compilation.
     if ( !source ) {
@@ -213,7 +213,9 @@ Variable * image_load( Environment * _environment, char * _filename, char * _ali
     // custom format of the target. This is a time efficient mode to store
     // the image, but not a space efficient (no compression is done).
     // Space efficiency can be applied after, if a bank is present.
+    telemetry_begin( _environment, "image conversion" );
     result = image_converter( _environment, source, width, height, depth, 0, 0, 0, 0, _mode, _transparent_color, _flags );
+    telemetry_end( _environment );
 
     // ADI INFO
     adiline1("LI2:%x", result->size );
@@ -233,7 +235,9 @@ Variable * image_load( Environment * _environment, char * _filename, char * _ali
         // the buffer will be considered as "uncompressed" size.
         MSC1Compressor * compressor = msc1_create( 32 );
         result->uncompressedSize = result->size;
+        telemetry_begin( _environment, "msc1 compression" );
         MemoryBlock * output = msc1_compress( compressor, result->valueBuffer, result->uncompressedSize, &result->size );
+        telemetry_end( _environment );
 
         int temporary;
         MemoryBlock * outputCheck = msc1_uncompress( compressor, output, result->size, &temporary );
@@ -302,7 +306,9 @@ Variable * image_load( Environment * _environment, char * _filename, char * _ali
         // the buffer will be considered as "uncompressed" size.
         MSC1Compressor * compressor = msc1_create( 32 );
         result->uncompressedSize = result->size;
+        telemetry_begin( _environment, "msc1 compression" );
         MemoryBlock * output = msc1_compress( compressor, result->valueBuffer, result->uncompressedSize, &result->size );
+        telemetry_end( _environment );
 
         int temporary;
         MemoryBlock * outputCheck = msc1_uncompress( compressor, output, result->size, &temporary );
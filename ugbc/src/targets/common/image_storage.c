@@ -75,7 +75,7 @@ lo stesso nome, è possibile indicare un alias (''AS target'').
 </usermanual> */
 Variable * image_storage( Environment * _environment, char * _source_name, char * _target_name, int _mode, int _flags, int _transparent_color, int _background_color, int _bank_expansion ) {
 
-    file_storage( _environment, _source_name, _target_name );
+    file_storage( _environment, _source_name, _target_name, 0 );
 
     // No we are going to load the image from the PC.
     // Those variables will maintain the data of the original image.
@@ -93,7 +93,7 @@ Variable * image_storage( Environment * _environment, char * _source_name, char
     fclose( lookedFileHandle );
 
     // Now we can decode the image using the external library.
-    unsigned char* source = stbi_load(lookedFilename, &width, &height, &depth, 0);
+    unsigned char* source = image_cache_load( _environment, lookedFilename, &width, &height, &depth );
 
     // If we are unable to decode the iamge, we stop the compilation.
     if ( !source ) {
@@ -121,7 +121,9 @@ Variable * image_storage( Environment * _environment, char * _source_name, char
     // custom format of the target. This is a time efficient mode to store
     // the image, but not a space efficient (no compression is done).
     // Space efficiency can be applied after, if a bank is present.
+    telemetry_begin( _environment, "image conversion" );
     Variable * result = image_converter( _environment, source, width, height, depth, 0, 0, 0, 0, _mode, _transparent_color, _flags );
+    telemetry_end( _environment );
 
     if ( _flags & FLAG_COMPRESSED ) {
 
@@ -131,7 +133,9 @@ Variable * image_storage( Environment * _environment, char * _source_name, char
         // the buffer will be considered as "uncompressed" size.
         MSC1Compressor * compressor = msc1_create( 32 );
         result->uncompressedSize = result->size;
+        telemetry_begin( _environment, "msc1 compression" );
         MemoryBlock * output = msc1_compress( compressor, result->valueBuffer, result->uncompressedSize, &result->size );
+        telemetry_end( _environment );
 
         int temporary;
         MemoryBlock * outputCheck = msc1_uncompress( compressor, output, result->size, &temporary );
@@ -160,6 +164,7 @@ Variable * image_storage( Environment * _environment, char * _source_name, char
     }
 
     _environment->currentFileStorage->size = result->size;
+    _environment->currentFileStorage->uncompressedSize = result->uncompressedSize;
     _environment->currentFileStorage->content = result->valueBuffer;
 
     return result;
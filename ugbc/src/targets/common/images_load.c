@@ -177,7 +177,7 @@ Variable * images_load( Environment * _environment, char * _filename, char * _al
         if ( _frame_height < 0 || _frame_width < 0 ) {
             CRITICAL_IMAGES_LOAD_INVALID_AUTO_WITHOUT_GIF( _filename );            
         }
-        source = stbi_load(lookedFilename, &width, &height, &depth, 0);
+        source = image_cache_load( _environment, lookedFilename, &width, &height, &depth );
         frames = 0;
         layout_mode = 0;
     }
@@ -244,7 +244,9 @@ Variable * images_load( Environment * _environment, char * _filename, char * _al
         for( z=0; z<a; ++z ) {
             for( y=0; y<height; y+=_frame_height ) {
                 for( x=0; x<width; x+=_frame_width ) {
+                    telemetry_begin( _environment, "image conversion" );
                     result[i] = image_converter( _environment, source, width, height, depth, x, y, _frame_width, _frame_height, _mode, _transparent_color, _flags );
+                    telemetry_end( _environment );
                     bufferSize += result[i]->size;
                     i += di;
                 }
@@ -285,7 +287,9 @@ Variable * images_load( Environment * _environment, char * _filename, char * _al
         for( z=0; z<frames; ++z ) {
             // for( y=0; y<height; y+=_frame_height ) {
             //     for( x=0; x<width; x+=_frame_width ) {
+                    telemetry_begin( _environment, "image conversion" );
                     result[i] = image_converter( _environment, source, width, height, depth, 0, 0, _frame_width, _frame_height, _mode, _transparent_color, _flags );
+                    telemetry_end( _environment );
                     bufferSize += result[i]->size;
                     ++i;
                     source += (width*height*depth)+2;
@@ -423,7 +427,9 @@ Variable * images_load( Environment * _environment, char * _filename, char * _al
         // the buffer will be considered as "uncompressed" size.
         MSC1Compressor * compressor = msc1_create( 32 );
         final->uncompressedSize = final->size;
+        telemetry_begin( _environment, "msc1 compression" );
         MemoryBlock * output = msc1_compress( compressor, final->valueBuffer, final->uncompressedSize, &final->size );
+        telemetry_end( _environment );
 
         int temporary;
         MemoryBlock * outputCheck = msc1_uncompress( compressor, output, final->size, &temporary );
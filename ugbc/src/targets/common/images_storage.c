@@ -75,7 +75,7 @@ lo stesso nome, è possibile indicare un alias (''AS target'').
 </usermanual> */
 Variable * images_storage( Environment * _environment, char * _source_name, char * _target_name, int _mode, int _frame_width, int _frame_height, int _flags, int _transparent_color, int _background_color, int _bank_expansion ) {
 
-    file_storage( _environment, _source_name, _target_name );
+    file_storage( _environment, _source_name, _target_name, 0 );
 
     Variable * final = variable_temporary( _environment, VT_IMAGES, 0 );
 
@@ -102,7 +102,7 @@ Variable * images_storage( Environment * _environment, char * _source_name, char
         if ( _frame_height < 0 || _frame_width < 0 ) {
             CRITICAL_IMAGES_LOAD_INVALID_AUTO_WITHOUT_GIF( _source_name );            
         }
-        source = stbi_load(lookedFilename, &width, &height, &depth, 0);
+        source = image_cache_load( _environment, lookedFilename, &width, &height, &depth );
         frames = 0;
         layout_mode = 0;
     }
@@ -165,7 +165,9 @@ Variable * images_storage( Environment * _environment, char * _source_name, char
         for( z=0; z<a; ++z ) {
             for( y=0; y<height; y+=_frame_height ) {
                 for( x=0; x<width; x+=_frame_width ) {
+                    telemetry_begin( _environment, "image conversion" );
                     result[i] = image_converter( _environment, source, width, height, depth, x, y, _frame_width, _frame_height, _mode, _transparent_color, _flags );
+                    telemetry_end( _environment );
                     bufferSize += result[i]->size;
                     i += di;
                 }
@@ -204,7 +206,9 @@ Variable * images_storage( Environment * _environment, char * _source_name, char
         for( z=0; z<frames; ++z ) {
             // for( y=0; y<height; y+=_frame_height ) {
             //     for( x=0; x<width; x+=_frame_width ) {
+                    telemetry_begin( _environment, "image conversion" );
                     result[i] = image_converter( _environment, source, width, height, depth, 0, 0, _frame_width, _frame_height, _mode, _transparent_color, _flags );
+                    telemetry_end( _environment );
                     bufferSize += result[i]->size;
                     ++i;
                     source += (width*height*depth)+2;
@@ -264,7 +268,9 @@ Variable * images_storage( Environment * _environment, char * _source_name, char
         // the buffer will be considered as "uncompressed" size.
         MSC1Compressor * compressor = msc1_create( 32 );
         final->uncompressedSize = final->size;
+        telemetry_begin( _environment, "msc1 compression" );
         MemoryBlock * output = msc1_compress( compressor, final->valueBuffer, final->uncompressedSize, &final->size );
+        telemetry_end( _environment );
 
         int temporary;
         MemoryBlock * outputCheck = msc1_uncompress( compressor, output, final->size, &temporary );
@@ -297,6 +303,7 @@ Variable * images_storage( Environment * _environment, char * _source_name, char
     }
 
     _environment->currentFileStorage->size = final->size;
+    _environment->currentFileStorage->uncompressedSize = final->uncompressedSize;
     _environment->currentFileStorage->content = final->valueBuffer;
 
     return final;
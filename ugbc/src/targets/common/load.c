@@ -143,7 +143,9 @@ Variable * load( Environment * _environment, char * _filename, char * _alias, in
         // the buffer will be considered as "uncompressed" size.
         MSC1Compressor * compressor = msc1_create( 32 );
         result->uncompressedSize = result->size;
+        telemetry_begin( _environment, "msc1 compression" );
         MemoryBlock * output = msc1_compress( compressor, result->valueBuffer, result->uncompressedSize, &result->size );
+        telemetry_end( _environment );
 
         int temporary;
         MemoryBlock * outputCheck = msc1_uncompress( compressor, output, result->size, &temporary );
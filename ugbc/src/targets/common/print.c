@@ -128,6 +128,10 @@ void print( Environment * _environment, char * _value, int _new_line ) {
     MAKE_LABEL
 
     Variable * value = variable_retrieve_or_define( _environment, _value, VT_DSTRING, 0 );
+
+    if ( VT_FIXED_TYPE( value->type ) ) {
+        value = variable_cast( _environment, value->name, VT_FLOAT );
+    }
     
     if ( value->type != VT_DSTRING && value->type != VT_STRING && value->type != VT_CHAR ) {
         switch( VT_BITWIDTH( value->type ) ) {
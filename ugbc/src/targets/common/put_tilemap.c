@@ -40,6 +40,47 @@
 
 extern char DATATYPE_AS_STRING[][16];
 
+// How the cells of the shadow are used while drawing a layer.
+#define PUT_TILEMAP_SHADOW_REDRAW           0
+#define PUT_TILEMAP_SHADOW_DELTA            1
+#define PUT_TILEMAP_SHADOW_INVALIDATE       2
+
+/**
+ * @brief Emit ASM code to compare a cell with the shadow of the last drawn map
+ * 
+ * The shadow remembers the frame drawn on each cell of the screen. When
+ * drawing in delta mode, the code jumps to _skip if the frame is the same
+ * already drawn; otherwise (and in redraw mode) it updates the shadow. 
+ * Cells of the layers over the first one are marked as unknown (0xff).
+ * 
+ * @param _environment Current calling environment
+ * @param _shadowAddress Address of the current cell of the shadow
+ * @param _shadowMode Mode to use (PUT_TILEMAP_SHADOW_xxx)
+ * @param _frame Frame to draw on the cell
+ * @param _skip Label to jump to if the cell must not be drawn
+ */
+static void put_tilemap_shadow( Environment * _environment, Variable * _shadowAddress, Variable * _shadowMode, Variable * _frame, char * _skip ) {
+
+    MAKE_LABEL
+
+    char labelWrite[MAX_TEMPORARY_STORAGE]; sprintf( labelWrite, "%sw", label );
+
+    Variable * value = variable_temporary( _environment, VT_BYTE, "(shadow)" );
+
+    cpu_move_8bit( _environment, _frame->realName, value->realName );
+    cpu_compare_and_branch_8bit_const( _environment, _shadowMode->realName, PUT_TILEMAP_SHADOW_REDRAW, labelWrite, 1 );
+    cpu_store_8bit( _environment, value->realName, 0xff );
+    cpu_compare_and_branch_8bit_const( _environment, _shadowMode->realName, PUT_TILEMAP_SHADOW_INVALIDATE, labelWrite, 1 );
+
+    cpu_peek( _environment, _shadowAddress->realName, value->realName );
+    cpu_compare_and_branch_8bit( _environment, value->realName, _frame->realName, _skip, 1 );
+    cpu_move_8bit( _environment, _frame->realName, value->realName );
+
+    cpu_label( _environment, labelWrite );
+    cpu_poke( _environment, _shadowAddress->realName, value->realName );
+
+}
+
 /**
  * @brief Emit ASM code for <b>PUT TILEMAP [tilemap]</b>
  * 
@@ -59,18 +100,53 @@ map is bigger than the screen, the comamnd only draws a part of the map. To scro
 can use the ''FROM'' parameter with the offsets (in terms of tiles) starting from which the map will 
 have to be drawn on the screen.
 
+With the ''DELTA'' keyword, the command remembers which frame has been drawn on each cell of the
+screen, and it draws only the cells whose frame is changed. When the map is scrolled by one tile,
+only the cells that actually change (typically, the newly exposed row or column and the borders
+of the objects on the map) are redrawn. The first ''PUT TILEMAP ... DELTA'' draws the whole map.
+Since the command cannot know what has been drawn by other commands, after a ''CLS'' (or after
+drawing over the map) you should use ''PUT TILEMAP'' without ''DELTA'', that redraws every cell.
+For maps with more than one layer, ''DELTA'' is applied only when a single ''LAYER'' is drawn.
+
 @italian
 
-@syntax PUT TILEMAP resource [ LAYER layer ] [ FROM x, y ]
+Con la parola chiave ''DELTA'' il comando ricorda quale fotogramma è stato disegnato su ogni cella
+dello schermo, e disegna solo le celle il cui fotogramma è cambiato. Quando la mappa viene
+fatta scorrere di una tessera, vengono ridisegnate solo le celle che cambiano davvero (di solito,
+la nuova riga o colonna esposta e i bordi degli oggetti sulla mappa). Il primo
+''PUT TILEMAP ... DELTA'' disegna l'intera mappa. Poiché il comando non può sapere cosa è stato
+disegnato da altri comandi, dopo un ''CLS'' (o dopo aver disegnato sopra la mappa) è necessario
+usare ''PUT TILEMAP'' senza ''DELTA'', che ridisegna tutte le celle. Per le mappe con più
+livelli, ''DELTA'' viene applicato solo quando si disegna un solo ''LAYER''.
+
+@syntax PUT TILEMAP resource [ LAYER layer ] [ FROM x, y ] [ DELTA ]
 
 @example PUT TILEMAP map
+@example PUT TILEMAP map FROM x, y DELTA
 
 @target all
 </usermanual> */
 
-void put_tilemap_vars( Environment * _environment, char * _tilemap, int _flags, char * _dx, char * _dy, char * _layer, char * _pad_frame ) {
-
-    deploy_begin( put_tilemap );
+/**
+ * @brief Emit ASM code for the routine that draws a tilemap
+ * 
+ * The routine is emitted in two versions. The plain one (lib_put_tilemap)
+ * draws every cell. The delta one (lib_put_tilemap_delta) compares each
+ * cell with the shadow, so it pays a few more instructions for each cell:
+ * it is emitted only if ''PUT TILEMAP ... DELTA'' is used. Every call of
+ * the plain version changes a generation counter, so that the delta one
+ * knows when the shadow does not match the screen anymore, and redraws
+ * all the cells.
+ * 
+ * Tiles are drawn by put_image_vars() on every target: there is no
+ * renderer that writes the tile indexes straight into the name table of
+ * the video chip, so the delta version saves the time of the skipped
+ * images and nothing more.
+ * 
+ * @param _environment Current calling environment
+ * @param _delta 1 to emit the delta version, 0 for the plain one
+ */
+static void put_tilemap_routine( Environment * _environment, int _delta ) {
 
         MAKE_LABEL
 
@@ -88,6 +164,10 @@ void put_tilemap_vars( Environment * _environment, char * _tilemap, int _flags,
         char labelExitFrame[MAX_TEMPORARY_STORAGE]; sprintf( labelExitFrame, "%sfr", label );
         char labelSkipFxCheck[MAX_TEMPORARY_STORAGE]; sprintf( labelSkipFxCheck, "%sskipx", label );
         char labelSkipIndexCheck[MAX_TEMPORARY_STORAGE]; sprintf( labelSkipIndexCheck, "%sskipy", label );
+        char labelForLayerOffset[MAX_TEMPORARY_STORAGE]; sprintf( labelForLayerOffset, "%slo", label );
+        char labelDoneLayerOffset[MAX_TEMPORARY_STORAGE]; sprintf( labelDoneLayerOffset, "%slod", label );
+        char labelSingleLayer[MAX_TEMPORARY_STORAGE]; sprintf( labelSingleLayer, "%ssl", label );
+        char labelSameGeneration[MAX_TEMPORARY_STORAGE]; sprintf( labelSameGeneration, "%ssg", label );
 
         // Local constants
         Variable * transparency = variable_temporary( _environment, VT_WORD, "(flags)" );
@@ -109,6 +189,13 @@ void put_tilemap_vars( Environment * _environment, char * _tilemap, int _flags,
         Variable * padFrame = variable_define( _environment, "puttilemap__padFrame", VT_BYTE, 0 );
         Variable * mapLayers = variable_define( _environment, "puttilemap__mapLayers", VT_BYTE, 0 );
         Variable * offsetFrameRoutine = variable_define( _environment, "puttilemap__offsetFrameRoutine", VT_ADDRESS, 0 );
+        Variable * generation = variable_define( _environment, "puttilemap__generation", VT_BYTE, 0 );
+        Variable * shadow = NULL;
+        Variable * shadowGeneration = NULL;
+        if ( _delta ) {
+            shadow = variable_define( _environment, "puttilemap__shadow", VT_ADDRESS, 0 );
+            shadowGeneration = variable_define( _environment, "puttilemap__shadowGeneration", VT_BYTE, 0 );
+        }
 
         // Local variables
         Variable * index = variable_temporary( _environment, VT_WORD, "(index)" );
@@ -119,6 +206,13 @@ void put_tilemap_vars( Environment * _environment, char * _tilemap, int _flags,
         Variable * padding = variable_temporary( _environment, VT_BYTE, "(padding)" );
         Variable * padding2 = variable_temporary( _environment, VT_BYTE, "(padding2)" );
         Variable * layerIndex = variable_temporary( _environment, VT_BYTE, "(layerIndex)" );
+        Variable * offset = variable_temporary( _environment, VT_WORD, "(offset)" );
+        Variable * shadowAddress = NULL;
+        Variable * shadowMode = NULL;
+        if ( _delta ) {
+            shadowAddress = variable_temporary( _environment, VT_ADDRESS, "(shadowAddress)" );
+            shadowMode = variable_temporary( _environment, VT_BYTE, "(shadowMode)" );
+        }
 
         // Starting index from 0 (zero).
         variable_store( _environment, index->name, 0 );
@@ -126,25 +220,56 @@ void put_tilemap_vars( Environment * _environment, char * _tilemap, int _flags,
         // Starting layer from 0 (zero).
         variable_store( _environment, layerIndex->name, 0 );
 
-        // If a starting point has been given, we must increase the
-        // index to match the first tile to draw.
-        variable_move( _environment, variable_add( _environment, index->name, variable_mul( _environment, dy->name, mapWidth->name )->name )->name, index->name );
-        variable_move( _environment, variable_add( _environment, index->name, dx->name )->name, index->name );
-
-        // If a layer has been given, we must increate the index to match
-        // the first tile of the layer to draw.
-        variable_move( _environment, variable_add( _environment, index->name, variable_mul( _environment, layer->name, size->name )->name )->name, index->name );
-
-        // *** Add index to the tile address
-        cpu_math_add_16bit( _environment, tilemapAddress->realName, index->realName, tilemapAddress->realName );
-
-        // Restore index to zero.
-        variable_store( _environment, index->name, 0 );
+        // If a starting point has been given, we must move the tile address
+        // to match the first tile to draw. Both the operands are bytes, so
+        // the offset is obtained with a single 8 bit multiplication.
+        cpu_math_mul_8bit_to_16bit( _environment, dy->realName, mapWidth->realName, offset->realName, 0 );
+        cpu_math_add_16bit( _environment, tilemapAddress->realName, offset->realName, tilemapAddress->realName );
+        cpu_math_add_16bit_with_8bit( _environment, tilemapAddress->realName, dx->realName, tilemapAddress->realName );
+
+        // If a layer has been given, we must move the tile address to match
+        // the first tile of the layer to draw. Maps have few layers, so a
+        // sum for each layer is cheaper than a 16 bit multiplication.
+        variable_move( _environment, layer->name, padding->name );
+        cpu_label( _environment, labelForLayerOffset );
+        cpu_compare_and_branch_8bit_const(  _environment, padding->realName, 0, labelDoneLayerOffset, 1 );
+        cpu_math_add_16bit( _environment, tilemapAddress->realName, size->realName, tilemapAddress->realName );
+        cpu_dec( _environment, padding->realName );
+        cpu_jump( _environment, labelForLayerOffset );
+        cpu_label( _environment, labelDoneLayerOffset );
+
+        if ( _delta ) {
+
+            // The first layer draws only the changed cells, unless the plain
+            // routine has drawn something after the last call: in that case
+            // the shadow does not match the screen, and all the cells are
+            // redrawn. Since the shadow can remember only one frame for each
+            // cell, more layers are always redrawn and the cells of the shadow 
+            // are marked as unknown.
+            variable_store( _environment, shadowMode->name, PUT_TILEMAP_SHADOW_DELTA );
+            cpu_compare_and_branch_8bit( _environment, generation->realName, shadowGeneration->realName, labelSameGeneration, 1 );
+            variable_store( _environment, shadowMode->name, PUT_TILEMAP_SHADOW_REDRAW );
+            cpu_move_8bit( _environment, generation->realName, shadowGeneration->realName );
+            cpu_label( _environment, labelSameGeneration );
+            cpu_compare_and_branch_8bit_const(  _environment, mapLayers->realName, 1, labelSingleLayer, 1 );
+            variable_store( _environment, shadowMode->name, PUT_TILEMAP_SHADOW_REDRAW );
+            cpu_label( _environment, labelSingleLayer );
+
+        } else {
+
+            // Anything drawn here is unknown to the shadow of the delta routine.
+            cpu_inc( _environment, generation->realName );
+
+        }
 
         // For each layer (actually, a normal map has just one layer).
         // for( int layerIndex = 0; layerIndex < tilemap->mapLayers; ++layerIndex ) {
         cpu_label( _environment, labelForLayers );
 
+            if ( _delta ) {
+                cpu_move_16bit( _environment, shadow->realName, shadowAddress->realName );
+            }
+
             // If a specific layer is selected, we must point to that layer.
             // Let's start from the start of the screen.
 
@@ -201,6 +326,10 @@ void put_tilemap_vars( Environment * _environment, char * _tilemap, int _flags,
             // In case the frame read from the map is 0xff, it means that that specific
             // frame has not to be drawn, so we exit from this frame drawing.
 
+            if ( _delta ) {
+                put_tilemap_shadow( _environment, shadowAddress, shadowMode, frame, labelExitFrame );
+            }
+
             cpu_compare_and_branch_8bit_const(  _environment, frame->realName, 0xff, labelExitFrame, 1 );
 
             // --- DRAW TILE --
@@ -211,6 +340,9 @@ void put_tilemap_vars( Environment * _environment, char * _tilemap, int _flags,
             // --- DRAW PADDING TILE --
 
             cpu_label( _environment, labelPadding );
+            if ( _delta ) {
+                put_tilemap_shadow( _environment, shadowAddress, shadowMode, padFrame, labelDonePutImage );
+            }
             cpu_compare_and_branch_8bit_const(  _environment, padFrame->realName, 0x00, labelDonePutImage, 1 );
 
             put_image_vars( _environment, tilesetAddress->name, x->name, y->name, NULL, NULL, padFrame->name, NULL, flags->name );
@@ -221,6 +353,12 @@ void put_tilemap_vars( Environment * _environment, char * _tilemap, int _flags,
 
             cpu_label( _environment, labelDonePutImage ); cpu_label( _environment, labelExitFrame );
 
+            // Move to the next cell of the shadow.
+
+            if ( _delta ) {
+                cpu_inc_16bit( _environment, shadowAddress->realName );
+            }
+
             // Increase the horizontal frames drawed count.
 
             cpu_inc( _environment, fx->realName );
@@ -308,6 +446,11 @@ void put_tilemap_vars( Environment * _environment, char * _tilemap, int _flags,
                 variable_store( _environment, index->name, 0 );
             // }
 
+            // Next layers are drawn over the first one.
+            if ( _delta ) {
+                variable_store( _environment, shadowMode->name, PUT_TILEMAP_SHADOW_INVALIDATE );
+            }
+
             // _flags = _flags | FLAG_TRANSPARENCY;
             variable_move( _environment, 
                     variable_or( _environment, flags->name, transparency->name )->name, 
@@ -321,13 +464,25 @@ void put_tilemap_vars( Environment * _environment, char * _tilemap, int _flags,
 
         cpu_return( _environment );
 
-        cpu_label( _environment, "_puttilemap__tilesetoffsetframe" );
+        cpu_label( _environment, _delta ? "_puttilemap__tilesetoffsetframedelta" : "_puttilemap__tilesetoffsetframe" );
 
         cpu_call_indirect( _environment, "_puttilemap__offsetFrameRoutine" );
 
         cpu_return( _environment );
 
-    deploy_end( put_tilemap );
+}
+
+void put_tilemap_vars( Environment * _environment, char * _tilemap, int _flags, char * _dx, char * _dy, char * _layer, char * _pad_frame ) {
+
+    if ( _flags & FLAG_DELTA ) {
+        deploy_begin( put_tilemap_delta );
+            put_tilemap_routine( _environment, 1 );
+        deploy_end( put_tilemap_delta );
+    } else {
+        deploy_begin( put_tilemap );
+            put_tilemap_routine( _environment, 0 );
+        deploy_end( put_tilemap );
+    }
 
     Variable * ptilemap = variable_retrieve( _environment, _tilemap );
     if ( ptilemap->type != VT_TILEMAP ) {
@@ -377,7 +532,41 @@ void put_tilemap_vars( Environment * _environment, char * _tilemap, int _flags,
     }
 
     Variable * vflags = variable_retrieve( _environment, "puttilemap__flags" );
-    variable_store( _environment, vflags->name, _flags );
+    variable_store( _environment, vflags->name, _flags & ~FLAG_DELTA );
+
+    if ( _flags & FLAG_DELTA ) {
+
+        // The shadow must have a cell for each tile that fits on the screen,
+        // even partially. The size of the tiles is taken from the tileset,
+        // that is known also for the maps on a storage; if it is missing,
+        // tiles of 8x8 pixels are assumed.
+        int cellWidth = 8;
+        int cellHeight = 8;
+        if ( ptilemap->tileset && ptilemap->tileset->frameWidth && ptilemap->tileset->frameHeight ) {
+            cellWidth = ptilemap->tileset->frameWidth;
+            cellHeight = ptilemap->tileset->frameHeight;
+        }
+        int cells = ( ( _environment->screenWidth + cellWidth - 1 ) / cellWidth ) * ( ( _environment->screenHeight + cellHeight - 1 ) / cellHeight );
+
+        // A single shadow is shared by all the maps, so it grows up to
+        // the largest number of cells. 0xff marks the cells as unknown, 
+        // so the first PUT TILEMAP ... DELTA will draw them all.
+        if ( ! _environment->tilemapShadow ) {
+            unsigned char * unknown = malloc( cells );
+            memset( unknown, 0xff, cells );
+            _environment->tilemapShadow = variable_temporary( _environment, VT_BUFFER, "(tilemap shadow)" );
+            variable_store_buffer( _environment, _environment->tilemapShadow->name, unknown, cells, 0 );
+            free( unknown );
+        } else if ( _environment->tilemapShadow->size < cells ) {
+            _environment->tilemapShadow->valueBuffer = realloc( _environment->tilemapShadow->valueBuffer, cells );
+            memset( _environment->tilemapShadow->valueBuffer + _environment->tilemapShadow->size, 0xff, cells - _environment->tilemapShadow->size );
+            _environment->tilemapShadow->size = cells;
+        }
+
+        Variable * vshadow = variable_retrieve( _environment, "puttilemap__shadow" );
+        cpu_addressof_16bit( _environment, _environment->tilemapShadow->realName, vshadow->realName );
+
+    }
 
     Variable * vpadFrame = variable_retrieve( _environment, "puttilemap__padFrame" );
     if ( _pad_frame ) {
@@ -480,7 +669,7 @@ void put_tilemap_vars( Environment * _environment, char * _tilemap, int _flags,
         cpu_addressof_16bit( _environment, labelForTileOffsetFrame, voffsetFrameRoutine->realName );
     }
     
-    cpu_call( _environment, "lib_put_tilemap" );
+    cpu_call( _environment, ( _flags & FLAG_DELTA ) ? "lib_put_tilemap_delta" : "lib_put_tilemap" );
 
 }
 
@@ -82,16 +82,12 @@ static void read_data_safe( Environment * _environment, char * _variable ) {
         case 32:
             cpu_inc_16bit( _environment, dataptr->realName );
             cpu_move_32bit_indirect2( _environment, dataptr->realName, variable->realName );
-            cpu_inc_16bit( _environment, dataptr->realName );
-            cpu_inc_16bit( _environment, dataptr->realName );
-            cpu_inc_16bit( _environment, dataptr->realName );
-            cpu_inc_16bit( _environment, dataptr->realName );
+            cpu_math_add_16bit_const( _environment, dataptr->realName, 4, dataptr->realName );
             break;
         case 16:
             cpu_inc_16bit( _environment, dataptr->realName );
             cpu_move_16bit_indirect2( _environment, dataptr->realName, variable->realName );
-            cpu_inc_16bit( _environment, dataptr->realName );
-            cpu_inc_16bit( _environment, dataptr->realName );
+            cpu_math_add_16bit_const( _environment, dataptr->realName, 2, dataptr->realName );
             break;
         case 8:
             cpu_inc_16bit( _environment, dataptr->realName );
@@ -147,10 +143,7 @@ static void read_data_safe( Environment * _environment, char * _variable ) {
 
         cpu_inc_16bit( _environment, dataptr->realName );
         cpu_move_32bit_indirect2( _environment, dataptr->realName, data32->realName );
-        cpu_inc_16bit( _environment, dataptr->realName );
-        cpu_inc_16bit( _environment, dataptr->realName );
-        cpu_inc_16bit( _environment, dataptr->realName );
-        cpu_inc_16bit( _environment, dataptr->realName );
+        cpu_math_add_16bit_const( _environment, dataptr->realName, 4, dataptr->realName );
 
         variable_move( _environment, data32->name, variable->name );
 
@@ -162,8 +155,7 @@ static void read_data_safe( Environment * _environment, char * _variable ) {
 
         cpu_inc_16bit( _environment, dataptr->realName );
         cpu_move_16bit_indirect2( _environment, dataptr->realName, data16->realName );
-        cpu_inc_16bit( _environment, dataptr->realName );
-        cpu_inc_16bit( _environment, dataptr->realName );
+        cpu_math_add_16bit_const( _environment, dataptr->realName, 2, dataptr->realName );
 
         variable_move( _environment, data16->name, variable->name );
 
@@ -202,6 +194,53 @@ static void read_data_safe( Environment * _environment, char * _variable ) {
 
 }
 
+/**
+ * @brief Emit code for <strong>READ</strong> from untagged (typed) DATA
+ * 
+ * With <strong>OPTION DATA AS</strong> every item has the same type and
+ * no tag, so there is nothing to check but the end of data: the item is
+ * read by the (target specific) unsafe reader, that advances the pointer
+ * by the size of the item, and converted if the variable has another type.
+ * 
+ * @param _environment Current calling environment
+ * @param _variable Variable to store to
+ * @param _safe Do not read past the end of data
+ */
+static void read_data_typed( Environment * _environment, char * _variable, int _safe ) {
+
+    MAKE_LABEL
+
+    char doneReadLabel[MAX_TEMPORARY_STORAGE]; sprintf( doneReadLabel, "%sdone", label );
+
+    Variable * variable = NULL;
+
+    if ( variable_exists( _environment, _variable ) ) {
+        variable = variable_retrieve( _environment, _variable );
+    } else {
+        variable = variable_define( _environment, _variable, _environment->defaultVariableType, 0 );
+    }
+
+    if ( VT_BITWIDTH( variable->type ) < 8 && variable->type != VT_FLOAT ) {
+        CRITICAL_READ_DATA_TYPE_NOT_SUPPORTED( _variable, DATATYPE_AS_STRING[variable->type] );
+    }
+
+    if ( _safe ) {
+        Variable * readEnd = read_end( _environment );
+        cpu_compare_and_branch_8bit_const( _environment, readEnd->realName, 0, doneReadLabel, 0 );
+    }
+
+    if ( variable->type == _environment->optionDataType ) {
+        read_data_unsafe( _environment, variable->name );
+    } else {
+        Variable * data = variable_temporary( _environment, _environment->optionDataType, "(data)" );
+        read_data_unsafe( _environment, data->name );
+        variable_move( _environment, data->name, variable->name );
+    }
+
+    cpu_label( _environment, doneReadLabel );
+
+}
+
 static void read_data_unsafe_common( Environment * _environment, char * _variable ) {
 
     MAKE_LABEL
@@ -285,7 +324,9 @@ void read_data( Environment * _environment, char * _variable, int _safe ) {
 
     _environment->readDataUsed = 1;
 
-    if ( _safe ) {
+    if ( _environment->optionDataType ) {
+        read_data_typed( _environment, _variable, _safe );
+    } else if ( _safe ) {
         read_data_safe( _environment, _variable );
     } else {
         read_data_unsafe_common( _environment, _variable );
@@ -293,3 +334,97 @@ void read_data( Environment * _environment, char * _variable, int _safe ) {
 
 }
 
+/**
+ * @brief Emit code for <strong>READ INTO</strong> instruction
+ * 
+ * @param _environment Current calling environment
+ * @param _array Array to fill
+ * @param _safe Do not read past the end of data
+ */
+/* <usermanual>
+@keyword READ INTO
+
+@english
+
+The ''READ INTO'' command fills a whole array with the next values of the 
+''DATA'' lines, as many as the elements of the array, in the same order
+they are stored in memory. The values are copied as a single block of 
+memory, so it is much faster than reading the elements one by one. For 
+this reason, the program must declare that every ''DATA'' has the same 
+type of the array's elements, with ''OPTION DATA AS''. Using ''SAFE'',
+the array will not be touched if there are not enough values left.
+
+@italian
+
+Il comando ''READ INTO'' riempie un intero vettore con i valori successivi 
+delle righe ''DATA'', tanti quanti sono gli elementi del vettore, nello 
+stesso ordine in cui sono memorizzati. I valori sono copiati come un unico
+blocco di memoria, per cui è molto più veloce che leggere gli elementi 
+uno a uno. Per questo motivo, il programma deve dichiarare che ogni ''DATA''
+ha lo stesso tipo degli elementi del vettore, con ''OPTION DATA AS''. 
+Utilizzando ''SAFE'', il vettore non verrà toccato se non ci sono 
+abbastanza valori rimasti.
+
+@syntax READ [SAFE|FAST] INTO array[()]
+
+@example OPTION DATA AS BYTE
+@example DIM level(64) AS BYTE
+@example READ INTO level()
+
+@usedInExample data_example_14.bas
+
+@target all
+</usermanual> */
+void read_data_into( Environment * _environment, char * _array, int _safe ) {
+
+    MAKE_LABEL
+
+    char doneReadLabel[MAX_TEMPORARY_STORAGE]; sprintf( doneReadLabel, "%sdone", label );
+
+    _environment->readDataUsed = 1;
+
+    Variable * array = variable_retrieve( _environment, _array );
+
+    if ( array->type != VT_ARRAY ) {
+        CRITICAL_NOT_ARRAY( _array );
+    }
+
+    if ( ! _environment->optionDataType || VT_BITWIDTH( array->arrayType ) != VT_BITWIDTH( _environment->optionDataType ) ) {
+        CRITICAL_READ_INTO_UNTYPED( _array );
+    }
+
+    Variable * dataptr = variable_retrieve( _environment, "DATAPTR" );
+    Variable * address = variable_temporary( _environment, VT_ADDRESS, "(address)" );
+
+#ifdef __UGBC_CPU6502__
+    // The 6502 readers keep an offset in DATAPTRY: bring it into DATAPTR.
+    deploy( read_data_unsafe, src_hw_6502_read_data_unsafe_asm );
+    outline0( "JSR READDATANUMERICRESET" );
+#endif
+
+    if ( _safe ) {
+        Variable * last = variable_temporary( _environment, VT_ADDRESS, "(last)" );
+        Variable * end = variable_temporary( _environment, VT_ADDRESS, "(end)" );
+        Variable * over = variable_temporary( _environment, VT_BYTE, "(over)" );
+        cpu_math_add_16bit_const( _environment, dataptr->realName, array->size, last->realName );
+        cpu_addressof_16bit( _environment, "DATAPTRE", end->realName );
+        cpu_greater_than_16bit( _environment, last->realName, end->realName, over->realName, 0, 0 );
+        cpu_compare_and_branch_8bit_const( _environment, over->realName, 0, doneReadLabel, 0 );
+    }
+
+    cpu_addressof_16bit( _environment, array->realName, address->realName );
+
+    if ( array->size < 256 ) {
+        cpu_mem_move_size( _environment, dataptr->realName, address->realName, array->size );
+    } else {
+        Variable * size = variable_temporary( _environment, VT_WORD, "(size)" );
+        variable_store( _environment, size->name, array->size );
+        cpu_mem_move_16bit( _environment, dataptr->realName, address->realName, size->realName );
+    }
+
+    cpu_math_add_16bit_const( _environment, dataptr->realName, array->size, dataptr->realName );
+
+    cpu_label( _environment, doneReadLabel );
+
+}
+
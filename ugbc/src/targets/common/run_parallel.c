@@ -47,10 +47,16 @@
 @keyword RUN PARALLEL
 
 @english
-This keyword will execute all previously invoked procedures. 
+This keyword will execute all previously invoked procedures. Only 
+the threads that are ready to run are visited: empty slots, ended
+threads and threads sleeping on ''WAIT ... TICKS'' are skipped 
+without any cost.
 
 @italian
-Questa parola chiave eseguirà tutte le procedure invocate in precedenza
+Questa parola chiave eseguirà tutte le procedure invocate in precedenza.
+Vengono considerati solo i thread pronti per l'esecuzione: gli slot 
+vuoti, i thread terminati e quelli sospesi su ''WAIT ... TICKS'' 
+vengono saltati senza alcun costo.
 
 @syntax RUN PARALLEL
 
@@ -66,6 +72,8 @@ void run_parallel( Environment * _environment ) {
 
     _environment->anyProtothread = 1;
     _environment->runParallel = 1;
+
+    cpu_move_16bit( _environment, get_timer( _environment )->realName, "PROTOTHREADNOW" );
     
     cpu_protothread_loop( _environment );
 
@@ -0,0 +1,95 @@
+/*****************************************************************************
+ * ugBASIC - an isomorphic BASIC language compiler for retrocomputers        *
+ *****************************************************************************
+ * Copyright 2021-2024 Marco Spedaletti (asimov@mclink.it)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *----------------------------------------------------------------------------
+ * Concesso in licenza secondo i termini della Licenza Apache, versione 2.0
+ * (la "Licenza"); è proibito usare questo file se non in conformità alla
+ * Licenza. Una copia della Licenza è disponibile all'indirizzo:
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Se non richiesto dalla legislazione vigente o concordato per iscritto,
+ * il software distribuito nei termini della Licenza è distribuito
+ * "COSÌ COM'È", SENZA GARANZIE O CONDIZIONI DI ALCUN TIPO, esplicite o
+ * implicite. Consultare la Licenza per il testo specifico che regola le
+ * autorizzazioni e le limitazioni previste dalla medesima.
+ ****************************************************************************/
+
+/****************************************************************************
+ * INCLUDE SECTION 
+ ****************************************************************************/
+
+#include "../../ugbc.h"
+
+/****************************************************************************
+ * CODE SECTION 
+ ****************************************************************************/
+
+/**
+ * @brief Emit ASM code for <b>SCREEN PLAYFIELD [width], [height]</b>
+ * 
+ * This function defines a virtual playfield, larger than the screen, for
+ * the text modes. It is available only on the hardware that can fetch
+ * each row of the screen from a different address (ANTIC); elsewhere it
+ * is ignored.
+ * 
+ * @param _environment Current calling environment
+ * @param _width Width of the playfield, in bytes
+ * @param _height Height of the playfield, in rows
+ */
+/* <usermanual>
+@keyword SCREEN PLAYFIELD
+
+@english
+This instruction defines a virtual playfield of ''width'' by ''height''
+characters, larger than the screen. Every row of the screen is fetched
+from its own row of the playfield, so moving the visible window with
+''SCROLL'', ''HSCROLL SCREEN'' and ''VSCROLL SCREEN'' does not copy any
+memory: only the addresses of the rows are rewritten, during the vertical
+blank, at the cost of a few hundred cycles per frame. The width must be
+64, 128 or 256, and the whole playfield must fit in 16384 bytes; it is
+placed at the end of the memory, starting from ''TEXTADDRESS''. The
+playfield is used only by the text modes, and it must be filled by
+writing directly to the memory, since the console instructions (like
+''PRINT'') still see a screen of 40 columns.
+
+@italian
+Questa istruzione definisce un campo di gioco virtuale di ''width'' per
+''height'' caratteri, più grande dello schermo. Ogni riga dello schermo
+viene letta da una propria riga del campo di gioco, per cui spostare la
+finestra visibile con ''SCROLL'', ''HSCROLL SCREEN'' e ''VSCROLL SCREEN''
+non copia alcuna memoria: vengono riscritti solo gli indirizzi delle
+righe, durante il vertical blank, al costo di poche centinaia di cicli
+per fotogramma. La larghezza deve essere 64, 128 o 256, e l'intero campo
+di gioco deve stare in 16384 byte; esso viene posto alla fine della
+memoria, a partire da ''TEXTADDRESS''. Il campo di gioco viene usato solo
+dalle modalità testuali, e deve essere riempito scrivendo direttamente in
+memoria, dato che le istruzioni della console (come ''PRINT'') vedono
+ancora uno schermo di 40 colonne.
+
+@syntax SCREEN PLAYFIELD width, height
+
+@example SCREEN PLAYFIELD 128, 64
+
+@target atari, atarixl
+ </usermanual> */
+void screen_playfield( Environment * _environment, int _width, int _height ) {
+
+#if defined(__atari__) || defined(__atarixl__)
+    gtia_screen_playfield( _environment, _width, _height );
+#endif
+
+}
@@ -167,7 +167,7 @@ Variable * sequence_load( Environment * _environment, char * _filename, char * _
     long fileSize = ftell( lookedFileHandle );
     fclose( lookedFileHandle );
 
-    unsigned char* source = stbi_load(lookedFilename, &width, &height, &depth, 0);
+    unsigned char* source = image_cache_load( _environment, lookedFilename, &width, &height, &depth );
 
     if ( !source ) {
         CRITICAL_IMAGE_LOAD_UNKNOWN_FORMAT( _filename );
@@ -208,7 +208,9 @@ Variable * sequence_load( Environment * _environment, char * _filename, char * _
     int base = ( 3*width*height ) - 6;
     for( y=0; y<height; y+=_frame_height ) {
         for( x=0; x<width; x+=_frame_width ) {
+            telemetry_begin( _environment, "image conversion" );
             result[i] = image_converter( _environment, source, width, height, depth, x, y, _frame_width, _frame_height, _mode, _transparent_color, _flags );
+            telemetry_end( _environment );
             bufferSize += result[i]->size;
             i += di;
         }
@@ -335,7 +337,9 @@ Variable * sequence_load( Environment * _environment, char * _filename, char * _
         // the buffer will be considered as "uncompressed" size.
         MSC1Compressor * compressor = msc1_create( 32 );
         final->uncompressedSize = final->size;
+        telemetry_begin( _environment, "msc1 compression" );
         MemoryBlock * output = msc1_compress( compressor, final->valueBuffer, final->uncompressedSize, &final->size );
+        telemetry_end( _environment );
 
         int temporary;
         MemoryBlock * outputCheck = msc1_uncompress( compressor, output, final->size, &temporary );
@@ -75,7 +75,7 @@ lo stesso nome, è possibile indicare un alias (''AS target'').
 </usermanual> */
 Variable * sequence_storage( Environment * _environment, char * _source_name, char * _target_name, int _mode, int _frame_width, int _frame_height, int _flags, int _transparent_color, int _background_color, int _bank_expansion ) {
 
-    file_storage( _environment, _source_name, _target_name );
+    file_storage( _environment, _source_name, _target_name, 0 );
 
     Variable * final = variable_temporary( _environment, VT_SEQUENCE, 0 );
 
@@ -90,7 +90,7 @@ Variable * sequence_storage( Environment * _environment, char * _source_name, ch
     long fileSize = ftell( lookedFileHandle );
     fclose( lookedFileHandle );
 
-    unsigned char* source = stbi_load(lookedFilename, &width, &height, &depth, 0);
+    unsigned char* source = image_cache_load( _environment, lookedFilename, &width, &height, &depth );
 
     if ( !source ) {
         CRITICAL_IMAGE_LOAD_UNKNOWN_FORMAT( _source_name );
@@ -129,7 +129,9 @@ Variable * sequence_storage( Environment * _environment, char * _source_name, ch
     int base = ( 3*width*height ) - 6;
     for( y=0; y<height; y+=_frame_height ) {
         for( x=0; x<width; x+=_frame_width ) {
+            telemetry_begin( _environment, "image conversion" );
             result[i] = image_converter( _environment, source, width, height, depth, x, y, _frame_width, _frame_height, _mode, _transparent_color, _flags );
+            telemetry_end( _environment );
             bufferSize += result[i]->size;
             i += di;
         }
@@ -187,7 +189,9 @@ Variable * sequence_storage( Environment * _environment, char * _source_name, ch
         // the buffer will be considered as "uncompressed" size.
         MSC1Compressor * compressor = msc1_create( 32 );
         final->uncompressedSize = final->size;
+        telemetry_begin( _environment, "msc1 compression" );
         MemoryBlock * output = msc1_compress( compressor, final->valueBuffer, final->uncompressedSize, &final->size );
+        telemetry_end( _environment );
 
         int temporary;
         MemoryBlock * outputCheck = msc1_uncompress( compressor, output, final->size, &temporary );
@@ -216,6 +220,7 @@ Variable * sequence_storage( Environment * _environment, char * _source_name, ch
     }
 
     _environment->currentFileStorage->size = final->size;
+    _environment->currentFileStorage->uncompressedSize = final->uncompressedSize;
     _environment->currentFileStorage->content = final->valueBuffer;
 
     return final;
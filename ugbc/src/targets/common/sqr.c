@@ -33,6 +33,7 @@
  ****************************************************************************/
 
 #include "../../ugbc.h"
+#include <math.h>
 
 /****************************************************************************
  * CODE SECTION 
@@ -40,6 +41,90 @@
 
 extern char DATATYPE_AS_STRING[][16];
 
+/**
+ * @brief Return the square root of a 16 bit value, by a table seeded Newton step
+ * 
+ * The seed is read from a table of 256 bytes, indexed by the most significant
+ * byte of the value (or by the least one, scaled down, for values under 256).
+ * A single Newton step ( x + n / x ) / 2 starting from above never goes
+ * below the root and it is never more than one unit over it, so a final
+ * check of the square gives the exact integer root.
+ * 
+ * @param _environment Current calling environment
+ * @param _value Value to calculate the square root (WORD)
+ * @return Variable* The square root of value (BYTE)
+ */
+static Variable * sqroot_newton( Environment * _environment, Variable * _value ) {
+
+    if ( ! _environment->sqrootTable ) {
+
+        unsigned char table[256];
+        int i;
+        for( i=0; i<256; ++i ) {
+            int seed = (int) round( sqrt( i * 256 + 128 ) );
+            table[i] = ( seed > 255 ) ? 255 : seed;
+        }
+        // Values under 256 divide the seed by 16: 16 gives a seed of 1
+        // for zero, to avoid a division by zero.
+        table[0] = 16;
+
+        _environment->sqrootTable = variable_temporary( _environment, VT_BUFFER, "(table of square roots)" );
+        variable_store_buffer( _environment, _environment->sqrootTable->name, table, 256, 0 );
+
+    }
+
+    MAKE_LABEL
+
+    char seededLabel[MAX_TEMPORARY_STORAGE]; sprintf( seededLabel, "%sseed", label );
+    char doneLabel[MAX_TEMPORARY_STORAGE]; sprintf( doneLabel, "%sdone", label );
+
+    Variable * index = variable_temporary( _environment, VT_BYTE, "(index)" );
+    Variable * seed = variable_temporary( _environment, VT_WORD, "(seed)" );
+    Variable * quotient = variable_temporary( _environment, VT_WORD, "(quotient)" );
+    Variable * remainder = variable_temporary( _environment, VT_WORD, "(remainder)" );
+    Variable * root = variable_temporary( _environment, VT_WORD, "(root)" );
+    Variable * square = variable_temporary( _environment, VT_DWORD, "(square)" );
+    Variable * value32 = variable_cast( _environment, _value->name, VT_DWORD );
+    Variable * greater = variable_temporary( _environment, VT_BYTE, "(check)" );
+    Variable * result = variable_temporary( _environment, VT_BYTE, "(result of SQR)");
+
+#ifdef CPU_BIG_ENDIAN
+    char * high = address_displacement( _environment, _value->realName, "0" );
+    char * low = address_displacement( _environment, _value->realName, "1" );
+    char * seedLow = address_displacement( _environment, seed->realName, "1" );
+    char * rootLow = address_displacement( _environment, root->realName, "1" );
+#else
+    char * high = address_displacement( _environment, _value->realName, "1" );
+    char * low = _value->realName;
+    char * seedLow = seed->realName;
+    char * rootLow = root->realName;
+#endif
+
+    cpu_store_16bit( _environment, seed->realName, 0 );
+    cpu_move_8bit( _environment, high, index->realName );
+    cpu_move_8bit_indirect2_8bit( _environment, _environment->sqrootTable->realName, index->realName, seedLow );
+    cpu_compare_and_branch_8bit_const( _environment, index->realName, 0, seededLabel, 0 );
+    cpu_move_8bit( _environment, low, index->realName );
+    cpu_move_8bit_indirect2_8bit( _environment, _environment->sqrootTable->realName, index->realName, seedLow );
+    cpu_math_div2_const_16bit( _environment, seed->realName, 4, 0 );
+    cpu_label( _environment, seededLabel );
+
+    cpu_math_div_16bit_to_16bit( _environment, _value->realName, seed->realName, quotient->realName, remainder->realName, 0 );
+    cpu_math_add_16bit( _environment, seed->realName, quotient->realName, root->realName );
+    cpu_math_div2_const_16bit( _environment, root->realName, 1, 0 );
+
+    cpu_math_mul_16bit_to_32bit( _environment, root->realName, root->realName, square->realName, 0 );
+    cpu_greater_than_32bit( _environment, square->realName, value32->realName, greater->realName, 0, 0 );
+    cpu_bveq( _environment, greater->realName, doneLabel );
+    cpu_dec_16bit( _environment, root->realName );
+    cpu_label( _environment, doneLabel );
+
+    cpu_move_8bit( _environment, rootLow, result->realName );
+
+    return result;
+
+}
+
 /**
  * @brief Return the square root of a variable
  * 
@@ -52,9 +137,13 @@ extern char DATATYPE_AS_STRING[][16];
 
 @english
 The ''SQR'' function returns a value representing the square root of a number.
+With ''DEFINE MATH FAST'' the (exact) integer root is calculated starting from
+a table, with a single division instead of the bit by bit method.
 
 @italian
 La funzione ''SQR'' restituisce un valore che rappresenta la radice quadrata di un numero.
+Con ''DEFINE MATH FAST'' la radice intera (esatta) viene calcolata partendo da
+una tabella, con una sola divisione invece del metodo bit per bit.
 
 @syntax SQR([expression])
 
@@ -77,10 +166,16 @@ Variable * sqroot( Environment * _environment, char * _value ) {
             // if ( VT_SIGNED( value->type ) ) {
             //     CRITICAL_SQR_UNSUPPORTED( _value, DATATYPE_AS_STRING[value->type] );
             // }
+            if ( _environment->mathMode == MATH_MODE_FAST ) {
+                return sqroot_newton( _environment, variable_cast( _environment, value->name, VT_WORD ) );
+            }
             cpu_sqroot( _environment, value->realName, result->realName );
             break;
         case 8: {
             Variable * value16 = variable_cast( _environment, value->name, VT_WORD );
+            if ( _environment->mathMode == MATH_MODE_FAST ) {
+                return sqroot_newton( _environment, value16 );
+            }
             cpu_sqroot( _environment, value16->realName, result->realName );
             break;
         }
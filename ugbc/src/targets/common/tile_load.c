@@ -152,7 +152,7 @@ Variable * tile_load( Environment * _environment, char * _filename, int _flags,
 
     adiline2("LT:%s:%s", _filename, lookedFilename );
 
-    unsigned char* source = stbi_load(lookedFilename, &width, &height, &depth, 0);
+    unsigned char* source = image_cache_load( _environment, lookedFilename, &width, &height, &depth );
 
     if ( !source ) {
         CRITICAL_TILE_LOAD_UNKNOWN_FORMAT( _filename );
@@ -175,7 +175,9 @@ Variable * tile_load( Environment * _environment, char * _filename, int _flags,
 
     Variable * index = variable_temporary( _environment, VT_TILE, "(tile index)" );
 
+    telemetry_begin( _environment, "image conversion" );
     Variable * realImage = image_converter( _environment, source, 8, 8, depth, 0, 0, 8, 8, BITMAP_MODE_DEFAULT, 0, _flags );
+    telemetry_end( _environment );
 
     stbi_image_free(source);
 
@@ -186,6 +188,7 @@ Variable * tile_load( Environment * _environment, char * _filename, int _flags,
     } else {
         if ( ! _environment->descriptors ) {
             _environment->descriptors = malloc( sizeof( TileDescriptors ) );
+            memset( _environment->descriptors, 0, sizeof( TileDescriptors ) );
             _environment->descriptors->count = 0;
             _environment->descriptors->first = 1;
             _environment->descriptors->firstFree = _environment->descriptors->first;
@@ -200,7 +203,9 @@ Variable * tile_load( Environment * _environment, char * _filename, int _flags,
         tile = tile_allocate( descriptors, realImage->valueBuffer + IMAGE_WIDTH_SIZE + IMAGE_HEIGHT_SIZE );
     } else {
         memcpy( descriptors->data[tile].data, realImage->valueBuffer + IMAGE_WIDTH_SIZE + IMAGE_HEIGHT_SIZE, 8 );
-        descriptors->descriptor[tile] = calculate_tile_descriptor( &descriptors->data[tile] );
+        TileDescriptor * tileDescriptor = calculate_tile_descriptor( &descriptors->data[tile] );
+        tile_descriptors_set( descriptors, tile, tileDescriptor );
+        free( tileDescriptor );
     }
 
     if ( tile == -1 ) {
@@ -153,7 +153,7 @@ Variable * tiles_load( Environment * _environment, char * _filename, int _flags,
 
     adiline2("LTS:%s:%s", _filename, lookedFilename );
 
-    unsigned char* source = stbi_load(lookedFilename, &width, &height, &depth, 0);
+    unsigned char* source = image_cache_load( _environment, lookedFilename, &width, &height, &depth );
 
     if ( !source ) {
         CRITICAL_TILE_LOAD_UNKNOWN_FORMAT( _filename );
@@ -182,6 +182,7 @@ Variable * tiles_load( Environment * _environment, char * _filename, int _flags,
         if ( ! _environment->descriptors ) {
             // printf("On demand allocating...\n");
             _environment->descriptors = malloc( sizeof( TileDescriptors ) );
+            memset( _environment->descriptors, 0, sizeof( TileDescriptors ) );
             _environment->descriptors->count = 0;
             _environment->descriptors->first = 128;
             _environment->descriptors->firstFree = _environment->descriptors->first;
@@ -213,7 +214,9 @@ Variable * tiles_load( Environment * _environment, char * _filename, int _flags,
     for( z=0; z<a; ++z ) {
         for (y=0; y<(height>>3);++y) {
             for (x=0; x<(width>>3);++x) {
+                telemetry_begin( _environment, "image conversion" );
                 Variable * realImage = image_converter( _environment, source, width, height, depth, x*8, y*8, 8, 8, BITMAP_MODE_DEFAULT, 0, _flags );
+                telemetry_end( _environment );
 
                 if ( _index == -1 ) {
                     int tile = tile_allocate( descriptors, realImage->valueBuffer + IMAGE_WIDTH_SIZE + IMAGE_HEIGHT_SIZE );
@@ -230,7 +233,9 @@ Variable * tiles_load( Environment * _environment, char * _filename, int _flags,
 
                 } else {
                     memcpy( descriptors->data[_index].data, realImage->valueBuffer + IMAGE_WIDTH_SIZE + IMAGE_HEIGHT_SIZE, 8 );
-                    descriptors->descriptor[_index] = calculate_tile_descriptor( &descriptors->data[_index] );
+                    TileDescriptor * tileDescriptor = calculate_tile_descriptor( &descriptors->data[_index] );
+                    tile_descriptors_set( descriptors, _index, tileDescriptor );
+                    free( tileDescriptor );
                     ++_index;
                 }
 
@@ -73,7 +73,7 @@ lo stesso nome, è possibile indicare un alias (''AS target'').
 </usermanual> */
 Variable * tileset_storage( Environment * _environment, char * _source_name, char * _target_name, int _mode, int _flags, int _transparent_color, int _background_color, int _bank_expansion ) {
 
-    file_storage( _environment, _source_name, _target_name );
+    file_storage( _environment, _source_name, _target_name, 0 );
 
     Variable * final = variable_temporary( _environment, VT_IMAGES, 0 );
 
@@ -118,7 +118,7 @@ Variable * tileset_storage( Environment * _environment, char * _source_name, cha
     long fileSize = ftell( lookedFileHandle );
     fclose( lookedFileHandle );
 
-    unsigned char* source = stbi_load(lookedFilename, &width, &height, &depth, 0);
+    unsigned char* source = image_cache_load( _environment, lookedFilename, &width, &height, &depth );
     
     if ( !source ) {
         CRITICAL_IMAGE_LOAD_UNKNOWN_FORMAT( tsxImage->source );
@@ -158,7 +158,9 @@ Variable * tileset_storage( Environment * _environment, char * _source_name, cha
     for( z=0; z<a; ++z ) {
         for( y=0; y<height; y+=tileset->tileheight ) {
             for( x=0; x<width; x+=tileset->tilewidth ) {
+                telemetry_begin( _environment, "image conversion" );
                 result[i] = image_converter( _environment, source, width, height, depth, x, y, tileset->tilewidth, tileset->tileheight, _mode, _transparent_color, _flags );
+                telemetry_end( _environment );
                 bufferSize += result[i]->size;
                 i += di;
             }
@@ -218,7 +220,9 @@ Variable * tileset_storage( Environment * _environment, char * _source_name, cha
         // the buffer will be considered as "uncompressed" size.
         MSC1Compressor * compressor = msc1_create( 32 );
         final->uncompressedSize = final->size;
+        telemetry_begin( _environment, "msc1 compression" );
         MemoryBlock * output = msc1_compress( compressor, final->valueBuffer, final->uncompressedSize, &final->size );
+        telemetry_end( _environment );
 
         int temporary;
         MemoryBlock * outputCheck = msc1_uncompress( compressor, output, final->size, &temporary );
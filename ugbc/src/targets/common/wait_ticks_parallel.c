@@ -0,0 +1,125 @@
+/*****************************************************************************
+ * ugBASIC - an isomorphic BASIC language compiler for retrocomputers        *
+ *****************************************************************************
+ * Copyright 2021-2024 Marco Spedaletti (asimov@mclink.it)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *----------------------------------------------------------------------------
+ * Concesso in licenza secondo i termini della Licenza Apache, versione 2.0
+ * (la "Licenza"); è proibito usare questo file se non in conformità alla
+ * Licenza. Una copia della Licenza è disponibile all'indirizzo:
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Se non richiesto dalla legislazione vigente o concordato per iscritto,
+ * il software distribuito nei termini della Licenza è distribuito
+ * "COSÌ COM'È", SENZA GARANZIE O CONDIZIONI DI ALCUN TIPO, esplicite o
+ * implicite. Consultare la Licenza per il testo specifico che regola le
+ * autorizzazioni e le limitazioni previste dalla medesima.
+ ****************************************************************************/
+
+/****************************************************************************
+ * INCLUDE SECTION 
+ ****************************************************************************/
+
+#include "../../ugbc.h"
+
+/****************************************************************************
+ * CODE SECTION 
+ ****************************************************************************/
+/**
+ * @brief Emit code for <strong>WAIT ... TICKS</strong> inside a parallel procedure
+ * 
+ * The thread is put on the sleep queue until the timer reaches the given
+ * number of ticks from the start of the current scheduling round. Until
+ * then the scheduler does not visit it at all.
+ * 
+ * @param _environment Current calling environment
+ * @param _ticks Number of ticks to sleep
+ */
+/* <usermanual>
+@keyword WAIT (PARALLEL PROCEDURE)
+
+@english
+Inside a ''PARALLEL PROCEDURE'', ''WAIT ... TICKS'', ''WAIT ... MILLISECONDS''
+and ''WAIT VBL'' do not busy wait. The thread goes to sleep and it is
+woken up by the scheduler, in ''RUN PARALLEL'', when the timer reaches the 
+requested value: meanwhile, the other threads keep running and a sleeping 
+thread costs nothing. ''WAIT VBL'' sleeps for a single tick. The longest 
+sleep is 32767 ticks.
+
+@italian
+All'interno di una ''PARALLEL PROCEDURE'', ''WAIT ... TICKS'', 
+''WAIT ... MILLISECONDS'' e ''WAIT VBL'' non eseguono un'attesa attiva. 
+Il thread viene sospeso e viene risvegliato dallo scheduler, in 
+''RUN PARALLEL'', quando il timer raggiunge il valore richiesto: nel 
+frattempo, gli altri thread continuano ad essere eseguiti e un thread 
+sospeso non ha alcun costo. ''WAIT VBL'' sospende per un solo tick.
+L'attesa più lunga è di 32767 tick.
+
+@syntax WAIT # [integer] TICKS
+@syntax WAIT [expression] TICKS
+@syntax WAIT # [integer] MILLISECONDS
+@syntax WAIT [expression] MILLISECONDS
+@syntax WAIT VBL
+
+@example PARALLEL PROCEDURE blink
+@example    DO: INC c: WAIT 25 TICKS: LOOP
+@example END PROC
+
+@target all
+</usermanual> */
+void wait_ticks_parallel( Environment * _environment, char * _ticks ) {
+
+    _environment->anyProtothread = 1;
+
+    if ( _environment->protothreadForbid ) {
+        CRITICAL_MULTITASKING_FORBIDDEN();
+    }
+
+    char protothreadLabel[MAX_TEMPORARY_STORAGE]; sprintf(protothreadLabel, "%spt%d", _environment->procedureName, _environment->protothreadStep );
+
+    Variable * ticks = variable_retrieve_or_define( _environment, _ticks, VT_WORD, 0 );
+    if ( ticks->type != VT_WORD ) {
+        ticks = variable_cast( _environment, ticks->name, VT_WORD );
+    }
+
+    cpu_protothread_save( _environment, "PROTOTHREADCT", _environment->protothreadStep );
+    cpu_protothread_sleep( _environment, "PROTOTHREADCT", ticks->realName );
+    cpu_return( _environment );
+    cpu_label( _environment, protothreadLabel );
+    cpu_protothread_set_state( _environment, "PROTOTHREADCT", PROTOTHREAD_STATUS_RUNNING );
+
+    ++_environment->protothreadStep;
+
+}
+
+/**
+ * @brief Emit code for <strong>WAIT ... MILLISECONDS</strong> inside a parallel procedure
+ * 
+ * @param _environment Current calling environment
+ * @param _milliseconds Number of milliseconds to sleep
+ */
+void wait_milliseconds_parallel( Environment * _environment, char * _milliseconds ) {
+
+    Variable * milliseconds = variable_retrieve_or_define( _environment, _milliseconds, VT_WORD, 0 );
+    Variable * thousand = variable_temporary( _environment, VT_WORD, "(1000)" );
+    variable_store( _environment, thousand->name, 1000 );
+
+    Variable * ticks = variable_div( _environment, 
+        variable_mul( _environment, milliseconds->name, get_ticks_per_second( _environment )->name )->name,
+        thousand->name, NULL );
+
+    wait_ticks_parallel( _environment, ticks->name );
+
+}
@@ -96,6 +96,12 @@ void target_initialization( Environment * _environment ) {
     variable_global( _environment, "TIMERRUNNING" );
     variable_import( _environment, "TIMERSTATUS", VT_BYTE, 0 );
     variable_global( _environment, "TIMERSTATUS" );
+    variable_import( _environment, "TIMERACTIVE", VT_BUFFER, 8 );
+    variable_global( _environment, "TIMERACTIVE" );
+    variable_import( _environment, "TIMERACTIVECOUNT", VT_BYTE, 0 );
+    variable_global( _environment, "TIMERACTIVECOUNT" );
+    variable_import( _environment, "TIMERACTIVEDIRTY", VT_BYTE, 0 );
+    variable_global( _environment, "TIMERACTIVEDIRTY" );
     variable_import( _environment, "TIMERCOUNTER", VT_BUFFER, 16 );
     variable_global( _environment, "TIMERCOUNTER" );
     variable_import( _environment, "TIMERINIT", VT_BUFFER, 16 );
@@ -51,6 +51,10 @@
 </usermanual> */
 Variable * csprite_init( Environment * _environment, char * _image, char *_sprite, int _flags ) {
 
+    if ( _environment->spriteConfig.multiplex ) {
+        CRITICAL_SPRITE_MULTIPLEX_COMPOSITE();
+    }
+
     Variable * index;
     Variable * startIndex = variable_temporary( _environment, VT_SPRITE, "(sprite index)" );
     Variable * image = variable_retrieve( _environment, _image );
@@ -58,12 +58,14 @@ static void variable_cleanup_entry( Environment * _environment, Variable * _firs
                     break;
                 case VT_WORD:
                 case VT_SWORD:
+                case VT_FIXED:
                 case VT_POSITION:
                 case VT_ADDRESS:
                     outline1("%s: defs 2", variable->realName);
                     break;
                 case VT_DWORD:
                 case VT_SDWORD:
+                case VT_DFIXED:
                     outline1("%s: defs 4", variable->realName);
                     break;
                 case VT_FLOAT:
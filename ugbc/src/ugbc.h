@@ -160,6 +160,9 @@ typedef struct _FileStorage {
     /** Size of the file */
     int size;
 
+    /** Size of the file once uncompressed (0 if it is not compressed) */
+    int uncompressedSize;
+
     /** Variable (eventually) linked for automatic loading */
     struct _Variable * variable;
 
@@ -369,7 +372,13 @@ typedef enum _VariableType {
     VT_TILEMAP = 27,
 
     /** BIT */
-    VT_BIT = 28
+    VT_BIT = 28,
+
+    /** FIXED (fixed point, 8.8 signed) */
+    VT_FIXED = 29,
+
+    /** DFIXED (fixed point, 16.16 signed) */
+    VT_DFIXED = 30
 
 } VariableType;
 
@@ -385,11 +394,13 @@ typedef struct _Resource {
 
 #define MAX_ARRAY_DIMENSIONS            256
 #define MAX_PARAMETERS                  256
+#define MAX_CONCATENATION               16
 #define MAX_PALETTE                     256
 #define MAX_TILESETS                    256
 #define MAX_NESTED_ARRAYS               16
 #define MAX_PROCEDURES                  4096
 #define MAX_RESIDENT_SHAREDS            128
+#define MAX_EVERY_HANDLERS              32
 #define PROTOTHREAD_DEFAULT_COUNT       16
 #define DSTRING_DEFAULT_COUNT           255
 #define DSTRING_DEFAULT_SPACE           1024
@@ -415,7 +426,17 @@ typedef struct _Resource {
 #define VT_BITWIDTH( t ) \
         ( VT_BW_1BIT( t, VT_BIT ) + VT_BW_8BIT( t, VT_CHAR ) + VT_BW_8BIT( t, VT_BYTE ) + VT_BW_8BIT( t, VT_SBYTE ) + VT_BW_8BIT( t, VT_COLOR ) + VT_BW_8BIT( t, VT_THREAD ) + \
         VT_BW_16BIT( t, VT_WORD ) + VT_BW_16BIT( t, VT_SWORD ) + VT_BW_16BIT( t, VT_ADDRESS ) + VT_BW_16BIT( t, VT_POSITION ) + \
-        VT_BW_32BIT( t, VT_DWORD ) + VT_BW_32BIT( t, VT_SDWORD ) )
+        VT_BW_16BIT( t, VT_FIXED ) + \
+        VT_BW_32BIT( t, VT_DWORD ) + VT_BW_32BIT( t, VT_SDWORD ) + VT_BW_32BIT( t, VT_DFIXED ) )
+
+#define VT_FIXED_TYPE( t ) \
+        ( ( (t) == VT_FIXED ) || ( (t) == VT_DFIXED ) )
+
+#define VT_FIXED_SHIFT( t ) \
+        ( ( (t) == VT_DFIXED ) ? 16 : 8 )
+
+#define VT_MAX_FIXED_TYPE( a, b ) \
+        ( ( ( VT_BITWIDTH( a ) == 32 ) || ( VT_BITWIDTH( b ) == 32 ) ) ? ( VT_DFIXED ) : ( VT_FIXED ) )
 
 #define VT_POW2_2( t, v )             ( ( (t) == (v) ) ? 2 : 0 )
 #define VT_POW2_3( t, v )             ( ( (t) == (v) ) ? 3 : 0 )
@@ -423,13 +444,14 @@ typedef struct _Resource {
 
 #define VT_MAX_BITWIDTH_TYPE( a, b ) \
         ( ( ( a == VT_FLOAT ) || ( b == VT_FLOAT ) ) ? ( VT_FLOAT ) : \
+            ( VT_FIXED_TYPE( a ) || VT_FIXED_TYPE( b ) ) ? ( VT_MAX_FIXED_TYPE( a, b ) ) : \
             ( VT_BITWIDTH( a ) > VT_BITWIDTH( b ) ) ? ( a ) : ( b ) )
 
 #define VT_MAX_FLOAT_BITWIDTH_TYPE( a, b ) \
         ( ( VT_FLOAT_BITWIDTH( a ) > VT_FLOAT_BITWIDTH( b ) ) ? ( a ) : ( b ) )
 
 #define VT_SIGNED( t ) \
-        ( ( (t) == VT_SBYTE ) || ( (t) == VT_SWORD ) || ( (t) == VT_SDWORD ) || ( (t) == VT_POSITION ) || ( (t) == VT_FLOAT ) )
+        ( ( (t) == VT_SBYTE ) || ( (t) == VT_SWORD ) || ( (t) == VT_SDWORD ) || ( (t) == VT_POSITION ) || ( (t) == VT_FLOAT ) || VT_FIXED_TYPE( t ) )
 
 #define VT_UNSIGN( t ) \
             ( VT_SIGNED( t ) ? \
@@ -438,7 +460,9 @@ typedef struct _Resource {
                     ( ( (t) == (VT_SWORD) ) ? VT_WORD : 0 ) + \
                     ( ( (t) == (VT_SDWORD) ) ? VT_DWORD : 0 ) + \
                     ( ( (t) == (VT_POSITION) ) ? VT_WORD : 0 ) + \
-                    ( ( (t) == (VT_FLOAT) ) ? VT_FLOAT : 0 ) \
+                    ( ( (t) == (VT_FLOAT) ) ? VT_FLOAT : 0 ) + \
+                    ( ( (t) == (VT_FIXED) ) ? VT_FIXED : 0 ) + \
+                    ( ( (t) == (VT_DFIXED) ) ? VT_DFIXED : 0 ) \
                 ) \
             : t )
 
@@ -541,6 +565,28 @@ typedef struct _MemoryArea {
 
 } MemoryArea;
 
+/**
+ * @brief Element placed by the memory map packer
+ */
+typedef struct _MemoryMapItem {
+
+    /** Label of the element */
+    char * name;
+
+    /** Address where the element has been placed */
+    int address;
+
+    /** Size of the element, in bytes */
+    int size;
+
+    /** Memory area where the element has been placed (NULL = main memory) */
+    MemoryArea * area;
+
+    /** Link to the next element (NULL if this is the last one) */
+    struct _MemoryMapItem * next;
+
+} MemoryMapItem;
+
 #define MEMORY_AREA_DEFINE( _type, _start, _end ) \
     { \
         MemoryArea * memoryArea = malloc( sizeof( MemoryArea ) ); \
@@ -609,6 +655,80 @@ typedef struct _Constant {
 
 } Constant;
 
+/**
+ * @brief Structure of a variable that can be promoted to a constant
+ * 
+ * Variables that are assigned only once, before any control flow, and
+ * that are only read afterwards, are found by a scan of the source made 
+ * before the parsing (see constant_propagation_scan()).
+ */
+typedef struct _ConstantCandidate {
+
+    /** Name of the variable (in the program) */
+    char * name;
+
+    /** Link to the next candidate (NULL if this is the last one) */
+    struct _ConstantCandidate * next;
+
+} ConstantCandidate;
+
+/**
+ * @brief Structure of a single phase of the compile time report
+ * 
+ * Phases are organized as a tree: a phase started while another one is 
+ * running becomes its child. A phase entered more than once (i.e. the
+ * conversion of each image) is accumulated on the same node, and the
+ * number of times is kept (see telemetry_begin()).
+ */
+typedef struct _TelemetryPhase {
+
+    /** Name of the phase */
+    char * name;
+
+    /** Number of times the phase has been entered */
+    int count;
+
+    /** Wall clock, CPU and external commands' CPU time (in seconds) */
+    double wall;
+    double cpu;
+    double childrenCpu;
+
+    /** Lines emitted and removed by a peephole pass (-1 for other phases) */
+    int linesEmitted;
+    int linesRemoved;
+
+    /** Times taken when the phase has been (last) entered */
+    double wallStart;
+    double cpuStart;
+    double childrenCpuStart;
+
+    /** Tree of phases */
+    struct _TelemetryPhase * parent;
+    struct _TelemetryPhase * firstChild;
+    struct _TelemetryPhase * lastChild;
+    struct _TelemetryPhase * next;
+
+} TelemetryPhase;
+
+/**
+ * @brief Structure of the compile time report (--time-report)
+ */
+typedef struct _Telemetry {
+
+    /** Filename of the JSON report (NULL for standard error) */
+    char * fileName;
+
+    /** The whole compilation */
+    TelemetryPhase * root;
+
+    /** Phase currently running */
+    TelemetryPhase * current;
+
+    /** Lines of the assembly file when the current peephole pass started */
+    int passLinesBefore;
+
+} Telemetry;
+
 /**
  * @brief Structure of a single label
  */
@@ -646,6 +766,14 @@ typedef struct _FloatType {
 
 } FloatType;
 
+typedef enum _MathMode {
+
+    MATH_MODE_AUTO = 0,         // tables for integer and fixed point arguments
+    MATH_MODE_FAST = 1,         // tables and approximations everywhere
+    MATH_MODE_PRECISE = 2       // floating point / exact routines everywhere
+
+} MathMode;
+
 typedef struct _OffsettingVariable {
 
     int sequence;
@@ -802,6 +930,30 @@ typedef struct _Variable {
      */
     MemoryArea * memoryArea;
 
+    /** 
+     * Bytes requested to be placed in a memory area (0 = none). The actual
+     * memory area and address are chosen by memory_map_pack().
+     */
+    int memoryAreaRequested;
+
+    /**
+     * Strings to be concatenated into this (temporary) DSTRING. The code
+     * is emitted only when the result is used, so that a whole chain of
+     * "+" allocates the result once (see expression_add()).
+     */
+    struct _Variable * concatenation[MAX_CONCATENATION];
+
+    /**
+     * Number of strings pending in concatenation (0 = none).
+     */
+    int concatenationCount;
+
+    /**
+     * This DSTRING temporary holds a concatenation that nobody else refers
+     * to: an assignment can take its descriptor instead of copying it.
+     */
+    int concatenationOwned;
+
     /**
      * Number of dimensions of this array
      */
@@ -908,6 +1060,29 @@ typedef struct _Variable {
 
 } Variable;
 
+/**
+ * @brief Structure of a value number (an operation already emitted
+ * inside the current statement)
+ */
+typedef struct _ValueNumber {
+
+    /** Operator of the operation */
+    char op;
+
+    /** Value number of the left operand */
+    char * left;
+
+    /** Value number of the right operand */
+    char * right;
+
+    /** Name of the variable that holds the result */
+    char * result;
+
+    /** Link to the next value number (NULL if this is the last one) */
+    struct _ValueNumber * next;
+
+} ValueNumber;
+
 typedef struct _Procedure {
 
     /** Name of the procedure (in the program) */
@@ -1430,7 +1605,10 @@ typedef struct _Deployed {
     int textHScrollLine;
     int textHScrollScreen;
     int scroll;
+    int scrollDouble;
+    int playfield;
     int raster;
+    int spriteMultiplexer;
     int putimage;
     int getimage;
     int puttilemap;
@@ -1530,12 +1708,16 @@ typedef struct _Deployed {
     int paint;
     int play_string;
     int put_tilemap;
+    int put_tilemap_delta;
 
     int timer;
 
     int dcommon;
     int dload;
     int dsave;
+    int fastload;
+    int dstream;
+    int msc1stream;
 
 } Deployed;
 
@@ -1552,6 +1734,16 @@ typedef struct _ProtothreadConfig {
 
 } ProtothreadConfig;
 
+typedef struct _SpriteConfig {
+
+    int multiplex;
+    int count;
+
+    // RASTER AT has been used: the VIC-II multiplexer needs the raster interrupt.
+    int rasterAt;
+
+} SpriteConfig;
+
 typedef struct _InputConfig {
 
     char separator;
@@ -1624,11 +1816,20 @@ typedef struct _TileDescriptors {
     int                 lastFree;
     int                 count;
 
-    TileDescriptor *    descriptor[256];
     TileData            data[256];
 
+    // Descriptors are kept as a structure of arrays (one row per feature,
+    // one column per tile) so that the nearest tile search can compare the
+    // same feature of many tiles at once. Unused tiles have used[i] == 0
+    // and a whiteArea far from any real one (TILE_DESCRIPTOR_UNUSED).
+    char                used[256];
+    short               whiteArea[256];
+    short               edges[16][256];
+
 } TileDescriptors;
 
+#define TILE_DESCRIPTOR_UNUSED      0x4000
+
 typedef int (*RgbConverterFunction)(int, int, int);
 
 extern int yycolno;
@@ -1672,6 +1873,76 @@ typedef struct _DataSegment {
 
 } DataSegment;
 
+/**
+ * @brief How a single line of generated assembly moves the program counter
+ * 
+ * Used by the per-CPU <code>cpu_code_line()</code> to let the common code
+ * walk the assembly emitted for a routine (see every_context_cleanup()).
+ */
+typedef enum _CodeLineFlow {
+
+    // The line does not change the flow: go on with the next one.
+    CLF_NONE = 0,
+
+    // The line calls the target, and then goes on with the next one.
+    CLF_CALL = 1,
+
+    // The line could jump to the target, or go on with the next one.
+    CLF_BRANCH = 2,
+
+    // The line jumps to the target, and never goes on.
+    CLF_JUMP = 3,
+
+    // The line leaves the routine.
+    CLF_RETURN = 4,
+
+    // The line goes somewhere that cannot be followed.
+    CLF_UNKNOWN = 5
+
+} CodeLineFlow;
+
+#define MAX_TRACKED_REGISTERS       8
+#define MAX_TRACKED_OPERAND         64
+
+/**
+ * @brief What the CPU registers are known to hold, while emitting
+ * 
+ * Each generated line is passed to the per-CPU 
+ * <code>cpu_register_track()</code> (see register_tracker_update()), that
+ * keeps, for every register, the constant or the memory operand it holds 
+ * (<code>content</code>) and the memory operand it has been stored to 
+ * (<code>alias</code>). An empty string means "unknown". The meaning of 
+ * each slot depends on the CPU (i.e. A, X and Y on the 6502).
+ */
+typedef struct _RegisterTracker {
+
+    // Constant ("#5") or memory operand ("_x") held by each register.
+    char content[MAX_TRACKED_REGISTERS][MAX_TRACKED_OPERAND];
+
+    // Memory operand where each register has been stored.
+    char alias[MAX_TRACKED_REGISTERS][MAX_TRACKED_OPERAND];
+
+    // Register reflected by the flags (-1 if unknown).
+    int flags;
+
+    // Output buffer and generation the tracker refers to.
+    int buffer;
+    int generation;
+
+    // Offset of the first line not yet tracked.
+    int offset;
+
+    // Start and end of the last two instructions tracked (-1 if none).
+    int lastStart;
+    int lastEnd;
+    int previousStart;
+    int previousEnd;
+
+    // Number of lines to leave untracked (i.e. after a "*+n" branch).
+    int blind;
+
+} RegisterTracker;
+
 /**
  * @brief Structure of compilation environment
  * 
@@ -1721,6 +1992,16 @@ typedef struct _Environment {
      */
     char * profileFileName;
 
+    /**
+     * Compile time report (NULL if not requested with --time-report)
+     */
+    Telemetry * telemetry;
+
+    /**
+     * Filename of the memory map report (*.map) 
+     */
+    char * memoryMapFileName;
+
     /**
      * Filename of executer
      */
@@ -1801,6 +2082,41 @@ typedef struct _Environment {
      */
     FloatType floatType;
 
+    /**
+     * Selection between table driven and precise math routines
+     * (DEFINE MATH FAST / PRECISE).
+     */
+    MathMode mathMode;
+
+    /**
+     * Quarter-wave table of sines used by the table driven SIN / COS / TAN
+     * (created on first use).
+     */
+    Variable * fixedSinTable;
+
+    /**
+     * Table of seeds used by the Newton square root
+     * (created on first use).
+     */
+    Variable * sqrootTable;
+
+    /**
+     * Operations emitted inside the current statement, used to
+     * reuse common subexpressions.
+     */
+    ValueNumber * valueNumbers;
+
+    /**
+     * If not zero, retrieving a variable does not emit the concatenation
+     * pending on it (used while the concatenation is still being built).
+     */
+    int concatenationHold;
+
+    /**
+     * Content of the CPU registers, as tracked on the generated code.
+     */
+    RegisterTracker registerTracker;
+
     /**
      * 
      */
@@ -1816,6 +2132,11 @@ typedef struct _Environment {
      */
     ProtothreadConfig protothreadConfig;
 
+    /**
+     * 
+     */
+    SpriteConfig spriteConfig;
+
     /**
      * 
      */
@@ -1851,6 +2172,11 @@ typedef struct _Environment {
      */
     int optionReadSafe;
 
+    /*
+     * Type of every DATA item (OPTION DATA AS), 0 if each item is tagged.
+     */
+    VariableType optionDataType;
+
     Blit blit;
 
     /**
@@ -1968,6 +2294,11 @@ typedef struct _Environment {
      */
     Constant * constants;
 
+    /**
+     * List of variables that can be promoted to constants.
+     */
+    ConstantCandidate * constantCandidates;
+
     /**
      * List of variables defined in the program.
      */
@@ -2044,6 +2375,13 @@ typedef struct _Environment {
      */
     MemoryArea * memoryAreas;
 
+    /**
+     * Elements placed into memory areas by the packer, and a flag
+     * to remember that variables have been already packed.
+     */
+    MemoryMapItem * memoryMapItems;
+    int memoryMapPacked;
+
     /**
      * Current graphical mode
      */
@@ -2194,6 +2532,16 @@ typedef struct _Environment {
      */
     int protothreadForbid;
 
+    /**
+     * Labels called by the timer manager (EVERY ... GOSUB / CALL)
+     */
+    char * everyHandlers[MAX_EVERY_HANDLERS];
+
+    /**
+     * Number of labels called by the timer manager (-1 if too many)
+     */
+    int everyHandlersCount;
+
     /**
      * 
      */
@@ -2277,6 +2625,12 @@ typedef struct _Environment {
      */
     TileDescriptors * tilesets[MAX_TILESETS];
 
+    /**
+     * Frames drawn by the last PUT TILEMAP on each cell of the screen
+     * (created by the first PUT TILEMAP ... DELTA).
+     */
+    Variable * tilemapShadow;
+
     /**
      * Debug during LOAD IMAGE.
      */
@@ -2307,11 +2661,27 @@ typedef struct _Environment {
      */
     int sandbox;
 
+    /**
+     * Is the promotion of variables assigned once to constants disabled?
+     */
+    int constantPropagationDisabled;
+
     /**
      * Is double buffering enabled?
      */
     int doubleBufferEnabled;
 
+    /**
+     * Is the scroll of the text screen made on two buffers (DEFINE SCROLL DOUBLE BUFFER)?
+     */
+    int scrollDoubleBuffer;
+
+    /**
+     * Size of the virtual playfield (SCREEN PLAYFIELD), if any.
+     */
+    int playfieldWidth;
+    int playfieldHeight;
+
     /*
      * Gamma correction to be used.
      */
@@ -2404,9 +2774,11 @@ typedef struct _Environment {
     /*
      * Used for deferred writing of assembly file.
      */
-    char *deferredEmbedded[MAX_TEMPORARY_STORAGE];
+    unsigned char *deferredEmbedded[MAX_TEMPORARY_STORAGE];
 
-    int deferredEmbeddedSize[MAX_TEMPORARY_STORAGE];
+    unsigned int *deferredEmbeddedLines[MAX_TEMPORARY_STORAGE];
+
+    unsigned int deferredEmbeddedLinesCount[MAX_TEMPORARY_STORAGE];
 
     char * threadIdentifier[MAX_TEMPORARY_STORAGE];
 
@@ -2455,6 +2827,11 @@ typedef struct _Environment {
      */
     int paintBucketSize;
 
+    /**
+     * Is DLOAD made by the fast loader (DEFINE DLOAD FAST)?
+     */
+    int dloadFast;
+
     /* --------------------------------------------------------------------- */
     /* OUTPUT PARAMETERS                                                     */
     /* --------------------------------------------------------------------- */
@@ -2763,6 +3140,17 @@ typedef struct _Environment {
 #define CRITICAL_IMAGES_LOAD_IMAGE_BUFFER_TOO_BIG() CRITICAL("E260 - image too big from buffer" );
 #define CRITICAL_PROCEDURE_DUPLICATE_PARAMETER(p,v) CRITICAL3("E261 - duplicate parameter on procedure", p, v );
 #define CRITICAL_CANNOT_KILL_NOT_ARRAY_THREADS(v) CRITICAL2("E262 - cannot KILL elements of something that is not an array of threads", p, v );
+#define CRITICAL_INVALID_SPRITE_MULTIPLEX_COUNT(v) CRITICAL2i("E263 - invalid number of multiplexed sprites (must be between 1 and 32)", v );
+#define CRITICAL_SPRITE_MULTIPLEX_UNSUPPORTED() CRITICAL("E264 - sprite multiplexer is not supported on this target" );
+#define CRITICAL_SPRITE_MULTIPLEX_COMPOSITE() CRITICAL("E265 - composite sprites (CSPRITE) cannot be used with sprite multiplexer" );
+#define CRITICAL_SPRITE_MULTIPLEX_RASTER() CRITICAL("E273 - RASTER AT cannot be used with sprite multiplexer" );
+#define CRITICAL_INVALID_PLAYFIELD_WIDTH(v) CRITICAL2i("E266 - invalid playfield width (must be 64, 128 or 256)", v );
+#define CRITICAL_INVALID_PLAYFIELD_HEIGHT(v) CRITICAL2i("E267 - invalid playfield height (must cover the screen and fit in 16384 bytes)", v );
+#define CRITICAL_DATA_NOT_HOMOGENEOUS( t1, t2 ) CRITICAL3("E268 - DATA value does not match the type given with OPTION DATA AS", t1, t2 );
+#define CRITICAL_OPTION_DATA_TOO_LATE( ) CRITICAL("E269 - OPTION DATA AS must be given before any DATA or READ" );
+#define CRITICAL_OPTION_DATA_TYPE_NOT_SUPPORTED( t ) CRITICAL2("E270 - OPTION DATA AS supports only integer types", t );
+#define CRITICAL_READ_INTO_UNTYPED( v ) CRITICAL2("E271 - READ INTO needs OPTION DATA AS with the same size of the elements of the array", v );
+#define CRITICAL_NOT_BIT_ARRAY( v ) CRITICAL2("E272 - BIT COUNT can be used only on arrays of BIT", v );
 
 #define WARNING( s ) if ( ((struct _Environment *)_environment)->warningsEnabled) { fprintf(stderr, "WARNING during compilation of %s:\n\t%s at %d\n", ((struct _Environment *)_environment)->sourceFileName, s, ((struct _Environment *)_environment)->yylineno ); }
 #define WARNING2( s, v ) if ( ((struct _Environment *)_environment)->warningsEnabled) { fprintf(stderr, "WARNING during compilation of %s:\n\t%s (%s) at %d\n", ((struct _Environment *)_environment)->sourceFileName, s, v, _environment->yylineno ); }
@@ -2778,6 +3166,11 @@ typedef struct _Environment {
 #define WARNING_DLOAD_IGNORED_OFFSET( f ) WARNING2("W008 - offset for DLOAD is ignored", f );
 
 int assemblyLineIsAComment( char * _buffer );
+int assemblyLineHasToken( char * _buffer, char * _token );
+
+void register_tracker_reset( RegisterTracker * _tracker );
+void register_tracker_forget( RegisterTracker * _tracker, char * _memory );
+void register_tracker_update( Environment * _environment );
 
 int buffered_fputs(const char * _string, FILE * _stream);
 void buffered_fprintf(FILE * _stream, const char * _format, ...);
@@ -2786,6 +3179,10 @@ void buffered_push_output( );
 void buffered_output( FILE * _stream );
 void buffered_prepend_output( );
 void buffered_pop_output( );
+char * buffered_get_output( int * _size );
+void buffered_replace_output( int _start, int _end, char * _text, int _size );
+
+extern int bufferOutputGeneration;
 
 #define outline0n(n,s,r)     \
     { \
@@ -2801,6 +3198,7 @@ void buffered_pop_output( );
             if ( ! ((Environment *)_environment)->emptyProcedure ) { \
                 ((Environment *)_environment)->producedAssemblyLines += assemblyLineIsAComment( s ) ? 0 : 1; \
             } \
+            register_tracker_update( ((Environment *)_environment) ); \
         } \
     }
 
@@ -2818,6 +3216,7 @@ void buffered_pop_output( );
             if ( ! ((Environment *)_environment)->emptyProcedure ) { \
                 ((Environment *)_environment)->producedAssemblyLines += assemblyLineIsAComment( s ) ? 0 : 1; \
             } \
+            register_tracker_update( ((Environment *)_environment) ); \
         } \
     }
 
@@ -2835,6 +3234,7 @@ void buffered_pop_output( );
             if ( ! ((Environment *)_environment)->emptyProcedure ) { \
                 ((Environment *)_environment)->producedAssemblyLines += assemblyLineIsAComment( s ) ? 0 : 1; \
             } \
+            register_tracker_update( ((Environment *)_environment) ); \
         } \
     }
 
@@ -2852,6 +3252,7 @@ void buffered_pop_output( );
             if ( ! ((Environment *)_environment)->emptyProcedure ) { \
                 ((Environment *)_environment)->producedAssemblyLines += assemblyLineIsAComment( s ) ? 0 : 1; \
             } \
+            register_tracker_update( ((Environment *)_environment) ); \
         } \
     }
 
@@ -2869,6 +3270,7 @@ void buffered_pop_output( );
             if ( ! ((Environment *)_environment)->emptyProcedure ) { \
                 ((Environment *)_environment)->producedAssemblyLines += assemblyLineIsAComment( s ) ? 0 : 1; \
             } \
+            register_tracker_update( ((Environment *)_environment) ); \
         } \
     }
 
@@ -2886,6 +3288,7 @@ void buffered_pop_output( );
             if ( ! ((Environment *)_environment)->emptyProcedure ) { \
                 ((Environment *)_environment)->producedAssemblyLines += assemblyLineIsAComment( s ) ? 0 : 1; \
             } \
+            register_tracker_update( ((Environment *)_environment) ); \
         } \
     }
 
@@ -2970,48 +3373,14 @@ void buffered_pop_output( );
 int embedparse (void *);
 int embed_scan_string (const char *);
 
+#define EMBEDDED_LINE_CODE              0
+#define EMBEDDED_LINE_COMMENT           1
+#define EMBEDDED_LINE_DIRECTIVE         2
+
+void embedded_deploy( Environment * _environment, unsigned char * _module, unsigned int * _lines, unsigned int _count );
+
 #define outembedded0(e)     \
-     { \
-        char * parsed = malloc( (8*e##_len) + 1 ); \
-        memset( parsed, 0, (8*e##_len) + 1 ); \
-        char * tmp = malloc( e##_len + 1 ); \
-        memset( tmp, 0, e##_len + 1 ); \
-        memcpy( tmp, e, e##_len ); \
-        char * line = strtok( tmp, "\x0a" ); \
-        while( line ) { \
-            _environment->embedResult.line = line; \
-            _environment->embedResult.conditional = 0; \
-            _environment->embedResult.lineCount = 0; \
-            embed_scan_string( line ); \
-            embedparse(_environment); \
-            if ( ! _environment->embedResult.conditional ) { \
-                int i; \
-                for( i=0; i<_environment->embedResult.current; ++i ) { \
-                    if ( _environment->embedResult.excluded[i] ) \
-                        break; \
-                } \
-                if ( i>= _environment->embedResult.current ) { \
-                    if ( _environment->embedResult.lineCount ) { \
-                        int j=0; \
-                        for( j=0; j<_environment->embedResult.lineCount; ++j ) { \
-                            strcat( parsed, _environment->embedResult.lines[j] ); \
-                            strcat( parsed, "\x0a" ); \
-                            ((Environment *)_environment)->producedAssemblyLines += assemblyLineIsAComment( _environment->embedResult.lines[j] ) ? 0 : 1; \
-                        } \
-                    } else { \
-                        strcat( parsed, line ); \
-                        strcat( parsed, "\x0a" ); \
-                        ((Environment *)_environment)->producedAssemblyLines += assemblyLineIsAComment( line ) ? 0 : 1; \
-                    } \
-                } \
-            } \
-            line = strtok( NULL, "\x0a" ); \
-        } \
-        free( tmp ); \
-        buffered_fwrite( parsed, strlen( parsed )-1, 1, ((Environment *)_environment)->asmFile ); \
-        free( parsed ); \
-        buffered_fputs( "\n", ((Environment *)_environment)->asmFile ); \
-    }
+    embedded_deploy( _environment, e, e##_lines, e##_lines_len );
 
 #define outembeddeddef0(e) \
     { \
@@ -3023,12 +3392,9 @@ int embed_scan_string (const char *);
             } \
         } \
         \
-        char * tmp = malloc( e##_len + 1 ); \
-        memset( tmp, 0, e##_len + 1 ); \
-        memcpy( tmp, e, e##_len ); \
-        \
-        _environment->deferredEmbedded[deferredIndex] = tmp; \
-        _environment->deferredEmbeddedSize[deferredIndex] = e##_len; \
+        _environment->deferredEmbedded[deferredIndex] = e; \
+        _environment->deferredEmbeddedLines[deferredIndex] = e##_lines; \
+        _environment->deferredEmbeddedLinesCount[deferredIndex] = e##_lines_len; \
         \
     }
 
@@ -3135,12 +3501,21 @@ int embed_scan_string (const char *);
 #define cfg4(s,a,b,c,d)         cfgline4n(0, s, a, b, c, d, 0)
 #define cfg5(s,a,b,c,d,e)       cfgline5n(0, s, a, b, c, d, e, 0)
 
+// When profiling, runtime modules are marked so that their cycles can be
+// given back to the statements that called them (see profile_report()).
+#define deploy_marker(s) \
+        if ( _environment->profileFileName ) { \
+            outline0("; M:" s ); \
+        }
+
 #define deploy(s,e)  \
         if ( ! _environment->deployed.s ) { \
             int ignoreEmptyProcedure = _environment->emptyProcedure; \
             _environment->emptyProcedure = 0; \
             cpu_jump( _environment, #s "_after" ); \
+            deploy_marker( #s ); \
             outembedded0(e); \
+            deploy_marker( "" ); \
             cpu_label( _environment, #s "_after" ); \
             _environment->emptyProcedure = ignoreEmptyProcedure; \
             _environment->deployed.s = 1; \
@@ -3172,7 +3547,9 @@ int embed_scan_string (const char *);
             int ignoreEmptyProcedure = _environment->emptyProcedure; \
             _environment->emptyProcedure = 0; \
             cpu_jump( _environment, #s "_after" ); \
+            deploy_marker( #s ); \
             outembedded0(e); \
+            deploy_marker( "" ); \
             v(_environment);\
             cpu_label( _environment, #s "_after" ); \
             _environment->emptyProcedure = ignoreEmptyProcedure; \
@@ -3191,7 +3568,9 @@ int embed_scan_string (const char *);
             int ignoreEmptyProcedure = _environment->emptyProcedure; \
             _environment->emptyProcedure = 0; \
             cpu_jump( _environment, #s "_after" ); \
+            deploy_marker( #s ); \
             outembedded0(e); \
+            deploy_marker( "" ); \
             cpu_label( _environment, #s "_after" ); \
             _environment->emptyProcedure = ignoreEmptyProcedure; \
             _environment->deployed.embedded.s = 1; \
@@ -3210,9 +3589,11 @@ int embed_scan_string (const char *);
             _environment->protothread = 0; \
             _environment->emptyProcedure = 0; \
             cpu_jump( _environment, #s "_after" ); \
+            deploy_marker( #s ); \
             cpu_label( _environment, "lib_" #s ); \
 
 #define deploy_end(s)  \
+            deploy_marker( "" ); \
             cpu_label( _environment, #s "_after" ); \
             _environment->protothread = ignoreProtothread; \
             _environment->emptyProcedure = ignoreEmptyProcedure; \
@@ -3265,6 +3646,7 @@ int embed_scan_string (const char *);
 #define PROTOTHREAD_STATUS_YIELDED		2
 #define PROTOTHREAD_STATUS_EXITED		3
 #define PROTOTHREAD_STATUS_ENDED		4
+#define PROTOTHREAD_STATUS_SLEEPING		5
 
 #define FLAG_FLIP_X         1
 #define FLAG_FLIP_Y         2
@@ -3277,6 +3659,7 @@ int embed_scan_string (const char *);
 #define FLAG_EXACT          128
 #define FLAG_COMPRESSED     256
 #define FLAG_WITH_PALETTE   512
+#define FLAG_DELTA          1024
 
 #define IMF_INSTRUMENT_EXPLOSION        			0x00
 #define IMF_INSTRUMENT_ACOUSTIC_GRAND_PIANO			0x01
@@ -3691,6 +4074,15 @@ void target_linkage( Environment *_environment );
 void target_finalize( Environment * _environment );
 void target_cleanup( Environment *_environment );
 void end_build( Environment * _environment );
+void profile_report( Environment * _environment );
+void telemetry_create( Environment * _environment, char * _fileName );
+void telemetry_begin( Environment * _environment, char * _name );
+void telemetry_begin_command( Environment * _environment, char * _commandline );
+void telemetry_begin_pass( Environment * _environment, int _pass, PeepHoleOptimizationKind _kind );
+void telemetry_begin_resource( Environment * _environment, char * _kind, char * _filename );
+void telemetry_end( Environment * _environment );
+void telemetry_end_pass( Environment * _environment );
+void telemetry_report( Environment * _environment );
 void bank_cleanup( Environment * _environment );
 void gameloop_cleanup( Environment * _environment );
 void linker_cleanup( Environment * _environment );
@@ -3831,6 +4223,7 @@ int                     calculate_nearest_tile( TileDescriptor * _tile, TileDesc
 int                     calculate_exact_tile( TileDescriptor * _tile, TileDescriptors * _tiles );
 int                     calculate_tile_affinity( TileDescriptor * _first, TileDescriptor * _second );
 TileDescriptor *        calculate_tile_descriptor( TileData * _tileData );
+void                    tile_descriptors_set( TileDescriptors * _tiles, int _index, TileDescriptor * _descriptor );
 Variable *              calculate_frame_by_type( Environment * _environment, TsxTileset * _tileset, char * _images, char * _description );
 void                    call_procedure( Environment * _environment, char * _name );
 void                    case_else( Environment * _environment );
@@ -3869,6 +4262,8 @@ void                    const_define_string( Environment * _environment, char *
 void                    const_define_float( Environment * _environment, char * _name, double _value );
 void                    const_emit( Environment * _environment, char * _name );
 Constant *              constant_find( Constant * _constant, char * _name );
+int                     constant_propagation_applies( Environment * _environment, char * _name, Variable * _expr );
+void                    constant_propagation_scan( Environment * _environment, char * _source_filename );
 Variable *              csprite_init( Environment * _environment, char * _image, char * _sprite, int _flags );
 
 //----------------------------------------------------------------------------
@@ -3917,11 +4312,21 @@ void                    end_storage( Environment * _environment );
 void                    end_while( Environment * _environment );
 char *                  escape_newlines( char * _string );
 void                    every_cleanup( Environment * _environment );
+void                    every_context_cleanup( Environment * _environment );
+void                    every_handler( Environment * _environment, char * _label );
 void                    every_off( Environment * _environment, char * _timer );
 void                    every_on( Environment * _environment, char * _timer );
 void                    every_ticks_call( Environment * _environment, char * _timing, char * _label, char * _timer );
 void                    every_ticks_gosub( Environment * _environment, char * _timing, char * _label, char * _timer );
 void                    exit_loop( Environment * _environment, int _number );
+Variable *              expression_add( Environment * _environment, char * _left, char * _right );
+Variable *              expression_div( Environment * _environment, char * _left, char * _right );
+void                    expression_flush( Environment * _environment );
+void                    expression_invalidate( Environment * _environment, char * _name );
+Variable *              expression_mod( Environment * _environment, char * _left, char * _right );
+Variable *              expression_mul( Environment * _environment, char * _left, char * _right );
+void                    expression_reset( Environment * _environment );
+Variable *              expression_sub( Environment * _environment, char * _left, char * _right );
 void                    exit_loop_if( Environment * _environment, char * _expression, int _number );
 void                    exit_proc_if( Environment * _environment, char * _expression, char * _value );
 void                    exit_procedure( Environment * _environment );
@@ -3930,8 +4335,13 @@ void                    exit_procedure( Environment * _environment );
 // *F*
 //----------------------------------------------------------------------------
 
-void                    file_storage( Environment * _environment, char * _source_name, char *_target_name );
+void                    file_storage( Environment * _environment, char * _source_name, char *_target_name, int _flags );
+FileStorage *           file_storage_find( Environment * _environment, char * _filename );
+void                    file_storage_uncompressed( Environment * _environment, FileStorage * _file_storage );
 int                     find_frame_by_type( Environment * _environment, TsxTileset * _tileset, char * _images, char * _description );
+Variable *              fixed_sin( Environment * _environment, Variable * _angle, int _cosine );
+int                     fixed_sin_applies( Environment * _environment, Variable * _angle );
+Variable *              fixed_tan( Environment * _environment, Variable * _angle );
 void                    font_descriptors_init( Environment * _environment, int _embedded_present );
 void                    forbid( Environment * _environment );
 int                     frames( Environment * _environment, char * _image );
@@ -3977,6 +4387,10 @@ void                    home( Environment * _environment );
 //----------------------------------------------------------------------------
 
 void                    if_then( Environment * _environment, char * _expression );
+void                    image_cache_cleanup( Environment * _environment );
+unsigned char *         image_cache_load( Environment * _environment, char * _filename, int * _width, int * _height, int * _depth );
+void                    image_cache_prefetch( Environment * _environment, char * _filename );
+void                    image_cache_prefetch_source( Environment * _environment, char * _source_filename );
 char *                  image_cut( Environment * _environment, char * _source, int _x, int _y, int _width, int _height );
 char *                  image_flip_x( Environment * _environment, char * _source, int _width, int _height, int _depth );
 char *                  image_flip_y( Environment * _environment, char * _source, int _width, int _height, int _depth );
@@ -4051,6 +4465,9 @@ float                   max_of_three(float _m, float _n, float _p);
 Variable *              maximum( Environment * _environment, char * _source, char * _dest );
 void                    memorize( Environment * _environment );
 void                    memory_area_assign( MemoryArea * _first, Variable * _variable );
+MemoryArea *            memory_map_allocate( Environment * _environment, char * _name, int _size );
+void                    memory_map_pack( Environment * _environment );
+void                    memory_map_report( Environment * _environment );
 float                   min_of_two(float _x, float _y);
 float                   min_of_three(float _m, float _n, float _p);
 Variable *              minimum( Environment * _environment, char * _source, char * _dest );
@@ -4164,10 +4581,12 @@ void                    raster_at_var( Environment * _environment, char * _label
 Variable *              read_end( Environment * _environment );
 Variable *              read_end_unsafe( Environment * _environment );
 void                    read_data( Environment * _environment, char * _variable, int _safe );
+void                    read_data_into( Environment * _environment, char * _array, int _safe );
 void                    read_data_unsafe( Environment * _environment, char * _variable );
 void                    remember( Environment * _environment );
 void                    repeat( Environment * _environment, char *_label );
 char *                  resource_load_asserts( Environment * _environment, char * _filename );
+char *                  resource_lookup( Environment * _environment, char * _filename );
 Variable *              respawn_procedure( Environment * _environment, char * _name );
 void                    restore_label( Environment * _environment, char * _label );
 void                    restore_label_unsafe( Environment * _environment, char * _label );
@@ -4177,7 +4596,7 @@ int                     rgbi_equals_rgb( RGBi * _first, RGBi * _second );
 int                     rgbi_equals_rgba( RGBi * _first, RGBi * _second );
 int                     rgbi_extract_palette( Environment * _environment, unsigned char* _source, int _width, int _height, int _depth, RGBi _palette[], int _palette_size, int _sorted);
 void                    rgbi_move( RGBi * _source, RGBi * _destination );
-int                     rgbi_distance( RGBi * _source, RGBi * _destination );
+int                     rgbi_distance_squared( RGBi * _source, RGBi * _destination );
 Variable *              rnd( Environment * _environment, char * _value );
 void                    run( Environment * _environment );
 void                    run_parallel( Environment * _environment );
@@ -4199,6 +4618,7 @@ void                    screen_mode( Environment * _environment, int _mode );
 void                    screen_type_color_set( Environment * _environment, int _type, int _color_set );
 void                    screen_off( Environment * _environment );
 void                    screen_on( Environment * _environment );
+void                    screen_playfield( Environment * _environment, int _width, int _height );
 void                    screen_rows( Environment * _environment, int _rows );
 void                    screen_rows_var( Environment * _environment, char * _rows );
 void                    screen_swap( Environment * _environment );
@@ -4322,9 +4742,11 @@ Variable *              variable_add_const( Environment * _environment, char * _
 void                    variable_add_inplace( Environment * _environment, char * _source, int _dest );
 void                    variable_add_inplace_vars( Environment * _environment, char * _source, char * _dest );
 void                    variable_add_inplace_array( Environment * _environment, char * _source, char * _destination );
+void                    variable_concatenation_flush( Environment * _environment, Variable * _result );
 void                    variable_add_inplace_mt( Environment * _environment, char * _source, char * _destination );
 Variable *              variable_and( Environment * _environment, char * _left, char * _right );
 Variable *              variable_and_const( Environment * _environment, char * _source, int _mask );
+Variable *              variable_array_bit_count( Environment * _environment, char * _name );
 void                    variable_array_fill( Environment * _environment, char * _name, int _value );
 Variable *              variable_array_type( Environment * _environment, char *_name, VariableType _type );
 Variable *              variable_bin( Environment * _environment, char * _value, char * _digits );
@@ -4345,6 +4767,7 @@ Variable *              variable_define_no_init( Environment * _environment, cha
 int                     variable_delete( Environment * _environment, char * _name );
 Variable *              variable_direct_assign( Environment * _environment, char * _var, char * _expr );
 Variable *              variable_div( Environment * _environment, char * _source, char * _dest, char * _remainder );
+Variable *              variable_div_fixed( Environment * _environment, Variable * _source, Variable * _target );
 Variable *              variable_div2_const( Environment * _environment, char * _source, int _bits );
 void                    variable_global( Environment * _environment, char * _pattern );
 Variable *              variable_greater_than( Environment * _environment, char * _source, char * _dest, int _equal );
@@ -4361,11 +4784,13 @@ Variable *              variable_mod( Environment * _environment, char * _source
 Variable *              variable_move( Environment * _environment, char * _source, char * _dest );
 void                    variable_move_array( Environment * _environment, char * _array, char * _value  );
 void                    variable_move_array_string( Environment * _environment, char * _array, char * _string  );
+void                    variable_move_fixed( Environment * _environment, Variable * _source, Variable * _target );
 Variable *              variable_move_from_array( Environment * _environment, char * _array );
 Variable *              variable_move_from_mt( Environment * _environment, char * _source, char * _destination );
 Variable *              variable_move_to_mt( Environment * _environment, char * _source, char * _destination );
 Variable *              variable_move_naked( Environment * _environment, char * _source, char * _dest );
 Variable *              variable_mul( Environment * _environment, char * _source, char * _dest );
+Variable *              variable_mul_fixed( Environment * _environment, Variable * _source, Variable * _target );
 Variable *              variable_mul2_const( Environment * _environment, char * _source, int _bits );
 Variable *              variable_not( Environment * _environment, char * _value );
 void                    variable_on_memory_init( Environment * _environment, int _imported_too );
@@ -4428,6 +4853,8 @@ void                    wait_milliseconds( Environment * _environment, int _timi
 void                    wait_milliseconds_var( Environment * _environment, char * _timing );
 void                    wait_ticks( Environment * _environment, int _timing );
 void                    wait_ticks_var( Environment * _environment, char * _timing );
+void                    wait_ticks_parallel( Environment * _environment, char * _ticks );
+void                    wait_milliseconds_parallel( Environment * _environment, char * _milliseconds );
 void                    wait_vbl( Environment * _environment, char * _raster_line );
 void                    wait_until( Environment * _environment );
 void                    wait_until_condition( Environment * _environment, char * _condition );
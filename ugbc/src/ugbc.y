@@ -27,6 +27,7 @@ extern char DATATYPE_AS_STRING[][16];
 extern char OUTPUT_FILE_TYPE_AS_STRING[][16];
 
 #include <math.h>
+#include <getopt.h>
 
 %}
 
@@ -92,7 +93,7 @@ extern char OUTPUT_FILE_TYPE_AS_STRING[][16];
 %token ALL BUT VG5000 CLASS PROBABILITY LAYER SLICE INDEX SYS EXEC REGISTER CPU6502 CPU6809 CPUZ80 ASM 
 %token STACK DECLARE SYSTEM KEYBOARD RATE DELAY NAMED MAP ID RATIO BETA PER SECOND AUTO COCO1 COCO2 COCO3
 %token RESTORE SAFE PAGE PMODE PCLS PRESET PSET BF PAINT SPC UNSIGNED NARROW WIDE AFTER STRPTR ERROR
-%token POKEW PEEKW POKED PEEKD DSAVE DEFDGR FORBID ALLOW
+%token POKEW PEEKW POKED PEEKD DSAVE DEFDGR FORBID ALLOW MULTIPLEX FIXED DFIXED MATH PRECISE DELTA PLAYFIELD INTO
 
 %token A B C D E F G H I J K L M N O P Q R S T U V X Y W Z
 %token F1 F2 F3 F4 F5 F6 F7 F8
@@ -133,7 +134,7 @@ extern char OUTPUT_FILE_TYPE_AS_STRING[][16];
 %type <integer> image_load_flags image_load_flags1 image_load_flag
 %type <integer> images_load_flags images_load_flags1 images_load_flag
 %type <integer> sequence_load_flags sequence_load_flags1 sequence_load_flag
-%type <integer> put_image_flags put_image_flags1 put_image_flag
+%type <integer> put_image_flags put_image_flags1 put_image_flag put_tilemap_flags
 %type <integer> blit_image_flags blit_image_flags1 blit_image_flag
 %type <integer> const_color_enumeration
 %type <integer> using_transparency
@@ -1298,47 +1299,24 @@ expr_math :
 expr_math2: 
       term
     | expr_math2 OP_PLUS term {
-        Variable * expr = variable_retrieve( _environment, $3 );
-        if ( expr->initializedByConstant ) {
-            $$ = variable_add_const( _environment, $1, expr->value )->name;
-        } else {
-            $$ = variable_add( _environment, $1, $3 )->name;
-        }
+        $$ = expression_add( _environment, $1, $3 )->name;
     }
     | expr_math2 OP_MINUS term {
-        Variable * expr = variable_retrieve( _environment, $3 );
-        if ( expr->initializedByConstant ) {
-            $$ = variable_sub_const( _environment, $1, expr->value )->name;
-        } else {
-            $$ = variable_sub( _environment, $1, $3 )->name;
-        }
+        $$ = expression_sub( _environment, $1, $3 )->name;
     }
     ;
 
 term:
       modula
     | term MOD modula {
-        $$ = variable_mod( _environment, $1, $3 )->name;
+        $$ = expression_mod( _environment, $1, $3 )->name;
     }
     ;
 
 modula: 
       factor
     | modula OP_MULTIPLICATION factor {
-        Variable * modula = variable_retrieve( _environment, $1 );
-        Variable * factor = variable_retrieve( _environment, $3 );
-        if ( factor->initializedByConstant ) {
-            if ( modula->initializedByConstant ) {
-                Variable * number = variable_temporary( _environment, VT_MAX_BITWIDTH_TYPE( factor->type, modula->type ), "(constant)" );
-                $$ = number->name;
-                variable_store( _environment, $$, factor->value * modula->value );
-                number->initializedByConstant = 1;
-            } else {
-                $$ = variable_mul( _environment, $1, $3 )->name;
-            }
-        } else {
-            $$ = variable_mul( _environment, $1, $3 )->name;
-        }
+        $$ = expression_mul( _environment, $1, $3 )->name;
     } 
     | modula OP_MULTIPLICATION2 direct_integer {
         if ( log2($3) != (int)log2($3) ) {
@@ -1353,7 +1331,7 @@ modula:
         $$ = variable_mul2_const( _environment, $1, $3 )->name;
     } 
     | modula OP_DIVISION factor {
-        $$ = variable_div( _environment, $1, $3, NULL )->name;
+        $$ = expression_div( _environment, $1, $3 )->name;
     } 
     | modula OP_DIVISION2 direct_integer {
         if ( log2($3) != (int)log2($3) ) {
@@ -1396,7 +1374,8 @@ factor:
         Variable * expr = variable_retrieve( _environment, $2 );
         Variable * zero = variable_temporary( _environment, VT_SIGN( expr->type ), "(zero)" );
         variable_store( _environment, zero->name, 0 );
-        $$ = variable_sub( _environment, zero->name, expr->name )->name;
+        zero->initializedByConstant = ( VT_BITWIDTH( zero->type ) > 1 );
+        $$ = expression_sub( _environment, zero->name, expr->name )->name;
       }
       ;
 
@@ -1662,6 +1641,14 @@ put_image_flags :
         $$ = $1;
     };
 
+put_tilemap_flags :
+    put_image_flags {
+        $$ = $1;
+    }
+    | DELTA put_image_flags {
+        $$ = $2 | FLAG_DELTA;
+    };
+
 blit_image_flags :
     {
         $$ = 0;    
@@ -2719,6 +2706,28 @@ exponential:
         $$ = variable_temporary( _environment, VT_FLOAT, "(float)" )->name;
         variable_store_float( _environment, $$, $4 );
     }
+    | OP FIXED CP Float { 
+        $$ = variable_temporary( _environment, VT_FIXED, "(fixed)" )->name;
+        variable_store_float( _environment, $$, $4 );
+    }
+    | OP FIXED CP Integer { 
+        $$ = variable_temporary( _environment, VT_FIXED, "(fixed)" )->name;
+        variable_store_float( _environment, $$, $4 );
+    }
+    | OP FIXED CP OP expr CP { 
+        $$ = variable_cast( _environment, $5, VT_FIXED )->name;
+    }
+    | OP DFIXED CP Float { 
+        $$ = variable_temporary( _environment, VT_DFIXED, "(fixed)" )->name;
+        variable_store_float( _environment, $$, $4 );
+    }
+    | OP DFIXED CP Integer { 
+        $$ = variable_temporary( _environment, VT_DFIXED, "(fixed)" )->name;
+        variable_store_float( _environment, $$, $4 );
+    }
+    | OP DFIXED CP OP expr CP { 
+        $$ = variable_cast( _environment, $5, VT_DFIXED )->name;
+    }
     | OP SIGNED DWORD CP OP expr CP { 
         $$ = variable_cast( _environment, $6, VT_SDWORD )->name;
       }
@@ -3679,6 +3688,9 @@ exponential:
         $$ = variable_temporary( _environment, VT_BYTE, "(JOYCOUNT)" )->name;
         variable_store( _environment, $$, JOY_COUNT );
     }
+    | BIT COUNT OP Identifier CP {
+        $$ = variable_array_bit_count( _environment, $4 )->name;
+    }
     | BIT OP expr OP_COMMA expr CP {
         $$ = variable_bit( _environment, $3, $5 )->name;
     }
@@ -4014,13 +4026,25 @@ wait_definition_simple:
       wait_cycles( _environment, $1, $3 );
     }
     | direct_integer ticks {
-      wait_ticks( _environment, $1 );
+      if ( ((struct _Environment *)_environment)->protothread && ((struct _Environment *)_environment)->procedureName ) {
+        Variable * ticks = variable_temporary( _environment, VT_WORD, "(ticks)" );
+        variable_store( _environment, ticks->name, $1 );
+        wait_ticks_parallel( _environment, ticks->name );
+      } else {
+        wait_ticks( _environment, $1 );
+      }
     }
     | direct_integer parallel_optional {
       wait_cycles( _environment, $1, $2 );
     }
     | direct_integer milliseconds {
-      wait_milliseconds( _environment, $1 );
+      if ( ((struct _Environment *)_environment)->protothread && ((struct _Environment *)_environment)->procedureName ) {
+        Variable * milliseconds = variable_temporary( _environment, VT_WORD, "(milliseconds)" );
+        variable_store( _environment, milliseconds->name, $1 );
+        wait_milliseconds_parallel( _environment, milliseconds->name );
+      } else {
+        wait_milliseconds( _environment, $1 );
+      }
     }
     | FIRE release {
         begin_loop( _environment );
@@ -4082,7 +4106,13 @@ wait_definition_simple:
         }
     }
     | VBL {
-      wait_vbl( _environment, NULL );
+      if ( ((struct _Environment *)_environment)->protothread && ((struct _Environment *)_environment)->procedureName ) {
+        Variable * ticks = variable_temporary( _environment, VT_WORD, "(ticks)" );
+        variable_store( _environment, ticks->name, 1 );
+        wait_ticks_parallel( _environment, ticks->name );
+      } else {
+        wait_vbl( _environment, NULL );
+      }
     }
     | VBL expr {
       wait_vbl( _environment, $2 );
@@ -4094,10 +4124,18 @@ wait_definition_expression:
       wait_cycles_var( _environment, $1, $3 );
     }
     | expr ticks {
-      wait_ticks_var( _environment, $1 );
+      if ( ((struct _Environment *)_environment)->protothread && ((struct _Environment *)_environment)->procedureName ) {
+        wait_ticks_parallel( _environment, $1 );
+      } else {
+        wait_ticks_var( _environment, $1 );
+      }
     }
     | expr milliseconds {
-      wait_milliseconds_var( _environment, $1 );
+      if ( ((struct _Environment *)_environment)->protothread && ((struct _Environment *)_environment)->procedureName ) {
+        wait_milliseconds_parallel( _environment, $1 );
+      } else {
+        wait_milliseconds_var( _environment, $1 );
+      }
     }
     | FIRE OP expr CP release {
         begin_loop( _environment );
@@ -4439,6 +4477,9 @@ screen_definition_simple:
   }
   | HORIZONTAL SCROLL direct_integer {
       screen_horizontal_scroll( _environment, $3 );
+  }
+  | PLAYFIELD direct_integer OP_COMMA direct_integer {
+      screen_playfield( _environment, $2, $4 );
   };
 
 screen_definition_expression:
@@ -4900,19 +4941,19 @@ put_definition_expression:
     | TILE expr AT optional_x OP_COMMA optional_y {
         put_tile( _environment, $2, $4, $6, NULL, NULL );
     }
-    | TILEMAP Identifier padding_tile put_image_flags {
+    | TILEMAP Identifier padding_tile put_tilemap_flags {
         $4 = $4 | FLAG_WITH_PALETTE;
         put_tilemap_vars( _environment, $2, $4, NULL, NULL, NULL, $3 );
     }
-    | TILEMAP Identifier padding_tile LAYER expr put_image_flags {
+    | TILEMAP Identifier padding_tile LAYER expr put_tilemap_flags {
         $6 = $6 | FLAG_WITH_PALETTE;
         put_tilemap_vars( _environment, $2, $6, NULL, NULL, $5, $3 );
     }
-    | TILEMAP Identifier padding_tile FROM expr OP_COMMA expr put_image_flags {
+    | TILEMAP Identifier padding_tile FROM expr OP_COMMA expr put_tilemap_flags {
         $8 = $8 | FLAG_WITH_PALETTE;
         put_tilemap_vars( _environment, $2, $8, $5, $7, NULL, $3 );
     }
-    | TILEMAP Identifier padding_tile LAYER expr FROM expr OP_COMMA expr put_image_flags {
+    | TILEMAP Identifier padding_tile LAYER expr FROM expr OP_COMMA expr put_tilemap_flags {
         $10 = $10 | FLAG_WITH_PALETTE;
         put_tilemap_vars( _environment, $2, $10, $7, $9, $5, $3 );
     }
@@ -5488,11 +5529,13 @@ every_definition :
       expr ticks timer_number_comma GOSUB Identifier on_targets {
         if ( $6 ) {
           every_ticks_gosub( _environment, $1, $5, $3 );
+          every_handler( _environment, $5 );
         }
     }
     | expr ticks timer_number_comma CALL Identifier on_targets {
         if ( $6 ) {
           every_ticks_call( _environment, $1, $5, $3 );
+          every_handler( _environment, $5 );
         }
     }
     | ON timer_number on_targets {
@@ -5510,12 +5553,14 @@ after_definition :
       expr ticks timer_number_comma GOSUB Identifier on_targets {
         if ( $6 ) {
           every_ticks_gosub( _environment, $1, $5, $3 );
+          every_handler( _environment, $5 );
           every_on( _environment, $3 );
         }
     }
     | expr ticks timer_number_comma CALL Identifier on_targets {
         if ( $6 ) {
           every_ticks_call( _environment, $1, $5, $3 );
+          every_handler( _environment, $5 );
           every_on( _environment, $3 );
         }
     };
@@ -5644,6 +5689,12 @@ datatype :
     | FLOAT {
         $$ = VT_FLOAT;
     }
+    | FIXED {
+        $$ = VT_FIXED;
+    }
+    | DFIXED {
+        $$ = VT_DFIXED;
+    }
     | ADDRESS {
         $$ = VT_ADDRESS;
     }
@@ -7065,6 +7116,12 @@ read_definition_single :
         read_data( _environment, read->name, $1 );
         variable_move_array_string( _environment, $2, read->name );
         parser_array_cleanup( _environment );
+    }
+    | read_safeness INTO Identifier {
+        read_data_into( _environment, $3, $1 );
+    }
+    | read_safeness INTO Identifier OP CP {
+        read_data_into( _environment, $3, $1 );
     };
 
 read_definition :
@@ -7281,6 +7338,21 @@ define_definition :
     | FLOAT PRECISION precision {
         ((struct _Environment *)_environment)->floatType.precision = $3;
     }
+    | MATH FAST {
+        ((struct _Environment *)_environment)->mathMode = MATH_MODE_FAST;
+    }
+    | MATH PRECISE {
+        ((struct _Environment *)_environment)->mathMode = MATH_MODE_PRECISE;
+    }
+    | SCROLL DOUBLE BUFFER {
+        ((struct _Environment *)_environment)->scrollDoubleBuffer = 1;
+    }
+    | SCROLL DOUBLE BUFFER ON {
+        ((struct _Environment *)_environment)->scrollDoubleBuffer = 1;
+    }
+    | SCROLL DOUBLE BUFFER OFF {
+        ((struct _Environment *)_environment)->scrollDoubleBuffer = 0;
+    }
     | TASK COUNT const_expr {
         if ( $3 <= 0 ) {
             CRITICAL_INVALID_TASK_COUNT( $3 );
@@ -7291,6 +7363,28 @@ define_definition :
     | DEFAULT TYPE datatype {
         ((struct _Environment *)_environment)->defaultVariableType = $3;
     }
+    | SPRITE MULTIPLEX ON {
+        if ( ((struct _Environment *)_environment)->spriteConfig.rasterAt ) {
+            CRITICAL_SPRITE_MULTIPLEX_RASTER();
+        }
+        ((struct _Environment *)_environment)->spriteConfig.multiplex = 1;
+        if ( ! ((struct _Environment *)_environment)->spriteConfig.count ) {
+            ((struct _Environment *)_environment)->spriteConfig.count = 24;
+        }
+    }
+    | SPRITE MULTIPLEX OFF {
+        ((struct _Environment *)_environment)->spriteConfig.multiplex = 0;
+    }
+    | SPRITE MULTIPLEX const_expr {
+        if ( $3 <= 0 || $3 > 32 ) {
+            CRITICAL_INVALID_SPRITE_MULTIPLEX_COUNT( $3 );
+        }
+        if ( ((struct _Environment *)_environment)->spriteConfig.rasterAt ) {
+            CRITICAL_SPRITE_MULTIPLEX_RASTER();
+        }
+        ((struct _Environment *)_environment)->spriteConfig.multiplex = 1;
+        ((struct _Environment *)_environment)->spriteConfig.count = $3;
+    }
     | INPUT SIZE const_expr {
         if ( $3 <= 0 ) {
             CRITICAL_INVALID_INPUT_SIZE( $3 );
@@ -7357,6 +7451,15 @@ define_definition :
         }
         ((struct _Environment *)_environment)->paintBucketSize = $3;
     }
+    | DLOAD FAST {
+        ((struct _Environment *)_environment)->dloadFast = 1;
+    }
+    | DLOAD FAST ON {
+        ((struct _Environment *)_environment)->dloadFast = 1;
+    }
+    | DLOAD FAST OFF {
+        ((struct _Environment *)_environment)->dloadFast = 0;
+    }
     ;
 
 system : {
@@ -7763,6 +7866,15 @@ option_definitions :
     | READ option_read {
         ((struct _Environment *)_environment)->optionReadSafe = $2;
     };
+    | DATA as_datatype_mandatory {
+        if ( ((struct _Environment *)_environment)->dataSegment || ((struct _Environment *)_environment)->readDataUsed ) {
+            CRITICAL_OPTION_DATA_TOO_LATE( );
+        }
+        if ( VT_BITWIDTH( $2 ) < 8 ) {
+            CRITICAL_OPTION_DATA_TYPE_NOT_SUPPORTED( DATATYPE_AS_STRING[$2] );
+        }
+        ((struct _Environment *)_environment)->optionDataType = $2;
+    };
     | CLIP option_clip {
         ((struct _Environment *)_environment)->optionClip = $2;
     };
@@ -7888,7 +8000,7 @@ data_definition_data :
 
 data_definition :
     {
-        ((struct _Environment *)_environment)->dataDataType = 0;
+        ((struct _Environment *)_environment)->dataDataType = ((struct _Environment *)_environment)->optionDataType;
     } data_definition_data
     | as_datatype_mandatory {
         ((struct _Environment *)_environment)->dataDataType = $1;
@@ -8684,10 +8796,16 @@ statement2nc:
         begin_storage( _environment, $2, $4 );
   }
   | FILEX const_expr_string {
-        file_storage( _environment, $2, NULL );
+        file_storage( _environment, $2, NULL, 0 );
+  }
+  | FILEX const_expr_string COMPRESSED {
+        file_storage( _environment, $2, NULL, FLAG_COMPRESSED );
   }
   | FILEX const_expr_string AS const_expr_string {
-        file_storage( _environment, $2, $4 );
+        file_storage( _environment, $2, $4, 0 );
+  }
+  | FILEX const_expr_string AS const_expr_string COMPRESSED {
+        file_storage( _environment, $2, $4, FLAG_COMPRESSED );
   }
   | IMAGE const_expr_string image_load_flags using_transparency using_opacity using_background on_bank to_variable {
         Variable * v = image_storage( _environment, $2, NULL, ((struct _Environment *)_environment)->currentMode, $3, $3+$4, $5, $6 );
@@ -8893,8 +9011,10 @@ statement2nc:
   }
   | Identifier OP_ASSIGN expr {
         Variable * expr = variable_retrieve( _environment, $3 );
-        Variable * variable;
-        if ( variable_exists( _environment, $1 ) ) {
+        Variable * variable = NULL;
+        if ( constant_propagation_applies( _environment, $1, expr ) ) {
+            const_define_numeric( _environment, $1, expr->value );
+        } else if ( variable_exists( _environment, $1 ) ) {
             variable = variable_retrieve( _environment, $1 );
         } else {
             if ( !((struct _Environment *)_environment)->optionExplicit ) {
@@ -8904,7 +9024,9 @@ statement2nc:
             }
         }
 
-        if ( expr->initializedByConstant ) {
+        if ( !variable ) {
+            // variable assigned once, promoted to a constant
+        } else if ( expr->initializedByConstant ) {
             if ( variable->type == VT_FLOAT ) {
                 variable_store_float( _environment, variable->name, expr->valueFloating );
             } else {
@@ -9232,11 +9354,14 @@ void show_usage_and_exit( int _argc, char *_argv[] ) {
     printf("\t-a           Show statistics on assembly listing generated\n" );
     printf("\t-d           Enable debugging of LOAD IMAGE\n" );
     printf("\t-p <num>     Maximum number of peep hole optimizations passes (default: 16, 0 = disable)\n" );
+    printf("\t-k           Keep variables assigned once (disable their promotion to constants)\n" );
     printf("\t-C <file>    Path to compiler\n" );
     printf("\t-A <file>    Path to app maker\n" );
     printf("\t-T <path>    Path to temporary path\n" );
     printf("\t-X <file>    Path to executer\n" );
     printf("\t-P <file>    Path to profile (-L needed)\n" );
+    printf("\t             Hot spots are written also to .hotspots (text)\n" );
+    printf("\t             and .folded (collapsed stacks) files.\n" );
     printf("\t-q <cycles>  Cycles for profiling (default: 1000000)\n" );
     printf("\t-c <file>    Output filename with linker configuration\n" );
 #if defined(__coco__) || defined(__coco3__)
@@ -9332,6 +9457,7 @@ void show_usage_and_exit( int _argc, char *_argv[] ) {
     #define defaultExtension "k7"
 #endif
     printf("\t-l <name>    Output filename with list of variables defined\n" );
+    printf("\t-M <name>    Output filename with memory map report\n" );
     printf("\t-e <modules> Embed specified modules instead of inline code\n" );
 #if defined(__zx__) || defined(__msx1__) || defined(__coleco__) || defined(__sc3000__) || defined(__sg1000__) || defined(__cpc__) || defined(__c128z__)
     printf("\t-L <ignored> Output filename with assembly listing file\n" );
@@ -9339,6 +9465,9 @@ void show_usage_and_exit( int _argc, char *_argv[] ) {
     printf("\t-L <listing> Output filename with assembly listing file\n" );
 #endif
     printf("\t-E           Show stats of embedded modules\n" );
+    printf("\t--time-report[=<file>]\n" );
+    printf("\t             Write a JSON report of the time spent by the\n" );
+    printf("\t             compiler on each phase (default: on stderr)\n" );
     printf("\t-W           Enable warnings during compilation\n" );
     printf("\t-V           Output version (example: '%s')\n", version );
     printf("\n\n" );
@@ -9414,8 +9543,16 @@ int main( int _argc, char *_argv[] ) {
     _environment->outputFileType = OUTPUT_FILE_TYPE_K7_NEW;
 #endif
 
-    while ((opt = getopt(_argc, _argv, "1a:A:b:c:C:dD:Ee:G:Ii:l:L:o:O:p:P:q:st:T:VWX:")) != -1) {
+    static struct option longOptions[] = {
+        { "time-report", optional_argument, NULL, 0x100 },
+        { NULL, 0, NULL, 0 }
+    };
+
+    while ((opt = getopt_long(_argc, _argv, "1a:A:b:c:C:dD:Ee:G:Ii:kl:L:M:o:O:p:P:q:st:T:VWX:", longOptions, NULL)) != -1) {
         switch (opt) {
+                case 0x100:
+                    telemetry_create( _environment, optarg );
+                    break;
                 case 'a':
                     if ( ! _environment->listingFileName ) {
                         char listingFileName[MAX_TEMPORARY_STORAGE];
@@ -9538,12 +9675,18 @@ int main( int _argc, char *_argv[] ) {
                 case 'L':
                     _environment->listingFileName = strdup(optarg);
                     break;
+                case 'M':
+                    _environment->memoryMapFileName = strdup(optarg);
+                    break;
                 case 'E':
                     _environment->embeddedStatsEnabled = 1;
                     break;
                 case 'p':
                     _environment->peepholeOptimizationLimit = atoi(optarg);
                     break;
+                case 'k':
+                    _environment->constantPropagationDisabled = 1;
+                    break;
                 case 'q':
                     _environment->profileCycles = atoi(optarg);
                     break;
@@ -9769,6 +9912,20 @@ int main( int _argc, char *_argv[] ) {
         _environment->asmFileName = strdup(_argv[optind+1] );
     }
     
+    // Variables assigned once with a constant can be promoted
+    // to constants (this must be done before parsing).
+    telemetry_begin( _environment, "constant propagation" );
+    constant_propagation_scan( _environment, _environment->sourceFileName );
+    telemetry_end( _environment );
+
+    // Images loaded with a constant filename can be decoded
+    // in background, while the source is compiled.
+    if ( ! _environment->sandbox ) {
+        telemetry_begin( _environment, "image prefetch" );
+        image_cache_prefetch_source( _environment, _environment->sourceFileName );
+        telemetry_end( _environment );
+    }
+
     yyin = fopen( _environment->sourceFileName, "r" );
     if ( ! yyin ) {
         fprintf(stderr, "Unable to open source file: %s\n", _environment->sourceFileName );
@@ -9789,21 +9946,33 @@ int main( int _argc, char *_argv[] ) {
     
     filenamestacked[0] = strdup( _environment->sourceFileName );
 
+    telemetry_begin( _environment, "begin compilation" );
     begin_compilation( _environment );
+    telemetry_end( _environment );
 
     yydebug = 1;
     errors = 0;
+    telemetry_begin( _environment, "parse" );
     yyparse (_environment);
+    telemetry_end( _environment );
 
+    telemetry_begin( _environment, "end compilation" );
     end_compilation( _environment );
+    telemetry_end( _environment );
 
+    telemetry_begin( _environment, "peephole" );
     target_peephole_optimizer( _environment );
+    telemetry_end( _environment );
 
     if ( _environment->exeFileName ) {
+        telemetry_begin( _environment, "build" );
         begin_build( _environment );
         end_build( _environment );
+        telemetry_end( _environment );
     }
 
+    telemetry_report( _environment );
+
     if ( _environment->additionalInfoFile ) {
         fflush( _environment->additionalInfoFile );
         fclose( _environment->additionalInfoFile );